@@ -0,0 +1,67 @@
+// Measures the throughput of the body checksums an upload can be hashed with: Poco's portable
+// SHA-256 that uploads used before, SHA-256 through OpenSSL EVP, and CRC-32C. EVP should run
+// several times faster than Poco on CPUs with the SHA extensions, and CRC-32C faster again.
+//
+// Usage: nebulafs_bench_hashing [--megabytes N] [--chunk-bytes N]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+#include <Poco/DigestEngine.h>
+#include <Poco/SHA2Engine.h>
+
+#include "bench_util.h"
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/core/hashing.h"
+
+namespace {
+
+/// @brief Feeds `total` bytes to `update` in `chunk`-sized pieces and prints MB/s.
+void Run(const char* name, const std::string& chunk, std::size_t total,
+         const std::function<void(const std::string&)>& update,
+         const std::function<std::string()>& finish) {
+    const auto start = nebulafs::bench::NowNanos();
+    for (std::size_t fed = 0; fed < total; fed += chunk.size()) {
+        update(chunk);
+    }
+    const auto digest = finish();
+    const auto nanos = nebulafs::bench::NowNanos() - start;
+    const double mb_per_s = static_cast<double>(total) / (1024.0 * 1024.0) /
+                            (static_cast<double>(std::max<std::uint64_t>(nanos, 1)) / 1e9);
+    std::printf("%-16s %12.1f  %s\n", name, mb_per_s, digest.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int megabytes = nebulafs::bench::GetIntArg(argc, argv, "--megabytes", 256);
+    const int chunk_bytes = nebulafs::bench::GetIntArg(argc, argv, "--chunk-bytes", 65536);
+    const std::string chunk(static_cast<std::size_t>(chunk_bytes), 'x');
+    const auto total = static_cast<std::size_t>(megabytes) * 1024 * 1024;
+
+    std::printf("%d MiB in %d-byte chunks, sha extensions %s, crc32c in hardware %s\n",
+                megabytes, chunk_bytes, nebulafs::core::CpuHasShaExtensions() ? "yes" : "no",
+                nebulafs::core::Crc32cUsesHardware() ? "yes" : "no");
+    std::printf("%-16s %12s  %s\n", "checksum", "MB/s", "digest");
+
+    Poco::SHA2Engine256 poco;
+    Run(
+        "poco-sha256", chunk, total,
+        [&poco](const std::string& data) { poco.update(data.data(), data.size()); },
+        [&poco] { return Poco::DigestEngine::digestToHex(poco.digest()); });
+
+    nebulafs::core::Sha256Hasher evp;
+    Run(
+        "evp-sha256", chunk, total, [&evp](const std::string& data) { evp.Update(data); },
+        [&evp] { return evp.HexDigest(); });
+
+    std::uint32_t crc = 0;
+    Run(
+        "crc32c", chunk, total,
+        [&crc](const std::string& data) { crc = nebulafs::core::Crc32c(data, crc); },
+        [&crc] { return nebulafs::core::Crc32cHex(crc); });
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Measures SqliteMetadataStore read throughput as reader threads are added, with and without
+// the read-only connection pool.
+//
+// Usage: nebulafs_bench_metadata_concurrency [--objects N] [--reads N] [--max-threads N]
+//                                            [--writer 0|1]
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+
+namespace {
+
+using nebulafs::metadata::SqliteMetadataStore;
+
+void Populate(SqliteMetadataStore& store, int objects) {
+    store.CreateBucket("bench");
+    for (int i = 0; i < objects; ++i) {
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = "obj-" + std::to_string(i);
+        meta.size_bytes = 1024;
+        meta.etag = "etag";
+        store.UpsertObject("bench", meta);
+    }
+}
+
+double RunReaders(SqliteMetadataStore& store, int threads, int reads_per_thread, int objects,
+                  bool with_writer) {
+    std::atomic<bool> stop_writer{false};
+    std::thread writer;
+    if (with_writer) {
+        writer = std::thread([&] {
+            int i = 0;
+            while (!stop_writer) {
+                nebulafs::metadata::ObjectMetadata meta;
+                meta.name = "churn-" + std::to_string(i++ % 1000);
+                meta.size_bytes = 1;
+                meta.etag = "etag";
+                store.UpsertObject("bench", meta);
+            }
+        });
+    }
+
+    std::vector<std::thread> workers;
+    const auto start = nebulafs::bench::NowNanos();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t + 1));
+            std::uniform_int_distribution<int> pick(0, objects - 1);
+            for (int i = 0; i < reads_per_thread; ++i) {
+                store.GetObject("bench", "obj-" + std::to_string(pick(rng)));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const auto elapsed = nebulafs::bench::NowNanos() - start;
+
+    stop_writer = true;
+    if (writer.joinable()) {
+        writer.join();
+    }
+    return static_cast<double>(threads) * reads_per_thread / (elapsed / 1e9);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int objects = nebulafs::bench::GetIntArg(argc, argv, "--objects", 10000);
+    const int reads = nebulafs::bench::GetIntArg(argc, argv, "--reads", 20000);
+    const int max_threads = nebulafs::bench::GetIntArg(argc, argv, "--max-threads", 8);
+    const bool with_writer = nebulafs::bench::GetIntArg(argc, argv, "--writer", 1) != 0;
+
+    nebulafs::bench::ScratchDir scratch("nebulafs_bench_metadata_concurrency");
+
+    std::printf("%-14s %-8s %-14s\n", "pool", "threads", "reads/sec");
+    for (int pool : {0, max_threads}) {
+        const auto db_path = scratch.path() / ("pool-" + std::to_string(pool) + ".db");
+        SqliteMetadataStore store(db_path.string(), pool);
+        Populate(store, objects);
+
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            const double rate = RunReaders(store, threads, reads, objects, with_writer);
+            std::printf("%-14s %-8d %-14.0f\n",
+                        pool == 0 ? "writer-only" : ("readers=" + std::to_string(pool)).c_str(),
+                        threads, rate);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Compares the v1 (text) and v2 (compact) SQLite metadata schemas: builds a v1 database, times
+// point lookups and the expiry scan on it, migrates it in place by opening a
+// SqliteMetadataStore, then repeats the lookups against the v2 file and reports both sizes.
+//
+// Usage: nebulafs_bench_metadata_schema [--objects N] [--uploads N] [--lookups N]
+
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Poco/UUIDGenerator.h>
+
+#include "bench_util.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/metadata/sqlite_schema.h"
+
+namespace {
+
+using nebulafs::metadata::SqliteConnection;
+
+std::uintmax_t FileBytes(const std::filesystem::path& db_path) {
+    std::uintmax_t total = 0;
+    for (const auto& suffix : {"", "-wal"}) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(db_path.string() + suffix, ec);
+        total += ec ? 0 : size;
+    }
+    return total;
+}
+
+std::string Hex64(std::mt19937_64& rng) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex(64, '0');
+    for (auto& c : hex) {
+        c = kDigits[rng() & 0x0f];
+    }
+    return hex;
+}
+
+void PopulateV1(SqliteConnection& db, int objects, int uploads,
+                std::vector<std::string>& upload_ids) {
+    std::mt19937_64 rng(7);
+    const std::string now = "2024-06-01T12:00:00Z";
+    nebulafs::metadata::CreateSchemaV1(db);
+    db.Execute("BEGIN");
+    db.Execute("INSERT INTO buckets(id, name, created_at) VALUES(1, 'bench', '" + now + "')");
+    db.Execute("INSERT INTO storage_nodes(id, endpoint, status, updated_at) "
+               "VALUES(1, 'http://node-a', 'active', '" + now + "')");
+    for (int i = 0; i < objects; ++i) {
+        auto object = db.Query(
+            "INSERT INTO objects(bucket_id, name, size_bytes, etag, created_at, updated_at) "
+            "VALUES(1, ?, 1024, ?, ?, ?) RETURNING id");
+        const auto etag = Hex64(rng);
+        object.Bind("photos/IMG_" + std::to_string(i) + ".jpg").Bind(etag).Bind(now).Bind(now);
+        object.Next();
+        const auto object_id = object.Int64(0);
+        auto replica = db.Query(
+            "INSERT INTO object_replicas(object_id, node_id, blob_id, replica_index, state, "
+            "checksum, updated_at) VALUES(?, 1, ?, 0, 'committed', ?, ?)");
+        replica.Bind(object_id)
+            .Bind(Poco::UUIDGenerator().createOne().toString())
+            .Bind(etag)
+            .Bind(now);
+        replica.Run();
+    }
+    for (int i = 0; i < uploads; ++i) {
+        upload_ids.push_back(Poco::UUIDGenerator().createOne().toString());
+        auto upload = db.Query(
+            "INSERT INTO multipart_uploads(upload_id, bucket_id, object_name, state, expires_at, "
+            "created_at, updated_at) VALUES(?, 1, 'big.bin', ?, ?, ?, ?)");
+        upload.Bind(upload_ids.back())
+            .Bind(i % 2 == 0 ? "uploading" : "completed")
+            .Bind(i % 4 == 0 ? "2000-01-01T00:00:00Z" : "2999-01-01T00:00:00Z")
+            .Bind(now)
+            .Bind(now);
+        upload.Run();
+    }
+    db.Execute("COMMIT");
+    db.Execute("PRAGMA wal_checkpoint(TRUNCATE)");
+}
+
+void Measure(const char* name, int lookups, const std::function<void(int)>& op) {
+    nebulafs::bench::LatencySamples samples;
+    for (int i = 0; i < lookups; ++i) {
+        const auto start = nebulafs::bench::NowNanos();
+        op(i);
+        samples.Add(nebulafs::bench::NowNanos() - start);
+    }
+    std::printf("  %-20s mean_us=%8.2f p99_us=%8.2f\n", name, samples.MeanMicros(),
+                samples.PercentileMicros(99));
+}
+
+// `v2` selects the compact bindings so each schema is queried the way its store would.
+void RunLookups(const std::filesystem::path& db_path, bool v2, int objects,
+                const std::vector<std::string>& upload_ids, int lookups) {
+    SqliteConnection db(db_path.string(), true);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> pick_object(0, objects - 1);
+    std::uniform_int_distribution<int> pick_upload(0, static_cast<int>(upload_ids.size()) - 1);
+
+    Measure("upload_by_id", lookups, [&](int) {
+        auto query =
+            db.Query("SELECT state, expires_at FROM multipart_uploads WHERE upload_id = ?");
+        if (v2) {
+            nebulafs::metadata::BindId(query, upload_ids[pick_upload(rng)]);
+        } else {
+            query.Bind(upload_ids[pick_upload(rng)]);
+        }
+        query.Next();
+    });
+    Measure("resolve_read", lookups, [&](int) {
+        auto query = db.Query(
+            "SELECT o.etag, r.blob_id FROM objects o JOIN buckets b ON o.bucket_id = b.id "
+            "JOIN object_replicas r ON r.object_id = o.id WHERE b.name = 'bench' AND o.name = ?");
+        query.Bind("photos/IMG_" + std::to_string(pick_object(rng)) + ".jpg");
+        if (query.Next()) {
+            if (v2) {
+                nebulafs::metadata::ReadDigest(query, 0);
+                nebulafs::metadata::ReadId(query, 1);
+            } else {
+                query.Text(0);
+                query.Text(1);
+            }
+        }
+    });
+    Measure("expired_scan", lookups / 100 + 1, [&](int) {
+        auto query = db.Query(v2 ? "SELECT upload_id FROM multipart_uploads "
+                                   "WHERE state IN (1, 2) AND expires_at < ?"
+                                 : "SELECT upload_id FROM multipart_uploads "
+                                   "WHERE state IN ('initiated', 'uploading') AND expires_at < ?");
+        if (v2) {
+            nebulafs::metadata::BindTime(query, "2020-01-01T00:00:00Z");
+        } else {
+            query.Bind("2020-01-01T00:00:00Z");
+        }
+        while (query.Next()) {
+        }
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int objects = nebulafs::bench::GetIntArg(argc, argv, "--objects", 200000);
+    const int uploads = nebulafs::bench::GetIntArg(argc, argv, "--uploads", 50000);
+    const int lookups = nebulafs::bench::GetIntArg(argc, argv, "--lookups", 20000);
+
+    nebulafs::bench::ScratchDir dir("nebulafs_bench_metadata_schema");
+    const auto db_path = dir.path() / "metadata.db";
+    std::vector<std::string> upload_ids;
+    {
+        SqliteConnection db(db_path.string(), false);
+        db.Execute("PRAGMA journal_mode = WAL");
+        PopulateV1(db, objects, uploads, upload_ids);
+    }
+    const auto v1_bytes = FileBytes(db_path);
+    std::printf("v1 schema: %ju bytes\n", v1_bytes);
+    RunLookups(db_path, false, objects, upload_ids, lookups);
+
+    const auto start = nebulafs::bench::NowNanos();
+    { nebulafs::metadata::SqliteMetadataStore store(db_path.string()); }
+    const auto migrate_ms = (nebulafs::bench::NowNanos() - start) / 1'000'000;
+    const auto v2_bytes = FileBytes(db_path);
+    std::printf("v2 schema: %ju bytes (%.1f%% of v1), migration took %llu ms\n", v2_bytes,
+                100.0 * static_cast<double>(v2_bytes) / static_cast<double>(v1_bytes),
+                static_cast<unsigned long long>(migrate_ms));
+    RunLookups(db_path, true, objects, upload_ids, lookups);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Measures write throughput of ShardedMetadataStore as shards are added. Each shard is a local
+// SqliteMetadataStore with its own database file and writer thread, standing in for one
+// nebulafs_metadata instance, so the numbers isolate routing overhead and per-shard writer
+// parallelism from network cost.
+//
+// Usage: nebulafs_bench_metadata_sharding [--max-shards N] [--threads N] [--ops N]
+//                                         [--buckets N]
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "nebulafs/metadata/sharded_metadata_store.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+
+namespace {
+
+double RunWrites(nebulafs::metadata::MetadataStore& store, int threads, int ops, int buckets) {
+    std::atomic<int> next{0};
+    std::vector<std::thread> workers;
+    const auto start = nebulafs::bench::NowNanos();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int i = next++; i < ops; i = next++) {
+                nebulafs::metadata::ObjectMetadata meta;
+                meta.name = "obj-" + std::to_string(i);
+                meta.size_bytes = 1024;
+                meta.etag = "etag";
+                store.UpsertObject("bucket-" + std::to_string(i % buckets), meta);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double seconds = static_cast<double>(nebulafs::bench::NowNanos() - start) / 1e9;
+    return static_cast<double>(ops) / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int max_shards = nebulafs::bench::GetIntArg(argc, argv, "--max-shards", 4);
+    const int threads = nebulafs::bench::GetIntArg(argc, argv, "--threads", 16);
+    const int ops = nebulafs::bench::GetIntArg(argc, argv, "--ops", 20000);
+    const int buckets = nebulafs::bench::GetIntArg(argc, argv, "--buckets", 64);
+
+    std::printf("%-8s %12s %10s\n", "shards", "writes_per_s", "speedup");
+    double baseline = 0;
+    for (int shard_count = 1; shard_count <= max_shards; shard_count *= 2) {
+        nebulafs::bench::ScratchDir scratch("nebulafs_bench_metadata_sharding");
+        std::vector<std::string> endpoints;
+        for (int i = 0; i < shard_count; ++i) {
+            endpoints.push_back("shard-" + std::to_string(i));
+        }
+        nebulafs::metadata::ShardedMetadataStore store(
+            endpoints, [&scratch](const std::string& endpoint) {
+                return std::make_shared<nebulafs::metadata::SqliteMetadataStore>(
+                    (scratch.path() / (endpoint + ".db")).string());
+            });
+        for (int b = 0; b < buckets; ++b) {
+            store.CreateBucket("bucket-" + std::to_string(b));
+        }
+        const double rate = RunWrites(store, threads, ops, buckets);
+        if (baseline == 0) {
+            baseline = rate;
+        }
+        std::printf("%-8d %12.0f %9.2fx\n", shard_count, rate, rate / baseline);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Measures single-node multipart uploads with many parts: part PUT latency through the gateway
+// routes, then the latency of the complete call, for each assemble thread count. The complete
+// reads every part record in one metadata round trip, matches them in one merge walk and
+// copies parts in parallel, so its latency should track the bytes copied rather than the part
+// count. With --in-place 1 the upload declares its part size, parts are written at their
+// offsets, and complete should take the same time at any part size.
+//
+// Usage: nebulafs_bench_multipart_complete [--parts N] [--part-bytes N] [--max-threads N]
+//                                          [--in-place 0|1]
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "bench_util.h"
+#include "nebulafs/core/config.h"
+#include "nebulafs/http/route_registration.h"
+#include "nebulafs/http/router.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/storage/local_storage.h"
+
+namespace {
+
+using nebulafs::http::HttpRequest;
+
+HttpRequest MakeRequest(boost::beast::http::verb verb, const std::string& target,
+                        std::string body) {
+    HttpRequest req{verb, target, 11};
+    req.body() = std::move(body);
+    req.prepare_payload();
+    return req;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int parts = nebulafs::bench::GetIntArg(argc, argv, "--parts", 10000);
+    const int part_bytes = nebulafs::bench::GetIntArg(argc, argv, "--part-bytes", 64 * 1024);
+    const int max_threads = nebulafs::bench::GetIntArg(argc, argv, "--max-threads", 8);
+    const bool in_place = nebulafs::bench::GetIntArg(argc, argv, "--in-place", 0) != 0;
+
+    nebulafs::bench::ScratchDir dir("nebulafs_bench_multipart_complete");
+    auto metadata = std::make_shared<nebulafs::metadata::SqliteMetadataStore>(
+        (dir.path() / "metadata.db").string());
+    auto storage = std::make_shared<nebulafs::storage::LocalStorage>(
+        (dir.path() / "data").string(), (dir.path() / "tmp").string());
+    metadata->CreateBucket("bench");
+    storage->EnsureBucket("bench");
+
+    const std::string data(static_cast<std::size_t>(part_bytes), 'x');
+    std::printf("%d parts of %d bytes%s\n", parts, part_bytes, in_place ? ", in place" : "");
+    std::printf("%-8s %12s %12s %14s\n", "threads", "put p50 us", "put p99 us", "complete ms");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        nebulafs::core::Config config;
+        config.server.mode = "single_node";
+        config.storage.multipart.assemble_threads = threads;
+        nebulafs::http::Router router;
+        nebulafs::http::RegisterDefaultRoutes(router, metadata, storage, config);
+
+        const auto upload_id = "bench-upload-" + std::to_string(threads);
+        metadata->CreateMultipartUpload("bench", upload_id, "object-" + std::to_string(threads),
+                                        "2099-01-01T00:00:00Z");
+        if (in_place) {
+            nebulafs::metadata::BatchOp set_size;
+            set_size.type = nebulafs::metadata::BatchOpType::kSetMultipartPartSize;
+            set_size.upload_id = upload_id;
+            set_size.part_size = static_cast<std::uint64_t>(part_bytes);
+            metadata->ExecuteBatch({set_size});
+        }
+        const auto upload_path = "/v1/buckets/bench/multipart-uploads/" + upload_id;
+
+        nebulafs::http::RequestContext ctx;
+        nebulafs::bench::LatencySamples puts;
+        for (int part = 1; part <= parts; ++part) {
+            const auto req = MakeRequest(boost::beast::http::verb::put,
+                                         upload_path + "/parts/" + std::to_string(part), data);
+            const auto start = nebulafs::bench::NowNanos();
+            auto response = router.Route(ctx, req);
+            puts.Add(nebulafs::bench::NowNanos() - start);
+            if (!response.ok() || response.value().result_int() != 200) {
+                std::fprintf(stderr, "part %d upload failed\n", part);
+                return 1;
+            }
+        }
+
+        // Every part holds the same bytes, so they share one etag.
+        auto listed = metadata->ListMultipartParts(upload_id);
+        if (!listed.ok() || listed.value().empty()) {
+            std::fprintf(stderr, "part listing failed\n");
+            return 1;
+        }
+        std::string body = "{\"parts\":[";
+        for (int part = 1; part <= parts; ++part) {
+            body += (part > 1 ? ",{\"part_number\":" : "{\"part_number\":") +
+                    std::to_string(part) + ",\"etag\":\"" + listed.value()[0].etag + "\"}";
+        }
+        body += "]}";
+
+        const auto req =
+            MakeRequest(boost::beast::http::verb::post, upload_path + "/complete", body);
+        const auto start = nebulafs::bench::NowNanos();
+        auto response = router.Route(ctx, req);
+        const auto elapsed = nebulafs::bench::NowNanos() - start;
+        if (!response.ok() || response.value().result_int() != 200) {
+            std::fprintf(stderr, "complete failed: %s\n",
+                         response.ok() ? response.value().body().c_str() : "routing error");
+            return 1;
+        }
+        std::printf("%-8d %12.1f %12.1f %14.1f\n", threads, puts.PercentileMicros(50),
+                    puts.PercentileMicros(99), static_cast<double>(elapsed) / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Compares encode and decode cost of internal RPC bodies: the Poco::JSON object trees the
+// metadata service used to build, the schema-driven JSON writer, and the binary encoding. The
+// messages are a CommitWrite request with three replicas and a list page of N objects.
+//
+// Usage: nebulafs_bench_rpc_codec [--objects N] [--iterations N]
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+
+#include "bench_util.h"
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/metadata/metadata_rpc.h"
+
+namespace {
+
+using nebulafs::core::WireFormat;
+using nebulafs::metadata::CommitWriteRequest;
+using nebulafs::metadata::ObjectPageResponse;
+
+CommitWriteRequest MakeCommit() {
+    CommitWriteRequest request;
+    request.bucket = "bench";
+    request.object = "photos/2024/IMG_0001.jpg";
+    request.blob_id = "0f8e2c4a-5b7d-4e1f-9a3c-6d2b8e0f1a7c";
+    request.size_bytes = 4'194'304;
+    request.etag = "9b74c9897bac770ffc029102a200c5de";
+    request.replicas = {{1, 0, "http://10.0.0.1:9100"},
+                        {2, 1, "http://10.0.0.2:9100"},
+                        {3, 2, "http://10.0.0.3:9100"}};
+    return request;
+}
+
+ObjectPageResponse MakePage(int objects) {
+    ObjectPageResponse page;
+    page.objects.reserve(objects);
+    for (int i = 0; i < objects; ++i) {
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.id = i + 1;
+        meta.bucket_id = 1;
+        meta.name = "photos/2024/IMG_" + std::to_string(i) + ".jpg";
+        meta.size_bytes = 4'194'304;
+        meta.etag = "9b74c9897bac770ffc029102a200c5de";
+        meta.created_at = "2024-01-01T00:00:00Z";
+        meta.updated_at = "2024-01-01T00:00:00Z";
+        page.objects.push_back(std::move(meta));
+    }
+    page.is_truncated = true;
+    page.next_cursor = "cGhvdG9zLzIwMjQvSU1HXzk5OS5qcGc";
+    return page;
+}
+
+// The pre-codec path: build a Poco tree, stringify it, then parse it back on the other side.
+std::string PocoEncode(const CommitWriteRequest& request) {
+    Poco::JSON::Object body;
+    body.set("bucket", std::string(request.bucket));
+    body.set("object", std::string(request.object));
+    body.set("blob_id", std::string(request.blob_id));
+    body.set("size_bytes", request.size_bytes);
+    body.set("etag", std::string(request.etag));
+    Poco::JSON::Array replicas;
+    for (const auto& replica : request.replicas) {
+        Poco::JSON::Object item;
+        item.set("node_id", replica.node_id);
+        item.set("replica_index", replica.replica_index);
+        item.set("endpoint", replica.endpoint);
+        replicas.add(item);
+    }
+    body.set("replicas", replicas);
+    std::ostringstream out;
+    body.stringify(out);
+    return out.str();
+}
+
+std::string PocoEncode(const ObjectPageResponse& page) {
+    Poco::JSON::Object body;
+    Poco::JSON::Array objects;
+    for (const auto& meta : page.objects) {
+        Poco::JSON::Object item;
+        item.set("id", meta.id);
+        item.set("bucket_id", meta.bucket_id);
+        item.set("name", meta.name);
+        item.set("size_bytes", meta.size_bytes);
+        item.set("etag", meta.etag);
+        item.set("created_at", meta.created_at);
+        item.set("updated_at", meta.updated_at);
+        objects.add(item);
+    }
+    body.set("objects", objects);
+    body.set("is_truncated", page.is_truncated);
+    body.set("next_cursor", page.next_cursor);
+    std::ostringstream out;
+    body.stringify(out);
+    return out.str();
+}
+
+std::size_t PocoDecode(const std::string& body) {
+    Poco::JSON::Parser parser;
+    auto root = parser.parse(body).extract<Poco::JSON::Object::Ptr>();
+    return root->size();
+}
+
+template <typename Encode, typename Decode>
+void Measure(const char* message, const char* codec, int iterations, Encode encode,
+             Decode decode) {
+    std::size_t bytes = 0;
+    auto start = nebulafs::bench::NowNanos();
+    for (int i = 0; i < iterations; ++i) {
+        bytes = encode().size();
+    }
+    const auto encode_ns = (nebulafs::bench::NowNanos() - start) / iterations;
+
+    const auto body = encode();
+    std::size_t sink = 0;
+    start = nebulafs::bench::NowNanos();
+    for (int i = 0; i < iterations; ++i) {
+        sink += decode(body);
+    }
+    const auto decode_ns = (nebulafs::bench::NowNanos() - start) / iterations;
+
+    if (sink == 0) {
+        std::printf("%-10s %-12s decode failed\n", message, codec);
+        return;
+    }
+    std::printf("%-10s %-12s bytes=%-9zu encode_ns=%-10llu decode_ns=%llu\n", message, codec,
+                bytes, static_cast<unsigned long long>(encode_ns),
+                static_cast<unsigned long long>(decode_ns));
+}
+
+template <typename Msg>
+void MeasureAll(const char* name, const Msg& msg, int iterations) {
+    Measure(name, "poco_json", iterations, [&] { return PocoEncode(msg); },
+            [](const std::string& body) { return PocoDecode(body); });
+    for (const auto format : {WireFormat::kJson, WireFormat::kBinary}) {
+        Measure(name, format == WireFormat::kJson ? "schema_json" : "binary", iterations,
+                [&] { return nebulafs::core::EncodeWire(format, msg); },
+                [format](const std::string& body) {
+                    nebulafs::core::WireDecoder decoder(format);
+                    return decoder.Decode<Msg>(body).ok() ? std::size_t{1} : 0;
+                });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int objects = nebulafs::bench::GetIntArg(argc, argv, "--objects", 1000);
+    const int iterations = nebulafs::bench::GetIntArg(argc, argv, "--iterations", 2000);
+
+    MeasureAll("commit", MakeCommit(), iterations);
+    // Pages are large, so fewer rounds keep the run short without changing per-op numbers much.
+    MeasureAll("list_page", MakePage(objects), iterations / 20 > 0 ? iterations / 20 : 1);
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Measures PUT and GET latency of small objects through a single-node gateway over loopback,
+// with objects written to files and with objects kept inline in their metadata row. Inline
+// objects skip the temp file, fsync and rename on write and the file open on read, so both
+// percentiles should drop at sizes under the threshold.
+//
+// Usage: nebulafs_bench_small_objects [--objects N] [--object-bytes N] [--inline-max N]
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include "bench_util.h"
+#include "nebulafs/core/config.h"
+#include "nebulafs/http/http_server.h"
+#include "nebulafs/http/route_registration.h"
+#include "nebulafs/http/router.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/storage/local_storage.h"
+
+namespace {
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+unsigned short FindFreePort() {
+    boost::asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(tcp::v4(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+/// @brief Keep-alive client that reconnects when the gateway closes the connection.
+class Client {
+public:
+    explicit Client(unsigned short port) : port_(port) {}
+
+    http::response<http::string_body> Send(http::verb verb, const std::string& target,
+                                           const std::string& body) {
+        if (!stream_) {
+            stream_ = std::make_unique<boost::beast::tcp_stream>(ioc_);
+            tcp::resolver resolver(ioc_);
+            stream_->connect(resolver.resolve("127.0.0.1", std::to_string(port_)));
+        }
+        http::request<http::string_body> req{verb, target, 11};
+        req.set(http::field::host, "127.0.0.1");
+        req.keep_alive(true);
+        req.body() = body;
+        req.prepare_payload();
+        http::write(*stream_, req);
+        http::response<http::string_body> res;
+        http::read(*stream_, buffer_, res);
+        if (!res.keep_alive()) {
+            stream_.reset();
+        }
+        return res;
+    }
+
+private:
+    unsigned short port_;
+    boost::asio::io_context ioc_;
+    std::unique_ptr<boost::beast::tcp_stream> stream_;
+    boost::beast::flat_buffer buffer_;
+};
+
+bool RunMode(const std::filesystem::path& dir, int inline_max, int objects, int object_bytes) {
+    nebulafs::core::Config config;
+    config.server.host = "127.0.0.1";
+    config.server.port = FindFreePort();
+    config.server.threads = 1;
+    config.cleanup.enabled = false;
+    config.storage.inline_max_bytes = inline_max;
+
+    auto metadata = std::make_shared<nebulafs::metadata::SqliteMetadataStore>(
+        (dir / "metadata.db").string());
+    auto storage = std::make_shared<nebulafs::storage::LocalStorage>((dir / "data").string(),
+                                                                     (dir / "tmp").string());
+    metadata->CreateBucket("bench");
+    storage->EnsureBucket("bench");
+
+    nebulafs::http::Router router;
+    nebulafs::http::RegisterDefaultRoutes(router, metadata, storage, config);
+    boost::asio::io_context ioc(1);
+    nebulafs::http::HttpServer server(ioc, config, std::move(router), storage, metadata);
+    server.Run();
+    std::thread io_thread([&ioc] { ioc.run(); });
+
+    const std::string data(static_cast<std::size_t>(object_bytes), 'x');
+    Client client(static_cast<unsigned short>(config.server.port));
+    nebulafs::bench::LatencySamples puts;
+    nebulafs::bench::LatencySamples gets;
+    bool ok = true;
+    for (int i = 0; i < objects && ok; ++i) {
+        const auto target = "/v1/buckets/bench/objects/object-" + std::to_string(i);
+        auto start = nebulafs::bench::NowNanos();
+        ok = client.Send(http::verb::put, target, data).result() == http::status::ok;
+        puts.Add(nebulafs::bench::NowNanos() - start);
+        start = nebulafs::bench::NowNanos();
+        auto res = client.Send(http::verb::get, target, "");
+        gets.Add(nebulafs::bench::NowNanos() - start);
+        ok = ok && res.result() == http::status::ok && res.body().size() == data.size();
+    }
+    ioc.stop();
+    io_thread.join();
+    if (!ok) {
+        std::fprintf(stderr, "request failed with inline-max %d\n", inline_max);
+        return false;
+    }
+    std::printf("%-12d %12.1f %12.1f %12.1f %12.1f\n", inline_max, puts.PercentileMicros(50),
+                puts.PercentileMicros(99), gets.PercentileMicros(50),
+                gets.PercentileMicros(99));
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int objects = nebulafs::bench::GetIntArg(argc, argv, "--objects", 2000);
+    const int object_bytes = nebulafs::bench::GetIntArg(argc, argv, "--object-bytes", 1024);
+    const int inline_max = nebulafs::bench::GetIntArg(argc, argv, "--inline-max", 4096);
+
+    std::printf("%d objects of %d bytes\n", objects, object_bytes);
+    std::printf("%-12s %12s %12s %12s %12s\n", "inline-max", "put p50 us", "put p99 us",
+                "get p50 us", "get p99 us");
+    for (const int threshold : {0, inline_max}) {
+        nebulafs::bench::ScratchDir dir("nebulafs_bench_small_objects_" +
+                                        std::to_string(threshold));
+        if (!RunMode(dir.path(), threshold, objects, object_bytes)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Measures single-stream upload throughput through a single-node gateway over loopback, with the
+// body written and hashed on the connection's I/O thread and with the upload pipeline. The
+// pipeline overlaps receiving, writing and hashing, so on a disk that keeps up with the network
+// the pipelined rate should approach the slowest of the three rather than their sum.
+//
+// The scratch directory follows TMPDIR; point it at the disk under test (e.g. an NVMe mount).
+//
+// Usage: nebulafs_bench_upload_pipeline [--megabytes N] [--rounds N] [--threads N] [--depth N]
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include "bench_util.h"
+#include "nebulafs/core/config.h"
+#include "nebulafs/http/http_server.h"
+#include "nebulafs/http/route_registration.h"
+#include "nebulafs/http/router.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/storage/local_storage.h"
+
+namespace {
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+unsigned short FindFreePort() {
+    boost::asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(tcp::v4(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+bool RunMode(const std::filesystem::path& dir, int threads, int depth, const std::string& body,
+             int rounds) {
+    nebulafs::core::Config config;
+    config.server.host = "127.0.0.1";
+    config.server.port = FindFreePort();
+    config.server.threads = 1;
+    config.server.limits.max_body_bytes = body.size() + 1;
+    config.cleanup.enabled = false;
+    config.storage.upload_pipeline.threads = threads;
+    config.storage.upload_pipeline.depth = depth;
+
+    auto metadata = std::make_shared<nebulafs::metadata::SqliteMetadataStore>(
+        (dir / "metadata.db").string());
+    auto storage = std::make_shared<nebulafs::storage::LocalStorage>((dir / "data").string(),
+                                                                     (dir / "tmp").string());
+    metadata->CreateBucket("bench");
+    storage->EnsureBucket("bench");
+
+    nebulafs::http::Router router;
+    nebulafs::http::RegisterDefaultRoutes(router, metadata, storage, config);
+    boost::asio::io_context ioc(1);
+    nebulafs::http::HttpServer server(ioc, config, std::move(router), storage, metadata);
+    server.Run();
+    std::thread io_thread([&ioc] { ioc.run(); });
+
+    boost::asio::io_context client_ioc;
+    boost::beast::tcp_stream stream(client_ioc);
+    tcp::resolver resolver(client_ioc);
+    stream.connect(resolver.resolve("127.0.0.1", std::to_string(config.server.port)));
+    boost::beast::flat_buffer buffer;
+    nebulafs::bench::LatencySamples samples;
+    bool ok = true;
+    for (int i = 0; i < rounds && ok; ++i) {
+        http::request<http::string_body> req{http::verb::put,
+                                             "/v1/buckets/bench/objects/large-" +
+                                                 std::to_string(i),
+                                             11};
+        req.set(http::field::host, "127.0.0.1");
+        req.keep_alive(true);
+        req.body() = body;
+        req.prepare_payload();
+        const auto start = nebulafs::bench::NowNanos();
+        http::write(stream, req);
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        samples.Add(nebulafs::bench::NowNanos() - start);
+        ok = res.result() == http::status::ok;
+    }
+    ioc.stop();
+    io_thread.join();
+    if (!ok) {
+        std::fprintf(stderr, "upload failed with %d pipeline threads\n", threads);
+        return false;
+    }
+    const double megabytes = static_cast<double>(body.size()) / (1024.0 * 1024.0);
+    std::printf("%-10d %-8d %12.1f %12.1f\n", threads, depth,
+                megabytes / (samples.PercentileMicros(50) / 1e6),
+                megabytes / (samples.PercentileMicros(0) / 1e6));
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int megabytes = nebulafs::bench::GetIntArg(argc, argv, "--megabytes", 512);
+    const int rounds = nebulafs::bench::GetIntArg(argc, argv, "--rounds", 5);
+    const int threads = nebulafs::bench::GetIntArg(argc, argv, "--threads", 2);
+    const int depth = nebulafs::bench::GetIntArg(argc, argv, "--depth", 8);
+
+    std::string body(static_cast<std::size_t>(megabytes) * 1024 * 1024, '\0');
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>(i * 2654435761u >> 24);
+    }
+    std::printf("%d uploads of %d MiB\n", rounds, megabytes);
+    std::printf("%-10s %-8s %12s %12s\n", "threads", "depth", "p50 MB/s", "best MB/s");
+    for (const int mode_threads : {0, threads}) {
+        nebulafs::bench::ScratchDir dir("nebulafs_bench_upload_pipeline_" +
+                                        std::to_string(mode_threads));
+        if (!RunMode(dir.path(), mode_threads, depth, body, rounds)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace nebulafs::bench {
+
+inline std::string GetArgValue(int argc, char** argv, const std::string& key,
+                               const std::string& default_value) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (argv[i] == key) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+inline int GetIntArg(int argc, char** argv, const std::string& key, int default_value) {
+    return std::stoi(GetArgValue(argc, argv, key, std::to_string(default_value)));
+}
+
+inline std::uint64_t NowNanos() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/// @brief Latency samples in nanoseconds with percentile helpers.
+class LatencySamples {
+public:
+    void Add(std::uint64_t nanos) { samples_.push_back(nanos); }
+    void Merge(const LatencySamples& other) {
+        samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    }
+    std::size_t size() const { return samples_.size(); }
+
+    double PercentileMicros(double pct) {
+        if (samples_.empty()) {
+            return 0.0;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        const auto index = static_cast<std::size_t>(pct / 100.0 * (samples_.size() - 1));
+        return static_cast<double>(samples_[index]) / 1000.0;
+    }
+
+    double MeanMicros() const {
+        if (samples_.empty()) {
+            return 0.0;
+        }
+        long double total = 0;
+        for (auto sample : samples_) {
+            total += sample;
+        }
+        return static_cast<double>(total / samples_.size() / 1000.0);
+    }
+
+private:
+    std::vector<std::uint64_t> samples_;
+};
+
+/// @brief Scratch directory removed when the benchmark exits.
+class ScratchDir {
+public:
+    explicit ScratchDir(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~ScratchDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+}  // namespace nebulafs::bench
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace nebulafs::core {
+
+/// @brief Appends little-endian integers and length-prefixed strings to a byte buffer.
+class ByteWriter {
+public:
+    void PutU8(std::uint8_t value);
+    void PutU32(std::uint32_t value);
+    void PutU64(std::uint64_t value);
+    void PutString(std::string_view value);
+    /// @brief Append raw bytes with no length prefix.
+    void PutRaw(std::string_view bytes);
+    /// @brief Overwrite four bytes at `offset`, e.g. a length written before its payload.
+    void PatchU32(std::size_t offset, std::uint32_t value);
+
+    std::size_t size() const { return buffer_.size(); }
+
+    const std::string& data() const { return buffer_; }
+    std::string Take() { return std::move(buffer_); }
+    void Clear() { buffer_.clear(); }
+
+private:
+    std::string buffer_;
+};
+
+/// @brief Reads values written by `ByteWriter`; getters return false on truncated input.
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data) : data_(data) {}
+
+    bool GetU8(std::uint8_t& value);
+    bool GetU32(std::uint32_t& value);
+    bool GetU64(std::uint64_t& value);
+    bool GetString(std::string& value);
+    /// @brief Borrow a length-prefixed string without copying; valid while the input is.
+    bool GetView(std::string_view& value);
+
+    std::size_t remaining() const { return data_.size() - offset_; }
+    bool AtEnd() const { return offset_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    std::size_t offset_{0};
+};
+
+/// @brief CRC-32C (Castagnoli) of `data`, continuing from `crc` when chaining buffers.
+std::uint32_t Crc32c(std::string_view data, std::uint32_t crc = 0);
+/// @brief True when `Crc32c` runs on the CPU's CRC32 instruction (SSE4.2) rather than a table.
+bool Crc32cUsesHardware();
+
+}  // namespace nebulafs::core
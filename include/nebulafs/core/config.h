@@ -34,13 +34,43 @@ struct ServerConfig {
 /// @brief Storage configuration for local filesystem backend.
 struct MultipartConfig {
     int max_upload_ttl_seconds{86400};
+    /// @brief Threads copying parts into the final object on single-node complete.
+    int assemble_threads{4};
 };
 
+/// @brief Worker stages that write and hash upload bodies off the connection's I/O thread.
+struct UploadPipelineConfig {
+    /// @brief Worker threads shared by all uploads; 0 writes and hashes on the I/O thread.
+    int threads{2};
+    /// @brief 64 KiB chunks one upload may have queued in its stages before reading pauses.
+    int depth{8};
+};
+
+/// @brief Largest `storage.inline_max_bytes` accepted; bigger bodies belong in files.
+inline constexpr int kMaxInlineObjectBytes = 64 * 1024;
+
 /// @brief Storage configuration for local filesystem backend.
 struct StorageConfig {
     std::string base_path{"data"};
     std::string temp_path{"data/tmp"};
+    /// @brief Keep each distinct object body once, by SHA-256, with objects hard-linked to it.
+    /// Single-node mode only; `temp_path` must be on the same filesystem as `base_path`.
+    bool content_addressed{false};
+    /// @brief Single-node objects up to this many bytes are kept in their metadata row rather
+    /// than in a file; 0 turns inlining off. Changing it affects new writes only.
+    int inline_max_bytes{0};
+    /// @brief Buckets (`"*"` for all) whose objects fan out over hashed subdirectories instead
+    /// of one flat directory. Single-node mode only; listed buckets that hold flat objects are
+    /// migrated in the background, and a bucket never switches back.
+    std::vector<std::string> fanout_buckets;
+    /// @brief Buckets (`"*"` for all) whose single-node uploads get a CRC-32C etag rather than
+    /// SHA-256: much cheaper to compute, but not shared by the content store.
+    std::vector<std::string> crc32c_buckets;
+    /// @brief Buckets (`"*"` for all) whose single-node objects are stored as seekable
+    /// compressed frames. Etags, sizes and ranges stay those of the uncompressed bytes.
+    std::vector<std::string> compressed_buckets;
     MultipartConfig multipart;
+    UploadPipelineConfig upload_pipeline;
 };
 
 /// @brief Background cleanup settings for multipart temp data.
@@ -49,6 +79,9 @@ struct CleanupJobConfig {
     int sweep_interval_seconds{300};
     int grace_period_seconds{60};
     int max_uploads_per_sweep{200};
+    /// @brief Term of the metadata lease that lets one gateway at a time sweep; the holder
+    /// renews it each sweep, so keep it above `sweep_interval_seconds`.
+    int lease_ttl_seconds{900};
 };
 
 /// @brief Observability settings (logging).
@@ -70,10 +103,51 @@ struct AuthConfig {
 /// @brief Distributed mode connection and quorum settings.
 struct DistributedConfig {
     std::string metadata_base_url;
+    /// @brief Metadata service shards; buckets are spread across them by rendezvous hashing.
+    std::vector<std::string> metadata_shards;
+    /// @brief Optional JSON shard map (`{"shards": [...]}`) re-read while the gateway runs.
+    std::string shard_map_path;
+    int shard_map_reload_seconds{30};
     std::vector<std::string> storage_nodes;
     std::string service_auth_token;
     int replication_factor{2};
     int min_write_acks{2};
+    /// @brief Body encoding of internal RPCs: `binary` (compact, versioned) or `json`.
+    std::string rpc_format{"binary"};
+    /// @brief Events a metadata service keeps for gateways following its change feed.
+    int change_feed_retain_events{100000};
+};
+
+/// @brief Gateway cache of bucket lookups and resolved read plans (see `CachingMetadataStore`).
+struct MetadataCacheConfig {
+    bool enabled{true};
+    int bucket_ttl_ms{30000};
+    int read_plan_ttl_ms{5000};
+    /// @brief Lifetime of cached "not found" answers.
+    int negative_ttl_ms{1000};
+    std::uint64_t max_bytes{16ull * 1024 * 1024};
+    /// @brief Follow the metadata change feed to drop entries changed by other gateways.
+    bool change_feed{true};
+    /// @brief How long one change-feed read waits for new events.
+    int change_feed_wait_ms{20000};
+};
+
+/// @brief Metadata service replication: one leader and followers shipping its write log.
+struct ReplicationConfig {
+    bool enabled{false};
+    /// @brief This member's URL as the other members reach it.
+    std::string self_url;
+    /// @brief URLs of the other members.
+    std::vector<std::string> peers;
+    /// @brief Holds the replication log and persisted election state.
+    std::string state_dir{"data/replication"};
+    int election_timeout_ms{1000};
+    int heartbeat_interval_ms{200};
+    /// @brief Followers refuse reads once they last matched the leader longer ago than this.
+    int max_staleness_ms{2000};
+    /// @brief How long a follower read may wait to catch up to a requested index.
+    int read_wait_ms{500};
+    int commit_timeout_ms{5000};
 };
 
 /// @brief Top-level configuration for NebulaFS.
@@ -84,11 +158,32 @@ struct Config {
     ObservabilityConfig observability;
     AuthConfig auth;
     DistributedConfig distributed;
+    MetadataCacheConfig metadata_cache;
+    ReplicationConfig replication;
+};
+
+/// @brief Metadata database settings.
+struct DatabaseConfig {
+    /// @brief Storage engine: "sqlite" or "memory".
+    std::string engine{"sqlite"};
+    std::string path{"data/metadata.db"};
+    int reader_connections{4};
+    /// @brief Directory holding the memory engine's WAL and snapshot.
+    std::string memory_path{"data/metadata-mem"};
+    std::uint64_t snapshot_wal_bytes{64ull * 1024 * 1024};
 };
 
 /// @brief Load server configuration from a JSON file.
 Config LoadConfig(const std::string& path);
+/// @brief Load the shard endpoint list from a shard map JSON file.
+std::vector<std::string> LoadShardMap(const std::string& path);
+/// @brief Shard endpoints in effect: the shard map file, else `metadata_shards`, else the base URL.
+std::vector<std::string> MetadataShardEndpoints(const DistributedConfig& config);
+/// @brief True when a per-bucket setting list names `bucket` or holds `"*"`.
+bool IsBucketListed(const std::vector<std::string>& buckets, const std::string& bucket);
 /// @brief Load SQLite metadata DB path from a JSON file.
 std::string LoadDatabasePath(const std::string& path);
+/// @brief Load metadata engine settings from a JSON file.
+DatabaseConfig LoadDatabaseConfig(const std::string& path);
 
 }  // namespace nebulafs::core
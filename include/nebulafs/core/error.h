@@ -15,6 +15,10 @@ enum class ErrorCode {
     kUnauthorized,
     kForbidden,
     kInternal,
+    kUnavailable,
+    kFailedPrecondition,
+    /// @brief A metadata batch names buckets on different shards and cannot run atomically.
+    kCrossShard,
 };
 
 /// @brief Error payload describing a failure with a code and human-readable message.
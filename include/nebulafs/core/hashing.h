@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Avoids pulling OpenSSL headers into every file that hashes.
+struct evp_md_ctx_st;
+
+namespace nebulafs::core {
+
+/// @brief Incremental SHA-256 through OpenSSL's EVP interface, which runs the SHA-NI or AVX2
+/// code the CPU supports.
+class Sha256Hasher {
+public:
+    Sha256Hasher();
+    ~Sha256Hasher();
+    Sha256Hasher(Sha256Hasher&& other) noexcept;
+    Sha256Hasher& operator=(Sha256Hasher&& other) noexcept;
+    Sha256Hasher(const Sha256Hasher&) = delete;
+    Sha256Hasher& operator=(const Sha256Hasher&) = delete;
+
+    void Update(const void* data, std::size_t size);
+    void Update(std::string_view data) { Update(data.data(), data.size()); }
+    /// @brief Lowercase hex digest of the bytes fed so far; the hasher then starts over.
+    std::string HexDigest();
+
+private:
+    evp_md_ctx_st* ctx_{nullptr};
+};
+
+/// @brief Algorithm an object's etag is computed with.
+enum class ChecksumAlgorithm {
+    /// @brief 64 hex digits; the only etag the content store can share bodies by.
+    kSha256,
+    /// @brief 8 hex digits; detects corruption at a fraction of the cost, but is not
+    /// collision resistant.
+    kCrc32c,
+};
+
+/// @brief Incremental etag of an object body under a chosen algorithm.
+class ObjectHasher {
+public:
+    explicit ObjectHasher(ChecksumAlgorithm algorithm = ChecksumAlgorithm::kSha256);
+
+    ChecksumAlgorithm algorithm() const { return algorithm_; }
+    void Update(const void* data, std::size_t size);
+    void Update(std::string_view data) { Update(data.data(), data.size()); }
+    /// @brief Lowercase hex digest of the bytes fed so far; the hasher then starts over.
+    std::string HexDigest();
+
+private:
+    ChecksumAlgorithm algorithm_;
+    std::optional<Sha256Hasher> sha256_;
+    std::uint32_t crc32c_{0};
+};
+
+/// @brief Lowercase hex of a CRC-32C, most significant digit first.
+std::string Crc32cHex(std::uint32_t crc);
+
+/// @brief True when the CPU has the SHA extensions that OpenSSL's SHA-256 uses when present.
+bool CpuHasShaExtensions();
+
+}  // namespace nebulafs::core
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace nebulafs::core {
 
@@ -9,4 +12,30 @@ std::string NowIso8601();
 /// @brief Returns a UTC ISO8601 timestamp offset from now by delta seconds.
 std::string NowIso8601WithOffsetSeconds(int delta_seconds);
 
+/// @brief Parses an ISO8601 timestamp to Unix seconds. Accepts a bare date, a `Z` or `+HH:MM`
+/// suffix, and fractional seconds (truncated); returns nullopt for anything else.
+std::optional<std::int64_t> ParseIso8601(std::string_view text);
+/// @brief Formats Unix seconds as `YYYY-MM-DDTHH:MM:SSZ`, the form `NowIso8601()` produces.
+std::string FormatIso8601(std::int64_t epoch_seconds);
+
+/// @brief Pins `NowIso8601()` to a fixed value on the calling thread while alive.
+///
+/// Replicated metadata uses this so a follower re-applying a mutation records the leader's
+/// timestamps. Overrides nest; code that hands work to another thread carries the value over
+/// with `ClockOverride()`.
+class ScopedClockOverride {
+public:
+    explicit ScopedClockOverride(std::string now);
+    ~ScopedClockOverride();
+
+    ScopedClockOverride(const ScopedClockOverride&) = delete;
+    ScopedClockOverride& operator=(const ScopedClockOverride&) = delete;
+
+private:
+    std::optional<std::string> previous_;
+};
+
+/// @brief The calling thread's `ScopedClockOverride` value, if one is active.
+std::optional<std::string> ClockOverride();
+
 }  // namespace nebulafs::core
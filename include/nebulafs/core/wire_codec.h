@@ -0,0 +1,366 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/core/error.h"
+#include "nebulafs/core/result.h"
+
+namespace nebulafs::core {
+
+/// @brief Body encoding of an internal RPC.
+enum class WireFormat { kJson, kBinary };
+
+/// @brief Media type of the compact binary encoding; JSON bodies stay `application/json`.
+inline constexpr std::string_view kBinaryMediaType = "application/x-nebulafs-rpc";
+/// @brief First byte of every binary body; bumped only for incompatible schema changes.
+inline constexpr std::uint8_t kWireVersion = 1;
+
+std::string_view MediaTypeFor(WireFormat format);
+/// @brief Format named by a `Content-Type` or `Accept` value; anything unrecognized is JSON.
+WireFormat FormatFromMediaType(std::string_view header);
+/// @brief `binary` or `json`, as spelled in configuration; anything else is binary.
+WireFormat WireFormatFromName(std::string_view name);
+
+/// @brief One schema entry: the JSON key and the member it maps to.
+template <typename Msg, typename T>
+struct WireField {
+    std::string_view name;
+    T Msg::*member;
+};
+
+template <typename Msg, typename T>
+constexpr WireField<Msg, T> Field(std::string_view name, T Msg::*member) {
+    return {name, member};
+}
+
+/// @brief Specialize with `static constexpr auto kFields = std::make_tuple(Field(...), ...);`.
+/// Binary bodies carry fields in schema order without names, and a reader leaves fields past
+/// the end of a body at their defaults, so new fields may only be appended.
+template <typename Msg>
+struct WireSchema;
+
+/// @brief Specialize with `Name(E)` and `Parse(std::string_view, E&)` so JSON carries names.
+template <typename E>
+struct WireEnum;
+
+/// @brief Streams compact JSON text; used instead of building a `Poco::JSON` tree.
+class JsonWriter {
+public:
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(std::string_view key);
+    void Value(bool value);
+    void Value(std::int64_t value);
+    void Value(std::uint64_t value);
+    void Value(std::string_view value);
+
+    std::string Take() { return std::move(out_); }
+
+private:
+    void Separate();
+
+    std::string out_;
+    bool need_comma_{false};
+};
+
+/// @brief Read-only view of one parsed JSON object.
+class JsonReader {
+public:
+    static Result<JsonReader> Parse(std::string_view text);
+
+    bool Has(std::string_view key) const;
+    bool Get(std::string_view key, bool& value) const;
+    bool Get(std::string_view key, int& value) const;
+    bool Get(std::string_view key, std::uint64_t& value) const;
+    bool Get(std::string_view key, std::string& value) const;
+    bool GetStrings(std::string_view key, std::vector<std::string>& values) const;
+    bool GetChild(std::string_view key, JsonReader& value) const;
+    bool GetChildren(std::string_view key, std::vector<JsonReader>& values) const;
+
+private:
+    struct Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+namespace wire_detail {
+
+template <typename T>
+concept Message = requires { WireSchema<T>::kFields; };
+
+template <typename T>
+struct IsVector : std::false_type {};
+template <typename T, typename A>
+struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+void PutValue(ByteWriter& out, const T& value);
+
+template <Message Msg>
+void PutFields(ByteWriter& out, const Msg& msg) {
+    std::apply([&](const auto&... field) { (PutValue(out, msg.*(field.member)), ...); },
+               WireSchema<Msg>::kFields);
+}
+
+template <typename T>
+void PutValue(ByteWriter& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.PutU8(value ? 1 : 0);
+    } else if constexpr (std::is_enum_v<T>) {
+        out.PutU32(static_cast<std::uint32_t>(value));
+    } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+        out.PutU64(value);
+    } else if constexpr (std::is_same_v<T, int>) {
+        out.PutU32(static_cast<std::uint32_t>(value));
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        out.PutString(value);
+    } else if constexpr (IsVector<T>::value) {
+        out.PutU32(static_cast<std::uint32_t>(value.size()));
+        for (const auto& item : value) {
+            PutValue(out, item);
+        }
+    } else {
+        static_assert(Message<T>, "no wire encoding for this field type");
+        // Nested messages are length-prefixed so a reader can skip fields it does not know.
+        const auto length_at = out.size();
+        out.PutU32(0);
+        PutFields(out, value);
+        out.PatchU32(length_at, static_cast<std::uint32_t>(out.size() - length_at - 4));
+    }
+}
+
+template <typename T>
+bool GetValue(ByteReader& in, T& value);
+
+template <Message Msg>
+bool GetFields(ByteReader& in, Msg& msg) {
+    bool ok = true;
+    std::apply(
+        [&](const auto&... field) {
+            ((ok = ok && (in.AtEnd() || GetValue(in, msg.*(field.member)))), ...);
+        },
+        WireSchema<Msg>::kFields);
+    return ok;
+}
+
+template <typename T>
+bool GetValue(ByteReader& in, T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        std::uint8_t raw = 0;
+        if (!in.GetU8(raw)) {
+            return false;
+        }
+        value = raw != 0;
+        return true;
+    } else if constexpr (std::is_enum_v<T> || std::is_same_v<T, int>) {
+        std::uint32_t raw = 0;
+        if (!in.GetU32(raw)) {
+            return false;
+        }
+        value = static_cast<T>(static_cast<std::int32_t>(raw));
+        return true;
+    } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+        return in.GetU64(value);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return in.GetString(value);
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        return in.GetView(value);
+    } else if constexpr (IsVector<T>::value) {
+        std::uint32_t count = 0;
+        // Every element takes at least one byte, which bounds the allocation on corrupt input.
+        if (!in.GetU32(count) || count > in.remaining()) {
+            return false;
+        }
+        value.resize(count);
+        for (auto& item : value) {
+            if (!GetValue(in, item)) {
+                return false;
+            }
+        }
+        return true;
+    } else {
+        static_assert(Message<T>, "no wire decoding for this field type");
+        std::string_view bytes;
+        if (!in.GetView(bytes)) {
+            return false;
+        }
+        ByteReader nested(bytes);
+        return GetFields(nested, value);
+    }
+}
+
+template <typename T>
+void WriteJsonValue(JsonWriter& out, const T& value);
+
+template <Message Msg>
+void WriteJsonObject(JsonWriter& out, const Msg& msg) {
+    out.BeginObject();
+    std::apply(
+        [&](const auto&... field) {
+            ((out.Key(field.name), WriteJsonValue(out, msg.*(field.member))), ...);
+        },
+        WireSchema<Msg>::kFields);
+    out.EndObject();
+}
+
+template <typename T>
+void WriteJsonValue(JsonWriter& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.Value(value);
+    } else if constexpr (std::is_enum_v<T>) {
+        out.Value(WireEnum<T>::Name(value));
+    } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+        out.Value(value);
+    } else if constexpr (std::is_same_v<T, int>) {
+        out.Value(static_cast<std::int64_t>(value));
+    } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        out.Value(std::string_view(value));
+    } else if constexpr (IsVector<T>::value) {
+        out.BeginArray();
+        for (const auto& item : value) {
+            WriteJsonValue(out, item);
+        }
+        out.EndArray();
+    } else {
+        WriteJsonObject(out, value);
+    }
+}
+
+template <typename T>
+bool ReadJsonField(const JsonReader& in, std::string_view key, T& value,
+                   std::deque<std::string>& arena);
+
+template <Message Msg>
+bool ReadJsonObject(const JsonReader& in, Msg& msg, std::deque<std::string>& arena) {
+    bool ok = true;
+    std::apply(
+        [&](const auto&... field) {
+            ((ok = ok && (!in.Has(field.name) ||
+                          ReadJsonField(in, field.name, msg.*(field.member), arena))),
+             ...);
+        },
+        WireSchema<Msg>::kFields);
+    return ok;
+}
+
+template <typename T>
+bool ReadJsonField(const JsonReader& in, std::string_view key, T& value,
+                   std::deque<std::string>& arena) {
+    if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int> ||
+                  std::is_same_v<T, std::uint64_t> || std::is_same_v<T, std::string>) {
+        return in.Get(key, value);
+    } else if constexpr (std::is_enum_v<T>) {
+        std::string name;
+        return in.Get(key, name) && WireEnum<T>::Parse(name, value);
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        // JSON strings need unescaping, so views point at copies this decoder owns.
+        auto& owned = arena.emplace_back();
+        if (!in.Get(key, owned)) {
+            return false;
+        }
+        value = owned;
+        return true;
+    } else if constexpr (IsVector<T>::value) {
+        using Element = typename T::value_type;
+        if constexpr (std::is_same_v<Element, std::string>) {
+            return in.GetStrings(key, value);
+        } else if constexpr (std::is_same_v<Element, std::string_view>) {
+            std::vector<std::string> strings;
+            if (!in.GetStrings(key, strings)) {
+                return false;
+            }
+            value.clear();
+            for (auto& item : strings) {
+                value.push_back(arena.emplace_back(std::move(item)));
+            }
+            return true;
+        } else {
+            static_assert(Message<Element>, "no JSON decoding for this array element type");
+            std::vector<JsonReader> items;
+            if (!in.GetChildren(key, items)) {
+                return false;
+            }
+            value.resize(items.size());
+            for (std::size_t i = 0; i < items.size(); ++i) {
+                if (!ReadJsonObject(items[i], value[i], arena)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } else {
+        static_assert(Message<T>, "no JSON decoding for this field type");
+        JsonReader nested;
+        return in.GetChild(key, nested) && ReadJsonObject(nested, value, arena);
+    }
+}
+
+}  // namespace wire_detail
+
+/// @brief Serializes `msg` in `format`.
+template <typename Msg>
+std::string EncodeWire(WireFormat format, const Msg& msg) {
+    if (format == WireFormat::kBinary) {
+        ByteWriter out;
+        out.PutU8(kWireVersion);
+        wire_detail::PutFields(out, msg);
+        return out.Take();
+    }
+    JsonWriter out;
+    wire_detail::WriteJsonObject(out, msg);
+    return out.Take();
+}
+
+/// @brief Decodes bodies in one format. `std::string_view` fields borrow from the binary body
+/// or from strings this decoder owns, so keep both alive while using the message.
+class WireDecoder {
+public:
+    explicit WireDecoder(WireFormat format) : format_(format) {}
+
+    template <typename Msg>
+    Result<Msg> Decode(std::string_view body) {
+        Msg msg;
+        if (format_ == WireFormat::kBinary) {
+            ByteReader in(body);
+            std::uint8_t version = 0;
+            if (!in.GetU8(version) || version != kWireVersion) {
+                return Error{ErrorCode::kInvalidArgument,
+                             "unsupported wire version " + std::to_string(version)};
+            }
+            if (!wire_detail::GetFields(in, msg)) {
+                return Error{ErrorCode::kInvalidArgument, "truncated binary body"};
+            }
+            return msg;
+        }
+        auto root = JsonReader::Parse(body);
+        if (!root.ok()) {
+            return root.error();
+        }
+        if (!wire_detail::ReadJsonObject(root.value(), msg, arena_)) {
+            return Error{ErrorCode::kInvalidArgument, "JSON body does not match its schema"};
+        }
+        return msg;
+    }
+
+private:
+    WireFormat format_;
+    std::deque<std::string> arena_;
+};
+
+/// @brief One-shot decode for messages that own all their strings.
+template <typename Msg>
+Result<Msg> DecodeWire(WireFormat format, std::string_view body) {
+    WireDecoder decoder(format);
+    return decoder.Decode<Msg>(body);
+}
+
+}  // namespace nebulafs::core
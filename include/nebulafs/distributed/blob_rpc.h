@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "nebulafs/core/wire_codec.h"
+
+namespace nebulafs::distributed {
+
+/// @brief Body of `POST /internal/v1/blobs/batch-delete`: blobs to remove from one node.
+struct DeleteBlobsRequest {
+    std::vector<std::string_view> blob_ids;
+};
+
+struct DeleteBlobsResponse {
+    /// @brief How many of the blobs the node still had.
+    std::uint64_t deleted{0};
+};
+
+}  // namespace nebulafs::distributed
+
+namespace nebulafs::core {
+
+template <>
+struct WireSchema<distributed::DeleteBlobsRequest> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("blob_ids", &distributed::DeleteBlobsRequest::blob_ids));
+};
+
+template <>
+struct WireSchema<distributed::DeleteBlobsResponse> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("deleted", &distributed::DeleteBlobsResponse::deleted));
+};
+
+}  // namespace nebulafs::core
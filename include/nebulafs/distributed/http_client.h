@@ -15,16 +15,19 @@ struct HttpCallResult {
     std::map<std::string, std::string> headers;
 };
 
+/// @brief Send a request and buffer the response; `timeout_ms` 0 keeps Poco's default.
 core::Result<HttpCallResult> SendHttpRequest(const std::string& method,
                                              const std::string& url,
                                              const std::string& body,
                                              const std::string& content_type,
                                              const std::string& bearer_token,
-                                             const std::map<std::string, std::string>& headers);
+                                             const std::map<std::string, std::string>& headers,
+                                             int timeout_ms = 0);
 
 core::Result<HttpCallResult> SendHttpRequestStream(
     const std::string& method, const std::string& url, std::istream& body_stream,
     std::uint64_t content_length, const std::string& content_type,
-    const std::string& bearer_token, const std::map<std::string, std::string>& headers);
+    const std::string& bearer_token, const std::map<std::string, std::string>& headers,
+    int timeout_ms = 0);
 
 }  // namespace nebulafs::distributed
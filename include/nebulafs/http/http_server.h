@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 #include "nebulafs/core/config.h"
 #include "nebulafs/auth/jwt_verifier.h"
@@ -15,6 +17,9 @@
 
 namespace nebulafs::http {
 
+/// @brief Metadata lease naming the gateway that runs the multipart cleanup sweep.
+inline constexpr const char* kCleanupLeaseName = "cleanup/multipart";
+
 /// @brief HTTP server bootstrapper (acceptor + TLS context).
 class HttpServer {
 public:
@@ -27,6 +32,9 @@ private:
     void StartCleanupJob();
     void ScheduleCleanupSweep();
     void RunCleanupSweep();
+    void ReclaimStoredContent();
+    core::Result<metadata::Lease> AcquireCleanupLease();
+    void ScheduleLayoutMigration(std::chrono::milliseconds delay);
 
     boost::asio::io_context& ioc_;
     core::Config config_;
@@ -36,6 +44,13 @@ private:
     std::shared_ptr<auth::JwtVerifier> auth_verifier_;
     std::unique_ptr<boost::asio::ssl::context> ssl_context_;
     std::unique_ptr<boost::asio::steady_timer> cleanup_timer_;
+    // Drives the move of objects into fan-out buckets; idle once nothing is left to move.
+    std::unique_ptr<boost::asio::steady_timer> layout_timer_;
+    // Writes and hashes upload bodies; absent when `storage.upload_pipeline.threads` is 0.
+    std::unique_ptr<boost::asio::thread_pool> upload_pool_;
+    // Identifies this gateway in the cleanup lease.
+    std::string cleanup_holder_;
+    std::chrono::steady_clock::time_point cleanup_lease_renew_at_;
 };
 
 }  // namespace nebulafs::http
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::http {
+
+/// @brief One entry of a complete-multipart request body.
+struct CompletePart {
+    int part_number{0};
+    std::string etag;
+};
+
+/// @brief Reads `{"parts":[{"part_number":N,"etag":"..."},...]}` in one forward pass, without
+/// building a JSON tree. Other keys are skipped; part numbers must be strictly increasing.
+core::Result<std::vector<CompletePart>> ParseCompleteParts(std::string_view body);
+
+/// @brief Pairs each requested part with its uploaded record, in request order.
+///
+/// Both lists must be sorted by part number, which `ParseCompleteParts` and part listings
+/// guarantee, so this is one merge walk. Fails with `kNotFound` for a part that was never
+/// uploaded and `kFailedPrecondition` for an etag mismatch; the message names the part.
+core::Result<std::vector<const metadata::MultipartPart*>> MatchCompleteParts(
+    const std::vector<CompletePart>& requested,
+    const std::vector<metadata::MultipartPart>& uploaded);
+
+/// @brief For an upload with a declared `part_size`, checks that `parts` are numbered 1..N
+/// and that every part but the last holds exactly `part_size` bytes (the last at most that),
+/// so they already sit back to back in the upload file. Returns the object size, or
+/// `kFailedPrecondition` naming the first part out of place.
+core::Result<std::uint64_t> CheckInPlaceLayout(
+    const std::vector<const metadata::MultipartPart*>& parts, std::uint64_t part_size);
+
+/// @brief Etag of an object assembled in place: SHA-256 over the part etags in order, then
+/// `-` and the part count. It is built from the recorded part hashes, so completing an upload
+/// does not read its bytes.
+std::string CompositeEtag(const std::vector<const metadata::MultipartPart*>& parts);
+
+}  // namespace nebulafs::http
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "nebulafs/metadata/change_feed.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Lifetimes and size budget of a `CachingMetadataStore`.
+struct MetadataCacheOptions {
+    std::chrono::milliseconds bucket_ttl{30000};
+    std::chrono::milliseconds read_plan_ttl{5000};
+    /// @brief Lifetime of cached "not found" answers for buckets and objects.
+    std::chrono::milliseconds negative_ttl{1000};
+    /// @brief Approximate memory held by entries; least recently used entries go first.
+    std::uint64_t max_bytes{16ull * 1024 * 1024};
+};
+
+/// @brief Gateway-side decorator caching `GetBucket` and `ResolveRead` answers, including
+/// not-found answers.
+///
+/// Concurrent lookups of the same key share one call to the wrapped store. Writes made through
+/// this decorator drop the entries they affect before returning, so this gateway reads its own
+/// writes. Changes made by other gateways arrive through `ApplyChange` when a
+/// `ChangeFeedWatcher` follows the metadata service, and otherwise once the entry's TTL lapses.
+/// Every other call passes straight through.
+class CachingMetadataStore : public MetadataStore {
+public:
+    CachingMetadataStore(std::shared_ptr<MetadataStore> inner, MetadataCacheOptions options);
+
+    /// @brief Bytes currently charged to cached entries.
+    std::uint64_t cached_bytes() const;
+
+    /// @brief Drop the entries a change made elsewhere may have invalidated.
+    void ApplyChange(const ChangeEvent& change);
+    /// @brief Drop every entry, for when changes may have been missed.
+    void Clear();
+
+    core::Result<Bucket> CreateBucket(const std::string& name) override;
+    core::Result<std::vector<Bucket>> ListBuckets() override;
+    core::Result<Bucket> GetBucket(const std::string& name) override;
+
+    core::Result<ObjectMetadata> UpsertObject(const std::string& bucket,
+                                              const ObjectMetadata& object) override;
+    core::Result<ObjectMetadata> GetObject(const std::string& bucket,
+                                           const std::string& object) override;
+    core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
+                                                          const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
+    core::Result<void> DeleteObject(const std::string& bucket,
+                                    const std::string& object) override;
+
+    core::Result<MultipartUpload> CreateMultipartUpload(const std::string& bucket,
+                                                        const std::string& upload_id,
+                                                        const std::string& object_name,
+                                                        const std::string& expires_at) override;
+    core::Result<MultipartUpload> GetMultipartUpload(const std::string& upload_id) override;
+    core::Result<std::vector<MultipartUpload>> ListExpiredMultipartUploads(
+        const std::string& expires_before, int limit) override;
+    core::Result<void> UpdateMultipartUploadState(const std::string& upload_id,
+                                                  const std::string& state) override;
+    core::Result<void> DeleteMultipartUpload(const std::string& upload_id) override;
+
+    core::Result<MultipartPart> UpsertMultipartPart(const std::string& upload_id, int part_number,
+                                                    std::uint64_t size_bytes,
+                                                    const std::string& etag,
+                                                    const std::string& temp_path) override;
+    core::Result<std::vector<MultipartPart>> ListMultipartParts(
+        const std::string& upload_id) override;
+    core::Result<void> DeleteMultipartParts(const std::string& upload_id) override;
+
+    core::Result<void> ConfigureStorageNodes(const std::vector<std::string>& endpoints) override;
+    core::Result<AllocateWritePlan> AllocateWrite(const std::string& bucket,
+                                                  const std::string& object_name,
+                                                  int replication_factor,
+                                                  const std::string& service_token) override;
+    core::Result<void> CommitWrite(const std::string& bucket, const std::string& object_name,
+                                   const std::string& blob_id, std::uint64_t size_bytes,
+                                   const std::string& etag,
+                                   const std::vector<ReplicaTarget>& replicas) override;
+    core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
+                                              const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // A cached answer; `core::Error` holds a not-found result.
+    using Value = std::variant<core::Error, Bucket, ResolveReadPlan>;
+
+    struct Entry {
+        std::string key;
+        Value value;
+        Clock::time_point expires_at;
+        std::uint64_t bytes{0};
+    };
+
+    // One lookup in progress; later callers for the same key wait on `result`.
+    template <typename T>
+    struct Flight {
+        std::uint64_t id{0};
+        std::shared_future<core::Result<T>> result;
+    };
+
+    template <typename T>
+    using Flights = std::unordered_map<std::string, Flight<T>>;
+
+    template <typename T, typename Load>
+    core::Result<T> Lookup(const std::string& key, Flights<T>& flights, Load load);
+    template <typename T>
+    bool FindLocked(const std::string& key, core::Result<T>* out);
+    void StoreLocked(const std::string& key, Value value, std::chrono::milliseconds ttl);
+    void EraseLocked(const std::string& key);
+
+    void InvalidateBucket(const std::string& bucket);
+    void InvalidateObject(const std::string& bucket, const std::string& object_name);
+    // Drops every read plan of `bucket`, for writes whose object name is not known here.
+    void InvalidateObjects(const std::string& bucket);
+
+    std::shared_ptr<MetadataStore> inner_;
+    MetadataCacheOptions options_;
+
+    mutable std::mutex mutex_;
+    // Front is most recently used.
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    std::uint64_t bytes_{0};
+    std::uint64_t next_flight_id_{0};
+    Flights<Bucket> bucket_flights_;
+    Flights<ResolveReadPlan> read_flights_;
+};
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nebulafs::metadata {
+
+/// @brief What a change event touched.
+enum class ChangeKind {
+    kBucket,
+    /// @brief One object, or every object of the bucket when `object_name` is empty.
+    kObject,
+    kUpload,
+};
+
+std::string_view ChangeKindName(ChangeKind kind);
+std::optional<ChangeKind> ParseChangeKindName(std::string_view name);
+
+/// @brief One committed mutation, numbered in commit order.
+struct ChangeEvent {
+    std::uint64_t sequence{0};
+    ChangeKind kind{ChangeKind::kObject};
+    std::string bucket;
+    std::string object_name;
+    std::string upload_id;
+    /// @brief Wall-clock commit time in Unix milliseconds, used to measure feed lag.
+    std::uint64_t time_ms{0};
+};
+
+/// @brief Result of one `ChangeFeed::Read`.
+struct ChangePage {
+    /// @brief Resume point for the next read.
+    std::string cursor;
+    /// @brief The requested cursor is unusable (another feed or an evicted position); the
+    /// reader has missed changes and must drop everything it derived from earlier events.
+    bool reset{false};
+    std::vector<ChangeEvent> events;
+    /// @brief Sequence of the newest event in the feed.
+    std::uint64_t head{0};
+};
+
+/// @brief In-memory, sequenced log of metadata mutations that readers follow by cursor.
+///
+/// Cursors name the feed instance as well as a position, so a reader that reconnects to a
+/// restarted service or another replica learns that it must start over. Only the newest
+/// `retain_events` stay readable. Thread-safe.
+class ChangeFeed {
+public:
+    static constexpr std::size_t kDefaultRetainEvents = 100000;
+
+    explicit ChangeFeed(std::size_t retain_events = kDefaultRetainEvents);
+
+    void Append(ChangeKind kind, std::string bucket, std::string object_name = {},
+                std::string upload_id = {});
+
+    /// @brief Up to `max_events` events after `cursor`, waiting up to `wait_ms` for the first
+    /// one. An empty cursor starts at the head with `reset` set.
+    ChangePage Read(std::string_view cursor, std::size_t max_events, int wait_ms);
+
+    std::uint64_t head() const;
+
+private:
+    std::string CursorAt(std::uint64_t sequence) const;
+
+    const std::size_t retain_events_;
+    const std::string epoch_;
+    mutable std::mutex mutex_;
+    std::condition_variable appended_;
+    std::deque<ChangeEvent> events_;
+    std::uint64_t head_{0};
+};
+
+}  // namespace nebulafs::metadata
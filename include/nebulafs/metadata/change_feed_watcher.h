@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/metadata/caching_metadata_store.h"
+#include "nebulafs/metadata/change_feed.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Follows the change feed of every metadata endpoint and applies it to a gateway's
+/// `CachingMetadataStore`.
+///
+/// One thread per endpoint long-polls its feed. A reset, or a failed poll, clears the whole
+/// cache, since changes may have been missed; entries cached while a feed is unreachable are
+/// therefore dropped again on each retry.
+class ChangeFeedWatcher {
+public:
+    /// @brief Reads the feed after `cursor`, waiting up to `wait_ms` for events.
+    using Source = std::function<core::Result<ChangePage>(const std::string& cursor, int wait_ms)>;
+    using SourceFactory = std::function<Source(const std::string& endpoint)>;
+
+    ChangeFeedWatcher(std::shared_ptr<CachingMetadataStore> cache, SourceFactory factory,
+                      int wait_ms);
+    ~ChangeFeedWatcher();
+
+    ChangeFeedWatcher(const ChangeFeedWatcher&) = delete;
+    ChangeFeedWatcher& operator=(const ChangeFeedWatcher&) = delete;
+
+    /// @brief Start following new endpoints and stop following ones no longer listed.
+    void SetEndpoints(const std::vector<std::string>& endpoints);
+
+private:
+    struct Poller {
+        std::shared_ptr<std::atomic<bool>> stop;
+        std::thread thread;
+    };
+
+    std::shared_ptr<CachingMetadataStore> cache_;
+    SourceFactory factory_;
+    int wait_ms_;
+    std::mutex mutex_;
+    std::map<std::string, Poller> pollers_;
+};
+
+}  // namespace nebulafs::metadata
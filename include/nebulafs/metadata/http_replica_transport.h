@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "nebulafs/metadata/replica_group.h"
+
+namespace nebulafs::metadata {
+
+/// @brief `ReplicaTransport` over the metadata service's `/internal/v1/replication/*` routes.
+class HttpReplicaTransport : public ReplicaTransport {
+public:
+    /// @brief `timeout_ms` bounds each RPC beyond any long-poll wait; keep it under the election
+    /// timeout so one dead peer cannot stall heartbeats to the others.
+    HttpReplicaTransport(std::string service_auth_token, int timeout_ms);
+
+    core::Result<VoteResponse> RequestVote(const std::string& peer,
+                                           const VoteRequest& request) override;
+    core::Result<HeartbeatResponse> Heartbeat(const std::string& peer,
+                                              const HeartbeatRequest& request) override;
+    core::Result<FetchResponse> Fetch(const std::string& leader,
+                                      const FetchRequest& request) override;
+
+private:
+    std::string service_auth_token_;
+    int timeout_ms_;
+};
+
+/// @brief Binary body of the entries route; shared by the service and the transport.
+std::string EncodeFetchResponse(const FetchResponse& response);
+core::Result<FetchResponse> DecodeFetchResponse(std::string_view body);
+
+}  // namespace nebulafs::metadata
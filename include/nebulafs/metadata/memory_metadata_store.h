@@ -0,0 +1,196 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/metadata/metadata_store.h"
+#include "nebulafs/metadata/ordered_index.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Metadata store serving from in-memory B+trees, made durable by a write-ahead log.
+///
+/// Every mutation is applied in memory and appended to `<dir>/wal`; callers return once a
+/// group-committed fsync covers their record. Reads wait for the records already applied to
+/// reach disk, and fail once the WAL has. The log is folded into `<dir>/snapshot` once it
+/// grows past `snapshot_wal_bytes`; the snapshot is copied a chunk at a time while writes go
+/// on, and only the records after it are kept in the log.
+class MemoryMetadataStore : public MetadataStore {
+public:
+    /// @brief Default WAL size that triggers a snapshot.
+    static constexpr std::uint64_t kDefaultSnapshotWalBytes = 64ull * 1024 * 1024;
+
+    /// @brief Recover state from `directory` (created if missing) and open the WAL for append.
+    explicit MemoryMetadataStore(const std::string& directory,
+                                 std::uint64_t snapshot_wal_bytes = kDefaultSnapshotWalBytes);
+    ~MemoryMetadataStore() override;
+
+    MemoryMetadataStore(const MemoryMetadataStore&) = delete;
+    MemoryMetadataStore& operator=(const MemoryMetadataStore&) = delete;
+
+    /// @brief Write a snapshot now and truncate the WAL.
+    core::Result<void> Checkpoint();
+
+    core::Result<Bucket> CreateBucket(const std::string& name) override;
+    core::Result<std::vector<Bucket>> ListBuckets() override;
+    core::Result<Bucket> GetBucket(const std::string& name) override;
+
+    core::Result<ObjectMetadata> UpsertObject(const std::string& bucket,
+                                              const ObjectMetadata& object) override;
+    core::Result<ObjectMetadata> GetObject(const std::string& bucket,
+                                           const std::string& object) override;
+    core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
+                                                          const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
+    core::Result<void> DeleteObject(const std::string& bucket,
+                                    const std::string& object) override;
+
+    core::Result<MultipartUpload> CreateMultipartUpload(const std::string& bucket,
+                                                        const std::string& upload_id,
+                                                        const std::string& object_name,
+                                                        const std::string& expires_at) override;
+    core::Result<MultipartUpload> GetMultipartUpload(const std::string& upload_id) override;
+    core::Result<std::vector<MultipartUpload>> ListExpiredMultipartUploads(
+        const std::string& expires_before, int limit) override;
+    core::Result<void> UpdateMultipartUploadState(const std::string& upload_id,
+                                                  const std::string& state) override;
+    core::Result<void> DeleteMultipartUpload(const std::string& upload_id) override;
+
+    core::Result<MultipartPart> UpsertMultipartPart(const std::string& upload_id, int part_number,
+                                                    std::uint64_t size_bytes,
+                                                    const std::string& etag,
+                                                    const std::string& temp_path) override;
+    core::Result<std::vector<MultipartPart>> ListMultipartParts(
+        const std::string& upload_id) override;
+    core::Result<void> DeleteMultipartParts(const std::string& upload_id) override;
+
+    core::Result<void> ConfigureStorageNodes(const std::vector<std::string>& endpoints) override;
+    core::Result<AllocateWritePlan> AllocateWrite(const std::string& bucket,
+                                                  const std::string& object_name,
+                                                  int replication_factor,
+                                                  const std::string& service_token) override;
+    core::Result<void> CommitWrite(const std::string& bucket, const std::string& object_name,
+                                   const std::string& blob_id, std::uint64_t size_bytes,
+                                   const std::string& etag,
+                                   const std::vector<ReplicaTarget>& replicas) override;
+    core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
+                                              const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
+
+private:
+    struct ObjectEntry {
+        ObjectMetadata meta;
+        std::string blob_id;
+        // Endpoints are resolved from `nodes_` at read time, like the SQLite join.
+        std::vector<ReplicaTarget> replicas;
+        // Set instead of `blob_id` and `replicas` for a composite object.
+        std::vector<ManifestSegment> segments;
+        // Kept beside `meta` so listings copy only the metadata.
+        std::optional<std::string> inline_data;
+    };
+
+    struct UploadEntry {
+        MultipartUpload upload;
+        std::map<int, MultipartPart> parts;
+    };
+
+    void Recover();
+    /// @brief Decode one log record and apply it to the in-memory state.
+    bool ApplyRecord(std::string_view payload);
+    /// @brief Apply `record` and queue it for the WAL; caller holds `state_mutex_` exclusively.
+    std::uint64_t Commit(const core::ByteWriter& record);
+    /// @brief Queue an already-applied record for the WAL and return its LSN.
+    std::uint64_t AppendToWal(std::string_view record);
+    /// @brief Helpers shared by single calls and batches; caller holds `state_mutex_`.
+    core::Result<AllocateWritePlan> PlanWrite(const std::string& bucket,
+                                              const std::string& object_name,
+                                              int replication_factor,
+                                              const std::string& service_token);
+    core::Result<void> BuildCommitRecord(const std::string& bucket,
+                                         const std::string& object_name,
+                                         const std::string& blob_id, std::uint64_t size_bytes,
+                                         const std::string& etag,
+                                         const std::vector<ReplicaTarget>& replicas,
+                                         const std::vector<ManifestSegment>& segments,
+                                         core::ByteWriter& record);
+    /// @brief Record committing `object_name` in `op.bucket` with the blobs of `op`'s source.
+    core::Result<void> BuildCopyRecord(const BatchOp& op, const std::string& object_name,
+                                       core::ByteWriter& record);
+    /// @brief Read plan of `entry` with node endpoints filled in; fails like `ResolveRead`
+    /// when no replica of some blob is on a known node.
+    core::Result<ResolveReadPlan> PlanRead(const ObjectEntry& entry) const;
+    /// @brief Adds `delta` to the reference count of each blob `entry` points at.
+    void CountBlobs(const ObjectEntry& entry, int delta);
+    /// @brief Encodes a new upload into `record`, failing if the bucket is missing or the
+    /// upload exists; returns the upload the record describes.
+    core::Result<MultipartUpload> BuildUploadRecord(const std::string& bucket,
+                                                    const std::string& upload_id,
+                                                    const std::string& object_name,
+                                                    const std::string& expires_at,
+                                                    core::ByteWriter& record);
+    core::Result<void> BuildUploadStateRecord(const std::string& upload_id,
+                                              const std::string& state,
+                                              core::ByteWriter& record);
+    /// @brief Usage of `bucket_id` counted from its rows, ignoring `stats_`.
+    BucketStats CountBucket(int bucket_id);
+    /// @brief Block until `lsn` is on disk, flushing pending records if no one else is.
+    core::Result<void> WaitDurable(std::uint64_t lsn);
+    /// @brief Block until every applied record is on disk, so a read never returns a write a
+    /// crash would undo; fails once the WAL has. Caller holds `state_mutex_` shared.
+    core::Result<void> WaitReadable();
+    core::Result<void> WriteSnapshot();
+    void SnapshotLoop();
+
+    std::string directory_;
+    std::uint64_t snapshot_wal_bytes_;
+
+    // Guards all in-memory state below; writers also hold it while appending so WAL order
+    // matches apply order.
+    std::shared_mutex state_mutex_;
+    OrderedIndex<Bucket> buckets_;
+    OrderedIndex<ObjectEntry> objects_;
+    std::unordered_map<std::string, UploadEntry> uploads_;
+    std::vector<StorageNodeRecord> nodes_;
+    std::map<std::string, Lease> leases_;
+    // Derived from the rows by `ApplyRecord`, so recovery rebuilds it and the WAL never holds it.
+    std::unordered_map<int, BucketStats> stats_;
+    // Objects pointing at each blob id, derived the same way. Only copies share blobs.
+    std::unordered_map<std::string, std::uint64_t> blob_refs_;
+    int next_bucket_id_{1};
+    int next_object_id_{1};
+    int next_upload_id_{1};
+    int next_part_id_{1};
+    int next_node_id_{1};
+
+    // Group commit: appends accumulate in `pending_` while one caller flushes the previous batch.
+    std::mutex wal_mutex_;
+    std::condition_variable wal_cv_;
+    int wal_fd_{-1};
+    std::string pending_;
+    std::uint64_t appended_lsn_{0};
+    std::uint64_t durable_lsn_{0};
+    std::uint64_t wal_bytes_{0};
+    bool flushing_{false};
+    bool wal_failed_{false};
+
+    std::mutex checkpoint_mutex_;
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    bool snapshot_requested_{false};
+    bool stopping_{false};
+    std::thread snapshot_thread_;
+};
+
+}  // namespace nebulafs::metadata
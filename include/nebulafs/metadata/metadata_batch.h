@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Largest batch the metadata service accepts in one request; also the most keys one
+/// bulk delete names, so its rows go in a single transaction.
+constexpr std::size_t kMaxBatchOps = 1000;
+
+/// @brief Wire name of an op type, e.g. `commit_write`.
+std::string_view BatchOpName(BatchOpType type);
+std::optional<BatchOpType> ParseBatchOpName(std::string_view name);
+
+/// @brief True when no op in `ops` changes metadata.
+bool IsReadOnlyBatch(const std::vector<BatchOp>& ops);
+
+/// @brief `error` prefixed with the failing op's position and name.
+core::Error BatchOpError(std::size_t index, const BatchOp& op, const core::Error& error);
+
+/// @brief Checks `op.expect_upload_state` against the upload's current state.
+core::Result<void> CheckUploadState(const BatchOp& op, const std::string& actual_state);
+
+/// @brief True for `kCommitWrite` and `kCommitManifest`, the ops that replace an object.
+bool IsCommitOp(const BatchOp& op);
+
+/// @brief True for the ops that replace or remove the object `op.object_name` names: commits,
+/// copies and deletes.
+bool ChangesObject(const BatchOp& op);
+
+/// @brief Checks that `kCommitManifest` op `op` lists segments back to back from offset 0,
+/// each with a blob and a replica, adding up to `op.size_bytes`.
+core::Result<void> CheckManifest(const BatchOp& op);
+
+/// @brief True for `kAcquireLease` and `kCheckLease`.
+bool IsLeaseOp(const BatchOp& op);
+
+/// @brief `op.now_ms`, or the current Unix time in milliseconds when it is unset.
+std::uint64_t LeaseClock(const BatchOp& op);
+
+/// @brief The lease after `kAcquireLease` op `op`, given the stored one (if any); fails with
+/// `kFailedPrecondition` while another holder's term is unexpired.
+core::Result<Lease> AcquireLease(const BatchOp& op, const Lease* current);
+
+/// @brief Runs `kCheckLease` op `op` against the stored lease.
+core::Result<void> CheckLease(const BatchOp& op, const Lease* current);
+
+/// @brief A `kCheckLease` op for `lease`, to lead a batch of writes the lease guards.
+BatchOp LeaseCheckOp(const Lease& lease);
+
+}  // namespace nebulafs::metadata
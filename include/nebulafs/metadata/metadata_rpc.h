@@ -0,0 +1,384 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/metadata/change_feed.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+// Message schemas of the metadata service's `/internal/v1/` routes, shared by the service and
+// `RemoteMetadataStore`. Request messages hold `std::string_view` fields so the service decodes
+// binary bodies without copying; keys match the JSON bodies the routes have always taken.
+
+namespace nebulafs::metadata {
+
+struct AckResponse {
+    bool ok{true};
+};
+
+struct BucketListResponse {
+    std::vector<Bucket> buckets;
+};
+
+struct ObjectPageResponse {
+    std::vector<ObjectMetadata> objects;
+    std::vector<std::string> common_prefixes;
+    bool is_truncated{false};
+    /// @brief `EncodeListCursor` token, so JSON bodies can carry arbitrary key bytes.
+    std::string next_cursor;
+};
+
+struct UploadListResponse {
+    std::vector<MultipartUpload> uploads;
+};
+
+struct PartListResponse {
+    std::vector<MultipartPart> parts;
+};
+
+struct BatchResponse {
+    std::vector<BatchOpResult> results;
+};
+
+/// @brief Reply of `GET /internal/v1/changes`; mirrors `ChangePage`.
+struct ChangesResponse {
+    std::string cursor;
+    bool reset{false};
+    std::vector<ChangeEvent> events;
+    std::uint64_t head{0};
+};
+
+struct CreateBucketRequest {
+    std::string_view name;
+};
+
+struct UpsertObjectRequest {
+    std::string_view bucket;
+    std::string_view name;
+    std::uint64_t size_bytes{0};
+    std::string_view etag;
+};
+
+struct CreateUploadRequest {
+    std::string_view bucket;
+    std::string_view upload_id;
+    std::string_view object;
+    std::string_view expires_at;
+};
+
+struct UploadStateRequest {
+    std::string_view upload_id;
+    std::string_view state;
+};
+
+struct UpsertPartRequest {
+    std::string_view upload_id;
+    int part_number{0};
+    std::uint64_t size_bytes{0};
+    std::string_view etag;
+    std::string_view temp_path;
+};
+
+struct ConfigureNodesRequest {
+    std::vector<std::string> endpoints;
+};
+
+struct AllocateWriteRequest {
+    std::string_view bucket;
+    std::string_view object;
+    int replication_factor{0};
+    std::string_view service_token;
+};
+
+struct CommitWriteRequest {
+    std::string_view bucket;
+    std::string_view object;
+    std::string_view blob_id;
+    std::uint64_t size_bytes{0};
+    std::string_view etag;
+    std::vector<ReplicaTarget> replicas;
+};
+
+struct BatchRequest {
+    std::vector<BatchOp> ops;
+};
+
+}  // namespace nebulafs::metadata
+
+namespace nebulafs::core {
+
+template <>
+struct WireEnum<metadata::BatchOpType> {
+    static std::string_view Name(metadata::BatchOpType type) {
+        return metadata::BatchOpName(type);
+    }
+    static bool Parse(std::string_view name, metadata::BatchOpType& type) {
+        const auto parsed = metadata::ParseBatchOpName(name);
+        if (parsed) {
+            type = *parsed;
+        }
+        return parsed.has_value();
+    }
+};
+
+template <>
+struct WireEnum<metadata::ChangeKind> {
+    static std::string_view Name(metadata::ChangeKind kind) {
+        return metadata::ChangeKindName(kind);
+    }
+    static bool Parse(std::string_view name, metadata::ChangeKind& kind) {
+        const auto parsed = metadata::ParseChangeKindName(name);
+        if (parsed) {
+            kind = *parsed;
+        }
+        return parsed.has_value();
+    }
+};
+
+template <>
+struct WireSchema<metadata::Bucket> {
+    using M = metadata::Bucket;
+    static constexpr auto kFields = std::make_tuple(
+        Field("id", &M::id), Field("name", &M::name), Field("created_at", &M::created_at));
+};
+
+template <>
+struct WireSchema<metadata::ObjectMetadata> {
+    using M = metadata::ObjectMetadata;
+    static constexpr auto kFields =
+        std::make_tuple(Field("id", &M::id), Field("bucket_id", &M::bucket_id),
+                        Field("name", &M::name), Field("size_bytes", &M::size_bytes),
+                        Field("etag", &M::etag), Field("created_at", &M::created_at),
+                        Field("updated_at", &M::updated_at));
+};
+
+template <>
+struct WireSchema<metadata::MultipartUpload> {
+    using M = metadata::MultipartUpload;
+    static constexpr auto kFields = std::make_tuple(
+        Field("id", &M::id), Field("upload_id", &M::upload_id), Field("bucket_id", &M::bucket_id),
+        Field("object_name", &M::object_name), Field("state", &M::state),
+        Field("expires_at", &M::expires_at), Field("created_at", &M::created_at),
+        Field("updated_at", &M::updated_at), Field("part_size", &M::part_size));
+};
+
+template <>
+struct WireSchema<metadata::MultipartPart> {
+    using M = metadata::MultipartPart;
+    static constexpr auto kFields =
+        std::make_tuple(Field("id", &M::id), Field("upload_id", &M::upload_id),
+                        Field("part_number", &M::part_number), Field("size_bytes", &M::size_bytes),
+                        Field("etag", &M::etag), Field("temp_path", &M::temp_path),
+                        Field("created_at", &M::created_at));
+};
+
+template <>
+struct WireSchema<metadata::ReplicaTarget> {
+    using M = metadata::ReplicaTarget;
+    static constexpr auto kFields =
+        std::make_tuple(Field("node_id", &M::node_id), Field("replica_index", &M::replica_index),
+                        Field("endpoint", &M::endpoint));
+};
+
+template <>
+struct WireSchema<metadata::AllocateWritePlan> {
+    using M = metadata::AllocateWritePlan;
+    static constexpr auto kFields =
+        std::make_tuple(Field("blob_id", &M::blob_id), Field("write_token", &M::write_token),
+                        Field("replicas", &M::replicas));
+};
+
+template <>
+struct WireSchema<metadata::ManifestSegment> {
+    using M = metadata::ManifestSegment;
+    static constexpr auto kFields =
+        std::make_tuple(Field("blob_id", &M::blob_id), Field("offset", &M::offset),
+                        Field("size_bytes", &M::size_bytes), Field("etag", &M::etag),
+                        Field("replicas", &M::replicas));
+};
+
+template <>
+struct WireSchema<metadata::ResolveReadPlan> {
+    using M = metadata::ResolveReadPlan;
+    static constexpr auto kFields =
+        std::make_tuple(Field("blob_id", &M::blob_id), Field("etag", &M::etag),
+                        Field("size_bytes", &M::size_bytes), Field("replicas", &M::replicas),
+                        Field("segments", &M::segments));
+};
+
+template <>
+struct WireSchema<metadata::BatchOp> {
+    using M = metadata::BatchOp;
+    static constexpr auto kFields = std::make_tuple(
+        Field("op", &M::type), Field("bucket", &M::bucket), Field("object", &M::object_name),
+        Field("upload_id", &M::upload_id), Field("state", &M::state),
+        Field("expect_upload_state", &M::expect_upload_state),
+        Field("replication_factor", &M::replication_factor),
+        Field("service_token", &M::service_token), Field("blob_id", &M::blob_id),
+        Field("size_bytes", &M::size_bytes), Field("etag", &M::etag),
+        Field("replicas", &M::replicas), Field("lease", &M::lease),
+        Field("lease_holder", &M::lease_holder), Field("lease_ttl_ms", &M::lease_ttl_ms),
+        Field("fencing_token", &M::fencing_token),
+        Field("part_number_marker", &M::part_number_marker), Field("max_parts", &M::max_parts),
+        Field("part_size", &M::part_size), Field("segments", &M::segments),
+        Field("source_bucket", &M::source_bucket), Field("source_object", &M::source_object),
+        Field("expires_at", &M::expires_at));
+};
+
+template <>
+struct WireSchema<metadata::Lease> {
+    using M = metadata::Lease;
+    static constexpr auto kFields =
+        std::make_tuple(Field("name", &M::name), Field("holder", &M::holder),
+                        Field("fencing_token", &M::fencing_token),
+                        Field("expires_at_ms", &M::expires_at_ms));
+};
+
+template <>
+struct WireSchema<metadata::BucketStats> {
+    using M = metadata::BucketStats;
+    static constexpr auto kFields =
+        std::make_tuple(Field("object_count", &M::object_count),
+                        Field("total_bytes", &M::total_bytes),
+                        Field("multipart_bytes", &M::multipart_bytes));
+};
+
+template <>
+struct WireSchema<metadata::BatchOpResult> {
+    using M = metadata::BatchOpResult;
+    static constexpr auto kFields = std::make_tuple(
+        Field("bucket", &M::bucket), Field("upload", &M::upload), Field("parts", &M::parts),
+        Field("write_plan", &M::write_plan), Field("lease", &M::lease),
+        Field("stats", &M::stats), Field("read_plan", &M::read_plan),
+        Field("blob_references", &M::blob_references), Field("removed", &M::removed));
+};
+
+template <>
+struct WireSchema<metadata::AckResponse> {
+    static constexpr auto kFields = std::make_tuple(Field("ok", &metadata::AckResponse::ok));
+};
+
+template <>
+struct WireSchema<metadata::BucketListResponse> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("buckets", &metadata::BucketListResponse::buckets));
+};
+
+template <>
+struct WireSchema<metadata::ObjectPageResponse> {
+    using M = metadata::ObjectPageResponse;
+    static constexpr auto kFields =
+        std::make_tuple(Field("objects", &M::objects),
+                        Field("common_prefixes", &M::common_prefixes),
+                        Field("is_truncated", &M::is_truncated),
+                        Field("next_cursor", &M::next_cursor));
+};
+
+template <>
+struct WireSchema<metadata::UploadListResponse> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("uploads", &metadata::UploadListResponse::uploads));
+};
+
+template <>
+struct WireSchema<metadata::PartListResponse> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("parts", &metadata::PartListResponse::parts));
+};
+
+template <>
+struct WireSchema<metadata::BatchResponse> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("results", &metadata::BatchResponse::results));
+};
+
+template <>
+struct WireSchema<metadata::ChangeEvent> {
+    using M = metadata::ChangeEvent;
+    static constexpr auto kFields = std::make_tuple(
+        Field("sequence", &M::sequence), Field("kind", &M::kind), Field("bucket", &M::bucket),
+        Field("object", &M::object_name), Field("upload_id", &M::upload_id),
+        Field("time_ms", &M::time_ms));
+};
+
+template <>
+struct WireSchema<metadata::ChangesResponse> {
+    using M = metadata::ChangesResponse;
+    static constexpr auto kFields =
+        std::make_tuple(Field("cursor", &M::cursor), Field("reset", &M::reset),
+                        Field("events", &M::events), Field("head", &M::head));
+};
+
+template <>
+struct WireSchema<metadata::CreateBucketRequest> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("name", &metadata::CreateBucketRequest::name));
+};
+
+template <>
+struct WireSchema<metadata::UpsertObjectRequest> {
+    using M = metadata::UpsertObjectRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("bucket", &M::bucket), Field("name", &M::name),
+                        Field("size_bytes", &M::size_bytes), Field("etag", &M::etag));
+};
+
+template <>
+struct WireSchema<metadata::CreateUploadRequest> {
+    using M = metadata::CreateUploadRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("bucket", &M::bucket), Field("upload_id", &M::upload_id),
+                        Field("object", &M::object), Field("expires_at", &M::expires_at));
+};
+
+template <>
+struct WireSchema<metadata::UploadStateRequest> {
+    using M = metadata::UploadStateRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("upload_id", &M::upload_id), Field("state", &M::state));
+};
+
+template <>
+struct WireSchema<metadata::UpsertPartRequest> {
+    using M = metadata::UpsertPartRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("upload_id", &M::upload_id), Field("part_number", &M::part_number),
+                        Field("size_bytes", &M::size_bytes), Field("etag", &M::etag),
+                        Field("temp_path", &M::temp_path));
+};
+
+template <>
+struct WireSchema<metadata::ConfigureNodesRequest> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("endpoints", &metadata::ConfigureNodesRequest::endpoints));
+};
+
+template <>
+struct WireSchema<metadata::AllocateWriteRequest> {
+    using M = metadata::AllocateWriteRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("bucket", &M::bucket), Field("object", &M::object),
+                        Field("replication_factor", &M::replication_factor),
+                        Field("service_token", &M::service_token));
+};
+
+template <>
+struct WireSchema<metadata::CommitWriteRequest> {
+    using M = metadata::CommitWriteRequest;
+    static constexpr auto kFields =
+        std::make_tuple(Field("bucket", &M::bucket), Field("object", &M::object),
+                        Field("blob_id", &M::blob_id), Field("size_bytes", &M::size_bytes),
+                        Field("etag", &M::etag), Field("replicas", &M::replicas));
+};
+
+template <>
+struct WireSchema<metadata::BatchRequest> {
+    static constexpr auto kFields = std::make_tuple(Field("ops", &metadata::BatchRequest::ops));
+};
+
+}  // namespace nebulafs::core
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,37 @@ struct ObjectMetadata {
     std::string etag;
     std::string created_at;
     std::string updated_at;
+    /// @brief Body of a small single-node object kept in its metadata row instead of a file.
+    /// Upserts replace it (unset clears it); `GetObject` returns it and listings leave it out.
+    /// The local stores keep it; RPC and replication do not carry it.
+    std::optional<std::string> inline_data;
+};
+
+/// @brief Paging and grouping options for an object listing.
+struct ListObjectsOptions {
+    std::string prefix;
+    /// @brief When set, keys sharing the text up to the next delimiter collapse to one prefix.
+    std::string delimiter;
+    /// @brief Inclusive resume key taken from a previous page's `next_cursor`.
+    std::string cursor;
+    int max_keys{1000};
+};
+
+/// @brief One page of objects and common prefixes in name order.
+struct ObjectListing {
+    std::vector<ObjectMetadata> objects;
+    std::vector<std::string> common_prefixes;
+    bool is_truncated{false};
+    /// @brief Resume key for the next page; empty unless `is_truncated`.
+    std::string next_cursor;
+};
+
+/// @brief Usage counters of one bucket, kept current by every write that touches it.
+struct BucketStats {
+    std::uint64_t object_count{0};
+    std::uint64_t total_bytes{0};
+    /// @brief Bytes held by parts of multipart uploads not yet completed or aborted.
+    std::uint64_t multipart_bytes{0};
 };
 
 /// @brief In-progress multipart upload metadata.
@@ -43,6 +75,9 @@ struct MultipartUpload {
     std::string expires_at;
     std::string created_at;
     std::string updated_at;
+    /// @brief Size of every part but the last, when the client declared it at initiate; 0 if
+    /// not. Single-node parts of such an upload are written at their offsets in one file.
+    std::uint64_t part_size{0};
 };
 
 /// @brief Metadata for a single uploaded part.
@@ -77,12 +112,135 @@ struct AllocateWritePlan {
     std::vector<ReplicaTarget> replicas;
 };
 
+/// @brief One stretch of a composite object: the whole of blob `blob_id`, placed at `offset`.
+///
+/// Commits name each replica's node by `endpoint`, as part locators do; the store resolves
+/// the node id. Read plans fill in both.
+struct ManifestSegment {
+    std::string blob_id;
+    std::uint64_t offset{0};
+    std::uint64_t size_bytes{0};
+    std::string etag;
+    std::vector<ReplicaTarget> replicas;
+};
+
 /// @brief Resolved read plan for a distributed object.
 struct ResolveReadPlan {
     std::string blob_id;
     std::string etag;
     std::uint64_t size_bytes{0};
     std::vector<ReplicaTarget> replicas;
+    /// @brief For a composite object, its segments in offset order; `blob_id` and `replicas`
+    /// are then empty.
+    std::vector<ManifestSegment> segments;
+};
+
+/// @brief Operations that may be combined with `MetadataStore::ExecuteBatch`.
+enum class BatchOpType {
+    kGetBucket,
+    kGetMultipartUpload,
+    kListMultipartParts,
+    kAllocateWrite,
+    kCommitWrite,
+    kUpdateMultipartUploadState,
+    kDeleteMultipartParts,
+    kDeleteMultipartUpload,
+    /// @brief Take lease `lease` for `lease_holder`, or extend it if that holder already has it.
+    kAcquireLease,
+    /// @brief Fail with `kFailedPrecondition` unless `lease_holder` still holds `lease` under
+    /// `fencing_token`; put it before the writes the lease guards.
+    kCheckLease,
+    /// @brief Read the usage counters of `bucket`.
+    kGetBucketStats,
+    /// @brief Recount the usage counters of `bucket` from its objects and parts.
+    kRepairBucketStats,
+    /// @brief Record `part_size` as the declared part size of upload `upload_id`.
+    kSetMultipartPartSize,
+    /// @brief Commit the object as a composite of `segments`, which must cover `size_bytes`
+    /// bytes from offset 0 in order. Like `kCommitWrite`, an empty `object_name` means the
+    /// object of upload `upload_id`.
+    kCommitManifest,
+    /// @brief Commit `object_name` in `bucket` as a copy of `source_object` in
+    /// `source_bucket`: the same blobs or manifest, size and etag, so no bytes move. The blobs
+    /// are then shared, and `kDeleteObject` reports whether any object still uses them. A
+    /// single-node source whose body is kept in its row is copied with that body instead.
+    kCopyObject,
+    /// @brief Remove `object_name` from `bucket`; removing a missing object is not an error.
+    kDeleteObject,
+    /// @brief Start upload `upload_id` of `object_name` in `bucket`, expiring at `expires_at`,
+    /// so later ops in the batch can describe it before anyone else sees it.
+    kCreateMultipartUpload,
+};
+
+/// @brief One step of a metadata batch; each type reads the fields its single call takes.
+struct BatchOp {
+    BatchOpType type{BatchOpType::kGetBucket};
+    std::string bucket;
+    /// @brief For allocate/commit; when empty, the object named by upload `upload_id`.
+    std::string object_name;
+    std::string upload_id;
+    /// @brief New state for `kUpdateMultipartUploadState`.
+    std::string state;
+    /// @brief When set, the batch fails with `kFailedPrecondition` unless upload `upload_id`
+    /// is in this state at the moment this op runs.
+    std::string expect_upload_state;
+    int replication_factor{0};
+    std::string service_token;
+    std::string blob_id;
+    std::uint64_t size_bytes{0};
+    std::string etag;
+    std::vector<ReplicaTarget> replicas;
+    /// @brief For `kCommitManifest`.
+    std::vector<ManifestSegment> segments;
+    /// @brief For `kCopyObject`, the object whose stored bytes the copy points at.
+    std::string source_bucket;
+    std::string source_object;
+    /// @brief For `kListMultipartParts`: only parts numbered above this, and at most
+    /// `max_parts` of them when positive.
+    int part_number_marker{0};
+    int max_parts{0};
+    /// @brief For `kSetMultipartPartSize`.
+    std::uint64_t part_size{0};
+    /// @brief For `kCreateMultipartUpload`, an ISO 8601 time.
+    std::string expires_at;
+    /// @brief Lease ops: the lease's name, the caller's holder id and, to acquire, its term.
+    std::string lease;
+    std::string lease_holder;
+    std::uint64_t lease_ttl_ms{0};
+    /// @brief For `kCheckLease`, the token `kAcquireLease` returned.
+    std::uint64_t fencing_token{0};
+    /// @brief Unix milliseconds lease ops judge expiry by; 0 means the store's own clock.
+    /// Replication fixes it on the leader so every member replays the same decision; it is
+    /// not part of the RPC, so the metadata service always judges by its own clock.
+    std::uint64_t now_ms{0};
+};
+
+/// @brief Time-bounded ownership of a job shared by gateways, such as the cleanup sweep.
+struct Lease {
+    std::string name;
+    std::string holder;
+    /// @brief Grows each time the lease changes hands, so a holder that lost the lease can be
+    /// told apart from the current one.
+    std::uint64_t fencing_token{0};
+    std::uint64_t expires_at_ms{0};
+};
+
+/// @brief Output of one batch op; only the member matching the op's type is filled.
+struct BatchOpResult {
+    Bucket bucket;
+    MultipartUpload upload;
+    std::vector<MultipartPart> parts;
+    AllocateWritePlan write_plan;
+    Lease lease;
+    BucketStats stats;
+    /// @brief For `kCopyObject`, where the copied bytes are; for `kDeleteObject`, where the
+    /// removed object's bytes were (empty when it had none).
+    ResolveReadPlan read_plan;
+    /// @brief For `kDeleteObject`, how many objects still point at `read_plan`'s blobs. Only
+    /// at 0 may the blobs themselves be deleted.
+    std::uint64_t blob_references{0};
+    /// @brief For `kDeleteObject`, whether there was an object to delete.
+    bool removed{false};
 };
 
 /// @brief Abstract metadata store interface for buckets and objects.
@@ -100,6 +258,8 @@ public:
                                                    const std::string& object) = 0;
     virtual core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
                                                                    const std::string& prefix) = 0;
+    virtual core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                        const ListObjectsOptions& options) = 0;
     virtual core::Result<void> DeleteObject(const std::string& bucket,
                                             const std::string& object) = 0;
 
@@ -138,6 +298,13 @@ public:
                                            const std::vector<ReplicaTarget>& replicas) = 0;
     virtual core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
                                                       const std::string& object_name) = 0;
+
+    /// @brief Run `ops` in order as one atomic unit and return one result per op.
+    ///
+    /// The first failing op, including an unmet `expect_upload_state`, undoes the ops before
+    /// it; the error message names the failing op's position.
+    virtual core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) = 0;
 };
 
 }  // namespace nebulafs::metadata
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <memory>
+
+#include "nebulafs/core/config.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Open the local metadata engine selected by `config.engine`, creating its directory.
+std::shared_ptr<MetadataStore> OpenMetadataStore(const core::DatabaseConfig& config);
+
+}  // namespace nebulafs::metadata
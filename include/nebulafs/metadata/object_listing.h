@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Upper bound on keys plus common prefixes returned in one listing page.
+constexpr int kMaxListKeys = 1000;
+
+/// @brief Visits objects with `lower <= name < upper` (empty upper = unbounded) in name order
+/// until the visitor returns false.
+using ObjectRangeScan = std::function<void(const std::string& lower, const std::string& upper,
+                                           const std::function<bool(ObjectMetadata&&)>& visit)>;
+
+/// @brief Smallest string greater than every string starting with `prefix` ("" if none exists).
+std::string PrefixUpperBound(std::string_view prefix);
+
+/// @brief Builds one listing page from ordered range scans, rolling keys up to common prefixes
+/// and seeking past each prefix instead of reading the keys under it.
+ObjectListing BuildObjectListing(const ListObjectsOptions& options, const ObjectRangeScan& scan);
+
+/// @brief Encodes a listing cursor as an opaque, URL- and JSON-safe continuation token.
+std::string EncodeListCursor(const std::string& cursor);
+
+/// @brief Decodes a continuation token produced by `EncodeListCursor`.
+std::optional<std::string> DecodeListCursor(const std::string& token);
+
+}  // namespace nebulafs::metadata
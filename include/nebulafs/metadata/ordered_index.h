@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace nebulafs::metadata {
+
+/// @brief In-memory B+tree from string keys to values with ordered scans over linked leaves.
+///
+/// Keys and values live in contiguous per-leaf arrays, so point lookups touch O(log n) small
+/// nodes and range scans walk memory sequentially. Not thread-safe; callers synchronize.
+template <typename Value>
+class OrderedIndex {
+    struct Leaf;
+
+public:
+    /// @brief Position in key order; invalidated by any mutation of the index.
+    class Iterator {
+    public:
+        bool Valid() const { return leaf_ != nullptr; }
+        const std::string& key() const { return leaf_->keys[index_]; }
+        Value& value() const { return leaf_->values[index_]; }
+        void Next() {
+            ++index_;
+            Settle();
+        }
+
+    private:
+        friend class OrderedIndex;
+        Iterator(Leaf* leaf, std::size_t index) : leaf_(leaf), index_(index) { Settle(); }
+
+        // Step over the end of a leaf (and any empty leaves) onto the next real entry.
+        void Settle() {
+            while (leaf_ != nullptr && index_ >= leaf_->keys.size()) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+        }
+
+        Leaf* leaf_;
+        std::size_t index_;
+    };
+
+    OrderedIndex() { Clear(); }
+
+    OrderedIndex(const OrderedIndex&) = delete;
+    OrderedIndex& operator=(const OrderedIndex&) = delete;
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    Value* Find(std::string_view key) {
+        Leaf* leaf = FindLeaf(key);
+        const auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
+        if (it == leaf->keys.end() || *it != key) {
+            return nullptr;
+        }
+        return &leaf->values[static_cast<std::size_t>(it - leaf->keys.begin())];
+    }
+
+    /// @brief Value for `key`, default-constructed if absent; `second` is true on insertion.
+    /// The pointer stays valid until the next mutation.
+    std::pair<Value*, bool> Emplace(const std::string& key) {
+        Value* slot = nullptr;
+        bool inserted = false;
+        auto split = Insert(root_.get(), key, slot, inserted);
+        if (split) {
+            auto root = std::make_unique<Inner>();
+            root->keys.push_back(std::move(split->separator));
+            root->children.push_back(std::move(root_));
+            root->children.push_back(std::move(split->right));
+            root_ = std::move(root);
+        }
+        if (inserted) {
+            ++size_;
+        }
+        return {slot, inserted};
+    }
+
+    bool Erase(std::string_view key) {
+        std::vector<std::pair<Inner*, std::size_t>> path;
+        Node* node = root_.get();
+        while (!node->is_leaf) {
+            auto* inner = static_cast<Inner*>(node);
+            const auto index = ChildIndex(*inner, key);
+            path.emplace_back(inner, index);
+            node = inner->children[index].get();
+        }
+        auto* leaf = static_cast<Leaf*>(node);
+        const auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
+        if (it == leaf->keys.end() || *it != key) {
+            return false;
+        }
+        const auto pos = it - leaf->keys.begin();
+        leaf->keys.erase(it);
+        leaf->values.erase(leaf->values.begin() + pos);
+        --size_;
+        if (!leaf->keys.empty() || path.empty()) {
+            return true;
+        }
+
+        // Only empty nodes are unlinked; underfull ones are not merged, which keeps deletes
+        // simple at the cost of some slack after heavy churn.
+        if (leaf->prev != nullptr) {
+            leaf->prev->next = leaf->next;
+        } else {
+            first_ = leaf->next;
+        }
+        if (leaf->next != nullptr) {
+            leaf->next->prev = leaf->prev;
+        }
+        while (!path.empty()) {
+            auto [parent, index] = path.back();
+            path.pop_back();
+            parent->children.erase(parent->children.begin() + static_cast<std::ptrdiff_t>(index));
+            if (!parent->keys.empty()) {
+                parent->keys.erase(parent->keys.begin() +
+                                   static_cast<std::ptrdiff_t>(index == 0 ? 0 : index - 1));
+            }
+            if (!parent->children.empty()) {
+                break;
+            }
+        }
+        while (!root_->is_leaf) {
+            auto* root = static_cast<Inner*>(root_.get());
+            if (root->children.size() != 1) {
+                break;
+            }
+            auto child = std::move(root->children.front());
+            root_ = std::move(child);
+        }
+        if (!root_->is_leaf && static_cast<Inner*>(root_.get())->children.empty()) {
+            Clear();
+        }
+        return true;
+    }
+
+    Iterator Begin() { return Iterator(first_, 0); }
+
+    /// @brief First entry whose key is >= `key`.
+    Iterator LowerBound(std::string_view key) {
+        Leaf* leaf = FindLeaf(key);
+        const auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
+        return Iterator(leaf, static_cast<std::size_t>(it - leaf->keys.begin()));
+    }
+
+    void Clear() {
+        auto leaf = std::make_unique<Leaf>();
+        first_ = leaf.get();
+        root_ = std::move(leaf);
+        size_ = 0;
+    }
+
+private:
+    // Node sizes keep a leaf's keys within a few cache lines of pointers while holding the
+    // tree to four levels at ~10M entries.
+    static constexpr std::size_t kLeafCapacity = 64;
+    static constexpr std::size_t kInnerCapacity = 64;
+
+    struct Node {
+        explicit Node(bool leaf) : is_leaf(leaf) {}
+        virtual ~Node() = default;
+        const bool is_leaf;
+    };
+
+    struct Leaf : Node {
+        Leaf() : Node(true) {}
+        std::vector<std::string> keys;
+        std::vector<Value> values;
+        Leaf* prev{nullptr};
+        Leaf* next{nullptr};
+    };
+
+    // keys[i] is the smallest key routed to children[i + 1].
+    struct Inner : Node {
+        Inner() : Node(false) {}
+        std::vector<std::string> keys;
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    struct Split {
+        std::string separator;
+        std::unique_ptr<Node> right;
+    };
+
+    static std::size_t ChildIndex(const Inner& inner, std::string_view key) {
+        return static_cast<std::size_t>(
+            std::upper_bound(inner.keys.begin(), inner.keys.end(), key) - inner.keys.begin());
+    }
+
+    Leaf* FindLeaf(std::string_view key) const {
+        Node* node = root_.get();
+        while (!node->is_leaf) {
+            auto* inner = static_cast<Inner*>(node);
+            node = inner->children[ChildIndex(*inner, key)].get();
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    std::optional<Split> Insert(Node* node, const std::string& key, Value*& slot,
+                                bool& inserted) {
+        if (node->is_leaf) {
+            auto* leaf = static_cast<Leaf*>(node);
+            const auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
+            const auto pos = static_cast<std::size_t>(it - leaf->keys.begin());
+            if (it != leaf->keys.end() && *it == key) {
+                slot = &leaf->values[pos];
+                return std::nullopt;
+            }
+            leaf->keys.insert(it, key);
+            leaf->values.insert(leaf->values.begin() + static_cast<std::ptrdiff_t>(pos), Value{});
+            inserted = true;
+            if (leaf->keys.size() <= kLeafCapacity) {
+                slot = &leaf->values[pos];
+                return std::nullopt;
+            }
+
+            const auto half = leaf->keys.size() / 2;
+            auto right = std::make_unique<Leaf>();
+            right->keys.assign(std::make_move_iterator(leaf->keys.begin() + half),
+                               std::make_move_iterator(leaf->keys.end()));
+            right->values.assign(std::make_move_iterator(leaf->values.begin() + half),
+                                 std::make_move_iterator(leaf->values.end()));
+            leaf->keys.resize(half);
+            leaf->values.resize(half);
+            right->next = leaf->next;
+            if (right->next != nullptr) {
+                right->next->prev = right.get();
+            }
+            right->prev = leaf;
+            leaf->next = right.get();
+            slot = pos < half ? &leaf->values[pos] : &right->values[pos - half];
+            std::string separator = right->keys.front();
+            return Split{std::move(separator), std::move(right)};
+        }
+
+        auto* inner = static_cast<Inner*>(node);
+        const auto index = ChildIndex(*inner, key);
+        auto split = Insert(inner->children[index].get(), key, slot, inserted);
+        if (!split) {
+            return std::nullopt;
+        }
+        inner->keys.insert(inner->keys.begin() + static_cast<std::ptrdiff_t>(index),
+                           std::move(split->separator));
+        inner->children.insert(inner->children.begin() + static_cast<std::ptrdiff_t>(index + 1),
+                               std::move(split->right));
+        if (inner->children.size() <= kInnerCapacity) {
+            return std::nullopt;
+        }
+
+        const auto mid = inner->keys.size() / 2;
+        auto right = std::make_unique<Inner>();
+        std::string separator = std::move(inner->keys[mid]);
+        right->keys.assign(std::make_move_iterator(inner->keys.begin() + mid + 1),
+                           std::make_move_iterator(inner->keys.end()));
+        right->children.assign(std::make_move_iterator(inner->children.begin() + mid + 1),
+                               std::make_move_iterator(inner->children.end()));
+        inner->keys.resize(mid);
+        inner->children.resize(mid + 1);
+        return Split{std::move(separator), std::move(right)};
+    }
+
+    std::unique_ptr<Node> root_;
+    Leaf* first_{nullptr};
+    std::size_t size_{0};
+};
+
+}  // namespace nebulafs::metadata
@@ -1,15 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/distributed/http_client.h"
+#include "nebulafs/metadata/change_feed.h"
 #include "nebulafs/metadata/metadata_store.h"
 
 namespace nebulafs::metadata {
 
 /// @brief HTTP-backed metadata store client for distributed mode.
+///
+/// `base_url` may list the members of a replicated metadata service separated by commas.
+/// Mutations go to the leader, following `X-Nebula-Leader` hints; bucket and object reads are
+/// spread across members and carry the highest commit index this client has seen, so a
+/// follower answers only once it reflects this client's own writes. Request and response
+/// bodies use `wire_format`; JSON remains available for debugging.
 class RemoteMetadataStore : public MetadataStore {
 public:
-    RemoteMetadataStore(std::string base_url, std::string service_auth_token);
+    RemoteMetadataStore(std::string base_url, std::string service_auth_token,
+                        core::WireFormat wire_format = core::WireFormat::kBinary);
 
     core::Result<Bucket> CreateBucket(const std::string& name) override;
     core::Result<std::vector<Bucket>> ListBuckets() override;
@@ -21,6 +36,8 @@ public:
                                            const std::string& object) override;
     core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
                                                           const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
     core::Result<void> DeleteObject(const std::string& bucket,
                                     const std::string& object) override;
 
@@ -57,10 +74,38 @@ public:
                                    const std::vector<ReplicaTarget>& replicas) override;
     core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
                                               const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
+
+    /// @brief Long-poll the leader's change feed for events after `cursor`.
+    core::Result<ChangePage> ReadChanges(const std::string& cursor, int wait_ms);
 
 private:
-    std::string base_url_;
+    /// @brief Send to the leader, retrying other members while a leader is elected.
+    core::Result<distributed::HttpCallResult> SendToLeader(const std::string& method,
+                                                           const std::string& path_and_query,
+                                                           const std::string& body,
+                                                           const std::string& content_type);
+    /// @brief GET from any member that is current enough, falling back to the leader.
+    core::Result<distributed::HttpCallResult> SendRead(const std::string& path_and_query);
+    /// @brief Send `request` to the leader encoded in this client's wire format.
+    template <typename Msg>
+    core::Result<distributed::HttpCallResult> SendMessage(const std::string& method,
+                                                          const std::string& path,
+                                                          const Msg& request);
+    /// @brief Decode a 200 response in whichever format the service answered with.
+    template <typename Msg>
+    core::Result<Msg> ReadReply(const distributed::HttpCallResult& response) const;
+    std::map<std::string, std::string> AcceptHeaders() const;
+    void NoteCommitIndex(const distributed::HttpCallResult& response);
+
+    std::vector<std::string> members_;
     std::string service_auth_token_;
+    core::WireFormat wire_format_;
+    std::mutex leader_mutex_;
+    std::string leader_;
+    std::atomic<std::size_t> next_reader_{0};
+    std::atomic<std::uint64_t> commit_index_{0};
 };
 
 }  // namespace nebulafs::metadata
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/metadata/replication_log.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Membership and timing for one metadata replica.
+struct ReplicaOptions {
+    /// @brief This member's base URL; must match how peers list it.
+    std::string self_url;
+    /// @brief Base URLs of the other members.
+    std::vector<std::string> peers;
+    /// @brief Directory holding the replication log, the persisted term/vote, and the index of
+    /// the last entry applied to the local store.
+    std::string state_dir;
+    int election_timeout_ms{1000};
+    int heartbeat_interval_ms{200};
+    /// @brief Followers stop serving reads once this long behind the leader.
+    int max_staleness_ms{2000};
+    int commit_timeout_ms{5000};
+    std::size_t retain_entries{ReplicationLog::kDefaultRetainEntries};
+};
+
+struct VoteRequest {
+    std::uint64_t term{0};
+    std::string candidate;
+    std::uint64_t last_index{0};
+    std::uint64_t last_term{0};
+};
+
+struct VoteResponse {
+    std::uint64_t term{0};
+    bool granted{false};
+};
+
+struct HeartbeatRequest {
+    std::uint64_t term{0};
+    std::string leader;
+    std::uint64_t commit_index{0};
+};
+
+struct HeartbeatResponse {
+    std::uint64_t term{0};
+    bool accepted{false};
+};
+
+/// @brief Follower pull of entries after its last log position.
+struct FetchRequest {
+    std::uint64_t term{0};
+    std::string follower;
+    std::uint64_t after{0};
+    std::uint64_t after_term{0};
+    /// @brief Long-poll budget when the leader has nothing newer.
+    int wait_ms{0};
+};
+
+enum class FetchStatus {
+    kOk,
+    kNotLeader,
+    /// @brief The follower's log disagrees with the leader's or is no longer retained.
+    kDiverged,
+};
+
+struct FetchResponse {
+    FetchStatus status{FetchStatus::kNotLeader};
+    std::uint64_t term{0};
+    std::string leader;
+    std::uint64_t commit_index{0};
+    std::uint64_t last_index{0};
+    std::vector<ReplicationEntry> entries;
+};
+
+/// @brief Point-in-time view of a replica, served by the status endpoint.
+struct ReplicaStatus {
+    std::string role;
+    std::uint64_t term{0};
+    std::string leader;
+    std::uint64_t last_index{0};
+    std::uint64_t commit_index{0};
+    std::uint64_t applied_index{0};
+    bool diverged{false};
+};
+
+/// @brief RPCs between replicas; `HttpReplicaTransport` is the production implementation.
+class ReplicaTransport {
+public:
+    virtual ~ReplicaTransport() = default;
+
+    virtual core::Result<VoteResponse> RequestVote(const std::string& peer,
+                                                   const VoteRequest& request) = 0;
+    virtual core::Result<HeartbeatResponse> Heartbeat(const std::string& peer,
+                                                      const HeartbeatRequest& request) = 0;
+    virtual core::Result<FetchResponse> Fetch(const std::string& leader,
+                                              const FetchRequest& request) = 0;
+};
+
+/// @brief Leader election and log shipping for a fixed set of metadata replicas.
+///
+/// Follows Raft's election and commit rules: terms and votes are persisted, a candidate needs a
+/// majority and an up-to-date log, and an entry commits once a majority stores it and it belongs
+/// to the leader's term. Unlike Raft, followers pull entries (long-polling `Fetch`). Every member
+/// applies entries in log order once they commit, so no member ever exposes a write that may be
+/// rolled back. A follower drops an uncommitted suffix that conflicts with the leader's log and
+/// fetches again; only one that has fallen behind the leader's retained log stops serving and
+/// must be re-seeded from a copy of the leader's database.
+class ReplicaGroup {
+public:
+    /// @brief Called from the group's apply thread for each committed entry, in log order, that
+    /// the member which appended it does not apply itself; without the group's lock held.
+    using ApplyFn = std::function<void(const ReplicationEntry&)>;
+
+    ReplicaGroup(ReplicaOptions options, std::shared_ptr<ReplicaTransport> transport,
+                 ApplyFn apply);
+    ~ReplicaGroup();
+
+    ReplicaGroup(const ReplicaGroup&) = delete;
+    ReplicaGroup& operator=(const ReplicaGroup&) = delete;
+
+    /// @brief Start the election timer and follower fetch loop.
+    void Start();
+    void Stop();
+
+    /// @brief Log `payload` as the next entry, reserving its apply for the caller through
+    /// `CommitAndApply`; fails with kUnavailable unless leader.
+    core::Result<std::uint64_t> Append(std::string payload);
+    /// @brief Block until `index` (from `Append`) is committed by a majority, then run `apply`
+    /// for it once every earlier entry is applied.
+    ///
+    /// Fails without running `apply` if leadership is lost or the commit times out; the entry
+    /// is then left to the apply thread, should it commit after all.
+    core::Result<void> CommitAndApply(std::uint64_t index, const std::function<void()>& apply);
+    /// @brief Wait up to `wait_ms` until local reads reflect `min_index` within staleness bounds.
+    core::Result<void> AwaitReadable(std::uint64_t min_index, int wait_ms);
+
+    bool IsLeader() const;
+    /// @brief Current leader's URL, or empty while unknown.
+    std::string leader() const;
+    ReplicaStatus Status() const;
+
+    VoteResponse HandleVote(const VoteRequest& request);
+    HeartbeatResponse HandleHeartbeat(const HeartbeatRequest& request);
+    FetchResponse HandleFetch(const FetchRequest& request);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    enum class Role { kFollower, kCandidate, kLeader };
+
+    void LoadState();
+    void PersistState();
+    void PersistApplied();
+    /// @brief Adopt a newer term as follower; caller holds `mutex_`.
+    void StepDown(std::uint64_t term);
+    void ResetElectionDeadline();
+    bool HasLease(Clock::time_point now) const;
+    void AdvanceCommit();
+    /// @brief Whether the appender of the entry at `index` applies it; caller holds `mutex_`.
+    bool IsReserved(std::uint64_t index) const;
+    /// @brief Record that every entry up to `index` is applied; caller holds `mutex_`.
+    void MarkApplied(std::uint64_t index);
+    std::size_t Majority() const { return (options_.peers.size() + 1) / 2 + 1; }
+
+    void TickLoop();
+    void RunElection();
+    void SendHeartbeats();
+    void FetchLoop();
+    void ApplyLoop();
+
+    ReplicaOptions options_;
+    std::shared_ptr<ReplicaTransport> transport_;
+    ApplyFn apply_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_cv_;
+    ReplicationLog log_;
+    Role role_{Role::kFollower};
+    std::uint64_t term_{0};
+    std::string voted_for_;
+    std::string leader_;
+    std::uint64_t commit_index_{0};
+    // Applies run strictly in log order, one entry after `applied_index_` at a time.
+    std::uint64_t applied_index_{0};
+    Clock::time_point applied_persisted_at_;
+    // Entries whose appender applies them itself, with the term it appended them in.
+    std::map<std::uint64_t, std::uint64_t> reserved_;
+    // Follower: highest index known to match the current leader's log, so a heartbeat's commit
+    // index never commits a conflicting suffix.
+    std::uint64_t verified_index_{0};
+    // Leader: index of its term's first entry; reads wait until it is applied.
+    std::uint64_t term_start_index_{0};
+    bool diverged_{false};
+    Clock::time_point election_deadline_;
+    // Last time this follower held every entry the leader had.
+    Clock::time_point caught_up_at_;
+    // Leader-only: highest index each follower stores and when it last acknowledged us.
+    std::map<std::string, std::uint64_t> match_index_;
+    std::map<std::string, Clock::time_point> last_contact_;
+
+    std::condition_variable stop_cv_;
+    bool stopping_{false};
+    std::thread tick_thread_;
+    std::thread fetch_thread_;
+    std::thread apply_thread_;
+};
+
+}  // namespace nebulafs::metadata
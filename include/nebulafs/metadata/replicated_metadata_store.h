@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/metadata/metadata_store.h"
+#include "nebulafs/metadata/replica_group.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Metadata store replicated across a `ReplicaGroup` of metadata services.
+///
+/// On the leader, each mutation is logged as a logical operation stamped with the leader's clock
+/// and applied to the local store once a majority holds it; the caller gets the result of that
+/// apply. Followers replay committed operations against their own store. Reads always go to the
+/// local store; callers gate them with `group().AwaitReadable`.
+class ReplicatedMetadataStore : public MetadataStore {
+public:
+    ReplicatedMetadataStore(std::shared_ptr<MetadataStore> store, ReplicaOptions options,
+                            std::shared_ptr<ReplicaTransport> transport);
+    ~ReplicatedMetadataStore() override;
+
+    ReplicatedMetadataStore(const ReplicatedMetadataStore&) = delete;
+    ReplicatedMetadataStore& operator=(const ReplicatedMetadataStore&) = delete;
+
+    ReplicaGroup& group() { return *group_; }
+
+    /// @brief Log index of the last mutation committed by this thread, 0 if none since reset.
+    static std::uint64_t LastWriteIndex();
+    static void ResetLastWriteIndex();
+
+    core::Result<Bucket> CreateBucket(const std::string& name) override;
+    core::Result<std::vector<Bucket>> ListBuckets() override;
+    core::Result<Bucket> GetBucket(const std::string& name) override;
+
+    core::Result<ObjectMetadata> UpsertObject(const std::string& bucket,
+                                              const ObjectMetadata& object) override;
+    core::Result<ObjectMetadata> GetObject(const std::string& bucket,
+                                           const std::string& object) override;
+    core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
+                                                          const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
+    core::Result<void> DeleteObject(const std::string& bucket,
+                                    const std::string& object) override;
+
+    core::Result<MultipartUpload> CreateMultipartUpload(const std::string& bucket,
+                                                        const std::string& upload_id,
+                                                        const std::string& object_name,
+                                                        const std::string& expires_at) override;
+    core::Result<MultipartUpload> GetMultipartUpload(const std::string& upload_id) override;
+    core::Result<std::vector<MultipartUpload>> ListExpiredMultipartUploads(
+        const std::string& expires_before, int limit) override;
+    core::Result<void> UpdateMultipartUploadState(const std::string& upload_id,
+                                                  const std::string& state) override;
+    core::Result<void> DeleteMultipartUpload(const std::string& upload_id) override;
+
+    core::Result<MultipartPart> UpsertMultipartPart(const std::string& upload_id, int part_number,
+                                                    std::uint64_t size_bytes,
+                                                    const std::string& etag,
+                                                    const std::string& temp_path) override;
+    core::Result<std::vector<MultipartPart>> ListMultipartParts(
+        const std::string& upload_id) override;
+    core::Result<void> DeleteMultipartParts(const std::string& upload_id) override;
+
+    core::Result<void> ConfigureStorageNodes(const std::vector<std::string>& endpoints) override;
+    core::Result<AllocateWritePlan> AllocateWrite(const std::string& bucket,
+                                                  const std::string& object_name,
+                                                  int replication_factor,
+                                                  const std::string& service_token) override;
+    core::Result<void> CommitWrite(const std::string& bucket, const std::string& object_name,
+                                   const std::string& blob_id, std::uint64_t size_bytes,
+                                   const std::string& etag,
+                                   const std::vector<ReplicaTarget>& replicas) override;
+    core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
+                                              const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
+
+private:
+    /// @brief Log `operation`, wait for a quorum, then apply it locally through `run`.
+    template <typename Run>
+    auto Mutate(core::ByteWriter operation, Run run) -> decltype(run());
+    /// @brief Replay one committed operation that this member did not run through `Mutate`.
+    void Apply(const ReplicationEntry& entry);
+
+    std::shared_ptr<MetadataStore> store_;
+    // Keeps leader timestamps in log order.
+    std::mutex write_mutex_;
+    std::unique_ptr<ReplicaGroup> group_;
+};
+
+}  // namespace nebulafs::metadata
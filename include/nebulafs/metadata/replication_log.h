@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+
+namespace nebulafs::metadata {
+
+/// @brief One replicated mutation: its log position, the leader term that wrote it, and the
+/// encoded operation.
+struct ReplicationEntry {
+    std::uint64_t index{0};
+    std::uint64_t term{0};
+    std::string payload;
+};
+
+/// @brief Durable log of replicated mutations with a bounded in-memory tail.
+///
+/// Entries are fsynced before `Append` returns. Only uncommitted entries are ever removed from
+/// the end, by `TruncateAfter`. Only the newest `retain_entries` stay readable;
+/// a follower further behind than that must be re-seeded from a copy of the database.
+/// Not thread-safe; `ReplicaGroup` serializes access.
+class ReplicationLog {
+public:
+    static constexpr std::size_t kDefaultRetainEntries = 1u << 20;
+
+    /// @brief Open (or create) the log at `path`, dropping a torn tail.
+    explicit ReplicationLog(std::string path,
+                            std::size_t retain_entries = kDefaultRetainEntries);
+    ~ReplicationLog();
+
+    ReplicationLog(const ReplicationLog&) = delete;
+    ReplicationLog& operator=(const ReplicationLog&) = delete;
+
+    /// @brief Append entries whose indexes continue from `last_index()`.
+    core::Result<void> Append(const std::vector<ReplicationEntry>& entries);
+    /// @brief Drop every entry after `index`, which must still be retained (or be 0).
+    core::Result<void> TruncateAfter(std::uint64_t index);
+
+    std::uint64_t last_index() const { return last_index_; }
+    std::uint64_t last_term() const { return last_term_; }
+    /// @brief Term of the entry at `index`; 0 for index 0, nullopt once compacted away or absent.
+    std::optional<std::uint64_t> TermAt(std::uint64_t index) const;
+    /// @brief Up to `max_entries` entries after `index`; nullopt when they were compacted away.
+    std::optional<std::vector<ReplicationEntry>> ReadAfter(std::uint64_t index,
+                                                           std::size_t max_entries) const;
+
+private:
+    core::Result<void> Compact();
+
+    std::string path_;
+    std::size_t retain_entries_;
+    int fd_{-1};
+    std::deque<ReplicationEntry> tail_;
+    std::uint64_t last_index_{0};
+    std::uint64_t last_term_{0};
+    std::size_t file_entries_{0};
+};
+
+}  // namespace nebulafs::metadata
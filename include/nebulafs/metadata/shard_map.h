@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nebulafs::metadata {
+
+/// @brief Assigns buckets to metadata shards by rendezvous (highest-random-weight) hashing.
+///
+/// Ownership depends only on the endpoint strings, so every gateway with the same list agrees,
+/// list order does not matter, and adding or removing one shard moves only that shard's share
+/// of buckets.
+class ShardMap {
+public:
+    explicit ShardMap(std::vector<std::string> endpoints);
+
+    /// @brief Index into `endpoints()` of the shard that owns `bucket`.
+    std::size_t ShardFor(std::string_view bucket) const;
+
+    const std::vector<std::string>& endpoints() const { return endpoints_; }
+    std::size_t size() const { return endpoints_.size(); }
+
+private:
+    std::vector<std::string> endpoints_;
+};
+
+}  // namespace nebulafs::metadata
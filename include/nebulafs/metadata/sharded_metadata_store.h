@@ -0,0 +1,103 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nebulafs/metadata/metadata_store.h"
+#include "nebulafs/metadata/shard_map.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Metadata store that spreads buckets across independent shard stores.
+///
+/// Bucket-scoped calls go to the bucket's owning shard; `ListBuckets`, expired-upload scans and
+/// storage-node configuration fan out to every shard. Calls keyed only by upload id use a
+/// cache filled at upload creation and fall back to asking every shard. A batch runs on one
+/// shard; one naming buckets or leases on two fails with `kCrossShard`.
+class ShardedMetadataStore : public MetadataStore {
+public:
+    /// @brief Creates the store for one shard endpoint (a `RemoteMetadataStore` in production).
+    using ShardFactory = std::function<std::shared_ptr<MetadataStore>(const std::string&)>;
+
+    ShardedMetadataStore(std::vector<std::string> endpoints, ShardFactory factory);
+
+    /// @brief Swap in a new shard list; stores for endpoints that remain are reused.
+    /// Buckets whose owner changes must be migrated by the operator.
+    void Reload(std::vector<std::string> endpoints);
+    std::vector<std::string> endpoints() const;
+
+    core::Result<Bucket> CreateBucket(const std::string& name) override;
+    core::Result<std::vector<Bucket>> ListBuckets() override;
+    core::Result<Bucket> GetBucket(const std::string& name) override;
+
+    core::Result<ObjectMetadata> UpsertObject(const std::string& bucket,
+                                              const ObjectMetadata& object) override;
+    core::Result<ObjectMetadata> GetObject(const std::string& bucket,
+                                           const std::string& object) override;
+    core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
+                                                          const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
+    core::Result<void> DeleteObject(const std::string& bucket,
+                                    const std::string& object) override;
+
+    core::Result<MultipartUpload> CreateMultipartUpload(const std::string& bucket,
+                                                        const std::string& upload_id,
+                                                        const std::string& object_name,
+                                                        const std::string& expires_at) override;
+    core::Result<MultipartUpload> GetMultipartUpload(const std::string& upload_id) override;
+    core::Result<std::vector<MultipartUpload>> ListExpiredMultipartUploads(
+        const std::string& expires_before, int limit) override;
+    core::Result<void> UpdateMultipartUploadState(const std::string& upload_id,
+                                                  const std::string& state) override;
+    core::Result<void> DeleteMultipartUpload(const std::string& upload_id) override;
+
+    core::Result<MultipartPart> UpsertMultipartPart(const std::string& upload_id, int part_number,
+                                                    std::uint64_t size_bytes,
+                                                    const std::string& etag,
+                                                    const std::string& temp_path) override;
+    core::Result<std::vector<MultipartPart>> ListMultipartParts(
+        const std::string& upload_id) override;
+    core::Result<void> DeleteMultipartParts(const std::string& upload_id) override;
+
+    core::Result<void> ConfigureStorageNodes(const std::vector<std::string>& endpoints) override;
+    core::Result<AllocateWritePlan> AllocateWrite(const std::string& bucket,
+                                                  const std::string& object_name,
+                                                  int replication_factor,
+                                                  const std::string& service_token) override;
+    core::Result<void> CommitWrite(const std::string& bucket, const std::string& object_name,
+                                   const std::string& blob_id, std::uint64_t size_bytes,
+                                   const std::string& etag,
+                                   const std::vector<ReplicaTarget>& replicas) override;
+    core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
+                                              const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
+
+private:
+    // Immutable once published; callers keep a reference for the duration of one call so a
+    // concurrent Reload never pulls a store out from under them.
+    struct Shards {
+        ShardMap map;
+        std::vector<std::shared_ptr<MetadataStore>> stores;
+    };
+
+    std::shared_ptr<const Shards> Current() const;
+    std::shared_ptr<MetadataStore> ForBucket(const std::string& bucket) const;
+    core::Result<std::shared_ptr<MetadataStore>> ForUpload(const std::string& upload_id);
+    void RememberUpload(const std::string& upload_id, std::shared_ptr<MetadataStore> store);
+    void ForgetUpload(const std::string& upload_id);
+
+    ShardFactory factory_;
+    mutable std::mutex shards_mutex_;
+    std::shared_ptr<const Shards> shards_;
+
+    std::mutex uploads_mutex_;
+    std::unordered_map<std::string, std::weak_ptr<MetadataStore>> upload_shards_;
+};
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace nebulafs::metadata {
+
+/// @brief SQLite failure carrying the primary result code.
+class SqliteError : public std::runtime_error {
+public:
+    SqliteError(int code, const std::string& message);
+
+    int code() const { return code_; }
+    /// @brief True for UNIQUE, PRIMARY KEY, and FOREIGN KEY violations.
+    bool IsConstraint() const;
+
+private:
+    int code_;
+};
+
+/// @brief One execution of a cached statement; binds positionally and resets on destruction.
+class SqliteQuery {
+public:
+    explicit SqliteQuery(sqlite3_stmt* stmt);
+    ~SqliteQuery();
+
+    SqliteQuery(SqliteQuery&& other) noexcept;
+    SqliteQuery(const SqliteQuery&) = delete;
+    SqliteQuery& operator=(const SqliteQuery&) = delete;
+    SqliteQuery& operator=(SqliteQuery&&) = delete;
+
+    SqliteQuery& Bind(std::int64_t value);
+    SqliteQuery& Bind(std::string_view value);
+    SqliteQuery& BindBlob(std::string_view value);
+    SqliteQuery& BindNull();
+
+    /// @brief Step to the next row; returns false once the statement is done.
+    bool Next();
+    /// @brief Step a statement that produces no rows to completion.
+    void Run();
+
+    std::int64_t Int64(int column) const;
+    int Int(int column) const;
+    std::string Text(int column) const;
+    /// @brief Column bytes without copying; valid until the next `Next()`.
+    std::string_view View(int column) const;
+    bool IsNull(int column) const;
+    /// @brief Storage class checks; call before reading the column, which may convert it.
+    bool IsBlob(int column) const;
+    bool IsInteger(int column) const;
+
+private:
+    sqlite3_stmt* stmt_;
+    int next_param_{1};
+};
+
+/// @brief One SQLite connection with a per-connection prepared-statement cache.
+class SqliteConnection {
+public:
+    SqliteConnection(const std::string& path, bool read_only);
+    ~SqliteConnection();
+
+    SqliteConnection(const SqliteConnection&) = delete;
+    SqliteConnection& operator=(const SqliteConnection&) = delete;
+
+    /// @brief Execute SQL that returns no rows (DDL, pragmas, transaction control).
+    void Execute(const std::string& sql);
+    /// @brief Start a query on a statement prepared once per connection and keyed by SQL text.
+    SqliteQuery Query(std::string_view sql);
+
+    int Changes() const;
+    /// @brief True while an explicit transaction is open on this connection.
+    bool InTransaction() const;
+
+private:
+    struct SqlHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view sql) const {
+            return std::hash<std::string_view>{}(sql);
+        }
+    };
+
+    sqlite3* db_{nullptr};
+    std::unordered_map<std::string, sqlite3_stmt*, SqlHash, std::equal_to<>> statements_;
+};
+
+/// @brief RAII transaction; rolls back unless `Commit()` is called. Opened inside another
+/// transaction it becomes a savepoint, so its rollback undoes only its own statements.
+class SqliteTransaction {
+public:
+    /// @brief Takes the write lock up front unless `read_only`, which gives a consistent
+    /// snapshot on a read-only connection.
+    explicit SqliteTransaction(SqliteConnection& connection, bool read_only = false);
+    ~SqliteTransaction();
+
+    SqliteTransaction(const SqliteTransaction&) = delete;
+    SqliteTransaction& operator=(const SqliteTransaction&) = delete;
+
+    void Commit();
+
+private:
+    SqliteConnection& connection_;
+    bool savepoint_{false};
+    bool done_{false};
+};
+
+}  // namespace nebulafs::metadata
@@ -1,18 +1,41 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
-
-#include <Poco/Data/Session.h>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "nebulafs/metadata/metadata_store.h"
+#include "nebulafs/metadata/sqlite_connection.h"
 
 namespace nebulafs::metadata {
 
-/// @brief SQLite-backed metadata store for single-node mode.
+/// @brief SQLite-backed metadata store (WAL, pooled readers, single queued writer).
+///
+/// Writes queued while the writer is busy are group-committed: each runs in its own savepoint
+/// of one shared transaction, so a failing write rolls back alone and the group pays for one
+/// journal sync. Callers see their result only after that commit.
 class SqliteMetadataStore : public MetadataStore {
 public:
-    explicit SqliteMetadataStore(const std::string& db_path);
+    /// @brief Default number of read-only connections kept in the reader pool.
+    static constexpr int kDefaultReaderConnections = 4;
+    /// @brief Most queued writes folded into one commit.
+    static constexpr std::size_t kMaxGroupCommit = 128;
+
+    /// @brief Open the database; `reader_connections == 0` routes reads through the writer.
+    explicit SqliteMetadataStore(const std::string& db_path,
+                                 int reader_connections = kDefaultReaderConnections);
+    ~SqliteMetadataStore() override;
+
+    SqliteMetadataStore(const SqliteMetadataStore&) = delete;
+    SqliteMetadataStore& operator=(const SqliteMetadataStore&) = delete;
 
     core::Result<Bucket> CreateBucket(const std::string& name) override;
     core::Result<std::vector<Bucket>> ListBuckets() override;
@@ -24,6 +47,8 @@ public:
                                            const std::string& object) override;
     core::Result<std::vector<ObjectMetadata>> ListObjects(const std::string& bucket,
                                                            const std::string& prefix) override;
+    core::Result<ObjectListing> ListObjectsPage(const std::string& bucket,
+                                                const ListObjectsOptions& options) override;
     core::Result<void> DeleteObject(const std::string& bucket,
                                     const std::string& object) override;
 
@@ -61,11 +86,40 @@ public:
                                    const std::vector<ReplicaTarget>& replicas) override;
     core::Result<ResolveReadPlan> ResolveRead(const std::string& bucket,
                                               const std::string& object_name) override;
+    core::Result<std::vector<BatchOpResult>> ExecuteBatch(
+        const std::vector<BatchOp>& ops) override;
 
 private:
-    // Schema creation is done once per store instance; in production this will be migrated.
+    struct WriteTask {
+        // Runs the caller's work inside its savepoint; false rolls that savepoint back.
+        std::function<bool()> run;
+        // Publishes the caller's result, or `failure` when the group did not commit.
+        std::function<void(const core::Error* failure)> finish;
+    };
+
+    // Creates the schema or migrates an older file in place (see sqlite_schema.h).
     void InitSchema();
-    Poco::Data::Session session_;
+    void WriterLoop();
+    void CommitGroup(std::vector<WriteTask>& group);
+
+    // Runs fn on a pooled read-only connection.
+    template <typename Fn>
+    auto Read(Fn&& fn) -> decltype(fn(std::declval<SqliteConnection&>()));
+    // Runs fn on the writer thread and blocks until it finishes.
+    template <typename Fn>
+    auto Write(Fn&& fn) -> decltype(fn(std::declval<SqliteConnection&>()));
+
+    SqliteConnection writer_;
+    std::vector<std::unique_ptr<SqliteConnection>> readers_;
+    std::vector<SqliteConnection*> idle_readers_;
+    std::mutex reader_mutex_;
+    std::condition_variable reader_cv_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<WriteTask> write_queue_;
+    bool stopping_{false};
+    std::thread writer_thread_;
 };
 
 }  // namespace nebulafs::metadata
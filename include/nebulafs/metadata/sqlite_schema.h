@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "nebulafs/metadata/sqlite_connection.h"
+
+namespace nebulafs::metadata {
+
+/// @brief Schema version `MigrateSchema` brings a database to; stored in `PRAGMA user_version`.
+///
+/// - v1: text timestamps, UUID strings, hex etags, and state names (unversioned files).
+/// - v2: Unix-second timestamps, 16-byte UUIDs, raw digest bytes, upload state codes, and
+///   `WITHOUT ROWID` replica rows.
+/// - v3: adds the `leases` table.
+/// - v4: adds `bucket_stats`, maintained by triggers on objects, uploads and parts.
+/// - v5: adds `multipart_uploads.part_size`.
+/// - v6: adds `object_segments`, the manifests of composite objects.
+/// - v7: adds `objects.inline_data`, the bodies of objects stored inline.
+/// - v8: indexes replica and segment rows by `blob_id`, which copied objects share.
+/// - v9: stores the "expired" upload state as code 5 instead of text.
+inline constexpr int kSqliteSchemaVersion = 9;
+
+/// @brief Creates or upgrades the schema in place and returns the version the file had (0 for
+/// a new database). Each step runs in one transaction, so a crash leaves the old version.
+int MigrateSchema(SqliteConnection& db);
+
+/// @brief Recomputes the `bucket_stats` row of `bucket_id` from its objects and parts.
+void RecountBucketStats(SqliteConnection& db, std::int64_t bucket_id);
+
+/// @brief Creates the v1 schema; kept so tests and benchmarks can build databases to migrate.
+void CreateSchemaV1(SqliteConnection& db);
+
+// Column encodings of schema v2. Values without a compact form (ids that are not lowercase
+// UUIDs, etags that are not lowercase hex, unknown states, unparseable times) are stored as
+// TEXT, and readers tell the forms apart by storage class, so every value round-trips.
+
+void BindId(SqliteQuery& query, std::string_view id);
+std::string ReadId(const SqliteQuery& query, int column);
+
+void BindDigest(SqliteQuery& query, std::string_view digest);
+std::string ReadDigest(const SqliteQuery& query, int column);
+
+void BindUploadState(SqliteQuery& query, std::string_view state);
+std::string ReadUploadState(const SqliteQuery& query, int column);
+
+/// @brief Binds an ISO8601 timestamp as Unix seconds.
+void BindTime(SqliteQuery& query, std::string_view iso8601);
+std::string ReadTime(const SqliteQuery& query, int column);
+
+}  // namespace nebulafs::metadata
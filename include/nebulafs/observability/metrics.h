@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace nebulafs::observability {
@@ -18,27 +20,63 @@ void RecordGatewayStoragePutFailure();
 void RecordGatewayMetadataRpcFailure();
 /// @brief Record replica fallback on distributed reads.
 void RecordGatewayReplicaFallback();
-/// @brief Record distributed multipart compose failures from gateway.
-void RecordGatewayMultipartComposeFailure();
-/// @brief Record distributed multipart rollback attempts from gateway.
-void RecordGatewayMultipartRollbackAttempt();
-/// @brief Record distributed multipart rollback failures from gateway.
-void RecordGatewayMultipartRollbackFailure();
+/// @brief Record a gateway metadata cache lookup answered from the cache (`hit`) or not.
+void RecordGatewayMetadataCacheLookup(bool hit);
+/// @brief Record a gateway metadata cache miss that joined an identical lookup in flight.
+void RecordGatewayMetadataCacheCoalesced();
+/// @brief Record how long after its commit a change-feed event reached this gateway.
+void RecordGatewayChangeFeedLag(long long lag_ms);
+/// @brief Record a change-feed read that restarted from the feed head.
+void RecordGatewayChangeFeedReset();
+/// @brief Record a failed change-feed read.
+void RecordGatewayChangeFeedError();
 /// @brief Record distributed cleanup upload processing outcome from gateway.
 void RecordGatewayDistributedCleanupUpload(bool success);
+/// @brief Record a cleanup sweep skipped because another gateway holds the cleanup lease.
+void RecordGatewayCleanupSweepSkipped();
+/// @brief Record an object write that linked a body already in the content store.
+void RecordGatewayContentDedupHit();
+/// @brief Record content-store bodies removed because no object links them any more.
+void RecordGatewayContentReclaimed(std::uint64_t bodies);
+/// @brief Record objects moved from a flat bucket directory into the fan-out layout.
+void RecordGatewayObjectsMigrated(std::uint64_t objects);
+/// @brief Record an object copied (or moved, with `move`) on the server side.
+void RecordGatewayObjectCopy(bool move);
+/// @brief Record a bulk delete request naming `keys` objects, `deleted` of which existed.
+void RecordGatewayBulkDelete(std::uint64_t keys, std::uint64_t deleted);
+/// @brief Record a change of `delta` in the blobs waiting for the background reclaimer.
+void RecordGatewayReclaimQueue(std::int64_t delta);
+/// @brief Record one batched blob delete sent to a storage node and its outcome.
+void RecordGatewayBlobReclaim(std::uint64_t blobs, bool success);
+/// @brief Record an object stored compressed: its raw and stored sizes and the time taken.
+void RecordGatewayCompression(std::uint64_t raw_bytes, std::uint64_t stored_bytes,
+                              long long elapsed_us);
+/// @brief Record compressed frames decoded to serve a read and the time taken.
+void RecordGatewayDecompression(std::uint64_t frames, long long elapsed_us);
+/// @brief Record a change of `delta` in the upload chunks waiting for or in the writer stage.
+void RecordGatewayUploadWriteQueue(std::int64_t delta);
+/// @brief Record a change of `delta` in the upload chunks waiting for or in the hasher stage.
+void RecordGatewayUploadHashQueue(std::int64_t delta);
+/// @brief Record an upload read that waited for its pipeline to free a chunk.
+void RecordGatewayUploadPipelineStall();
 /// @brief Record distributed cleanup blob delete outcome from gateway.
 void RecordGatewayDistributedCleanupBlobDelete(bool success);
 /// @brief Record metadata allocate-write request outcome and latency.
 void RecordMetadataAllocate(bool success, long long latency_ms);
 /// @brief Record metadata commit request outcome and latency.
 void RecordMetadataCommit(bool success, long long latency_ms);
+/// @brief Record one event appended to the metadata change feed.
+void RecordMetadataChangeFeedEvent();
+/// @brief Record one SQLite group commit covering `transactions` callers' writes.
+void RecordMetadataGroupCommit(std::size_t transactions);
+/// @brief Record a committed replicated operation that the store rejected, either when its
+/// leader ran it (`replay` false) or when a member replayed it from the log.
+void RecordMetadataReplicationApplyFailure(bool replay);
 /// @brief Record storage node blob write request outcome and latency.
 void RecordStorageNodeWrite(bool success, long long latency_ms);
 /// @brief Record storage node blob read request outcome and latency.
 void RecordStorageNodeRead(bool success, long long latency_ms);
 /// @brief Record storage node blob delete request outcome and latency.
 void RecordStorageNodeDelete(bool success, long long latency_ms);
-/// @brief Record storage node blob compose request outcome and latency.
-void RecordStorageNodeCompose(bool success, long long latency_ms);
 
 }  // namespace nebulafs::observability
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/metadata/metadata_store.h"
+
+namespace nebulafs::storage {
+
+/// @brief Deletes the blobs of removed objects in the background, batched per storage node.
+///
+/// Callers queue the read plans of objects whose blobs nothing names any more and return at
+/// once. One worker thread groups the queued replicas by node and sends up to `batch_size`
+/// blob ids per request. A failed batch is retried after `retry_delay` and dropped, with a
+/// log line, after `kMaxAttempts` sends. The queue lives in memory only: blobs still queued
+/// when the gateway stops stay on their nodes, as after a failed synchronous delete.
+class BlobReclaimer {
+public:
+    /// @brief Deletes `blob_ids` on the storage node at `endpoint`.
+    using Sender = std::function<core::Result<void>(const std::string& endpoint,
+                                                    const std::vector<std::string>& blob_ids)>;
+
+    static constexpr std::size_t kDefaultBatchSize = 1000;
+    static constexpr int kMaxAttempts = 5;
+
+    explicit BlobReclaimer(Sender sender, std::size_t batch_size = kDefaultBatchSize,
+                           std::chrono::milliseconds retry_delay = std::chrono::seconds(1));
+    /// @brief Sends what is queued once more, without retrying, and stops.
+    ~BlobReclaimer();
+
+    BlobReclaimer(const BlobReclaimer&) = delete;
+    BlobReclaimer& operator=(const BlobReclaimer&) = delete;
+
+    /// @brief Queues every replica of the blob and segments in `plan`.
+    void Enqueue(const metadata::ResolveReadPlan& plan);
+    /// @brief Blocks until every blob queued so far has been deleted or dropped.
+    void Flush();
+
+private:
+    struct Pending {
+        std::string blob_id;
+        int attempts{0};
+    };
+
+    void Run();
+
+    Sender sender_;
+    std::size_t batch_size_;
+    std::chrono::milliseconds retry_delay_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    // Replicas waiting to be sent, by storage node endpoint.
+    std::map<std::string, std::vector<Pending>> queue_;
+    std::size_t queued_{0};
+    std::size_t in_flight_{0};
+    bool stop_{false};
+    std::thread worker_;
+};
+
+}  // namespace nebulafs::storage
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+
+namespace nebulafs::storage {
+
+/// @brief Uncompressed bytes per frame: the most a range read decodes beyond what it asked for.
+inline constexpr std::size_t kCompressedFrameBytes = 128 * 1024;
+
+/// @brief Sizes of an object before and after compression.
+struct CompressionResult {
+    std::uint64_t raw_bytes{0};
+    std::uint64_t stored_bytes{0};
+};
+
+/// @brief Writes `source` to `dest` as a seekable compressed object and syncs it.
+///
+/// The body is cut into `frame_bytes` frames, each deflated on its own (or kept as is when that
+/// does not shrink it), followed by an index of the frames' stored sizes and CRC-32Cs and a
+/// fixed-size footer. Any byte range can then be read by decoding only the frames it covers.
+core::Result<CompressionResult> CompressObjectFile(const std::string& source,
+                                                   const std::string& dest,
+                                                   std::size_t frame_bytes = kCompressedFrameBytes);
+
+/// @brief Decodes a file written by `CompressObjectFile` frame by frame.
+class CompressedObjectReader {
+public:
+    /// @brief Opens `path` and loads its frame index.
+    static core::Result<CompressedObjectReader> Open(const std::string& path);
+    /// @brief Uncompressed size of `path` from its footer, without loading the index.
+    static core::Result<std::uint64_t> ReadObjectSize(const std::string& path);
+
+    std::uint64_t size() const { return size_; }
+    std::size_t frame_bytes() const { return frame_bytes_; }
+    /// @brief Index of the frame holding uncompressed byte `offset`.
+    std::size_t FrameOf(std::uint64_t offset) const {
+        return static_cast<std::size_t>(offset / frame_bytes_);
+    }
+    /// @brief Replaces `out` with the uncompressed bytes of frame `index`, checked against the
+    /// CRC-32C the index holds for them.
+    core::Result<void> ReadFrame(std::size_t index, std::string& out);
+
+private:
+    struct Frame {
+        std::uint64_t offset{0};
+        std::uint32_t stored_size{0};
+        bool deflated{false};
+        std::uint32_t crc32c{0};
+    };
+
+    std::ifstream file_;
+    std::uint64_t size_{0};
+    std::size_t frame_bytes_{0};
+    std::vector<Frame> frames_;
+    std::string stored_;
+};
+
+}  // namespace nebulafs::storage
@@ -1,23 +1,69 @@
 #pragma once
 
 #include <cstdint>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "nebulafs/storage/storage_backend.h"
 
 namespace nebulafs::storage {
 
 /// @brief Local filesystem storage with atomic writes.
+///
+/// With `content_addressed` set, each distinct body is kept once under `content/` by its
+/// SHA-256, and object files are hard links to it. The link count is the reference count:
+/// `ReclaimContent` removes bodies whose only remaining link is their own.
+///
+/// Buckets named in `fanout_buckets` (`"*"` names every bucket) keep objects under
+/// `fanout/<xx>/<yy>/` by a hash of the object name instead of in one flat `objects/`
+/// directory. A bucket switches when this storage is built or first uses it, and stays switched.
+/// Objects it still holds in `objects/` are read from there until `MigrateObjectLayout` moves
+/// them.
+///
+/// Objects written to buckets named in `compressed_buckets` are stored as seekable compressed
+/// frames in a file named with `kCompressedSuffix`, which no object name can contain. Reads
+/// look for the raw file first, so a bucket may hold both kinds while its setting changes.
+///
+/// `CopyObject` and `MoveObject` never read bytes through the process: a move renames the file,
+/// and a copy links the shared body (content-addressed) or reflinks it, falling back to
+/// `copy_file_range` and then to a plain copy. Either keeps the file in its stored form.
 class LocalStorage : public StorageBackend {
 public:
-    LocalStorage(std::string base_path, std::string temp_path);
+    /// @brief Appended to the file name of an object stored compressed.
+    static constexpr const char* kCompressedSuffix = "~z";
+
+    LocalStorage(std::string base_path, std::string temp_path, bool content_addressed = false,
+                 std::vector<std::string> fanout_buckets = {},
+                 std::vector<std::string> compressed_buckets = {});
 
     core::Result<StoredObject> WriteObject(const std::string& bucket, const std::string& object,
                                            std::istream& data) override;
     core::Result<StoredObject> ReadObject(const std::string& bucket,
                                           const std::string& object) const override;
+    core::Result<StoredRange> ReadObjectRange(const std::string& bucket, const std::string& object,
+                                              std::uint64_t first,
+                                              std::uint64_t last) const override;
     core::Result<void> DeleteObject(const std::string& bucket,
                                     const std::string& object) override;
+    core::Result<std::vector<bool>> DeleteObjects(
+        const std::string& bucket, const std::vector<std::string>& objects) override;
+    core::Result<StoredObject> CopyObject(const std::string& source_bucket,
+                                          const std::string& source_object,
+                                          const std::string& bucket,
+                                          const std::string& object) override;
+    core::Result<StoredObject> MoveObject(const std::string& source_bucket,
+                                          const std::string& source_object,
+                                          const std::string& bucket,
+                                          const std::string& object) override;
+    core::Result<StoredObject> LinkObject(const std::string& bucket, const std::string& object,
+                                          const std::string& sha256) override;
+    core::Result<std::uint64_t> ReclaimContent() override;
+    core::Result<StoredObject> PlaceObject(const std::string& bucket, const std::string& object,
+                                           const std::string& file_path,
+                                           const std::string& etag) override;
+    core::Result<std::uint64_t> MigrateObjectLayout(std::size_t max_objects) override;
 
     core::Result<void> EnsureBucket(const std::string& bucket) override;
 
@@ -27,10 +73,53 @@ public:
     static bool IsSafeName(const std::string& name);
     static std::string BuildObjectPath(const std::string& base_path, const std::string& bucket,
                                        const std::string& object);
+    /// @brief Where a fan-out bucket keeps `object`: two directory levels named by the hex
+    /// digits of a hash of the name.
+    static std::string BuildFanoutObjectPath(const std::string& base_path,
+                                             const std::string& bucket,
+                                             const std::string& object);
+    /// @brief Where the content store keeps the body with SHA-256 hex digest `sha256`.
+    static std::string BuildContentPath(const std::string& base_path, const std::string& sha256);
+    /// @brief True for a lowercase 64-digit hex SHA-256 digest.
+    static bool IsContentDigest(const std::string& sha256);
 
 private:
+    // True once the bucket has a `fanout/` directory, which is what marks the layout on disk.
+    bool IsFanoutBucket(const std::string& bucket) const;
+    void MarkFanoutBucket(const std::string& bucket);
+    bool WantsFanout(const std::string& bucket) const;
+    // Where a write of `object` lands under the bucket's layout.
+    std::string ObjectPath(const std::string& bucket, const std::string& object) const;
+    // The file holding `object` (its compressed form with `suffix`), or empty when there is
+    // none.
+    std::string FindObjectPath(const std::string& bucket, const std::string& object,
+                               const std::string& suffix = "") const;
+    // Removes the files of `object` with `suffix` in every layout; false when there were none.
+    bool RemoveObjectFiles(const std::string& bucket, const std::string& object,
+                           const std::string& suffix);
+    // Moves the finished temp file into place as `object`, compressing it for a compressed
+    // bucket, and drops the object's file in the other form.
+    core::Result<StoredObject> InstallObject(const std::string& bucket, const std::string& object,
+                                             const std::string& temp_file,
+                                             const std::string& etag, std::uint64_t size);
+    // Copies or renames the stored file of one object to another name, keeping its form.
+    core::Result<StoredObject> TransferObject(const std::string& source_bucket,
+                                              const std::string& source_object,
+                                              const std::string& bucket,
+                                              const std::string& object, bool move);
+    // Moves the hashed temp file `temp_path` to `final_path`, sharing the stored body when one
+    // with the same digest exists and keeping this one as the stored body otherwise.
+    core::Result<void> CommitContent(const std::string& temp_path, const std::string& etag,
+                                     const std::string& final_path);
+
     std::string base_path_;
     std::string temp_path_;
+    bool content_addressed_{false};
+    std::vector<std::string> fanout_buckets_;
+    std::vector<std::string> compressed_buckets_;
+    mutable std::shared_mutex fanout_mutex_;
+    // Layout of each bucket seen so far; a bucket only ever moves from flat to fan-out.
+    mutable std::unordered_map<std::string, bool> fanout_state_;
 };
 
 }  // namespace nebulafs::storage
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nebulafs/core/result.h"
+
+namespace nebulafs::storage {
+
+/// @brief One uploaded part file and the size recorded for it at upload time.
+struct PartSource {
+    std::string path;
+    std::uint64_t size_bytes{0};
+};
+
+/// @brief Size and SHA-256 etag of an assembled object.
+struct AssembledObject {
+    std::uint64_t size_bytes{0};
+    std::string etag;
+};
+
+/// @brief Writes `parts` back to back into `dest_path` (replacing it) and hashes the result.
+///
+/// `threads` workers check each part file against its recorded size and copy it to its own
+/// offset, while the calling thread hashes the parts in order. On failure `dest_path` is
+/// removed.
+core::Result<AssembledObject> AssembleParts(const std::vector<PartSource>& parts,
+                                            const std::string& dest_path, int threads);
+
+/// @brief Writes `data` at `offset` of `path`, creating the file if needed. The rest of the
+/// file is left as it is, and a gap below `offset` stays a hole where the filesystem allows.
+core::Result<void> WriteAt(const std::string& path, std::uint64_t offset, std::string_view data);
+
+}  // namespace nebulafs::storage
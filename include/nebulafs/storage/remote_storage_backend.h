@@ -2,14 +2,20 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "nebulafs/core/config.h"
 #include "nebulafs/metadata/metadata_backend.h"
+#include "nebulafs/storage/blob_reclaimer.h"
 #include "nebulafs/storage/storage_backend.h"
 
 namespace nebulafs::storage {
 
 /// @brief Distributed storage backend using metadata placement and storage-node APIs.
+///
+/// Copies and moves only write metadata: the new row names the source's immutable blobs, and
+/// deletes hand blobs to a background `BlobReclaimer` only once no object row names them any
+/// more.
 class RemoteStorageBackend : public StorageBackend {
 public:
     RemoteStorageBackend(core::DistributedConfig distributed,
@@ -20,18 +26,46 @@ public:
                                            std::istream& data) override;
     core::Result<StoredObject> ReadObject(const std::string& bucket,
                                           const std::string& object) const override;
+    core::Result<StoredRange> ReadObjectRange(const std::string& bucket, const std::string& object,
+                                              std::uint64_t first,
+                                              std::uint64_t last) const override;
     core::Result<void> DeleteObject(const std::string& bucket,
                                     const std::string& object) override;
+    core::Result<std::vector<bool>> DeleteObjects(
+        const std::string& bucket, const std::vector<std::string>& objects) override;
+    core::Result<StoredObject> CopyObject(const std::string& source_bucket,
+                                          const std::string& source_object,
+                                          const std::string& bucket,
+                                          const std::string& object) override;
+    core::Result<StoredObject> MoveObject(const std::string& source_bucket,
+                                          const std::string& source_object,
+                                          const std::string& bucket,
+                                          const std::string& object) override;
+    core::Result<StoredObject> LinkObject(const std::string& bucket, const std::string& object,
+                                          const std::string& sha256) override;
+    core::Result<std::uint64_t> ReclaimContent() override;
+    core::Result<StoredObject> PlaceObject(const std::string& bucket, const std::string& object,
+                                           const std::string& file_path,
+                                           const std::string& etag) override;
+    core::Result<std::uint64_t> MigrateObjectLayout(std::size_t max_objects) override;
     core::Result<void> EnsureBucket(const std::string& bucket) override;
 
     const std::string& base_path() const override { return base_path_placeholder_; }
     const std::string& temp_path() const override { return temp_path_; }
 
 private:
+    // Copies the object's row onto the source's blobs, moving it when `move` is set.
+    core::Result<StoredObject> TransferObject(const std::string& source_bucket,
+                                              const std::string& source_object,
+                                              const std::string& bucket,
+                                              const std::string& object, bool move);
+
     core::DistributedConfig distributed_;
     std::shared_ptr<metadata::MetadataBackend> metadata_;
     std::string temp_path_;
     std::string base_path_placeholder_{"distributed"};
+    // Last, so its final round runs while the rest of the backend is still alive.
+    std::unique_ptr<BlobReclaimer> reclaimer_;
 };
 
 }  // namespace nebulafs::storage
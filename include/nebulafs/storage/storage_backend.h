@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <istream>
 #include <string>
+#include <vector>
 
 #include "nebulafs/core/result.h"
 
@@ -12,7 +13,25 @@ namespace nebulafs::storage {
 struct StoredObject {
     std::string path;
     std::string etag;
+    /// @brief Uncompressed size, also when `path` holds compressed frames.
     std::uint64_t size_bytes{0};
+    /// @brief `path` holds the object as written by `CompressObjectFile` rather than raw.
+    bool compressed{false};
+};
+
+/// @brief Bytes `first`..`last` (inclusive) of an object, as read for an HTTP Range request.
+struct StoredRange {
+    /// @brief File holding the bytes, with byte `first` at `path_offset`. Empty when the
+    /// requested range starts past the end of the object.
+    std::string path;
+    std::uint64_t path_offset{0};
+    std::uint64_t first{0};
+    std::uint64_t last{0};
+    std::uint64_t object_size{0};
+    std::string etag;
+    /// @brief `path` holds compressed frames; `path_offset` is then unused and the reader
+    /// decodes the frames covering `first`..`last`.
+    bool compressed{false};
 };
 
 /// @brief Abstract byte-storage backend used by HTTP handlers.
@@ -25,8 +44,48 @@ public:
                                                    std::istream& data) = 0;
     virtual core::Result<StoredObject> ReadObject(const std::string& bucket,
                                                   const std::string& object) const = 0;
+    /// @brief Reads bytes `first`..`last` of an object, with `last` clamped to its end.
+    virtual core::Result<StoredRange> ReadObjectRange(const std::string& bucket,
+                                                      const std::string& object,
+                                                      std::uint64_t first,
+                                                      std::uint64_t last) const = 0;
     virtual core::Result<void> DeleteObject(const std::string& bucket,
                                             const std::string& object) = 0;
+    /// @brief Deletes `objects` of `bucket` together; entry `i` of the result tells whether
+    /// `objects[i]` was there. Storage that frees bytes elsewhere may do so after returning.
+    virtual core::Result<std::vector<bool>> DeleteObjects(
+        const std::string& bucket, const std::vector<std::string>& objects) = 0;
+    /// @brief Stores a copy of `source_object` in `source_bucket` as `object` in `bucket`
+    /// without sending its bytes through the caller; `bucket` may differ from the source's.
+    /// Fails with `kInvalidArgument` when source and destination are the same object.
+    virtual core::Result<StoredObject> CopyObject(const std::string& source_bucket,
+                                                  const std::string& source_object,
+                                                  const std::string& bucket,
+                                                  const std::string& object) = 0;
+    /// @brief Renames `source_object` in `source_bucket` to `object` in `bucket`, as
+    /// `CopyObject` followed by deleting the source.
+    virtual core::Result<StoredObject> MoveObject(const std::string& source_bucket,
+                                                  const std::string& source_object,
+                                                  const std::string& bucket,
+                                                  const std::string& object) = 0;
+    /// @brief Stores `object` as the body already kept under SHA-256 hex digest `sha256`,
+    /// without receiving its bytes. Fails with `kNotFound` when no such body is kept, in which
+    /// case the caller uploads the bytes.
+    virtual core::Result<StoredObject> LinkObject(const std::string& bucket,
+                                                  const std::string& object,
+                                                  const std::string& sha256) = 0;
+    /// @brief Removes kept bodies that no object refers to any more; returns how many went.
+    virtual core::Result<std::uint64_t> ReclaimContent() = 0;
+    /// @brief Moves a finished file at `file_path`, on the filesystem of `temp_path()`, into
+    /// place as `object` with the already computed `etag`. Content-addressed storage shares
+    /// the body when `etag` is its SHA-256.
+    virtual core::Result<StoredObject> PlaceObject(const std::string& bucket,
+                                                   const std::string& object,
+                                                   const std::string& file_path,
+                                                   const std::string& etag) = 0;
+    /// @brief Moves up to `max_objects` objects still in an old directory layout into the
+    /// current one; returns how many moved, so 0 means nothing is left.
+    virtual core::Result<std::uint64_t> MigrateObjectLayout(std::size_t max_objects) = 0;
     virtual core::Result<void> EnsureBucket(const std::string& bucket) = 0;
 
     virtual const std::string& base_path() const = 0;
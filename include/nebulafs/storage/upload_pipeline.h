@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "nebulafs/core/hashing.h"
+#include "nebulafs/core/result.h"
+
+namespace nebulafs::storage {
+
+/// @brief A received piece of an upload body, shared by the stages until both are done.
+struct UploadChunk {
+    std::vector<char> data;
+    std::size_t size{0};
+    // Stages still holding the chunk; touched only under the pipeline's lock.
+    int stages_left{0};
+};
+
+/// @brief Writes one upload body to a file and hashes it on worker threads, so the connection
+/// reads the next chunk while earlier ones are still being written and hashed.
+///
+/// Chunks pass through a writer stage and a hasher stage, each a strand on the shared pool, so
+/// each stage sees them in order. At most `depth` chunks are in flight; the connection then
+/// waits for one to come back before reading more.
+class UploadPipeline : public std::enable_shared_from_this<UploadPipeline> {
+public:
+    static constexpr std::size_t kChunkBytes = 64 * 1024;
+
+    /// @brief `fd` stays owned by the caller and must stay open until the pipeline drains.
+    /// Callbacks given to `WaitForChunk` and `WaitForDrain` run on `owner`.
+    UploadPipeline(boost::asio::thread_pool& pool, boost::asio::any_io_executor owner, int fd,
+                   std::optional<core::ObjectHasher> hasher,
+                   std::optional<std::uint32_t> crc32c, std::size_t depth);
+
+    /// @brief A free chunk to receive into, or null while `depth` chunks are in flight.
+    std::shared_ptr<UploadChunk> Acquire();
+    /// @brief Queues the first `chunk->size` bytes on both stages; an empty chunk is freed.
+    void Submit(std::shared_ptr<UploadChunk> chunk);
+    /// @brief Runs `resume` once a chunk is free again.
+    void WaitForChunk(std::function<void()> resume);
+    /// @brief Runs `done` once every submitted chunk has been written and hashed.
+    void WaitForDrain(std::function<void()> done);
+
+    /// @brief The first write error, if any. Read after the pipeline drains.
+    core::Result<void> status() const;
+    /// @brief The hasher and running CRC-32C given at construction, fed every submitted
+    /// byte. Take them after the pipeline drains.
+    std::optional<core::ObjectHasher> TakeHasher() { return std::move(hasher_); }
+    std::optional<std::uint32_t> TakeCrc32c() { return crc32c_; }
+
+private:
+    using Strand = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+
+    void Write(const std::shared_ptr<UploadChunk>& chunk);
+    void Hash(const std::shared_ptr<UploadChunk>& chunk);
+    void Release(std::shared_ptr<UploadChunk> chunk);
+
+    boost::asio::any_io_executor owner_;
+    Strand writer_strand_;
+    Strand hasher_strand_;
+    int fd_;
+    std::size_t depth_;
+    bool hashing_;
+
+    // Owned by the hasher stage while chunks are in flight.
+    std::optional<core::ObjectHasher> hasher_;
+    std::optional<std::uint32_t> crc32c_;
+    // Owned by the writer stage while chunks are in flight.
+    std::optional<std::string> write_error_;
+
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<UploadChunk>> free_;
+    std::size_t allocated_{0};
+    std::size_t in_flight_{0};
+    std::function<void()> waiter_;
+    bool waiting_for_drain_{false};
+};
+
+}  // namespace nebulafs::storage
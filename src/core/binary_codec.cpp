@@ -0,0 +1,174 @@
+#include "nebulafs/core/binary_codec.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#define NEBULAFS_CRC32C_SSE42 1
+#if defined(__GNUC__) || defined(__clang__)
+#define NEBULAFS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#include <intrin.h>
+#define NEBULAFS_TARGET_SSE42
+#endif
+#endif
+
+namespace nebulafs::core {
+
+namespace {
+
+// Table-driven CRC-32C, reflected polynomial 0x82F63B78.
+constexpr std::array<std::uint32_t, 256> MakeCrc32cTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kCrc32cTable = MakeCrc32cTable();
+
+std::uint32_t Crc32cTable(std::string_view data, std::uint32_t crc) {
+    for (const char c : data) {
+        crc = kCrc32cTable[(crc ^ static_cast<unsigned char>(c)) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef NEBULAFS_CRC32C_SSE42
+// Eight bytes per instruction; about twenty times the table's throughput.
+NEBULAFS_TARGET_SSE42 std::uint32_t Crc32cSse42(std::string_view data, std::uint32_t crc) {
+    const char* p = data.data();
+    std::size_t n = data.size();
+    std::uint64_t wide = crc;
+    for (; n >= 8; p += 8, n -= 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, p, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = static_cast<std::uint32_t>(wide);
+    for (; n > 0; ++p, --n) {
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*p));
+    }
+    return crc;
+}
+
+bool DetectSse42() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("sse4.2");
+#else
+    int info[4] = {};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#endif
+}
+
+bool HasSse42() {
+    static const bool has = DetectSse42();
+    return has;
+}
+#endif
+
+}  // namespace
+
+void ByteWriter::PutU8(std::uint8_t value) { buffer_.push_back(static_cast<char>(value)); }
+
+void ByteWriter::PutU32(std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer_.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+void ByteWriter::PutU64(std::uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        buffer_.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+void ByteWriter::PutString(std::string_view value) {
+    PutU32(static_cast<std::uint32_t>(value.size()));
+    buffer_.append(value);
+}
+
+void ByteWriter::PutRaw(std::string_view bytes) { buffer_.append(bytes); }
+
+void ByteWriter::PatchU32(std::size_t offset, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        buffer_[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+bool ByteReader::GetU8(std::uint8_t& value) {
+    if (remaining() < 1) {
+        return false;
+    }
+    value = static_cast<std::uint8_t>(data_[offset_++]);
+    return true;
+}
+
+bool ByteReader::GetU32(std::uint32_t& value) {
+    if (remaining() < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data_[offset_++]))
+                 << (8 * i);
+    }
+    return true;
+}
+
+bool ByteReader::GetU64(std::uint64_t& value) {
+    if (remaining() < 8) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data_[offset_++]))
+                 << (8 * i);
+    }
+    return true;
+}
+
+bool ByteReader::GetString(std::string& value) {
+    std::string_view view;
+    if (!GetView(view)) {
+        return false;
+    }
+    value.assign(view);
+    return true;
+}
+
+bool ByteReader::GetView(std::string_view& value) {
+    std::uint32_t size = 0;
+    if (!GetU32(size) || remaining() < size) {
+        return false;
+    }
+    value = data_.substr(offset_, size);
+    offset_ += size;
+    return true;
+}
+
+std::uint32_t Crc32c(std::string_view data, std::uint32_t crc) {
+#ifdef NEBULAFS_CRC32C_SSE42
+    if (HasSse42()) {
+        return ~Crc32cSse42(data, ~crc);
+    }
+#endif
+    return ~Crc32cTable(data, ~crc);
+}
+
+bool Crc32cUsesHardware() {
+#ifdef NEBULAFS_CRC32C_SSE42
+    return HasSse42();
+#else
+    return false;
+#endif
+}
+
+}  // namespace nebulafs::core
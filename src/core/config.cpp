@@ -1,8 +1,10 @@
 #include "nebulafs/core/config.h"
 
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
 
+#include <Poco/Util/AbstractConfiguration.h>
 #include <Poco/Util/JSONConfiguration.h>
 #include <Poco/Util/PropertyFileConfiguration.h>
 #include <Poco/AutoPtr.h>
@@ -20,6 +22,22 @@ bool IsBlank(const std::string& value) {
     return true;
 }
 
+std::vector<std::string> GetEndpointList(const Poco::Util::AbstractConfiguration& cfg,
+                                         const std::string& key) {
+    std::vector<std::string> endpoints;
+    for (int i = 0;; ++i) {
+        const auto item = key + "[" + std::to_string(i) + "]";
+        if (!cfg.hasProperty(item)) {
+            break;
+        }
+        const auto endpoint = cfg.getString(item, "");
+        if (!IsBlank(endpoint)) {
+            endpoints.push_back(endpoint);
+        }
+    }
+    return endpoints;
+}
+
 }  // namespace
 
 Config LoadConfig(const std::string& path) {
@@ -42,13 +60,23 @@ Config LoadConfig(const std::string& path) {
 
     config.storage.base_path = cfg->getString("storage.base_path", "data");
     config.storage.temp_path = cfg->getString("storage.temp_path", "data/tmp");
+    config.storage.content_addressed = cfg->getBool("storage.content_addressed", false);
+    config.storage.inline_max_bytes = cfg->getInt("storage.inline_max_bytes", 0);
+    config.storage.fanout_buckets = GetEndpointList(*cfg, "storage.fanout_buckets");
+    config.storage.crc32c_buckets = GetEndpointList(*cfg, "storage.crc32c_buckets");
+    config.storage.compressed_buckets = GetEndpointList(*cfg, "storage.compressed_buckets");
     config.storage.multipart.max_upload_ttl_seconds =
         cfg->getInt("storage.multipart.max_upload_ttl_seconds", 86400);
+    config.storage.multipart.assemble_threads =
+        cfg->getInt("storage.multipart.assemble_threads", 4);
+    config.storage.upload_pipeline.threads = cfg->getInt("storage.upload_pipeline.threads", 2);
+    config.storage.upload_pipeline.depth = cfg->getInt("storage.upload_pipeline.depth", 8);
 
     config.cleanup.enabled = cfg->getBool("cleanup.enabled", true);
     config.cleanup.sweep_interval_seconds = cfg->getInt("cleanup.sweep_interval_seconds", 300);
     config.cleanup.grace_period_seconds = cfg->getInt("cleanup.grace_period_seconds", 60);
     config.cleanup.max_uploads_per_sweep = cfg->getInt("cleanup.max_uploads_per_sweep", 200);
+    config.cleanup.lease_ttl_seconds = cfg->getInt("cleanup.lease_ttl_seconds", 900);
 
     config.observability.log_level = cfg->getString("observability.log_level", "information");
 
@@ -64,16 +92,35 @@ Config LoadConfig(const std::string& path) {
     config.distributed.service_auth_token = cfg->getString("distributed.service_auth_token", "");
     config.distributed.replication_factor = cfg->getInt("distributed.replication_factor", 2);
     config.distributed.min_write_acks = cfg->getInt("distributed.min_write_acks", 2);
-    for (int i = 0;; ++i) {
-        const auto key = "distributed.storage_nodes[" + std::to_string(i) + "]";
-        if (!cfg->hasProperty(key)) {
-            break;
-        }
-        const auto endpoint = cfg->getString(key, "");
-        if (!IsBlank(endpoint)) {
-            config.distributed.storage_nodes.push_back(endpoint);
-        }
-    }
+    config.distributed.storage_nodes = GetEndpointList(*cfg, "distributed.storage_nodes");
+    config.distributed.metadata_shards = GetEndpointList(*cfg, "distributed.metadata_shards");
+    config.distributed.shard_map_path = cfg->getString("distributed.shard_map_path", "");
+    config.distributed.shard_map_reload_seconds =
+        cfg->getInt("distributed.shard_map_reload_seconds", 30);
+    config.distributed.rpc_format = cfg->getString("distributed.rpc_format", "binary");
+    config.distributed.change_feed_retain_events =
+        cfg->getInt("distributed.change_feed_retain_events", 100000);
+
+    config.metadata_cache.enabled = cfg->getBool("metadata_cache.enabled", true);
+    config.metadata_cache.bucket_ttl_ms = cfg->getInt("metadata_cache.bucket_ttl_ms", 30000);
+    config.metadata_cache.read_plan_ttl_ms = cfg->getInt("metadata_cache.read_plan_ttl_ms", 5000);
+    config.metadata_cache.negative_ttl_ms = cfg->getInt("metadata_cache.negative_ttl_ms", 1000);
+    config.metadata_cache.max_bytes = static_cast<std::uint64_t>(
+        cfg->getInt64("metadata_cache.max_bytes", 16ll * 1024 * 1024));
+    config.metadata_cache.change_feed = cfg->getBool("metadata_cache.change_feed", true);
+    config.metadata_cache.change_feed_wait_ms =
+        cfg->getInt("metadata_cache.change_feed_wait_ms", 20000);
+
+    config.replication.enabled = cfg->getBool("replication.enabled", false);
+    config.replication.self_url = cfg->getString("replication.self_url", "");
+    config.replication.peers = GetEndpointList(*cfg, "replication.peers");
+    config.replication.state_dir = cfg->getString("replication.state_dir", "data/replication");
+    config.replication.election_timeout_ms = cfg->getInt("replication.election_timeout_ms", 1000);
+    config.replication.heartbeat_interval_ms =
+        cfg->getInt("replication.heartbeat_interval_ms", 200);
+    config.replication.max_staleness_ms = cfg->getInt("replication.max_staleness_ms", 2000);
+    config.replication.read_wait_ms = cfg->getInt("replication.read_wait_ms", 500);
+    config.replication.commit_timeout_ms = cfg->getInt("replication.commit_timeout_ms", 5000);
 
     if (config.server.mode != "single_node" && config.server.mode != "distributed") {
         throw std::invalid_argument("server.mode must be 'single_node' or 'distributed'");
@@ -90,12 +137,29 @@ Config LoadConfig(const std::string& path) {
     if (config.storage.multipart.max_upload_ttl_seconds <= 0) {
         throw std::invalid_argument("storage.multipart.max_upload_ttl_seconds must be positive");
     }
+    if (config.storage.multipart.assemble_threads <= 0) {
+        throw std::invalid_argument("storage.multipart.assemble_threads must be positive");
+    }
+    if (config.storage.upload_pipeline.threads < 0) {
+        throw std::invalid_argument("storage.upload_pipeline.threads must not be negative");
+    }
+    if (config.storage.upload_pipeline.depth <= 0) {
+        throw std::invalid_argument("storage.upload_pipeline.depth must be positive");
+    }
+    if (config.storage.inline_max_bytes < 0 ||
+        config.storage.inline_max_bytes > kMaxInlineObjectBytes) {
+        throw std::invalid_argument("storage.inline_max_bytes must be between 0 and " +
+                                    std::to_string(kMaxInlineObjectBytes));
+    }
     if (config.cleanup.sweep_interval_seconds <= 0) {
         throw std::invalid_argument("cleanup.sweep_interval_seconds must be positive");
     }
     if (config.cleanup.max_uploads_per_sweep <= 0) {
         throw std::invalid_argument("cleanup.max_uploads_per_sweep must be positive");
     }
+    if (config.cleanup.lease_ttl_seconds <= 0) {
+        throw std::invalid_argument("cleanup.lease_ttl_seconds must be positive");
+    }
     if (config.server.limits.request_timeout_ms <= 0) {
         throw std::invalid_argument("server.limits.request_timeout_ms must be positive");
     }
@@ -106,9 +170,15 @@ Config LoadConfig(const std::string& path) {
         throw std::invalid_argument("server.limits.rate_limit_burst must be >= 0");
     }
     if (config.server.mode == "distributed") {
-        if (IsBlank(config.distributed.metadata_base_url)) {
+        if (IsBlank(config.distributed.metadata_base_url) &&
+            config.distributed.metadata_shards.empty() &&
+            IsBlank(config.distributed.shard_map_path)) {
             throw std::invalid_argument(
-                "server.mode=distributed requires non-empty distributed.metadata_base_url");
+                "server.mode=distributed requires distributed.metadata_base_url, "
+                "distributed.metadata_shards, or distributed.shard_map_path");
+        }
+        if (config.distributed.shard_map_reload_seconds <= 0) {
+            throw std::invalid_argument("distributed.shard_map_reload_seconds must be positive");
         }
         if (IsBlank(config.distributed.service_auth_token)) {
             throw std::invalid_argument(
@@ -118,6 +188,9 @@ Config LoadConfig(const std::string& path) {
             throw std::invalid_argument(
                 "server.mode=distributed requires distributed.storage_nodes");
         }
+        if (config.distributed.rpc_format != "binary" && config.distributed.rpc_format != "json") {
+            throw std::invalid_argument("distributed.rpc_format must be 'binary' or 'json'");
+        }
         if (config.distributed.replication_factor <= 0) {
             throw std::invalid_argument("distributed.replication_factor must be positive");
         }
@@ -134,13 +207,88 @@ Config LoadConfig(const std::string& path) {
                 "distributed.storage_nodes must have at least replication_factor endpoints");
         }
     }
+    if (config.metadata_cache.enabled &&
+        (config.metadata_cache.bucket_ttl_ms < 0 || config.metadata_cache.read_plan_ttl_ms < 0 ||
+         config.metadata_cache.negative_ttl_ms < 0)) {
+        throw std::invalid_argument("metadata_cache TTLs must not be negative");
+    }
+    if (config.metadata_cache.enabled && config.metadata_cache.change_feed &&
+        config.metadata_cache.change_feed_wait_ms <= 0) {
+        throw std::invalid_argument("metadata_cache.change_feed_wait_ms must be positive");
+    }
+    if (config.distributed.change_feed_retain_events <= 0) {
+        throw std::invalid_argument("distributed.change_feed_retain_events must be positive");
+    }
+    if (config.replication.enabled) {
+        if (IsBlank(config.replication.self_url)) {
+            throw std::invalid_argument("replication.enabled requires replication.self_url");
+        }
+        if (config.replication.heartbeat_interval_ms <= 0 ||
+            config.replication.heartbeat_interval_ms >= config.replication.election_timeout_ms) {
+            throw std::invalid_argument(
+                "replication.heartbeat_interval_ms must be positive and below "
+                "replication.election_timeout_ms");
+        }
+        if (config.replication.max_staleness_ms <= 0 || config.replication.read_wait_ms < 0 ||
+            config.replication.commit_timeout_ms <= 0) {
+            throw std::invalid_argument(
+                "replication.max_staleness_ms and commit_timeout_ms must be positive and "
+                "read_wait_ms must be >= 0");
+        }
+    }
     return config;
 }
 
+std::vector<std::string> LoadShardMap(const std::string& path) {
+    Poco::AutoPtr<Poco::Util::JSONConfiguration> cfg(
+        new Poco::Util::JSONConfiguration(path));
+    auto shards = GetEndpointList(*cfg, "shards");
+    if (shards.empty()) {
+        throw std::invalid_argument("shard map must list at least one shard");
+    }
+    return shards;
+}
+
+std::vector<std::string> MetadataShardEndpoints(const DistributedConfig& config) {
+    if (!IsBlank(config.shard_map_path)) {
+        return LoadShardMap(config.shard_map_path);
+    }
+    if (!config.metadata_shards.empty()) {
+        return config.metadata_shards;
+    }
+    return {config.metadata_base_url};
+}
+
+bool IsBucketListed(const std::vector<std::string>& buckets, const std::string& bucket) {
+    return std::any_of(buckets.begin(), buckets.end(),
+                       [&](const std::string& name) { return name == "*" || name == bucket; });
+}
+
 std::string LoadDatabasePath(const std::string& path) {
+    return LoadDatabaseConfig(path).path;
+}
+
+DatabaseConfig LoadDatabaseConfig(const std::string& path) {
     Poco::AutoPtr<Poco::Util::JSONConfiguration> cfg(
         new Poco::Util::JSONConfiguration(path));
-    return cfg->getString("sqlite.path", "data/metadata.db");
+
+    DatabaseConfig config;
+    config.engine = cfg->getString("engine", "sqlite");
+    if (config.engine != "sqlite" && config.engine != "memory") {
+        throw std::invalid_argument("engine must be \"sqlite\" or \"memory\"");
+    }
+    config.path = cfg->getString("sqlite.path", "data/metadata.db");
+    config.reader_connections = cfg->getInt("sqlite.reader_connections", 4);
+    if (config.reader_connections < 0) {
+        throw std::invalid_argument("sqlite.reader_connections must be >= 0");
+    }
+    config.memory_path = cfg->getString("memory.path", "data/metadata-mem");
+    const auto snapshot_wal_bytes = cfg->getInt64("memory.snapshot_wal_bytes", 64ll * 1024 * 1024);
+    if (snapshot_wal_bytes <= 0) {
+        throw std::invalid_argument("memory.snapshot_wal_bytes must be > 0");
+    }
+    config.snapshot_wal_bytes = static_cast<std::uint64_t>(snapshot_wal_bytes);
+    return config;
 }
 
 }  // namespace nebulafs::core
@@ -0,0 +1,120 @@
+#include "nebulafs/core/hashing.h"
+
+#include <new>
+#include <utility>
+
+#include <openssl/evp.h>
+
+#include "nebulafs/core/binary_codec.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#else
+#include <intrin.h>
+#endif
+#endif
+
+namespace nebulafs::core {
+
+namespace {
+
+std::string ToHex(const unsigned char* bytes, std::size_t size) {
+    constexpr char kHex[] = "0123456789abcdef";
+    std::string out(size * 2, '0');
+    for (std::size_t i = 0; i < size; ++i) {
+        out[2 * i] = kHex[bytes[i] >> 4];
+        out[2 * i + 1] = kHex[bytes[i] & 0xf];
+    }
+    return out;
+}
+
+void InitSha256(EVP_MD_CTX* ctx) {
+    if (EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) != 1) {
+        throw std::bad_alloc();
+    }
+}
+
+}  // namespace
+
+Sha256Hasher::Sha256Hasher() : ctx_(EVP_MD_CTX_new()) {
+    if (ctx_ == nullptr) {
+        throw std::bad_alloc();
+    }
+    InitSha256(ctx_);
+}
+
+Sha256Hasher::~Sha256Hasher() { EVP_MD_CTX_free(ctx_); }
+
+Sha256Hasher::Sha256Hasher(Sha256Hasher&& other) noexcept
+    : ctx_(std::exchange(other.ctx_, nullptr)) {}
+
+Sha256Hasher& Sha256Hasher::operator=(Sha256Hasher&& other) noexcept {
+    if (this != &other) {
+        EVP_MD_CTX_free(ctx_);
+        ctx_ = std::exchange(other.ctx_, nullptr);
+    }
+    return *this;
+}
+
+void Sha256Hasher::Update(const void* data, std::size_t size) {
+    EVP_DigestUpdate(ctx_, data, size);
+}
+
+std::string Sha256Hasher::HexDigest() {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int size = 0;
+    EVP_DigestFinal_ex(ctx_, digest, &size);
+    InitSha256(ctx_);
+    return ToHex(digest, size);
+}
+
+ObjectHasher::ObjectHasher(ChecksumAlgorithm algorithm) : algorithm_(algorithm) {
+    if (algorithm_ == ChecksumAlgorithm::kSha256) {
+        sha256_.emplace();
+    }
+}
+
+void ObjectHasher::Update(const void* data, std::size_t size) {
+    if (sha256_) {
+        sha256_->Update(data, size);
+    } else {
+        crc32c_ = Crc32c(std::string_view(static_cast<const char*>(data), size), crc32c_);
+    }
+}
+
+std::string ObjectHasher::HexDigest() {
+    if (sha256_) {
+        return sha256_->HexDigest();
+    }
+    return Crc32cHex(std::exchange(crc32c_, 0));
+}
+
+std::string Crc32cHex(std::uint32_t crc) {
+    const unsigned char bytes[4] = {static_cast<unsigned char>(crc >> 24),
+                                    static_cast<unsigned char>(crc >> 16),
+                                    static_cast<unsigned char>(crc >> 8),
+                                    static_cast<unsigned char>(crc)};
+    return ToHex(bytes, sizeof(bytes));
+}
+
+bool CpuHasShaExtensions() {
+#if defined(__x86_64__) || defined(_M_X64)
+    // CPUID leaf 7, sub-leaf 0: EBX bit 29 reports the SHA extensions.
+#if defined(__GNUC__) || defined(__clang__)
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ebx & (1u << 29)) != 0;
+#else
+    int info[4] = {};
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 29)) != 0;
+#endif
+#else
+    return false;
+#endif
+}
+
+}  // namespace nebulafs::core
@@ -1,5 +1,10 @@
 #include "nebulafs/core/time.h"
 
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <utility>
+
 #include <Poco/DateTimeFormatter.h>
 #include <Poco/DateTimeFormat.h>
 #include <Poco/Timestamp.h>
@@ -7,7 +12,41 @@
 
 namespace nebulafs::core {
 
+namespace {
+
+thread_local std::optional<std::string> t_override;
+
+// Reads exactly `digits` decimal digits at `pos` and advances past them.
+bool ReadNumber(std::string_view text, std::size_t& pos, int digits, int& value) {
+    if (pos + digits > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < digits; ++i) {
+        const char c = text[pos + i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    pos += digits;
+    return true;
+}
+
+bool Expect(std::string_view text, std::size_t& pos, char c) {
+    if (pos >= text.size() || text[pos] != c) {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+}  // namespace
+
 std::string NowIso8601() {
+    if (t_override) {
+        return *t_override;
+    }
     return Poco::DateTimeFormatter::format(Poco::Timestamp(), Poco::DateTimeFormat::ISO8601_FORMAT);
 }
 
@@ -17,4 +56,83 @@ std::string NowIso8601WithOffsetSeconds(int delta_seconds) {
     return Poco::DateTimeFormatter::format(ts, Poco::DateTimeFormat::ISO8601_FORMAT);
 }
 
+std::optional<std::int64_t> ParseIso8601(std::string_view text) {
+    std::size_t pos = 0;
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    if (!ReadNumber(text, pos, 4, year) || !Expect(text, pos, '-') ||
+        !ReadNumber(text, pos, 2, month) || !Expect(text, pos, '-') ||
+        !ReadNumber(text, pos, 2, day)) {
+        return std::nullopt;
+    }
+    const std::chrono::year_month_day date{std::chrono::year{year},
+                                           std::chrono::month{static_cast<unsigned>(month)},
+                                           std::chrono::day{static_cast<unsigned>(day)}};
+    if (!date.ok()) {
+        return std::nullopt;
+    }
+    std::int64_t seconds =
+        std::chrono::sys_days{date}.time_since_epoch() / std::chrono::seconds{1};
+    if (pos == text.size()) {
+        return seconds;
+    }
+
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    if (!Expect(text, pos, 'T') || !ReadNumber(text, pos, 2, hour) || !Expect(text, pos, ':') ||
+        !ReadNumber(text, pos, 2, minute) || !Expect(text, pos, ':') ||
+        !ReadNumber(text, pos, 2, second) || hour > 23 || minute > 59 || second > 60) {
+        return std::nullopt;
+    }
+    seconds += hour * 3600 + minute * 60 + second;
+    if (pos < text.size() && text[pos] == '.') {
+        ++pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+    }
+    if (pos == text.size() || (text[pos] == 'Z' && pos + 1 == text.size())) {
+        return seconds;
+    }
+    const char sign = text[pos++];
+    int offset_hours = 0;
+    int offset_minutes = 0;
+    if ((sign != '+' && sign != '-') || !ReadNumber(text, pos, 2, offset_hours) ||
+        !Expect(text, pos, ':') || !ReadNumber(text, pos, 2, offset_minutes) ||
+        pos != text.size()) {
+        return std::nullopt;
+    }
+    const std::int64_t offset = offset_hours * 3600 + offset_minutes * 60;
+    return sign == '+' ? seconds - offset : seconds + offset;
+}
+
+std::string FormatIso8601(std::int64_t epoch_seconds) {
+    using namespace std::chrono;
+    const sys_seconds at{std::chrono::seconds{epoch_seconds}};
+    const auto day_start = floor<days>(at);
+    const year_month_day date{day_start};
+    const hh_mm_ss time{at - day_start};
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02uT%02d:%02d:%02dZ",
+                  static_cast<int>(date.year()), static_cast<unsigned>(date.month()),
+                  static_cast<unsigned>(date.day()), static_cast<int>(time.hours().count()),
+                  static_cast<int>(time.minutes().count()),
+                  static_cast<int>(time.seconds().count()));
+    return buffer;
+}
+
+ScopedClockOverride::ScopedClockOverride(std::string now) : previous_(std::move(t_override)) {
+    t_override = std::move(now);
+}
+
+ScopedClockOverride::~ScopedClockOverride() {
+    t_override = std::move(previous_);
+}
+
+std::optional<std::string> ClockOverride() {
+    return t_override;
+}
+
 }  // namespace nebulafs::core
@@ -0,0 +1,213 @@
+#include "nebulafs/core/wire_codec.h"
+
+#include <cstdio>
+
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+
+namespace nebulafs::core {
+
+std::string_view MediaTypeFor(WireFormat format) {
+    return format == WireFormat::kBinary ? kBinaryMediaType : "application/json";
+}
+
+WireFormat FormatFromMediaType(std::string_view header) {
+    return header.find(kBinaryMediaType) != std::string_view::npos ? WireFormat::kBinary
+                                                                    : WireFormat::kJson;
+}
+
+WireFormat WireFormatFromName(std::string_view name) {
+    return name == "json" ? WireFormat::kJson : WireFormat::kBinary;
+}
+
+void JsonWriter::Separate() {
+    if (need_comma_) {
+        out_.push_back(',');
+    }
+}
+
+void JsonWriter::BeginObject() {
+    Separate();
+    out_.push_back('{');
+    need_comma_ = false;
+}
+
+void JsonWriter::EndObject() {
+    out_.push_back('}');
+    need_comma_ = true;
+}
+
+void JsonWriter::BeginArray() {
+    Separate();
+    out_.push_back('[');
+    need_comma_ = false;
+}
+
+void JsonWriter::EndArray() {
+    out_.push_back(']');
+    need_comma_ = true;
+}
+
+void JsonWriter::Key(std::string_view key) {
+    Value(key);
+    out_.push_back(':');
+    need_comma_ = false;
+}
+
+void JsonWriter::Value(bool value) {
+    Separate();
+    out_.append(value ? "true" : "false");
+    need_comma_ = true;
+}
+
+void JsonWriter::Value(std::int64_t value) {
+    Separate();
+    out_.append(std::to_string(value));
+    need_comma_ = true;
+}
+
+void JsonWriter::Value(std::uint64_t value) {
+    Separate();
+    out_.append(std::to_string(value));
+    need_comma_ = true;
+}
+
+void JsonWriter::Value(std::string_view value) {
+    Separate();
+    out_.push_back('"');
+    for (const char c : value) {
+        switch (c) {
+            case '"':
+                out_.append("\\\"");
+                break;
+            case '\\':
+                out_.append("\\\\");
+                break;
+            case '\n':
+                out_.append("\\n");
+                break;
+            case '\r':
+                out_.append("\\r");
+                break;
+            case '\t':
+                out_.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out_.append(escaped);
+                } else {
+                    out_.push_back(c);
+                }
+        }
+    }
+    out_.push_back('"');
+    need_comma_ = true;
+}
+
+struct JsonReader::Impl {
+    Poco::JSON::Object::Ptr object;
+};
+
+Result<JsonReader> JsonReader::Parse(std::string_view text) {
+    try {
+        Poco::JSON::Parser parser;
+        auto parsed = parser.parse(std::string(text));
+        JsonReader reader;
+        reader.impl_ = std::make_shared<const Impl>(
+            Impl{parsed.extract<Poco::JSON::Object::Ptr>()});
+        return reader;
+    } catch (const std::exception& ex) {
+        return Error{ErrorCode::kInvalidArgument, std::string("invalid JSON body: ") + ex.what()};
+    }
+}
+
+bool JsonReader::Has(std::string_view key) const {
+    return impl_ && impl_->object->has(std::string(key));
+}
+
+// Poco reports type mismatches by throwing; the codec treats them as a schema mismatch.
+bool JsonReader::Get(std::string_view key, bool& value) const {
+    try {
+        value = impl_->object->getValue<bool>(std::string(key));
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool JsonReader::Get(std::string_view key, int& value) const {
+    try {
+        value = impl_->object->getValue<int>(std::string(key));
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool JsonReader::Get(std::string_view key, std::uint64_t& value) const {
+    try {
+        value = impl_->object->getValue<Poco::UInt64>(std::string(key));
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool JsonReader::Get(std::string_view key, std::string& value) const {
+    try {
+        value = impl_->object->getValue<std::string>(std::string(key));
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool JsonReader::GetStrings(std::string_view key, std::vector<std::string>& values) const {
+    try {
+        auto arr = impl_->object->getArray(std::string(key));
+        if (!arr) {
+            return false;
+        }
+        values.clear();
+        values.reserve(arr->size());
+        for (std::size_t i = 0; i < arr->size(); ++i) {
+            values.push_back(arr->getElement<std::string>(i));
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool JsonReader::GetChild(std::string_view key, JsonReader& value) const {
+    auto nested = impl_->object->getObject(std::string(key));
+    if (!nested) {
+        return false;
+    }
+    value.impl_ = std::make_shared<const Impl>(Impl{nested});
+    return true;
+}
+
+bool JsonReader::GetChildren(std::string_view key, std::vector<JsonReader>& values) const {
+    auto arr = impl_->object->getArray(std::string(key));
+    if (!arr) {
+        return false;
+    }
+    values.clear();
+    values.reserve(arr->size());
+    for (std::size_t i = 0; i < arr->size(); ++i) {
+        auto item = arr->getObject(static_cast<unsigned int>(i));
+        if (!item) {
+            return false;
+        }
+        JsonReader reader;
+        reader.impl_ = std::make_shared<const Impl>(Impl{item});
+        values.push_back(std::move(reader));
+    }
+    return true;
+}
+
+}  // namespace nebulafs::core
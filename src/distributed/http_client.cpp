@@ -10,6 +10,7 @@
 #include <Poco/Net/HTTPClientSession.h>
 #include <Poco/Net/HTTPRequest.h>
 #include <Poco/Net/HTTPResponse.h>
+#include <Poco/Timespan.h>
 #include <Poco/URI.h>
 
 #include "nebulafs/core/error.h"
@@ -19,12 +20,17 @@ namespace nebulafs::distributed {
 core::Result<HttpCallResult> SendHttpRequestStream(
     const std::string& method, const std::string& url, std::istream& body_stream,
     std::uint64_t content_length, const std::string& content_type,
-    const std::string& bearer_token, const std::map<std::string, std::string>& headers) {
+    const std::string& bearer_token, const std::map<std::string, std::string>& headers,
+    int timeout_ms) {
     try {
         Poco::URI uri(url);
         const std::string path_and_query = uri.getPathAndQuery().empty() ? "/" : uri.getPathAndQuery();
 
         Poco::Net::HTTPClientSession session(uri.getHost(), uri.getPort());
+        if (timeout_ms > 0) {
+            session.setTimeout(Poco::Timespan(static_cast<Poco::Timespan::TimeDiff>(timeout_ms) *
+                                              1000));
+        }
         Poco::Net::HTTPRequest request(method, path_and_query, Poco::Net::HTTPMessage::HTTP_1_1);
         request.set(Poco::Net::HTTPRequest::HOST, uri.getHost());
         request.set("User-Agent", "NebulaFS-Distributed");
@@ -67,10 +73,11 @@ core::Result<HttpCallResult> SendHttpRequest(const std::string& method, const st
                                              const std::string& body,
                                              const std::string& content_type,
                                              const std::string& bearer_token,
-                                             const std::map<std::string, std::string>& headers) {
+                                             const std::map<std::string, std::string>& headers,
+                                             int timeout_ms) {
     std::istringstream in(body);
     return SendHttpRequestStream(method, url, in, static_cast<std::uint64_t>(body.size()),
-                                 content_type, bearer_token, headers);
+                                 content_type, bearer_token, headers, timeout_ms);
 }
 
 }  // namespace nebulafs::distributed
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -14,11 +15,11 @@
 #include <type_traits>
 #include <vector>
 
+#include <Poco/JSON/Array.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Parser.h>
+#include <Poco/URI.h>
 #include <Poco/UUIDGenerator.h>
-#include <Poco/DigestEngine.h>
-#include <Poco/SHA2Engine.h>
 
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/dispatch.hpp>
@@ -27,14 +28,20 @@
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
 
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/core/hashing.h"
 #include "nebulafs/core/ids.h"
 #include "nebulafs/core/logger.h"
 #include "nebulafs/core/time.h"
 #include "nebulafs/distributed/http_client.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/metadata/object_listing.h"
 #include "nebulafs/observability/metrics.h"
 #include "nebulafs/auth/jwt_utils.h"
 #include "nebulafs/auth/jwt_verifier.h"
+#include "nebulafs/storage/compressed_object.h"
 #include "nebulafs/storage/local_storage.h"
+#include "nebulafs/storage/upload_pipeline.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -50,6 +57,17 @@ namespace net = boost::asio;
 using tcp = net::ip::tcp;
 
 constexpr std::size_t kBufferSize = 8192;
+constexpr std::streamoff kListChunkBytes = 16 * 1024;
+
+bool IsCrc32cHex(const std::string& value) {
+    return value.size() == 8 && std::all_of(value.begin(), value.end(), [](char c) {
+               return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+           });
+}
+// Each layout migration step runs on an IO thread, so it is kept short and followed by a pause
+// for the requests queued behind it.
+constexpr std::size_t kLayoutMigrationBatch = 1000;
+constexpr std::chrono::milliseconds kLayoutMigrationPause{50};
 
 class RateLimiter {
 public:
@@ -125,6 +143,86 @@ std::string GetQueryParam(const std::string& target, const std::string& key) {
     return "";
 }
 
+std::string DecodeQueryValue(const std::string& value) {
+    std::string decoded;
+    Poco::URI::decode(value, decoded, true);
+    return decoded;
+}
+
+std::optional<int> ParseMaxKeys(const std::string& value) {
+    if (value.empty()) {
+        return nebulafs::metadata::kMaxListKeys;
+    }
+    if (value.size() > 4 ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return std::nullopt;
+    }
+    const int parsed = std::stoi(value);
+    if (parsed > nebulafs::metadata::kMaxListKeys) {
+        return std::nullopt;
+    }
+    return parsed;
+}
+
+// Renders a listing page in bounded slices so it leaves as HTTP chunks while later entries are
+// still being serialized, rather than as one fully buffered JSON body.
+class ListingJsonWriter {
+public:
+    explicit ListingJsonWriter(nebulafs::metadata::ObjectListing listing)
+        : listing_(std::move(listing)) {
+    }
+
+    // Replaces `out` with the next slice; returns false once the document is complete.
+    bool Next(std::string& out) {
+        if (done_) {
+            return false;
+        }
+        std::ostringstream ss;
+        if (!started_) {
+            ss << "{\"objects\":[";
+            started_ = true;
+        }
+        while (next_object_ < listing_.objects.size() && ss.tellp() < kListChunkBytes) {
+            const auto& object = listing_.objects[next_object_];
+            if (next_object_++ > 0) {
+                ss << ',';
+            }
+            Poco::JSON::Object item;
+            item.set("name", object.name);
+            item.set("size", static_cast<Poco::UInt64>(object.size_bytes));
+            item.set("etag", object.etag);
+            item.set("updated_at", object.updated_at);
+            item.stringify(ss);
+        }
+        if (next_object_ == listing_.objects.size()) {
+            Poco::JSON::Array prefixes;
+            for (const auto& prefix : listing_.common_prefixes) {
+                prefixes.add(prefix);
+            }
+            ss << "],\"common_prefixes\":";
+            prefixes.stringify(ss);
+            ss << ",\"key_count\":"
+               << listing_.objects.size() + listing_.common_prefixes.size()
+               << ",\"is_truncated\":" << (listing_.is_truncated ? "true" : "false");
+            if (listing_.is_truncated) {
+                // Tokens are hex, so they need no JSON escaping.
+                ss << ",\"next_continuation_token\":\""
+                   << nebulafs::metadata::EncodeListCursor(listing_.next_cursor) << '"';
+            }
+            ss << '}';
+            done_ = true;
+        }
+        out = ss.str();
+        return true;
+    }
+
+private:
+    nebulafs::metadata::ObjectListing listing_;
+    std::size_t next_object_{0};
+    bool started_{false};
+    bool done_{false};
+};
+
 std::string BlobUrl(const std::string& endpoint, const std::string& blob_id) {
     if (!endpoint.empty() && endpoint.back() == '/') {
         return endpoint.substr(0, endpoint.size() - 1) + "/internal/v1/blobs/" + blob_id;
@@ -218,14 +316,15 @@ public:
             std::shared_ptr<nebulafs::storage::StorageBackend> storage,
             std::shared_ptr<nebulafs::metadata::MetadataBackend> metadata,
             std::shared_ptr<nebulafs::auth::JwtVerifier> auth_verifier,
-            std::shared_ptr<RateLimiter> rate_limiter)
+            std::shared_ptr<RateLimiter> rate_limiter, net::thread_pool* upload_pool)
         : stream_(std::move(stream)),
           router_(std::move(router)),
           config_(std::move(config)),
           storage_(std::move(storage)),
           metadata_(std::move(metadata)),
           auth_verifier_(std::move(auth_verifier)),
-          rate_limiter_(std::move(rate_limiter)) {
+          rate_limiter_(std::move(rate_limiter)),
+          upload_pool_(upload_pool) {
     }
 
     void Start() {
@@ -398,6 +497,10 @@ private:
         if (request.method() == http::verb::get && IsObjectPath(path)) {
             return HandleDownload(request, path);
         }
+        if (request.method() == http::verb::get &&
+            nebulafs::http::Router::Match("/v1/buckets/{bucket}/objects", path, nullptr)) {
+            return HandleListObjects(request, path);
+        }
 
         auto result = router_.Route(ctx, request);
         if (!result.ok()) {
@@ -492,6 +595,68 @@ private:
 
         upload_bucket_ = bucket;
         upload_object_ = object;
+        upload_content_crc32c_ = std::string(parser_->get()["x-content-crc32c"]);
+        if (!upload_content_crc32c_.empty() && !IsCrc32cHex(upload_content_crc32c_)) {
+            auto response = ErrorResponse(http::status::bad_request, parser_->get().version(),
+                                          "INVALID_CHECKSUM",
+                                          "x-content-crc32c must be 8 lowercase hex digits",
+                                          request_id_);
+            return Send(std::move(response));
+        }
+        // A client naming the body's SHA-256 may send no bytes at all; when the server already
+        // keeps that body the object just links to it.
+        upload_content_sha256_ = std::string(parser_->get()["x-content-sha256"]);
+        if (!upload_content_sha256_.empty()) {
+            if (!nebulafs::storage::LocalStorage::IsContentDigest(upload_content_sha256_)) {
+                auto response = ErrorResponse(http::status::bad_request, parser_->get().version(),
+                                              "INVALID_DIGEST",
+                                              "x-content-sha256 must be a lowercase hex SHA-256",
+                                              request_id_);
+                return Send(std::move(response));
+            }
+            auto linked = storage_->LinkObject(bucket, object, upload_content_sha256_);
+            if (linked.ok()) {
+                return CommitUpload(linked.value());
+            }
+            if (linked.error().code != nebulafs::core::ErrorCode::kNotFound) {
+                auto response = ErrorResponse(http::status::internal_server_error,
+                                              parser_->get().version(), "STORAGE_ERROR",
+                                              linked.error().message, request_id_);
+                return Send(std::move(response));
+            }
+        }
+        // The etag uses the bucket's checksum, except that a body named by its SHA-256 is
+        // checked and kept under it. In distributed mode the storage backend computes the etag,
+        // so the body is only hashed here to check a client's checksum.
+        using nebulafs::core::ChecksumAlgorithm;
+        const bool single_node = config_.server.mode != "distributed";
+        const auto algorithm =
+            single_node && upload_content_sha256_.empty() &&
+                    nebulafs::core::IsBucketListed(config_.storage.crc32c_buckets, bucket)
+                ? ChecksumAlgorithm::kCrc32c
+                : ChecksumAlgorithm::kSha256;
+        upload_hasher_.reset();
+        upload_crc32c_.reset();
+        upload_pipeline_.reset();
+        if (single_node || !upload_content_sha256_.empty()) {
+            upload_hasher_.emplace(algorithm);
+        }
+        if (!upload_content_crc32c_.empty() &&
+            (!upload_hasher_ || algorithm != ChecksumAlgorithm::kCrc32c)) {
+            upload_crc32c_.emplace(0);
+        }
+        upload_total_ = 0;
+        // Small bodies of known length go into the object's metadata row: no temp file, fsync
+        // or rename on the way in, and no file to open on the way out.
+        const auto length = parser_->content_length();
+        const auto inline_max = config_.storage.inline_max_bytes;
+        upload_inline_ = config_.server.mode != "distributed" && inline_max > 0 &&
+                         length.has_value() && *length <= static_cast<std::uint64_t>(inline_max);
+        if (upload_inline_) {
+            upload_inline_data_.clear();
+            upload_inline_data_.reserve(static_cast<std::size_t>(*length));
+            return DoReadUploadChunk();
+        }
         upload_temp_path_ =
             (std::filesystem::path(storage_->temp_path()) /
              Poco::UUIDGenerator().createOne().toString())
@@ -513,18 +678,38 @@ private:
                                           "failed to open temp file", request_id_);
             return Send(std::move(response));
         }
+        if (upload_pool_) {
+            // Writing and hashing move to worker threads, so they overlap with each other and
+            // with reading the next chunk off the socket.
+            upload_pipeline_ = std::make_shared<nebulafs::storage::UploadPipeline>(
+                *upload_pool_, stream_.get_executor(), upload_fd_, std::move(upload_hasher_),
+                upload_crc32c_, static_cast<std::size_t>(config_.storage.upload_pipeline.depth));
+            upload_hasher_.reset();
+            upload_crc32c_.reset();
+        }
 #endif
 
-        upload_hasher_.emplace();
-        upload_total_ = 0;
         DoReadUploadChunk();
     }
 
     void DoReadUploadChunk() {
+        char* data = body_buffer_.data();
+        std::size_t capacity = body_buffer_.size();
+        if (upload_pipeline_) {
+            upload_chunk_ = upload_pipeline_->Acquire();
+            if (!upload_chunk_) {
+                // The disk or the hash is behind the network; read on once a chunk comes back.
+                nebulafs::observability::RecordGatewayUploadPipelineStall();
+                return upload_pipeline_->WaitForChunk(
+                    [self = this->shared_from_this()] { self->DoReadUploadChunk(); });
+            }
+            data = upload_chunk_->data.data();
+            capacity = upload_chunk_->data.size();
+        }
         beast::get_lowest_layer(stream_).expires_after(
             std::chrono::milliseconds(config_.server.limits.request_timeout_ms));
-        parser_->get().body().data = body_buffer_.data();
-        parser_->get().body().size = body_buffer_.size();
+        parser_->get().body().data = data;
+        parser_->get().body().size = capacity;
         http::async_read(stream_, buffer_, *parser_,
                          beast::bind_front_handler(&Session::OnUploadChunk,
                                                    this->shared_from_this()));
@@ -541,8 +726,21 @@ private:
         if (RequestTimedOut()) {
             return SendRequestTimeout(parser_->get().version());
         }
+        if (upload_pipeline_) {
+            const auto bytes = upload_chunk_->data.size() - parser_->get().body().size;
+            upload_chunk_->size = bytes;
+            upload_pipeline_->Submit(std::move(upload_chunk_));
+            upload_total_ += static_cast<std::uint64_t>(bytes);
+            if (parser_->is_done()) {
+                return upload_pipeline_->WaitForDrain(
+                    [self = this->shared_from_this()] { self->FinishUpload(); });
+            }
+            return DoReadUploadChunk();
+        }
         const auto bytes = body_buffer_.size() - parser_->get().body().size;
-        if (bytes > 0) {
+        if (bytes > 0 && upload_inline_) {
+            upload_inline_data_.append(body_buffer_.data(), bytes);
+        } else if (bytes > 0) {
 #ifdef _WIN32
             upload_stream_.write(body_buffer_.data(), bytes);
 #else
@@ -551,7 +749,15 @@ private:
                 return FailUpload("failed to write temp file");
             }
 #endif
-            upload_hasher_->update(body_buffer_.data(), static_cast<unsigned int>(bytes));
+        }
+        if (bytes > 0) {
+            if (upload_hasher_) {
+                upload_hasher_->Update(body_buffer_.data(), bytes);
+            }
+            if (upload_crc32c_) {
+                *upload_crc32c_ = nebulafs::core::Crc32c(
+                    std::string_view(body_buffer_.data(), bytes), *upload_crc32c_);
+            }
             upload_total_ += static_cast<std::uint64_t>(bytes);
         }
 
@@ -562,13 +768,67 @@ private:
     }
 
     void FinishUpload() {
+        if (upload_pipeline_) {
+            const auto pipeline = std::move(upload_pipeline_);
+            if (auto status = pipeline->status(); !status.ok()) {
+                return FailUpload(status.error().message);
+            }
+            upload_hasher_ = pipeline->TakeHasher();
+            upload_crc32c_ = pipeline->TakeCrc32c();
+        }
+        if (!upload_inline_) {
 #ifdef _WIN32
-        upload_stream_.flush();
-        upload_stream_.close();
+            upload_stream_.flush();
+            upload_stream_.close();
 #else
-        ::fsync(upload_fd_);
-        ::close(upload_fd_);
+            ::fsync(upload_fd_);
+            ::close(upload_fd_);
 #endif
+        }
+        const auto received = upload_hasher_ ? upload_hasher_->HexDigest() : std::string();
+        if (!upload_content_sha256_.empty() && received != upload_content_sha256_) {
+            if (!upload_inline_) {
+                std::filesystem::remove(upload_temp_path_);
+            }
+            // An empty body asked for content the server does not keep; the client now sends it.
+            auto response =
+                upload_total_ == 0
+                    ? ErrorResponse(http::status::precondition_failed, parser_->get().version(),
+                                    "CONTENT_NOT_STORED", "content not stored; send the body",
+                                    request_id_)
+                    : ErrorResponse(http::status::bad_request, parser_->get().version(),
+                                    "DIGEST_MISMATCH", "body does not match x-content-sha256",
+                                    request_id_);
+            return Send(std::move(response));
+        }
+        if (!upload_content_crc32c_.empty() &&
+            (upload_crc32c_ ? nebulafs::core::Crc32cHex(*upload_crc32c_) : received) !=
+                upload_content_crc32c_) {
+            if (!upload_inline_) {
+                std::filesystem::remove(upload_temp_path_);
+            }
+            auto response = ErrorResponse(http::status::bad_request, parser_->get().version(),
+                                          "DIGEST_MISMATCH",
+                                          "body does not match x-content-crc32c", request_id_);
+            return Send(std::move(response));
+        }
+        if (upload_inline_) {
+            return FinishInlineUpload(received);
+        }
+        if (config_.server.mode != "distributed") {
+            // The temp file already holds the fsynced body and its etag, so it is renamed into
+            // place rather than copied and hashed a second time.
+            auto placed =
+                storage_->PlaceObject(upload_bucket_, upload_object_, upload_temp_path_, received);
+            if (!placed.ok()) {
+                std::filesystem::remove(upload_temp_path_);
+                auto response =
+                    ErrorResponse(http::status::internal_server_error, parser_->get().version(),
+                                  "STORAGE_ERROR", placed.error().message, request_id_);
+                return Send(std::move(response));
+            }
+            return CommitUpload(placed.value());
+        }
         std::ifstream input(upload_temp_path_, std::ios::binary);
         if (!input.is_open()) {
             auto response = ErrorResponse(http::status::internal_server_error,
@@ -585,11 +845,37 @@ private:
                               "STORAGE_ERROR", stored.error().message, request_id_);
             return Send(std::move(response));
         }
+        CommitUpload(stored.value());
+    }
 
+    void FinishInlineUpload(const std::string& etag) {
         nebulafs::metadata::ObjectMetadata meta;
         meta.name = upload_object_;
-        meta.size_bytes = stored.value().size_bytes;
-        meta.etag = stored.value().etag;
+        meta.size_bytes = upload_total_;
+        meta.etag = etag;
+        meta.inline_data = std::move(upload_inline_data_);
+        auto result = metadata_->UpsertObject(upload_bucket_, meta);
+        if (!result.ok()) {
+            auto response = ErrorResponse(http::status::internal_server_error,
+                                          parser_->get().version(), "METADATA_ERROR",
+                                          result.error().message, request_id_);
+            return Send(std::move(response));
+        }
+        // Only once the row holds the new body is the file of an earlier version removed.
+        // Reads prefer the row, so a file left behind by a failure here is never served.
+        auto removed = storage_->DeleteObject(upload_bucket_, upload_object_);
+        if (!removed.ok() && removed.error().code != nebulafs::core::ErrorCode::kNotFound) {
+            nebulafs::core::LogError("failed to remove the replaced file of " + upload_bucket_ +
+                                     "/" + upload_object_ + ": " + removed.error().message);
+        }
+        SendUploaded(meta);
+    }
+
+    void CommitUpload(const nebulafs::storage::StoredObject& stored) {
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = upload_object_;
+        meta.size_bytes = stored.size_bytes;
+        meta.etag = stored.etag;
 
         if (config_.server.mode != "distributed") {
             auto result = metadata_->UpsertObject(upload_bucket_, meta);
@@ -600,10 +886,18 @@ private:
                 return Send(std::move(response));
             }
         }
+        SendUploaded(meta);
+    }
 
+    void SendUploaded(const nebulafs::metadata::ObjectMetadata& meta) {
         auto response = JsonResponse(http::status::ok, parser_->get().version(),
                                      "{\"etag\":\"" + meta.etag + "\",\"size\":" +
                                          std::to_string(meta.size_bytes) + "}");
+        // A linked upload answers before reading any body the client sent anyway, and those
+        // bytes cannot be parsed as the next request.
+        if (!parser_->is_done()) {
+            response.keep_alive(false);
+        }
         Send(std::move(response));
     }
 
@@ -629,12 +923,27 @@ private:
         const auto bucket = params["bucket"];
         const auto object = params["object"];
 
+        // Support HTTP Range for large object reads and resumable downloads. The backend
+        // reads only the requested bytes, so a range of a distributed object fetches just the
+        // blobs (or segments of a composite object) it covers.
+        auto range_header = request[http::field::range];
+        if (auto body = FindInlineBody(bucket, object)) {
+            return SendInlineObject(request, *body, std::string(range_header));
+        }
+        if (!range_header.empty()) {
+            return HandleRangeDownload(request, bucket, object, std::string(range_header));
+        }
+
         auto storage_result = storage_->ReadObject(bucket, object);
         if (!storage_result.ok()) {
             auto response = ErrorResponse(http::status::not_found, request.version(),
                                           "OBJECT_NOT_FOUND", "object not found", request_id_);
             return Send(std::move(response));
         }
+        if (storage_result.value().compressed) {
+            return SendCompressedObject(request, storage_result.value().path, 0,
+                                        storage_result.value().size_bytes, false);
+        }
 
         beast::error_code ec;
         http::response<http::file_body> response{http::status::ok, request.version()};
@@ -645,41 +954,269 @@ private:
             return Send(std::move(err));
         }
 
-        const auto size = response.body().size();
         response.set(http::field::content_type, "application/octet-stream");
         response.set(http::field::accept_ranges, "bytes");
+        response.content_length(response.body().size());
+        Send(std::move(response));
+    }
 
-        // Support HTTP Range for large object reads and resumable downloads.
-        auto range_header = request[http::field::range];
-        if (!range_header.empty()) {
-            auto range = ParseRange(std::string(range_header), size);
+    // The row decides first: a file left by an earlier version may outlive the upsert that
+    // inlined the object, and must not shadow it. Single-node rows are a local lookup.
+    std::optional<std::string> FindInlineBody(const std::string& bucket,
+                                              const std::string& object) {
+        if (config_.server.mode == "distributed") {
+            return std::nullopt;
+        }
+        auto meta = metadata_->GetObject(bucket, object);
+        if (!meta.ok()) {
+            return std::nullopt;
+        }
+        return std::move(meta.value().inline_data);
+    }
+
+    void SendInlineObject(const nebulafs::http::HttpRequest& request, const std::string& body,
+                          const std::string& range_header) {
+        http::response<http::string_body> response{http::status::ok, request.version()};
+        if (range_header.empty()) {
+            response.body() = body;
+        } else {
+            const auto range = ParseRange(range_header, body.size());
             if (!range) {
                 auto err = ErrorResponse(http::status::range_not_satisfiable, request.version(),
                                          "INVALID_RANGE", "invalid range", request_id_);
-                err.set(http::field::content_range, "bytes */" + std::to_string(size));
+                err.set(http::field::content_range, "bytes */" + std::to_string(body.size()));
                 return Send(std::move(err));
             }
+            const auto last = std::min<std::uint64_t>(range->end, body.size() - 1);
             response.result(http::status::partial_content);
-            response.body().seek(range->start, ec);
-            if (ec) {
-                auto err = ErrorResponse(http::status::internal_server_error, request.version(),
-                                         "IO_ERROR", "failed to seek file", request_id_);
-                return Send(std::move(err));
-            }
-            const auto length = range->end - range->start + 1;
-            response.content_length(length);
+            response.body() = body.substr(range->start, last - range->start + 1);
             response.set(http::field::content_range,
-                         "bytes " + std::to_string(range->start) + "-" +
-                             std::to_string(range->end) + "/" + std::to_string(size));
-        } else {
-            response.content_length(size);
+                         "bytes " + std::to_string(range->start) + "-" + std::to_string(last) +
+                             "/" + std::to_string(body.size()));
+        }
+        response.set(http::field::content_type, "application/octet-stream");
+        response.set(http::field::accept_ranges, "bytes");
+        response.content_length(response.body().size());
+        Send(std::move(response));
+    }
+
+    // A compressed object is decoded one frame at a time as the response goes out, so a range
+    // costs only the frames it covers and a connection never holds more than one frame.
+    void SendCompressedObject(const nebulafs::http::HttpRequest& request, const std::string& path,
+                              std::uint64_t first, std::uint64_t end, bool partial) {
+        auto reader = nebulafs::storage::CompressedObjectReader::Open(path);
+        if (!reader.ok()) {
+            auto err = ErrorResponse(http::status::internal_server_error, request.version(),
+                                     "IO_ERROR", "failed to open file", request_id_);
+            return Send(std::move(err));
+        }
+        frame_reader_.emplace(std::move(reader.value()));
+        frame_next_ = first;
+        frame_end_ = std::min(end, frame_reader_->size());
+        auto header = std::make_shared<http::response<http::empty_body>>(
+            partial ? http::status::partial_content : http::status::ok, request.version());
+        header->set(http::field::content_type, "application/octet-stream");
+        header->set(http::field::accept_ranges, "bytes");
+        if (partial) {
+            header->set(http::field::content_range,
+                        "bytes " + std::to_string(first) + "-" + std::to_string(frame_end_ - 1) +
+                            "/" + std::to_string(frame_reader_->size()));
+        }
+        header->content_length(frame_end_ - std::min(frame_next_, frame_end_));
+        header->keep_alive(request.keep_alive());
+        PrepareResponse(*header);
+        auto serializer = std::make_shared<http::response_serializer<http::empty_body>>(*header);
+        http::async_write_header(
+            stream_, *serializer,
+            [self = this->shared_from_this(), header, serializer](beast::error_code ec,
+                                                                  std::size_t) {
+                if (ec) {
+                    nebulafs::core::LogError("Write failed: " + ec.message());
+                    return;
+                }
+                self->DoWriteFrame(header->need_eof());
+            });
+    }
+
+    void DoWriteFrame(bool close) {
+        if (frame_next_ >= frame_end_) {
+            frame_reader_.reset();
+            if (close) {
+                return DoClose();
+            }
+            return DoReadHeader();
+        }
+        const auto index = frame_reader_->FrameOf(frame_next_);
+        const auto started = std::chrono::steady_clock::now();
+        auto read = frame_reader_->ReadFrame(index, frame_chunk_);
+        nebulafs::observability::RecordGatewayDecompression(
+            1, std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - started)
+                   .count());
+        if (!read.ok()) {
+            // The header has gone out, so the only way left to fail is to cut the body short.
+            nebulafs::core::LogError("Read compressed object failed: " + read.error().message);
+            frame_reader_.reset();
+            return DoClose();
+        }
+        const auto frame_start = static_cast<std::uint64_t>(index) * frame_reader_->frame_bytes();
+        const auto from = static_cast<std::size_t>(frame_next_ - frame_start);
+        const auto to = static_cast<std::size_t>(
+            std::min<std::uint64_t>(frame_end_ - frame_start, frame_chunk_.size()));
+        frame_next_ = frame_start + to;
+        net::async_write(stream_, net::buffer(frame_chunk_.data() + from, to - from),
+                         beast::bind_front_handler(&Session::OnWriteFrame,
+                                                   this->shared_from_this(), close));
+    }
+
+    void OnWriteFrame(bool close, beast::error_code ec, std::size_t) {
+        if (ec) {
+            nebulafs::core::LogError("Write failed: " + ec.message());
+            return;
         }
+        DoWriteFrame(close);
+    }
 
+    void HandleRangeDownload(const nebulafs::http::HttpRequest& request, const std::string& bucket,
+                             const std::string& object, const std::string& range_header) {
+        // The object size is not known before the read, so open-ended ranges run to the end
+        // and the backend clamps them. An unparseable range asks for nothing, which still
+        // yields the size for the 416 response.
+        constexpr auto kUnbounded = std::numeric_limits<std::uint64_t>::max();
+        const auto requested = ParseRange(range_header, kUnbounded);
+        auto storage_result = storage_->ReadObjectRange(
+            bucket, object, requested ? requested->start : kUnbounded,
+            requested ? requested->end : kUnbounded);
+        if (!storage_result.ok()) {
+            auto response = ErrorResponse(http::status::not_found, request.version(),
+                                          "OBJECT_NOT_FOUND", "object not found", request_id_);
+            return Send(std::move(response));
+        }
+        const auto& range = storage_result.value();
+        if (range.path.empty()) {
+            auto err = ErrorResponse(http::status::range_not_satisfiable, request.version(),
+                                     "INVALID_RANGE", "invalid range", request_id_);
+            err.set(http::field::content_range, "bytes */" + std::to_string(range.object_size));
+            return Send(std::move(err));
+        }
+        if (range.compressed) {
+            return SendCompressedObject(request, range.path, range.first, range.last + 1, true);
+        }
+
+        beast::error_code ec;
+        http::response<http::file_body> response{http::status::partial_content,
+                                                 request.version()};
+        response.body().open(range.path.c_str(), beast::file_mode::scan, ec);
+        if (ec) {
+            auto err = ErrorResponse(http::status::internal_server_error, request.version(),
+                                     "IO_ERROR", "failed to open file", request_id_);
+            return Send(std::move(err));
+        }
+        response.set(http::field::content_type, "application/octet-stream");
+        response.set(http::field::accept_ranges, "bytes");
+        response.body().seek(range.path_offset, ec);
+        if (ec) {
+            auto err = ErrorResponse(http::status::internal_server_error, request.version(),
+                                     "IO_ERROR", "failed to seek file", request_id_);
+            return Send(std::move(err));
+        }
+        response.content_length(range.last - range.first + 1);
+        response.set(http::field::content_range,
+                     "bytes " + std::to_string(range.first) + "-" + std::to_string(range.last) +
+                         "/" + std::to_string(range.object_size));
         Send(std::move(response));
     }
 
+    void HandleListObjects(const nebulafs::http::HttpRequest& request, const std::string& path) {
+        nebulafs::http::RouteParams params;
+        nebulafs::http::Router::Match("/v1/buckets/{bucket}/objects", path, &params);
+        const auto target = std::string(request.target());
+
+        nebulafs::metadata::ListObjectsOptions options;
+        options.prefix = DecodeQueryValue(GetQueryParam(target, "prefix"));
+        options.delimiter = DecodeQueryValue(GetQueryParam(target, "delimiter"));
+        const auto max_keys = ParseMaxKeys(GetQueryParam(target, "max-keys"));
+        if (!max_keys) {
+            auto response = ErrorResponse(
+                http::status::bad_request, request.version(), "INVALID_ARGUMENT",
+                "max-keys must be between 0 and " +
+                    std::to_string(nebulafs::metadata::kMaxListKeys),
+                request_id_);
+            return Send(std::move(response));
+        }
+        options.max_keys = *max_keys;
+        const auto token = GetQueryParam(target, "continuation-token");
+        if (!token.empty()) {
+            auto cursor = nebulafs::metadata::DecodeListCursor(token);
+            if (!cursor) {
+                auto response = ErrorResponse(http::status::bad_request, request.version(),
+                                              "INVALID_ARGUMENT", "invalid continuation token",
+                                              request_id_);
+                return Send(std::move(response));
+            }
+            options.cursor = std::move(*cursor);
+        }
+
+        auto listing = metadata_->ListObjectsPage(params["bucket"], options);
+        if (!listing.ok()) {
+            auto response = ErrorResponse(http::status::internal_server_error, request.version(),
+                                          "DB_ERROR", listing.error().message, request_id_);
+            return Send(std::move(response));
+        }
+
+        auto header = std::make_shared<http::response<http::empty_body>>(http::status::ok,
+                                                                         request.version());
+        header->set(http::field::content_type, "application/json");
+        header->keep_alive(request.keep_alive());
+        header->chunked(true);
+        list_writer_.emplace(std::move(listing.value()));
+        PrepareResponse(*header);
+        auto serializer = std::make_shared<http::response_serializer<http::empty_body>>(*header);
+        http::async_write_header(
+            stream_, *serializer,
+            [self = this->shared_from_this(), header, serializer](beast::error_code ec,
+                                                                  std::size_t) {
+                if (ec) {
+                    nebulafs::core::LogError("Write failed: " + ec.message());
+                    return;
+                }
+                self->DoWriteListChunk(header->need_eof());
+            });
+    }
+
+    void DoWriteListChunk(bool close) {
+        if (!list_writer_->Next(list_chunk_)) {
+            list_writer_.reset();
+            return net::async_write(stream_, http::make_chunk_last(),
+                                    beast::bind_front_handler(&Session::OnWriteListEnd,
+                                                              this->shared_from_this(), close));
+        }
+        net::async_write(stream_, http::make_chunk(net::buffer(list_chunk_)),
+                         beast::bind_front_handler(&Session::OnWriteListChunk,
+                                                   this->shared_from_this(), close));
+    }
+
+    void OnWriteListChunk(bool close, beast::error_code ec, std::size_t) {
+        if (ec) {
+            nebulafs::core::LogError("Write failed: " + ec.message());
+            return;
+        }
+        DoWriteListChunk(close);
+    }
+
+    void OnWriteListEnd(bool close, beast::error_code ec, std::size_t) {
+        if (ec) {
+            nebulafs::core::LogError("Write failed: " + ec.message());
+            return;
+        }
+        if (close) {
+            return DoClose();
+        }
+        DoReadHeader();
+    }
+
     template <typename Body>
-    void Send(http::response<Body>&& response) {
+    void PrepareResponse(http::response<Body>& response) {
         // Disable read deadline while writing a response to avoid write-side timeout races.
         beast::get_lowest_layer(stream_).expires_never();
         response.set(http::field::server, "NebulaFS");
@@ -690,6 +1227,11 @@ private:
         nebulafs::core::LogRequest(request_id_, request_method_, request_target_, request_remote_,
                                    response.result_int(), latency);
         nebulafs::observability::RecordRequest(response.result_int(), latency);
+    }
+
+    template <typename Body>
+    void Send(http::response<Body>&& response) {
+        PrepareResponse(response);
         auto sp = std::make_shared<http::response<Body>>(std::move(response));
         http::async_write(stream_, *sp,
                           beast::bind_front_handler(&Session::OnWrite<Body>,
@@ -766,17 +1308,34 @@ private:
     bool timeout_response_sent_{false};
     std::string body_;
     std::optional<nebulafs::auth::JwtClaims> auth_claims_;
+    std::optional<ListingJsonWriter> list_writer_;
+    std::string list_chunk_;
+    // Set while a compressed object streams out; bytes `frame_next_`..`frame_end_` remain.
+    std::optional<nebulafs::storage::CompressedObjectReader> frame_reader_;
+    std::uint64_t frame_next_{0};
+    std::uint64_t frame_end_{0};
+    std::string frame_chunk_;
 
     std::string upload_bucket_;
     std::string upload_object_;
     std::string upload_temp_path_;
-    std::optional<Poco::SHA2Engine256> upload_hasher_;
+    std::string upload_content_sha256_;
+    bool upload_inline_{false};
+    std::string upload_inline_data_;
+    std::string upload_content_crc32c_;
+    std::optional<nebulafs::core::ObjectHasher> upload_hasher_;
+    // Running CRC-32C when the client sent one and the etag is not already that checksum.
+    std::optional<std::uint32_t> upload_crc32c_;
     std::uint64_t upload_total_{0};
 #ifdef _WIN32
     std::ofstream upload_stream_;
 #else
     int upload_fd_{-1};
 #endif
+    net::thread_pool* upload_pool_{nullptr};
+    // Set while a body streams through the worker stages; null when written inline.
+    std::shared_ptr<nebulafs::storage::UploadPipeline> upload_pipeline_;
+    std::shared_ptr<nebulafs::storage::UploadChunk> upload_chunk_;
 };
 
 class Listener : public std::enable_shared_from_this<Listener> {
@@ -787,7 +1346,7 @@ public:
              std::shared_ptr<nebulafs::metadata::MetadataBackend> metadata,
              std::shared_ptr<nebulafs::auth::JwtVerifier> auth_verifier,
              std::shared_ptr<RateLimiter> rate_limiter,
-             net::ssl::context* ssl_ctx)
+             net::ssl::context* ssl_ctx, net::thread_pool* upload_pool)
         : acceptor_(ioc),
           router_(std::move(router)),
           config_(std::move(config)),
@@ -795,7 +1354,8 @@ public:
           metadata_(std::move(metadata)),
           auth_verifier_(std::move(auth_verifier)),
           rate_limiter_(std::move(rate_limiter)),
-          ssl_ctx_(ssl_ctx) {
+          ssl_ctx_(ssl_ctx),
+          upload_pool_(upload_pool) {
         beast::error_code ec;
         acceptor_.open(endpoint.protocol(), ec);
         acceptor_.set_option(net::socket_base::reuse_address(true), ec);
@@ -819,13 +1379,13 @@ private:
                 auto stream = beast::ssl_stream<beast::tcp_stream>(std::move(socket), *ssl_ctx_);
                 std::make_shared<Session<beast::ssl_stream<beast::tcp_stream>>>(
                     std::move(stream), router_, config_, storage_, metadata_, auth_verifier_,
-                    rate_limiter_)
+                    rate_limiter_, upload_pool_)
                     ->Start();
             } else {
                 auto stream = beast::tcp_stream(std::move(socket));
                 std::make_shared<Session<beast::tcp_stream>>(std::move(stream), router_, config_,
                                                              storage_, metadata_, auth_verifier_,
-                                                             rate_limiter_)
+                                                             rate_limiter_, upload_pool_)
                     ->Start();
             }
         }
@@ -840,6 +1400,7 @@ private:
     std::shared_ptr<nebulafs::auth::JwtVerifier> auth_verifier_;
     std::shared_ptr<RateLimiter> rate_limiter_;
     net::ssl::context* ssl_ctx_{nullptr};
+    net::thread_pool* upload_pool_{nullptr};
 };
 
 }  // namespace
@@ -853,17 +1414,25 @@ HttpServer::HttpServer(boost::asio::io_context& ioc, const core::Config& config,
       config_(config),
       router_(std::move(router)),
       storage_(std::move(storage)),
-      metadata_(std::move(metadata)) {
+      metadata_(std::move(metadata)),
+      cleanup_holder_(config_.server.host + ":" + std::to_string(config_.server.port) + "/" +
+                      core::GenerateRequestId()) {
     auth_verifier_ = std::make_shared<nebulafs::auth::JwtVerifier>(config_.auth);
     if (config_.server.tls.enabled) {
         ssl_context_ = std::make_unique<net::ssl::context>(net::ssl::context::tlsv12_server);
         ssl_context_->use_certificate_chain_file(config_.server.tls.certificate);
         ssl_context_->use_private_key_file(config_.server.tls.private_key, net::ssl::context::pem);
     }
+    if (config_.storage.upload_pipeline.threads > 0) {
+        upload_pool_ = std::make_unique<net::thread_pool>(
+            static_cast<std::size_t>(config_.storage.upload_pipeline.threads));
+    }
 }
 
 void HttpServer::Run() {
     StartCleanupJob();
+    layout_timer_ = std::make_unique<net::steady_timer>(ioc_);
+    ScheduleLayoutMigration(std::chrono::milliseconds(0));
     auto rate_limiter = std::make_shared<RateLimiter>(config_.server.limits.rate_limit_rps,
                                                       config_.server.limits.rate_limit_burst);
 
@@ -872,7 +1441,7 @@ void HttpServer::Run() {
 
     std::make_shared<Listener>(ioc_, endpoint, router_, config_, storage_, metadata_,
                                auth_verifier_, rate_limiter,
-                               ssl_context_ ? ssl_context_.get() : nullptr)
+                               ssl_context_ ? ssl_context_.get() : nullptr, upload_pool_.get())
         ->Run();
 }
 
@@ -895,11 +1464,79 @@ void HttpServer::ScheduleCleanupSweep() {
             return;
         }
         RunCleanupSweep();
+        ReclaimStoredContent();
         ScheduleCleanupSweep();
     });
 }
 
+void HttpServer::ReclaimStoredContent() {
+    // Deletes and overwrites only drop an object's link to its body; bodies left with no
+    // object are removed here rather than on every delete, which would have to find them.
+    auto reclaimed = storage_->ReclaimContent();
+    if (!reclaimed.ok()) {
+        nebulafs::core::LogError("Content reclaim failed: " + reclaimed.error().message);
+    } else if (reclaimed.value() > 0) {
+        nebulafs::core::LogInfo("Content reclaim removed " + std::to_string(reclaimed.value()) +
+                                " unreferenced bodies");
+    }
+}
+
+void HttpServer::ScheduleLayoutMigration(std::chrono::milliseconds delay) {
+    layout_timer_->expires_after(delay);
+    layout_timer_->async_wait([this](const beast::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        // Buckets switch layout before serving, so no new flat objects appear and the
+        // migration can stop for good once a step finds nothing; a failed step resumes on the
+        // next start.
+        auto moved = storage_->MigrateObjectLayout(kLayoutMigrationBatch);
+        if (!moved.ok()) {
+            nebulafs::core::LogError("Object layout migration failed: " + moved.error().message);
+            return;
+        }
+        if (moved.value() == 0) {
+            return;
+        }
+        nebulafs::core::LogDebug("Object layout migration moved " +
+                                 std::to_string(moved.value()) + " objects");
+        ScheduleLayoutMigration(kLayoutMigrationPause);
+    });
+}
+
+core::Result<metadata::Lease> HttpServer::AcquireCleanupLease() {
+    metadata::BatchOp op;
+    op.type = metadata::BatchOpType::kAcquireLease;
+    op.lease = kCleanupLeaseName;
+    op.lease_holder = cleanup_holder_;
+    op.lease_ttl_ms = static_cast<std::uint64_t>(config_.cleanup.lease_ttl_seconds) * 1000;
+    // Judged by this gateway's clock rather than the lease's expiry, which is the metadata
+    // service's; renewing at half the term leaves room for skew and slow calls.
+    const auto renew_at = std::chrono::steady_clock::now() +
+                          std::chrono::seconds(config_.cleanup.lease_ttl_seconds) / 2;
+    auto acquired = metadata_->ExecuteBatch({op});
+    if (!acquired.ok()) {
+        return acquired.error();
+    }
+    cleanup_lease_renew_at_ = renew_at;
+    return std::move(acquired.value().front().lease);
+}
+
 void HttpServer::RunCleanupSweep() {
+    // Only the gateway holding the lease sweeps, so N gateways list and delete each expired
+    // upload once rather than N times.
+    auto lease = AcquireCleanupLease();
+    if (!lease.ok()) {
+        if (lease.error().code == core::ErrorCode::kFailedPrecondition) {
+            observability::RecordGatewayCleanupSweepSkipped();
+            nebulafs::core::LogDebug("Cleanup sweep skipped: " + lease.error().message);
+        } else {
+            nebulafs::core::LogError("Cleanup sweep failed to acquire lease: " +
+                                     lease.error().message);
+        }
+        return;
+    }
+
     const auto cutoff = nebulafs::core::NowIso8601WithOffsetSeconds(
         -config_.cleanup.grace_period_seconds);
     auto expired = metadata_->ListExpiredMultipartUploads(
@@ -911,6 +1548,46 @@ void HttpServer::RunCleanupSweep() {
     }
 
     for (const auto& upload : expired.value()) {
+        if (std::chrono::steady_clock::now() >= cleanup_lease_renew_at_) {
+            lease = AcquireCleanupLease();
+            if (!lease.ok()) {
+                nebulafs::core::LogError("Cleanup sweep stopped; lease not renewed: " +
+                                         lease.error().message);
+                return;
+            }
+        }
+        // Retire the upload before touching its data. The lease check fences out a gateway
+        // that lost the lease while paused, and the state check makes a racing complete or
+        // abort (which expects the state it read) fail instead of committing on blobs this
+        // sweep is about to delete.
+        std::vector<metadata::BatchOp> retire{metadata::LeaseCheckOp(lease.value())};
+        auto& expire = retire.emplace_back();
+        expire.type = metadata::BatchOpType::kUpdateMultipartUploadState;
+        expire.upload_id = upload.upload_id;
+        expire.state = "expired";
+        expire.expect_upload_state = upload.state;
+        auto retired = metadata_->ExecuteBatch(retire);
+        if (!retired.ok()) {
+            if (retired.error().code == core::ErrorCode::kFailedPrecondition) {
+                // Either the lease or the upload moved on; only the former ends the sweep.
+                auto held = metadata_->ExecuteBatch({metadata::LeaseCheckOp(lease.value())});
+                if (!held.ok()) {
+                    nebulafs::core::LogError("Cleanup sweep stopped; lease lost: " +
+                                             held.error().message);
+                    return;
+                }
+                nebulafs::core::LogDebug("Cleanup sweep skipped multipart upload " +
+                                         upload.upload_id + ": " + retired.error().message);
+                continue;
+            }
+            nebulafs::core::LogError("Cleanup sweep failed to retire multipart upload " +
+                                     upload.upload_id + ": " + retired.error().message);
+            if (config_.server.mode == "distributed") {
+                observability::RecordGatewayDistributedCleanupUpload(false);
+            }
+            continue;
+        }
+
         bool upload_success = true;
         if (config_.server.mode == "distributed") {
             auto parts = metadata_->ListMultipartParts(upload.upload_id);
@@ -954,30 +1631,30 @@ void HttpServer::RunCleanupSweep() {
             }
         }
 
-        auto mark_expired = metadata_->UpdateMultipartUploadState(upload.upload_id, "expired");
-        if (!mark_expired.ok()) {
-            upload_success = false;
-            nebulafs::core::LogError("Cleanup sweep failed to mark upload expired for " +
-                                     upload.upload_id + ": " + mark_expired.error().message);
-        }
-        auto delete_parts = metadata_->DeleteMultipartParts(upload.upload_id);
-        if (!delete_parts.ok()) {
-            upload_success = false;
-            nebulafs::core::LogError("Cleanup sweep failed to delete multipart parts for " +
-                                     upload.upload_id + ": " + delete_parts.error().message);
-        }
-        auto delete_upload = metadata_->DeleteMultipartUpload(upload.upload_id);
-        if (!delete_upload.ok()) {
-            upload_success = false;
-            nebulafs::core::LogError("Cleanup sweep failed to delete multipart upload " +
-                                     upload.upload_id + ": " + delete_upload.error().message);
-        }
-
         std::error_code ec;
         const auto path = std::filesystem::path(storage_->temp_path()) / "multipart" /
                           upload.upload_id;
         std::filesystem::remove_all(path, ec);
 
+        // An upload whose blobs are not all gone stays "expired", and a later sweep lists it
+        // and retries; nothing can complete it in the meantime.
+        if (upload_success) {
+            std::vector<metadata::BatchOp> remove{metadata::LeaseCheckOp(lease.value())};
+            for (const auto type : {metadata::BatchOpType::kDeleteMultipartParts,
+                                    metadata::BatchOpType::kDeleteMultipartUpload}) {
+                auto& op = remove.emplace_back();
+                op.type = type;
+                op.upload_id = upload.upload_id;
+                op.expect_upload_state = "expired";
+            }
+            auto removed = metadata_->ExecuteBatch(remove);
+            if (!removed.ok()) {
+                upload_success = false;
+                nebulafs::core::LogError("Cleanup sweep failed to delete multipart upload " +
+                                         upload.upload_id + ": " + removed.error().message);
+            }
+        }
+
         if (config_.server.mode == "distributed") {
             observability::RecordGatewayDistributedCleanupUpload(upload_success);
         }
@@ -0,0 +1,344 @@
+#include "nebulafs/http/multipart_complete.h"
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <system_error>
+
+#include "nebulafs/core/hashing.h"
+
+namespace nebulafs::http {
+
+namespace {
+
+// Nesting allowed inside values this parser skips; bounds recursion on hostile bodies.
+constexpr int kMaxSkipDepth = 32;
+
+core::Error Invalid(const std::string& message) {
+    return core::Error{core::ErrorCode::kInvalidArgument, message};
+}
+
+class Scanner {
+public:
+    explicit Scanner(std::string_view text) : text_(text) {}
+
+    bool AtEnd() {
+        SkipSpace();
+        return pos_ == text_.size();
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool ReadString(std::string& out) {
+        if (!Consume('"')) {
+            return false;
+        }
+        out.clear();
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ == text_.size() || !ReadEscape(out)) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool ReadInt(std::int64_t& value) {
+        SkipSpace();
+        const auto* begin = text_.data() + pos_;
+        const auto* end = text_.data() + text_.size();
+        const auto [next, ec] = std::from_chars(begin, end, value);
+        if (ec != std::errc() || next == begin) {
+            return false;
+        }
+        pos_ += static_cast<std::size_t>(next - begin);
+        // A fraction or exponent makes the number something other than a part number.
+        return pos_ == text_.size() || (text_[pos_] != '.' && text_[pos_] != 'e' &&
+                                        text_[pos_] != 'E');
+    }
+
+    bool SkipValue(int depth = 0) {
+        if (depth > kMaxSkipDepth) {
+            return false;
+        }
+        SkipSpace();
+        if (pos_ == text_.size()) {
+            return false;
+        }
+        std::string scratch;
+        switch (text_[pos_]) {
+            case '"':
+                return ReadString(scratch);
+            case '{':
+                ++pos_;
+                if (Consume('}')) {
+                    return true;
+                }
+                do {
+                    if (!ReadString(scratch) || !Consume(':') || !SkipValue(depth + 1)) {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume('}');
+            case '[':
+                ++pos_;
+                if (Consume(']')) {
+                    return true;
+                }
+                do {
+                    if (!SkipValue(depth + 1)) {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume(']');
+            default:
+                return SkipLiteral();
+        }
+    }
+
+private:
+    void SkipSpace() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r' || text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    // Numbers, true, false and null: a run of the characters they may contain.
+    bool SkipLiteral() {
+        const auto start = pos_;
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_];
+            const bool literal = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' ||
+                                 c == '+' || c == '.' || c == 'E';
+            if (!literal) {
+                break;
+            }
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    bool ReadEscape(std::string& out) {
+        const char c = text_[pos_++];
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                out.push_back(c);
+                return true;
+            case 'b':
+                out.push_back('\b');
+                return true;
+            case 'f':
+                out.push_back('\f');
+                return true;
+            case 'n':
+                out.push_back('\n');
+                return true;
+            case 'r':
+                out.push_back('\r');
+                return true;
+            case 't':
+                out.push_back('\t');
+                return true;
+            case 'u':
+                return ReadCodeUnit(out);
+            default:
+                return false;
+        }
+    }
+
+    // Encodes one `\uXXXX` as UTF-8; surrogate pairs are not valid in part etags and are
+    // rejected rather than combined.
+    bool ReadCodeUnit(std::string& out) {
+        if (text_.size() - pos_ < 4) {
+            return false;
+        }
+        unsigned code = 0;
+        const auto* begin = text_.data() + pos_;
+        const auto [next, ec] = std::from_chars(begin, begin + 4, code, 16);
+        if (ec != std::errc() || next != begin + 4 || (code >= 0xd800 && code <= 0xdfff)) {
+            return false;
+        }
+        pos_ += 4;
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        return true;
+    }
+
+    std::string_view text_;
+    std::size_t pos_{0};
+};
+
+core::Result<CompletePart> ParsePart(Scanner& in) {
+    if (!in.Consume('{')) {
+        return Invalid("invalid part entry");
+    }
+    CompletePart part;
+    std::int64_t part_number = 0;
+    bool has_number = false;
+    bool has_etag = false;
+    std::string key;
+    if (!in.Consume('}')) {
+        do {
+            if (!in.ReadString(key) || !in.Consume(':')) {
+                return Invalid("invalid part entry");
+            }
+            bool ok = true;
+            if (key == "part_number") {
+                ok = in.ReadInt(part_number);
+                has_number = ok;
+            } else if (key == "etag") {
+                ok = in.ReadString(part.etag);
+                has_etag = ok;
+            } else {
+                ok = in.SkipValue();
+            }
+            if (!ok) {
+                return Invalid("invalid part entry");
+            }
+        } while (in.Consume(','));
+        if (!in.Consume('}')) {
+            return Invalid("invalid part entry");
+        }
+    }
+    if (!has_number || !has_etag || part_number <= 0 ||
+        part_number > std::numeric_limits<int>::max() || part.etag.empty()) {
+        return Invalid("invalid part_number or etag");
+    }
+    part.part_number = static_cast<int>(part_number);
+    return part;
+}
+
+}  // namespace
+
+core::Result<std::vector<CompletePart>> ParseCompleteParts(std::string_view body) {
+    Scanner in(body);
+    if (!in.Consume('{')) {
+        return Invalid("request body must be a JSON object");
+    }
+    std::vector<CompletePart> parts;
+    bool has_parts = false;
+    std::string key;
+    if (!in.Consume('}')) {
+        do {
+            if (!in.ReadString(key) || !in.Consume(':')) {
+                return Invalid("invalid JSON body");
+            }
+            if (key != "parts") {
+                if (!in.SkipValue()) {
+                    return Invalid("invalid JSON body");
+                }
+                continue;
+            }
+            if (!in.Consume('[')) {
+                return Invalid("parts must be an array");
+            }
+            has_parts = true;
+            parts.clear();
+            if (in.Consume(']')) {
+                continue;
+            }
+            do {
+                auto part = ParsePart(in);
+                if (!part.ok()) {
+                    return part.error();
+                }
+                if (!parts.empty() && part.value().part_number <= parts.back().part_number) {
+                    return Invalid("parts must be strictly increasing");
+                }
+                parts.push_back(std::move(part.value()));
+            } while (in.Consume(','));
+            if (!in.Consume(']')) {
+                return Invalid("invalid JSON body");
+            }
+        } while (in.Consume(','));
+        if (!in.Consume('}')) {
+            return Invalid("invalid JSON body");
+        }
+    }
+    if (!in.AtEnd()) {
+        return Invalid("invalid JSON body");
+    }
+    if (!has_parts || parts.empty()) {
+        return Invalid("parts list is required");
+    }
+    return parts;
+}
+
+core::Result<std::vector<const metadata::MultipartPart*>> MatchCompleteParts(
+    const std::vector<CompletePart>& requested,
+    const std::vector<metadata::MultipartPart>& uploaded) {
+    std::vector<const metadata::MultipartPart*> matched;
+    matched.reserve(requested.size());
+    auto it = uploaded.begin();
+    for (const auto& part : requested) {
+        while (it != uploaded.end() && it->part_number < part.part_number) {
+            ++it;
+        }
+        if (it == uploaded.end() || it->part_number != part.part_number) {
+            return core::Error{core::ErrorCode::kNotFound,
+                               "missing uploaded part " + std::to_string(part.part_number)};
+        }
+        if (it->etag != part.etag) {
+            return core::Error{core::ErrorCode::kFailedPrecondition,
+                               "part etag mismatch for part " + std::to_string(part.part_number)};
+        }
+        matched.push_back(&*it);
+    }
+    return matched;
+}
+
+core::Result<std::uint64_t> CheckInPlaceLayout(
+    const std::vector<const metadata::MultipartPart*>& parts, std::uint64_t part_size) {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        const auto& part = *parts[i];
+        const bool last = i + 1 == parts.size();
+        if (part.part_number != static_cast<int>(i + 1) ||
+            (last ? part.size_bytes > part_size : part.size_bytes != part_size)) {
+            return core::Error{core::ErrorCode::kFailedPrecondition,
+                               "part " + std::to_string(part.part_number) +
+                                   " does not fit the declared part_size layout"};
+        }
+        total += part.size_bytes;
+    }
+    return total;
+}
+
+std::string CompositeEtag(const std::vector<const metadata::MultipartPart*>& parts) {
+    core::Sha256Hasher sha256;
+    for (const auto* part : parts) {
+        sha256.Update(part->etag);
+    }
+    return sha256.HexDigest() + "-" + std::to_string(parts.size());
+}
+
+}  // namespace nebulafs::http
@@ -1,52 +1,36 @@
 #include "nebulafs/http/route_registration.h"
 
 #include <algorithm>
-#include <array>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <initializer_list>
+#include <iterator>
 #include <optional>
 #include <sstream>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-#include <Poco/DigestEngine.h>
 #include <Poco/JSON/Array.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Parser.h>
-#include <Poco/SHA2Engine.h>
+#include <Poco/URI.h>
 #include <Poco/UUIDGenerator.h>
 
+#include "nebulafs/core/hashing.h"
+#include "nebulafs/core/logger.h"
 #include "nebulafs/core/time.h"
 #include "nebulafs/distributed/http_client.h"
+#include "nebulafs/http/multipart_complete.h"
+#include "nebulafs/metadata/metadata_batch.h"
 #include "nebulafs/metadata/metadata_store.h"
 #include "nebulafs/observability/metrics.h"
 #include "nebulafs/storage/local_storage.h"
+#include "nebulafs/storage/part_assembler.h"
 
 namespace nebulafs::http {
 namespace {
 
-std::string GetQueryParam(const std::string& target, const std::string& key) {
-    auto pos = target.find('?');
-    if (pos == std::string::npos) {
-        return "";
-    }
-    auto query = target.substr(pos + 1);
-    std::stringstream ss(query);
-    std::string item;
-    while (std::getline(ss, item, '&')) {
-        auto eq = item.find('=');
-        if (eq == std::string::npos) {
-            continue;
-        }
-        if (item.substr(0, eq) == key) {
-            return item.substr(eq + 1);
-        }
-    }
-    return "";
-}
-
 std::optional<int> ParsePositiveInt(const std::string& value) {
     if (value.empty()) {
         return std::nullopt;
@@ -70,10 +54,6 @@ std::string BlobUrl(const std::string& endpoint, const std::string& blob_id) {
     return endpoint + "/internal/v1/blobs/" + blob_id;
 }
 
-std::string BlobComposeUrl(const std::string& endpoint, const std::string& blob_id) {
-    return BlobUrl(endpoint, blob_id) + "/compose";
-}
-
 struct DistributedPartLocator {
     std::string blob_id;
     std::vector<std::string> endpoints;
@@ -118,66 +98,6 @@ void BestEffortDeletePartBlob(const DistributedPartLocator& locator, const std::
     }
 }
 
-void BestEffortDeleteBlobReplicas(const std::string& blob_id,
-                                  const std::vector<metadata::ReplicaTarget>& replicas,
-                                  const std::string& token) {
-    observability::RecordGatewayMultipartRollbackAttempt();
-    for (const auto& replica : replicas) {
-        auto del = distributed::SendHttpRequest("DELETE", BlobUrl(replica.endpoint, blob_id), "", "",
-                                                token, {});
-        if (!del.ok() || (del.value().status != 200 && del.value().status != 404)) {
-            observability::RecordGatewayMultipartRollbackFailure();
-        }
-    }
-}
-
-struct ComposeBlobResult {
-    std::uint64_t size_bytes{0};
-    std::string etag;
-};
-
-core::Result<ComposeBlobResult> ComposeBlobOnNode(const std::string& endpoint,
-                                                  const std::string& target_blob_id,
-                                                  const std::vector<std::string>& source_blob_ids,
-                                                  const std::string& service_token,
-                                                  const std::string& placement_token) {
-    Poco::JSON::Array::Ptr source_array = new Poco::JSON::Array();
-    for (const auto& source_blob_id : source_blob_ids) {
-        source_array->add(source_blob_id);
-    }
-    Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-    root->set("source_blob_ids", source_array);
-    std::ostringstream body;
-    root->stringify(body);
-
-    auto compose =
-        distributed::SendHttpRequest("POST", BlobComposeUrl(endpoint, target_blob_id), body.str(),
-                                     "application/json", service_token,
-                                     {{"X-Placement-Token", placement_token}});
-    if (!compose.ok()) {
-        return compose.error();
-    }
-    if (compose.value().status != 200) {
-        return core::Error{core::ErrorCode::kIoError, "compose failed with status " +
-                                                         std::to_string(compose.value().status)};
-    }
-
-    try {
-        Poco::JSON::Parser parser;
-        auto parsed = parser.parse(compose.value().body).extract<Poco::JSON::Object::Ptr>();
-        ComposeBlobResult result;
-        result.size_bytes = parsed->getValue<Poco::UInt64>("size_bytes");
-        result.etag = parsed->getValue<std::string>("etag");
-        if (result.etag.empty()) {
-            return core::Error{core::ErrorCode::kIoError, "compose response missing etag"};
-        }
-        return result;
-    } catch (const std::exception& ex) {
-        return core::Error{core::ErrorCode::kIoError,
-                           "invalid compose response: " + std::string(ex.what())};
-    }
-}
-
 std::string MultipartPartPath(const std::string& temp_root, const std::string& upload_id,
                               int part_number) {
     return (std::filesystem::path(temp_root) / "multipart" / upload_id /
@@ -189,6 +109,16 @@ std::filesystem::path MultipartUploadDir(const std::string& temp_root, const std
     return std::filesystem::path(temp_root) / "multipart" / upload_id;
 }
 
+// Single file holding every part of an upload with a declared part size, each at its offset.
+std::string MultipartInPlacePath(const std::string& temp_root, const std::string& upload_id) {
+    return (MultipartUploadDir(temp_root, upload_id) / "object").string();
+}
+
+// Limits for uploads that declare a part size; together they keep part offsets far from
+// overflow.
+constexpr std::uint64_t kMaxDeclaredPartSize = 5ULL << 30;
+constexpr int kMaxInPlaceParts = 10000;
+
 HttpResponse JsonOk(int version, const std::string& body) {
     HttpResponse response{boost::beast::http::status::ok, version};
     response.set(boost::beast::http::field::content_type, "application/json");
@@ -207,68 +137,435 @@ HttpResponse JsonError(int version, const std::string& code, const std::string&
     return response;
 }
 
+Poco::JSON::Object::Ptr BucketStatsJson(const metadata::BucketStats& stats) {
+    Poco::JSON::Object::Ptr obj = new Poco::JSON::Object();
+    obj->set("object_count", static_cast<Poco::UInt64>(stats.object_count));
+    obj->set("total_bytes", static_cast<Poco::UInt64>(stats.total_bytes));
+    obj->set("multipart_bytes", static_cast<Poco::UInt64>(stats.multipart_bytes));
+    return obj;
+}
+
+// Runs the stats ops of `types` on `bucket` in one batch.
+HttpResponse BucketStatsRequest(metadata::MetadataBackend* metadata, const RequestContext& ctx,
+                                const HttpRequest& req, const std::string& bucket,
+                                std::initializer_list<metadata::BatchOpType> types) {
+    std::vector<metadata::BatchOp> ops;
+    for (const auto type : types) {
+        metadata::BatchOp op;
+        op.type = type;
+        op.bucket = bucket;
+        ops.push_back(std::move(op));
+    }
+    auto executed = metadata->ExecuteBatch(ops);
+    if (!executed.ok()) {
+        if (executed.error().code == core::ErrorCode::kNotFound) {
+            return JsonError(req.version(), "BUCKET_NOT_FOUND", "bucket not found",
+                             ctx.request_id, boost::beast::http::status::not_found);
+        }
+        return JsonError(req.version(), "DB_ERROR", executed.error().message, ctx.request_id,
+                         boost::beast::http::status::internal_server_error);
+    }
+    Poco::JSON::Object::Ptr root = BucketStatsJson(executed.value().back().stats);
+    root->set("bucket", bucket);
+    if (executed.value().size() > 1) {
+        root->set("previous", BucketStatsJson(executed.value().front().stats));
+    }
+    std::stringstream ss;
+    root->stringify(ss);
+    return JsonOk(req.version(), ss.str());
+}
+
+// Reads the bucket, the upload and any `extra` ops in one metadata round trip. Results follow
+// op order: [0] bucket, [1] upload, then one per extra op.
+core::Result<std::vector<metadata::BatchOpResult>> LoadUploadForBucket(
+    metadata::MetadataBackend* metadata, const std::string& bucket, const std::string& upload_id,
+    std::vector<metadata::BatchOp> extra = {}) {
+    std::vector<metadata::BatchOp> ops(2);
+    ops[0].type = metadata::BatchOpType::kGetBucket;
+    ops[0].bucket = bucket;
+    ops[1].type = metadata::BatchOpType::kGetMultipartUpload;
+    ops[1].upload_id = upload_id;
+    std::move(extra.begin(), extra.end(), std::back_inserter(ops));
+    auto loaded = metadata->ExecuteBatch(ops);
+    if (!loaded.ok()) {
+        return loaded.error();
+    }
+    if (loaded.value()[1].upload.bucket_id != loaded.value()[0].bucket.id) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found for bucket"};
+    }
+    return loaded;
+}
+
 core::Result<void> ValidateUploadForBucket(metadata::MetadataBackend* metadata,
                                            const std::string& bucket, const std::string& upload_id,
                                            int* bucket_id_out,
                                            metadata::MultipartUpload* upload_out) {
-    auto bucket_result = metadata->GetBucket(bucket);
-    if (!bucket_result.ok()) {
-        return bucket_result.error();
+    auto loaded = LoadUploadForBucket(metadata, bucket, upload_id);
+    if (!loaded.ok()) {
+        return loaded.error();
     }
-    auto upload = metadata->GetMultipartUpload(upload_id);
-    if (!upload.ok()) {
-        return upload.error();
-    }
-    if (upload.value().bucket_id != bucket_result.value().id) {
-        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found for bucket"};
+    *bucket_id_out = loaded.value()[0].bucket.id;
+    *upload_out = std::move(loaded.value()[1].upload);
+    return core::Ok();
+}
+
+// Past its expiry an upload belongs to the cleanup sweep, which may be deleting its parts before
+// it has marked the upload "expired".
+bool UploadCompletable(const metadata::MultipartUpload& upload) {
+    if (upload.state == "completed" || upload.state == "aborted" || upload.state == "expired") {
+        return false;
     }
+    const auto expires_at = core::ParseIso8601(upload.expires_at);
+    const auto now = core::ParseIso8601(core::NowIso8601());
+    return !expires_at || !now || *now < *expires_at;
+}
 
-    *bucket_id_out = bucket_result.value().id;
-    *upload_out = upload.value();
+metadata::BatchOp UploadOp(metadata::BatchOpType type, const std::string& upload_id) {
+    metadata::BatchOp op;
+    op.type = type;
+    op.upload_id = upload_id;
+    return op;
+}
+
+// Moves an upload out of "initiated" on its first part. Later parts leave the upload row
+// alone, so a large upload writes its state once rather than once per part; losing the race
+// to another first part is not an error.
+core::Result<void> MarkUploadUploading(metadata::MetadataBackend* metadata,
+                                       const metadata::MultipartUpload& upload) {
+    if (upload.state != "initiated") {
+        return core::Ok();
+    }
+    auto op = UploadOp(metadata::BatchOpType::kUpdateMultipartUploadState, upload.upload_id);
+    op.state = "uploading";
+    op.expect_upload_state = "initiated";
+    auto updated = metadata->ExecuteBatch({std::move(op)});
+    if (!updated.ok() && updated.error().code != core::ErrorCode::kFailedPrecondition) {
+        return updated.error();
+    }
     return core::Ok();
 }
 
-struct CompletePart {
-    int part_number{0};
-    std::string etag;
-};
+// Default and largest `max-parts` for a part listing page.
+constexpr int kMaxListParts = 1000;
 
-core::Result<std::vector<CompletePart>> ParseCompleteParts(const std::string& body) {
+// Lists one page of an upload's parts, numbered above `part-number-marker`, in one metadata
+// round trip. One part past the page is read so truncation is known without a second query.
+HttpResponse ListPartsPage(metadata::MetadataBackend* metadata, const RequestContext& ctx,
+                           const HttpRequest& req, const std::string& bucket,
+                           const std::string& upload_id) {
+    int max_parts = kMaxListParts;
+    int marker = 0;
     try {
-        Poco::JSON::Parser parser;
-        auto result = parser.parse(body);
-        auto obj = result.extract<Poco::JSON::Object::Ptr>();
-        auto parts = obj->getArray("parts");
-        if (!parts || parts->empty()) {
-            return core::Error{core::ErrorCode::kInvalidArgument, "parts list is required"};
+        const Poco::URI uri{std::string(req.target())};
+        for (const auto& [key, value] : uri.getQueryParameters()) {
+            if (key == "max-parts") {
+                auto parsed = ParsePositiveInt(value);
+                if (!parsed || *parsed > kMaxListParts) {
+                    return JsonError(req.version(), "INVALID_ARGUMENT",
+                                     "max-parts must be between 1 and " +
+                                         std::to_string(kMaxListParts),
+                                     ctx.request_id, boost::beast::http::status::bad_request);
+                }
+                max_parts = *parsed;
+            } else if (key == "part-number-marker") {
+                auto parsed = ParsePositiveInt(value);
+                if (!parsed) {
+                    return JsonError(req.version(), "INVALID_ARGUMENT",
+                                     "part-number-marker must be positive integer",
+                                     ctx.request_id, boost::beast::http::status::bad_request);
+                }
+                marker = *parsed;
+            }
+        }
+    } catch (const std::exception&) {
+        return JsonError(req.version(), "INVALID_ARGUMENT", "invalid query string",
+                         ctx.request_id, boost::beast::http::status::bad_request);
+    }
+
+    auto list = UploadOp(metadata::BatchOpType::kListMultipartParts, upload_id);
+    list.part_number_marker = marker;
+    list.max_parts = max_parts + 1;
+    auto loaded = LoadUploadForBucket(metadata, bucket, upload_id, {std::move(list)});
+    if (!loaded.ok()) {
+        if (loaded.error().code == core::ErrorCode::kNotFound) {
+            return JsonError(req.version(), "UPLOAD_NOT_FOUND", loaded.error().message,
+                             ctx.request_id, boost::beast::http::status::not_found);
         }
+        return JsonError(req.version(), "DB_ERROR", loaded.error().message, ctx.request_id,
+                         boost::beast::http::status::internal_server_error);
+    }
+    const auto& upload = loaded.value()[1].upload;
+    const auto& parts = loaded.value()[2].parts;
+    const bool truncated = parts.size() > static_cast<std::size_t>(max_parts);
+    const auto page_size = truncated ? static_cast<std::size_t>(max_parts) : parts.size();
+
+    Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
+    for (std::size_t i = 0; i < page_size; ++i) {
+        Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
+        item->set("part_number", parts[i].part_number);
+        item->set("size", static_cast<Poco::UInt64>(parts[i].size_bytes));
+        item->set("etag", parts[i].etag);
+        arr->add(item);
+    }
+    Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+    root->set("upload_id", upload_id);
+    root->set("object", upload.object_name);
+    root->set("state", upload.state);
+    root->set("parts", arr);
+    root->set("is_truncated", truncated);
+    if (truncated) {
+        root->set("next_part_number_marker", parts[page_size - 1].part_number);
+    }
+    std::stringstream ss;
+    root->stringify(ss);
+    return JsonOk(req.version(), ss.str());
+}
 
-        std::vector<CompletePart> expected_parts;
-        expected_parts.reserve(parts->size());
-        int previous = 0;
-        for (size_t i = 0; i < parts->size(); ++i) {
-            auto part_obj = parts->getObject(i);
-            if (!part_obj) {
-                return core::Error{core::ErrorCode::kInvalidArgument, "invalid part entry"};
+// Serves POST .../objects/{object}/copy and /move. The body names the destination as
+// {"bucket": ..., "object": ...}, with the bucket defaulting to the source's. No bytes pass
+// through the request: single-node storage renames or clones the file, and distributed storage
+// points a new row at the same blobs.
+HttpResponse CopyObjectRequest(metadata::MetadataBackend* metadata,
+                               storage::StorageBackend* storage, bool distributed,
+                               const RequestContext& ctx, const HttpRequest& req,
+                               const RouteParams& params, bool move) {
+    const auto source_bucket = params.at("bucket");
+    const auto source_object = params.at("object");
+    std::string bucket;
+    std::string object;
+    try {
+        Poco::JSON::Parser parser;
+        auto obj = parser.parse(req.body()).extract<Poco::JSON::Object::Ptr>();
+        bucket = obj->optValue<std::string>("bucket", source_bucket);
+        object = obj->getValue<std::string>("object");
+    } catch (const std::exception& ex) {
+        return JsonError(req.version(), "INVALID_JSON", ex.what(), ctx.request_id,
+                         boost::beast::http::status::bad_request);
+    }
+    if (!storage::LocalStorage::IsSafeName(bucket) || !storage::LocalStorage::IsSafeName(object)) {
+        return JsonError(req.version(), "INVALID_NAME", "invalid destination name",
+                         ctx.request_id, boost::beast::http::status::bad_request);
+    }
+    if (bucket == source_bucket && object == source_object) {
+        return JsonError(req.version(), "INVALID_ARGUMENT",
+                         "source and destination are the same object", ctx.request_id,
+                         boost::beast::http::status::bad_request);
+    }
+    if (!metadata->GetBucket(bucket).ok()) {
+        return JsonError(req.version(), "BUCKET_NOT_FOUND", "bucket not found", ctx.request_id,
+                         boost::beast::http::status::not_found);
+    }
+    auto failed = [&](const core::Error& error) {
+        if (error.code == core::ErrorCode::kNotFound) {
+            return JsonError(req.version(), "OBJECT_NOT_FOUND", "object not found",
+                             ctx.request_id, boost::beast::http::status::not_found);
+        }
+        if (error.code == core::ErrorCode::kInvalidArgument) {
+            return JsonError(req.version(), "INVALID_ARGUMENT", error.message, ctx.request_id,
+                             boost::beast::http::status::bad_request);
+        }
+        return JsonError(req.version(), "STORAGE_ERROR", error.message, ctx.request_id,
+                         boost::beast::http::status::internal_server_error);
+    };
+
+    metadata::ObjectMetadata meta;
+    meta.name = object;
+    if (distributed) {
+        // The metadata service commits the destination row itself.
+        auto stored = move ? storage->MoveObject(source_bucket, source_object, bucket, object)
+                           : storage->CopyObject(source_bucket, source_object, bucket, object);
+        if (!stored.ok()) {
+            return failed(stored.error());
+        }
+        meta.etag = stored.value().etag;
+        meta.size_bytes = stored.value().size_bytes;
+    } else {
+        auto source = metadata->GetObject(source_bucket, source_object);
+        if (!source.ok()) {
+            return failed(source.error());
+        }
+        meta.etag = source.value().etag;
+        meta.size_bytes = source.value().size_bytes;
+        if (source.value().inline_data) {
+            // The body travels in the row, which the copy op takes along, so the new row and
+            // the removal of a moved source commit together.
+            std::vector<metadata::BatchOp> ops(1);
+            ops[0].type = metadata::BatchOpType::kCopyObject;
+            ops[0].bucket = bucket;
+            ops[0].object_name = object;
+            ops[0].source_bucket = source_bucket;
+            ops[0].source_object = source_object;
+            if (move) {
+                metadata::BatchOp drop;
+                drop.type = metadata::BatchOpType::kDeleteObject;
+                drop.bucket = source_bucket;
+                drop.object_name = source_object;
+                ops.push_back(std::move(drop));
+            }
+            auto committed = metadata->ExecuteBatch(ops);
+            if (!committed.ok()) {
+                if (committed.error().code == core::ErrorCode::kNotFound) {
+                    return failed(committed.error());
+                }
+                return JsonError(req.version(), "METADATA_ERROR", committed.error().message,
+                                 ctx.request_id, boost::beast::http::status::internal_server_error);
             }
-            const int part_number = part_obj->getValue<int>("part_number");
-            const std::string etag = part_obj->getValue<std::string>("etag");
-            if (part_number <= 0 || etag.empty()) {
-                return core::Error{core::ErrorCode::kInvalidArgument,
-                                   "invalid part_number or etag"};
+            // Only once the row holds the body is an earlier version's file removed. Reads
+            // prefer the row, so a file left behind by a failure here is never served.
+            auto removed = storage->DeleteObject(bucket, object);
+            if (!removed.ok() && removed.error().code != core::ErrorCode::kNotFound) {
+                core::LogError("failed to remove the replaced file of " + bucket + "/" + object +
+                               ": " + removed.error().message);
             }
-            if (part_number <= previous) {
-                return core::Error{core::ErrorCode::kInvalidArgument,
-                                   "parts must be strictly increasing"};
+        } else {
+            auto stored = move
+                              ? storage->MoveObject(source_bucket, source_object, bucket, object)
+                              : storage->CopyObject(source_bucket, source_object, bucket, object);
+            if (!stored.ok()) {
+                return failed(stored.error());
+            }
+            // The row describes the file that was transferred. Local storage keeps no etags, so
+            // the source row's stands in when the backend reports none.
+            meta.size_bytes = stored.value().size_bytes;
+            if (!stored.value().etag.empty()) {
+                meta.etag = stored.value().etag;
+            }
+            std::vector<metadata::BatchOp> ops(1);
+            ops[0].type = metadata::BatchOpType::kCommitWrite;
+            ops[0].bucket = bucket;
+            ops[0].object_name = object;
+            ops[0].size_bytes = meta.size_bytes;
+            ops[0].etag = meta.etag;
+            if (move) {
+                metadata::BatchOp drop;
+                drop.type = metadata::BatchOpType::kDeleteObject;
+                drop.bucket = source_bucket;
+                drop.object_name = source_object;
+                ops.push_back(std::move(drop));
+            }
+            auto committed = metadata->ExecuteBatch(ops);
+            if (!committed.ok()) {
+                // The source row still names its file, so a moved file goes back under it.
+                std::string message = committed.error().message;
+                if (move) {
+                    auto restored =
+                        storage->MoveObject(bucket, object, source_bucket, source_object);
+                    if (!restored.ok()) {
+                        message += "; moving the file back failed: " + restored.error().message;
+                    }
+                }
+                return JsonError(req.version(), "METADATA_ERROR", message, ctx.request_id,
+                                 boost::beast::http::status::internal_server_error);
             }
-            previous = part_number;
-            expected_parts.push_back(CompletePart{part_number, etag});
         }
+    }
+    observability::RecordGatewayObjectCopy(move);
+    Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+    root->set("bucket", bucket);
+    root->set("object", object);
+    root->set("etag", meta.etag);
+    root->set("size", static_cast<Poco::UInt64>(meta.size_bytes));
+    std::stringstream ss;
+    root->stringify(ss);
+    return JsonOk(req.version(), ss.str());
+}
 
-        return expected_parts;
+// Deletes up to `metadata::kMaxBatchOps` objects named in `{"objects": [...]}` and reports
+// each one. Rows go in one metadata batch; in distributed mode the storage backend runs it and
+// leaves blob removal to its reclaimer.
+HttpResponse BulkDeleteRequest(metadata::MetadataBackend* metadata,
+                               storage::StorageBackend* storage, bool distributed,
+                               const RequestContext& ctx, const HttpRequest& req,
+                               const RouteParams& params) {
+    const auto bucket = params.at("bucket");
+    std::vector<std::string> names;
+    try {
+        Poco::JSON::Parser parser;
+        auto obj = parser.parse(req.body()).extract<Poco::JSON::Object::Ptr>();
+        auto objects = obj->getArray("objects");
+        if (!objects) {
+            return JsonError(req.version(), "INVALID_JSON", "objects must be an array",
+                             ctx.request_id, boost::beast::http::status::bad_request);
+        }
+        names.reserve(objects->size());
+        for (std::size_t i = 0; i < objects->size(); ++i) {
+            names.push_back(objects->getElement<std::string>(static_cast<unsigned int>(i)));
+        }
     } catch (const std::exception& ex) {
-        return core::Error{core::ErrorCode::kInvalidArgument, ex.what()};
+        return JsonError(req.version(), "INVALID_JSON", ex.what(), ctx.request_id,
+                         boost::beast::http::status::bad_request);
+    }
+    if (names.empty() || names.size() > metadata::kMaxBatchOps) {
+        return JsonError(req.version(), "INVALID_ARGUMENT",
+                         "objects must name 1 to " + std::to_string(metadata::kMaxBatchOps) +
+                             " keys",
+                         ctx.request_id, boost::beast::http::status::bad_request);
+    }
+    if (!metadata->GetBucket(bucket).ok()) {
+        return JsonError(req.version(), "BUCKET_NOT_FOUND", "bucket not found", ctx.request_id,
+                         boost::beast::http::status::not_found);
+    }
+
+    // Invalid names are reported per key rather than failing the whole request.
+    std::vector<std::string> valid;
+    valid.reserve(names.size());
+    for (const auto& name : names) {
+        if (storage::LocalStorage::IsSafeName(name)) {
+            valid.push_back(name);
+        }
+    }
+    std::vector<bool> existed(valid.size(), false);
+    if (!valid.empty()) {
+        auto files = storage->DeleteObjects(bucket, valid);
+        if (!files.ok()) {
+            return JsonError(req.version(), "STORAGE_ERROR", files.error().message,
+                             ctx.request_id, boost::beast::http::status::internal_server_error);
+        }
+        existed = std::move(files.value());
+    }
+    if (!distributed && !valid.empty()) {
+        // Objects stored inline have a row and no file, so the rows decide what existed too.
+        std::vector<metadata::BatchOp> ops(valid.size());
+        for (std::size_t i = 0; i < valid.size(); ++i) {
+            ops[i].type = metadata::BatchOpType::kDeleteObject;
+            ops[i].bucket = bucket;
+            ops[i].object_name = valid[i];
+        }
+        auto rows = metadata->ExecuteBatch(ops);
+        if (!rows.ok()) {
+            return JsonError(req.version(), "METADATA_ERROR", rows.error().message,
+                             ctx.request_id, boost::beast::http::status::internal_server_error);
+        }
+        for (std::size_t i = 0; i < valid.size(); ++i) {
+            existed[i] = existed[i] || rows.value()[i].removed;
+        }
+    }
+
+    Poco::JSON::Array::Ptr results = new Poco::JSON::Array();
+    std::uint64_t deleted = 0;
+    std::size_t next_valid = 0;
+    for (const auto& name : names) {
+        Poco::JSON::Object::Ptr result = new Poco::JSON::Object();
+        result->set("object", name);
+        if (!storage::LocalStorage::IsSafeName(name)) {
+            result->set("deleted", false);
+            result->set("code", "INVALID_NAME");
+        } else if (existed[next_valid++]) {
+            result->set("deleted", true);
+            ++deleted;
+        } else {
+            result->set("deleted", false);
+            result->set("code", "OBJECT_NOT_FOUND");
+        }
+        results->add(result);
     }
+    observability::RecordGatewayBulkDelete(names.size(), deleted);
+    Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+    root->set("deleted", static_cast<Poco::UInt64>(deleted));
+    root->set("results", results);
+    std::stringstream ss;
+    root->stringify(ss);
+    return JsonOk(req.version(), ss.str());
 }
 
 }  // namespace
@@ -343,31 +640,21 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                    return JsonOk(req.version(), ss.str());
                });
 
-    router.Add("GET", "/v1/buckets/{bucket}/objects",
+    router.Add("GET", "/v1/buckets/{bucket}/stats",
                [metadata](const RequestContext& ctx, const HttpRequest& req,
                           const RouteParams& params) {
-                   const auto bucket = params.at("bucket");
-                   const auto prefix = GetQueryParam(std::string(req.target()), "prefix");
-                   auto objects = metadata->ListObjects(bucket, prefix);
-                   if (!objects.ok()) {
-                       return JsonError(req.version(), "DB_ERROR", objects.error().message,
-                                        ctx.request_id,
-                                        boost::beast::http::status::internal_server_error);
-                   }
-                   Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                   for (const auto& object : objects.value()) {
-                       Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                       item->set("name", object.name);
-                       item->set("size", static_cast<Poco::UInt64>(object.size_bytes));
-                       item->set("etag", object.etag);
-                       item->set("updated_at", object.updated_at);
-                       arr->add(item);
-                   }
-                   Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                   root->set("objects", arr);
-                   std::stringstream ss;
-                   root->stringify(ss);
-                   return JsonOk(req.version(), ss.str());
+                   return BucketStatsRequest(metadata.get(), ctx, req, params.at("bucket"),
+                                             {metadata::BatchOpType::kGetBucketStats});
+               });
+
+    // Recounts the counters from the bucket's rows; the reply also carries the values it
+    // replaced, so drift shows up in the response.
+    router.Add("POST", "/v1/buckets/{bucket}/stats/repair",
+               [metadata](const RequestContext& ctx, const HttpRequest& req,
+                          const RouteParams& params) {
+                   return BucketStatsRequest(metadata.get(), ctx, req, params.at("bucket"),
+                                             {metadata::BatchOpType::kGetBucketStats,
+                                              metadata::BatchOpType::kRepairBucketStats});
                });
 
     if (config.server.mode == "single_node") {
@@ -399,11 +686,41 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                             boost::beast::http::status::bad_request);
                        }
 
+                       // A declared part size lets parts be written straight to their offsets,
+                       // so complete does not copy them.
+                       std::uint64_t part_size = 0;
+                       if (obj->has("part_size")) {
+                           const auto declared = obj->getValue<Poco::Int64>("part_size");
+                           if (declared <= 0 ||
+                               static_cast<std::uint64_t>(declared) > kMaxDeclaredPartSize) {
+                               return JsonError(req.version(), "INVALID_PART_SIZE",
+                                                "part_size must be between 1 and " +
+                                                    std::to_string(kMaxDeclaredPartSize),
+                                                ctx.request_id,
+                                                boost::beast::http::status::bad_request);
+                           }
+                           part_size = static_cast<std::uint64_t>(declared);
+                       }
+
                        const auto upload_id = Poco::UUIDGenerator().createOne().toString();
                        const auto expires_at =
                            core::NowIso8601WithOffsetSeconds(ttl_seconds);
-                       auto created =
-                           metadata->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+                       // The part size lands with the upload, so no one sees the upload
+                       // without it and takes it for a copy-mode one.
+                       std::vector<metadata::BatchOp> ops;
+                       auto create =
+                           UploadOp(metadata::BatchOpType::kCreateMultipartUpload, upload_id);
+                       create.bucket = bucket;
+                       create.object_name = object_name;
+                       create.expires_at = expires_at;
+                       ops.push_back(std::move(create));
+                       if (part_size > 0) {
+                           auto set_size = UploadOp(
+                               metadata::BatchOpType::kSetMultipartPartSize, upload_id);
+                           set_size.part_size = part_size;
+                           ops.push_back(std::move(set_size));
+                       }
+                       auto created = metadata->ExecuteBatch(ops);
                        if (!created.ok()) {
                            return JsonError(req.version(), "DB_ERROR", created.error().message,
                                             ctx.request_id,
@@ -412,7 +729,8 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
 
                        return JsonOk(req.version(),
                                      "{\"upload_id\":\"" + upload_id + "\",\"object\":\"" +
-                                         object_name + "\",\"expires_at\":\"" + expires_at + "\"}");
+                                         object_name + "\",\"expires_at\":\"" + expires_at +
+                                         "\",\"part_size\":" + std::to_string(part_size) + "}");
                    } catch (const std::exception& ex) {
                        return JsonError(req.version(), "INVALID_JSON", ex.what(), ctx.request_id,
                                         boost::beast::http::status::bad_request);
@@ -450,23 +768,43 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                         ctx.request_id, boost::beast::http::status::conflict);
                    }
 
-                   const auto part_path = MultipartPartPath(storage->temp_path(), upload_id, *part_number);
+                   const bool in_place = upload.part_size > 0;
+                   if (in_place && (req.body().size() > upload.part_size ||
+                                    *part_number > kMaxInPlaceParts)) {
+                       return JsonError(req.version(), "INVALID_PART_SIZE",
+                                        "part exceeds the declared part_size or part limit",
+                                        ctx.request_id, boost::beast::http::status::bad_request);
+                   }
+                   const auto part_path =
+                       in_place ? MultipartInPlacePath(storage->temp_path(), upload_id)
+                                : MultipartPartPath(storage->temp_path(), upload_id, *part_number);
                    std::filesystem::create_directories(std::filesystem::path(part_path).parent_path());
 
                    try {
-                       std::ofstream out(part_path, std::ios::binary | std::ios::trunc);
-                       if (!out.is_open()) {
-                           return JsonError(req.version(), "IO_ERROR", "failed to open part file",
-                                            ctx.request_id,
-                                            boost::beast::http::status::internal_server_error);
+                       if (in_place) {
+                           const auto offset =
+                               static_cast<std::uint64_t>(*part_number - 1) * upload.part_size;
+                           auto written = storage::WriteAt(part_path, offset, req.body());
+                           if (!written.ok()) {
+                               return JsonError(req.version(), "IO_ERROR",
+                                                written.error().message, ctx.request_id,
+                                                boost::beast::http::status::internal_server_error);
+                           }
+                       } else {
+                           std::ofstream out(part_path, std::ios::binary | std::ios::trunc);
+                           if (!out.is_open()) {
+                               return JsonError(req.version(), "IO_ERROR",
+                                                "failed to open part file", ctx.request_id,
+                                                boost::beast::http::status::internal_server_error);
+                           }
+                           out.write(req.body().data(),
+                                     static_cast<std::streamsize>(req.body().size()));
+                           out.flush();
                        }
-                       out.write(req.body().data(), static_cast<std::streamsize>(req.body().size()));
-                       out.flush();
 
-                       Poco::SHA2Engine256 sha256;
-                       sha256.update(req.body().data(),
-                                     static_cast<unsigned int>(req.body().size()));
-                       const auto etag = Poco::DigestEngine::digestToHex(sha256.digest());
+                       core::Sha256Hasher sha256;
+                       sha256.Update(req.body().data(), req.body().size());
+                       const auto etag = sha256.HexDigest();
 
                        auto part = metadata->UpsertMultipartPart(
                            upload_id, *part_number, static_cast<std::uint64_t>(req.body().size()),
@@ -476,7 +814,7 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                             ctx.request_id,
                                             boost::beast::http::status::internal_server_error);
                        }
-                       auto state_update = metadata->UpdateMultipartUploadState(upload_id, "uploading");
+                       auto state_update = MarkUploadUploading(metadata.get(), upload);
                        if (!state_update.ok()) {
                            return JsonError(req.version(), "DB_ERROR", state_update.error().message,
                                             ctx.request_id,
@@ -496,65 +834,16 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
     router.Add("GET", "/v1/buckets/{bucket}/multipart-uploads/{upload_id}/parts",
                [metadata](const RequestContext& ctx, const HttpRequest& req,
                           const RouteParams& params) {
-                   const auto bucket = params.at("bucket");
-                   const auto upload_id = params.at("upload_id");
-
-                   int bucket_id = 0;
-                   metadata::MultipartUpload upload;
-                   auto validated =
-                       ValidateUploadForBucket(metadata.get(), bucket, upload_id, &bucket_id, &upload);
-                   if (!validated.ok()) {
-                       return JsonError(req.version(), "UPLOAD_NOT_FOUND",
-                                        validated.error().message, ctx.request_id,
-                                        boost::beast::http::status::not_found);
-                   }
-
-                   auto parts = metadata->ListMultipartParts(upload_id);
-                   if (!parts.ok()) {
-                       return JsonError(req.version(), "DB_ERROR", parts.error().message,
-                                        ctx.request_id,
-                                        boost::beast::http::status::internal_server_error);
-                   }
-
-                   Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                   for (const auto& part : parts.value()) {
-                       Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                       item->set("part_number", part.part_number);
-                       item->set("size", static_cast<Poco::UInt64>(part.size_bytes));
-                       item->set("etag", part.etag);
-                       arr->add(item);
-                   }
-                   Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                   root->set("upload_id", upload_id);
-                   root->set("object", upload.object_name);
-                   root->set("state", upload.state);
-                   root->set("parts", arr);
-                   std::stringstream ss;
-                   root->stringify(ss);
-                   return JsonOk(req.version(), ss.str());
+                   return ListPartsPage(metadata.get(), ctx, req, params.at("bucket"),
+                                        params.at("upload_id"));
                });
 
     router.Add("POST", "/v1/buckets/{bucket}/multipart-uploads/{upload_id}/complete",
-               [metadata, storage](const RequestContext& ctx, const HttpRequest& req,
-                                   const RouteParams& params) {
+               [metadata, storage, assemble_threads = config.storage.multipart.assemble_threads](
+                   const RequestContext& ctx, const HttpRequest& req, const RouteParams& params) {
                    const auto bucket = params.at("bucket");
                    const auto upload_id = params.at("upload_id");
 
-                   int bucket_id = 0;
-                   metadata::MultipartUpload upload;
-                   auto validated =
-                       ValidateUploadForBucket(metadata.get(), bucket, upload_id, &bucket_id, &upload);
-                   if (!validated.ok()) {
-                       return JsonError(req.version(), "UPLOAD_NOT_FOUND",
-                                        validated.error().message, ctx.request_id,
-                                        boost::beast::http::status::not_found);
-                   }
-                   if (upload.state == "completed" || upload.state == "aborted" ||
-                       upload.state == "expired") {
-                       return JsonError(req.version(), "INVALID_STATE", "upload is not completable",
-                                        ctx.request_id, boost::beast::http::status::conflict);
-                   }
-
                    auto expected_parts = ParseCompleteParts(req.body());
                    if (!expected_parts.ok()) {
                        return JsonError(req.version(), "INVALID_JSON",
@@ -562,96 +851,140 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                         boost::beast::http::status::bad_request);
                    }
 
-                   auto listed_parts = metadata->ListMultipartParts(upload_id);
-                   if (!listed_parts.ok()) {
-                       return JsonError(req.version(), "DB_ERROR", listed_parts.error().message,
+                   auto loaded = LoadUploadForBucket(
+                       metadata.get(), bucket, upload_id,
+                       {UploadOp(metadata::BatchOpType::kListMultipartParts, upload_id)});
+                   if (!loaded.ok()) {
+                       if (loaded.error().code == core::ErrorCode::kNotFound) {
+                           return JsonError(req.version(), "UPLOAD_NOT_FOUND",
+                                            loaded.error().message, ctx.request_id,
+                                            boost::beast::http::status::not_found);
+                       }
+                       return JsonError(req.version(), "DB_ERROR", loaded.error().message,
                                         ctx.request_id,
                                         boost::beast::http::status::internal_server_error);
                    }
-                   if (listed_parts.value().empty()) {
+                   const auto& upload = loaded.value()[1].upload;
+                   const auto& listed_parts = loaded.value()[2].parts;
+                   if (!UploadCompletable(upload)) {
+                       return JsonError(req.version(), "INVALID_STATE", "upload is not completable",
+                                        ctx.request_id, boost::beast::http::status::conflict);
+                   }
+                   if (listed_parts.empty()) {
                        return JsonError(req.version(), "INVALID_STATE", "no parts uploaded",
                                         ctx.request_id, boost::beast::http::status::conflict);
                    }
 
-                   std::unordered_map<int, metadata::MultipartPart> part_map;
-                   for (const auto& part : listed_parts.value()) {
-                       part_map[part.part_number] = part;
+                   auto matched = MatchCompleteParts(expected_parts.value(), listed_parts);
+                   if (!matched.ok()) {
+                       const bool missing = matched.error().code == core::ErrorCode::kNotFound;
+                       return JsonError(req.version(), missing ? "MISSING_PART" : "ETAG_MISMATCH",
+                                        matched.error().message, ctx.request_id,
+                                        boost::beast::http::status::conflict);
                    }
-
-                   const auto upload_dir = MultipartUploadDir(storage->temp_path(), upload_id);
-                   const auto final_temp_path =
-                       (upload_dir / ("complete-" + Poco::UUIDGenerator().createOne().toString()))
-                           .string();
-                   std::ofstream out(final_temp_path, std::ios::binary | std::ios::trunc);
-                   if (!out.is_open()) {
-                       return JsonError(req.version(), "IO_ERROR", "failed to open final temp file",
+                   // Claim the upload before touching its files, so an abort that runs now
+                   // finds it completed and leaves the part files alone.
+                   metadata::BatchOp claim =
+                       UploadOp(metadata::BatchOpType::kUpdateMultipartUploadState, upload_id);
+                   claim.state = "completed";
+                   claim.expect_upload_state = upload.state;
+                   auto claimed = metadata->ExecuteBatch({std::move(claim)});
+                   if (!claimed.ok()) {
+                       if (claimed.error().code == core::ErrorCode::kFailedPrecondition ||
+                           claimed.error().code == core::ErrorCode::kNotFound) {
+                           return JsonError(req.version(), "INVALID_STATE",
+                                            "upload changed while completing", ctx.request_id,
+                                            boost::beast::http::status::conflict);
+                       }
+                       return JsonError(req.version(), "DB_ERROR", claimed.error().message,
                                         ctx.request_id,
                                         boost::beast::http::status::internal_server_error);
                    }
+                   // A complete that fails before the object is placed hands the upload back,
+                   // so the client can retry or abort it.
+                   auto release = [&] {
+                       metadata::BatchOp restore =
+                           UploadOp(metadata::BatchOpType::kUpdateMultipartUploadState, upload_id);
+                       restore.state = upload.state;
+                       restore.expect_upload_state = "completed";
+                       (void)metadata->ExecuteBatch({std::move(restore)});
+                   };
 
-                   Poco::SHA2Engine256 sha256;
-                   std::uint64_t total_size = 0;
-                   std::array<char, 8192> buffer{};
-                   for (const auto& expected : expected_parts.value()) {
-                       auto it = part_map.find(expected.part_number);
-                       if (it == part_map.end()) {
-                           std::filesystem::remove(final_temp_path);
-                           return JsonError(req.version(), "MISSING_PART",
-                                            "missing uploaded part " +
-                                                std::to_string(expected.part_number),
-                                            ctx.request_id,
-                                            boost::beast::http::status::conflict);
-                       }
-                       if (it->second.etag != expected.etag) {
-                           std::filesystem::remove(final_temp_path);
-                           return JsonError(req.version(), "ETAG_MISMATCH",
-                                            "part etag mismatch for part " +
-                                                std::to_string(expected.part_number),
-                                            ctx.request_id,
+                   const auto upload_dir = MultipartUploadDir(storage->temp_path(), upload_id);
+                   std::string final_temp_path;
+                   storage::AssembledObject assembled;
+                   if (upload.part_size > 0) {
+                       // The parts already sit at their offsets: complete checks the layout,
+                       // trims whatever lies past the last part, and renames the file.
+                       auto size = CheckInPlaceLayout(matched.value(), upload.part_size);
+                       if (!size.ok()) {
+                           release();
+                           return JsonError(req.version(), "INVALID_PART_LAYOUT",
+                                            size.error().message, ctx.request_id,
                                             boost::beast::http::status::conflict);
                        }
-
-                       std::ifstream in(it->second.temp_path, std::ios::binary);
-                       if (!in.is_open()) {
-                           std::filesystem::remove(final_temp_path);
+                       final_temp_path = MultipartInPlacePath(storage->temp_path(), upload_id);
+                       std::error_code size_ec;
+                       std::filesystem::resize_file(final_temp_path, size.value(), size_ec);
+                       if (size_ec) {
+                           release();
                            return JsonError(req.version(), "IO_ERROR",
-                                            "failed to read uploaded part", ctx.request_id,
+                                            "failed to size upload file", ctx.request_id,
                                             boost::beast::http::status::internal_server_error);
                        }
-                       while (in) {
-                           in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-                           const auto bytes = in.gcount();
-                           if (bytes <= 0) {
-                               break;
-                           }
-                           out.write(buffer.data(), bytes);
-                           sha256.update(buffer.data(), static_cast<unsigned int>(bytes));
-                           total_size += static_cast<std::uint64_t>(bytes);
+                       assembled = {size.value(), CompositeEtag(matched.value())};
+                   } else {
+                       std::vector<storage::PartSource> sources;
+                       sources.reserve(matched.value().size());
+                       for (const auto* part : matched.value()) {
+                           sources.push_back(
+                               storage::PartSource{part->temp_path, part->size_bytes});
                        }
+                       final_temp_path = (upload_dir / ("complete-" +
+                                                        Poco::UUIDGenerator().createOne().toString()))
+                                             .string();
+                       auto copied =
+                           storage::AssembleParts(sources, final_temp_path, assemble_threads);
+                       if (!copied.ok()) {
+                           release();
+                           return JsonError(req.version(), "IO_ERROR", copied.error().message,
+                                            ctx.request_id,
+                                            boost::beast::http::status::internal_server_error);
+                       }
+                       assembled = std::move(copied.value());
                    }
-                   out.flush();
-                   out.close();
 
-                   const auto final_path = storage::LocalStorage::BuildObjectPath(
-                       storage->base_path(), bucket, upload.object_name);
-                   std::filesystem::create_directories(
-                       std::filesystem::path(final_path).parent_path());
-                   std::filesystem::rename(final_temp_path, final_path);
+                   auto placed = storage->PlaceObject(bucket, upload.object_name, final_temp_path,
+                                                      assembled.etag);
+                   if (!placed.ok()) {
+                       release();
+                       return JsonError(req.version(), "IO_ERROR", placed.error().message,
+                                        ctx.request_id,
+                                        boost::beast::http::status::internal_server_error);
+                   }
 
                    metadata::ObjectMetadata object_meta;
                    object_meta.name = upload.object_name;
-                   object_meta.size_bytes = total_size;
-                   object_meta.etag = Poco::DigestEngine::digestToHex(sha256.digest());
-                   auto upsert = metadata->UpsertObject(bucket, object_meta);
-                   if (!upsert.ok()) {
-                       return JsonError(req.version(), "DB_ERROR", upsert.error().message,
+                   object_meta.size_bytes = assembled.size_bytes;
+                   object_meta.etag = assembled.etag;
+                   // The row appears and the upload disappears in one transaction, as in
+                   // distributed mode.
+                   metadata::BatchOp commit =
+                       UploadOp(metadata::BatchOpType::kCommitWrite, upload_id);
+                   commit.expect_upload_state = "completed";
+                   commit.bucket = bucket;
+                   commit.object_name = object_meta.name;
+                   commit.size_bytes = object_meta.size_bytes;
+                   commit.etag = object_meta.etag;
+                   auto committed = metadata->ExecuteBatch(
+                       {std::move(commit),
+                        UploadOp(metadata::BatchOpType::kDeleteMultipartParts, upload_id),
+                        UploadOp(metadata::BatchOpType::kDeleteMultipartUpload, upload_id)});
+                   if (!committed.ok()) {
+                       return JsonError(req.version(), "DB_ERROR", committed.error().message,
                                         ctx.request_id,
                                         boost::beast::http::status::internal_server_error);
                    }
-
-                   (void)metadata->UpdateMultipartUploadState(upload_id, "completed");
-                   (void)metadata->DeleteMultipartParts(upload_id);
-                   (void)metadata->DeleteMultipartUpload(upload_id);
                    std::error_code ec;
                    std::filesystem::remove_all(upload_dir, ec);
 
@@ -681,9 +1014,25 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                         ctx.request_id, boost::beast::http::status::conflict);
                    }
 
-                   (void)metadata->UpdateMultipartUploadState(upload_id, "aborted");
-                   (void)metadata->DeleteMultipartParts(upload_id);
-                   (void)metadata->DeleteMultipartUpload(upload_id);
+                   // One batch, and only if a concurrent complete has not moved the upload on
+                   // and claimed its parts.
+                   metadata::BatchOp delete_parts =
+                       UploadOp(metadata::BatchOpType::kDeleteMultipartParts, upload_id);
+                   delete_parts.expect_upload_state = upload.state;
+                   auto retired = metadata->ExecuteBatch(
+                       {std::move(delete_parts),
+                        UploadOp(metadata::BatchOpType::kDeleteMultipartUpload, upload_id)});
+                   if (!retired.ok()) {
+                       if (retired.error().code == core::ErrorCode::kFailedPrecondition ||
+                           retired.error().code == core::ErrorCode::kNotFound) {
+                           return JsonError(req.version(), "INVALID_STATE",
+                                            "upload changed while aborting", ctx.request_id,
+                                            boost::beast::http::status::conflict);
+                       }
+                       return JsonError(req.version(), "DB_ERROR", retired.error().message,
+                                        ctx.request_id,
+                                        boost::beast::http::status::internal_server_error);
+                   }
                    std::error_code ec;
                    std::filesystem::remove_all(MultipartUploadDir(storage->temp_path(), upload_id), ec);
 
@@ -770,9 +1119,9 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                             ctx.request_id, boost::beast::http::status::conflict);
                        }
 
-                       Poco::SHA2Engine256 sha256;
-                       sha256.update(req.body().data(), static_cast<unsigned int>(req.body().size()));
-                       const auto etag = Poco::DigestEngine::digestToHex(sha256.digest());
+                       core::Sha256Hasher sha256;
+                       sha256.Update(req.body().data(), req.body().size());
+                       const auto etag = sha256.HexDigest();
 
                        const auto part_object_name =
                            upload.object_name + ".part." + std::to_string(*part_number);
@@ -813,7 +1162,7 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                             ctx.request_id,
                                             boost::beast::http::status::internal_server_error);
                        }
-                       auto state_update = metadata->UpdateMultipartUploadState(upload_id, "uploading");
+                       auto state_update = MarkUploadUploading(metadata.get(), upload);
                        if (!state_update.ok()) {
                            return JsonError(req.version(), "DB_ERROR", state_update.error().message,
                                             ctx.request_id,
@@ -829,67 +1178,16 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
         router.Add("GET", "/v1/buckets/{bucket}/multipart-uploads/{upload_id}/parts",
                    [metadata](const RequestContext& ctx, const HttpRequest& req,
                               const RouteParams& params) {
-                       const auto bucket = params.at("bucket");
-                       const auto upload_id = params.at("upload_id");
-
-                       int bucket_id = 0;
-                       metadata::MultipartUpload upload;
-                       auto validated =
-                           ValidateUploadForBucket(metadata.get(), bucket, upload_id, &bucket_id, &upload);
-                       if (!validated.ok()) {
-                           return JsonError(req.version(), "UPLOAD_NOT_FOUND",
-                                            validated.error().message, ctx.request_id,
-                                            boost::beast::http::status::not_found);
-                       }
-
-                       auto parts = metadata->ListMultipartParts(upload_id);
-                       if (!parts.ok()) {
-                           return JsonError(req.version(), "DB_ERROR", parts.error().message,
-                                            ctx.request_id,
-                                            boost::beast::http::status::internal_server_error);
-                       }
-
-                       Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                       for (const auto& part : parts.value()) {
-                           Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                           item->set("part_number", part.part_number);
-                           item->set("size", static_cast<Poco::UInt64>(part.size_bytes));
-                           item->set("etag", part.etag);
-                           arr->add(item);
-                       }
-                       Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                       root->set("upload_id", upload_id);
-                       root->set("object", upload.object_name);
-                       root->set("state", upload.state);
-                       root->set("parts", arr);
-                       std::stringstream ss;
-                       root->stringify(ss);
-                       return JsonOk(req.version(), ss.str());
+                       return ListPartsPage(metadata.get(), ctx, req, params.at("bucket"),
+                                            params.at("upload_id"));
                    });
 
         router.Add("POST", "/v1/buckets/{bucket}/multipart-uploads/{upload_id}/complete",
-                   [metadata, storage, service_token = config.distributed.service_auth_token,
-                    replication_factor = config.distributed.replication_factor,
-                    min_write_acks = config.distributed.min_write_acks](
+                   [metadata, storage, service_token = config.distributed.service_auth_token](
                        const RequestContext& ctx, const HttpRequest& req, const RouteParams& params) {
                        const auto bucket = params.at("bucket");
                        const auto upload_id = params.at("upload_id");
 
-                       int bucket_id = 0;
-                       metadata::MultipartUpload upload;
-                       auto validated =
-                           ValidateUploadForBucket(metadata.get(), bucket, upload_id, &bucket_id, &upload);
-                       if (!validated.ok()) {
-                           return JsonError(req.version(), "UPLOAD_NOT_FOUND",
-                                            validated.error().message, ctx.request_id,
-                                            boost::beast::http::status::not_found);
-                       }
-                       if (upload.state == "completed" || upload.state == "aborted" ||
-                           upload.state == "expired") {
-                           return JsonError(req.version(), "INVALID_STATE", "upload is not completable",
-                                            ctx.request_id, boost::beast::http::status::conflict);
-                       }
-
                        auto expected_parts = ParseCompleteParts(req.body());
                        if (!expected_parts.ok()) {
                            return JsonError(req.version(), "INVALID_JSON",
@@ -897,147 +1195,113 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                                             boost::beast::http::status::bad_request);
                        }
 
-                       auto listed_parts = metadata->ListMultipartParts(upload_id);
-                       if (!listed_parts.ok()) {
-                           return JsonError(req.version(), "DB_ERROR", listed_parts.error().message,
+                       // One metadata round trip reads the upload and its parts.
+                       auto loaded = LoadUploadForBucket(
+                           metadata.get(), bucket, upload_id,
+                           {UploadOp(metadata::BatchOpType::kListMultipartParts, upload_id)});
+                       if (!loaded.ok()) {
+                           if (loaded.error().code == core::ErrorCode::kNotFound) {
+                               return JsonError(req.version(), "UPLOAD_NOT_FOUND",
+                                                loaded.error().message, ctx.request_id,
+                                                boost::beast::http::status::not_found);
+                           }
+                           observability::RecordGatewayMetadataRpcFailure();
+                           return JsonError(req.version(), "DB_ERROR", loaded.error().message,
                                             ctx.request_id,
                                             boost::beast::http::status::internal_server_error);
                        }
-                       if (listed_parts.value().empty()) {
+                       const auto& upload = loaded.value()[1].upload;
+                       const auto& listed_parts = loaded.value()[2].parts;
+                       if (!UploadCompletable(upload)) {
+                           return JsonError(req.version(), "INVALID_STATE", "upload is not completable",
+                                            ctx.request_id, boost::beast::http::status::conflict);
+                       }
+                       if (listed_parts.empty()) {
                            return JsonError(req.version(), "INVALID_STATE", "no parts uploaded",
                                             ctx.request_id, boost::beast::http::status::conflict);
                        }
 
-                       std::unordered_map<int, metadata::MultipartPart> part_map;
-                       for (const auto& part : listed_parts.value()) {
-                           part_map[part.part_number] = part;
+                       auto matched = MatchCompleteParts(expected_parts.value(), listed_parts);
+                       if (!matched.ok()) {
+                           const bool missing = matched.error().code == core::ErrorCode::kNotFound;
+                           return JsonError(req.version(),
+                                            missing ? "MISSING_PART" : "ETAG_MISMATCH",
+                                            matched.error().message, ctx.request_id,
+                                            boost::beast::http::status::conflict);
                        }
 
-                       std::vector<DistributedPartLocator> ordered_locators;
-                       ordered_locators.reserve(expected_parts.value().size());
-                       std::vector<std::string> ordered_source_blob_ids;
-                       ordered_source_blob_ids.reserve(expected_parts.value().size());
-
-                       for (const auto& expected : expected_parts.value()) {
-                           auto it = part_map.find(expected.part_number);
-                           if (it == part_map.end()) {
-                               return JsonError(req.version(), "MISSING_PART",
-                                                "missing uploaded part " +
-                                                    std::to_string(expected.part_number),
-                                                ctx.request_id,
-                                                boost::beast::http::status::conflict);
-                           }
-                           if (it->second.etag != expected.etag) {
-                               return JsonError(req.version(), "ETAG_MISMATCH",
-                                                "part etag mismatch for part " +
-                                                    std::to_string(expected.part_number),
-                                                ctx.request_id,
-                                                boost::beast::http::status::conflict);
-                           }
-
-                           auto locator = DecodePartLocator(it->second.temp_path);
+                       // The part blobs become the object as they are: its manifest lists them
+                       // in order, and reads stitch them together, so no bytes move here.
+                       metadata::BatchOp commit =
+                           UploadOp(metadata::BatchOpType::kCommitManifest, upload_id);
+                       commit.expect_upload_state = upload.state;
+                       commit.bucket = bucket;
+                       commit.object_name = upload.object_name;
+                       commit.etag = CompositeEtag(matched.value());
+                       commit.segments.reserve(matched.value().size());
+                       for (const auto* part : matched.value()) {
+                           auto locator = DecodePartLocator(part->temp_path);
                            if (!locator.has_value()) {
                                return JsonError(req.version(), "INVALID_STATE",
                                                 "invalid distributed part locator",
                                                 ctx.request_id,
                                                 boost::beast::http::status::internal_server_error);
                            }
-                           ordered_source_blob_ids.push_back(locator->blob_id);
-                           ordered_locators.push_back(*locator);
+                           metadata::ManifestSegment segment;
+                           segment.blob_id = std::move(locator->blob_id);
+                           segment.offset = commit.size_bytes;
+                           segment.size_bytes = part->size_bytes;
+                           segment.etag = part->etag;
+                           for (auto& endpoint : locator->endpoints) {
+                               segment.replicas.push_back(metadata::ReplicaTarget{
+                                   0, static_cast<int>(segment.replicas.size()),
+                                   std::move(endpoint)});
+                           }
+                           commit.size_bytes += part->size_bytes;
+                           commit.segments.push_back(std::move(segment));
                        }
 
-                       auto plan = metadata->AllocateWrite(bucket, upload.object_name,
-                                                           replication_factor, service_token);
-                       if (!plan.ok()) {
+                       // The object becomes visible and the upload disappears in one
+                       // transaction, and only if no abort or other complete got there first.
+                       const auto size_bytes = commit.size_bytes;
+                       const auto etag = commit.etag;
+                       auto committed = metadata->ExecuteBatch(
+                           {std::move(commit),
+                            UploadOp(metadata::BatchOpType::kDeleteMultipartParts, upload_id),
+                            UploadOp(metadata::BatchOpType::kDeleteMultipartUpload, upload_id)});
+                       if (!committed.ok()) {
+                           if (committed.error().code == core::ErrorCode::kFailedPrecondition ||
+                               committed.error().code == core::ErrorCode::kNotFound) {
+                               return JsonError(req.version(), "INVALID_STATE",
+                                                "upload changed while completing", ctx.request_id,
+                                                boost::beast::http::status::conflict);
+                           }
                            observability::RecordGatewayMetadataRpcFailure();
-                           return JsonError(req.version(), "ALLOCATE_FAILED", plan.error().message,
+                           return JsonError(req.version(), "DB_ERROR", committed.error().message,
                                             ctx.request_id,
                                             boost::beast::http::status::internal_server_error);
                        }
 
-                       std::vector<metadata::ReplicaTarget> composed_replicas;
-                       std::optional<ComposeBlobResult> committed_object;
-                       for (const auto& replica : plan.value().replicas) {
-                           // Compose on replicas that hold every part blob to avoid cross-node part fetches.
-                           bool replica_has_all_parts = true;
-                           for (const auto& locator : ordered_locators) {
-                               if (std::find(locator.endpoints.begin(), locator.endpoints.end(),
-                                             replica.endpoint) == locator.endpoints.end()) {
-                                   replica_has_all_parts = false;
-                                   break;
-                               }
-                           }
-                           if (!replica_has_all_parts) {
-                               observability::RecordGatewayMultipartComposeFailure();
+                       // Parts uploaded but left out of the request belong to nothing now.
+                       auto kept = matched.value().begin();
+                       for (const auto& part : listed_parts) {
+                           if (kept != matched.value().end() && *kept == &part) {
+                               ++kept;
                                continue;
                            }
-
-                           auto composed =
-                               ComposeBlobOnNode(replica.endpoint, plan.value().blob_id,
-                                                 ordered_source_blob_ids, service_token,
-                                                 plan.value().write_token);
-                           if (!composed.ok()) {
-                               observability::RecordGatewayMultipartComposeFailure();
-                               continue;
-                           }
-
-                           if (committed_object.has_value() &&
-                               (committed_object->size_bytes != composed.value().size_bytes ||
-                                committed_object->etag != composed.value().etag)) {
-                               observability::RecordGatewayMultipartComposeFailure();
-                               BestEffortDeleteBlobReplicas(plan.value().blob_id, composed_replicas,
-                                                            service_token);
-                               return JsonError(
-                                   req.version(), "IO_ERROR",
-                                   "multipart compose produced inconsistent replica content",
-                                   ctx.request_id,
-                                   boost::beast::http::status::internal_server_error);
-                           }
-
-                           committed_object = composed.value();
-                           composed_replicas.push_back(replica);
-                       }
-
-                       if (!committed_object.has_value() ||
-                           static_cast<int>(composed_replicas.size()) < min_write_acks) {
-                           BestEffortDeleteBlobReplicas(plan.value().blob_id, composed_replicas,
-                                                        service_token);
-                           return JsonError(
-                               req.version(), "IO_ERROR",
-                               "insufficient storage node compose acknowledgements for multipart complete",
-                               ctx.request_id, boost::beast::http::status::internal_server_error);
-                       }
-
-                       auto commit = metadata->CommitWrite(
-                           bucket, upload.object_name, plan.value().blob_id,
-                           committed_object->size_bytes, committed_object->etag, composed_replicas);
-                       if (!commit.ok()) {
-                           observability::RecordGatewayMetadataRpcFailure();
-                           BestEffortDeleteBlobReplicas(plan.value().blob_id, composed_replicas,
-                                                        service_token);
-                           return JsonError(req.version(), "DB_ERROR", commit.error().message,
-                                            ctx.request_id,
-                                            boost::beast::http::status::internal_server_error);
-                       }
-
-                       for (const auto& part : listed_parts.value()) {
                            auto locator = DecodePartLocator(part.temp_path);
                            if (locator.has_value()) {
                                BestEffortDeletePartBlob(*locator, service_token);
                            }
                        }
 
-                       (void)metadata->UpdateMultipartUploadState(upload_id, "completed");
-                       (void)metadata->DeleteMultipartParts(upload_id);
-                       (void)metadata->DeleteMultipartUpload(upload_id);
                        std::error_code ec;
                        std::filesystem::remove_all(MultipartUploadDir(storage->temp_path(), upload_id),
                                                    ec);
 
                        return JsonOk(req.version(),
                                      "{\"name\":\"" + upload.object_name + "\",\"etag\":\"" +
-                                         committed_object->etag + "\",\"size\":" +
-                                         std::to_string(committed_object->size_bytes) + "}");
+                                         etag + "\",\"size\":" + std::to_string(size_bytes) + "}");
                    });
 
         router.Add("DELETE", "/v1/buckets/{bucket}/multipart-uploads/{upload_id}",
@@ -1046,34 +1310,48 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                        const auto bucket = params.at("bucket");
                        const auto upload_id = params.at("upload_id");
 
-                       int bucket_id = 0;
-                       metadata::MultipartUpload upload;
-                       auto validated =
-                           ValidateUploadForBucket(metadata.get(), bucket, upload_id, &bucket_id, &upload);
-                       if (!validated.ok()) {
+                       auto loaded = LoadUploadForBucket(
+                           metadata.get(), bucket, upload_id,
+                           {UploadOp(metadata::BatchOpType::kListMultipartParts, upload_id)});
+                       if (!loaded.ok()) {
                            return JsonError(req.version(), "UPLOAD_NOT_FOUND",
-                                            validated.error().message, ctx.request_id,
+                                            loaded.error().message, ctx.request_id,
                                             boost::beast::http::status::not_found);
                        }
+                       const auto& upload = loaded.value()[1].upload;
                        if (upload.state == "completed") {
                            return JsonError(req.version(), "INVALID_STATE",
                                             "completed upload cannot abort", ctx.request_id,
                                             boost::beast::http::status::conflict);
                        }
 
-                       auto parts = metadata->ListMultipartParts(upload_id);
-                       if (parts.ok()) {
-                           for (const auto& part : parts.value()) {
-                               auto locator = DecodePartLocator(part.temp_path);
-                               if (locator.has_value()) {
-                                   BestEffortDeletePartBlob(*locator, service_token);
-                               }
+                       // Retire the metadata first and only if a concurrent complete has not
+                       // moved the upload on, so its part blobs are never deleted under it.
+                       metadata::BatchOp delete_parts =
+                           UploadOp(metadata::BatchOpType::kDeleteMultipartParts, upload_id);
+                       delete_parts.expect_upload_state = upload.state;
+                       auto retired = metadata->ExecuteBatch(
+                           {std::move(delete_parts),
+                            UploadOp(metadata::BatchOpType::kDeleteMultipartUpload, upload_id)});
+                       if (!retired.ok()) {
+                           if (retired.error().code == core::ErrorCode::kFailedPrecondition ||
+                               retired.error().code == core::ErrorCode::kNotFound) {
+                               return JsonError(req.version(), "INVALID_STATE",
+                                                "upload changed while aborting", ctx.request_id,
+                                                boost::beast::http::status::conflict);
                            }
+                           observability::RecordGatewayMetadataRpcFailure();
+                           return JsonError(req.version(), "DB_ERROR", retired.error().message,
+                                            ctx.request_id,
+                                            boost::beast::http::status::internal_server_error);
                        }
 
-                       (void)metadata->UpdateMultipartUploadState(upload_id, "aborted");
-                       (void)metadata->DeleteMultipartParts(upload_id);
-                       (void)metadata->DeleteMultipartUpload(upload_id);
+                       for (const auto& part : loaded.value()[2].parts) {
+                           auto locator = DecodePartLocator(part.temp_path);
+                           if (locator.has_value()) {
+                               BestEffortDeletePartBlob(*locator, service_token);
+                           }
+                       }
                        std::error_code ec;
                        std::filesystem::remove_all(MultipartUploadDir(storage->temp_path(), upload_id),
                                                    ec);
@@ -1083,19 +1361,66 @@ void RegisterDefaultRoutes(Router& router, std::shared_ptr<metadata::MetadataBac
                    });
     }
 
+    const bool distributed = config.server.mode == "distributed";
     router.Add("DELETE", "/v1/buckets/{bucket}/objects/{object}",
-               [metadata, storage](const RequestContext& ctx, const HttpRequest& req,
-                                   const RouteParams& params) {
+               [metadata, storage, distributed](const RequestContext& ctx,
+                                                const HttpRequest& req,
+                                                const RouteParams& params) {
                    const auto bucket = params.at("bucket");
                    const auto object = params.at("object");
                    auto storage_result = storage->DeleteObject(bucket, object);
-                   if (!storage_result.ok()) {
+                   if (!storage_result.ok() &&
+                       storage_result.error().code != core::ErrorCode::kNotFound) {
+                       return JsonError(req.version(), "STORAGE_ERROR",
+                                        storage_result.error().message, ctx.request_id,
+                                        boost::beast::http::status::internal_server_error);
+                   }
+                   // Distributed storage removes the row itself.
+                   bool existed = storage_result.ok();
+                   if (!distributed) {
+                       // Objects stored inline have a metadata row and no file.
+                       metadata::BatchOp op;
+                       op.type = metadata::BatchOpType::kDeleteObject;
+                       op.bucket = bucket;
+                       op.object_name = object;
+                       auto rows = metadata->ExecuteBatch({std::move(op)});
+                       if (!rows.ok() && rows.error().code != core::ErrorCode::kNotFound) {
+                           return JsonError(req.version(), "METADATA_ERROR",
+                                            rows.error().message, ctx.request_id,
+                                            boost::beast::http::status::internal_server_error);
+                       }
+                       existed = existed || (rows.ok() && rows.value().front().removed);
+                   }
+                   if (!existed) {
                        return JsonError(req.version(), "OBJECT_NOT_FOUND", "object not found",
                                         ctx.request_id, boost::beast::http::status::not_found);
                    }
-                   metadata->DeleteObject(bucket, object);
                    return JsonOk(req.version(), "{\"deleted\":true}");
                });
+
+    router.Add("POST", "/v1/buckets/{bucket}/delete",
+               [metadata, storage, distributed](const RequestContext& ctx,
+                                                const HttpRequest& req,
+                                                const RouteParams& params) {
+                   return BulkDeleteRequest(metadata.get(), storage.get(), distributed, ctx, req,
+                                            params);
+               });
+
+    router.Add("POST", "/v1/buckets/{bucket}/objects/{object}/copy",
+               [metadata, storage, distributed](const RequestContext& ctx,
+                                                const HttpRequest& req,
+                                                const RouteParams& params) {
+                   return CopyObjectRequest(metadata.get(), storage.get(), distributed, ctx, req,
+                                            params, false);
+               });
+
+    router.Add("POST", "/v1/buckets/{bucket}/objects/{object}/move",
+               [metadata, storage, distributed](const RequestContext& ctx,
+                                                const HttpRequest& req,
+                                                const RouteParams& params) {
+                   return CopyObjectRequest(metadata.get(), storage.get(), distributed, ctx, req,
+                                            params, true);
+               });
 }
 
 }  // namespace nebulafs::http
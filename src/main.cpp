@@ -1,19 +1,24 @@
-#include <filesystem>
+#include <chrono>
+#include <exception>
 #include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include "nebulafs/core/config.h"
 #include "nebulafs/core/logger.h"
 #include "nebulafs/http/http_server.h"
 #include "nebulafs/http/route_registration.h"
 #include "nebulafs/http/router.h"
+#include "nebulafs/metadata/caching_metadata_store.h"
+#include "nebulafs/metadata/change_feed_watcher.h"
 #include "nebulafs/metadata/metadata_backend.h"
+#include "nebulafs/metadata/metadata_store_factory.h"
 #include "nebulafs/metadata/remote_metadata_store.h"
-#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/metadata/sharded_metadata_store.h"
 #include "nebulafs/storage/local_storage.h"
 #include "nebulafs/storage/remote_storage_backend.h"
 #include "nebulafs/storage/storage_backend.h"
@@ -30,6 +35,57 @@ std::string GetArgValue(int argc, char** argv, const std::string& key,
     return default_value;
 }
 
+// Returns null when the cache is disabled.
+std::shared_ptr<nebulafs::metadata::CachingMetadataStore> MakeMetadataCache(
+    std::shared_ptr<nebulafs::metadata::MetadataBackend> metadata,
+    const nebulafs::core::MetadataCacheConfig& cache) {
+    if (!cache.enabled) {
+        return nullptr;
+    }
+    nebulafs::metadata::MetadataCacheOptions options;
+    options.bucket_ttl = std::chrono::milliseconds(cache.bucket_ttl_ms);
+    options.read_plan_ttl = std::chrono::milliseconds(cache.read_plan_ttl_ms);
+    options.negative_ttl = std::chrono::milliseconds(cache.negative_ttl_ms);
+    options.max_bytes = cache.max_bytes;
+    return std::make_shared<nebulafs::metadata::CachingMetadataStore>(std::move(metadata),
+                                                                      options);
+}
+
+// Re-reads the shard map on a timer. Newly added shards are told about the storage nodes before
+// the next reload, and a bad file keeps the current map.
+void ScheduleShardMapReload(boost::asio::steady_timer& timer,
+                            const nebulafs::core::DistributedConfig& distributed,
+                            std::shared_ptr<nebulafs::metadata::ShardedMetadataStore> sharded,
+                            std::shared_ptr<nebulafs::metadata::ChangeFeedWatcher> watcher) {
+    timer.expires_after(std::chrono::seconds(distributed.shard_map_reload_seconds));
+    timer.async_wait([&timer, &distributed, sharded,
+                      watcher](const boost::system::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        try {
+            auto endpoints = nebulafs::core::LoadShardMap(distributed.shard_map_path);
+            nebulafs::metadata::ShardMap next(endpoints);
+            if (next.endpoints() != sharded->endpoints()) {
+                sharded->Reload(std::move(endpoints));
+                auto configured = sharded->ConfigureStorageNodes(distributed.storage_nodes);
+                if (!configured.ok()) {
+                    nebulafs::core::LogError("Failed to configure storage nodes on new shards: " +
+                                             configured.error().message);
+                }
+                if (watcher) {
+                    watcher->SetEndpoints(sharded->endpoints());
+                }
+                nebulafs::core::LogInfo("Reloaded metadata shard map with " +
+                                        std::to_string(next.size()) + " shards");
+            }
+        } catch (const std::exception& ex) {
+            nebulafs::core::LogError(std::string("Failed to reload shard map: ") + ex.what());
+        }
+        ScheduleShardMapReload(timer, distributed, sharded, watcher);
+    });
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -40,10 +96,41 @@ int main(int argc, char** argv) {
     nebulafs::core::InitLogging(config.observability.log_level);
 
     std::shared_ptr<nebulafs::metadata::MetadataBackend> metadata;
+    std::shared_ptr<nebulafs::metadata::ShardedMetadataStore> sharded;
+    std::shared_ptr<nebulafs::metadata::ChangeFeedWatcher> watcher;
     std::shared_ptr<nebulafs::storage::StorageBackend> storage;
     if (config.server.mode == "distributed") {
-        metadata = std::make_shared<nebulafs::metadata::RemoteMetadataStore>(
-            config.distributed.metadata_base_url, config.distributed.service_auth_token);
+        const auto token = config.distributed.service_auth_token;
+        const auto rpc_format = nebulafs::core::WireFormatFromName(config.distributed.rpc_format);
+        auto shards = nebulafs::core::MetadataShardEndpoints(config.distributed);
+        if (shards.size() == 1 && config.distributed.shard_map_path.empty()) {
+            metadata = std::make_shared<nebulafs::metadata::RemoteMetadataStore>(
+                shards.front(), token, rpc_format);
+        } else {
+            sharded = std::make_shared<nebulafs::metadata::ShardedMetadataStore>(
+                std::move(shards), [token, rpc_format](const std::string& endpoint) {
+                    return std::make_shared<nebulafs::metadata::RemoteMetadataStore>(
+                        endpoint, token, rpc_format);
+                });
+            metadata = sharded;
+        }
+        auto endpoints = sharded ? sharded->endpoints() : shards;
+        if (auto cache = MakeMetadataCache(metadata, config.metadata_cache)) {
+            if (config.metadata_cache.change_feed) {
+                watcher = std::make_shared<nebulafs::metadata::ChangeFeedWatcher>(
+                    cache,
+                    [token, rpc_format](const std::string& endpoint) {
+                        auto remote = std::make_shared<nebulafs::metadata::RemoteMetadataStore>(
+                            endpoint, token, rpc_format);
+                        return [remote](const std::string& cursor, int wait_ms) {
+                            return remote->ReadChanges(cursor, wait_ms);
+                        };
+                    },
+                    config.metadata_cache.change_feed_wait_ms);
+                watcher->SetEndpoints(endpoints);
+            }
+            metadata = std::move(cache);
+        }
         auto configured_nodes = metadata->ConfigureStorageNodes(config.distributed.storage_nodes);
         if (!configured_nodes.ok()) {
             nebulafs::core::LogError("Failed to configure storage nodes: " +
@@ -53,11 +140,14 @@ int main(int argc, char** argv) {
         storage = std::make_shared<nebulafs::storage::RemoteStorageBackend>(
             config.distributed, metadata, config.storage.temp_path);
     } else {
-        auto sqlite_path = nebulafs::core::LoadDatabasePath(db_path);
-        std::filesystem::create_directories(std::filesystem::path(sqlite_path).parent_path());
-        metadata = std::make_shared<nebulafs::metadata::SqliteMetadataStore>(sqlite_path);
-        storage = std::make_shared<nebulafs::storage::LocalStorage>(config.storage.base_path,
-                                                                    config.storage.temp_path);
+        metadata =
+            nebulafs::metadata::OpenMetadataStore(nebulafs::core::LoadDatabaseConfig(db_path));
+        if (auto cache = MakeMetadataCache(metadata, config.metadata_cache)) {
+            metadata = std::move(cache);
+        }
+        storage = std::make_shared<nebulafs::storage::LocalStorage>(
+            config.storage.base_path, config.storage.temp_path, config.storage.content_addressed,
+            config.storage.fanout_buckets, config.storage.compressed_buckets);
     }
 
     nebulafs::http::Router router;
@@ -67,6 +157,11 @@ int main(int argc, char** argv) {
     nebulafs::http::HttpServer server(ioc, config, std::move(router), storage, metadata);
     server.Run();
 
+    boost::asio::steady_timer shard_map_timer(ioc);
+    if (sharded && !config.distributed.shard_map_path.empty()) {
+        ScheduleShardMapReload(shard_map_timer, config.distributed, sharded, watcher);
+    }
+
     std::vector<std::thread> threads;
     threads.reserve(static_cast<size_t>(config.server.threads));
     for (int i = 0; i < config.server.threads; ++i) {
@@ -0,0 +1,378 @@
+#include "nebulafs/metadata/caching_metadata_store.h"
+
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/observability/metrics.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Allowance for list and hash-map nodes per entry on top of the payload strings.
+constexpr std::uint64_t kEntryOverheadBytes = 128;
+
+std::string BucketKey(const std::string& bucket) { return "b/" + bucket; }
+
+// Names never contain NUL, so the separator keeps `a` + `b/c` apart from `a/b` + `c`.
+std::string ReadPlanPrefix(const std::string& bucket) { return "r/" + bucket + '\0'; }
+
+std::string ReadPlanKey(const std::string& bucket, const std::string& object_name) {
+    return ReadPlanPrefix(bucket) + object_name;
+}
+
+bool HasPrefix(const std::string& key, const std::string& prefix) {
+    return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::uint64_t PayloadBytes(const core::Error& error) { return error.message.size(); }
+
+std::uint64_t PayloadBytes(const Bucket& bucket) {
+    return sizeof(Bucket) + bucket.name.size() + bucket.created_at.size();
+}
+
+std::uint64_t PayloadBytes(const std::vector<ReplicaTarget>& replicas) {
+    std::uint64_t bytes = 0;
+    for (const auto& replica : replicas) {
+        bytes += sizeof(ReplicaTarget) + replica.endpoint.size();
+    }
+    return bytes;
+}
+
+std::uint64_t PayloadBytes(const ResolveReadPlan& plan) {
+    std::uint64_t bytes = sizeof(ResolveReadPlan) + plan.blob_id.size() + plan.etag.size() +
+                          PayloadBytes(plan.replicas);
+    // A composite object's manifest can hold thousands of segments, which dwarf the rest.
+    for (const auto& segment : plan.segments) {
+        bytes += sizeof(ManifestSegment) + segment.blob_id.size() + segment.etag.size() +
+                 PayloadBytes(segment.replicas);
+    }
+    return bytes;
+}
+
+}  // namespace
+
+CachingMetadataStore::CachingMetadataStore(std::shared_ptr<MetadataStore> inner,
+                                           MetadataCacheOptions options)
+    : inner_(std::move(inner)), options_(options) {}
+
+std::uint64_t CachingMetadataStore::cached_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+template <typename T>
+bool CachingMetadataStore::FindLocked(const std::string& key, core::Result<T>* out) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (it->second->expires_at <= Clock::now()) {
+        EraseLocked(key);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    const auto& value = it->second->value;
+    if (const auto* error = std::get_if<core::Error>(&value)) {
+        *out = *error;
+    } else {
+        *out = std::get<T>(value);
+    }
+    return true;
+}
+
+void CachingMetadataStore::StoreLocked(const std::string& key, Value value,
+                                       std::chrono::milliseconds ttl) {
+    EraseLocked(key);
+    const auto bytes = kEntryOverheadBytes + 2 * key.size() +
+                       std::visit([](const auto& v) { return PayloadBytes(v); }, value);
+    if (ttl.count() <= 0 || bytes > options_.max_bytes) {
+        return;
+    }
+    while (bytes_ + bytes > options_.max_bytes && !lru_.empty()) {
+        EraseLocked(lru_.back().key);
+    }
+    lru_.push_front(Entry{key, std::move(value), Clock::now() + ttl, bytes});
+    entries_[key] = lru_.begin();
+    bytes_ += bytes;
+}
+
+void CachingMetadataStore::EraseLocked(const std::string& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return;
+    }
+    bytes_ -= it->second->bytes;
+    lru_.erase(it->second);
+    entries_.erase(it);
+}
+
+template <typename T, typename Load>
+core::Result<T> CachingMetadataStore::Lookup(const std::string& key, Flights<T>& flights,
+                                             Load load) {
+    std::promise<core::Result<T>> promise;
+    std::uint64_t flight_id = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        core::Result<T> cached{core::Error{core::ErrorCode::kInternal, "unset"}};
+        if (FindLocked(key, &cached)) {
+            lock.unlock();
+            observability::RecordGatewayMetadataCacheLookup(true);
+            return cached;
+        }
+        auto pending = flights.find(key);
+        if (pending != flights.end()) {
+            auto shared = pending->second.result;
+            lock.unlock();
+            observability::RecordGatewayMetadataCacheCoalesced();
+            return shared.get();
+        }
+        flight_id = ++next_flight_id_;
+        flights.emplace(key, Flight<T>{flight_id, promise.get_future().share()});
+    }
+    observability::RecordGatewayMetadataCacheLookup(false);
+
+    // A write that lands while this lookup is outstanding erases the flight, so the answer is
+    // still handed to the callers already waiting but is not cached.
+    auto retire = [&] {
+        auto it = flights.find(key);
+        if (it == flights.end() || it->second.id != flight_id) {
+            return false;
+        }
+        flights.erase(it);
+        return true;
+    };
+    try {
+        auto result = load();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (retire()) {
+                if (result.ok()) {
+                    const auto ttl = std::is_same_v<T, Bucket> ? options_.bucket_ttl
+                                                               : options_.read_plan_ttl;
+                    StoreLocked(key, result.value(), ttl);
+                } else if (result.error().code == core::ErrorCode::kNotFound) {
+                    StoreLocked(key, result.error(), options_.negative_ttl);
+                }
+            }
+        }
+        promise.set_value(result);
+        return result;
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retire();
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void CachingMetadataStore::InvalidateBucket(const std::string& bucket) {
+    const auto key = BucketKey(bucket);
+    std::lock_guard<std::mutex> lock(mutex_);
+    EraseLocked(key);
+    bucket_flights_.erase(key);
+}
+
+void CachingMetadataStore::InvalidateObject(const std::string& bucket,
+                                            const std::string& object_name) {
+    const auto key = ReadPlanKey(bucket, object_name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    EraseLocked(key);
+    read_flights_.erase(key);
+}
+
+void CachingMetadataStore::InvalidateObjects(const std::string& bucket) {
+    const auto prefix = ReadPlanPrefix(bucket);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        auto next = std::next(it);
+        if (HasPrefix(it->key, prefix)) {
+            EraseLocked(it->key);
+        }
+        it = next;
+    }
+    for (auto it = read_flights_.begin(); it != read_flights_.end();) {
+        it = HasPrefix(it->first, prefix) ? read_flights_.erase(it) : std::next(it);
+    }
+}
+
+void CachingMetadataStore::ApplyChange(const ChangeEvent& change) {
+    switch (change.kind) {
+        case ChangeKind::kBucket:
+            InvalidateBucket(change.bucket);
+            break;
+        case ChangeKind::kObject:
+            if (change.object_name.empty()) {
+                InvalidateObjects(change.bucket);
+            } else {
+                InvalidateObject(change.bucket, change.object_name);
+            }
+            break;
+        case ChangeKind::kUpload:
+            // Uploads are not cached.
+            break;
+    }
+}
+
+void CachingMetadataStore::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    entries_.clear();
+    bytes_ = 0;
+    bucket_flights_.clear();
+    read_flights_.clear();
+}
+
+core::Result<Bucket> CachingMetadataStore::CreateBucket(const std::string& name) {
+    auto created = inner_->CreateBucket(name);
+    InvalidateBucket(name);
+    return created;
+}
+
+core::Result<std::vector<Bucket>> CachingMetadataStore::ListBuckets() {
+    return inner_->ListBuckets();
+}
+
+core::Result<Bucket> CachingMetadataStore::GetBucket(const std::string& name) {
+    return Lookup<Bucket>(BucketKey(name), bucket_flights_,
+                          [&] { return inner_->GetBucket(name); });
+}
+
+// Writes invalidate whatever their outcome: a failed RPC may still have been applied.
+
+core::Result<ObjectMetadata> CachingMetadataStore::UpsertObject(const std::string& bucket,
+                                                                const ObjectMetadata& object) {
+    auto upserted = inner_->UpsertObject(bucket, object);
+    InvalidateObject(bucket, object.name);
+    return upserted;
+}
+
+core::Result<ObjectMetadata> CachingMetadataStore::GetObject(const std::string& bucket,
+                                                             const std::string& object) {
+    return inner_->GetObject(bucket, object);
+}
+
+core::Result<std::vector<ObjectMetadata>> CachingMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    return inner_->ListObjects(bucket, prefix);
+}
+
+core::Result<ObjectListing> CachingMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    return inner_->ListObjectsPage(bucket, options);
+}
+
+core::Result<void> CachingMetadataStore::DeleteObject(const std::string& bucket,
+                                                      const std::string& object) {
+    auto deleted = inner_->DeleteObject(bucket, object);
+    InvalidateObject(bucket, object);
+    return deleted;
+}
+
+core::Result<MultipartUpload> CachingMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    return inner_->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+}
+
+core::Result<MultipartUpload> CachingMetadataStore::GetMultipartUpload(
+    const std::string& upload_id) {
+    return inner_->GetMultipartUpload(upload_id);
+}
+
+core::Result<std::vector<MultipartUpload>> CachingMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    return inner_->ListExpiredMultipartUploads(expires_before, limit);
+}
+
+core::Result<void> CachingMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
+                                                                    const std::string& state) {
+    return inner_->UpdateMultipartUploadState(upload_id, state);
+}
+
+core::Result<void> CachingMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    return inner_->DeleteMultipartUpload(upload_id);
+}
+
+core::Result<MultipartPart> CachingMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes, const std::string& etag,
+    const std::string& temp_path) {
+    return inner_->UpsertMultipartPart(upload_id, part_number, size_bytes, etag, temp_path);
+}
+
+core::Result<std::vector<MultipartPart>> CachingMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    return inner_->ListMultipartParts(upload_id);
+}
+
+core::Result<void> CachingMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
+    return inner_->DeleteMultipartParts(upload_id);
+}
+
+core::Result<void> CachingMetadataStore::ConfigureStorageNodes(
+    const std::vector<std::string>& endpoints) {
+    auto configured = inner_->ConfigureStorageNodes(endpoints);
+    // Read plans carry node endpoints, which this may have changed.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        auto next = std::next(it);
+        if (std::holds_alternative<ResolveReadPlan>(it->value)) {
+            EraseLocked(it->key);
+        }
+        it = next;
+    }
+    read_flights_.clear();
+    return configured;
+}
+
+core::Result<AllocateWritePlan> CachingMetadataStore::AllocateWrite(
+    const std::string& bucket, const std::string& object_name, int replication_factor,
+    const std::string& service_token) {
+    return inner_->AllocateWrite(bucket, object_name, replication_factor, service_token);
+}
+
+core::Result<void> CachingMetadataStore::CommitWrite(const std::string& bucket,
+                                                     const std::string& object_name,
+                                                     const std::string& blob_id,
+                                                     std::uint64_t size_bytes,
+                                                     const std::string& etag,
+                                                     const std::vector<ReplicaTarget>& replicas) {
+    auto committed = inner_->CommitWrite(bucket, object_name, blob_id, size_bytes, etag, replicas);
+    InvalidateObject(bucket, object_name);
+    return committed;
+}
+
+core::Result<ResolveReadPlan> CachingMetadataStore::ResolveRead(const std::string& bucket,
+                                                                const std::string& object_name) {
+    return Lookup<ResolveReadPlan>(ReadPlanKey(bucket, object_name), read_flights_,
+                                   [&] { return inner_->ResolveRead(bucket, object_name); });
+}
+
+core::Result<std::vector<BatchOpResult>> CachingMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    auto executed = inner_->ExecuteBatch(ops);
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto& op = ops[i];
+        if (ChangesObject(op)) {
+            // An empty name means the upload's object, which only the metadata service knows.
+            if (op.object_name.empty()) {
+                InvalidateObjects(op.bucket);
+            } else {
+                InvalidateObject(op.bucket, op.object_name);
+            }
+        } else if (op.type == BatchOpType::kGetBucket && executed.ok() &&
+                   i < executed.value().size()) {
+            // Buckets are never deleted, so a bucket the batch found can be cached as is.
+            std::lock_guard<std::mutex> lock(mutex_);
+            StoreLocked(BucketKey(op.bucket), executed.value()[i].bucket, options_.bucket_ttl);
+        }
+    }
+    return executed;
+}
+
+}  // namespace nebulafs::metadata
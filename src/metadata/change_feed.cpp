@@ -0,0 +1,106 @@
+#include "nebulafs/metadata/change_feed.h"
+
+#include <array>
+#include <chrono>
+#include <charconv>
+#include <utility>
+
+#include "nebulafs/core/ids.h"
+#include "nebulafs/observability/metrics.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr std::array<std::pair<ChangeKind, std::string_view>, 3> kKindNames = {{
+    {ChangeKind::kBucket, "bucket"},
+    {ChangeKind::kObject, "object"},
+    {ChangeKind::kUpload, "upload"},
+}};
+
+std::uint64_t NowUnixMillis() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          std::chrono::system_clock::now().time_since_epoch())
+                                          .count());
+}
+
+}  // namespace
+
+std::string_view ChangeKindName(ChangeKind kind) {
+    for (const auto& [change_kind, name] : kKindNames) {
+        if (change_kind == kind) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+std::optional<ChangeKind> ParseChangeKindName(std::string_view name) {
+    for (const auto& [change_kind, kind_name] : kKindNames) {
+        if (kind_name == name) {
+            return change_kind;
+        }
+    }
+    return std::nullopt;
+}
+
+ChangeFeed::ChangeFeed(std::size_t retain_events)
+    : retain_events_(retain_events == 0 ? 1 : retain_events),
+      epoch_(core::GenerateRequestId()) {}
+
+void ChangeFeed::Append(ChangeKind kind, std::string bucket, std::string object_name,
+                        std::string upload_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(ChangeEvent{++head_, kind, std::move(bucket), std::move(object_name),
+                                      std::move(upload_id), NowUnixMillis()});
+        if (events_.size() > retain_events_) {
+            events_.pop_front();
+        }
+    }
+    observability::RecordMetadataChangeFeedEvent();
+    appended_.notify_all();
+}
+
+ChangePage ChangeFeed::Read(std::string_view cursor, std::size_t max_events, int wait_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ChangePage page;
+    // Cursors are "<epoch>:<sequence>"; anything else restarts the reader at the head.
+    std::uint64_t after = 0;
+    const auto colon = cursor.rfind(':');
+    const bool same_feed = colon != std::string_view::npos && cursor.substr(0, colon) == epoch_ &&
+                           std::from_chars(cursor.data() + colon + 1,
+                                           cursor.data() + cursor.size(), after)
+                                   .ec == std::errc{};
+    if (same_feed && after == head_ && wait_ms > 0) {
+        appended_.wait_for(lock, std::chrono::milliseconds(wait_ms),
+                           [&] { return head_ > after; });
+    }
+    // Checked after the wait too: a burst of appends may have evicted the reader's position.
+    const auto first = events_.empty() ? head_ + 1 : events_.front().sequence;
+    if (!same_feed || after > head_ || after + 1 < first) {
+        page.reset = true;
+        page.cursor = CursorAt(head_);
+        page.head = head_;
+        return page;
+    }
+    // Events are numbered consecutively, so the first one to return sits at a known offset.
+    for (auto i = static_cast<std::size_t>(after + 1 - first);
+         i < events_.size() && page.events.size() < max_events; ++i) {
+        page.events.push_back(events_[i]);
+    }
+    page.cursor = CursorAt(page.events.empty() ? after : page.events.back().sequence);
+    page.head = head_;
+    return page;
+}
+
+std::uint64_t ChangeFeed::head() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return head_;
+}
+
+std::string ChangeFeed::CursorAt(std::uint64_t sequence) const {
+    return epoch_ + ":" + std::to_string(sequence);
+}
+
+}  // namespace nebulafs::metadata
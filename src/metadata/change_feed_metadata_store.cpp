@@ -0,0 +1,195 @@
+#include "nebulafs/metadata/change_feed_metadata_store.h"
+
+#include <utility>
+
+#include "nebulafs/metadata/metadata_batch.h"
+
+namespace nebulafs::metadata {
+
+ChangeFeedMetadataStore::ChangeFeedMetadataStore(std::shared_ptr<MetadataStore> inner,
+                                                 std::shared_ptr<ChangeFeed> feed)
+    : inner_(std::move(inner)), feed_(std::move(feed)) {}
+
+core::Result<Bucket> ChangeFeedMetadataStore::CreateBucket(const std::string& name) {
+    auto created = inner_->CreateBucket(name);
+    if (created.ok()) {
+        feed_->Append(ChangeKind::kBucket, name);
+    }
+    return created;
+}
+
+core::Result<std::vector<Bucket>> ChangeFeedMetadataStore::ListBuckets() {
+    return inner_->ListBuckets();
+}
+
+core::Result<Bucket> ChangeFeedMetadataStore::GetBucket(const std::string& name) {
+    return inner_->GetBucket(name);
+}
+
+core::Result<ObjectMetadata> ChangeFeedMetadataStore::UpsertObject(const std::string& bucket,
+                                                                   const ObjectMetadata& object) {
+    auto upserted = inner_->UpsertObject(bucket, object);
+    if (upserted.ok()) {
+        feed_->Append(ChangeKind::kObject, bucket, object.name);
+    }
+    return upserted;
+}
+
+core::Result<ObjectMetadata> ChangeFeedMetadataStore::GetObject(const std::string& bucket,
+                                                                const std::string& object) {
+    return inner_->GetObject(bucket, object);
+}
+
+core::Result<std::vector<ObjectMetadata>> ChangeFeedMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    return inner_->ListObjects(bucket, prefix);
+}
+
+core::Result<ObjectListing> ChangeFeedMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    return inner_->ListObjectsPage(bucket, options);
+}
+
+core::Result<void> ChangeFeedMetadataStore::DeleteObject(const std::string& bucket,
+                                                         const std::string& object) {
+    auto deleted = inner_->DeleteObject(bucket, object);
+    if (deleted.ok()) {
+        feed_->Append(ChangeKind::kObject, bucket, object);
+    }
+    return deleted;
+}
+
+core::Result<MultipartUpload> ChangeFeedMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    auto created = inner_->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+    if (created.ok()) {
+        feed_->Append(ChangeKind::kUpload, bucket, object_name, upload_id);
+    }
+    return created;
+}
+
+core::Result<MultipartUpload> ChangeFeedMetadataStore::GetMultipartUpload(
+    const std::string& upload_id) {
+    return inner_->GetMultipartUpload(upload_id);
+}
+
+core::Result<std::vector<MultipartUpload>> ChangeFeedMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    return inner_->ListExpiredMultipartUploads(expires_before, limit);
+}
+
+core::Result<void> ChangeFeedMetadataStore::UpdateMultipartUploadState(
+    const std::string& upload_id, const std::string& state) {
+    auto updated = inner_->UpdateMultipartUploadState(upload_id, state);
+    if (updated.ok()) {
+        feed_->Append(ChangeKind::kUpload, {}, {}, upload_id);
+    }
+    return updated;
+}
+
+core::Result<void> ChangeFeedMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    auto deleted = inner_->DeleteMultipartUpload(upload_id);
+    if (deleted.ok()) {
+        feed_->Append(ChangeKind::kUpload, {}, {}, upload_id);
+    }
+    return deleted;
+}
+
+core::Result<MultipartPart> ChangeFeedMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes,
+    const std::string& etag, const std::string& temp_path) {
+    auto part = inner_->UpsertMultipartPart(upload_id, part_number, size_bytes, etag, temp_path);
+    if (part.ok()) {
+        feed_->Append(ChangeKind::kUpload, {}, {}, upload_id);
+    }
+    return part;
+}
+
+core::Result<std::vector<MultipartPart>> ChangeFeedMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    return inner_->ListMultipartParts(upload_id);
+}
+
+core::Result<void> ChangeFeedMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
+    auto deleted = inner_->DeleteMultipartParts(upload_id);
+    if (deleted.ok()) {
+        feed_->Append(ChangeKind::kUpload, {}, {}, upload_id);
+    }
+    return deleted;
+}
+
+core::Result<void> ChangeFeedMetadataStore::ConfigureStorageNodes(
+    const std::vector<std::string>& endpoints) {
+    return inner_->ConfigureStorageNodes(endpoints);
+}
+
+core::Result<AllocateWritePlan> ChangeFeedMetadataStore::AllocateWrite(
+    const std::string& bucket, const std::string& object_name, int replication_factor,
+    const std::string& service_token) {
+    return inner_->AllocateWrite(bucket, object_name, replication_factor, service_token);
+}
+
+core::Result<void> ChangeFeedMetadataStore::CommitWrite(
+    const std::string& bucket, const std::string& object_name, const std::string& blob_id,
+    std::uint64_t size_bytes, const std::string& etag, const std::vector<ReplicaTarget>& replicas) {
+    auto committed =
+        inner_->CommitWrite(bucket, object_name, blob_id, size_bytes, etag, replicas);
+    if (committed.ok()) {
+        feed_->Append(ChangeKind::kObject, bucket, object_name);
+    }
+    return committed;
+}
+
+core::Result<ResolveReadPlan> ChangeFeedMetadataStore::ResolveRead(
+    const std::string& bucket, const std::string& object_name) {
+    return inner_->ResolveRead(bucket, object_name);
+}
+
+core::Result<std::vector<BatchOpResult>> ChangeFeedMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    // A commit may name its object only through the upload. An upload's object name never
+    // changes, so it can be read before the batch runs; if that fails, the event covers the
+    // whole bucket instead.
+    std::vector<std::string> commit_names(ops.size());
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        if (ChangesObject(ops[i])) {
+            commit_names[i] = ops[i].object_name;
+            if (commit_names[i].empty() && !ops[i].upload_id.empty()) {
+                auto upload = inner_->GetMultipartUpload(ops[i].upload_id);
+                if (upload.ok()) {
+                    commit_names[i] = std::move(upload.value().object_name);
+                }
+            }
+        }
+    }
+    auto executed = inner_->ExecuteBatch(ops);
+    if (!executed.ok()) {
+        return executed;
+    }
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto& op = ops[i];
+        switch (op.type) {
+            case BatchOpType::kCommitWrite:
+            case BatchOpType::kCommitManifest:
+            case BatchOpType::kCopyObject:
+            case BatchOpType::kDeleteObject:
+                feed_->Append(ChangeKind::kObject, op.bucket, commit_names[i]);
+                break;
+            case BatchOpType::kCreateMultipartUpload:
+                feed_->Append(ChangeKind::kUpload, op.bucket, op.object_name, op.upload_id);
+                break;
+            case BatchOpType::kUpdateMultipartUploadState:
+            case BatchOpType::kSetMultipartPartSize:
+            case BatchOpType::kDeleteMultipartParts:
+            case BatchOpType::kDeleteMultipartUpload:
+                feed_->Append(ChangeKind::kUpload, op.bucket, {}, op.upload_id);
+                break;
+            default:
+                break;
+        }
+    }
+    return executed;
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,113 @@
+#include "nebulafs/metadata/change_feed_watcher.h"
+
+#include <chrono>
+#include <set>
+#include <utility>
+
+#include "nebulafs/core/logger.h"
+#include "nebulafs/observability/metrics.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr auto kRetryDelay = std::chrono::seconds(1);
+constexpr auto kStopCheckInterval = std::chrono::milliseconds(50);
+
+std::int64_t NowUnixMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void SleepUnlessStopped(const std::atomic<bool>& stop) {
+    const auto until = std::chrono::steady_clock::now() + kRetryDelay;
+    while (!stop && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(kStopCheckInterval);
+    }
+}
+
+// Owns only shared state, so a poller that is told to stop may finish its last poll detached.
+void Follow(const std::string& endpoint, std::shared_ptr<CachingMetadataStore> cache,
+            ChangeFeedWatcher::Source source, int wait_ms,
+            std::shared_ptr<std::atomic<bool>> stop) {
+    std::string cursor;
+    bool failing = false;
+    while (!*stop) {
+        auto page = source(cursor, wait_ms);
+        if (*stop) {
+            break;
+        }
+        if (!page.ok()) {
+            cache->Clear();
+            observability::RecordGatewayChangeFeedError();
+            if (!failing) {
+                core::LogError("Change feed " + endpoint + " unavailable: " +
+                               page.error().message);
+                failing = true;
+            }
+            SleepUnlessStopped(*stop);
+            continue;
+        }
+        failing = false;
+        if (page.value().reset) {
+            cache->Clear();
+            observability::RecordGatewayChangeFeedReset();
+        }
+        const auto now_ms = NowUnixMillis();
+        for (const auto& change : page.value().events) {
+            cache->ApplyChange(change);
+            observability::RecordGatewayChangeFeedLag(now_ms -
+                                                      static_cast<std::int64_t>(change.time_ms));
+        }
+        cursor = std::move(page.value().cursor);
+    }
+}
+
+}  // namespace
+
+ChangeFeedWatcher::ChangeFeedWatcher(std::shared_ptr<CachingMetadataStore> cache,
+                                     SourceFactory factory, int wait_ms)
+    : cache_(std::move(cache)), factory_(std::move(factory)), wait_ms_(wait_ms) {}
+
+ChangeFeedWatcher::~ChangeFeedWatcher() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [endpoint, poller] : pollers_) {
+        *poller.stop = true;
+    }
+    for (auto& [endpoint, poller] : pollers_) {
+        poller.thread.join();
+    }
+}
+
+void ChangeFeedWatcher::SetEndpoints(const std::vector<std::string>& endpoints) {
+    const std::set<std::string> wanted(endpoints.begin(), endpoints.end());
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool removed = false;
+    for (auto it = pollers_.begin(); it != pollers_.end();) {
+        if (wanted.count(it->first) != 0) {
+            ++it;
+            continue;
+        }
+        // Its current long poll may run for `wait_ms` more; nothing waits for it.
+        *it->second.stop = true;
+        it->second.thread.detach();
+        it = pollers_.erase(it);
+        removed = true;
+    }
+    // Buckets of a removed endpoint moved to a shard whose history this cache never followed.
+    // Added endpoints clear the cache on their first read, which always resets.
+    if (removed) {
+        cache_->Clear();
+    }
+    for (const auto& endpoint : wanted) {
+        if (pollers_.count(endpoint) != 0) {
+            continue;
+        }
+        auto stop = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread(Follow, endpoint, cache_, factory_(endpoint), wait_ms_, stop);
+        pollers_.emplace(endpoint, Poller{std::move(stop), std::move(thread)});
+    }
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,138 @@
+#include "nebulafs/metadata/http_replica_transport.h"
+
+#include <sstream>
+#include <utility>
+
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+#include <Poco/URI.h>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/distributed/http_client.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+core::Result<Poco::JSON::Object::Ptr> PostJson(const std::string& url,
+                                               const Poco::JSON::Object::Ptr& body,
+                                               const std::string& token, int timeout_ms) {
+    std::ostringstream ss;
+    body->stringify(ss);
+    auto call = distributed::SendHttpRequest("POST", url, ss.str(), "application/json", token, {},
+                                             timeout_ms);
+    if (!call.ok()) {
+        return call.error();
+    }
+    if (call.value().status != 200) {
+        return core::Error{core::ErrorCode::kUnavailable,
+                           "replication rpc failed: " + call.value().body};
+    }
+    try {
+        Poco::JSON::Parser parser;
+        return parser.parse(call.value().body).extract<Poco::JSON::Object::Ptr>();
+    } catch (const std::exception& ex) {
+        return core::Error{core::ErrorCode::kInternal, ex.what()};
+    }
+}
+
+}  // namespace
+
+HttpReplicaTransport::HttpReplicaTransport(std::string service_auth_token, int timeout_ms)
+    : service_auth_token_(std::move(service_auth_token)), timeout_ms_(timeout_ms) {
+}
+
+core::Result<VoteResponse> HttpReplicaTransport::RequestVote(const std::string& peer,
+                                                             const VoteRequest& request) {
+    Poco::JSON::Object::Ptr body = new Poco::JSON::Object();
+    body->set("term", static_cast<Poco::UInt64>(request.term));
+    body->set("candidate", request.candidate);
+    body->set("last_index", static_cast<Poco::UInt64>(request.last_index));
+    body->set("last_term", static_cast<Poco::UInt64>(request.last_term));
+    auto parsed = PostJson(peer + "/internal/v1/replication/vote", body, service_auth_token_,
+                           timeout_ms_);
+    if (!parsed.ok()) {
+        return parsed.error();
+    }
+    return VoteResponse{parsed.value()->getValue<Poco::UInt64>("term"),
+                        parsed.value()->getValue<bool>("granted")};
+}
+
+core::Result<HeartbeatResponse> HttpReplicaTransport::Heartbeat(const std::string& peer,
+                                                                const HeartbeatRequest& request) {
+    Poco::JSON::Object::Ptr body = new Poco::JSON::Object();
+    body->set("term", static_cast<Poco::UInt64>(request.term));
+    body->set("leader", request.leader);
+    body->set("commit_index", static_cast<Poco::UInt64>(request.commit_index));
+    auto parsed = PostJson(peer + "/internal/v1/replication/heartbeat", body,
+                           service_auth_token_, timeout_ms_);
+    if (!parsed.ok()) {
+        return parsed.error();
+    }
+    return HeartbeatResponse{parsed.value()->getValue<Poco::UInt64>("term"),
+                             parsed.value()->getValue<bool>("accepted")};
+}
+
+core::Result<FetchResponse> HttpReplicaTransport::Fetch(const std::string& leader,
+                                                        const FetchRequest& request) {
+    std::string follower_enc;
+    Poco::URI::encode(request.follower, "", follower_enc);
+    const auto url = leader + "/internal/v1/replication/entries?term=" +
+                     std::to_string(request.term) + "&follower=" + follower_enc +
+                     "&after=" + std::to_string(request.after) +
+                     "&after_term=" + std::to_string(request.after_term) +
+                     "&wait_ms=" + std::to_string(request.wait_ms);
+    auto call = distributed::SendHttpRequest("GET", url, "", "", service_auth_token_, {},
+                                             timeout_ms_ + request.wait_ms);
+    if (!call.ok()) {
+        return call.error();
+    }
+    if (call.value().status != 200) {
+        return core::Error{core::ErrorCode::kUnavailable,
+                           "replication fetch failed: " + call.value().body};
+    }
+    return DecodeFetchResponse(call.value().body);
+}
+
+std::string EncodeFetchResponse(const FetchResponse& response) {
+    core::ByteWriter writer;
+    writer.PutU8(static_cast<std::uint8_t>(response.status));
+    writer.PutU64(response.term);
+    writer.PutString(response.leader);
+    writer.PutU64(response.commit_index);
+    writer.PutU64(response.last_index);
+    writer.PutU32(static_cast<std::uint32_t>(response.entries.size()));
+    for (const auto& entry : response.entries) {
+        writer.PutU64(entry.index);
+        writer.PutU64(entry.term);
+        writer.PutString(entry.payload);
+    }
+    return writer.Take();
+}
+
+core::Result<FetchResponse> DecodeFetchResponse(std::string_view body) {
+    // Each entry takes at least 20 bytes (index, term, payload length); bounding `count` by the
+    // body size keeps a corrupt header from forcing a huge allocation.
+    core::ByteReader reader(body);
+    FetchResponse response;
+    std::uint8_t status = 0;
+    std::uint32_t count = 0;
+    if (!reader.GetU8(status) || status > static_cast<std::uint8_t>(FetchStatus::kDiverged) ||
+        !reader.GetU64(response.term) || !reader.GetString(response.leader) ||
+        !reader.GetU64(response.commit_index) || !reader.GetU64(response.last_index) ||
+        !reader.GetU32(count) || count > reader.remaining() / 20) {
+        return core::Error{core::ErrorCode::kInternal, "malformed replication fetch response"};
+    }
+    response.status = static_cast<FetchStatus>(status);
+    response.entries.resize(count);
+    for (auto& entry : response.entries) {
+        if (!reader.GetU64(entry.index) || !reader.GetU64(entry.term) ||
+            !reader.GetString(entry.payload)) {
+            return core::Error{core::ErrorCode::kInternal,
+                               "malformed replication fetch response"};
+        }
+    }
+    return response;
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,1785 @@
+#include "nebulafs/metadata/memory_metadata_store.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/core/logger.h"
+#include "nebulafs/core/time.h"
+#include "nebulafs/distributed/placement_token.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/metadata/object_listing.h"
+#include "nebulafs/storage/local_storage.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Records are logical redo entries holding the final row values (ids and timestamps already
+// assigned), so replaying one is idempotent and matches what the live write applied.
+enum class RecordType : std::uint8_t {
+    kPutBucket = 1,
+    kPutObject = 2,
+    kDeleteObject = 3,
+    kPutUpload = 4,
+    kDeleteUpload = 5,
+    kPutPart = 6,
+    kDeleteParts = 7,
+    kSetStorageNodes = 8,
+    kCounters = 9,
+    // A metadata batch: nested records that recovery applies all together or not at all.
+    kBatch = 10,
+    kPutLease = 11,
+};
+
+constexpr std::string_view kSnapshotMagic = "NFSMEM01";
+// Frame: u32 payload size, u32 CRC-32C over lsn + payload, u64 lsn, payload.
+constexpr std::size_t kFrameHeaderBytes = 16;
+constexpr std::uint32_t kMaxRecordBytes = 64u * 1024 * 1024;
+// Entries copied per shared-lock hold while writing a snapshot.
+constexpr std::size_t kSnapshotChunkEntries = 4096;
+
+core::Error IoError(const std::string& message) {
+    return core::Error{core::ErrorCode::kIoError, message};
+}
+
+// Big-endian bucket id keeps each bucket's objects contiguous and in name order.
+std::uint64_t PartBytes(const std::map<int, MultipartPart>& parts) {
+    std::uint64_t bytes = 0;
+    for (const auto& [part_number, part] : parts) {
+        bytes += part.size_bytes;
+    }
+    return bytes;
+}
+
+std::string ObjectKey(int bucket_id, std::string_view name) {
+    const auto id = static_cast<std::uint32_t>(bucket_id);
+    std::string key;
+    key.reserve(4 + name.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        key.push_back(static_cast<char>((id >> shift) & 0xff));
+    }
+    key.append(name);
+    return key;
+}
+
+void AppendFrame(std::string& out, std::uint64_t lsn, std::string_view payload) {
+    core::ByteWriter lsn_bytes;
+    lsn_bytes.PutU64(lsn);
+    core::ByteWriter header;
+    header.PutU32(static_cast<std::uint32_t>(payload.size()));
+    header.PutU32(core::Crc32c(payload, core::Crc32c(lsn_bytes.data())));
+    out.append(header.data());
+    out.append(lsn_bytes.data());
+    out.append(payload);
+}
+
+// Returns false at end of input and on a torn or corrupt frame.
+bool ReadFrame(std::istream& in, std::uint64_t& lsn, std::string& payload) {
+    char header[kFrameHeaderBytes];
+    if (!in.read(header, kFrameHeaderBytes)) {
+        return false;
+    }
+    core::ByteReader reader(std::string_view(header, kFrameHeaderBytes));
+    std::uint32_t size = 0;
+    std::uint32_t crc = 0;
+    reader.GetU32(size);
+    reader.GetU32(crc);
+    reader.GetU64(lsn);
+    if (size > kMaxRecordBytes) {
+        return false;
+    }
+    payload.resize(size);
+    if (!in.read(payload.data(), size)) {
+        return false;
+    }
+    return core::Crc32c(payload, core::Crc32c(std::string_view(header + 8, 8))) == crc;
+}
+
+int OpenForAppend(const std::string& path, bool truncate) {
+#ifdef _WIN32
+    int flags = _O_WRONLY | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : _O_APPEND);
+    return ::_open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int flags = O_WRONLY | O_CREAT | (truncate ? O_TRUNC : O_APPEND);
+    return ::open(path.c_str(), flags, 0644);
+#endif
+}
+
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+#ifdef _WIN32
+        const auto written = ::_write(fd, data.data(), static_cast<unsigned int>(data.size()));
+#else
+        const auto written = ::write(fd, data.data(), data.size());
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+bool SyncFile(int fd) {
+#ifdef _WIN32
+    return ::_commit(fd) == 0;
+#elif defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+void CloseFile(int fd) {
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Makes a rename durable; Windows has no directory handles to sync.
+void SyncDirectory(const std::string& directory) {
+#ifndef _WIN32
+    const int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)directory;
+#endif
+}
+
+void EncodeBucket(core::ByteWriter& record, const Bucket& bucket) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kPutBucket));
+    record.PutU32(static_cast<std::uint32_t>(bucket.id));
+    record.PutString(bucket.name);
+    record.PutString(bucket.created_at);
+}
+
+bool DecodeBucket(core::ByteReader& reader, Bucket& bucket) {
+    std::uint32_t id = 0;
+    if (!reader.GetU32(id) || !reader.GetString(bucket.name) ||
+        !reader.GetString(bucket.created_at)) {
+        return false;
+    }
+    bucket.id = static_cast<int>(id);
+    return true;
+}
+
+void PutNodeRefs(core::ByteWriter& record, const std::vector<ReplicaTarget>& replicas) {
+    record.PutU32(static_cast<std::uint32_t>(replicas.size()));
+    for (const auto& replica : replicas) {
+        record.PutU32(static_cast<std::uint32_t>(replica.node_id));
+        record.PutU32(static_cast<std::uint32_t>(replica.replica_index));
+    }
+}
+
+bool GetNodeRefs(core::ByteReader& reader, std::vector<ReplicaTarget>& replicas) {
+    std::uint32_t count = 0;
+    if (!reader.GetU32(count)) {
+        return false;
+    }
+    replicas.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint32_t node_id = 0;
+        std::uint32_t replica_index = 0;
+        if (!reader.GetU32(node_id) || !reader.GetU32(replica_index)) {
+            return false;
+        }
+        replicas.push_back(
+            ReplicaTarget{static_cast<int>(node_id), static_cast<int>(replica_index), ""});
+    }
+    return true;
+}
+
+// Segments and then the inline body trail the replica list, so object records written before
+// either existed still decode.
+void EncodeObject(core::ByteWriter& record, const ObjectMetadata& meta, const std::string& blob_id,
+                  const std::vector<ReplicaTarget>& replicas,
+                  const std::vector<ManifestSegment>& segments,
+                  const std::optional<std::string>& inline_data) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kPutObject));
+    record.PutU32(static_cast<std::uint32_t>(meta.id));
+    record.PutU32(static_cast<std::uint32_t>(meta.bucket_id));
+    record.PutString(meta.name);
+    record.PutU64(meta.size_bytes);
+    record.PutString(meta.etag);
+    record.PutString(meta.created_at);
+    record.PutString(meta.updated_at);
+    record.PutString(blob_id);
+    PutNodeRefs(record, replicas);
+    record.PutU32(static_cast<std::uint32_t>(segments.size()));
+    for (const auto& segment : segments) {
+        record.PutString(segment.blob_id);
+        record.PutU64(segment.offset);
+        record.PutU64(segment.size_bytes);
+        record.PutString(segment.etag);
+        PutNodeRefs(record, segment.replicas);
+    }
+    record.PutU8(inline_data ? 1 : 0);
+    if (inline_data) {
+        record.PutString(*inline_data);
+    }
+}
+
+bool DecodeObject(core::ByteReader& reader, ObjectMetadata& meta, std::string& blob_id,
+                  std::vector<ReplicaTarget>& replicas, std::vector<ManifestSegment>& segments,
+                  std::optional<std::string>& inline_data) {
+    std::uint32_t id = 0;
+    std::uint32_t bucket_id = 0;
+    if (!reader.GetU32(id) || !reader.GetU32(bucket_id) || !reader.GetString(meta.name) ||
+        !reader.GetU64(meta.size_bytes) || !reader.GetString(meta.etag) ||
+        !reader.GetString(meta.created_at) || !reader.GetString(meta.updated_at) ||
+        !reader.GetString(blob_id) || !GetNodeRefs(reader, replicas)) {
+        return false;
+    }
+    meta.id = static_cast<int>(id);
+    meta.bucket_id = static_cast<int>(bucket_id);
+    segments.clear();
+    inline_data.reset();
+    if (reader.AtEnd()) {
+        return true;
+    }
+    std::uint32_t segment_count = 0;
+    if (!reader.GetU32(segment_count)) {
+        return false;
+    }
+    segments.resize(segment_count);
+    for (auto& segment : segments) {
+        if (!reader.GetString(segment.blob_id) || !reader.GetU64(segment.offset) ||
+            !reader.GetU64(segment.size_bytes) || !reader.GetString(segment.etag) ||
+            !GetNodeRefs(reader, segment.replicas)) {
+            return false;
+        }
+    }
+    if (reader.AtEnd()) {
+        return true;
+    }
+    std::uint8_t has_inline = 0;
+    if (!reader.GetU8(has_inline)) {
+        return false;
+    }
+    if (has_inline != 0) {
+        inline_data.emplace();
+        return reader.GetString(*inline_data);
+    }
+    return true;
+}
+
+void EncodeUpload(core::ByteWriter& record, const MultipartUpload& upload) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kPutUpload));
+    record.PutU32(static_cast<std::uint32_t>(upload.id));
+    record.PutString(upload.upload_id);
+    record.PutU32(static_cast<std::uint32_t>(upload.bucket_id));
+    record.PutString(upload.object_name);
+    record.PutString(upload.state);
+    record.PutString(upload.expires_at);
+    record.PutString(upload.created_at);
+    record.PutString(upload.updated_at);
+    record.PutU64(upload.part_size);
+}
+
+bool DecodeUpload(core::ByteReader& reader, MultipartUpload& upload) {
+    std::uint32_t id = 0;
+    std::uint32_t bucket_id = 0;
+    if (!reader.GetU32(id) || !reader.GetString(upload.upload_id) || !reader.GetU32(bucket_id) ||
+        !reader.GetString(upload.object_name) || !reader.GetString(upload.state) ||
+        !reader.GetString(upload.expires_at) || !reader.GetString(upload.created_at) ||
+        !reader.GetString(upload.updated_at)) {
+        return false;
+    }
+    // Records written before part sizes existed end here.
+    if (!reader.AtEnd() && !reader.GetU64(upload.part_size)) {
+        return false;
+    }
+    upload.id = static_cast<int>(id);
+    upload.bucket_id = static_cast<int>(bucket_id);
+    return true;
+}
+
+void EncodePart(core::ByteWriter& record, const MultipartPart& part) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kPutPart));
+    record.PutU32(static_cast<std::uint32_t>(part.id));
+    record.PutString(part.upload_id);
+    record.PutU32(static_cast<std::uint32_t>(part.part_number));
+    record.PutU64(part.size_bytes);
+    record.PutString(part.etag);
+    record.PutString(part.temp_path);
+    record.PutString(part.created_at);
+}
+
+bool DecodePart(core::ByteReader& reader, MultipartPart& part) {
+    std::uint32_t id = 0;
+    std::uint32_t part_number = 0;
+    if (!reader.GetU32(id) || !reader.GetString(part.upload_id) || !reader.GetU32(part_number) ||
+        !reader.GetU64(part.size_bytes) || !reader.GetString(part.etag) ||
+        !reader.GetString(part.temp_path) || !reader.GetString(part.created_at)) {
+        return false;
+    }
+    part.id = static_cast<int>(id);
+    part.part_number = static_cast<int>(part_number);
+    return true;
+}
+
+void EncodeStorageNodes(core::ByteWriter& record, const std::vector<StorageNodeRecord>& nodes) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kSetStorageNodes));
+    record.PutU32(static_cast<std::uint32_t>(nodes.size()));
+    for (const auto& node : nodes) {
+        record.PutU32(static_cast<std::uint32_t>(node.id));
+        record.PutString(node.endpoint);
+        record.PutString(node.status);
+    }
+}
+
+void EncodeLease(core::ByteWriter& record, const Lease& lease) {
+    record.PutU8(static_cast<std::uint8_t>(RecordType::kPutLease));
+    record.PutString(lease.name);
+    record.PutString(lease.holder);
+    record.PutU64(lease.fencing_token);
+    record.PutU64(lease.expires_at_ms);
+}
+
+bool DecodeLease(core::ByteReader& reader, Lease& lease) {
+    return reader.GetString(lease.name) && reader.GetString(lease.holder) &&
+           reader.GetU64(lease.fencing_token) && reader.GetU64(lease.expires_at_ms);
+}
+
+void EncodeKeyed(core::ByteWriter& record, RecordType type, std::string_view key) {
+    record.PutU8(static_cast<std::uint8_t>(type));
+    record.PutString(key);
+}
+
+}  // namespace
+
+MemoryMetadataStore::MemoryMetadataStore(const std::string& directory,
+                                         std::uint64_t snapshot_wal_bytes)
+    : directory_(directory), snapshot_wal_bytes_(snapshot_wal_bytes) {
+    Recover();
+    snapshot_thread_ = std::thread([this] { SnapshotLoop(); });
+}
+
+MemoryMetadataStore::~MemoryMetadataStore() {
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        stopping_ = true;
+    }
+    snapshot_cv_.notify_one();
+    if (snapshot_thread_.joinable()) {
+        snapshot_thread_.join();
+    }
+    if (wal_fd_ >= 0) {
+        CloseFile(wal_fd_);
+    }
+}
+
+void MemoryMetadataStore::Recover() {
+    std::filesystem::create_directories(directory_);
+    const auto snapshot_path = std::filesystem::path(directory_) / "snapshot";
+    const auto wal_path = std::filesystem::path(directory_) / "wal";
+
+    std::uint64_t snapshot_lsn = 0;
+    std::uint64_t lsn = 0;
+    std::string payload;
+    if (std::filesystem::exists(snapshot_path)) {
+        // Snapshots are renamed into place only once complete, so any damage here is real
+        // corruption rather than a torn write.
+        std::ifstream in(snapshot_path, std::ios::binary);
+        std::string magic(kSnapshotMagic.size(), '\0');
+        bool complete = false;
+        if (in.read(magic.data(), static_cast<std::streamsize>(magic.size())) &&
+            magic == kSnapshotMagic) {
+            while (ReadFrame(in, lsn, payload)) {
+                snapshot_lsn = lsn;
+                if (!ApplyRecord(payload)) {
+                    break;
+                }
+                complete = static_cast<RecordType>(payload[0]) == RecordType::kCounters;
+            }
+        }
+        if (!complete) {
+            throw std::runtime_error("metadata snapshot is corrupt: " + snapshot_path.string());
+        }
+    }
+
+    std::uint64_t last_lsn = snapshot_lsn;
+    std::uint64_t valid_bytes = 0;
+    if (std::filesystem::exists(wal_path)) {
+        std::ifstream in(wal_path, std::ios::binary);
+        while (ReadFrame(in, lsn, payload)) {
+            // Records up to the snapshot's LSN are already in it; they survive here only if a
+            // crash came before the log was cut.
+            if (lsn > snapshot_lsn && !ApplyRecord(payload)) {
+                throw std::runtime_error("metadata WAL record is malformed: " + wal_path.string());
+            }
+            last_lsn = std::max(last_lsn, lsn);
+            valid_bytes += kFrameHeaderBytes + payload.size();
+        }
+        in.close();
+        // A torn final frame is an unacknowledged write; drop it so appends start clean.
+        if (std::filesystem::file_size(wal_path) != valid_bytes) {
+            std::filesystem::resize_file(wal_path, valid_bytes);
+        }
+    }
+
+    appended_lsn_ = last_lsn;
+    durable_lsn_ = last_lsn;
+    wal_bytes_ = valid_bytes;
+    wal_fd_ = OpenForAppend(wal_path.string(), false);
+    if (wal_fd_ < 0) {
+        throw std::runtime_error("failed to open metadata WAL: " + wal_path.string());
+    }
+}
+
+bool MemoryMetadataStore::ApplyRecord(std::string_view payload) {
+    core::ByteReader reader(payload);
+    std::uint8_t type = 0;
+    if (!reader.GetU8(type)) {
+        return false;
+    }
+    switch (static_cast<RecordType>(type)) {
+        case RecordType::kPutBucket: {
+            Bucket bucket;
+            if (!DecodeBucket(reader, bucket)) {
+                return false;
+            }
+            next_bucket_id_ = std::max(next_bucket_id_, bucket.id + 1);
+            stats_.try_emplace(bucket.id);
+            *buckets_.Emplace(bucket.name).first = std::move(bucket);
+            break;
+        }
+        case RecordType::kPutObject: {
+            ObjectEntry entry;
+            if (!DecodeObject(reader, entry.meta, entry.blob_id, entry.replicas, entry.segments,
+                              entry.inline_data)) {
+                return false;
+            }
+            next_object_id_ = std::max(next_object_id_, entry.meta.id + 1);
+            const auto key = ObjectKey(entry.meta.bucket_id, entry.meta.name);
+            auto& stats = stats_[entry.meta.bucket_id];
+            if (const auto* old = objects_.Find(key)) {
+                --stats.object_count;
+                stats.total_bytes -= old->meta.size_bytes;
+                CountBlobs(*old, -1);
+            }
+            ++stats.object_count;
+            stats.total_bytes += entry.meta.size_bytes;
+            CountBlobs(entry, 1);
+            *objects_.Emplace(key).first = std::move(entry);
+            break;
+        }
+        case RecordType::kDeleteObject: {
+            std::string_view key;
+            if (!reader.GetView(key)) {
+                return false;
+            }
+            if (const auto* old = objects_.Find(key)) {
+                auto& stats = stats_[old->meta.bucket_id];
+                --stats.object_count;
+                stats.total_bytes -= old->meta.size_bytes;
+                CountBlobs(*old, -1);
+            }
+            objects_.Erase(key);
+            break;
+        }
+        case RecordType::kPutUpload: {
+            MultipartUpload upload;
+            if (!DecodeUpload(reader, upload)) {
+                return false;
+            }
+            next_upload_id_ = std::max(next_upload_id_, upload.id + 1);
+            auto& entry = uploads_[upload.upload_id];
+            entry.upload = std::move(upload);
+            break;
+        }
+        case RecordType::kDeleteUpload: {
+            std::string upload_id;
+            if (!reader.GetString(upload_id)) {
+                return false;
+            }
+            if (auto it = uploads_.find(upload_id); it != uploads_.end()) {
+                stats_[it->second.upload.bucket_id].multipart_bytes -= PartBytes(it->second.parts);
+                uploads_.erase(it);
+            }
+            break;
+        }
+        case RecordType::kPutPart: {
+            MultipartPart part;
+            if (!DecodePart(reader, part)) {
+                return false;
+            }
+            next_part_id_ = std::max(next_part_id_, part.id + 1);
+            auto it = uploads_.find(part.upload_id);
+            if (it != uploads_.end()) {
+                auto& stats = stats_[it->second.upload.bucket_id];
+                auto& slot = it->second.parts[part.part_number];
+                stats.multipart_bytes = stats.multipart_bytes - slot.size_bytes + part.size_bytes;
+                slot = std::move(part);
+            }
+            break;
+        }
+        case RecordType::kDeleteParts: {
+            std::string upload_id;
+            if (!reader.GetString(upload_id)) {
+                return false;
+            }
+            auto it = uploads_.find(upload_id);
+            if (it != uploads_.end()) {
+                stats_[it->second.upload.bucket_id].multipart_bytes -= PartBytes(it->second.parts);
+                it->second.parts.clear();
+            }
+            break;
+        }
+        case RecordType::kSetStorageNodes: {
+            std::uint32_t count = 0;
+            if (!reader.GetU32(count)) {
+                return false;
+            }
+            std::vector<StorageNodeRecord> nodes;
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::uint32_t id = 0;
+                StorageNodeRecord node;
+                if (!reader.GetU32(id) || !reader.GetString(node.endpoint) ||
+                    !reader.GetString(node.status)) {
+                    return false;
+                }
+                node.id = static_cast<int>(id);
+                next_node_id_ = std::max(next_node_id_, node.id + 1);
+                nodes.push_back(std::move(node));
+            }
+            nodes_ = std::move(nodes);
+            break;
+        }
+        case RecordType::kCounters: {
+            std::uint32_t counters[5] = {};
+            for (auto& counter : counters) {
+                if (!reader.GetU32(counter)) {
+                    return false;
+                }
+            }
+            next_bucket_id_ = std::max(next_bucket_id_, static_cast<int>(counters[0]));
+            next_object_id_ = std::max(next_object_id_, static_cast<int>(counters[1]));
+            next_upload_id_ = std::max(next_upload_id_, static_cast<int>(counters[2]));
+            next_part_id_ = std::max(next_part_id_, static_cast<int>(counters[3]));
+            next_node_id_ = std::max(next_node_id_, static_cast<int>(counters[4]));
+            break;
+        }
+        case RecordType::kPutLease: {
+            Lease lease;
+            if (!DecodeLease(reader, lease)) {
+                return false;
+            }
+            auto name = lease.name;
+            leases_[std::move(name)] = std::move(lease);
+            break;
+        }
+        case RecordType::kBatch: {
+            std::uint32_t count = 0;
+            if (!reader.GetU32(count)) {
+                return false;
+            }
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::string_view nested;
+                if (!reader.GetView(nested) || nested.empty() ||
+                    static_cast<RecordType>(nested[0]) == RecordType::kBatch ||
+                    !ApplyRecord(nested)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    return reader.AtEnd();
+}
+
+std::uint64_t MemoryMetadataStore::Commit(const core::ByteWriter& record) {
+    ApplyRecord(record.data());
+    return AppendToWal(record.data());
+}
+
+std::uint64_t MemoryMetadataStore::AppendToWal(std::string_view record) {
+    std::lock_guard<std::mutex> lock(wal_mutex_);
+    const auto lsn = ++appended_lsn_;
+    AppendFrame(pending_, lsn, record);
+    return lsn;
+}
+
+core::Result<void> MemoryMetadataStore::WaitDurable(std::uint64_t lsn) {
+    bool snapshot_due = false;
+    {
+        std::unique_lock<std::mutex> lock(wal_mutex_);
+        while (durable_lsn_ < lsn && !wal_failed_) {
+            if (flushing_) {
+                wal_cv_.wait(lock);
+                continue;
+            }
+            // Lead the next group commit: one write and one fsync cover every record appended
+            // so far, including those of callers now waiting behind this one.
+            flushing_ = true;
+            std::string batch;
+            batch.swap(pending_);
+            const auto batch_lsn = appended_lsn_;
+            lock.unlock();
+            const bool ok = WriteAll(wal_fd_, batch) && SyncFile(wal_fd_);
+            lock.lock();
+            flushing_ = false;
+            if (ok) {
+                durable_lsn_ = std::max(durable_lsn_, batch_lsn);
+                wal_bytes_ += batch.size();
+            } else {
+                // The in-memory state is now ahead of the log; refuse further writes rather
+                // than acknowledge records that may never reach disk.
+                wal_failed_ = true;
+                core::LogError("metadata WAL write failed in " + directory_);
+            }
+            wal_cv_.notify_all();
+        }
+        if (durable_lsn_ < lsn) {
+            return IoError("metadata WAL is unavailable");
+        }
+        snapshot_due = wal_bytes_ >= snapshot_wal_bytes_;
+    }
+    if (snapshot_due) {
+        {
+            std::lock_guard<std::mutex> lock(snapshot_mutex_);
+            snapshot_requested_ = true;
+        }
+        snapshot_cv_.notify_one();
+    }
+    return core::Ok();
+}
+
+core::Result<void> MemoryMetadataStore::WaitReadable() {
+    std::uint64_t applied = 0;
+    {
+        std::lock_guard<std::mutex> lock(wal_mutex_);
+        if (wal_failed_) {
+            return IoError("metadata WAL is unavailable");
+        }
+        if (durable_lsn_ >= appended_lsn_) {
+            return core::Ok();
+        }
+        applied = appended_lsn_;
+    }
+    // The shared lock keeps further writes out while this waits, so at most the records
+    // already in flight are waited for.
+    return WaitDurable(applied);
+}
+
+core::Result<void> MemoryMetadataStore::Checkpoint() { return WriteSnapshot(); }
+
+core::Result<void> MemoryMetadataStore::WriteSnapshot() {
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+    const auto wal_path = (std::filesystem::path(directory_) / "wal").string();
+    const auto tmp_path = (std::filesystem::path(directory_) / "snapshot.tmp").string();
+    const int fd = OpenForAppend(tmp_path, true);
+    if (fd < 0) {
+        return IoError("failed to create metadata snapshot");
+    }
+    // The image is taken a chunk at a time so writers run in between. It may then hold
+    // records past `snapshot_lsn`; recovery replays the WAL after that LSN over it, which is
+    // safe because records are idempotent row images.
+    std::uint64_t snapshot_lsn = 0;
+    std::uint64_t tail_offset = 0;
+    std::string buffer(kSnapshotMagic);
+    core::ByteWriter record;
+    bool ok = true;
+    auto frame = [&] {
+        AppendFrame(buffer, snapshot_lsn, record.data());
+        record.Clear();
+    };
+    auto flush = [&] {
+        ok = ok && WriteAll(fd, buffer);
+        buffer.clear();
+    };
+    {
+        std::shared_lock<std::shared_mutex> state_lock(state_mutex_);
+        {
+            std::unique_lock<std::mutex> lock(wal_mutex_);
+            // Frames reach the file in LSN order, so once the pending ones are written the
+            // records after `snapshot_lsn` start at `tail_offset`.
+            wal_cv_.wait(lock, [this] { return !flushing_; });
+            if (wal_failed_) {
+                CloseFile(fd);
+                return IoError("metadata WAL is unavailable");
+            }
+            snapshot_lsn = appended_lsn_;
+            tail_offset = wal_bytes_ + pending_.size();
+        }
+        // Uploads, leases and nodes are few next to objects and go in one step.
+        EncodeStorageNodes(record, nodes_);
+        frame();
+        for (const auto& [upload_id, entry] : uploads_) {
+            EncodeUpload(record, entry.upload);
+            frame();
+            for (const auto& [part_number, part] : entry.parts) {
+                EncodePart(record, part);
+                frame();
+            }
+        }
+        for (const auto& [name, lease] : leases_) {
+            EncodeLease(record, lease);
+            frame();
+        }
+    }
+    flush();
+    // Buckets go before objects so recovery counts each object against its bucket.
+    auto copy_index = [&](auto& index, const auto& encode) {
+        std::string next;
+        for (bool more = true; more && ok;) {
+            {
+                std::shared_lock<std::shared_mutex> state_lock(state_mutex_);
+                auto it = next.empty() ? index.Begin() : index.LowerBound(next);
+                for (std::size_t n = 0; it.Valid() && n < kSnapshotChunkEntries; it.Next(), ++n) {
+                    encode(it.value());
+                    frame();
+                    // The smallest key after this one.
+                    next = it.key() + '\0';
+                }
+                more = it.Valid();
+            }
+            flush();
+        }
+    };
+    copy_index(buckets_, [&](const Bucket& bucket) { EncodeBucket(record, bucket); });
+    copy_index(objects_, [&](const ObjectEntry& entry) {
+        EncodeObject(record, entry.meta, entry.blob_id, entry.replicas, entry.segments,
+                     entry.inline_data);
+    });
+    {
+        // Counters go last and double as the end marker that recovery checks for. They only
+        // grow, so these cover every id in the image.
+        std::shared_lock<std::shared_mutex> state_lock(state_mutex_);
+        record.PutU8(static_cast<std::uint8_t>(RecordType::kCounters));
+        for (int next : {next_bucket_id_, next_object_id_, next_upload_id_, next_part_id_,
+                         next_node_id_}) {
+            record.PutU32(static_cast<std::uint32_t>(next));
+        }
+    }
+    frame();
+    flush();
+    ok = ok && SyncFile(fd);
+    CloseFile(fd);
+    if (!ok) {
+        std::filesystem::remove(tmp_path);
+        return IoError("failed to write metadata snapshot");
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, std::filesystem::path(directory_) / "snapshot", ec);
+    if (ec) {
+        return IoError("failed to install metadata snapshot: " + ec.message());
+    }
+    SyncDirectory(directory_);
+
+    // Only the records written since `snapshot_lsn` stay in the log. They are copied to a new
+    // file while no flush runs; appends meanwhile wait in `pending_`.
+    std::unique_lock<std::mutex> lock(wal_mutex_);
+    wal_cv_.wait(lock, [this] { return !flushing_; });
+    durable_lsn_ = std::max(durable_lsn_, snapshot_lsn);
+    if (wal_failed_ || wal_bytes_ < tail_offset) {
+        return IoError("metadata WAL is unavailable");
+    }
+    std::string tail(wal_bytes_ - tail_offset, '\0');
+    {
+        std::ifstream in(wal_path, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(tail_offset));
+        if (!in.read(tail.data(), static_cast<std::streamsize>(tail.size()))) {
+            return IoError("failed to read metadata WAL tail");
+        }
+    }
+    const auto wal_tmp_path = wal_path + ".tmp";
+    const int tail_fd = OpenForAppend(wal_tmp_path, true);
+    if (tail_fd < 0) {
+        return IoError("failed to create metadata WAL");
+    }
+    ok = WriteAll(tail_fd, tail) && SyncFile(tail_fd);
+    CloseFile(tail_fd);
+    // Windows cannot replace a file that is still open, so the log is closed across the swap.
+    CloseFile(wal_fd_);
+    if (ok) {
+        std::filesystem::rename(wal_tmp_path, wal_path, ec);
+        ok = !ec;
+    }
+    wal_fd_ = OpenForAppend(wal_path, false);
+    if (wal_fd_ < 0) {
+        wal_failed_ = true;
+        core::LogError("metadata WAL could not be reopened in " + directory_);
+        return IoError("metadata WAL is unavailable");
+    }
+    if (!ok) {
+        // The old log stays valid: recovery skips its records up to `snapshot_lsn`.
+        std::filesystem::remove(wal_tmp_path, ec);
+        return IoError("failed to truncate metadata WAL");
+    }
+    SyncDirectory(directory_);
+    wal_bytes_ = tail.size();
+    wal_cv_.notify_all();
+    return core::Ok();
+}
+
+void MemoryMetadataStore::SnapshotLoop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(snapshot_mutex_);
+            snapshot_cv_.wait(lock, [this] { return stopping_ || snapshot_requested_; });
+            if (stopping_) {
+                return;
+            }
+            snapshot_requested_ = false;
+        }
+        auto result = WriteSnapshot();
+        if (!result.ok()) {
+            core::LogError("metadata snapshot failed: " + result.error().message);
+        }
+    }
+}
+
+core::Result<Bucket> MemoryMetadataStore::CreateBucket(const std::string& name) {
+    Bucket bucket;
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        if (buckets_.Find(name) != nullptr) {
+            return core::Error{core::ErrorCode::kAlreadyExists, "bucket already exists"};
+        }
+        bucket = Bucket{next_bucket_id_, name, core::NowIso8601()};
+        core::ByteWriter record;
+        EncodeBucket(record, bucket);
+        lsn = Commit(record);
+    }
+    auto durable = WaitDurable(lsn);
+    if (!durable.ok()) {
+        return durable.error();
+    }
+    return bucket;
+}
+
+core::Result<std::vector<Bucket>> MemoryMetadataStore::ListBuckets() {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    std::vector<Bucket> buckets;
+    buckets.reserve(buckets_.size());
+    for (auto it = buckets_.Begin(); it.Valid(); it.Next()) {
+        buckets.push_back(it.value());
+    }
+    return buckets;
+}
+
+core::Result<Bucket> MemoryMetadataStore::GetBucket(const std::string& name) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    const auto* bucket = buckets_.Find(name);
+    if (bucket == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    return *bucket;
+}
+
+core::Result<ObjectMetadata> MemoryMetadataStore::UpsertObject(const std::string& bucket,
+                                                               const ObjectMetadata& object) {
+    ObjectMetadata meta;
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        const auto* owner = buckets_.Find(bucket);
+        if (owner == nullptr) {
+            return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+        }
+        const auto now_time = core::NowIso8601();
+        const auto* existing = objects_.Find(ObjectKey(owner->id, object.name));
+        meta.id = existing != nullptr ? existing->meta.id : next_object_id_;
+        meta.bucket_id = owner->id;
+        meta.name = object.name;
+        meta.size_bytes = object.size_bytes;
+        meta.etag = object.etag;
+        meta.created_at = existing != nullptr ? existing->meta.created_at : now_time;
+        meta.updated_at = now_time;
+        // Like the SQLite upsert, rewriting an object keeps its replica placement and replaces
+        // its inline body.
+        core::ByteWriter record;
+        EncodeObject(record, meta, existing != nullptr ? existing->blob_id : std::string(),
+                     existing != nullptr ? existing->replicas : std::vector<ReplicaTarget>(),
+                     existing != nullptr ? existing->segments : std::vector<ManifestSegment>(),
+                     object.inline_data);
+        lsn = Commit(record);
+    }
+    auto durable = WaitDurable(lsn);
+    if (!durable.ok()) {
+        return durable.error();
+    }
+    return meta;
+}
+
+core::Result<ObjectMetadata> MemoryMetadataStore::GetObject(const std::string& bucket,
+                                                            const std::string& object) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    const auto* owner = buckets_.Find(bucket);
+    const auto* entry = owner != nullptr ? objects_.Find(ObjectKey(owner->id, object)) : nullptr;
+    if (entry == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    auto meta = entry->meta;
+    meta.inline_data = entry->inline_data;
+    return meta;
+}
+
+core::Result<std::vector<ObjectMetadata>> MemoryMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    std::vector<ObjectMetadata> objects;
+    const auto* owner = buckets_.Find(bucket);
+    if (owner == nullptr) {
+        return objects;
+    }
+    const auto start = ObjectKey(owner->id, prefix);
+    const auto end = PrefixUpperBound(start);
+    for (auto it = objects_.LowerBound(start); it.Valid() && (end.empty() || it.key() < end);
+         it.Next()) {
+        objects.push_back(it.value().meta);
+    }
+    return objects;
+}
+
+core::Result<ObjectListing> MemoryMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    const auto* owner = buckets_.Find(bucket);
+    if (owner == nullptr) {
+        return ObjectListing{};
+    }
+    const int bucket_id = owner->id;
+    const auto bucket_end = PrefixUpperBound(ObjectKey(bucket_id, ""));
+    return BuildObjectListing(options, [&](const std::string& lower, const std::string& upper,
+                                           const auto& visit) {
+        const auto end = upper.empty() ? bucket_end : ObjectKey(bucket_id, upper);
+        for (auto it = objects_.LowerBound(ObjectKey(bucket_id, lower));
+             it.Valid() && (end.empty() || it.key() < end); it.Next()) {
+            ObjectMetadata meta = it.value().meta;
+            if (!visit(std::move(meta))) {
+                return;
+            }
+        }
+    });
+}
+
+core::Result<void> MemoryMetadataStore::DeleteObject(const std::string& bucket,
+                                                     const std::string& object) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        const auto* owner = buckets_.Find(bucket);
+        if (owner == nullptr) {
+            return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+        }
+        const auto key = ObjectKey(owner->id, object);
+        if (objects_.Find(key) == nullptr) {
+            return core::Ok();
+        }
+        core::ByteWriter record;
+        EncodeKeyed(record, RecordType::kDeleteObject, key);
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<MultipartUpload> MemoryMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    MultipartUpload upload;
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        core::ByteWriter record;
+        auto built = BuildUploadRecord(bucket, upload_id, object_name, expires_at, record);
+        if (!built.ok()) {
+            return built.error();
+        }
+        upload = std::move(built.value());
+        lsn = Commit(record);
+    }
+    auto durable = WaitDurable(lsn);
+    if (!durable.ok()) {
+        return durable.error();
+    }
+    return upload;
+}
+
+core::Result<MultipartUpload> MemoryMetadataStore::GetMultipartUpload(
+    const std::string& upload_id) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    auto it = uploads_.find(upload_id);
+    if (it == uploads_.end()) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+    }
+    return it->second.upload;
+}
+
+core::Result<std::vector<MultipartUpload>> MemoryMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    std::vector<MultipartUpload> uploads;
+    for (const auto& [upload_id, entry] : uploads_) {
+        const auto& upload = entry.upload;
+        if ((upload.state == "initiated" || upload.state == "uploading" ||
+             upload.state == "expired") &&
+            upload.expires_at < expires_before) {
+            uploads.push_back(upload);
+        }
+    }
+    const auto keep = std::min(uploads.size(), static_cast<std::size_t>(std::max(0, limit)));
+    std::partial_sort(uploads.begin(), uploads.begin() + static_cast<std::ptrdiff_t>(keep),
+                      uploads.end(), [](const MultipartUpload& a, const MultipartUpload& b) {
+                          return a.expires_at < b.expires_at;
+                      });
+    uploads.resize(keep);
+    return uploads;
+}
+
+core::Result<void> MemoryMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
+                                                                   const std::string& state) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        core::ByteWriter record;
+        auto built = BuildUploadStateRecord(upload_id, state, record);
+        if (!built.ok()) {
+            return built;
+        }
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<void> MemoryMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        if (uploads_.count(upload_id) == 0) {
+            return core::Ok();
+        }
+        core::ByteWriter record;
+        EncodeKeyed(record, RecordType::kDeleteUpload, upload_id);
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<MultipartPart> MemoryMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes, const std::string& etag,
+    const std::string& temp_path) {
+    MultipartPart part;
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        auto it = uploads_.find(upload_id);
+        if (it == uploads_.end()) {
+            return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+        }
+        auto existing = it->second.parts.find(part_number);
+        const bool found = existing != it->second.parts.end();
+        part = MultipartPart{found ? existing->second.id : next_part_id_,
+                             upload_id,
+                             part_number,
+                             size_bytes,
+                             etag,
+                             temp_path,
+                             found ? existing->second.created_at : core::NowIso8601()};
+        core::ByteWriter record;
+        EncodePart(record, part);
+        lsn = Commit(record);
+    }
+    auto durable = WaitDurable(lsn);
+    if (!durable.ok()) {
+        return durable.error();
+    }
+    return part;
+}
+
+core::Result<std::vector<MultipartPart>> MemoryMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    std::vector<MultipartPart> parts;
+    auto it = uploads_.find(upload_id);
+    if (it != uploads_.end()) {
+        parts.reserve(it->second.parts.size());
+        for (const auto& [part_number, part] : it->second.parts) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+core::Result<void> MemoryMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        auto it = uploads_.find(upload_id);
+        if (it == uploads_.end() || it->second.parts.empty()) {
+            return core::Ok();
+        }
+        core::ByteWriter record;
+        EncodeKeyed(record, RecordType::kDeleteParts, upload_id);
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<void> MemoryMetadataStore::ConfigureStorageNodes(
+    const std::vector<std::string>& endpoints) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        // Retire rather than forget nodes so replica node ids stay resolvable.
+        auto nodes = nodes_;
+        for (auto& node : nodes) {
+            node.status = "inactive";
+        }
+        int next_id = next_node_id_;
+        for (const auto& endpoint : endpoints) {
+            auto it = std::find_if(nodes.begin(), nodes.end(), [&](const StorageNodeRecord& node) {
+                return node.endpoint == endpoint;
+            });
+            if (it != nodes.end()) {
+                it->status = "active";
+            } else {
+                nodes.push_back(StorageNodeRecord{next_id++, endpoint, "active"});
+            }
+        }
+        core::ByteWriter record;
+        EncodeStorageNodes(record, nodes);
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<AllocateWritePlan> MemoryMetadataStore::AllocateWrite(
+    const std::string& bucket, const std::string& object_name, int replication_factor,
+    const std::string& service_token) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    return PlanWrite(bucket, object_name, replication_factor, service_token);
+}
+
+core::Result<void> MemoryMetadataStore::CommitWrite(const std::string& bucket,
+                                                    const std::string& object_name,
+                                                    const std::string& blob_id,
+                                                    std::uint64_t size_bytes,
+                                                    const std::string& etag,
+                                                    const std::vector<ReplicaTarget>& replicas) {
+    std::uint64_t lsn = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(state_mutex_);
+        core::ByteWriter record;
+        auto built =
+            BuildCommitRecord(bucket, object_name, blob_id, size_bytes, etag, replicas, {}, record);
+        if (!built.ok()) {
+            return built;
+        }
+        lsn = Commit(record);
+    }
+    return WaitDurable(lsn);
+}
+
+core::Result<AllocateWritePlan> MemoryMetadataStore::PlanWrite(const std::string& bucket,
+                                                               const std::string& object_name,
+                                                               int replication_factor,
+                                                               const std::string& service_token) {
+    if (!storage::LocalStorage::IsSafeName(object_name)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object name"};
+    }
+    if (buckets_.Find(bucket) == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    AllocateWritePlan plan;
+    // `nodes_` is kept in id order, matching the SQLite placement query.
+    for (const auto& node : nodes_) {
+        if (static_cast<int>(plan.replicas.size()) >= replication_factor) {
+            break;
+        }
+        if (node.status == "active") {
+            plan.replicas.push_back(
+                ReplicaTarget{node.id, static_cast<int>(plan.replicas.size()), node.endpoint});
+        }
+    }
+    if (static_cast<int>(plan.replicas.size()) < replication_factor) {
+        return core::Error{core::ErrorCode::kInternal, "insufficient active storage nodes"};
+    }
+    plan.blob_id = Poco::UUIDGenerator().createOne().toString();
+    plan.write_token = nebulafs::distributed::CreatePlacementToken(plan.blob_id, "write", 120,
+                                                                  service_token);
+    return plan;
+}
+
+core::Result<void> MemoryMetadataStore::BuildCommitRecord(
+    const std::string& bucket, const std::string& object_name, const std::string& blob_id,
+    std::uint64_t size_bytes, const std::string& etag, const std::vector<ReplicaTarget>& replicas,
+    const std::vector<ManifestSegment>& segments, core::ByteWriter& record) {
+    const auto* owner = buckets_.Find(bucket);
+    if (owner == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    // Segments name their nodes by endpoint; records keep node ids, like replica lists.
+    auto stored_segments = segments;
+    for (auto& segment : stored_segments) {
+        for (std::size_t r = 0; r < segment.replicas.size(); ++r) {
+            auto& replica = segment.replicas[r];
+            auto node =
+                std::find_if(nodes_.begin(), nodes_.end(), [&](const StorageNodeRecord& n) {
+                    return n.endpoint == replica.endpoint;
+                });
+            if (node == nodes_.end()) {
+                return core::Error{core::ErrorCode::kNotFound,
+                                   "unknown storage node " + replica.endpoint};
+            }
+            replica = ReplicaTarget{node->id, static_cast<int>(r), ""};
+        }
+    }
+    const auto now_time = core::NowIso8601();
+    const auto* existing = objects_.Find(ObjectKey(owner->id, object_name));
+    ObjectMetadata meta;
+    meta.id = existing != nullptr ? existing->meta.id : next_object_id_;
+    meta.bucket_id = owner->id;
+    meta.name = object_name;
+    meta.size_bytes = size_bytes;
+    meta.etag = etag;
+    meta.created_at = existing != nullptr ? existing->meta.created_at : now_time;
+    meta.updated_at = now_time;
+    auto sorted = replicas;
+    std::sort(sorted.begin(), sorted.end(), [](const ReplicaTarget& a, const ReplicaTarget& b) {
+        return a.replica_index < b.replica_index;
+    });
+    // One record carries the object and its replica set, so recovery never sees one without
+    // the other.
+    EncodeObject(record, meta, blob_id, sorted, stored_segments, std::nullopt);
+    return core::Ok();
+}
+
+core::Result<MultipartUpload> MemoryMetadataStore::BuildUploadRecord(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at, core::ByteWriter& record) {
+    const auto* owner = buckets_.Find(bucket);
+    if (owner == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    if (uploads_.count(upload_id) != 0) {
+        return core::Error{core::ErrorCode::kAlreadyExists, "multipart upload already exists"};
+    }
+    const auto now_time = core::NowIso8601();
+    MultipartUpload upload{next_upload_id_, upload_id,  owner->id, object_name,
+                           "initiated",     expires_at, now_time,  now_time};
+    EncodeUpload(record, upload);
+    return upload;
+}
+
+core::Result<void> MemoryMetadataStore::BuildUploadStateRecord(const std::string& upload_id,
+                                                               const std::string& state,
+                                                               core::ByteWriter& record) {
+    auto it = uploads_.find(upload_id);
+    if (it == uploads_.end()) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+    }
+    auto upload = it->second.upload;
+    upload.state = state;
+    upload.updated_at = core::NowIso8601();
+    EncodeUpload(record, upload);
+    return core::Ok();
+}
+
+BucketStats MemoryMetadataStore::CountBucket(int bucket_id) {
+    BucketStats stats;
+    const auto start = ObjectKey(bucket_id, "");
+    const auto end = PrefixUpperBound(start);
+    for (auto it = objects_.LowerBound(start); it.Valid() && (end.empty() || it.key() < end);
+         it.Next()) {
+        ++stats.object_count;
+        stats.total_bytes += it.value().meta.size_bytes;
+    }
+    for (const auto& [upload_id, entry] : uploads_) {
+        if (entry.upload.bucket_id == bucket_id) {
+            stats.multipart_bytes += PartBytes(entry.parts);
+        }
+    }
+    return stats;
+}
+
+core::Result<ResolveReadPlan> MemoryMetadataStore::ResolveRead(const std::string& bucket,
+                                                               const std::string& object_name) {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    auto readable = WaitReadable();
+    if (!readable.ok()) {
+        return readable.error();
+    }
+    const auto* owner = buckets_.Find(bucket);
+    const auto* entry =
+        owner != nullptr ? objects_.Find(ObjectKey(owner->id, object_name)) : nullptr;
+    if (entry == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    return PlanRead(*entry);
+}
+
+core::Result<ResolveReadPlan> MemoryMetadataStore::PlanRead(const ObjectEntry& entry) const {
+    auto resolve = [&](const std::vector<ReplicaTarget>& stored) {
+        std::vector<ReplicaTarget> resolved;
+        for (const auto& replica : stored) {
+            auto node =
+                std::find_if(nodes_.begin(), nodes_.end(), [&](const StorageNodeRecord& n) {
+                    return n.id == replica.node_id;
+                });
+            if (node != nodes_.end()) {
+                resolved.push_back(
+                    ReplicaTarget{replica.node_id, replica.replica_index, node->endpoint});
+            }
+        }
+        return resolved;
+    };
+    ResolveReadPlan plan;
+    plan.size_bytes = entry.meta.size_bytes;
+    plan.etag = entry.meta.etag;
+    if (!entry.segments.empty()) {
+        plan.segments = entry.segments;
+        for (auto& segment : plan.segments) {
+            segment.replicas = resolve(segment.replicas);
+            if (segment.replicas.empty()) {
+                return core::Error{core::ErrorCode::kNotFound, "object manifest is incomplete"};
+            }
+        }
+        return plan;
+    }
+    plan.replicas = resolve(entry.replicas);
+    if (plan.replicas.empty()) {
+        return core::Error{core::ErrorCode::kNotFound, "object has no committed replicas"};
+    }
+    plan.blob_id = entry.blob_id;
+    return plan;
+}
+
+void MemoryMetadataStore::CountBlobs(const ObjectEntry& entry, int delta) {
+    auto count = [&](const std::string& blob_id) {
+        if (blob_id.empty()) {
+            return;
+        }
+        auto& refs = blob_refs_[blob_id];
+        refs += static_cast<std::uint64_t>(delta);
+        if (refs == 0) {
+            blob_refs_.erase(blob_id);
+        }
+    };
+    count(entry.blob_id);
+    for (const auto& segment : entry.segments) {
+        count(segment.blob_id);
+    }
+}
+
+core::Result<void> MemoryMetadataStore::BuildCopyRecord(const BatchOp& op,
+                                                        const std::string& object_name,
+                                                        core::ByteWriter& record) {
+    const auto* source_owner = buckets_.Find(op.source_bucket);
+    const auto* source =
+        source_owner != nullptr ? objects_.Find(ObjectKey(source_owner->id, op.source_object))
+                                : nullptr;
+    if (source == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "source object not found"};
+    }
+    // Only bytes on storage nodes, or a body kept in the row, can be shared; the copy must be
+    // readable wherever the source is.
+    if (!source->inline_data) {
+        auto readable = PlanRead(*source);
+        if (!readable.ok()) {
+            return readable.error();
+        }
+    }
+    const auto* owner = buckets_.Find(op.bucket);
+    if (owner == nullptr) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    const auto now_time = core::NowIso8601();
+    const auto* existing = objects_.Find(ObjectKey(owner->id, object_name));
+    ObjectMetadata meta;
+    meta.id = existing != nullptr ? existing->meta.id : next_object_id_;
+    meta.bucket_id = owner->id;
+    meta.name = object_name;
+    meta.size_bytes = source->meta.size_bytes;
+    meta.etag = source->meta.etag;
+    meta.created_at = existing != nullptr ? existing->meta.created_at : now_time;
+    meta.updated_at = now_time;
+    // The source's rows already hold node ids, so they are copied without resolving anything.
+    EncodeObject(record, meta, source->blob_id, source->replicas, source->segments,
+                 source->inline_data);
+    return core::Ok();
+}
+
+core::Result<std::vector<BatchOpResult>> MemoryMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    const bool read_only = IsReadOnlyBatch(ops);
+    std::shared_lock<std::shared_mutex> shared(state_mutex_, std::defer_lock);
+    std::unique_lock<std::shared_mutex> exclusive(state_mutex_, std::defer_lock);
+    if (read_only) {
+        shared.lock();
+        auto readable = WaitReadable();
+        if (!readable.ok()) {
+            return readable.error();
+        }
+    } else {
+        exclusive.lock();
+    }
+
+    // Ops apply as they go so later ops see earlier ones; each mutation first saves the rows it
+    // replaces, and a failing op restores them before anything reaches the WAL.
+    std::vector<BatchOpResult> results(ops.size());
+    std::vector<std::string> records;
+    std::vector<std::function<void()>> undo;
+    // Counters are restored alongside the rows, since the undo steps bypass `ApplyRecord`.
+    auto save_stats = [&](int bucket_id) {
+        undo.push_back([this, bucket_id, saved = stats_[bucket_id]] { stats_[bucket_id] = saved; });
+    };
+    auto save_upload = [&](const std::string& upload_id) {
+        std::optional<UploadEntry> saved;
+        if (auto it = uploads_.find(upload_id); it != uploads_.end()) {
+            saved = it->second;
+            save_stats(saved->upload.bucket_id);
+        }
+        undo.push_back([this, upload_id, saved = std::move(saved)] {
+            if (saved) {
+                uploads_[upload_id] = *saved;
+            } else {
+                uploads_.erase(upload_id);
+            }
+        });
+    };
+    auto save_object = [&](const std::string& bucket, const std::string& object_name) {
+        const auto* owner = buckets_.Find(bucket);
+        if (owner == nullptr) {
+            return;
+        }
+        save_stats(owner->id);
+        auto key = ObjectKey(owner->id, object_name);
+        std::optional<ObjectEntry> saved;
+        if (const auto* entry = objects_.Find(key)) {
+            saved = *entry;
+        }
+        undo.push_back([this, key = std::move(key), saved = std::move(saved),
+                        next_id = next_object_id_] {
+            if (const auto* current = objects_.Find(key)) {
+                CountBlobs(*current, -1);
+            }
+            if (saved) {
+                CountBlobs(*saved, 1);
+                *objects_.Emplace(key).first = *saved;
+            } else {
+                objects_.Erase(key);
+            }
+            next_object_id_ = next_id;
+        });
+    };
+    auto save_lease = [&](const std::string& name) {
+        std::optional<Lease> saved;
+        if (auto it = leases_.find(name); it != leases_.end()) {
+            saved = it->second;
+        }
+        undo.push_back([this, name, saved = std::move(saved)] {
+            if (saved) {
+                leases_[name] = *saved;
+            } else {
+                leases_.erase(name);
+            }
+        });
+    };
+    auto apply = [&](core::ByteWriter& record) {
+        ApplyRecord(record.data());
+        records.push_back(record.Take());
+    };
+    auto find_lease = [&](const std::string& name) -> const Lease* {
+        auto it = leases_.find(name);
+        return it == leases_.end() ? nullptr : &it->second;
+    };
+
+    auto run = [&](const BatchOp& op, BatchOpResult& result) -> core::Result<void> {
+        std::string object_name = op.object_name;
+        const bool names_upload =
+            object_name.empty() && (op.type == BatchOpType::kAllocateWrite || IsCommitOp(op));
+        if (!op.expect_upload_state.empty() || names_upload) {
+            auto it = uploads_.find(op.upload_id);
+            if (it == uploads_.end()) {
+                return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+            }
+            auto checked = CheckUploadState(op, it->second.upload.state);
+            if (!checked.ok()) {
+                return checked;
+            }
+            if (names_upload) {
+                object_name = it->second.upload.object_name;
+            }
+        }
+        switch (op.type) {
+            case BatchOpType::kGetBucket: {
+                const auto* bucket = buckets_.Find(op.bucket);
+                if (bucket == nullptr) {
+                    return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+                }
+                result.bucket = *bucket;
+                return core::Ok();
+            }
+            case BatchOpType::kGetMultipartUpload: {
+                auto it = uploads_.find(op.upload_id);
+                if (it == uploads_.end()) {
+                    return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+                }
+                result.upload = it->second.upload;
+                return core::Ok();
+            }
+            case BatchOpType::kListMultipartParts: {
+                if (auto it = uploads_.find(op.upload_id); it != uploads_.end()) {
+                    const auto& parts = it->second.parts;
+                    for (auto part = parts.upper_bound(op.part_number_marker);
+                         part != parts.end() &&
+                         (op.max_parts <= 0 ||
+                          result.parts.size() < static_cast<std::size_t>(op.max_parts));
+                         ++part) {
+                        result.parts.push_back(part->second);
+                    }
+                }
+                return core::Ok();
+            }
+            case BatchOpType::kAllocateWrite: {
+                auto plan =
+                    PlanWrite(op.bucket, object_name, op.replication_factor, op.service_token);
+                if (!plan.ok()) {
+                    return plan.error();
+                }
+                result.write_plan = std::move(plan.value());
+                return core::Ok();
+            }
+            case BatchOpType::kCommitWrite: {
+                core::ByteWriter record;
+                auto built = BuildCommitRecord(op.bucket, object_name, op.blob_id, op.size_bytes,
+                                               op.etag, op.replicas, {}, record);
+                if (!built.ok()) {
+                    return built;
+                }
+                save_object(op.bucket, object_name);
+                apply(record);
+                return core::Ok();
+            }
+            case BatchOpType::kCommitManifest: {
+                auto checked = CheckManifest(op);
+                if (!checked.ok()) {
+                    return checked;
+                }
+                core::ByteWriter record;
+                auto built = BuildCommitRecord(op.bucket, object_name, {}, op.size_bytes, op.etag,
+                                               {}, op.segments, record);
+                if (!built.ok()) {
+                    return built;
+                }
+                save_object(op.bucket, object_name);
+                apply(record);
+                return core::Ok();
+            }
+            case BatchOpType::kCopyObject: {
+                core::ByteWriter record;
+                auto built = BuildCopyRecord(op, object_name, record);
+                if (!built.ok()) {
+                    return built;
+                }
+                save_object(op.bucket, object_name);
+                apply(record);
+                // An inline copy has no blobs to plan a read of.
+                if (auto plan = PlanRead(*objects_.Find(
+                        ObjectKey(buckets_.Find(op.bucket)->id, object_name)));
+                    plan.ok()) {
+                    result.read_plan = std::move(plan.value());
+                }
+                return core::Ok();
+            }
+            case BatchOpType::kDeleteObject: {
+                const auto* owner = buckets_.Find(op.bucket);
+                if (owner == nullptr) {
+                    return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+                }
+                auto key = ObjectKey(owner->id, object_name);
+                const auto* entry = objects_.Find(key);
+                if (entry == nullptr) {
+                    return core::Ok();
+                }
+                // Copies share a whole layout, so the first blob's count stands for all of it.
+                const auto shared = entry->segments.empty() ? entry->blob_id
+                                                            : entry->segments.front().blob_id;
+                if (auto plan = PlanRead(*entry); plan.ok()) {
+                    result.read_plan = std::move(plan.value());
+                }
+                core::ByteWriter record;
+                EncodeKeyed(record, RecordType::kDeleteObject, key);
+                save_object(op.bucket, object_name);
+                apply(record);
+                result.removed = true;
+                if (auto it = blob_refs_.find(shared); it != blob_refs_.end()) {
+                    result.blob_references = it->second;
+                }
+                return core::Ok();
+            }
+            case BatchOpType::kUpdateMultipartUploadState: {
+                core::ByteWriter record;
+                auto built = BuildUploadStateRecord(op.upload_id, op.state, record);
+                if (!built.ok()) {
+                    return built;
+                }
+                save_upload(op.upload_id);
+                apply(record);
+                return core::Ok();
+            }
+            case BatchOpType::kCreateMultipartUpload: {
+                core::ByteWriter record;
+                auto built = BuildUploadRecord(op.bucket, op.upload_id, object_name,
+                                               op.expires_at, record);
+                if (!built.ok()) {
+                    return built.error();
+                }
+                save_upload(op.upload_id);
+                apply(record);
+                result.upload = std::move(built.value());
+                return core::Ok();
+            }
+            case BatchOpType::kSetMultipartPartSize: {
+                auto it = uploads_.find(op.upload_id);
+                if (it == uploads_.end()) {
+                    return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+                }
+                auto upload = it->second.upload;
+                upload.part_size = op.part_size;
+                upload.updated_at = core::NowIso8601();
+                core::ByteWriter record;
+                EncodeUpload(record, upload);
+                save_upload(op.upload_id);
+                apply(record);
+                return core::Ok();
+            }
+            case BatchOpType::kDeleteMultipartParts:
+            case BatchOpType::kDeleteMultipartUpload: {
+                if (uploads_.count(op.upload_id) == 0) {
+                    return core::Ok();
+                }
+                core::ByteWriter record;
+                EncodeKeyed(record,
+                            op.type == BatchOpType::kDeleteMultipartParts
+                                ? RecordType::kDeleteParts
+                                : RecordType::kDeleteUpload,
+                            op.upload_id);
+                save_upload(op.upload_id);
+                apply(record);
+                return core::Ok();
+            }
+            case BatchOpType::kAcquireLease: {
+                auto lease = AcquireLease(op, find_lease(op.lease));
+                if (!lease.ok()) {
+                    return lease.error();
+                }
+                core::ByteWriter record;
+                EncodeLease(record, lease.value());
+                save_lease(op.lease);
+                apply(record);
+                result.lease = std::move(lease.value());
+                return core::Ok();
+            }
+            case BatchOpType::kCheckLease:
+                return CheckLease(op, find_lease(op.lease));
+            case BatchOpType::kGetBucketStats:
+            case BatchOpType::kRepairBucketStats: {
+                const auto* bucket = buckets_.Find(op.bucket);
+                if (bucket == nullptr) {
+                    return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+                }
+                if (op.type == BatchOpType::kRepairBucketStats) {
+                    save_stats(bucket->id);
+                    stats_[bucket->id] = CountBucket(bucket->id);
+                }
+                if (auto it = stats_.find(bucket->id); it != stats_.end()) {
+                    result.stats = it->second;
+                }
+                return core::Ok();
+            }
+        }
+        return core::Error{core::ErrorCode::kInvalidArgument, "unknown batch op"};
+    };
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        auto ran = run(ops[i], results[i]);
+        if (!ran.ok()) {
+            for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+                (*it)();
+            }
+            return BatchOpError(i, ops[i], ran.error());
+        }
+    }
+    if (records.empty()) {
+        return results;
+    }
+    // One frame for the whole batch, so a torn tail drops all of it or none.
+    core::ByteWriter batch;
+    batch.PutU8(static_cast<std::uint8_t>(RecordType::kBatch));
+    batch.PutU32(static_cast<std::uint32_t>(records.size()));
+    for (const auto& record : records) {
+        batch.PutString(record);
+    }
+    const auto lsn = AppendToWal(batch.data());
+    exclusive.unlock();
+    auto durable = WaitDurable(lsn);
+    if (!durable.ok()) {
+        return durable.error();
+    }
+    return results;
+}
+
+}  // namespace nebulafs::metadata
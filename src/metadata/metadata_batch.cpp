@@ -0,0 +1,164 @@
+#include "nebulafs/metadata/metadata_batch.h"
+
+#include <array>
+#include <chrono>
+#include <utility>
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr std::array<std::pair<BatchOpType, std::string_view>, 17> kOpNames = {{
+    {BatchOpType::kGetBucket, "get_bucket"},
+    {BatchOpType::kGetMultipartUpload, "get_upload"},
+    {BatchOpType::kListMultipartParts, "list_parts"},
+    {BatchOpType::kAllocateWrite, "allocate_write"},
+    {BatchOpType::kCommitWrite, "commit_write"},
+    {BatchOpType::kUpdateMultipartUploadState, "update_upload_state"},
+    {BatchOpType::kDeleteMultipartParts, "delete_parts"},
+    {BatchOpType::kDeleteMultipartUpload, "delete_upload"},
+    {BatchOpType::kAcquireLease, "acquire_lease"},
+    {BatchOpType::kCheckLease, "check_lease"},
+    {BatchOpType::kGetBucketStats, "get_bucket_stats"},
+    {BatchOpType::kRepairBucketStats, "repair_bucket_stats"},
+    {BatchOpType::kSetMultipartPartSize, "set_upload_part_size"},
+    {BatchOpType::kCommitManifest, "commit_manifest"},
+    {BatchOpType::kCopyObject, "copy_object"},
+    {BatchOpType::kDeleteObject, "delete_object"},
+    {BatchOpType::kCreateMultipartUpload, "create_upload"},
+}};
+
+}  // namespace
+
+std::string_view BatchOpName(BatchOpType type) {
+    for (const auto& [op_type, name] : kOpNames) {
+        if (op_type == type) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+std::optional<BatchOpType> ParseBatchOpName(std::string_view name) {
+    for (const auto& [op_type, op_name] : kOpNames) {
+        if (op_name == name) {
+            return op_type;
+        }
+    }
+    return std::nullopt;
+}
+
+bool IsReadOnlyBatch(const std::vector<BatchOp>& ops) {
+    for (const auto& op : ops) {
+        switch (op.type) {
+            case BatchOpType::kGetBucket:
+            case BatchOpType::kGetMultipartUpload:
+            case BatchOpType::kListMultipartParts:
+            case BatchOpType::kAllocateWrite:
+            case BatchOpType::kCheckLease:
+            case BatchOpType::kGetBucketStats:
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+core::Error BatchOpError(std::size_t index, const BatchOp& op, const core::Error& error) {
+    return core::Error{error.code, "batch op " + std::to_string(index) + " (" +
+                                       std::string(BatchOpName(op.type)) +
+                                       "): " + error.message};
+}
+
+core::Result<void> CheckUploadState(const BatchOp& op, const std::string& actual_state) {
+    if (!op.expect_upload_state.empty() && actual_state != op.expect_upload_state) {
+        return core::Error{core::ErrorCode::kFailedPrecondition,
+                           "multipart upload is " + actual_state + ", expected " +
+                               op.expect_upload_state};
+    }
+    return core::Ok();
+}
+
+bool IsCommitOp(const BatchOp& op) {
+    return op.type == BatchOpType::kCommitWrite || op.type == BatchOpType::kCommitManifest;
+}
+
+bool ChangesObject(const BatchOp& op) {
+    return IsCommitOp(op) || op.type == BatchOpType::kCopyObject ||
+           op.type == BatchOpType::kDeleteObject;
+}
+
+core::Result<void> CheckManifest(const BatchOp& op) {
+    if (op.segments.empty()) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "manifest has no segments"};
+    }
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < op.segments.size(); ++i) {
+        const auto& segment = op.segments[i];
+        if (segment.blob_id.empty() || segment.replicas.empty() || segment.offset != offset) {
+            return core::Error{core::ErrorCode::kInvalidArgument,
+                               "manifest segment " + std::to_string(i) + " is out of place"};
+        }
+        offset += segment.size_bytes;
+    }
+    if (offset != op.size_bytes) {
+        return core::Error{core::ErrorCode::kInvalidArgument,
+                           "manifest segments do not add up to the object size"};
+    }
+    return core::Ok();
+}
+
+bool IsLeaseOp(const BatchOp& op) {
+    return op.type == BatchOpType::kAcquireLease || op.type == BatchOpType::kCheckLease;
+}
+
+std::uint64_t LeaseClock(const BatchOp& op) {
+    if (op.now_ms != 0) {
+        return op.now_ms;
+    }
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          std::chrono::system_clock::now().time_since_epoch())
+                                          .count());
+}
+
+core::Result<Lease> AcquireLease(const BatchOp& op, const Lease* current) {
+    if (op.lease.empty() || op.lease_holder.empty() || op.lease_ttl_ms == 0) {
+        return core::Error{core::ErrorCode::kInvalidArgument,
+                           "acquiring a lease needs a name, a holder and a ttl"};
+    }
+    const auto now = LeaseClock(op);
+    Lease next{op.lease, op.lease_holder, 1, now + op.lease_ttl_ms};
+    if (current != nullptr) {
+        if (current->holder == op.lease_holder) {
+            // A renewal keeps the token: writes fenced by it are still the same holder's.
+            next.fencing_token = current->fencing_token;
+        } else if (current->expires_at_ms > now) {
+            return core::Error{core::ErrorCode::kFailedPrecondition,
+                               "lease " + op.lease + " is held by " + current->holder};
+        } else {
+            next.fencing_token = current->fencing_token + 1;
+        }
+    }
+    return next;
+}
+
+core::Result<void> CheckLease(const BatchOp& op, const Lease* current) {
+    if (current == nullptr || current->holder != op.lease_holder ||
+        current->fencing_token != op.fencing_token || current->expires_at_ms <= LeaseClock(op)) {
+        return core::Error{core::ErrorCode::kFailedPrecondition,
+                           "lease " + op.lease + " is no longer held by " + op.lease_holder};
+    }
+    return core::Ok();
+}
+
+BatchOp LeaseCheckOp(const Lease& lease) {
+    BatchOp op;
+    op.type = BatchOpType::kCheckLease;
+    op.lease = lease.name;
+    op.lease_holder = lease.holder;
+    op.fencing_token = lease.fencing_token;
+    return op;
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,19 @@
+#include "nebulafs/metadata/metadata_store_factory.h"
+
+#include <filesystem>
+
+#include "nebulafs/metadata/memory_metadata_store.h"
+#include "nebulafs/metadata/sqlite_metadata_store.h"
+
+namespace nebulafs::metadata {
+
+std::shared_ptr<MetadataStore> OpenMetadataStore(const core::DatabaseConfig& config) {
+    if (config.engine == "memory") {
+        return std::make_shared<MemoryMetadataStore>(config.memory_path,
+                                                     config.snapshot_wal_bytes);
+    }
+    std::filesystem::create_directories(std::filesystem::path(config.path).parent_path());
+    return std::make_shared<SqliteMetadataStore>(config.path, config.reader_connections);
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,110 @@
+#include "nebulafs/metadata/object_listing.h"
+
+#include <algorithm>
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr std::string_view kCursorVersion = "v1";
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+std::string PrefixUpperBound(std::string_view prefix) {
+    std::string upper(prefix);
+    // Trailing 0xff bytes cannot be incremented; drop them and bump the byte before.
+    while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xff) {
+        upper.pop_back();
+    }
+    if (!upper.empty()) {
+        upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+    }
+    return upper;
+}
+
+ObjectListing BuildObjectListing(const ListObjectsOptions& options, const ObjectRangeScan& scan) {
+    ObjectListing listing;
+    const int max_keys = std::clamp(options.max_keys, 0, kMaxListKeys);
+    const std::string upper = PrefixUpperBound(options.prefix);
+    std::string lower = std::max(options.prefix, options.cursor);
+    int returned = 0;
+
+    bool seek = true;
+    while (seek && (upper.empty() || lower < upper)) {
+        seek = false;
+        std::string next_lower;
+        scan(lower, upper, [&](ObjectMetadata&& object) {
+            if (returned == max_keys) {
+                // One key past the page is enough to know another page exists.
+                listing.is_truncated = true;
+                return false;
+            }
+            if (!options.delimiter.empty()) {
+                const auto pos = object.name.find(options.delimiter, options.prefix.size());
+                if (pos != std::string::npos) {
+                    auto common = object.name.substr(0, pos + options.delimiter.size());
+                    next_lower = PrefixUpperBound(common);
+                    listing.common_prefixes.push_back(std::move(common));
+                    listing.next_cursor = next_lower;
+                    ++returned;
+                    // Re-seek past the whole group so a prefix costs one lookup, not one row
+                    // per key underneath it.
+                    seek = !next_lower.empty();
+                    return false;
+                }
+            }
+            // Appending NUL yields the immediate successor, so the next page starts after it.
+            listing.next_cursor = object.name + '\0';
+            listing.objects.push_back(std::move(object));
+            ++returned;
+            return true;
+        });
+        lower = std::move(next_lower);
+    }
+
+    if (!listing.is_truncated) {
+        listing.next_cursor.clear();
+    }
+    return listing;
+}
+
+std::string EncodeListCursor(const std::string& cursor) {
+    std::string token(kCursorVersion);
+    token.reserve(kCursorVersion.size() + cursor.size() * 2);
+    for (const char c : cursor) {
+        const auto byte = static_cast<unsigned char>(c);
+        token.push_back(kHexDigits[byte >> 4]);
+        token.push_back(kHexDigits[byte & 0x0f]);
+    }
+    return token;
+}
+
+std::optional<std::string> DecodeListCursor(const std::string& token) {
+    if (token.rfind(kCursorVersion, 0) != 0 || (token.size() - kCursorVersion.size()) % 2 != 0) {
+        return std::nullopt;
+    }
+    std::string cursor;
+    cursor.reserve((token.size() - kCursorVersion.size()) / 2);
+    for (std::size_t i = kCursorVersion.size(); i < token.size(); i += 2) {
+        const int high = HexValue(token[i]);
+        const int low = HexValue(token[i + 1]);
+        if (high < 0 || low < 0) {
+            return std::nullopt;
+        }
+        cursor.push_back(static_cast<char>((high << 4) | low));
+    }
+    return cursor;
+}
+
+}  // namespace nebulafs::metadata
@@ -1,15 +1,18 @@
 #include "nebulafs/metadata/remote_metadata_store.h"
 
+#include <chrono>
 #include <cstdint>
-#include <sstream>
+#include <iterator>
 #include <string>
+#include <thread>
 
-#include <Poco/JSON/Array.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Parser.h>
 #include <Poco/URI.h>
 
 #include "nebulafs/distributed/http_client.h"
+#include "nebulafs/metadata/metadata_rpc.h"
+#include "nebulafs/metadata/object_listing.h"
 
 // Poco pulls in Windows headers on win32, which define GetObject as a macro.
 // Remove the macro before member definitions to avoid GetObject->GetObjectW rewrite.
@@ -33,87 +36,182 @@ std::string JoinUrl(const std::string& base_url, const std::string& path_and_que
     return base_url + "/" + path_and_query;
 }
 
+constexpr auto kLeaderSearchTimeout = std::chrono::seconds(5);
+constexpr auto kLeaderRetryDelay = std::chrono::milliseconds(100);
+
 core::Error HttpError(const std::string& message) {
     return core::Error{core::ErrorCode::kInternal, message};
 }
 
-template <typename Builder>
-core::Result<distributed::HttpCallResult> CallJson(const std::string& method, const std::string& url,
-                                                   const std::string& token, Builder&& build_body) {
-    Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-    build_body(root);
-    std::ostringstream ss;
-    root->stringify(ss);
-    return distributed::SendHttpRequest(method, url, ss.str(), "application/json", token, {});
-}
-
-core::Result<Poco::JSON::Object::Ptr> ParseObject(const distributed::HttpCallResult& response) {
+// Error bodies are always the service's JSON envelope, whatever format was negotiated.
+std::string ErrorMessage(const distributed::HttpCallResult& response) {
     try {
         Poco::JSON::Parser parser;
-        auto v = parser.parse(response.body);
-        return v.extract<Poco::JSON::Object::Ptr>();
-    } catch (const std::exception& ex) {
-        return core::Error{core::ErrorCode::kInternal, ex.what()};
+        auto root = parser.parse(response.body).extract<Poco::JSON::Object::Ptr>();
+        if (root->has("error")) {
+            return root->getObject("error")->getValue<std::string>("message");
+        }
+    } catch (const std::exception&) {
     }
+    return response.body;
 }
 
 }  // namespace
 
-RemoteMetadataStore::RemoteMetadataStore(std::string base_url, std::string service_auth_token)
-    : base_url_(std::move(base_url)),
-      service_auth_token_(std::move(service_auth_token)) {
+RemoteMetadataStore::RemoteMetadataStore(std::string base_url, std::string service_auth_token,
+                                         core::WireFormat wire_format)
+    : service_auth_token_(std::move(service_auth_token)), wire_format_(wire_format) {
+    std::size_t start = 0;
+    while (start <= base_url.size()) {
+        auto end = base_url.find(',', start);
+        if (end == std::string::npos) {
+            end = base_url.size();
+        }
+        auto member = base_url.substr(start, end - start);
+        member.erase(0, member.find_first_not_of(" \t"));
+        member.erase(member.find_last_not_of(" \t") + 1);
+        if (!member.empty()) {
+            members_.push_back(std::move(member));
+        }
+        start = end + 1;
+    }
+    if (members_.empty()) {
+        members_.push_back(base_url);
+    }
+    leader_ = members_.front();
 }
 
+core::Result<distributed::HttpCallResult> RemoteMetadataStore::SendToLeader(
+    const std::string& method, const std::string& path_and_query, const std::string& body,
+    const std::string& content_type) {
+    std::string target;
+    {
+        std::lock_guard<std::mutex> lock(leader_mutex_);
+        target = leader_;
+    }
+    if (members_.size() == 1) {
+        auto call = distributed::SendHttpRequest(method, JoinUrl(target, path_and_query), body,
+                                                 content_type, service_auth_token_,
+                                                 AcceptHeaders());
+        if (call.ok()) {
+            NoteCommitIndex(call.value());
+        }
+        return call;
+    }
+    // Elections take one to two election timeouts; keep trying members until one leads.
+    const auto deadline = std::chrono::steady_clock::now() + kLeaderSearchTimeout;
+    core::Result<distributed::HttpCallResult> call =
+        core::Error{core::ErrorCode::kUnavailable, "no metadata leader available"};
+    std::size_t rotation = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        call = distributed::SendHttpRequest(method, JoinUrl(target, path_and_query), body,
+                                            content_type, service_auth_token_, AcceptHeaders());
+        if (call.ok() && call.value().status != 503) {
+            NoteCommitIndex(call.value());
+            std::lock_guard<std::mutex> lock(leader_mutex_);
+            leader_ = target;
+            return call;
+        }
+        if (call.ok()) {
+            const auto& headers = call.value().headers;
+            const auto hint = headers.find("X-Nebula-Leader");
+            if (hint != headers.end() && hint->second != target) {
+                target = hint->second;
+                continue;
+            }
+        }
+        target = members_[++rotation % members_.size()];
+        if (rotation % members_.size() == 0) {
+            std::this_thread::sleep_for(kLeaderRetryDelay);
+        }
+    }
+    return call;
+}
+
+core::Result<distributed::HttpCallResult> RemoteMetadataStore::SendRead(
+    const std::string& path_and_query) {
+    if (members_.size() > 1) {
+        const auto& member = members_[next_reader_++ % members_.size()];
+        auto headers = AcceptHeaders();
+        headers["X-Nebula-Min-Index"] = std::to_string(commit_index_.load());
+        auto call = distributed::SendHttpRequest("GET", JoinUrl(member, path_and_query), "", "",
+                                                 service_auth_token_, headers);
+        // 503 means that member is stale or partitioned; the leader can always answer.
+        if (call.ok() && call.value().status != 503) {
+            return call;
+        }
+    }
+    return SendToLeader("GET", path_and_query, "", "");
+}
+
+template <typename Msg>
+core::Result<distributed::HttpCallResult> RemoteMetadataStore::SendMessage(
+    const std::string& method, const std::string& path, const Msg& request) {
+    return SendToLeader(method, path, core::EncodeWire(wire_format_, request),
+                        std::string(core::MediaTypeFor(wire_format_)));
+}
+
+template <typename Msg>
+core::Result<Msg> RemoteMetadataStore::ReadReply(
+    const distributed::HttpCallResult& response) const {
+    // Follow the response's own Content-Type: a service predating the binary codec answers JSON.
+    const auto content_type = response.headers.find("Content-Type");
+    const auto format = content_type == response.headers.end()
+                            ? core::WireFormat::kJson
+                            : core::FormatFromMediaType(content_type->second);
+    auto decoded = core::DecodeWire<Msg>(format, response.body);
+    if (!decoded.ok()) {
+        return HttpError("invalid metadata response: " + decoded.error().message);
+    }
+    return decoded;
+}
+
+std::map<std::string, std::string> RemoteMetadataStore::AcceptHeaders() const {
+    return {{"Accept", std::string(core::MediaTypeFor(wire_format_))}};
+}
+
+void RemoteMetadataStore::NoteCommitIndex(const distributed::HttpCallResult& response) {
+    const auto it = response.headers.find("X-Nebula-Commit-Index");
+    if (it == response.headers.end()) {
+        return;
+    }
+    const auto index = std::stoull(it->second);
+    auto seen = commit_index_.load();
+    while (seen < index && !commit_index_.compare_exchange_weak(seen, index)) {
+    }
+}
+
+
 core::Result<Bucket> RemoteMetadataStore::CreateBucket(const std::string& name) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/buckets/create"),
-                         service_auth_token_,
-                         [&](Poco::JSON::Object::Ptr root) { root->set("name", name); });
+    auto call = SendMessage("POST", "/internal/v1/buckets/create", CreateBucketRequest{name});
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("create bucket failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    Bucket bucket;
-    bucket.id = parsed.value()->getValue<int>("id");
-    bucket.name = parsed.value()->getValue<std::string>("name");
-    bucket.created_at = parsed.value()->getValue<std::string>("created_at");
-    return bucket;
+    return ReadReply<Bucket>(call.value());
 }
 
 core::Result<std::vector<Bucket>> RemoteMetadataStore::ListBuckets() {
-    auto call = distributed::SendHttpRequest("GET", JoinUrl(base_url_, "/internal/v1/buckets/list"),
-                                             "", "", service_auth_token_, {});
+    auto call = SendRead("/internal/v1/buckets/list");
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("list buckets failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
+    auto reply = ReadReply<BucketListResponse>(call.value());
+    if (!reply.ok()) {
+        return reply.error();
     }
-    std::vector<Bucket> buckets;
-    auto arr = parsed.value()->getArray("buckets");
-    for (size_t i = 0; i < arr->size(); ++i) {
-        auto item = arr->getObject(i);
-        buckets.push_back(Bucket{item->getValue<int>("id"), item->getValue<std::string>("name"),
-                                 item->getValue<std::string>("created_at")});
-    }
-    return buckets;
+    return std::move(reply.value().buckets);
 }
 
 core::Result<Bucket> RemoteMetadataStore::GetBucket(const std::string& name) {
     std::string encoded;
     Poco::URI::encode(name, "", encoded);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/buckets/get?name=" + encoded), "", "",
-        service_auth_token_, {});
+    auto call = SendRead("/internal/v1/buckets/get?name=" + encoded);
     if (!call.ok()) {
         return call.error();
     }
@@ -123,45 +221,21 @@ core::Result<Bucket> RemoteMetadataStore::GetBucket(const std::string& name) {
     if (call.value().status != 200) {
         return HttpError("get bucket failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    Bucket bucket;
-    bucket.id = parsed.value()->getValue<int>("id");
-    bucket.name = parsed.value()->getValue<std::string>("name");
-    bucket.created_at = parsed.value()->getValue<std::string>("created_at");
-    return bucket;
+    return ReadReply<Bucket>(call.value());
 }
 
 core::Result<ObjectMetadata> RemoteMetadataStore::UpsertObject(const std::string& bucket,
                                                                const ObjectMetadata& object) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/objects/upsert"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("bucket", bucket);
-                             root->set("name", object.name);
-                             root->set("size_bytes", static_cast<Poco::UInt64>(object.size_bytes));
-                             root->set("etag", object.etag);
-                         });
+    auto call = SendMessage("POST", "/internal/v1/objects/upsert",
+                            UpsertObjectRequest{bucket, object.name, object.size_bytes,
+                                                object.etag});
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("upsert object failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    ObjectMetadata meta;
-    meta.id = parsed.value()->getValue<int>("id");
-    meta.bucket_id = parsed.value()->getValue<int>("bucket_id");
-    meta.name = parsed.value()->getValue<std::string>("name");
-    meta.size_bytes = parsed.value()->getValue<Poco::UInt64>("size_bytes");
-    meta.etag = parsed.value()->getValue<std::string>("etag");
-    meta.created_at = parsed.value()->getValue<std::string>("created_at");
-    meta.updated_at = parsed.value()->getValue<std::string>("updated_at");
-    return meta;
+    return ReadReply<ObjectMetadata>(call.value());
 }
 
 core::Result<ObjectMetadata> RemoteMetadataStore::GetObject(const std::string& bucket,
@@ -170,10 +244,8 @@ core::Result<ObjectMetadata> RemoteMetadataStore::GetObject(const std::string& b
     std::string object_enc;
     Poco::URI::encode(bucket, "", bucket_enc);
     Poco::URI::encode(object_name, "", object_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/objects/get?bucket=" + bucket_enc + "&object=" +
-                                      object_enc),
-        "", "", service_auth_token_, {});
+    auto call =
+        SendRead("/internal/v1/objects/get?bucket=" + bucket_enc + "&object=" + object_enc);
     if (!call.ok()) {
         return call.error();
     }
@@ -183,56 +255,62 @@ core::Result<ObjectMetadata> RemoteMetadataStore::GetObject(const std::string& b
     if (call.value().status != 200) {
         return HttpError("get object failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    ObjectMetadata meta;
-    meta.id = parsed.value()->getValue<int>("id");
-    meta.bucket_id = parsed.value()->getValue<int>("bucket_id");
-    meta.name = parsed.value()->getValue<std::string>("name");
-    meta.size_bytes = parsed.value()->getValue<Poco::UInt64>("size_bytes");
-    meta.etag = parsed.value()->getValue<std::string>("etag");
-    meta.created_at = parsed.value()->getValue<std::string>("created_at");
-    meta.updated_at = parsed.value()->getValue<std::string>("updated_at");
-    return meta;
+    return ReadReply<ObjectMetadata>(call.value());
 }
 
 core::Result<std::vector<ObjectMetadata>> RemoteMetadataStore::ListObjects(
     const std::string& bucket, const std::string& prefix) {
+    // The service pages listings, so walk the cursor until the last page.
+    std::vector<ObjectMetadata> objects;
+    ListObjectsOptions options;
+    options.prefix = prefix;
+    options.max_keys = kMaxListKeys;
+    while (true) {
+        auto page = ListObjectsPage(bucket, options);
+        if (!page.ok()) {
+            return page.error();
+        }
+        auto& listing = page.value();
+        std::move(listing.objects.begin(), listing.objects.end(), std::back_inserter(objects));
+        if (!listing.is_truncated) {
+            return objects;
+        }
+        options.cursor = std::move(listing.next_cursor);
+    }
+}
+
+core::Result<ObjectListing> RemoteMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
     std::string bucket_enc;
     std::string prefix_enc;
+    std::string delimiter_enc;
     Poco::URI::encode(bucket, "", bucket_enc);
-    Poco::URI::encode(prefix, "", prefix_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/objects/list?bucket=" + bucket_enc + "&prefix=" +
-                                      prefix_enc),
-        "", "", service_auth_token_, {});
+    Poco::URI::encode(options.prefix, "", prefix_enc);
+    Poco::URI::encode(options.delimiter, "", delimiter_enc);
+    auto call = SendRead("/internal/v1/objects/list?bucket=" + bucket_enc + "&prefix=" +
+                         prefix_enc + "&delimiter=" + delimiter_enc +
+                         "&max_keys=" + std::to_string(options.max_keys) +
+                         "&cursor=" + EncodeListCursor(options.cursor));
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("list objects failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
+    auto reply = ReadReply<ObjectPageResponse>(call.value());
+    if (!reply.ok()) {
+        return reply.error();
     }
-    std::vector<ObjectMetadata> objects;
-    auto arr = parsed.value()->getArray("objects");
-    for (size_t i = 0; i < arr->size(); ++i) {
-        auto item = arr->getObject(i);
-        ObjectMetadata meta;
-        meta.id = item->getValue<int>("id");
-        meta.bucket_id = item->getValue<int>("bucket_id");
-        meta.name = item->getValue<std::string>("name");
-        meta.size_bytes = item->getValue<Poco::UInt64>("size_bytes");
-        meta.etag = item->getValue<std::string>("etag");
-        meta.created_at = item->getValue<std::string>("created_at");
-        meta.updated_at = item->getValue<std::string>("updated_at");
-        objects.push_back(meta);
-    }
-    return objects;
+    auto cursor = DecodeListCursor(reply.value().next_cursor);
+    if (!cursor) {
+        return HttpError("list objects returned an invalid cursor");
+    }
+    ObjectListing listing;
+    listing.objects = std::move(reply.value().objects);
+    listing.common_prefixes = std::move(reply.value().common_prefixes);
+    listing.is_truncated = reply.value().is_truncated;
+    listing.next_cursor = std::move(*cursor);
+    return listing;
 }
 
 core::Result<void> RemoteMetadataStore::DeleteObject(const std::string& bucket,
@@ -241,10 +319,9 @@ core::Result<void> RemoteMetadataStore::DeleteObject(const std::string& bucket,
     std::string object_enc;
     Poco::URI::encode(bucket, "", bucket_enc);
     Poco::URI::encode(object_name, "", object_enc);
-    auto call = distributed::SendHttpRequest(
-        "DELETE", JoinUrl(base_url_, "/internal/v1/objects/delete?bucket=" + bucket_enc +
-                                         "&object=" + object_enc),
-        "", "", service_auth_token_, {});
+    auto call = SendToLeader(
+        "DELETE", "/internal/v1/objects/delete?bucket=" + bucket_enc + "&object=" + object_enc,
+        "", "");
     if (!call.ok()) {
         return call.error();
     }
@@ -257,13 +334,8 @@ core::Result<void> RemoteMetadataStore::DeleteObject(const std::string& bucket,
 core::Result<MultipartUpload> RemoteMetadataStore::CreateMultipartUpload(
     const std::string& bucket, const std::string& upload_id, const std::string& object_name,
     const std::string& expires_at) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/multipart/uploads/create"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("bucket", bucket);
-                             root->set("upload_id", upload_id);
-                             root->set("object", object_name);
-                             root->set("expires_at", expires_at);
-                         });
+    auto call = SendMessage("POST", "/internal/v1/multipart/uploads/create",
+                            CreateUploadRequest{bucket, upload_id, object_name, expires_at});
     if (!call.ok()) {
         return call.error();
     }
@@ -276,28 +348,14 @@ core::Result<MultipartUpload> RemoteMetadataStore::CreateMultipartUpload(
     if (call.value().status != 200) {
         return HttpError("create multipart upload failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    MultipartUpload upload;
-    upload.id = parsed.value()->getValue<int>("id");
-    upload.upload_id = parsed.value()->getValue<std::string>("upload_id");
-    upload.bucket_id = parsed.value()->getValue<int>("bucket_id");
-    upload.object_name = parsed.value()->getValue<std::string>("object_name");
-    upload.state = parsed.value()->getValue<std::string>("state");
-    upload.expires_at = parsed.value()->getValue<std::string>("expires_at");
-    upload.created_at = parsed.value()->getValue<std::string>("created_at");
-    upload.updated_at = parsed.value()->getValue<std::string>("updated_at");
-    return upload;
+    return ReadReply<MultipartUpload>(call.value());
 }
 
 core::Result<MultipartUpload> RemoteMetadataStore::GetMultipartUpload(const std::string& upload_id) {
     std::string upload_id_enc;
     Poco::URI::encode(upload_id, "", upload_id_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/multipart/uploads/get?upload_id=" + upload_id_enc),
-        "", "", service_auth_token_, {});
+    auto call = SendToLeader(
+        "GET", "/internal/v1/multipart/uploads/get?upload_id=" + upload_id_enc, "", "");
     if (!call.ok()) {
         return call.error();
     }
@@ -307,65 +365,34 @@ core::Result<MultipartUpload> RemoteMetadataStore::GetMultipartUpload(const std:
     if (call.value().status != 200) {
         return HttpError("get multipart upload failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    MultipartUpload upload;
-    upload.id = parsed.value()->getValue<int>("id");
-    upload.upload_id = parsed.value()->getValue<std::string>("upload_id");
-    upload.bucket_id = parsed.value()->getValue<int>("bucket_id");
-    upload.object_name = parsed.value()->getValue<std::string>("object_name");
-    upload.state = parsed.value()->getValue<std::string>("state");
-    upload.expires_at = parsed.value()->getValue<std::string>("expires_at");
-    upload.created_at = parsed.value()->getValue<std::string>("created_at");
-    upload.updated_at = parsed.value()->getValue<std::string>("updated_at");
-    return upload;
+    return ReadReply<MultipartUpload>(call.value());
 }
 
 core::Result<std::vector<MultipartUpload>> RemoteMetadataStore::ListExpiredMultipartUploads(
     const std::string& expires_before, int limit) {
     std::string expires_before_enc;
     Poco::URI::encode(expires_before, "", expires_before_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/multipart/uploads/list-expired?expires_before=" +
-                                      expires_before_enc + "&limit=" + std::to_string(limit)),
-        "", "", service_auth_token_, {});
+    auto call = SendToLeader("GET",
+                             "/internal/v1/multipart/uploads/list-expired?expires_before=" +
+                                 expires_before_enc + "&limit=" + std::to_string(limit),
+                             "", "");
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("list expired multipart uploads failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    std::vector<MultipartUpload> uploads;
-    auto arr = parsed.value()->getArray("uploads");
-    for (size_t i = 0; i < arr->size(); ++i) {
-        auto item = arr->getObject(i);
-        MultipartUpload upload;
-        upload.id = item->getValue<int>("id");
-        upload.upload_id = item->getValue<std::string>("upload_id");
-        upload.bucket_id = item->getValue<int>("bucket_id");
-        upload.object_name = item->getValue<std::string>("object_name");
-        upload.state = item->getValue<std::string>("state");
-        upload.expires_at = item->getValue<std::string>("expires_at");
-        upload.created_at = item->getValue<std::string>("created_at");
-        upload.updated_at = item->getValue<std::string>("updated_at");
-        uploads.push_back(upload);
+    auto reply = ReadReply<UploadListResponse>(call.value());
+    if (!reply.ok()) {
+        return reply.error();
     }
-    return uploads;
+    return std::move(reply.value().uploads);
 }
 
 core::Result<void> RemoteMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
                                                                    const std::string& state) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/multipart/uploads/state"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("upload_id", upload_id);
-                             root->set("state", state);
-                         });
+    auto call = SendMessage("POST", "/internal/v1/multipart/uploads/state",
+                            UploadStateRequest{upload_id, state});
     if (!call.ok()) {
         return call.error();
     }
@@ -381,10 +408,8 @@ core::Result<void> RemoteMetadataStore::UpdateMultipartUploadState(const std::st
 core::Result<void> RemoteMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
     std::string upload_id_enc;
     Poco::URI::encode(upload_id, "", upload_id_enc);
-    auto call = distributed::SendHttpRequest("DELETE",
-                                             JoinUrl(base_url_, "/internal/v1/multipart/uploads/delete?upload_id=" +
-                                                                    upload_id_enc),
-                                             "", "", service_auth_token_, {});
+    auto call = SendToLeader(
+        "DELETE", "/internal/v1/multipart/uploads/delete?upload_id=" + upload_id_enc, "", "");
     if (!call.ok()) {
         return call.error();
     }
@@ -397,14 +422,9 @@ core::Result<void> RemoteMetadataStore::DeleteMultipartUpload(const std::string&
 core::Result<MultipartPart> RemoteMetadataStore::UpsertMultipartPart(
     const std::string& upload_id, int part_number, std::uint64_t size_bytes,
     const std::string& etag, const std::string& temp_path) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/multipart/parts/upsert"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("upload_id", upload_id);
-                             root->set("part_number", part_number);
-                             root->set("size_bytes", static_cast<Poco::UInt64>(size_bytes));
-                             root->set("etag", etag);
-                             root->set("temp_path", temp_path);
-                         });
+    auto call =
+        SendMessage("POST", "/internal/v1/multipart/parts/upsert",
+                    UpsertPartRequest{upload_id, part_number, size_bytes, etag, temp_path});
     if (!call.ok()) {
         return call.error();
     }
@@ -414,61 +434,33 @@ core::Result<MultipartPart> RemoteMetadataStore::UpsertMultipartPart(
     if (call.value().status != 200) {
         return HttpError("upsert multipart part failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    MultipartPart part;
-    part.id = parsed.value()->getValue<int>("id");
-    part.upload_id = parsed.value()->getValue<std::string>("upload_id");
-    part.part_number = parsed.value()->getValue<int>("part_number");
-    part.size_bytes = parsed.value()->getValue<Poco::UInt64>("size_bytes");
-    part.etag = parsed.value()->getValue<std::string>("etag");
-    part.temp_path = parsed.value()->getValue<std::string>("temp_path");
-    part.created_at = parsed.value()->getValue<std::string>("created_at");
-    return part;
+    return ReadReply<MultipartPart>(call.value());
 }
 
 core::Result<std::vector<MultipartPart>> RemoteMetadataStore::ListMultipartParts(
     const std::string& upload_id) {
     std::string upload_id_enc;
     Poco::URI::encode(upload_id, "", upload_id_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/multipart/parts/list?upload_id=" + upload_id_enc),
-        "", "", service_auth_token_, {});
+    auto call = SendToLeader(
+        "GET", "/internal/v1/multipart/parts/list?upload_id=" + upload_id_enc, "", "");
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("list multipart parts failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    std::vector<MultipartPart> parts;
-    auto arr = parsed.value()->getArray("parts");
-    for (size_t i = 0; i < arr->size(); ++i) {
-        auto item = arr->getObject(i);
-        MultipartPart part;
-        part.id = item->getValue<int>("id");
-        part.upload_id = item->getValue<std::string>("upload_id");
-        part.part_number = item->getValue<int>("part_number");
-        part.size_bytes = item->getValue<Poco::UInt64>("size_bytes");
-        part.etag = item->getValue<std::string>("etag");
-        part.temp_path = item->getValue<std::string>("temp_path");
-        part.created_at = item->getValue<std::string>("created_at");
-        parts.push_back(part);
+    auto reply = ReadReply<PartListResponse>(call.value());
+    if (!reply.ok()) {
+        return reply.error();
     }
-    return parts;
+    return std::move(reply.value().parts);
 }
 
 core::Result<void> RemoteMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
     std::string upload_id_enc;
     Poco::URI::encode(upload_id, "", upload_id_enc);
-    auto call = distributed::SendHttpRequest(
-        "DELETE", JoinUrl(base_url_, "/internal/v1/multipart/parts/delete?upload_id=" + upload_id_enc),
-        "", "", service_auth_token_, {});
+    auto call = SendToLeader(
+        "DELETE", "/internal/v1/multipart/parts/delete?upload_id=" + upload_id_enc, "", "");
     if (!call.ok()) {
         return call.error();
     }
@@ -480,14 +472,8 @@ core::Result<void> RemoteMetadataStore::DeleteMultipartParts(const std::string&
 
 core::Result<void> RemoteMetadataStore::ConfigureStorageNodes(
     const std::vector<std::string>& endpoints) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/storage-nodes/configure"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                             for (const auto& endpoint : endpoints) {
-                                 arr->add(endpoint);
-                             }
-                             root->set("endpoints", arr);
-                         });
+    auto call = SendMessage("POST", "/internal/v1/storage-nodes/configure",
+                            ConfigureNodesRequest{endpoints});
     if (!call.ok()) {
         return call.error();
     }
@@ -501,34 +487,16 @@ core::Result<AllocateWritePlan> RemoteMetadataStore::AllocateWrite(const std::st
                                                                    const std::string& object_name,
                                                                    int replication_factor,
                                                                    const std::string& service_token) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/objects/allocate-write"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("bucket", bucket);
-                             root->set("object", object_name);
-                             root->set("replication_factor", replication_factor);
-                             root->set("service_token", service_token);
-                         });
+    auto call = SendMessage(
+        "POST", "/internal/v1/objects/allocate-write",
+        AllocateWriteRequest{bucket, object_name, replication_factor, service_token});
     if (!call.ok()) {
         return call.error();
     }
     if (call.value().status != 200) {
         return HttpError("allocate write failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    AllocateWritePlan plan;
-    plan.blob_id = parsed.value()->getValue<std::string>("blob_id");
-    plan.write_token = parsed.value()->getValue<std::string>("write_token");
-    auto replicas = parsed.value()->getArray("replicas");
-    for (size_t i = 0; i < replicas->size(); ++i) {
-        auto replica = replicas->getObject(i);
-        plan.replicas.push_back(
-            ReplicaTarget{replica->getValue<int>("node_id"), replica->getValue<int>("replica_index"),
-                          replica->getValue<std::string>("endpoint")});
-    }
-    return plan;
+    return ReadReply<AllocateWritePlan>(call.value());
 }
 
 core::Result<void> RemoteMetadataStore::CommitWrite(const std::string& bucket,
@@ -537,23 +505,9 @@ core::Result<void> RemoteMetadataStore::CommitWrite(const std::string& bucket,
                                                     std::uint64_t size_bytes,
                                                     const std::string& etag,
                                                     const std::vector<ReplicaTarget>& replicas) {
-    auto call = CallJson("POST", JoinUrl(base_url_, "/internal/v1/objects/commit"),
-                         service_auth_token_, [&](Poco::JSON::Object::Ptr root) {
-                             root->set("bucket", bucket);
-                             root->set("object", object_name);
-                             root->set("blob_id", blob_id);
-                             root->set("size_bytes", static_cast<Poco::UInt64>(size_bytes));
-                             root->set("etag", etag);
-                             Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                             for (const auto& replica : replicas) {
-                                 Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                                 item->set("node_id", replica.node_id);
-                                 item->set("replica_index", replica.replica_index);
-                                 item->set("endpoint", replica.endpoint);
-                                 arr->add(item);
-                             }
-                             root->set("replicas", arr);
-                         });
+    auto call = SendMessage(
+        "POST", "/internal/v1/objects/commit",
+        CommitWriteRequest{bucket, object_name, blob_id, size_bytes, etag, replicas});
     if (!call.ok()) {
         return call.error();
     }
@@ -569,10 +523,8 @@ core::Result<ResolveReadPlan> RemoteMetadataStore::ResolveRead(const std::string
     std::string object_enc;
     Poco::URI::encode(bucket, "", bucket_enc);
     Poco::URI::encode(object_name, "", object_enc);
-    auto call = distributed::SendHttpRequest(
-        "GET", JoinUrl(base_url_, "/internal/v1/objects/resolve-read?bucket=" + bucket_enc +
-                                      "&object=" + object_enc),
-        "", "", service_auth_token_, {});
+    auto call = SendRead("/internal/v1/objects/resolve-read?bucket=" + bucket_enc +
+                         "&object=" + object_enc);
     if (!call.ok()) {
         return call.error();
     }
@@ -582,22 +534,61 @@ core::Result<ResolveReadPlan> RemoteMetadataStore::ResolveRead(const std::string
     if (call.value().status != 200) {
         return HttpError("resolve read failed: " + call.value().body);
     }
-    auto parsed = ParseObject(call.value());
-    if (!parsed.ok()) {
-        return parsed.error();
-    }
-    ResolveReadPlan plan;
-    plan.blob_id = parsed.value()->getValue<std::string>("blob_id");
-    plan.etag = parsed.value()->getValue<std::string>("etag");
-    plan.size_bytes = parsed.value()->getValue<Poco::UInt64>("size_bytes");
-    auto replicas = parsed.value()->getArray("replicas");
-    for (size_t i = 0; i < replicas->size(); ++i) {
-        auto replica = replicas->getObject(i);
-        plan.replicas.push_back(
-            ReplicaTarget{replica->getValue<int>("node_id"), replica->getValue<int>("replica_index"),
-                          replica->getValue<std::string>("endpoint")});
-    }
-    return plan;
+    return ReadReply<ResolveReadPlan>(call.value());
+}
+
+core::Result<std::vector<BatchOpResult>> RemoteMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    auto call = SendMessage("POST", "/internal/v1/batch", BatchRequest{ops});
+    if (!call.ok()) {
+        return call.error();
+    }
+    const auto status = call.value().status;
+    if (status == 200) {
+        auto reply = ReadReply<BatchResponse>(call.value());
+        if (!reply.ok()) {
+            return reply.error();
+        }
+        if (reply.value().results.size() != ops.size()) {
+            return HttpError("batch response does not match ops");
+        }
+        return std::move(reply.value().results);
+    }
+    // The service names the failing op in its message; keep it and map the status back.
+    const auto message = ErrorMessage(call.value());
+    switch (status) {
+        case 400:
+            return core::Error{core::ErrorCode::kInvalidArgument, message};
+        case 404:
+            return core::Error{core::ErrorCode::kNotFound, message};
+        case 409:
+            return core::Error{core::ErrorCode::kFailedPrecondition, message};
+        default:
+            return HttpError("metadata batch failed: " + message);
+    }
+}
+
+core::Result<ChangePage> RemoteMetadataStore::ReadChanges(const std::string& cursor,
+                                                          int wait_ms) {
+    std::string cursor_enc;
+    Poco::URI::encode(cursor, "", cursor_enc);
+    auto call = SendToLeader("GET",
+                             "/internal/v1/changes?cursor=" + cursor_enc +
+                                 "&wait_ms=" + std::to_string(wait_ms),
+                             "", "");
+    if (!call.ok()) {
+        return call.error();
+    }
+    if (call.value().status != 200) {
+        return HttpError("read changes failed: " + ErrorMessage(call.value()));
+    }
+    auto reply = ReadReply<ChangesResponse>(call.value());
+    if (!reply.ok()) {
+        return reply.error();
+    }
+    auto& changes = reply.value();
+    return ChangePage{std::move(changes.cursor), changes.reset, std::move(changes.events),
+                      changes.head};
 }
 
 }  // namespace nebulafs::metadata
@@ -0,0 +1,643 @@
+#include "nebulafs/metadata/replica_group.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+
+#include "nebulafs/core/logger.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr std::size_t kMaxFetchEntries = 1024;
+constexpr std::size_t kMaxApplyEntries = 256;
+
+core::Error Unavailable(const std::string& message) {
+    return core::Error{core::ErrorCode::kUnavailable, message};
+}
+
+// Replaces `path` with `contents` through an fsynced temporary file.
+bool WriteFileDurably(const std::string& path, const std::string& contents) {
+    const auto temp_path = path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fwrite(contents.data(), 1, contents.size(), file);
+    std::fflush(file);
+#ifdef _WIN32
+    ::_commit(::_fileno(file));
+#else
+    ::fsync(::fileno(file));
+#endif
+    std::fclose(file);
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    return !ec;
+}
+
+// Starts `call` for every peer concurrently; the caller collects the futures in peer order.
+template <typename Call>
+auto FanOut(const std::vector<std::string>& peers, Call call) {
+    using ResultType = decltype(call(peers.front()));
+    std::vector<std::future<ResultType>> pending;
+    pending.reserve(peers.size());
+    for (const auto& peer : peers) {
+        pending.push_back(std::async(std::launch::async, [call, &peer] { return call(peer); }));
+    }
+    return pending;
+}
+
+}  // namespace
+
+ReplicaGroup::ReplicaGroup(ReplicaOptions options, std::shared_ptr<ReplicaTransport> transport,
+                           ApplyFn apply)
+    : options_(std::move(options)),
+      transport_(std::move(transport)),
+      apply_(std::move(apply)),
+      log_((std::filesystem::path(options_.state_dir) / "log").string(),
+           options_.retain_entries) {
+    LoadState();
+}
+
+ReplicaGroup::~ReplicaGroup() {
+    Stop();
+}
+
+void ReplicaGroup::Start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tick_thread_.joinable()) {
+            return;
+        }
+        stopping_ = false;
+        ResetElectionDeadline();
+    }
+    tick_thread_ = std::thread([this] { TickLoop(); });
+    fetch_thread_ = std::thread([this] { FetchLoop(); });
+    apply_thread_ = std::thread([this] { ApplyLoop(); });
+}
+
+void ReplicaGroup::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    changed_cv_.notify_all();
+    if (tick_thread_.joinable()) {
+        tick_thread_.join();
+    }
+    if (fetch_thread_.joinable()) {
+        fetch_thread_.join();
+    }
+    if (apply_thread_.joinable()) {
+        apply_thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    PersistApplied();
+}
+
+void ReplicaGroup::LoadState() {
+    std::ifstream in(std::filesystem::path(options_.state_dir) / "state");
+    std::uint64_t term = 0;
+    if (in >> term) {
+        term_ = term;
+        in >> voted_for_;
+    }
+    // The log may hold entries from a term whose state write was lost; never go below them.
+    term_ = std::max(term_, log_.last_term());
+    std::ifstream applied(std::filesystem::path(options_.state_dir) / "applied");
+    std::uint64_t index = 0;
+    if (applied >> index) {
+        // Only committed entries are ever applied.
+        applied_index_ = index;
+        commit_index_ = index;
+    }
+}
+
+void ReplicaGroup::PersistState() {
+    // A vote must survive a crash, or a restarted member could vote twice in one term.
+    const auto path = (std::filesystem::path(options_.state_dir) / "state").string();
+    if (!WriteFileDurably(path, std::to_string(term_) + "\n" + voted_for_ + "\n")) {
+        core::LogError("replication: failed to persist term " + std::to_string(term_));
+    }
+}
+
+void ReplicaGroup::PersistApplied() {
+    const auto path = (std::filesystem::path(options_.state_dir) / "applied").string();
+    if (!WriteFileDurably(path, std::to_string(applied_index_) + "\n")) {
+        core::LogError("replication: failed to persist applied index " +
+                       std::to_string(applied_index_));
+    }
+    applied_persisted_at_ = Clock::now();
+}
+
+void ReplicaGroup::StepDown(std::uint64_t term) {
+    if (term > term_) {
+        term_ = term;
+        voted_for_.clear();
+        leader_.clear();
+        verified_index_ = 0;
+        PersistState();
+    }
+    if (role_ == Role::kLeader) {
+        core::LogInfo("replication: stepping down in term " + std::to_string(term_));
+    }
+    role_ = Role::kFollower;
+    match_index_.clear();
+    last_contact_.clear();
+    ResetElectionDeadline();
+    changed_cv_.notify_all();
+}
+
+void ReplicaGroup::ResetElectionDeadline() {
+    // Randomized so that members rarely time out together and split the vote.
+    thread_local std::mt19937 rng{std::random_device{}()};
+    std::uniform_int_distribution<int> jitter(0, options_.election_timeout_ms);
+    election_deadline_ = Clock::now() +
+                         std::chrono::milliseconds(options_.election_timeout_ms + jitter(rng));
+}
+
+bool ReplicaGroup::HasLease(Clock::time_point now) const {
+    // Followers only elect someone else after an election timeout without hearing from us, so
+    // a majority acknowledgement within that window means no newer leader can exist yet.
+    const auto horizon = now - std::chrono::milliseconds(options_.election_timeout_ms);
+    std::size_t fresh = 1;
+    for (const auto& [peer, contact] : last_contact_) {
+        if (contact >= horizon) {
+            ++fresh;
+        }
+    }
+    return fresh >= Majority();
+}
+
+void ReplicaGroup::AdvanceCommit() {
+    std::vector<std::uint64_t> matched{log_.last_index()};
+    for (const auto& peer : options_.peers) {
+        const auto it = match_index_.find(peer);
+        matched.push_back(it == match_index_.end() ? 0 : it->second);
+    }
+    std::sort(matched.begin(), matched.end(), std::greater<>());
+    const auto candidate = matched[Majority() - 1];
+    // Entries from earlier terms commit indirectly, once an entry of this term does.
+    if (candidate > commit_index_ && log_.TermAt(candidate) == term_) {
+        commit_index_ = candidate;
+        changed_cv_.notify_all();
+    }
+}
+
+core::Result<std::uint64_t> ReplicaGroup::Append(std::string payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (role_ != Role::kLeader) {
+        return Unavailable("not leader");
+    }
+    ReplicationEntry entry{log_.last_index() + 1, term_, std::move(payload)};
+    const auto index = entry.index;
+    auto appended = log_.Append({std::move(entry)});
+    if (!appended.ok()) {
+        return appended.error();
+    }
+    reserved_[index] = term_;
+    AdvanceCommit();
+    changed_cv_.notify_all();
+    return index;
+}
+
+core::Result<void> ReplicaGroup::CommitAndApply(std::uint64_t index,
+                                                const std::function<void()>& apply) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto reserved = reserved_.find(index);
+    if (reserved == reserved_.end()) {
+        return Unavailable("entry " + std::to_string(index) + " is not awaiting its appender");
+    }
+    const auto term = reserved->second;
+    const auto release = [&] {
+        // From here the apply thread applies the entry if it commits after all.
+        const auto it = reserved_.find(index);
+        if (it != reserved_.end() && it->second == term) {
+            reserved_.erase(it);
+        }
+        changed_cv_.notify_all();
+    };
+    const auto deadline = Clock::now() + std::chrono::milliseconds(options_.commit_timeout_ms);
+    changed_cv_.wait_until(lock, deadline, [&] {
+        return stopping_ || commit_index_ >= index || role_ != Role::kLeader || term_ != term;
+    });
+    if (commit_index_ < index || log_.TermAt(index) != term) {
+        release();
+        if (role_ != Role::kLeader || term_ != term) {
+            return Unavailable("leadership lost before commit");
+        }
+        return Unavailable("timed out waiting for a replication quorum");
+    }
+    // Committed entries are never truncated, and nobody else applies this one, so the wait
+    // ends once every earlier entry is applied.
+    changed_cv_.wait(lock, [&] { return stopping_ || applied_index_ + 1 >= index; });
+    if (applied_index_ + 1 != index) {
+        release();
+        return Unavailable("replica stopped before applying a committed entry");
+    }
+    lock.unlock();
+    apply();
+    lock.lock();
+    reserved_.erase(index);
+    MarkApplied(index);
+    return core::Ok();
+}
+
+bool ReplicaGroup::IsReserved(std::uint64_t index) const {
+    // A reservation from an older term names an entry a later leader has since replaced.
+    const auto it = reserved_.find(index);
+    return it != reserved_.end() && log_.TermAt(index) == it->second;
+}
+
+void ReplicaGroup::MarkApplied(std::uint64_t index) {
+    applied_index_ = index;
+    // Persisted at most once per heartbeat interval: after a crash, entries applied since the
+    // last write are applied again, which the apply callback tolerates.
+    if (Clock::now() - applied_persisted_at_ >=
+        std::chrono::milliseconds(options_.heartbeat_interval_ms)) {
+        PersistApplied();
+    }
+    changed_cv_.notify_all();
+}
+
+core::Result<void> ReplicaGroup::AwaitReadable(std::uint64_t min_index, int wait_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto readable = [&] {
+        const auto now = Clock::now();
+        if (role_ == Role::kLeader) {
+            // Entries from earlier terms may still be unapplied until this term's first commits.
+            return HasLease(now) && applied_index_ >= std::max(min_index, term_start_index_);
+        }
+        return !diverged_ && applied_index_ >= min_index &&
+               now - caught_up_at_ <= std::chrono::milliseconds(options_.max_staleness_ms);
+    };
+    const auto deadline = Clock::now() + std::chrono::milliseconds(std::max(0, wait_ms));
+    if (changed_cv_.wait_until(lock, deadline, [&] { return stopping_ || readable(); }) &&
+        !stopping_) {
+        return core::Ok();
+    }
+    if (diverged_) {
+        return Unavailable("replica diverged from the leader and must be re-seeded");
+    }
+    return Unavailable(role_ == Role::kLeader ? "leader lease expired" : "replica is stale");
+}
+
+bool ReplicaGroup::IsLeader() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return role_ == Role::kLeader;
+}
+
+std::string ReplicaGroup::leader() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return leader_;
+}
+
+ReplicaStatus ReplicaGroup::Status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ReplicaStatus status;
+    status.role = role_ == Role::kLeader      ? "leader"
+                  : role_ == Role::kCandidate ? "candidate"
+                                              : "follower";
+    status.term = term_;
+    status.leader = leader_;
+    status.last_index = log_.last_index();
+    status.commit_index = commit_index_;
+    status.applied_index = applied_index_;
+    status.diverged = diverged_;
+    return status;
+}
+
+VoteResponse ReplicaGroup::HandleVote(const VoteRequest& request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (request.term < term_) {
+        return VoteResponse{term_, false};
+    }
+    if (request.term > term_) {
+        StepDown(request.term);
+    }
+    const bool up_to_date =
+        request.last_term > log_.last_term() ||
+        (request.last_term == log_.last_term() && request.last_index >= log_.last_index());
+    if (up_to_date && (voted_for_.empty() || voted_for_ == request.candidate)) {
+        voted_for_ = request.candidate;
+        PersistState();
+        ResetElectionDeadline();
+        return VoteResponse{term_, true};
+    }
+    return VoteResponse{term_, false};
+}
+
+HeartbeatResponse ReplicaGroup::HandleHeartbeat(const HeartbeatRequest& request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (request.term < term_) {
+        return HeartbeatResponse{term_, false};
+    }
+    if (request.term > term_ || role_ != Role::kFollower) {
+        StepDown(request.term);
+    }
+    leader_ = request.leader;
+    commit_index_ = std::max(commit_index_, std::min(request.commit_index, verified_index_));
+    ResetElectionDeadline();
+    changed_cv_.notify_all();
+    return HeartbeatResponse{term_, true};
+}
+
+FetchResponse ReplicaGroup::HandleFetch(const FetchRequest& request) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    FetchResponse response;
+    if (request.term > term_) {
+        StepDown(request.term);
+    }
+    if (role_ != Role::kLeader) {
+        response.term = term_;
+        response.leader = leader_;
+        return response;
+    }
+    // A member still in our term (or older) has not voted for a newer leader, so its fetch
+    // doubles as an acknowledgement for the read lease.
+    if (std::find(options_.peers.begin(), options_.peers.end(), request.follower) !=
+        options_.peers.end()) {
+        last_contact_[request.follower] = Clock::now();
+    }
+    if (request.after > log_.last_index() || log_.TermAt(request.after) != request.after_term) {
+        response.status = FetchStatus::kDiverged;
+        response.term = term_;
+        response.leader = options_.self_url;
+        return response;
+    }
+    auto& matched = match_index_[request.follower];
+    matched = std::max(matched, request.after);
+    AdvanceCommit();
+    if (request.after == log_.last_index() && request.wait_ms > 0) {
+        const auto term = term_;
+        changed_cv_.wait_for(lock, std::chrono::milliseconds(request.wait_ms), [&] {
+            return stopping_ || term_ != term || log_.last_index() > request.after;
+        });
+        if (role_ != Role::kLeader || term_ != term) {
+            response.term = term_;
+            response.leader = leader_;
+            return response;
+        }
+    }
+    auto entries = log_.ReadAfter(request.after, kMaxFetchEntries);
+    response.term = term_;
+    response.leader = options_.self_url;
+    if (!entries) {
+        response.status = FetchStatus::kDiverged;
+        return response;
+    }
+    response.status = FetchStatus::kOk;
+    response.commit_index = commit_index_;
+    response.last_index = log_.last_index();
+    response.entries = std::move(*entries);
+    return response;
+}
+
+void ReplicaGroup::TickLoop() {
+    const auto interval = std::chrono::milliseconds(options_.heartbeat_interval_ms);
+    while (true) {
+        bool lead = false;
+        bool elect = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_cv_.wait_for(lock, interval, [this] { return stopping_; })) {
+                return;
+            }
+            lead = role_ == Role::kLeader;
+            elect = !lead && Clock::now() >= election_deadline_;
+        }
+        if (lead) {
+            SendHeartbeats();
+        } else if (elect) {
+            RunElection();
+        }
+    }
+}
+
+void ReplicaGroup::RunElection() {
+    VoteRequest request;
+    Clock::time_point started;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || role_ == Role::kLeader) {
+            return;
+        }
+        ++term_;
+        role_ = Role::kCandidate;
+        voted_for_ = options_.self_url;
+        leader_.clear();
+        PersistState();
+        ResetElectionDeadline();
+        request = VoteRequest{term_, options_.self_url, log_.last_index(), log_.last_term()};
+        started = Clock::now();
+    }
+    core::LogInfo("replication: starting election for term " + std::to_string(request.term));
+    auto pending = FanOut(options_.peers, [&](const std::string& peer) {
+        return transport_->RequestVote(peer, request);
+    });
+    std::vector<std::string> voters;
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        auto response = pending[i].get();
+        if (!response.ok()) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (response.value().term > term_) {
+            StepDown(response.value().term);
+        } else if (response.value().granted) {
+            voters.push_back(options_.peers[i]);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (role_ != Role::kCandidate || term_ != request.term || voters.size() + 1 < Majority()) {
+        return;
+    }
+    role_ = Role::kLeader;
+    leader_ = options_.self_url;
+    match_index_.clear();
+    last_contact_.clear();
+    for (const auto& voter : voters) {
+        last_contact_[voter] = started;
+    }
+    // Raft's no-op: committing an entry of the new term also commits everything before it.
+    auto appended = log_.Append({ReplicationEntry{log_.last_index() + 1, term_, {}}});
+    if (!appended.ok()) {
+        core::LogError("replication: failed to start term: " + appended.error().message);
+        StepDown(term_);
+        return;
+    }
+    core::LogInfo("replication: elected leader for term " + std::to_string(term_));
+    term_start_index_ = log_.last_index();
+    AdvanceCommit();
+    changed_cv_.notify_all();
+}
+
+void ReplicaGroup::SendHeartbeats() {
+    HeartbeatRequest request;
+    Clock::time_point started;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (role_ != Role::kLeader) {
+            return;
+        }
+        request = HeartbeatRequest{term_, options_.self_url, commit_index_};
+        started = Clock::now();
+    }
+    auto pending = FanOut(options_.peers, [&](const std::string& peer) {
+        return transport_->Heartbeat(peer, request);
+    });
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        auto response = pending[i].get();
+        if (!response.ok()) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (response.value().term > term_) {
+            StepDown(response.value().term);
+        } else if (response.value().accepted && role_ == Role::kLeader &&
+                   term_ == request.term) {
+            // Lease time counts from when the heartbeat was sent, not when it was answered.
+            auto& contact = last_contact_[options_.peers[i]];
+            contact = std::max(contact, started);
+            changed_cv_.notify_all();
+        }
+    }
+}
+
+void ReplicaGroup::FetchLoop() {
+    const auto interval = std::chrono::milliseconds(options_.heartbeat_interval_ms);
+    while (true) {
+        FetchRequest request;
+        std::string target;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            if (role_ == Role::kLeader || leader_.empty() || diverged_) {
+                stop_cv_.wait_for(lock, interval, [this] { return stopping_; });
+                continue;
+            }
+            target = leader_;
+            request = FetchRequest{term_, options_.self_url, log_.last_index(), log_.last_term(),
+                                   options_.heartbeat_interval_ms};
+        }
+
+        auto fetched = transport_->Fetch(target, request);
+        if (!fetched.ok()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_cv_.wait_for(lock, interval, [this] { return stopping_; });
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto& response = fetched.value();
+        if (response.term < term_) {
+            continue;
+        }
+        if (response.term > term_) {
+            StepDown(response.term);
+        }
+        if (response.status == FetchStatus::kNotLeader) {
+            if (leader_ == target && response.leader != options_.self_url) {
+                leader_ = response.leader;
+            }
+            continue;
+        }
+        if (role_ != Role::kFollower) {
+            continue;
+        }
+        leader_ = target;
+        ResetElectionDeadline();
+        if (response.status == FetchStatus::kDiverged) {
+            // Entries past the commit point may come from a leader that never committed them;
+            // dropping them and fetching again converges on this leader's log. Committed
+            // entries are in every later leader's log, so a conflict at or below the commit
+            // point means the leader no longer retains what this member needs.
+            if (request.after > commit_index_) {
+                auto truncated = log_.TruncateAfter(commit_index_);
+                if (truncated.ok()) {
+                    core::LogInfo("replication: dropped uncommitted entries " +
+                                  std::to_string(commit_index_ + 1) + "-" +
+                                  std::to_string(request.after) + " conflicting with leader " +
+                                  target);
+                    verified_index_ = std::min(verified_index_, commit_index_);
+                    continue;
+                }
+                core::LogError("replication: " + truncated.error().message);
+            }
+            diverged_ = true;
+            core::LogError("replication: log diverged from leader " + target +
+                           " at index " + std::to_string(request.after) +
+                           "; re-seed this replica");
+            changed_cv_.notify_all();
+            continue;
+        }
+        if (!response.entries.empty() && response.entries.front().index == log_.last_index() + 1) {
+            auto appended = log_.Append(response.entries);
+            if (!appended.ok()) {
+                core::LogError("replication: " + appended.error().message);
+                continue;
+            }
+        }
+        // The leader matched our log at `request.after` and sent what follows, so the whole
+        // log now matches the leader's.
+        verified_index_ = log_.last_index();
+        commit_index_ = std::max(commit_index_, std::min(response.commit_index, verified_index_));
+        if (log_.last_index() >= response.last_index) {
+            caught_up_at_ = Clock::now();
+        }
+        changed_cv_.notify_all();
+    }
+}
+
+void ReplicaGroup::ApplyLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        changed_cv_.wait(lock, [this] {
+            return stopping_ || (!diverged_ && applied_index_ < commit_index_ &&
+                                 !IsReserved(applied_index_ + 1));
+        });
+        if (stopping_) {
+            return;
+        }
+        auto entries = log_.ReadAfter(applied_index_, kMaxApplyEntries);
+        if (!entries) {
+            diverged_ = true;
+            core::LogError("replication: committed entries after " +
+                           std::to_string(applied_index_) +
+                           " are no longer retained; re-seed this replica");
+            changed_cv_.notify_all();
+            continue;
+        }
+        // Stop at the commit point and at the first entry its appender applies itself.
+        auto end = entries->begin();
+        while (end != entries->end() && end->index <= commit_index_ && !IsReserved(end->index)) {
+            ++end;
+        }
+        entries->erase(end, entries->end());
+        lock.unlock();
+        for (const auto& entry : *entries) {
+            if (!entry.payload.empty()) {
+                apply_(entry);
+            }
+        }
+        lock.lock();
+        MarkApplied(entries->back().index);
+    }
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,579 @@
+#include "nebulafs/metadata/replicated_metadata_store.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "nebulafs/core/logger.h"
+#include "nebulafs/core/time.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/observability/metrics.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Logged operations carry the caller's arguments rather than resulting rows, so followers
+// run the same store code path; timestamps come from the leader via `ScopedClockOverride`.
+enum class OpType : std::uint8_t {
+    kCreateBucket = 1,
+    kUpsertObject = 2,
+    kDeleteObject = 3,
+    kCreateUpload = 4,
+    kUpdateUploadState = 5,
+    kDeleteUpload = 6,
+    kUpsertPart = 7,
+    kDeleteParts = 8,
+    kConfigureNodes = 9,
+    kCommitWrite = 10,
+    kBatch = 11,
+    // A batch whose ops also carry the lease fields; `kBatch` entries predate them.
+    kLeaseBatch = 12,
+    // A batch whose ops carry the lease fields, the declared part size and manifest segments.
+    kManifestBatch = 13,
+    // A manifest batch whose ops also carry the copy source, written for batches that copy or
+    // delete objects so older members refuse the entry instead of misreading its ops.
+    kCopyBatch = 14,
+    // A copy batch whose ops also carry the expiry of an upload they create.
+    kUploadBatch = 15,
+};
+
+thread_local std::uint64_t t_last_write_index = 0;
+
+core::ByteWriter Operation(OpType type) {
+    core::ByteWriter operation;
+    operation.PutU8(static_cast<std::uint8_t>(type));
+    return operation;
+}
+
+bool GetInt(core::ByteReader& reader, int& value) {
+    std::uint32_t raw = 0;
+    if (!reader.GetU32(raw)) {
+        return false;
+    }
+    value = static_cast<int>(raw);
+    return true;
+}
+
+bool GetStrings(core::ByteReader& reader, std::vector<std::string>& values) {
+    std::uint32_t count = 0;
+    if (!reader.GetU32(count)) {
+        return false;
+    }
+    values.resize(count);
+    for (auto& value : values) {
+        if (!reader.GetString(value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GetReplicas(core::ByteReader& reader, std::vector<ReplicaTarget>& replicas) {
+    std::uint32_t count = 0;
+    if (!reader.GetU32(count)) {
+        return false;
+    }
+    replicas.resize(count);
+    for (auto& replica : replicas) {
+        if (!GetInt(reader, replica.node_id) || !GetInt(reader, replica.replica_index) ||
+            !reader.GetString(replica.endpoint)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PutReplicas(core::ByteWriter& writer, const std::vector<ReplicaTarget>& replicas) {
+    writer.PutU32(static_cast<std::uint32_t>(replicas.size()));
+    for (const auto& replica : replicas) {
+        writer.PutU32(static_cast<std::uint32_t>(replica.node_id));
+        writer.PutU32(static_cast<std::uint32_t>(replica.replica_index));
+        writer.PutString(replica.endpoint);
+    }
+}
+
+void PutSegments(core::ByteWriter& writer, const std::vector<ManifestSegment>& segments) {
+    writer.PutU32(static_cast<std::uint32_t>(segments.size()));
+    for (const auto& segment : segments) {
+        writer.PutString(segment.blob_id);
+        writer.PutU64(segment.offset);
+        writer.PutU64(segment.size_bytes);
+        writer.PutString(segment.etag);
+        PutReplicas(writer, segment.replicas);
+    }
+}
+
+bool GetSegments(core::ByteReader& reader, std::vector<ManifestSegment>& segments) {
+    std::uint32_t count = 0;
+    if (!reader.GetU32(count)) {
+        return false;
+    }
+    segments.resize(count);
+    for (auto& segment : segments) {
+        if (!reader.GetString(segment.blob_id) || !reader.GetU64(segment.offset) ||
+            !reader.GetU64(segment.size_bytes) || !reader.GetString(segment.etag) ||
+            !GetReplicas(reader, segment.replicas)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Each entry type carries the op fields of the one before it plus its own.
+void PutBatchOps(core::ByteWriter& writer, const std::vector<BatchOp>& ops, OpType format) {
+    const bool with_leases = format != OpType::kBatch;
+    writer.PutU32(static_cast<std::uint32_t>(ops.size()));
+    for (const auto& op : ops) {
+        writer.PutU8(static_cast<std::uint8_t>(op.type));
+        writer.PutString(op.bucket);
+        writer.PutString(op.object_name);
+        writer.PutString(op.upload_id);
+        writer.PutString(op.state);
+        writer.PutString(op.expect_upload_state);
+        writer.PutU32(static_cast<std::uint32_t>(op.replication_factor));
+        writer.PutString(op.service_token);
+        writer.PutString(op.blob_id);
+        writer.PutU64(op.size_bytes);
+        writer.PutString(op.etag);
+        PutReplicas(writer, op.replicas);
+        if (with_leases) {
+            writer.PutString(op.lease);
+            writer.PutString(op.lease_holder);
+            writer.PutU64(op.lease_ttl_ms);
+            writer.PutU64(op.fencing_token);
+            writer.PutU64(op.now_ms);
+        }
+        if (format >= OpType::kManifestBatch) {
+            writer.PutU64(op.part_size);
+            PutSegments(writer, op.segments);
+        }
+        if (format >= OpType::kCopyBatch) {
+            writer.PutString(op.source_bucket);
+            writer.PutString(op.source_object);
+        }
+        if (format >= OpType::kUploadBatch) {
+            writer.PutString(op.expires_at);
+        }
+    }
+}
+
+bool GetBatchOps(core::ByteReader& reader, std::vector<BatchOp>& ops, OpType format) {
+    const bool with_leases = format != OpType::kBatch;
+    std::uint32_t count = 0;
+    if (!reader.GetU32(count)) {
+        return false;
+    }
+    ops.resize(count);
+    for (auto& op : ops) {
+        std::uint8_t type = 0;
+        if (!reader.GetU8(type) || !reader.GetString(op.bucket) ||
+            !reader.GetString(op.object_name) || !reader.GetString(op.upload_id) ||
+            !reader.GetString(op.state) || !reader.GetString(op.expect_upload_state) ||
+            !GetInt(reader, op.replication_factor) || !reader.GetString(op.service_token) ||
+            !reader.GetString(op.blob_id) || !reader.GetU64(op.size_bytes) ||
+            !reader.GetString(op.etag) || !GetReplicas(reader, op.replicas)) {
+            return false;
+        }
+        if (with_leases &&
+            (!reader.GetString(op.lease) || !reader.GetString(op.lease_holder) ||
+             !reader.GetU64(op.lease_ttl_ms) || !reader.GetU64(op.fencing_token) ||
+             !reader.GetU64(op.now_ms))) {
+            return false;
+        }
+        if (format >= OpType::kManifestBatch &&
+            (!reader.GetU64(op.part_size) || !GetSegments(reader, op.segments))) {
+            return false;
+        }
+        if (format >= OpType::kCopyBatch &&
+            (!reader.GetString(op.source_bucket) || !reader.GetString(op.source_object))) {
+            return false;
+        }
+        if (format >= OpType::kUploadBatch && !reader.GetString(op.expires_at)) {
+            return false;
+        }
+        op.type = static_cast<BatchOpType>(type);
+    }
+    return true;
+}
+
+}  // namespace
+
+ReplicatedMetadataStore::ReplicatedMetadataStore(std::shared_ptr<MetadataStore> store,
+                                                 ReplicaOptions options,
+                                                 std::shared_ptr<ReplicaTransport> transport)
+    : store_(std::move(store)) {
+    group_ = std::make_unique<ReplicaGroup>(std::move(options), std::move(transport),
+                                            [this](const ReplicationEntry& entry) { Apply(entry); });
+    group_->Start();
+}
+
+ReplicatedMetadataStore::~ReplicatedMetadataStore() {
+    group_->Stop();
+}
+
+std::uint64_t ReplicatedMetadataStore::LastWriteIndex() {
+    return t_last_write_index;
+}
+
+void ReplicatedMetadataStore::ResetLastWriteIndex() {
+    t_last_write_index = 0;
+}
+
+template <typename Run>
+auto ReplicatedMetadataStore::Mutate(core::ByteWriter operation, Run run) -> decltype(run()) {
+    // The operation is logged before it runs anywhere, so a write that never commits never
+    // reaches a store. An operation the store rejects is logged too and fails the same way on
+    // every member.
+    std::unique_lock<std::mutex> lock(write_mutex_);
+    const auto now = core::NowIso8601();
+    core::ByteWriter payload;
+    payload.PutString(now);
+    payload.PutRaw(operation.data());
+    auto index = group_->Append(payload.Take());
+    lock.unlock();
+    if (!index.ok()) {
+        return index.error();
+    }
+    std::optional<decltype(run())> result;
+    auto applied = group_->CommitAndApply(index.value(), [&] {
+        core::ScopedClockOverride clock(now);
+        result.emplace(run());
+    });
+    if (!applied.ok()) {
+        return applied.error();
+    }
+    if (!result->ok()) {
+        observability::RecordMetadataReplicationApplyFailure(false);
+    }
+    t_last_write_index = index.value();
+    return std::move(*result);
+}
+
+void ReplicatedMetadataStore::Apply(const ReplicationEntry& entry) {
+    core::ByteReader reader(entry.payload);
+    std::string now;
+    std::uint8_t type = 0;
+    if (!reader.GetString(now) || !reader.GetU8(type)) {
+        core::LogError("replication: undecodable entry " + std::to_string(entry.index));
+        return;
+    }
+    core::ScopedClockOverride clock(now);
+    core::Result<void> applied;
+    bool decoded = false;
+    switch (static_cast<OpType>(type)) {
+        case OpType::kCreateBucket: {
+            std::string name;
+            if ((decoded = reader.GetString(name))) {
+                auto created = store_->CreateBucket(name);
+                applied = created.ok() ? core::Ok() : core::Result<void>(created.error());
+            }
+            break;
+        }
+        case OpType::kUpsertObject: {
+            std::string bucket;
+            ObjectMetadata object;
+            if ((decoded = reader.GetString(bucket) && reader.GetString(object.name) &&
+                           reader.GetU64(object.size_bytes) && reader.GetString(object.etag))) {
+                auto upserted = store_->UpsertObject(bucket, object);
+                applied = upserted.ok() ? core::Ok() : core::Result<void>(upserted.error());
+            }
+            break;
+        }
+        case OpType::kDeleteObject: {
+            std::string bucket;
+            std::string object;
+            if ((decoded = reader.GetString(bucket) && reader.GetString(object))) {
+                applied = store_->DeleteObject(bucket, object);
+            }
+            break;
+        }
+        case OpType::kCreateUpload: {
+            std::string bucket;
+            std::string upload_id;
+            std::string object_name;
+            std::string expires_at;
+            if ((decoded = reader.GetString(bucket) && reader.GetString(upload_id) &&
+                           reader.GetString(object_name) && reader.GetString(expires_at))) {
+                auto created =
+                    store_->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+                applied = created.ok() ? core::Ok() : core::Result<void>(created.error());
+            }
+            break;
+        }
+        case OpType::kUpdateUploadState: {
+            std::string upload_id;
+            std::string state;
+            if ((decoded = reader.GetString(upload_id) && reader.GetString(state))) {
+                applied = store_->UpdateMultipartUploadState(upload_id, state);
+            }
+            break;
+        }
+        case OpType::kDeleteUpload: {
+            std::string upload_id;
+            if ((decoded = reader.GetString(upload_id))) {
+                applied = store_->DeleteMultipartUpload(upload_id);
+            }
+            break;
+        }
+        case OpType::kUpsertPart: {
+            std::string upload_id;
+            int part_number = 0;
+            std::uint64_t size_bytes = 0;
+            std::string etag;
+            std::string temp_path;
+            if ((decoded = reader.GetString(upload_id) && GetInt(reader, part_number) &&
+                           reader.GetU64(size_bytes) && reader.GetString(etag) &&
+                           reader.GetString(temp_path))) {
+                auto upserted =
+                    store_->UpsertMultipartPart(upload_id, part_number, size_bytes, etag, temp_path);
+                applied = upserted.ok() ? core::Ok() : core::Result<void>(upserted.error());
+            }
+            break;
+        }
+        case OpType::kDeleteParts: {
+            std::string upload_id;
+            if ((decoded = reader.GetString(upload_id))) {
+                applied = store_->DeleteMultipartParts(upload_id);
+            }
+            break;
+        }
+        case OpType::kConfigureNodes: {
+            std::vector<std::string> endpoints;
+            if ((decoded = GetStrings(reader, endpoints))) {
+                applied = store_->ConfigureStorageNodes(endpoints);
+            }
+            break;
+        }
+        case OpType::kCommitWrite: {
+            std::string bucket;
+            std::string object_name;
+            std::string blob_id;
+            std::uint64_t size_bytes = 0;
+            std::string etag;
+            std::vector<ReplicaTarget> replicas;
+            if ((decoded = reader.GetString(bucket) && reader.GetString(object_name) &&
+                           reader.GetString(blob_id) && reader.GetU64(size_bytes) &&
+                           reader.GetString(etag) && GetReplicas(reader, replicas))) {
+                applied = store_->CommitWrite(bucket, object_name, blob_id, size_bytes, etag,
+                                              replicas);
+            }
+            break;
+        }
+        case OpType::kBatch:
+        case OpType::kLeaseBatch:
+        case OpType::kManifestBatch:
+        case OpType::kCopyBatch:
+        case OpType::kUploadBatch: {
+            std::vector<BatchOp> ops;
+            if ((decoded = GetBatchOps(reader, ops, static_cast<OpType>(type)))) {
+                auto executed = store_->ExecuteBatch(ops);
+                applied = executed.ok() ? core::Ok() : core::Result<void>(executed.error());
+            }
+            break;
+        }
+    }
+    if (!decoded) {
+        core::LogError("replication: undecodable entry " + std::to_string(entry.index));
+        return;
+    }
+    if (applied.ok()) {
+        return;
+    }
+    // Operations the leader's store rejected fail here the same way. Anything beyond that
+    // (including replays after a crash, before the applied index was persisted) means this
+    // store and the leader's disagree, so every failure is counted.
+    observability::RecordMetadataReplicationApplyFailure(true);
+    const auto message = "replication: entry " + std::to_string(entry.index) +
+                         " failed to apply: " + applied.error().message;
+    const auto code = applied.error().code;
+    if (code == core::ErrorCode::kNotFound || code == core::ErrorCode::kAlreadyExists ||
+        code == core::ErrorCode::kFailedPrecondition) {
+        core::LogInfo(message);
+    } else {
+        core::LogError(message);
+    }
+}
+
+core::Result<Bucket> ReplicatedMetadataStore::CreateBucket(const std::string& name) {
+    auto operation = Operation(OpType::kCreateBucket);
+    operation.PutString(name);
+    return Mutate(std::move(operation), [&] { return store_->CreateBucket(name); });
+}
+
+core::Result<std::vector<Bucket>> ReplicatedMetadataStore::ListBuckets() {
+    return store_->ListBuckets();
+}
+
+core::Result<Bucket> ReplicatedMetadataStore::GetBucket(const std::string& name) {
+    return store_->GetBucket(name);
+}
+
+core::Result<ObjectMetadata> ReplicatedMetadataStore::UpsertObject(const std::string& bucket,
+                                                                   const ObjectMetadata& object) {
+    auto operation = Operation(OpType::kUpsertObject);
+    operation.PutString(bucket);
+    operation.PutString(object.name);
+    operation.PutU64(object.size_bytes);
+    operation.PutString(object.etag);
+    return Mutate(std::move(operation), [&] { return store_->UpsertObject(bucket, object); });
+}
+
+core::Result<ObjectMetadata> ReplicatedMetadataStore::GetObject(const std::string& bucket,
+                                                                const std::string& object) {
+    return store_->GetObject(bucket, object);
+}
+
+core::Result<std::vector<ObjectMetadata>> ReplicatedMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    return store_->ListObjects(bucket, prefix);
+}
+
+core::Result<ObjectListing> ReplicatedMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    return store_->ListObjectsPage(bucket, options);
+}
+
+core::Result<void> ReplicatedMetadataStore::DeleteObject(const std::string& bucket,
+                                                         const std::string& object) {
+    auto operation = Operation(OpType::kDeleteObject);
+    operation.PutString(bucket);
+    operation.PutString(object);
+    return Mutate(std::move(operation), [&] { return store_->DeleteObject(bucket, object); });
+}
+
+core::Result<MultipartUpload> ReplicatedMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    auto operation = Operation(OpType::kCreateUpload);
+    operation.PutString(bucket);
+    operation.PutString(upload_id);
+    operation.PutString(object_name);
+    operation.PutString(expires_at);
+    return Mutate(std::move(operation), [&] {
+        return store_->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+    });
+}
+
+core::Result<MultipartUpload> ReplicatedMetadataStore::GetMultipartUpload(
+    const std::string& upload_id) {
+    return store_->GetMultipartUpload(upload_id);
+}
+
+core::Result<std::vector<MultipartUpload>> ReplicatedMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    return store_->ListExpiredMultipartUploads(expires_before, limit);
+}
+
+core::Result<void> ReplicatedMetadataStore::UpdateMultipartUploadState(
+    const std::string& upload_id, const std::string& state) {
+    auto operation = Operation(OpType::kUpdateUploadState);
+    operation.PutString(upload_id);
+    operation.PutString(state);
+    return Mutate(std::move(operation),
+                  [&] { return store_->UpdateMultipartUploadState(upload_id, state); });
+}
+
+core::Result<void> ReplicatedMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    auto operation = Operation(OpType::kDeleteUpload);
+    operation.PutString(upload_id);
+    return Mutate(std::move(operation),
+                  [&] { return store_->DeleteMultipartUpload(upload_id); });
+}
+
+core::Result<MultipartPart> ReplicatedMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes,
+    const std::string& etag, const std::string& temp_path) {
+    auto operation = Operation(OpType::kUpsertPart);
+    operation.PutString(upload_id);
+    operation.PutU32(static_cast<std::uint32_t>(part_number));
+    operation.PutU64(size_bytes);
+    operation.PutString(etag);
+    operation.PutString(temp_path);
+    return Mutate(std::move(operation), [&] {
+        return store_->UpsertMultipartPart(upload_id, part_number, size_bytes, etag, temp_path);
+    });
+}
+
+core::Result<std::vector<MultipartPart>> ReplicatedMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    return store_->ListMultipartParts(upload_id);
+}
+
+core::Result<void> ReplicatedMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
+    auto operation = Operation(OpType::kDeleteParts);
+    operation.PutString(upload_id);
+    return Mutate(std::move(operation),
+                  [&] { return store_->DeleteMultipartParts(upload_id); });
+}
+
+core::Result<void> ReplicatedMetadataStore::ConfigureStorageNodes(
+    const std::vector<std::string>& endpoints) {
+    auto operation = Operation(OpType::kConfigureNodes);
+    operation.PutU32(static_cast<std::uint32_t>(endpoints.size()));
+    for (const auto& endpoint : endpoints) {
+        operation.PutString(endpoint);
+    }
+    return Mutate(std::move(operation),
+                  [&] { return store_->ConfigureStorageNodes(endpoints); });
+}
+
+core::Result<AllocateWritePlan> ReplicatedMetadataStore::AllocateWrite(
+    const std::string& bucket, const std::string& object_name, int replication_factor,
+    const std::string& service_token) {
+    // Allocation only reads placement state; the plan takes effect through `CommitWrite`.
+    return store_->AllocateWrite(bucket, object_name, replication_factor, service_token);
+}
+
+core::Result<void> ReplicatedMetadataStore::CommitWrite(
+    const std::string& bucket, const std::string& object_name, const std::string& blob_id,
+    std::uint64_t size_bytes, const std::string& etag,
+    const std::vector<ReplicaTarget>& replicas) {
+    auto operation = Operation(OpType::kCommitWrite);
+    operation.PutString(bucket);
+    operation.PutString(object_name);
+    operation.PutString(blob_id);
+    operation.PutU64(size_bytes);
+    operation.PutString(etag);
+    PutReplicas(operation, replicas);
+    return Mutate(std::move(operation), [&] {
+        return store_->CommitWrite(bucket, object_name, blob_id, size_bytes, etag, replicas);
+    });
+}
+
+core::Result<ResolveReadPlan> ReplicatedMetadataStore::ResolveRead(
+    const std::string& bucket, const std::string& object_name) {
+    return store_->ResolveRead(bucket, object_name);
+}
+
+core::Result<std::vector<BatchOpResult>> ReplicatedMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    if (IsReadOnlyBatch(ops)) {
+        return store_->ExecuteBatch(ops);
+    }
+    // The batch is one log entry, so followers apply it as one transaction too. Conditions
+    // re-evaluate to the leader's outcome because followers replay the same prefix of the log,
+    // and lease expiry is judged by the leader's clock, fixed here.
+    // Batches use the oldest entry type that holds their fields, which older members read.
+    auto stamped = ops;
+    auto format = OpType::kBatch;
+    for (auto& op : stamped) {
+        if (op.type == BatchOpType::kCreateMultipartUpload) {
+            format = std::max(format, OpType::kUploadBatch);
+        } else if (op.type == BatchOpType::kCopyObject || op.type == BatchOpType::kDeleteObject) {
+            format = std::max(format, OpType::kCopyBatch);
+        } else if (op.type == BatchOpType::kSetMultipartPartSize ||
+                   op.type == BatchOpType::kCommitManifest) {
+            format = std::max(format, OpType::kManifestBatch);
+        }
+        if (IsLeaseOp(op)) {
+            op.now_ms = LeaseClock(op);
+            format = std::max(format, OpType::kLeaseBatch);
+        }
+    }
+    auto operation = Operation(format);
+    PutBatchOps(operation, stamped, format);
+    return Mutate(std::move(operation), [&] { return store_->ExecuteBatch(stamped); });
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,254 @@
+#include "nebulafs/metadata/replication_log.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "nebulafs/core/binary_codec.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Frame: u32 payload size, u32 CRC-32C over index + term + payload, u64 index, u64 term, payload.
+constexpr std::size_t kFrameHeaderBytes = 24;
+constexpr std::uint32_t kMaxEntryBytes = 64u * 1024 * 1024;
+
+core::Error IoError(const std::string& message) {
+    return core::Error{core::ErrorCode::kIoError, message};
+}
+
+void AppendFrame(std::string& out, const ReplicationEntry& entry) {
+    core::ByteWriter position;
+    position.PutU64(entry.index);
+    position.PutU64(entry.term);
+    core::ByteWriter header;
+    header.PutU32(static_cast<std::uint32_t>(entry.payload.size()));
+    header.PutU32(core::Crc32c(entry.payload, core::Crc32c(position.data())));
+    out.append(header.data());
+    out.append(position.data());
+    out.append(entry.payload);
+}
+
+// Returns false at end of input and on a torn or corrupt frame.
+bool ReadFrame(std::istream& in, ReplicationEntry& entry) {
+    char header[kFrameHeaderBytes];
+    if (!in.read(header, kFrameHeaderBytes)) {
+        return false;
+    }
+    core::ByteReader reader(std::string_view(header, kFrameHeaderBytes));
+    std::uint32_t size = 0;
+    std::uint32_t crc = 0;
+    reader.GetU32(size);
+    reader.GetU32(crc);
+    reader.GetU64(entry.index);
+    reader.GetU64(entry.term);
+    if (size > kMaxEntryBytes) {
+        return false;
+    }
+    entry.payload.resize(size);
+    if (!in.read(entry.payload.data(), size)) {
+        return false;
+    }
+    return core::Crc32c(entry.payload, core::Crc32c(std::string_view(header + 8, 16))) == crc;
+}
+
+int OpenForAppend(const std::string& path) {
+#ifdef _WIN32
+    return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY,
+                   _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+bool WriteAndSync(int fd, std::string_view data) {
+    while (!data.empty()) {
+#ifdef _WIN32
+        const auto written = ::_write(fd, data.data(), static_cast<unsigned int>(data.size()));
+#else
+        const auto written = ::write(fd, data.data(), data.size());
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+#ifdef _WIN32
+    return ::_commit(fd) == 0;
+#elif defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+void CloseFile(int fd) {
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+}  // namespace
+
+ReplicationLog::ReplicationLog(std::string path, std::size_t retain_entries)
+    : path_(std::move(path)), retain_entries_(std::max<std::size_t>(retain_entries, 1)) {
+    const auto parent = std::filesystem::path(path_).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+    std::uintmax_t valid_bytes = 0;
+    {
+        std::ifstream in(path_, std::ios::binary);
+        ReplicationEntry entry;
+        while (in && ReadFrame(in, entry)) {
+            // A gap means the file was stitched together wrongly; keep only the clean prefix.
+            if (last_index_ != 0 && entry.index != last_index_ + 1) {
+                break;
+            }
+            valid_bytes += kFrameHeaderBytes + entry.payload.size();
+            last_index_ = entry.index;
+            last_term_ = entry.term;
+            ++file_entries_;
+            tail_.push_back(std::move(entry));
+            if (tail_.size() > retain_entries_) {
+                tail_.pop_front();
+            }
+        }
+    }
+    std::error_code ec;
+    if (std::filesystem::exists(path_, ec) &&
+        std::filesystem::file_size(path_, ec) != valid_bytes) {
+        std::filesystem::resize_file(path_, valid_bytes, ec);
+    }
+    fd_ = OpenForAppend(path_);
+    if (fd_ < 0) {
+        throw std::runtime_error("failed to open replication log: " + path_);
+    }
+}
+
+ReplicationLog::~ReplicationLog() {
+    if (fd_ >= 0) {
+        CloseFile(fd_);
+    }
+}
+
+core::Result<void> ReplicationLog::Append(const std::vector<ReplicationEntry>& entries) {
+    if (entries.empty()) {
+        return core::Ok();
+    }
+    std::string frames;
+    auto expected = last_index_ + 1;
+    for (const auto& entry : entries) {
+        if (entry.index != expected++) {
+            return core::Error{core::ErrorCode::kInvalidArgument,
+                               "replication log entries must be contiguous"};
+        }
+        AppendFrame(frames, entry);
+    }
+    if (!WriteAndSync(fd_, frames)) {
+        return IoError("failed to write replication log");
+    }
+    for (const auto& entry : entries) {
+        tail_.push_back(entry);
+    }
+    while (tail_.size() > retain_entries_) {
+        tail_.pop_front();
+    }
+    last_index_ = entries.back().index;
+    last_term_ = entries.back().term;
+    file_entries_ += entries.size();
+    if (file_entries_ > 2 * retain_entries_) {
+        return Compact();
+    }
+    return core::Ok();
+}
+
+core::Result<void> ReplicationLog::TruncateAfter(std::uint64_t index) {
+    if (index >= last_index_) {
+        return core::Ok();
+    }
+    const auto term = TermAt(index);
+    if (!term) {
+        return core::Error{core::ErrorCode::kInvalidArgument,
+                           "cannot truncate the replication log below its retained tail"};
+    }
+    while (!tail_.empty() && tail_.back().index > index) {
+        tail_.pop_back();
+    }
+    last_index_ = index;
+    last_term_ = *term;
+    // The file is append-only, so the surviving tail is rewritten in its place.
+    return Compact();
+}
+
+std::optional<std::uint64_t> ReplicationLog::TermAt(std::uint64_t index) const {
+    if (index == 0) {
+        return 0;
+    }
+    if (tail_.empty() || index < tail_.front().index || index > last_index_) {
+        return std::nullopt;
+    }
+    return tail_[static_cast<std::size_t>(index - tail_.front().index)].term;
+}
+
+std::optional<std::vector<ReplicationEntry>> ReplicationLog::ReadAfter(
+    std::uint64_t index, std::size_t max_entries) const {
+    std::vector<ReplicationEntry> entries;
+    if (index >= last_index_) {
+        return entries;
+    }
+    if (tail_.empty() || index + 1 < tail_.front().index) {
+        return std::nullopt;
+    }
+    auto offset = static_cast<std::size_t>(index + 1 - tail_.front().index);
+    while (offset < tail_.size() && entries.size() < max_entries) {
+        entries.push_back(tail_[offset++]);
+    }
+    return entries;
+}
+
+core::Result<void> ReplicationLog::Compact() {
+    // Rewrite only the retained tail; older entries are unreachable through `ReadAfter` anyway.
+    std::string frames;
+    for (const auto& entry : tail_) {
+        AppendFrame(frames, entry);
+    }
+    const auto temp_path = path_ + ".tmp";
+    std::error_code ec;
+    std::filesystem::remove(temp_path, ec);
+    const int temp_fd = OpenForAppend(temp_path);
+    if (temp_fd < 0) {
+        return IoError("failed to open replication log for compaction");
+    }
+    const bool written = WriteAndSync(temp_fd, frames);
+    CloseFile(temp_fd);
+    if (!written) {
+        return IoError("failed to write compacted replication log");
+    }
+    std::filesystem::rename(temp_path, path_, ec);
+    if (ec) {
+        return IoError("failed to replace replication log: " + ec.message());
+    }
+    CloseFile(fd_);
+    fd_ = OpenForAppend(path_);
+    if (fd_ < 0) {
+        return IoError("failed to reopen replication log");
+    }
+    file_entries_ = tail_.size();
+    return core::Ok();
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,56 @@
+#include "nebulafs/metadata/shard_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// FNV-1a finished with a 64-bit mixer. std::hash is not stable across builds, and every
+// gateway must compute the same owner for a bucket.
+std::uint64_t StableHash(std::string_view a, std::string_view b) {
+    std::uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](std::string_view part) {
+        for (const char c : part) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(a);
+    mix(std::string_view("\0", 1));
+    mix(b);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}  // namespace
+
+ShardMap::ShardMap(std::vector<std::string> endpoints) : endpoints_(std::move(endpoints)) {
+    if (endpoints_.empty()) {
+        throw std::invalid_argument("shard map must list at least one shard");
+    }
+    std::sort(endpoints_.begin(), endpoints_.end());
+    endpoints_.erase(std::unique(endpoints_.begin(), endpoints_.end()), endpoints_.end());
+}
+
+std::size_t ShardMap::ShardFor(std::string_view bucket) const {
+    std::size_t best = 0;
+    std::uint64_t best_score = 0;
+    for (std::size_t i = 0; i < endpoints_.size(); ++i) {
+        const auto score = StableHash(endpoints_[i], bucket);
+        if (i == 0 || score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+}  // namespace nebulafs::metadata
@@ -0,0 +1,401 @@
+#include "nebulafs/metadata/sharded_metadata_store.h"
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <utility>
+
+#include "nebulafs/metadata/metadata_batch.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Entries are dropped when an upload is deleted; the cap only bounds uploads abandoned without
+// a delete. A cleared entry costs one fan-out lookup.
+constexpr std::size_t kMaxCachedUploads = 65536;
+
+// Runs `call` against every shard concurrently; shard calls are blocking HTTP round trips.
+template <typename Call>
+auto FanOut(const std::vector<std::shared_ptr<MetadataStore>>& stores, Call call) {
+    using ResultType = decltype(call(*stores.front()));
+    std::vector<std::future<ResultType>> pending;
+    pending.reserve(stores.size());
+    for (const auto& store : stores) {
+        pending.push_back(std::async(std::launch::async, [&call, store] { return call(*store); }));
+    }
+    std::vector<ResultType> results;
+    results.reserve(pending.size());
+    for (auto& future : pending) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+core::Result<std::vector<BatchOpResult>> ExecuteSplitLeaseBatch(
+    MetadataStore& lease_store, MetadataStore& store, const std::vector<BatchOp>& ops) {
+    // The lease ops run first on their own shard. The writes they guard are still fenced, but
+    // not atomically: a lease lost between the two calls goes unnoticed by the second.
+    std::vector<BatchOp> lease_ops;
+    std::vector<BatchOp> other_ops;
+    for (const auto& op : ops) {
+        (IsLeaseOp(op) ? lease_ops : other_ops).push_back(op);
+    }
+    auto leased = lease_store.ExecuteBatch(lease_ops);
+    if (!leased.ok()) {
+        return leased.error();
+    }
+    auto executed = store.ExecuteBatch(other_ops);
+    if (!executed.ok()) {
+        return executed.error();
+    }
+    std::vector<BatchOpResult> results;
+    results.reserve(ops.size());
+    std::size_t next_lease = 0;
+    std::size_t next_other = 0;
+    for (const auto& op : ops) {
+        results.push_back(IsLeaseOp(op) ? std::move(leased.value()[next_lease++])
+                                        : std::move(executed.value()[next_other++]));
+    }
+    return results;
+}
+
+}  // namespace
+
+ShardedMetadataStore::ShardedMetadataStore(std::vector<std::string> endpoints,
+                                           ShardFactory factory)
+    : factory_(std::move(factory)) {
+    Reload(std::move(endpoints));
+}
+
+void ShardedMetadataStore::Reload(std::vector<std::string> endpoints) {
+    ShardMap map(std::move(endpoints));
+    auto previous = Current();
+    std::vector<std::shared_ptr<MetadataStore>> stores;
+    stores.reserve(map.size());
+    for (const auto& endpoint : map.endpoints()) {
+        std::shared_ptr<MetadataStore> store;
+        if (previous) {
+            const auto& old = previous->map.endpoints();
+            const auto it = std::lower_bound(old.begin(), old.end(), endpoint);
+            if (it != old.end() && *it == endpoint) {
+                store = previous->stores[static_cast<std::size_t>(it - old.begin())];
+            }
+        }
+        stores.push_back(store ? std::move(store) : factory_(endpoint));
+    }
+    auto next = std::make_shared<const Shards>(Shards{std::move(map), std::move(stores)});
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    shards_ = std::move(next);
+}
+
+std::vector<std::string> ShardedMetadataStore::endpoints() const {
+    return Current()->map.endpoints();
+}
+
+std::shared_ptr<const ShardedMetadataStore::Shards> ShardedMetadataStore::Current() const {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    return shards_;
+}
+
+std::shared_ptr<MetadataStore> ShardedMetadataStore::ForBucket(const std::string& bucket) const {
+    const auto shards = Current();
+    return shards->stores[shards->map.ShardFor(bucket)];
+}
+
+core::Result<std::shared_ptr<MetadataStore>> ShardedMetadataStore::ForUpload(
+    const std::string& upload_id) {
+    {
+        std::lock_guard<std::mutex> lock(uploads_mutex_);
+        auto it = upload_shards_.find(upload_id);
+        if (it != upload_shards_.end()) {
+            if (auto store = it->second.lock()) {
+                return store;
+            }
+            upload_shards_.erase(it);
+        }
+    }
+    // Uploads started by another gateway (or before a restart) are found by asking every shard.
+    const auto shards = Current();
+    auto found = FanOut(shards->stores,
+                        [&](MetadataStore& store) { return store.GetMultipartUpload(upload_id); });
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        if (found[i].ok()) {
+            RememberUpload(upload_id, shards->stores[i]);
+            return shards->stores[i];
+        }
+        if (found[i].error().code != core::ErrorCode::kNotFound) {
+            return found[i].error();
+        }
+    }
+    return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+}
+
+void ShardedMetadataStore::RememberUpload(const std::string& upload_id,
+                                          std::shared_ptr<MetadataStore> store) {
+    std::lock_guard<std::mutex> lock(uploads_mutex_);
+    if (upload_shards_.size() >= kMaxCachedUploads) {
+        upload_shards_.clear();
+    }
+    upload_shards_[upload_id] = std::move(store);
+}
+
+void ShardedMetadataStore::ForgetUpload(const std::string& upload_id) {
+    std::lock_guard<std::mutex> lock(uploads_mutex_);
+    upload_shards_.erase(upload_id);
+}
+
+core::Result<Bucket> ShardedMetadataStore::CreateBucket(const std::string& name) {
+    return ForBucket(name)->CreateBucket(name);
+}
+
+core::Result<std::vector<Bucket>> ShardedMetadataStore::ListBuckets() {
+    auto listed =
+        FanOut(Current()->stores, [](MetadataStore& store) { return store.ListBuckets(); });
+    std::vector<Bucket> buckets;
+    for (auto& result : listed) {
+        if (!result.ok()) {
+            return result.error();
+        }
+        std::move(result.value().begin(), result.value().end(), std::back_inserter(buckets));
+    }
+    std::sort(buckets.begin(), buckets.end(),
+              [](const Bucket& a, const Bucket& b) { return a.name < b.name; });
+    return buckets;
+}
+
+core::Result<Bucket> ShardedMetadataStore::GetBucket(const std::string& name) {
+    return ForBucket(name)->GetBucket(name);
+}
+
+core::Result<ObjectMetadata> ShardedMetadataStore::UpsertObject(const std::string& bucket,
+                                                                const ObjectMetadata& object) {
+    return ForBucket(bucket)->UpsertObject(bucket, object);
+}
+
+core::Result<ObjectMetadata> ShardedMetadataStore::GetObject(const std::string& bucket,
+                                                             const std::string& object) {
+    return ForBucket(bucket)->GetObject(bucket, object);
+}
+
+core::Result<std::vector<ObjectMetadata>> ShardedMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    return ForBucket(bucket)->ListObjects(bucket, prefix);
+}
+
+core::Result<ObjectListing> ShardedMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    return ForBucket(bucket)->ListObjectsPage(bucket, options);
+}
+
+core::Result<void> ShardedMetadataStore::DeleteObject(const std::string& bucket,
+                                                      const std::string& object) {
+    return ForBucket(bucket)->DeleteObject(bucket, object);
+}
+
+core::Result<MultipartUpload> ShardedMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    // Uploads live with their bucket so completion commits the object on the same shard.
+    auto store = ForBucket(bucket);
+    auto created = store->CreateMultipartUpload(bucket, upload_id, object_name, expires_at);
+    if (created.ok()) {
+        RememberUpload(upload_id, std::move(store));
+    }
+    return created;
+}
+
+core::Result<MultipartUpload> ShardedMetadataStore::GetMultipartUpload(
+    const std::string& upload_id) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        return store.error();
+    }
+    return store.value()->GetMultipartUpload(upload_id);
+}
+
+core::Result<std::vector<MultipartUpload>> ShardedMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    auto listed = FanOut(Current()->stores, [&](MetadataStore& store) {
+        return store.ListExpiredMultipartUploads(expires_before, limit);
+    });
+    std::vector<MultipartUpload> uploads;
+    for (auto& result : listed) {
+        if (!result.ok()) {
+            return result.error();
+        }
+        std::move(result.value().begin(), result.value().end(), std::back_inserter(uploads));
+    }
+    // Each shard returned its own oldest `limit`; keep the oldest `limit` overall.
+    std::sort(uploads.begin(), uploads.end(),
+              [](const MultipartUpload& a, const MultipartUpload& b) {
+                  return a.expires_at < b.expires_at;
+              });
+    if (uploads.size() > static_cast<std::size_t>(std::max(0, limit))) {
+        uploads.resize(static_cast<std::size_t>(std::max(0, limit)));
+    }
+    return uploads;
+}
+
+core::Result<void> ShardedMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
+                                                                    const std::string& state) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        return store.error();
+    }
+    return store.value()->UpdateMultipartUploadState(upload_id, state);
+}
+
+core::Result<void> ShardedMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        // Deleting an unknown upload is a no-op on every store.
+        if (store.error().code == core::ErrorCode::kNotFound) {
+            return core::Ok();
+        }
+        return store.error();
+    }
+    auto deleted = store.value()->DeleteMultipartUpload(upload_id);
+    if (deleted.ok()) {
+        ForgetUpload(upload_id);
+    }
+    return deleted;
+}
+
+core::Result<MultipartPart> ShardedMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes, const std::string& etag,
+    const std::string& temp_path) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        return store.error();
+    }
+    return store.value()->UpsertMultipartPart(upload_id, part_number, size_bytes, etag,
+                                              temp_path);
+}
+
+core::Result<std::vector<MultipartPart>> ShardedMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        if (store.error().code == core::ErrorCode::kNotFound) {
+            return std::vector<MultipartPart>{};
+        }
+        return store.error();
+    }
+    return store.value()->ListMultipartParts(upload_id);
+}
+
+core::Result<void> ShardedMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
+    auto store = ForUpload(upload_id);
+    if (!store.ok()) {
+        if (store.error().code == core::ErrorCode::kNotFound) {
+            return core::Ok();
+        }
+        return store.error();
+    }
+    return store.value()->DeleteMultipartParts(upload_id);
+}
+
+core::Result<void> ShardedMetadataStore::ConfigureStorageNodes(
+    const std::vector<std::string>& endpoints) {
+    // Every shard places replicas for its own buckets, so each needs the full node list.
+    auto configured = FanOut(Current()->stores, [&](MetadataStore& store) {
+        return store.ConfigureStorageNodes(endpoints);
+    });
+    for (auto& result : configured) {
+        if (!result.ok()) {
+            return result.error();
+        }
+    }
+    return core::Ok();
+}
+
+core::Result<AllocateWritePlan> ShardedMetadataStore::AllocateWrite(
+    const std::string& bucket, const std::string& object_name, int replication_factor,
+    const std::string& service_token) {
+    return ForBucket(bucket)->AllocateWrite(bucket, object_name, replication_factor,
+                                            service_token);
+}
+
+core::Result<void> ShardedMetadataStore::CommitWrite(const std::string& bucket,
+                                                     const std::string& object_name,
+                                                     const std::string& blob_id,
+                                                     std::uint64_t size_bytes,
+                                                     const std::string& etag,
+                                                     const std::vector<ReplicaTarget>& replicas) {
+    return ForBucket(bucket)->CommitWrite(bucket, object_name, blob_id, size_bytes, etag,
+                                          replicas);
+}
+
+core::Result<ResolveReadPlan> ShardedMetadataStore::ResolveRead(const std::string& bucket,
+                                                                const std::string& object_name) {
+    return ForBucket(bucket)->ResolveRead(bucket, object_name);
+}
+
+core::Result<std::vector<BatchOpResult>> ShardedMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    // Leases live on the shard a bucket of the same name would, so every gateway finds them.
+    std::shared_ptr<MetadataStore> lease_store;
+    for (const auto& op : ops) {
+        if (!IsLeaseOp(op)) {
+            continue;
+        }
+        auto owner = ForBucket(op.lease);
+        if (lease_store && owner != lease_store) {
+            return core::Error{core::ErrorCode::kCrossShard,
+                               "batch spans leases on different metadata shards"};
+        }
+        lease_store = std::move(owner);
+    }
+    // A batch is atomic only within one shard. Uploads live with their bucket, so any op naming
+    // a bucket picks the shard and the rest must agree with it; a copy's source counts too.
+    std::shared_ptr<MetadataStore> store;
+    for (const auto& op : ops) {
+        for (const auto* bucket : {&op.bucket, &op.source_bucket}) {
+            if (bucket->empty()) {
+                continue;
+            }
+            auto owner = ForBucket(*bucket);
+            if (store && owner != store) {
+                return core::Error{core::ErrorCode::kCrossShard,
+                                   "batch spans buckets on different metadata shards"};
+            }
+            store = std::move(owner);
+        }
+    }
+    if (!store) {
+        for (const auto& op : ops) {
+            if (op.upload_id.empty()) {
+                continue;
+            }
+            auto found = ForUpload(op.upload_id);
+            if (!found.ok()) {
+                return found.error();
+            }
+            store = std::move(found.value());
+            break;
+        }
+    }
+    if (!store) {
+        store = lease_store;
+    }
+    if (!store) {
+        return core::Error{core::ErrorCode::kInvalidArgument,
+                           "batch names no bucket, upload or lease"};
+    }
+    auto executed = lease_store && lease_store != store
+                        ? ExecuteSplitLeaseBatch(*lease_store, *store, ops)
+                        : store->ExecuteBatch(ops);
+    if (executed.ok()) {
+        for (const auto& op : ops) {
+            if (op.type == BatchOpType::kCreateMultipartUpload) {
+                RememberUpload(op.upload_id, store);
+            } else if (op.type == BatchOpType::kDeleteMultipartUpload) {
+                ForgetUpload(op.upload_id);
+            }
+        }
+    }
+    return executed;
+}
+
+}  // namespace nebulafs::metadata
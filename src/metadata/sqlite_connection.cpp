@@ -0,0 +1,200 @@
+#include "nebulafs/metadata/sqlite_connection.h"
+
+#include <sqlite3.h>
+
+namespace nebulafs::metadata {
+
+namespace {
+
+constexpr int kBusyTimeoutMs = 5000;
+
+[[noreturn]] void ThrowError(sqlite3* db, int code) {
+    throw SqliteError(code, db != nullptr ? sqlite3_errmsg(db) : sqlite3_errstr(code));
+}
+
+}  // namespace
+
+SqliteError::SqliteError(int code, const std::string& message)
+    : std::runtime_error(message), code_(code) {}
+
+bool SqliteError::IsConstraint() const { return (code_ & 0xff) == SQLITE_CONSTRAINT; }
+
+SqliteQuery::SqliteQuery(sqlite3_stmt* stmt) : stmt_(stmt) {}
+
+SqliteQuery::SqliteQuery(SqliteQuery&& other) noexcept
+    : stmt_(other.stmt_), next_param_(other.next_param_) {
+    other.stmt_ = nullptr;
+}
+
+SqliteQuery::~SqliteQuery() {
+    if (stmt_ != nullptr) {
+        // Resetting releases the read snapshot so WAL checkpoints are not held back.
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+}
+
+SqliteQuery& SqliteQuery::Bind(std::int64_t value) {
+    const int rc = sqlite3_bind_int64(stmt_, next_param_++, value);
+    if (rc != SQLITE_OK) {
+        ThrowError(sqlite3_db_handle(stmt_), rc);
+    }
+    return *this;
+}
+
+SqliteQuery& SqliteQuery::Bind(std::string_view value) {
+    // SQLITE_TRANSIENT copies the bytes, so callers may bind temporaries.
+    const int rc = sqlite3_bind_text(stmt_, next_param_++, value.data(),
+                                     static_cast<int>(value.size()), SQLITE_TRANSIENT);
+    if (rc != SQLITE_OK) {
+        ThrowError(sqlite3_db_handle(stmt_), rc);
+    }
+    return *this;
+}
+
+SqliteQuery& SqliteQuery::BindBlob(std::string_view value) {
+    const int rc = sqlite3_bind_blob(stmt_, next_param_++, value.data(),
+                                     static_cast<int>(value.size()), SQLITE_TRANSIENT);
+    if (rc != SQLITE_OK) {
+        ThrowError(sqlite3_db_handle(stmt_), rc);
+    }
+    return *this;
+}
+
+SqliteQuery& SqliteQuery::BindNull() {
+    const int rc = sqlite3_bind_null(stmt_, next_param_++);
+    if (rc != SQLITE_OK) {
+        ThrowError(sqlite3_db_handle(stmt_), rc);
+    }
+    return *this;
+}
+
+bool SqliteQuery::Next() {
+    const int rc = sqlite3_step(stmt_);
+    if (rc == SQLITE_ROW) {
+        return true;
+    }
+    if (rc == SQLITE_DONE) {
+        return false;
+    }
+    ThrowError(sqlite3_db_handle(stmt_), sqlite3_extended_errcode(sqlite3_db_handle(stmt_)));
+}
+
+void SqliteQuery::Run() {
+    while (Next()) {
+    }
+}
+
+std::int64_t SqliteQuery::Int64(int column) const {
+    return sqlite3_column_int64(stmt_, column);
+}
+
+int SqliteQuery::Int(int column) const { return sqlite3_column_int(stmt_, column); }
+
+std::string SqliteQuery::Text(int column) const { return std::string(View(column)); }
+
+std::string_view SqliteQuery::View(int column) const {
+    const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt_, column));
+    const int size = sqlite3_column_bytes(stmt_, column);
+    if (data == nullptr || size <= 0) {
+        return {};
+    }
+    return std::string_view(data, static_cast<std::size_t>(size));
+}
+
+bool SqliteQuery::IsNull(int column) const {
+    return sqlite3_column_type(stmt_, column) == SQLITE_NULL;
+}
+
+bool SqliteQuery::IsBlob(int column) const {
+    return sqlite3_column_type(stmt_, column) == SQLITE_BLOB;
+}
+
+bool SqliteQuery::IsInteger(int column) const {
+    return sqlite3_column_type(stmt_, column) == SQLITE_INTEGER;
+}
+
+SqliteConnection::SqliteConnection(const std::string& path, bool read_only) {
+    // Each connection is only ever used by one thread at a time (writer thread or a leased
+    // reader), so SQLite's per-connection mutex is pure overhead.
+    const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+    const int rc = sqlite3_open_v2(path.c_str(), &db_, flags, nullptr);
+    if (rc != SQLITE_OK) {
+        const std::string message = db_ != nullptr ? sqlite3_errmsg(db_) : sqlite3_errstr(rc);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw SqliteError(rc, message);
+    }
+    sqlite3_extended_result_codes(db_, 1);
+    sqlite3_busy_timeout(db_, kBusyTimeoutMs);
+    if (read_only) {
+        Execute("PRAGMA query_only = ON");
+    }
+}
+
+SqliteConnection::~SqliteConnection() {
+    for (auto& entry : statements_) {
+        sqlite3_finalize(entry.second);
+    }
+    sqlite3_close(db_);
+}
+
+void SqliteConnection::Execute(const std::string& sql) {
+    char* message = nullptr;
+    const int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &message);
+    if (rc != SQLITE_OK) {
+        std::string text = message != nullptr ? message : sqlite3_errstr(rc);
+        sqlite3_free(message);
+        throw SqliteError(sqlite3_extended_errcode(db_), text);
+    }
+}
+
+SqliteQuery SqliteConnection::Query(std::string_view sql) {
+    auto it = statements_.find(sql);
+    if (it == statements_.end()) {
+        sqlite3_stmt* stmt = nullptr;
+        const int rc = sqlite3_prepare_v3(db_, sql.data(), static_cast<int>(sql.size()),
+                                          SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+        if (rc != SQLITE_OK) {
+            ThrowError(db_, rc);
+        }
+        it = statements_.emplace(std::string(sql), stmt).first;
+    }
+    return SqliteQuery(it->second);
+}
+
+int SqliteConnection::Changes() const { return sqlite3_changes(db_); }
+
+bool SqliteConnection::InTransaction() const { return sqlite3_get_autocommit(db_) == 0; }
+
+SqliteTransaction::SqliteTransaction(SqliteConnection& connection, bool read_only)
+    : connection_(connection), savepoint_(connection.InTransaction()) {
+    if (savepoint_) {
+        connection_.Execute("SAVEPOINT nested");
+        return;
+    }
+    connection_.Execute(read_only ? "BEGIN" : "BEGIN IMMEDIATE");
+}
+
+SqliteTransaction::~SqliteTransaction() {
+    if (!done_) {
+        try {
+            if (savepoint_) {
+                // ROLLBACK TO keeps the savepoint open; RELEASE pops it off the stack.
+                connection_.Execute("ROLLBACK TO nested");
+                connection_.Execute("RELEASE nested");
+            } else {
+                connection_.Execute("ROLLBACK");
+            }
+        } catch (const SqliteError&) {
+            // The transaction may already be gone (e.g. SQLite rolled back on an I/O error).
+        }
+    }
+}
+
+void SqliteTransaction::Commit() {
+    connection_.Execute(savepoint_ ? "RELEASE nested" : "COMMIT");
+    done_ = true;
+}
+
+}  // namespace nebulafs::metadata
@@ -1,491 +1,1050 @@
 #include "nebulafs/metadata/sqlite_metadata_store.h"
 
-#include <Poco/Data/SessionFactory.h>
-#include <Poco/Data/SQLite/Connector.h>
-#include <Poco/Data/Statement.h>
+#include <future>
+#include <optional>
+
 #include <Poco/UUIDGenerator.h>
 
 #include "nebulafs/core/time.h"
 #include "nebulafs/distributed/placement_token.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/metadata/object_listing.h"
+#include "nebulafs/metadata/sqlite_schema.h"
+#include "nebulafs/observability/metrics.h"
 #include "nebulafs/storage/local_storage.h"
 
+namespace nebulafs::metadata {
+
 namespace {
-using namespace Poco::Data::Keywords;
+
+constexpr const char* kSelectBucket = "SELECT id, name, created_at FROM buckets WHERE name = ?";
+
+// Only point lookups read `inline_data`; scans leave it on disk.
+constexpr const char* kSelectObject =
+    "SELECT o.id, o.bucket_id, o.name, o.size_bytes, o.etag, o.created_at, o.updated_at, "
+    "o.inline_data FROM objects o JOIN buckets b ON o.bucket_id = b.id "
+    "WHERE b.name = ? AND o.name = ?";
+
+constexpr const char* kScanObjectsFrom =
+    "SELECT o.id, o.bucket_id, o.name, o.size_bytes, o.etag, o.created_at, o.updated_at "
+    "FROM objects o JOIN buckets b ON o.bucket_id = b.id "
+    "WHERE b.name = ? AND o.name >= ? ORDER BY o.name";
+
+constexpr const char* kScanObjectsRange =
+    "SELECT o.id, o.bucket_id, o.name, o.size_bytes, o.etag, o.created_at, o.updated_at "
+    "FROM objects o JOIN buckets b ON o.bucket_id = b.id "
+    "WHERE b.name = ? AND o.name >= ? AND o.name < ? ORDER BY o.name";
+
+constexpr const char* kSelectUpload =
+    "SELECT id, upload_id, bucket_id, object_name, state, expires_at, created_at, updated_at, "
+    "part_size FROM multipart_uploads WHERE upload_id = ?";
+
+// Resolves the bucket inside the INSERT so an upsert is one statement instead of a bucket
+// lookup, the write, and a read-back.
+constexpr const char* kUpsertObject =
+    "INSERT INTO objects(bucket_id, name, size_bytes, etag, created_at, updated_at, inline_data) "
+    "SELECT id, ?, ?, ?, ?, ?, ? FROM buckets WHERE name = ? "
+    "ON CONFLICT(bucket_id, name) DO UPDATE SET "
+    "size_bytes=excluded.size_bytes, etag=excluded.etag, updated_at=excluded.updated_at, "
+    "inline_data=excluded.inline_data "
+    "RETURNING id, bucket_id, name, size_bytes, etag, created_at, updated_at";
+
+Bucket ReadBucket(const SqliteQuery& query) {
+    Bucket bucket;
+    bucket.id = query.Int(0);
+    bucket.name = query.Text(1);
+    bucket.created_at = ReadTime(query, 2);
+    return bucket;
 }
 
-namespace nebulafs::metadata {
+ObjectMetadata ReadObject(const SqliteQuery& query) {
+    ObjectMetadata meta;
+    meta.id = query.Int(0);
+    meta.bucket_id = query.Int(1);
+    meta.name = query.Text(2);
+    meta.size_bytes = static_cast<std::uint64_t>(query.Int64(3));
+    meta.etag = ReadDigest(query, 4);
+    meta.created_at = ReadTime(query, 5);
+    meta.updated_at = ReadTime(query, 6);
+    return meta;
+}
 
-SqliteMetadataStore::SqliteMetadataStore(const std::string& db_path)
-    : session_([](const std::string& path) {
-          Poco::Data::SQLite::Connector::registerConnector();
-          return Poco::Data::Session("SQLite", path);
-      }(db_path)) {
-    InitSchema();
+MultipartUpload ReadUpload(const SqliteQuery& query) {
+    MultipartUpload upload;
+    upload.id = query.Int(0);
+    upload.upload_id = ReadId(query, 1);
+    upload.bucket_id = query.Int(2);
+    upload.object_name = query.Text(3);
+    upload.state = ReadUploadState(query, 4);
+    upload.expires_at = ReadTime(query, 5);
+    upload.created_at = ReadTime(query, 6);
+    upload.updated_at = ReadTime(query, 7);
+    upload.part_size = static_cast<std::uint64_t>(query.Int64(8));
+    return upload;
 }
 
-void SqliteMetadataStore::InitSchema() {
-    session_ << "PRAGMA foreign_keys = ON", now;
-
-    // Schema is created on startup for developer convenience; migrations will replace this later.
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS buckets ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "name TEXT NOT NULL UNIQUE,"
-            "created_at TEXT NOT NULL"
-            ")",
-        now;
-
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS objects ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "bucket_id INTEGER NOT NULL,"
-            "name TEXT NOT NULL,"
-            "size_bytes INTEGER NOT NULL,"
-            "etag TEXT NOT NULL,"
-            "created_at TEXT NOT NULL,"
-            "updated_at TEXT NOT NULL,"
-            "UNIQUE(bucket_id, name),"
-            "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
-            ")",
-        now;
-
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS multipart_uploads ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "upload_id TEXT NOT NULL UNIQUE,"
-            "bucket_id INTEGER NOT NULL,"
-            "object_name TEXT NOT NULL,"
-            "state TEXT NOT NULL,"
-            "expires_at TEXT NOT NULL,"
-            "created_at TEXT NOT NULL,"
-            "updated_at TEXT NOT NULL,"
-            "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
-            ")",
-        now;
-
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS multipart_parts ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "upload_id TEXT NOT NULL,"
-            "part_number INTEGER NOT NULL,"
-            "size_bytes INTEGER NOT NULL,"
-            "etag TEXT NOT NULL,"
-            "temp_path TEXT NOT NULL,"
-            "created_at TEXT NOT NULL,"
-            "UNIQUE(upload_id, part_number),"
-            "FOREIGN KEY(upload_id) REFERENCES multipart_uploads(upload_id) ON DELETE CASCADE"
-            ")",
-        now;
-
-    session_ <<
-            "CREATE INDEX IF NOT EXISTS idx_multipart_uploads_expires_at "
-            "ON multipart_uploads(expires_at)",
-        now;
-    session_ <<
-            "CREATE INDEX IF NOT EXISTS idx_multipart_parts_upload_id "
-            "ON multipart_parts(upload_id)",
-        now;
-
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS storage_nodes ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "endpoint TEXT NOT NULL UNIQUE,"
-            "status TEXT NOT NULL,"
-            "capacity_bytes INTEGER NOT NULL DEFAULT 0,"
-            "free_bytes INTEGER NOT NULL DEFAULT 0,"
-            "updated_at TEXT NOT NULL"
-            ")",
-        now;
-
-    session_ <<
-            "CREATE TABLE IF NOT EXISTS object_replicas ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "object_id INTEGER NOT NULL,"
-            "node_id INTEGER NOT NULL,"
-            "blob_id TEXT NOT NULL,"
-            "replica_index INTEGER NOT NULL,"
-            "state TEXT NOT NULL,"
-            "checksum TEXT NOT NULL,"
-            "updated_at TEXT NOT NULL,"
-            "UNIQUE(object_id, replica_index),"
-            "FOREIGN KEY(object_id) REFERENCES objects(id) ON DELETE CASCADE,"
-            "FOREIGN KEY(node_id) REFERENCES storage_nodes(id) ON DELETE CASCADE"
-            ")",
-        now;
-    session_ <<
-            "CREATE INDEX IF NOT EXISTS idx_object_replicas_object_id "
-            "ON object_replicas(object_id)",
-        now;
+MultipartPart ReadPart(const SqliteQuery& query) {
+    MultipartPart part;
+    part.id = query.Int(0);
+    part.upload_id = ReadId(query, 1);
+    part.part_number = query.Int(2);
+    part.size_bytes = static_cast<std::uint64_t>(query.Int64(3));
+    part.etag = ReadDigest(query, 4);
+    part.temp_path = query.Text(5);
+    part.created_at = ReadTime(query, 6);
+    return part;
 }
 
-core::Result<Bucket> SqliteMetadataStore::CreateBucket(const std::string& name) {
-    try {
-        std::string created_at = core::NowIso8601();
-        std::string name_value = name;
-        session_ << "INSERT INTO buckets(name, created_at) VALUES(?, ?)", use(name_value),
-            use(created_at), now;
-    } catch (const Poco::Exception& ex) {
-        // SQLite uniqueness errors surface here; map them to a conflict-like error.
-        return core::Error{core::ErrorCode::kAlreadyExists, ex.displayText()};
+core::Result<Bucket> SelectBucket(SqliteConnection& db, const std::string& name) {
+    auto query = db.Query(kSelectBucket);
+    query.Bind(name);
+    if (!query.Next()) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
     }
-
-    return GetBucket(name);
+    return ReadBucket(query);
 }
 
-core::Result<std::vector<Bucket>> SqliteMetadataStore::ListBuckets() {
-    std::vector<Bucket> buckets;
-    Bucket bucket;
+core::Result<ObjectMetadata> SelectObject(SqliteConnection& db, const std::string& bucket,
+                                          const std::string& object) {
+    auto query = db.Query(kSelectObject);
+    query.Bind(bucket).Bind(object);
+    if (!query.Next()) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    auto meta = ReadObject(query);
+    if (!query.IsNull(7)) {
+        meta.inline_data = std::string(query.View(7));
+    }
+    return meta;
+}
 
-    Poco::Data::Statement select(session_);
-    select << "SELECT id, name, created_at FROM buckets ORDER BY name ASC", into(bucket.id),
-        into(bucket.name), into(bucket.created_at), range(0, 1);
+core::Result<MultipartUpload> SelectMultipartUpload(SqliteConnection& db,
+                                                    const std::string& upload_id) {
+    auto query = db.Query(kSelectUpload);
+    BindId(query, upload_id);
+    if (!query.Next()) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+    }
+    return ReadUpload(query);
+}
 
-    while (!select.done()) {
-        bucket = {};
-        select.execute();
-        if (select.done() && bucket.name.empty()) {
-            break;
-        }
-        if (!bucket.name.empty()) {
-            buckets.push_back(bucket);
+// Range predicates instead of LIKE 'prefix%' let SQLite seek the (bucket_id, name) unique index
+// and stop at the upper bound; LIKE is case-insensitive by default and never uses that index.
+void ScanObjects(SqliteConnection& db, const std::string& bucket, const std::string& lower,
+                 const std::string& upper, const std::function<bool(ObjectMetadata&&)>& visit) {
+    auto query = db.Query(upper.empty() ? kScanObjectsFrom : kScanObjectsRange);
+    query.Bind(bucket).Bind(lower);
+    if (!upper.empty()) {
+        query.Bind(upper);
+    }
+    while (query.Next()) {
+        if (!visit(ReadObject(query))) {
+            return;
         }
     }
+}
 
-    return buckets;
+core::Result<ObjectMetadata> UpsertObjectRow(SqliteConnection& db, const std::string& bucket,
+                                             const ObjectMetadata& object) {
+    const std::string now_time = core::NowIso8601();
+    auto query = db.Query(kUpsertObject);
+    query.Bind(object.name).Bind(static_cast<std::int64_t>(object.size_bytes));
+    BindDigest(query, object.etag);
+    BindTime(query, now_time);
+    BindTime(query, now_time);
+    if (object.inline_data) {
+        query.BindBlob(*object.inline_data);
+    } else {
+        query.BindNull();
+    }
+    query.Bind(bucket);
+    if (!query.Next()) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+    }
+    return ReadObject(query);
 }
 
-core::Result<Bucket> SqliteMetadataStore::GetBucket(const std::string& name) {
-    Bucket bucket;
-    std::string name_value = name;
-    Poco::Data::Statement select(session_);
-    select << "SELECT id, name, created_at FROM buckets WHERE name = ?", use(name_value),
-        into(bucket.id), into(bucket.name), into(bucket.created_at), now;
+// A negative LIMIT means no limit to SQLite.
+std::vector<MultipartPart> SelectParts(SqliteConnection& db, const std::string& upload_id,
+                                       int after_part = 0, int limit = -1) {
+    std::vector<MultipartPart> parts;
+    auto query = db.Query(
+        "SELECT id, upload_id, part_number, size_bytes, etag, temp_path, created_at "
+        "FROM multipart_parts WHERE upload_id = ? AND part_number > ? "
+        "ORDER BY part_number ASC LIMIT ?");
+    BindId(query, upload_id);
+    query.Bind(static_cast<std::int64_t>(after_part)).Bind(static_cast<std::int64_t>(limit));
+    while (query.Next()) {
+        parts.push_back(ReadPart(query));
+    }
+    return parts;
+}
 
-    if (bucket.name.empty()) {
-        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+core::Result<void> UpdateUploadStateRow(SqliteConnection& db, const std::string& upload_id,
+                                        const std::string& state) {
+    auto update =
+        db.Query("UPDATE multipart_uploads SET state = ?, updated_at = ? WHERE upload_id = ?");
+    BindUploadState(update, state);
+    BindTime(update, core::NowIso8601());
+    BindId(update, upload_id);
+    update.Run();
+    if (db.Changes() == 0) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
     }
-    return bucket;
+    return core::Ok();
 }
 
-core::Result<ObjectMetadata> SqliteMetadataStore::UpsertObject(const std::string& bucket,
-                                                               const ObjectMetadata& object) {
-    auto bucket_result = GetBucket(bucket);
-    if (!bucket_result.ok()) {
-        return bucket_result.error();
+core::Result<void> UpdateUploadPartSizeRow(SqliteConnection& db, const std::string& upload_id,
+                                           std::uint64_t part_size) {
+    auto update =
+        db.Query("UPDATE multipart_uploads SET part_size = ?, updated_at = ? WHERE upload_id = ?");
+    update.Bind(static_cast<std::int64_t>(part_size));
+    BindTime(update, core::NowIso8601());
+    BindId(update, upload_id);
+    update.Run();
+    if (db.Changes() == 0) {
+        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
     }
-    int bucket_id = bucket_result.value().id;
+    return core::Ok();
+}
 
-    std::string now_time = core::NowIso8601();
-    try {
-        std::string name_value = object.name;
-        std::string etag_value = object.etag;
-        std::uint64_t size_value = object.size_bytes;
-        session_ <<
-                "INSERT INTO objects(bucket_id, name, size_bytes, etag, created_at, updated_at) "
-                "VALUES(?, ?, ?, ?, ?, ?) "
-                "ON CONFLICT(bucket_id, name) DO UPDATE SET "
-                "size_bytes=excluded.size_bytes, etag=excluded.etag, updated_at=excluded.updated_at",
-            use(bucket_id), use(name_value), use(size_value), use(etag_value), use(now_time),
-            use(now_time), now;
-    } catch (const Poco::Exception& ex) {
-        return core::Error{core::ErrorCode::kDbError, ex.displayText()};
+void DeleteUploadRow(SqliteConnection& db, const std::string& upload_id) {
+    auto del = db.Query("DELETE FROM multipart_uploads WHERE upload_id = ?");
+    BindId(del, upload_id);
+    del.Run();
+}
+
+void DeletePartRows(SqliteConnection& db, const std::string& upload_id) {
+    auto del = db.Query("DELETE FROM multipart_parts WHERE upload_id = ?");
+    BindId(del, upload_id);
+    del.Run();
+}
+
+core::Result<AllocateWritePlan> PlanWrite(SqliteConnection& db, const std::string& bucket,
+                                          const std::string& object_name,
+                                          int replication_factor,
+                                          const std::string& service_token) {
+    if (!storage::LocalStorage::IsSafeName(object_name)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object name"};
+    }
+    AllocateWritePlan plan;
+    auto select = db.Query(
+        "SELECT id, endpoint FROM storage_nodes "
+        "WHERE status = 'active' AND EXISTS (SELECT 1 FROM buckets WHERE name = ?) "
+        "ORDER BY id ASC LIMIT ?");
+    select.Bind(bucket).Bind(replication_factor);
+    int index = 0;
+    while (select.Next()) {
+        plan.replicas.push_back(ReplicaTarget{select.Int(0), index++, select.Text(1)});
+    }
+    if (plan.replicas.empty()) {
+        auto bucket_result = SelectBucket(db, bucket);
+        if (!bucket_result.ok()) {
+            return bucket_result.error();
+        }
+    }
+    if (static_cast<int>(plan.replicas.size()) < replication_factor) {
+        return core::Error{core::ErrorCode::kInternal, "insufficient active storage nodes"};
     }
 
-    return GetObject(bucket, object.name);
+    plan.blob_id = Poco::UUIDGenerator().createOne().toString();
+    plan.write_token = nebulafs::distributed::CreatePlacementToken(plan.blob_id, "write", 120,
+                                                                  service_token);
+    return plan;
 }
 
-core::Result<ObjectMetadata> SqliteMetadataStore::GetObject(const std::string& bucket,
-                                                            const std::string& object) {
-    ObjectMetadata meta;
-    std::string bucket_value = bucket;
-    std::string object_value = object;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT o.id, o.bucket_id, o.name, o.size_bytes, o.etag, o.created_at, o.updated_at "
-            "FROM objects o JOIN buckets b ON o.bucket_id = b.id "
-            "WHERE b.name = ? AND o.name = ?",
-        use(bucket_value), use(object_value), into(meta.id), into(meta.bucket_id), into(meta.name),
-        into(meta.size_bytes), into(meta.etag), into(meta.created_at), into(meta.updated_at), now;
-
-    if (meta.name.empty()) {
-        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+// Callers own the transaction so readers never observe an object without its replicas.
+// An object is stored either as one blob with replicas or as a manifest of segments; a
+// commit of either kind replaces whatever the object had.
+void DeleteObjectLayout(SqliteConnection& db, int object_id) {
+    for (const char* sql : {"DELETE FROM object_replicas WHERE object_id = ?",
+                            "DELETE FROM object_segments WHERE object_id = ?"}) {
+        auto del = db.Query(sql);
+        del.Bind(object_id);
+        del.Run();
     }
-    return meta;
 }
 
-core::Result<std::vector<ObjectMetadata>> SqliteMetadataStore::ListObjects(
-    const std::string& bucket, const std::string& prefix) {
-    std::vector<ObjectMetadata> objects;
-    ObjectMetadata meta;
+core::Result<void> CommitWriteRows(SqliteConnection& db, const std::string& bucket,
+                                   const std::string& object_name, const std::string& blob_id,
+                                   std::uint64_t size_bytes, const std::string& etag,
+                                   const std::vector<ReplicaTarget>& replicas) {
+    nebulafs::metadata::ObjectMetadata object;
+    object.name = object_name;
+    object.size_bytes = size_bytes;
+    object.etag = etag;
+    auto upsert = UpsertObjectRow(db, bucket, object);
+    if (!upsert.ok()) {
+        return upsert.error();
+    }
 
-    std::string like = prefix + "%";
-    std::string bucket_value = bucket;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT o.id, o.bucket_id, o.name, o.size_bytes, o.etag, o.created_at, o.updated_at "
-            "FROM objects o JOIN buckets b ON o.bucket_id = b.id "
-            "WHERE b.name = ? AND o.name LIKE ? ORDER BY o.name ASC",
-        use(bucket_value), use(like), into(meta.id), into(meta.bucket_id), into(meta.name),
-        into(meta.size_bytes), into(meta.etag), into(meta.created_at), into(meta.updated_at),
-        range(0, 1);
+    const std::string now_time = core::NowIso8601();
+    const int object_id = upsert.value().id;
+    DeleteObjectLayout(db, object_id);
+    for (const auto& replica : replicas) {
+        // Replica state 1 is "committed" (schema v2 stores states as codes).
+        auto insert = db.Query(
+            "INSERT INTO object_replicas(object_id, node_id, blob_id, replica_index, state, "
+            "checksum, updated_at) VALUES(?, ?, ?, ?, 1, ?, ?)");
+        insert.Bind(object_id).Bind(replica.node_id);
+        BindId(insert, blob_id);
+        insert.Bind(replica.replica_index);
+        BindDigest(insert, etag);
+        BindTime(insert, now_time);
+        insert.Run();
+    }
+    return core::Ok();
+}
 
-    while (!select.done()) {
-        meta = {};
-        select.execute();
-        if (select.done() && meta.name.empty()) {
-            break;
-        }
-        if (!meta.name.empty()) {
-            objects.push_back(meta);
+core::Result<void> CommitManifestRows(SqliteConnection& db, const BatchOp& op,
+                                      const std::string& object_name) {
+    auto checked = CheckManifest(op);
+    if (!checked.ok()) {
+        return checked;
+    }
+    ObjectMetadata object;
+    object.name = object_name;
+    object.size_bytes = op.size_bytes;
+    object.etag = op.etag;
+    auto upsert = UpsertObjectRow(db, op.bucket, object);
+    if (!upsert.ok()) {
+        return upsert.error();
+    }
+    const int object_id = upsert.value().id;
+    DeleteObjectLayout(db, object_id);
+    for (std::size_t i = 0; i < op.segments.size(); ++i) {
+        const auto& segment = op.segments[i];
+        for (std::size_t r = 0; r < segment.replicas.size(); ++r) {
+            // Segments name their nodes by endpoint; the SELECT maps it to the node id.
+            auto insert = db.Query(
+                "INSERT INTO object_segments(object_id, segment_index, replica_index, node_id, "
+                "blob_id, byte_offset, size_bytes, etag) "
+                "SELECT ?, ?, ?, id, ?, ?, ?, ? FROM storage_nodes WHERE endpoint = ?");
+            insert.Bind(object_id).Bind(static_cast<std::int64_t>(i));
+            insert.Bind(static_cast<std::int64_t>(r));
+            BindId(insert, segment.blob_id);
+            insert.Bind(static_cast<std::int64_t>(segment.offset));
+            insert.Bind(static_cast<std::int64_t>(segment.size_bytes));
+            BindDigest(insert, segment.etag);
+            insert.Bind(segment.replicas[r].endpoint);
+            insert.Run();
+            if (db.Changes() == 0) {
+                return core::Error{core::ErrorCode::kNotFound,
+                                   "unknown storage node " + segment.replicas[r].endpoint};
+            }
         }
     }
+    return core::Ok();
+}
 
-    return objects;
+// Rows come in (segment, replica) order; a segment whose rows are all missing would leave a
+// gap, which `CheckManifest` reports.
+core::Result<std::vector<ManifestSegment>> SelectSegments(SqliteConnection& db, int object_id,
+                                                          std::uint64_t size_bytes) {
+    auto select = db.Query(
+        "SELECT g.segment_index, g.blob_id, g.byte_offset, g.size_bytes, g.etag, g.node_id, "
+        "g.replica_index, s.endpoint FROM object_segments g "
+        "JOIN storage_nodes s ON s.id = g.node_id "
+        "WHERE g.object_id = ? ORDER BY g.segment_index ASC, g.replica_index ASC");
+    select.Bind(object_id);
+    BatchOp manifest;
+    manifest.size_bytes = size_bytes;
+    int current = -1;
+    while (select.Next()) {
+        if (select.Int(0) != current) {
+            current = select.Int(0);
+            ManifestSegment segment;
+            segment.blob_id = ReadId(select, 1);
+            segment.offset = static_cast<std::uint64_t>(select.Int64(2));
+            segment.size_bytes = static_cast<std::uint64_t>(select.Int64(3));
+            segment.etag = ReadDigest(select, 4);
+            manifest.segments.push_back(std::move(segment));
+        }
+        manifest.segments.back().replicas.push_back(
+            ReplicaTarget{select.Int(5), select.Int(6), select.Text(7)});
+    }
+    if (manifest.segments.empty()) {
+        return manifest.segments;
+    }
+    auto checked = CheckManifest(manifest);
+    if (!checked.ok()) {
+        return core::Error{core::ErrorCode::kNotFound, "object manifest is incomplete"};
+    }
+    return manifest.segments;
 }
 
-core::Result<void> SqliteMetadataStore::DeleteObject(const std::string& bucket,
-                                                     const std::string& object) {
-    auto bucket_result = GetBucket(bucket);
-    if (!bucket_result.ok()) {
-        return bucket_result.error();
+core::Result<ResolveReadPlan> SelectReadPlan(SqliteConnection& db, const std::string& bucket,
+                                             const std::string& object_name) {
+    // One statement resolves the object and its replicas; the LEFT JOINs keep the object
+    // row so "missing object" and "no committed replicas" stay distinguishable.
+    auto select = db.Query(
+        "SELECT o.size_bytes, o.etag, r.blob_id, r.node_id, r.replica_index, s.endpoint, "
+        "o.id "
+        "FROM objects o JOIN buckets b ON o.bucket_id = b.id "
+        "LEFT JOIN object_replicas r ON r.object_id = o.id AND r.state = 1 "
+        "LEFT JOIN storage_nodes s ON s.id = r.node_id "
+        "WHERE b.name = ? AND o.name = ? ORDER BY r.replica_index ASC");
+    select.Bind(bucket).Bind(object_name);
+
+    bool found = false;
+    int object_id = 0;
+    ResolveReadPlan plan;
+    while (select.Next()) {
+        if (!found) {
+            found = true;
+            plan.size_bytes = static_cast<std::uint64_t>(select.Int64(0));
+            plan.etag = ReadDigest(select, 1);
+            object_id = select.Int(6);
+        }
+        if (select.IsNull(2) || select.IsNull(5)) {
+            continue;
+        }
+        if (plan.blob_id.empty()) {
+            plan.blob_id = ReadId(select, 2);
+        }
+        plan.replicas.push_back(ReplicaTarget{select.Int(3), select.Int(4), select.Text(5)});
     }
-    int bucket_id = bucket_result.value().id;
+    if (!found) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    if (!plan.replicas.empty()) {
+        return plan;
+    }
+    // Only composite objects have no replica rows, so the manifest is looked up just then.
+    auto segments = SelectSegments(db, object_id, plan.size_bytes);
+    if (!segments.ok()) {
+        return segments.error();
+    }
+    if (segments.value().empty()) {
+        return core::Error{core::ErrorCode::kNotFound, "object has no committed replicas"};
+    }
+    plan.segments = std::move(segments.value());
+    return plan;
+}
+
+// Copies share blobs, so a delete counts the objects that still point at the first blob of
+// the plan it removed; every blob of a layout is shared by the same objects.
+std::uint64_t CountBlobReferences(SqliteConnection& db, const ResolveReadPlan& plan) {
+    const bool manifest = plan.blob_id.empty() && !plan.segments.empty();
+    auto count = db.Query(manifest
+                              ? "SELECT COUNT(DISTINCT object_id) FROM object_segments "
+                                "WHERE blob_id = ?"
+                              : "SELECT COUNT(DISTINCT object_id) FROM object_replicas "
+                                "WHERE blob_id = ?");
+    BindId(count, manifest ? plan.segments.front().blob_id : plan.blob_id);
+    return count.Next() ? static_cast<std::uint64_t>(count.Int64(0)) : 0;
+}
 
-    Poco::Data::Statement del(session_);
-    std::string object_value = object;
-    del << "DELETE FROM objects WHERE bucket_id = ? AND name = ?", use(bucket_id),
-        use(object_value),
-        now;
+core::Result<void> DeleteObjectRow(SqliteConnection& db, const std::string& bucket,
+                                   const std::string& object) {
+    auto del = db.Query(
+        "DELETE FROM objects "
+        "WHERE bucket_id = (SELECT id FROM buckets WHERE name = ?) AND name = ?");
+    del.Bind(bucket).Bind(object);
+    del.Run();
+    if (db.Changes() == 0) {
+        // Only a miss pays for the lookup that reports a missing bucket.
+        auto bucket_result = SelectBucket(db, bucket);
+        if (!bucket_result.ok()) {
+            return bucket_result.error();
+        }
+    }
     return core::Ok();
 }
 
-core::Result<MultipartUpload> SqliteMetadataStore::CreateMultipartUpload(
-    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
-    const std::string& expires_at) {
-    auto bucket_result = GetBucket(bucket);
-    if (!bucket_result.ok()) {
-        return bucket_result.error();
+std::optional<Lease> SelectLease(SqliteConnection& db, const std::string& name) {
+    auto select = db.Query(
+        "SELECT holder, fencing_token, expires_at_ms FROM leases WHERE name = ?");
+    select.Bind(name);
+    if (!select.Next()) {
+        return std::nullopt;
     }
-    int bucket_id = bucket_result.value().id;
+    return Lease{name, select.Text(0), static_cast<std::uint64_t>(select.Int64(1)),
+                 static_cast<std::uint64_t>(select.Int64(2))};
+}
 
-    std::string now_time = core::NowIso8601();
-    try {
-        std::string upload_id_value = upload_id;
-        std::string object_name_value = object_name;
-        std::string state_value = "initiated";
-        std::string expires_at_value = expires_at;
-        session_ <<
-                "INSERT INTO multipart_uploads(upload_id, bucket_id, object_name, state, "
-                "expires_at, created_at, updated_at) VALUES(?, ?, ?, ?, ?, ?, ?)",
-            use(upload_id_value), use(bucket_id), use(object_name_value), use(state_value),
-            use(expires_at_value), use(now_time), use(now_time), now;
-    } catch (const Poco::Exception& ex) {
-        return core::Error{core::ErrorCode::kAlreadyExists, ex.displayText()};
+void UpsertLeaseRow(SqliteConnection& db, const Lease& lease) {
+    auto upsert = db.Query(
+        "INSERT INTO leases(name, holder, fencing_token, expires_at_ms) VALUES(?, ?, ?, ?) "
+        "ON CONFLICT(name) DO UPDATE SET holder = excluded.holder, "
+        "fencing_token = excluded.fencing_token, expires_at_ms = excluded.expires_at_ms");
+    upsert.Bind(lease.name).Bind(lease.holder);
+    upsert.Bind(static_cast<std::int64_t>(lease.fencing_token));
+    upsert.Bind(static_cast<std::int64_t>(lease.expires_at_ms));
+    upsert.Run();
+}
+
+core::Result<BucketStats> SelectBucketStats(SqliteConnection& db, const std::string& bucket) {
+    auto select = db.Query(
+        "SELECT s.object_count, s.total_bytes, s.multipart_bytes "
+        "FROM bucket_stats s JOIN buckets b ON s.bucket_id = b.id WHERE b.name = ?");
+    select.Bind(bucket);
+    if (!select.Next()) {
+        return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
     }
+    return BucketStats{static_cast<std::uint64_t>(select.Int64(0)),
+                       static_cast<std::uint64_t>(select.Int64(1)),
+                       static_cast<std::uint64_t>(select.Int64(2))};
+}
 
-    return GetMultipartUpload(upload_id);
+// Copies a source that has no blobs but keeps its body in its row; any other source fails
+// with `missing`, the error its read plan gave.
+core::Result<void> CopyInlineRow(SqliteConnection& db, const BatchOp& op,
+                                 const std::string& object_name, const core::Error& missing) {
+    if (missing.code != core::ErrorCode::kNotFound) {
+        return missing;
+    }
+    auto source = SelectObject(db, op.source_bucket, op.source_object);
+    if (!source.ok() || !source.value().inline_data) {
+        return missing;
+    }
+    auto copy = std::move(source.value());
+    copy.name = object_name;
+    auto upsert = UpsertObjectRow(db, op.bucket, copy);
+    if (!upsert.ok()) {
+        return upsert.error();
+    }
+    DeleteObjectLayout(db, upsert.value().id);
+    return core::Ok();
 }
 
-core::Result<MultipartUpload> SqliteMetadataStore::GetMultipartUpload(const std::string& upload_id) {
-    MultipartUpload upload;
-    std::string upload_id_value = upload_id;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT id, upload_id, bucket_id, object_name, state, expires_at, created_at, "
-            "updated_at FROM multipart_uploads WHERE upload_id = ?",
-        use(upload_id_value), into(upload.id), into(upload.upload_id), into(upload.bucket_id),
-        into(upload.object_name), into(upload.state), into(upload.expires_at),
-        into(upload.created_at), into(upload.updated_at), now;
+core::Result<MultipartUpload> InsertUploadRow(SqliteConnection& db, const std::string& bucket,
+                                              const std::string& upload_id,
+                                              const std::string& object_name,
+                                              const std::string& expires_at) {
+    // Expiry is compared numerically, so it must parse rather than fall back to text.
+    const auto expires_seconds = core::ParseIso8601(expires_at);
+    if (!expires_seconds) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid expires_at timestamp"};
+    }
+    const std::string now_time = core::NowIso8601();
+    try {
+        // State 1 is "initiated"; see BindUploadState.
+        auto query = db.Query(
+            "INSERT INTO multipart_uploads(upload_id, bucket_id, object_name, state, "
+            "expires_at, created_at, updated_at) "
+            "SELECT ?, id, ?, 1, ?, ?, ? FROM buckets WHERE name = ? "
+            "RETURNING id, upload_id, bucket_id, object_name, state, expires_at, "
+            "created_at, updated_at, part_size");
+        BindId(query, upload_id);
+        query.Bind(object_name).Bind(*expires_seconds);
+        BindTime(query, now_time);
+        BindTime(query, now_time);
+        query.Bind(bucket);
+        if (!query.Next()) {
+            return core::Error{core::ErrorCode::kNotFound, "bucket not found"};
+        }
+        return ReadUpload(query);
+    } catch (const SqliteError& ex) {
+        if (ex.IsConstraint()) {
+            return core::Error{core::ErrorCode::kAlreadyExists, ex.what()};
+        }
+        throw;
+    }
+}
 
-    if (upload.upload_id.empty()) {
-        return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+// Runs inside the batch transaction, so a condition checked here still holds when the op's
+// own statements run.
+core::Result<void> RunBatchOp(SqliteConnection& db, const BatchOp& op, BatchOpResult& result) {
+    std::optional<MultipartUpload> upload;
+    if (!op.expect_upload_state.empty() ||
+        (op.object_name.empty() && (op.type == BatchOpType::kAllocateWrite || IsCommitOp(op)))) {
+        auto selected = SelectMultipartUpload(db, op.upload_id);
+        if (!selected.ok()) {
+            return selected.error();
+        }
+        auto checked = CheckUploadState(op, selected.value().state);
+        if (!checked.ok()) {
+            return checked;
+        }
+        upload = std::move(selected.value());
     }
-    return upload;
+    const auto& object_name = op.object_name.empty() && upload ? upload->object_name
+                                                               : op.object_name;
+    switch (op.type) {
+        case BatchOpType::kGetBucket: {
+            auto bucket = SelectBucket(db, op.bucket);
+            if (!bucket.ok()) {
+                return bucket.error();
+            }
+            result.bucket = std::move(bucket.value());
+            return core::Ok();
+        }
+        case BatchOpType::kGetMultipartUpload: {
+            if (upload) {
+                result.upload = std::move(*upload);
+                return core::Ok();
+            }
+            auto selected = SelectMultipartUpload(db, op.upload_id);
+            if (!selected.ok()) {
+                return selected.error();
+            }
+            result.upload = std::move(selected.value());
+            return core::Ok();
+        }
+        case BatchOpType::kListMultipartParts:
+            result.parts = SelectParts(db, op.upload_id, op.part_number_marker,
+                                       op.max_parts > 0 ? op.max_parts : -1);
+            return core::Ok();
+        case BatchOpType::kAllocateWrite: {
+            auto plan = PlanWrite(db, op.bucket, object_name, op.replication_factor,
+                                  op.service_token);
+            if (!plan.ok()) {
+                return plan.error();
+            }
+            result.write_plan = std::move(plan.value());
+            return core::Ok();
+        }
+        case BatchOpType::kCommitWrite:
+            return CommitWriteRows(db, op.bucket, object_name, op.blob_id, op.size_bytes, op.etag,
+                                   op.replicas);
+        case BatchOpType::kCommitManifest:
+            return CommitManifestRows(db, op, object_name);
+        case BatchOpType::kCopyObject: {
+            auto source = SelectReadPlan(db, op.source_bucket, op.source_object);
+            if (!source.ok()) {
+                return CopyInlineRow(db, op, object_name, source.error());
+            }
+            auto& plan = source.value();
+            core::Result<void> copied = core::Ok();
+            if (plan.segments.empty()) {
+                copied = CommitWriteRows(db, op.bucket, object_name, plan.blob_id,
+                                         plan.size_bytes, plan.etag, plan.replicas);
+            } else {
+                BatchOp manifest;
+                manifest.bucket = op.bucket;
+                manifest.size_bytes = plan.size_bytes;
+                manifest.etag = plan.etag;
+                manifest.segments = plan.segments;
+                copied = CommitManifestRows(db, manifest, object_name);
+            }
+            if (!copied.ok()) {
+                return copied;
+            }
+            result.read_plan = std::move(plan);
+            return core::Ok();
+        }
+        case BatchOpType::kDeleteObject: {
+            auto plan = SelectReadPlan(db, op.bucket, object_name);
+            auto deleted = DeleteObjectRow(db, op.bucket, object_name);
+            if (!deleted.ok()) {
+                return deleted;
+            }
+            // Local objects have no read plan, so the row count says whether one was there;
+            // the bucket lookup a miss runs does not reset it.
+            result.removed = db.Changes() > 0;
+            if (plan.ok()) {
+                result.blob_references = CountBlobReferences(db, plan.value());
+                result.read_plan = std::move(plan.value());
+            }
+            return core::Ok();
+        }
+        case BatchOpType::kUpdateMultipartUploadState:
+            return UpdateUploadStateRow(db, op.upload_id, op.state);
+        case BatchOpType::kSetMultipartPartSize:
+            return UpdateUploadPartSizeRow(db, op.upload_id, op.part_size);
+        case BatchOpType::kCreateMultipartUpload: {
+            auto created = InsertUploadRow(db, op.bucket, op.upload_id, object_name, op.expires_at);
+            if (!created.ok()) {
+                return created.error();
+            }
+            result.upload = std::move(created.value());
+            return core::Ok();
+        }
+        case BatchOpType::kDeleteMultipartParts:
+            DeletePartRows(db, op.upload_id);
+            return core::Ok();
+        case BatchOpType::kDeleteMultipartUpload:
+            DeleteUploadRow(db, op.upload_id);
+            return core::Ok();
+        case BatchOpType::kAcquireLease: {
+            const auto current = SelectLease(db, op.lease);
+            auto lease = AcquireLease(op, current ? &*current : nullptr);
+            if (!lease.ok()) {
+                return lease.error();
+            }
+            UpsertLeaseRow(db, lease.value());
+            result.lease = std::move(lease.value());
+            return core::Ok();
+        }
+        case BatchOpType::kCheckLease: {
+            const auto current = SelectLease(db, op.lease);
+            return CheckLease(op, current ? &*current : nullptr);
+        }
+        case BatchOpType::kGetBucketStats:
+        case BatchOpType::kRepairBucketStats: {
+            if (op.type == BatchOpType::kRepairBucketStats) {
+                auto bucket = SelectBucket(db, op.bucket);
+                if (!bucket.ok()) {
+                    return bucket.error();
+                }
+                RecountBucketStats(db, bucket.value().id);
+            }
+            auto stats = SelectBucketStats(db, op.bucket);
+            if (!stats.ok()) {
+                return stats.error();
+            }
+            result.stats = stats.value();
+            return core::Ok();
+        }
+    }
+    return core::Error{core::ErrorCode::kInvalidArgument, "unknown batch op"};
 }
 
-core::Result<std::vector<MultipartUpload>> SqliteMetadataStore::ListExpiredMultipartUploads(
-    const std::string& expires_before, int limit) {
-    std::vector<MultipartUpload> uploads;
-    MultipartUpload upload;
+}  // namespace
 
-    std::string cutoff_value = expires_before;
-    int limit_value = limit;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT id, upload_id, bucket_id, object_name, state, expires_at, created_at, "
-            "updated_at FROM multipart_uploads "
-            "WHERE state IN ('initiated', 'uploading') AND expires_at < ? "
-            "ORDER BY expires_at ASC LIMIT ?",
-        use(cutoff_value), use(limit_value), into(upload.id), into(upload.upload_id),
-        into(upload.bucket_id), into(upload.object_name), into(upload.state),
-        into(upload.expires_at), into(upload.created_at), into(upload.updated_at), range(0, 1);
+template <typename Fn>
+auto SqliteMetadataStore::Read(Fn&& fn) -> decltype(fn(std::declval<SqliteConnection&>())) {
+    if (readers_.empty()) {
+        return Write(std::forward<Fn>(fn));
+    }
 
-    while (!select.done()) {
-        upload = {};
-        select.execute();
-        if (select.done() && upload.upload_id.empty()) {
-            break;
+    SqliteConnection* db = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(reader_mutex_);
+        reader_cv_.wait(lock, [this] { return !idle_readers_.empty(); });
+        db = idle_readers_.back();
+        idle_readers_.pop_back();
+    }
+    // Return the connection even when a query throws.
+    struct Release {
+        SqliteMetadataStore* store;
+        SqliteConnection* db;
+        ~Release() {
+            {
+                std::lock_guard<std::mutex> lock(store->reader_mutex_);
+                store->idle_readers_.push_back(db);
+            }
+            store->reader_cv_.notify_one();
         }
-        if (!upload.upload_id.empty()) {
-            uploads.push_back(upload);
+    } release{this, db};
+
+    try {
+        return fn(*db);
+    } catch (const SqliteError& ex) {
+        return core::Error{core::ErrorCode::kDbError, ex.what()};
+    }
+}
+
+template <typename Fn>
+auto SqliteMetadataStore::Write(Fn&& fn) -> decltype(fn(std::declval<SqliteConnection&>())) {
+    using ResultType = decltype(fn(std::declval<SqliteConnection&>()));
+    auto run = [&]() -> ResultType {
+        try {
+            return fn(writer_);
+        } catch (const SqliteError& ex) {
+            return core::Error{core::ErrorCode::kDbError, ex.what()};
         }
+    };
+    if (std::this_thread::get_id() == writer_thread_.get_id()) {
+        // Already inside the group transaction (and the caller's savepoint).
+        return run();
     }
 
-    return uploads;
+    std::optional<ResultType> result;
+    std::promise<void> done;
+    auto finished = done.get_future();
+    // A replicated apply pins the clock on its own thread; the writer must see the same time.
+    const auto clock = core::ClockOverride();
+    WriteTask task{[&] {
+                       std::optional<core::ScopedClockOverride> pinned;
+                       if (clock) {
+                           pinned.emplace(*clock);
+                       }
+                       try {
+                           result.emplace(run());
+                       } catch (const std::exception& ex) {
+                           // Escaping would take down the writer thread for every caller.
+                           result.emplace(core::Error{core::ErrorCode::kInternal, ex.what()});
+                       }
+                       return result->ok();
+                   },
+                   [&](const core::Error* failure) {
+                       if (failure) {
+                           result.emplace(*failure);
+                       }
+                       done.set_value();
+                   }};
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        write_queue_.push_back(std::move(task));
+    }
+    queue_cv_.notify_one();
+    finished.wait();
+    return std::move(*result);
 }
 
-core::Result<void> SqliteMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
-                                                                   const std::string& state) {
-    auto upload = GetMultipartUpload(upload_id);
-    if (!upload.ok()) {
-        return upload.error();
+SqliteMetadataStore::SqliteMetadataStore(const std::string& db_path, int reader_connections)
+    : writer_(db_path, false) {
+    InitSchema();
+
+    // Readers are opened after the writer has switched the file to WAL so they never block it.
+    for (int i = 0; i < reader_connections; ++i) {
+        readers_.push_back(std::make_unique<SqliteConnection>(db_path, true));
+        idle_readers_.push_back(readers_.back().get());
     }
 
-    std::string now_time = core::NowIso8601();
-    std::string upload_id_value = upload_id;
-    std::string state_value = state;
-    Poco::Data::Statement update(session_);
-    update << "UPDATE multipart_uploads SET state = ?, updated_at = ? WHERE upload_id = ?",
-        use(state_value), use(now_time), use(upload_id_value), now;
-    return core::Ok();
+    writer_thread_ = std::thread([this] { WriterLoop(); });
 }
 
-core::Result<void> SqliteMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
-    std::string upload_id_value = upload_id;
-    Poco::Data::Statement del(session_);
-    del << "DELETE FROM multipart_uploads WHERE upload_id = ?", use(upload_id_value), now;
-    return core::Ok();
+SqliteMetadataStore::~SqliteMetadataStore() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_one();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
 }
 
-core::Result<MultipartPart> SqliteMetadataStore::UpsertMultipartPart(
-    const std::string& upload_id, int part_number, std::uint64_t size_bytes, const std::string& etag,
-    const std::string& temp_path) {
-    auto upload = GetMultipartUpload(upload_id);
-    if (!upload.ok()) {
-        return upload.error();
+void SqliteMetadataStore::WriterLoop() {
+    std::vector<WriteTask> group;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !write_queue_.empty(); });
+            if (write_queue_.empty()) {
+                return;
+            }
+            // Everything that queued up during the previous commit shares the next one.
+            while (!write_queue_.empty() && group.size() < kMaxGroupCommit) {
+                group.push_back(std::move(write_queue_.front()));
+                write_queue_.pop_front();
+            }
+        }
+        CommitGroup(group);
+        group.clear();
     }
+}
 
-    std::string now_time = core::NowIso8601();
+void SqliteMetadataStore::CommitGroup(std::vector<WriteTask>& group) {
+    std::optional<core::Error> failure;
     try {
-        std::string upload_id_value = upload_id;
-        int part_number_value = part_number;
-        std::uint64_t size_bytes_value = size_bytes;
-        std::string etag_value = etag;
-        std::string temp_path_value = temp_path;
-        session_ <<
-                "INSERT INTO multipart_parts(upload_id, part_number, size_bytes, etag, temp_path, "
-                "created_at) VALUES(?, ?, ?, ?, ?, ?) "
-                "ON CONFLICT(upload_id, part_number) DO UPDATE SET "
-                "size_bytes=excluded.size_bytes, etag=excluded.etag, temp_path=excluded.temp_path",
-            use(upload_id_value), use(part_number_value), use(size_bytes_value), use(etag_value),
-            use(temp_path_value), use(now_time), now;
-    } catch (const Poco::Exception& ex) {
-        return core::Error{core::ErrorCode::kDbError, ex.displayText()};
-    }
-
-    std::string upload_id_value = upload_id;
-    int part_number_value = part_number;
-    MultipartPart part;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT id, upload_id, part_number, size_bytes, etag, temp_path, created_at "
-            "FROM multipart_parts WHERE upload_id = ? AND part_number = ?",
-        use(upload_id_value), use(part_number_value), into(part.id), into(part.upload_id),
-        into(part.part_number), into(part.size_bytes), into(part.etag), into(part.temp_path),
-        into(part.created_at), now;
-    return part;
+        SqliteTransaction txn(writer_);
+        for (auto& task : group) {
+            {
+                SqliteTransaction savepoint(writer_);
+                if (task.run()) {
+                    savepoint.Commit();
+                }
+            }
+            // Some errors (SQLITE_FULL, I/O errors) make SQLite roll back the whole
+            // transaction; later tasks would then run in autocommit, so stop here.
+            if (!writer_.InTransaction()) {
+                failure = core::Error{core::ErrorCode::kDbError,
+                                      "group transaction was rolled back by SQLite"};
+                break;
+            }
+        }
+        if (!failure) {
+            txn.Commit();
+        }
+    } catch (const SqliteError& ex) {
+        failure = core::Error{core::ErrorCode::kDbError, ex.what()};
+    }
+    observability::RecordMetadataGroupCommit(group.size());
+    for (auto& task : group) {
+        task.finish(failure ? &*failure : nullptr);
+    }
 }
 
-core::Result<std::vector<MultipartPart>> SqliteMetadataStore::ListMultipartParts(
-    const std::string& upload_id) {
-    std::vector<MultipartPart> parts;
-    MultipartPart part;
-
-    std::string upload_id_value = upload_id;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT id, upload_id, part_number, size_bytes, etag, temp_path, created_at "
-            "FROM multipart_parts WHERE upload_id = ? ORDER BY part_number ASC",
-        use(upload_id_value), into(part.id), into(part.upload_id), into(part.part_number),
-        into(part.size_bytes), into(part.etag), into(part.temp_path), into(part.created_at),
-        range(0, 1);
+void SqliteMetadataStore::InitSchema() {
+    writer_.Execute("PRAGMA foreign_keys = ON");
+    // WAL lets the reader pool run alongside the single writer without SQLITE_BUSY churn.
+    writer_.Execute("PRAGMA journal_mode = WAL");
+    MigrateSchema(writer_);
+}
 
-    while (!select.done()) {
-        part = {};
-        select.execute();
-        if (select.done() && part.upload_id.empty()) {
-            break;
+core::Result<Bucket> SqliteMetadataStore::CreateBucket(const std::string& name) {
+    return Write([&](SqliteConnection& db) -> core::Result<Bucket> {
+        try {
+            auto query = db.Query(
+                "INSERT INTO buckets(name, created_at) VALUES(?, ?) "
+                "RETURNING id, name, created_at");
+            query.Bind(name);
+            BindTime(query, core::NowIso8601());
+            query.Next();
+            return ReadBucket(query);
+        } catch (const SqliteError& ex) {
+            // SQLite uniqueness errors surface here; map them to a conflict-like error.
+            if (ex.IsConstraint()) {
+                return core::Error{core::ErrorCode::kAlreadyExists, ex.what()};
+            }
+            throw;
         }
-        if (!part.upload_id.empty()) {
-            parts.push_back(part);
+    });
+}
+
+core::Result<std::vector<Bucket>> SqliteMetadataStore::ListBuckets() {
+    return Read([&](SqliteConnection& db) -> core::Result<std::vector<Bucket>> {
+        std::vector<Bucket> buckets;
+        auto query = db.Query("SELECT id, name, created_at FROM buckets ORDER BY name ASC");
+        while (query.Next()) {
+            buckets.push_back(ReadBucket(query));
         }
+        return buckets;
+    });
+}
+
+core::Result<Bucket> SqliteMetadataStore::GetBucket(const std::string& name) {
+    return Read([&](SqliteConnection& db) { return SelectBucket(db, name); });
+}
+
+core::Result<ObjectMetadata> SqliteMetadataStore::UpsertObject(const std::string& bucket,
+                                                               const ObjectMetadata& object) {
+    return Write([&](SqliteConnection& db) { return UpsertObjectRow(db, bucket, object); });
+}
+
+core::Result<ObjectMetadata> SqliteMetadataStore::GetObject(const std::string& bucket,
+                                                            const std::string& object) {
+    return Read([&](SqliteConnection& db) { return SelectObject(db, bucket, object); });
+}
+
+core::Result<std::vector<ObjectMetadata>> SqliteMetadataStore::ListObjects(
+    const std::string& bucket, const std::string& prefix) {
+    return Read([&](SqliteConnection& db) -> core::Result<std::vector<ObjectMetadata>> {
+        std::vector<ObjectMetadata> objects;
+        ScanObjects(db, bucket, prefix, PrefixUpperBound(prefix), [&](ObjectMetadata&& object) {
+            objects.push_back(std::move(object));
+            return true;
+        });
+        return objects;
+    });
+}
+
+core::Result<ObjectListing> SqliteMetadataStore::ListObjectsPage(
+    const std::string& bucket, const ListObjectsOptions& options) {
+    return Read([&](SqliteConnection& db) -> core::Result<ObjectListing> {
+        // Delimiter re-seeks reuse this leased connection and its cached scan statements.
+        return BuildObjectListing(options, [&](const std::string& lower, const std::string& upper,
+                                               const auto& visit) {
+            ScanObjects(db, bucket, lower, upper, visit);
+        });
+    });
+}
+
+core::Result<void> SqliteMetadataStore::DeleteObject(const std::string& bucket,
+                                                     const std::string& object) {
+    return Write(
+        [&](SqliteConnection& db) { return DeleteObjectRow(db, bucket, object); });
+}
+
+core::Result<MultipartUpload> SqliteMetadataStore::CreateMultipartUpload(
+    const std::string& bucket, const std::string& upload_id, const std::string& object_name,
+    const std::string& expires_at) {
+    return Write([&](SqliteConnection& db) {
+        return InsertUploadRow(db, bucket, upload_id, object_name, expires_at);
+    });
+}
+
+core::Result<MultipartUpload> SqliteMetadataStore::GetMultipartUpload(const std::string& upload_id) {
+    return Read([&](SqliteConnection& db) { return SelectMultipartUpload(db, upload_id); });
+}
+
+core::Result<std::vector<MultipartUpload>> SqliteMetadataStore::ListExpiredMultipartUploads(
+    const std::string& expires_before, int limit) {
+    const auto expires_seconds = core::ParseIso8601(expires_before);
+    if (!expires_seconds) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid expires_before timestamp"};
     }
+    return Read([&](SqliteConnection& db) -> core::Result<std::vector<MultipartUpload>> {
+        std::vector<MultipartUpload> uploads;
+        // Codes 1, 2 and 5 are "initiated", "uploading" and "expired"; expired uploads are ones
+        // a sweep retired but has not finished deleting.
+        auto query = db.Query(
+            "SELECT id, upload_id, bucket_id, object_name, state, expires_at, created_at, "
+            "updated_at, part_size FROM multipart_uploads "
+            "WHERE state IN (1, 2, 5) AND expires_at < ? "
+            "ORDER BY expires_at ASC LIMIT ?");
+        query.Bind(*expires_seconds).Bind(limit);
+        while (query.Next()) {
+            uploads.push_back(ReadUpload(query));
+        }
+        return uploads;
+    });
+}
 
-    return parts;
+core::Result<void> SqliteMetadataStore::UpdateMultipartUploadState(const std::string& upload_id,
+                                                                   const std::string& state) {
+    return Write(
+        [&](SqliteConnection& db) { return UpdateUploadStateRow(db, upload_id, state); });
+}
+
+core::Result<void> SqliteMetadataStore::DeleteMultipartUpload(const std::string& upload_id) {
+    return Write([&](SqliteConnection& db) -> core::Result<void> {
+        DeleteUploadRow(db, upload_id);
+        return core::Ok();
+    });
+}
+
+core::Result<MultipartPart> SqliteMetadataStore::UpsertMultipartPart(
+    const std::string& upload_id, int part_number, std::uint64_t size_bytes, const std::string& etag,
+    const std::string& temp_path) {
+    return Write([&](SqliteConnection& db) -> core::Result<MultipartPart> {
+        auto query = db.Query(
+            "INSERT INTO multipart_parts(upload_id, part_number, size_bytes, etag, temp_path, "
+            "created_at) "
+            "SELECT upload_id, ?, ?, ?, ?, ? FROM multipart_uploads WHERE upload_id = ? "
+            "ON CONFLICT(upload_id, part_number) DO UPDATE SET "
+            "size_bytes=excluded.size_bytes, etag=excluded.etag, temp_path=excluded.temp_path "
+            "RETURNING id, upload_id, part_number, size_bytes, etag, temp_path, created_at");
+        query.Bind(part_number).Bind(static_cast<std::int64_t>(size_bytes));
+        BindDigest(query, etag);
+        query.Bind(temp_path);
+        BindTime(query, core::NowIso8601());
+        BindId(query, upload_id);
+        if (!query.Next()) {
+            return core::Error{core::ErrorCode::kNotFound, "multipart upload not found"};
+        }
+        return ReadPart(query);
+    });
+}
+
+core::Result<std::vector<MultipartPart>> SqliteMetadataStore::ListMultipartParts(
+    const std::string& upload_id) {
+    return Read([&](SqliteConnection& db) -> core::Result<std::vector<MultipartPart>> {
+        return SelectParts(db, upload_id);
+    });
 }
 
 core::Result<void> SqliteMetadataStore::DeleteMultipartParts(const std::string& upload_id) {
-    std::string upload_id_value = upload_id;
-    Poco::Data::Statement del(session_);
-    del << "DELETE FROM multipart_parts WHERE upload_id = ?", use(upload_id_value), now;
-    return core::Ok();
+    return Write([&](SqliteConnection& db) -> core::Result<void> {
+        DeletePartRows(db, upload_id);
+        return core::Ok();
+    });
 }
 
 core::Result<void> SqliteMetadataStore::ConfigureStorageNodes(
     const std::vector<std::string>& endpoints) {
-    try {
-        session_ << "DELETE FROM storage_nodes", now;
+    return Write([&](SqliteConnection& db) -> core::Result<void> {
         const auto now_time = core::NowIso8601();
+        SqliteTransaction txn(db);
+        // Retire nodes instead of deleting them: node ids are referenced by object_replicas and
+        // a DELETE would cascade through every replica row on each restart.
+        auto retire = db.Query("UPDATE storage_nodes SET status = 'inactive', updated_at = ?");
+        BindTime(retire, now_time);
+        retire.Run();
         for (const auto& endpoint : endpoints) {
-            std::string endpoint_value = endpoint;
-            std::string status_value = "active";
-            std::string updated_at_value = now_time;
-            session_ <<
-                    "INSERT INTO storage_nodes(endpoint, status, updated_at) VALUES(?, ?, ?)",
-                use(endpoint_value), use(status_value), use(updated_at_value), now;
+            auto insert = db.Query(
+                "INSERT INTO storage_nodes(endpoint, status, updated_at) VALUES(?, 'active', ?) "
+                "ON CONFLICT(endpoint) DO UPDATE SET status = 'active', "
+                "updated_at = excluded.updated_at");
+            insert.Bind(endpoint);
+            BindTime(insert, now_time);
+            insert.Run();
         }
+        txn.Commit();
         return core::Ok();
-    } catch (const Poco::Exception& ex) {
-        return core::Error{core::ErrorCode::kDbError, ex.displayText()};
-    }
+    });
 }
 
 core::Result<AllocateWritePlan> SqliteMetadataStore::AllocateWrite(
     const std::string& bucket, const std::string& object_name, int replication_factor,
     const std::string& service_token) {
-    auto bucket_result = GetBucket(bucket);
-    if (!bucket_result.ok()) {
-        return bucket_result.error();
-    }
-    if (!storage::LocalStorage::IsSafeName(object_name)) {
-        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object name"};
-    }
-
-    AllocateWritePlan plan;
-    plan.blob_id = Poco::UUIDGenerator().createOne().toString();
-    plan.write_token =
-        nebulafs::distributed::CreatePlacementToken(plan.blob_id, "write", 120, service_token);
-
-    int id = 0;
-    std::string endpoint;
-    Poco::Data::Statement select(session_);
-    select << "SELECT id, endpoint FROM storage_nodes WHERE status = 'active' ORDER BY id ASC",
-        into(id), into(endpoint), range(0, 1);
-
-    int index = 0;
-    while (!select.done() && index < replication_factor) {
-        id = 0;
-        endpoint.clear();
-        select.execute();
-        if (!endpoint.empty()) {
-            plan.replicas.push_back(ReplicaTarget{id, index, endpoint});
-            ++index;
-        }
-    }
-    if (static_cast<int>(plan.replicas.size()) < replication_factor) {
-        return core::Error{core::ErrorCode::kInternal, "insufficient active storage nodes"};
-    }
-    return plan;
+    return Read([&](SqliteConnection& db) {
+        return PlanWrite(db, bucket, object_name, replication_factor, service_token);
+    });
 }
 
 core::Result<void> SqliteMetadataStore::CommitWrite(const std::string& bucket,
@@ -494,79 +1053,48 @@ core::Result<void> SqliteMetadataStore::CommitWrite(const std::string& bucket,
                                                     std::uint64_t size_bytes,
                                                     const std::string& etag,
                                                     const std::vector<ReplicaTarget>& replicas) {
-    nebulafs::metadata::ObjectMetadata object;
-    object.name = object_name;
-    object.size_bytes = size_bytes;
-    object.etag = etag;
-    auto upsert = UpsertObject(bucket, object);
-    if (!upsert.ok()) {
-        return upsert.error();
-    }
-
-    std::string now_time = core::NowIso8601();
-    int object_id = upsert.value().id;
-    try {
-        session_ << "DELETE FROM object_replicas WHERE object_id = ?", use(object_id), now;
-        for (const auto& replica : replicas) {
-            int node_id_value = replica.node_id;
-            int replica_index_value = replica.replica_index;
-            std::string blob_id_value = blob_id;
-            std::string state_value = "committed";
-            std::string checksum_value = etag;
-            std::string updated_at_value = now_time;
-            session_ <<
-                    "INSERT INTO object_replicas(object_id, node_id, blob_id, replica_index, "
-                    "state, checksum, updated_at) VALUES(?, ?, ?, ?, ?, ?, ?)",
-                use(object_id), use(node_id_value), use(blob_id_value), use(replica_index_value),
-                use(state_value), use(checksum_value), use(updated_at_value), now;
+    return Write([&](SqliteConnection& db) -> core::Result<void> {
+        // Inside the writer's group transaction this is a savepoint, so a failure partway
+        // through leaves neither the object nor any of its replica rows behind.
+        SqliteTransaction txn(db);
+        auto committed =
+            CommitWriteRows(db, bucket, object_name, blob_id, size_bytes, etag, replicas);
+        if (!committed.ok()) {
+            return committed;
         }
+        txn.Commit();
         return core::Ok();
-    } catch (const Poco::Exception& ex) {
-        return core::Error{core::ErrorCode::kDbError, ex.displayText()};
-    }
+    });
 }
 
 core::Result<ResolveReadPlan> SqliteMetadataStore::ResolveRead(const std::string& bucket,
                                                                const std::string& object_name) {
-    auto object = GetObject(bucket, object_name);
-    if (!object.ok()) {
-        return object.error();
-    }
+    return Read([&](SqliteConnection& db) -> core::Result<ResolveReadPlan> {
+        return SelectReadPlan(db, bucket, object_name);
+    });
+}
 
-    ResolveReadPlan plan;
-    plan.size_bytes = object.value().size_bytes;
-    plan.etag = object.value().etag;
-
-    int node_id = 0;
-    int replica_index = 0;
-    std::string endpoint;
-    std::string blob_id;
-    Poco::Data::Statement select(session_);
-    select <<
-            "SELECT r.node_id, r.replica_index, s.endpoint, r.blob_id "
-            "FROM object_replicas r JOIN storage_nodes s ON r.node_id = s.id "
-            "WHERE r.object_id = ? AND r.state = 'committed' "
-            "ORDER BY r.replica_index ASC",
-        use(object.value().id), into(node_id), into(replica_index), into(endpoint), into(blob_id),
-        range(0, 1);
-
-    while (!select.done()) {
-        node_id = 0;
-        replica_index = 0;
-        endpoint.clear();
-        blob_id.clear();
-        select.execute();
-        if (!endpoint.empty() && !blob_id.empty()) {
-            if (plan.blob_id.empty()) {
-                plan.blob_id = blob_id;
+core::Result<std::vector<BatchOpResult>> SqliteMetadataStore::ExecuteBatch(
+    const std::vector<BatchOp>& ops) {
+    const bool read_only = IsReadOnlyBatch(ops);
+    auto run = [&](SqliteConnection& db) -> core::Result<std::vector<BatchOpResult>> {
+        // The whole batch is one transaction (a savepoint of the writer's group commit);
+        // returning early rolls every earlier op back.
+        SqliteTransaction txn(db, read_only);
+        std::vector<BatchOpResult> results(ops.size());
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            auto ran = RunBatchOp(db, ops[i], results[i]);
+            if (!ran.ok()) {
+                return BatchOpError(i, ops[i], ran.error());
             }
-            plan.replicas.push_back(ReplicaTarget{node_id, replica_index, endpoint});
         }
+        txn.Commit();
+        return results;
+    };
+    if (read_only) {
+        return Read(run);
     }
-    if (plan.replicas.empty()) {
-        return core::Error{core::ErrorCode::kNotFound, "object has no committed replicas"};
-    }
-    return plan;
+    return Write(run);
 }
 
 }  // namespace nebulafs::metadata
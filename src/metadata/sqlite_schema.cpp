@@ -0,0 +1,649 @@
+#include "nebulafs/metadata/sqlite_schema.h"
+
+#include <array>
+#include <cstdint>
+
+#include "nebulafs/core/logger.h"
+#include "nebulafs/core/time.h"
+
+namespace nebulafs::metadata {
+
+namespace {
+
+// Append-only: a state's code is its position plus one, and files keep the codes they hold.
+constexpr std::array<std::string_view, 5> kUploadStates{"initiated", "uploading", "completed",
+                                                       "aborted", "expired"};
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Only lowercase hex converts, so the bytes always format back to the original text.
+bool DecodeHex(std::string_view hex, std::string& bytes) {
+    if (hex.empty() || hex.size() % 2 != 0) {
+        return false;
+    }
+    bytes.resize(hex.size() / 2);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        const int high = HexValue(hex[2 * i]);
+        const int low = HexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes[i] = static_cast<char>(high << 4 | low);
+    }
+    return true;
+}
+
+void AppendHex(std::string& out, std::string_view bytes) {
+    for (const char byte : bytes) {
+        const auto value = static_cast<unsigned char>(byte);
+        out.push_back(kHexDigits[value >> 4]);
+        out.push_back(kHexDigits[value & 0x0f]);
+    }
+}
+
+bool IsUuidDash(std::size_t index) {
+    return index == 8 || index == 13 || index == 18 || index == 23;
+}
+
+bool EncodeUuid(std::string_view id, std::string& bytes) {
+    if (id.size() != 36) {
+        return false;
+    }
+    std::string hex;
+    hex.reserve(32);
+    for (std::size_t i = 0; i < id.size(); ++i) {
+        if (IsUuidDash(i)) {
+            if (id[i] != '-') {
+                return false;
+            }
+        } else {
+            hex.push_back(id[i]);
+        }
+    }
+    return DecodeHex(hex, bytes);
+}
+
+int UserVersion(SqliteConnection& db) {
+    auto query = db.Query("PRAGMA user_version");
+    return query.Next() ? query.Int(0) : 0;
+}
+
+bool HasTable(SqliteConnection& db, const std::string& name) {
+    auto query = db.Query("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?");
+    query.Bind(name);
+    return query.Next();
+}
+
+// `suffix` lets a migration build the new tables next to the old ones; foreign keys name the
+// final tables, which exist once the migration renames its copies.
+void CreateTablesV2(SqliteConnection& db, const std::string& suffix) {
+    db.Execute(
+        "CREATE TABLE buckets" + suffix + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL UNIQUE,"
+        "created_at INTEGER NOT NULL"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE objects" + suffix + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "bucket_id INTEGER NOT NULL,"
+        "name TEXT NOT NULL,"
+        "size_bytes INTEGER NOT NULL,"
+        "etag BLOB NOT NULL,"
+        "created_at INTEGER NOT NULL,"
+        "updated_at INTEGER NOT NULL,"
+        "UNIQUE(bucket_id, name),"
+        "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE multipart_uploads" + suffix + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "upload_id BLOB NOT NULL UNIQUE,"
+        "bucket_id INTEGER NOT NULL,"
+        "object_name TEXT NOT NULL,"
+        "state INTEGER NOT NULL,"
+        "expires_at INTEGER NOT NULL,"
+        "created_at INTEGER NOT NULL,"
+        "updated_at INTEGER NOT NULL,"
+        "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
+        ")");
+
+    // UNIQUE(upload_id, part_number) already indexes lookups by upload.
+    db.Execute(
+        "CREATE TABLE multipart_parts" + suffix + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "upload_id BLOB NOT NULL,"
+        "part_number INTEGER NOT NULL,"
+        "size_bytes INTEGER NOT NULL,"
+        "etag BLOB NOT NULL,"
+        "temp_path TEXT NOT NULL,"
+        "created_at INTEGER NOT NULL,"
+        "UNIQUE(upload_id, part_number),"
+        "FOREIGN KEY(upload_id) REFERENCES multipart_uploads(upload_id) ON DELETE CASCADE"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE storage_nodes" + suffix + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "endpoint TEXT NOT NULL UNIQUE,"
+        "status TEXT NOT NULL,"
+        "capacity_bytes INTEGER NOT NULL DEFAULT 0,"
+        "free_bytes INTEGER NOT NULL DEFAULT 0,"
+        "updated_at INTEGER NOT NULL"
+        ")");
+
+    // Replica rows are only ever reached through their object, so clustering them on
+    // (object_id, replica_index) replaces both the rowid and the secondary index.
+    db.Execute(
+        "CREATE TABLE object_replicas" + suffix + " ("
+        "object_id INTEGER NOT NULL,"
+        "replica_index INTEGER NOT NULL,"
+        "node_id INTEGER NOT NULL,"
+        "blob_id BLOB NOT NULL,"
+        "state INTEGER NOT NULL,"
+        "checksum BLOB NOT NULL,"
+        "updated_at INTEGER NOT NULL,"
+        "PRIMARY KEY(object_id, replica_index),"
+        "FOREIGN KEY(object_id) REFERENCES objects(id) ON DELETE CASCADE,"
+        "FOREIGN KEY(node_id) REFERENCES storage_nodes(id) ON DELETE CASCADE"
+        ") WITHOUT ROWID");
+}
+
+// Leases are few and always found by name.
+void CreateLeasesTable(SqliteConnection& db) {
+    db.Execute(
+        "CREATE TABLE leases ("
+        "name TEXT PRIMARY KEY,"
+        "holder TEXT NOT NULL,"
+        "fencing_token INTEGER NOT NULL,"
+        "expires_at_ms INTEGER NOT NULL"
+        ") WITHOUT ROWID");
+}
+
+constexpr const char* kRecountBucketStats =
+    "UPDATE bucket_stats SET "
+    "object_count = (SELECT COUNT(*) FROM objects o WHERE o.bucket_id = bucket_stats.bucket_id),"
+    "total_bytes = (SELECT COALESCE(SUM(o.size_bytes), 0) FROM objects o "
+    "WHERE o.bucket_id = bucket_stats.bucket_id),"
+    "multipart_bytes = (SELECT COALESCE(SUM(p.size_bytes), 0) FROM multipart_parts p "
+    "JOIN multipart_uploads u ON p.upload_id = u.upload_id "
+    "WHERE u.bucket_id = bucket_stats.bucket_id)";
+
+// Triggers keep the counters in the same transaction as the row change, whichever statement
+// makes it. Parts reach their bucket through the upload; deleting an upload cascades to its
+// parts after the upload row is gone, so the upload's own trigger takes their bytes out first.
+void CreateBucketStats(SqliteConnection& db) {
+    db.Execute(
+        "CREATE TABLE bucket_stats ("
+        "bucket_id INTEGER PRIMARY KEY,"
+        "object_count INTEGER NOT NULL DEFAULT 0,"
+        "total_bytes INTEGER NOT NULL DEFAULT 0,"
+        "multipart_bytes INTEGER NOT NULL DEFAULT 0,"
+        "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
+        ")");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_bucket_insert AFTER INSERT ON buckets BEGIN "
+        "INSERT INTO bucket_stats(bucket_id) VALUES(NEW.id); END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_object_insert AFTER INSERT ON objects BEGIN "
+        "UPDATE bucket_stats SET object_count = object_count + 1, "
+        "total_bytes = total_bytes + NEW.size_bytes WHERE bucket_id = NEW.bucket_id; END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_object_update AFTER UPDATE OF size_bytes ON objects BEGIN "
+        "UPDATE bucket_stats SET total_bytes = total_bytes - OLD.size_bytes + NEW.size_bytes "
+        "WHERE bucket_id = NEW.bucket_id; END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_object_delete AFTER DELETE ON objects BEGIN "
+        "UPDATE bucket_stats SET object_count = object_count - 1, "
+        "total_bytes = total_bytes - OLD.size_bytes WHERE bucket_id = OLD.bucket_id; END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_part_insert AFTER INSERT ON multipart_parts BEGIN "
+        "UPDATE bucket_stats SET multipart_bytes = multipart_bytes + NEW.size_bytes "
+        "WHERE bucket_id = (SELECT bucket_id FROM multipart_uploads "
+        "WHERE upload_id = NEW.upload_id); END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_part_update AFTER UPDATE OF size_bytes ON multipart_parts "
+        "BEGIN UPDATE bucket_stats SET "
+        "multipart_bytes = multipart_bytes - OLD.size_bytes + NEW.size_bytes "
+        "WHERE bucket_id = (SELECT bucket_id FROM multipart_uploads "
+        "WHERE upload_id = NEW.upload_id); END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_part_delete AFTER DELETE ON multipart_parts BEGIN "
+        "UPDATE bucket_stats SET multipart_bytes = multipart_bytes - OLD.size_bytes "
+        "WHERE bucket_id = (SELECT bucket_id FROM multipart_uploads "
+        "WHERE upload_id = OLD.upload_id); END");
+    db.Execute(
+        "CREATE TRIGGER bucket_stats_upload_delete BEFORE DELETE ON multipart_uploads BEGIN "
+        "UPDATE bucket_stats SET multipart_bytes = multipart_bytes - "
+        "(SELECT COALESCE(SUM(size_bytes), 0) FROM multipart_parts "
+        "WHERE upload_id = OLD.upload_id) WHERE bucket_id = OLD.bucket_id; END");
+}
+
+void MigrateV3ToV4(SqliteConnection& db) {
+    CreateBucketStats(db);
+    db.Execute("INSERT INTO bucket_stats(bucket_id) SELECT id FROM buckets");
+    db.Execute(kRecountBucketStats);
+}
+
+// 0 means the client declared no part size; rows from older versions read as that.
+void AddUploadPartSize(SqliteConnection& db) {
+    db.Execute(
+        "ALTER TABLE multipart_uploads ADD COLUMN part_size INTEGER NOT NULL DEFAULT 0");
+}
+
+// One row per replica of each segment, repeating the segment's blob, offset and etag: a
+// manifest is only ever read whole, so clustering on (object_id, segment_index,
+// replica_index) returns it in order with one range scan and no second table.
+void CreateObjectSegments(SqliteConnection& db) {
+    db.Execute(
+        "CREATE TABLE object_segments ("
+        "object_id INTEGER NOT NULL,"
+        "segment_index INTEGER NOT NULL,"
+        "replica_index INTEGER NOT NULL,"
+        "node_id INTEGER NOT NULL,"
+        "blob_id BLOB NOT NULL,"
+        "byte_offset INTEGER NOT NULL,"
+        "size_bytes INTEGER NOT NULL,"
+        "etag BLOB NOT NULL,"
+        "PRIMARY KEY(object_id, segment_index, replica_index),"
+        "FOREIGN KEY(object_id) REFERENCES objects(id) ON DELETE CASCADE,"
+        "FOREIGN KEY(node_id) REFERENCES storage_nodes(id) ON DELETE CASCADE"
+        ") WITHOUT ROWID");
+}
+
+// NULL for objects whose bytes live in a file or on storage nodes. SQLite keeps a row's
+// trailing NULL columns out of the record, so rows of large objects do not grow.
+void AddObjectInlineData(SqliteConnection& db) {
+    db.Execute("ALTER TABLE objects ADD COLUMN inline_data BLOB");
+}
+
+// A delete asks whether any other object still points at its blobs, which copies share.
+void CreateBlobIndexes(SqliteConnection& db) {
+    db.Execute("CREATE INDEX idx_object_replicas_blob_id ON object_replicas(blob_id)");
+    db.Execute("CREATE INDEX idx_object_segments_blob_id ON object_segments(blob_id)");
+}
+
+// Uploads retired by a cleanup sweep before "expired" had a code hold it as text.
+void CodeExpiredUploads(SqliteConnection& db) {
+    db.Execute("UPDATE multipart_uploads SET state = 5 WHERE state = 'expired'");
+}
+
+void CreateIndexesV2(SqliteConnection& db) {
+    db.Execute(
+        "CREATE INDEX idx_multipart_uploads_expires_at ON multipart_uploads(expires_at)");
+}
+
+void CopyBuckets(SqliteConnection& db) {
+    auto rows = db.Query("SELECT id, name, created_at FROM buckets");
+    while (rows.Next()) {
+        auto insert = db.Query("INSERT INTO buckets_v2(id, name, created_at) VALUES(?, ?, ?)");
+        insert.Bind(rows.Int64(0)).Bind(rows.View(1));
+        BindTime(insert, rows.View(2));
+        insert.Run();
+    }
+}
+
+void CopyObjects(SqliteConnection& db) {
+    auto rows = db.Query(
+        "SELECT id, bucket_id, name, size_bytes, etag, created_at, updated_at FROM objects");
+    while (rows.Next()) {
+        auto insert = db.Query(
+            "INSERT INTO objects_v2(id, bucket_id, name, size_bytes, etag, created_at, "
+            "updated_at) VALUES(?, ?, ?, ?, ?, ?, ?)");
+        insert.Bind(rows.Int64(0)).Bind(rows.Int64(1)).Bind(rows.View(2)).Bind(rows.Int64(3));
+        BindDigest(insert, rows.View(4));
+        BindTime(insert, rows.View(5));
+        BindTime(insert, rows.View(6));
+        insert.Run();
+    }
+}
+
+void CopyUploads(SqliteConnection& db) {
+    auto rows = db.Query(
+        "SELECT id, upload_id, bucket_id, object_name, state, expires_at, created_at, "
+        "updated_at FROM multipart_uploads");
+    while (rows.Next()) {
+        auto insert = db.Query(
+            "INSERT INTO multipart_uploads_v2(id, upload_id, bucket_id, object_name, state, "
+            "expires_at, created_at, updated_at) VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+        insert.Bind(rows.Int64(0));
+        BindId(insert, rows.View(1));
+        insert.Bind(rows.Int64(2)).Bind(rows.View(3));
+        BindUploadState(insert, rows.View(4));
+        BindTime(insert, rows.View(5));
+        BindTime(insert, rows.View(6));
+        BindTime(insert, rows.View(7));
+        insert.Run();
+    }
+}
+
+void CopyParts(SqliteConnection& db) {
+    auto rows = db.Query(
+        "SELECT id, upload_id, part_number, size_bytes, etag, temp_path, created_at "
+        "FROM multipart_parts");
+    while (rows.Next()) {
+        auto insert = db.Query(
+            "INSERT INTO multipart_parts_v2(id, upload_id, part_number, size_bytes, etag, "
+            "temp_path, created_at) VALUES(?, ?, ?, ?, ?, ?, ?)");
+        insert.Bind(rows.Int64(0));
+        BindId(insert, rows.View(1));
+        insert.Bind(rows.Int64(2)).Bind(rows.Int64(3));
+        BindDigest(insert, rows.View(4));
+        insert.Bind(rows.View(5));
+        BindTime(insert, rows.View(6));
+        insert.Run();
+    }
+}
+
+void CopyStorageNodes(SqliteConnection& db) {
+    auto rows = db.Query(
+        "SELECT id, endpoint, status, capacity_bytes, free_bytes, updated_at FROM storage_nodes");
+    while (rows.Next()) {
+        auto insert = db.Query(
+            "INSERT INTO storage_nodes_v2(id, endpoint, status, capacity_bytes, free_bytes, "
+            "updated_at) VALUES(?, ?, ?, ?, ?, ?)");
+        insert.Bind(rows.Int64(0)).Bind(rows.View(1)).Bind(rows.View(2));
+        insert.Bind(rows.Int64(3)).Bind(rows.Int64(4));
+        BindTime(insert, rows.View(5));
+        insert.Run();
+    }
+}
+
+void CopyReplicas(SqliteConnection& db) {
+    auto rows = db.Query(
+        "SELECT object_id, replica_index, node_id, blob_id, state, checksum, updated_at "
+        "FROM object_replicas");
+    while (rows.Next()) {
+        // v1 only ever wrote 'committed' replicas, which v2 stores as state 1.
+        auto insert = db.Query(
+            "INSERT INTO object_replicas_v2(object_id, replica_index, node_id, blob_id, state, "
+            "checksum, updated_at) VALUES(?, ?, ?, ?, CASE WHEN ? = 'committed' THEN 1 ELSE 0 "
+            "END, ?, ?)");
+        insert.Bind(rows.Int64(0)).Bind(rows.Int64(1)).Bind(rows.Int64(2));
+        BindId(insert, rows.View(3));
+        insert.Bind(rows.View(4));
+        BindDigest(insert, rows.View(5));
+        BindTime(insert, rows.View(6));
+        insert.Run();
+    }
+}
+
+// Rebuilds every table in the v2 layout: build copies, convert rows, swap the copies in.
+void MigrateV1ToV2(SqliteConnection& db) {
+    CreateTablesV2(db, "_v2");
+    CopyBuckets(db);
+    CopyObjects(db);
+    CopyUploads(db);
+    CopyParts(db);
+    CopyStorageNodes(db);
+    CopyReplicas(db);
+    for (const char* table : {"object_replicas", "multipart_parts", "multipart_uploads",
+                              "objects", "storage_nodes", "buckets"}) {
+        db.Execute(std::string("DROP TABLE ") + table);
+        db.Execute(std::string("ALTER TABLE ") + table + "_v2 RENAME TO " + table);
+    }
+    CreateIndexesV2(db);
+}
+
+struct Migration {
+    int version;
+    void (*apply)(SqliteConnection& db);
+};
+
+// Append-only: each entry upgrades a database from `version - 1` to `version`.
+constexpr Migration kMigrations[] = {
+    {2, MigrateV1ToV2},
+    {3, CreateLeasesTable},
+    {4, MigrateV3ToV4},
+    {5, AddUploadPartSize},
+    {6, CreateObjectSegments},
+    {7, AddObjectInlineData},
+    {8, CreateBlobIndexes},
+    {9, CodeExpiredUploads},
+};
+
+}  // namespace
+
+int MigrateSchema(SqliteConnection& db) {
+    const int found = UserVersion(db);
+    if (found > kSqliteSchemaVersion) {
+        throw SqliteError(0, "database schema v" + std::to_string(found) +
+                                 " is newer than this build supports (v" +
+                                 std::to_string(kSqliteSchemaVersion) + ")");
+    }
+    if (found == 0 && !HasTable(db, "buckets")) {
+        SqliteTransaction txn(db);
+        CreateTablesV2(db, "");
+        CreateIndexesV2(db);
+        CreateLeasesTable(db);
+        CreateBucketStats(db);
+        AddUploadPartSize(db);
+        CreateObjectSegments(db);
+        AddObjectInlineData(db);
+        CreateBlobIndexes(db);
+        db.Execute("PRAGMA user_version = " + std::to_string(kSqliteSchemaVersion));
+        txn.Commit();
+        return 0;
+    }
+
+    // Files written before versioning carry user_version 0 but hold the v1 tables.
+    int version = found == 0 ? 1 : found;
+    if (version == kSqliteSchemaVersion) {
+        return found;
+    }
+    // Table rebuilds drop tables that others reference; with enforcement on, the DROPs would
+    // cascade. The pragma is ignored inside a transaction, so toggle it around the steps.
+    db.Execute("PRAGMA foreign_keys = OFF");
+    const bool rebuilt = version < 2;
+    for (const auto& migration : kMigrations) {
+        if (migration.version <= version) {
+            continue;
+        }
+        core::LogInfo("metadata: migrating SQLite schema v" + std::to_string(version) +
+                      " -> v" + std::to_string(migration.version));
+        SqliteTransaction txn(db);
+        migration.apply(db);
+        if (migration.version == kSqliteSchemaVersion) {
+            // Nothing enforced references while the steps ran, so a dangling row stops startup
+            // here and the final step rolls back rather than being found by a later write.
+            auto check = db.Query("PRAGMA foreign_key_check");
+            if (check.Next()) {
+                throw SqliteError(0, "schema migration left a dangling reference in " +
+                                         check.Text(0) + " row " +
+                                         std::to_string(check.Int64(1)) + " to " +
+                                         check.Text(2));
+            }
+        }
+        db.Execute("PRAGMA user_version = " + std::to_string(migration.version));
+        txn.Commit();
+        version = migration.version;
+    }
+    db.Execute("PRAGMA foreign_keys = ON");
+    if (rebuilt) {
+        // The v2 rebuild leaves the old tables' pages on the freelist; hand them back to the
+        // filesystem. Later steps only add, so they do not pay for a full copy of the file.
+        db.Execute("VACUUM");
+    }
+    return found;
+}
+
+void RecountBucketStats(SqliteConnection& db, std::int64_t bucket_id) {
+    auto recount = db.Query(std::string(kRecountBucketStats) + " WHERE bucket_id = ?");
+    recount.Bind(bucket_id);
+    recount.Run();
+}
+
+void CreateSchemaV1(SqliteConnection& db) {
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS buckets ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL UNIQUE,"
+        "created_at TEXT NOT NULL"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS objects ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "bucket_id INTEGER NOT NULL,"
+        "name TEXT NOT NULL,"
+        "size_bytes INTEGER NOT NULL,"
+        "etag TEXT NOT NULL,"
+        "created_at TEXT NOT NULL,"
+        "updated_at TEXT NOT NULL,"
+        "UNIQUE(bucket_id, name),"
+        "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS multipart_uploads ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "upload_id TEXT NOT NULL UNIQUE,"
+        "bucket_id INTEGER NOT NULL,"
+        "object_name TEXT NOT NULL,"
+        "state TEXT NOT NULL,"
+        "expires_at TEXT NOT NULL,"
+        "created_at TEXT NOT NULL,"
+        "updated_at TEXT NOT NULL,"
+        "FOREIGN KEY(bucket_id) REFERENCES buckets(id) ON DELETE CASCADE"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS multipart_parts ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "upload_id TEXT NOT NULL,"
+        "part_number INTEGER NOT NULL,"
+        "size_bytes INTEGER NOT NULL,"
+        "etag TEXT NOT NULL,"
+        "temp_path TEXT NOT NULL,"
+        "created_at TEXT NOT NULL,"
+        "UNIQUE(upload_id, part_number),"
+        "FOREIGN KEY(upload_id) REFERENCES multipart_uploads(upload_id) ON DELETE CASCADE"
+        ")");
+
+    db.Execute(
+        "CREATE INDEX IF NOT EXISTS idx_multipart_uploads_expires_at "
+        "ON multipart_uploads(expires_at)");
+    db.Execute(
+        "CREATE INDEX IF NOT EXISTS idx_multipart_parts_upload_id "
+        "ON multipart_parts(upload_id)");
+
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS storage_nodes ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "endpoint TEXT NOT NULL UNIQUE,"
+        "status TEXT NOT NULL,"
+        "capacity_bytes INTEGER NOT NULL DEFAULT 0,"
+        "free_bytes INTEGER NOT NULL DEFAULT 0,"
+        "updated_at TEXT NOT NULL"
+        ")");
+
+    db.Execute(
+        "CREATE TABLE IF NOT EXISTS object_replicas ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "object_id INTEGER NOT NULL,"
+        "node_id INTEGER NOT NULL,"
+        "blob_id TEXT NOT NULL,"
+        "replica_index INTEGER NOT NULL,"
+        "state TEXT NOT NULL,"
+        "checksum TEXT NOT NULL,"
+        "updated_at TEXT NOT NULL,"
+        "UNIQUE(object_id, replica_index),"
+        "FOREIGN KEY(object_id) REFERENCES objects(id) ON DELETE CASCADE,"
+        "FOREIGN KEY(node_id) REFERENCES storage_nodes(id) ON DELETE CASCADE"
+        ")");
+    db.Execute(
+        "CREATE INDEX IF NOT EXISTS idx_object_replicas_object_id "
+        "ON object_replicas(object_id)");
+}
+
+void BindId(SqliteQuery& query, std::string_view id) {
+    std::string bytes;
+    if (EncodeUuid(id, bytes)) {
+        query.BindBlob(bytes);
+    } else {
+        query.Bind(id);
+    }
+}
+
+std::string ReadId(const SqliteQuery& query, int column) {
+    if (!query.IsBlob(column)) {
+        return query.Text(column);
+    }
+    const auto bytes = query.View(column);
+    std::string id;
+    id.reserve(36);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            id.push_back('-');
+        }
+        AppendHex(id, bytes.substr(i, 1));
+    }
+    return id;
+}
+
+void BindDigest(SqliteQuery& query, std::string_view digest) {
+    std::string bytes;
+    if (DecodeHex(digest, bytes)) {
+        query.BindBlob(bytes);
+    } else {
+        query.Bind(digest);
+    }
+}
+
+std::string ReadDigest(const SqliteQuery& query, int column) {
+    if (!query.IsBlob(column)) {
+        return query.Text(column);
+    }
+    std::string hex;
+    AppendHex(hex, query.View(column));
+    return hex;
+}
+
+void BindUploadState(SqliteQuery& query, std::string_view state) {
+    for (std::size_t i = 0; i < kUploadStates.size(); ++i) {
+        if (kUploadStates[i] == state) {
+            query.Bind(static_cast<std::int64_t>(i + 1));
+            return;
+        }
+    }
+    query.Bind(state);
+}
+
+std::string ReadUploadState(const SqliteQuery& query, int column) {
+    if (query.IsInteger(column)) {
+        const auto code = query.Int64(column);
+        if (code >= 1 && code <= static_cast<std::int64_t>(kUploadStates.size())) {
+            return std::string(kUploadStates[static_cast<std::size_t>(code - 1)]);
+        }
+    }
+    return query.Text(column);
+}
+
+void BindTime(SqliteQuery& query, std::string_view iso8601) {
+    const auto seconds = core::ParseIso8601(iso8601);
+    if (seconds) {
+        query.Bind(*seconds);
+    } else {
+        query.Bind(iso8601);
+    }
+}
+
+std::string ReadTime(const SqliteQuery& query, int column) {
+    if (query.IsInteger(column)) {
+        return core::FormatIso8601(query.Int64(column));
+    }
+    return query.Text(column);
+}
+
+}  // namespace nebulafs::metadata
@@ -1,10 +1,14 @@
+#include <algorithm>
 #include <chrono>
-#include <filesystem>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
-#include <Poco/JSON/Array.h>
+#include <Poco/Exception.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Parser.h>
 #include <Poco/Net/HTTPServer.h>
@@ -22,11 +26,20 @@
 #include "nebulafs/core/config.h"
 #include "nebulafs/core/ids.h"
 #include "nebulafs/core/logger.h"
-#include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/metadata/change_feed_metadata_store.h"
+#include "nebulafs/metadata/http_replica_transport.h"
+#include "nebulafs/metadata/metadata_rpc.h"
+#include "nebulafs/metadata/metadata_store_factory.h"
+#include "nebulafs/metadata/object_listing.h"
+#include "nebulafs/metadata/replicated_metadata_store.h"
 #include "nebulafs/observability/metrics.h"
 
 namespace {
 
+// Bounds on one change-feed read; each waiting reader holds a server thread.
+constexpr std::size_t kMaxChangesPerRead = 1000;
+constexpr int kMaxChangesWaitMs = 30000;
+
 std::string GetArgValue(int argc, char** argv, const std::string& key,
                         const std::string& default_value) {
     for (int i = 1; i < argc - 1; ++i) {
@@ -42,14 +55,25 @@ bool IsAuthorized(const Poco::Net::HTTPServerRequest& req, const std::string& to
     return auth == "Bearer " + token;
 }
 
-void WriteJson(Poco::Net::HTTPServerResponse& res, Poco::JSON::Object::Ptr obj,
-               Poco::Net::HTTPResponse::HTTPStatus status = Poco::Net::HTTPResponse::HTTP_OK,
-               const std::string& request_id = "") {
+void SetResponseHeaders(Poco::Net::HTTPServerResponse& res,
+                        Poco::Net::HTTPResponse::HTTPStatus status,
+                        const std::string& request_id, std::string_view content_type) {
     res.setStatus(status);
-    res.setContentType("application/json");
+    res.setContentType(std::string(content_type));
     if (!request_id.empty()) {
         res.set("X-Request-Id", request_id);
     }
+    // Lets clients ask followers for reads at least as new as their own writes.
+    const auto write_index = nebulafs::metadata::ReplicatedMetadataStore::LastWriteIndex();
+    if (write_index != 0) {
+        res.set("X-Nebula-Commit-Index", std::to_string(write_index));
+    }
+}
+
+void WriteJson(Poco::Net::HTTPServerResponse& res, Poco::JSON::Object::Ptr obj,
+               Poco::Net::HTTPResponse::HTTPStatus status = Poco::Net::HTTPResponse::HTTP_OK,
+               const std::string& request_id = "") {
+    SetResponseHeaders(res, status, request_id, "application/json");
     std::ostream& out = res.send();
     obj->stringify(out);
 }
@@ -74,18 +98,87 @@ Poco::JSON::Object::Ptr ParseBody(Poco::Net::HTTPServerRequest& req) {
     return parser.parse(body.str()).extract<Poco::JSON::Object::Ptr>();
 }
 
+std::string GetParam(const Poco::URI& uri, const std::string& key) {
+    for (const auto& p : uri.getQueryParameters()) {
+        if (p.first == key) {
+            return p.second;
+        }
+    }
+    return "";
+}
+
+std::uint64_t GetUInt64Param(const Poco::URI& uri, const std::string& key) {
+    const auto value = GetParam(uri, key);
+    return value.empty() ? 0 : std::stoull(value);
+}
+
 long long ElapsedMs(const std::chrono::steady_clock::time_point& started_at) {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
                std::chrono::steady_clock::now() - started_at)
         .count();
 }
 
+// One internal request. Bodies arrive and replies leave in the format the caller negotiated
+// through Content-Type and Accept; error envelopes are always JSON.
+struct RpcCall {
+    RpcCall(Poco::Net::HTTPServerRequest& request, Poco::Net::HTTPServerResponse& response,
+            const Poco::URI& request_uri, const std::string& id)
+        : req(request),
+          res(response),
+          uri(request_uri),
+          request_id(id),
+          reply_format(nebulafs::core::FormatFromMediaType(request.get("Accept", ""))),
+          decoder(nebulafs::core::FormatFromMediaType(request.getContentType())) {
+    }
+
+    // Decoded string_view fields point into `body` or `decoder`, which live as long as the call.
+    template <typename Msg>
+    Msg ReadRequest() {
+        body.assign(std::istreambuf_iterator<char>(req.stream()), std::istreambuf_iterator<char>());
+        auto decoded = decoder.Decode<Msg>(body);
+        if (!decoded.ok()) {
+            throw Poco::DataFormatException(decoded.error().message);
+        }
+        return std::move(decoded.value());
+    }
+
+    template <typename Msg>
+    void Reply(const Msg& msg) {
+        const auto encoded = nebulafs::core::EncodeWire(reply_format, msg);
+        SetResponseHeaders(res, Poco::Net::HTTPResponse::HTTP_OK, request_id,
+                           nebulafs::core::MediaTypeFor(reply_format));
+        res.sendBuffer(encoded.data(), encoded.size());
+    }
+
+    void Fail(const std::string& code, const std::string& message,
+              Poco::Net::HTTPResponse::HTTPStatus status) {
+        WriteError(res, request_id, code, message, status);
+    }
+
+    void FailInternal(const std::string& message) {
+        Fail("INTERNAL_ERROR", message, Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+    }
+
+    Poco::Net::HTTPServerRequest& req;
+    Poco::Net::HTTPServerResponse& res;
+    const Poco::URI& uri;
+    const std::string& request_id;
+    nebulafs::core::WireFormat reply_format;
+    std::string body;
+    nebulafs::core::WireDecoder decoder;
+};
+
 class MetadataHandler : public Poco::Net::HTTPRequestHandler {
 public:
-    MetadataHandler(std::shared_ptr<nebulafs::metadata::SqliteMetadataStore> store,
-                    std::string token)
+    MetadataHandler(std::shared_ptr<nebulafs::metadata::MetadataStore> store,
+                    std::shared_ptr<nebulafs::metadata::ReplicatedMetadataStore> replicated,
+                    std::shared_ptr<nebulafs::metadata::ChangeFeed> feed, std::string token,
+                    int read_wait_ms)
         : store_(std::move(store)),
-          token_(std::move(token)) {
+          replicated_(std::move(replicated)),
+          feed_(std::move(feed)),
+          token_(std::move(token)),
+          read_wait_ms_(read_wait_ms) {
     }
 
     void handleRequest(Poco::Net::HTTPServerRequest& req,
@@ -93,6 +186,8 @@ public:
         const std::string request_id = nebulafs::core::GenerateRequestId();
         Poco::URI uri(req.getURI());
         const auto path = uri.getPath();
+        // Server threads are pooled; the index must describe this request's write only.
+        nebulafs::metadata::ReplicatedMetadataStore::ResetLastWriteIndex();
 
         try {
             if (path == "/healthz") {
@@ -113,493 +208,474 @@ public:
                                   Poco::Net::HTTPResponse::HTTP_UNAUTHORIZED);
             }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/storage-nodes/configure") {
-                auto body = ParseBody(req);
-                auto arr = body->getArray("endpoints");
-                std::vector<std::string> endpoints;
-                for (size_t i = 0; i < arr->size(); ++i) {
-                    endpoints.push_back(arr->getElement<std::string>(i));
-                }
-                auto result = store_->ConfigureStorageNodes(endpoints);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+            const auto& routes = Routes();
+            const auto route = routes.find(req.getMethod() + " " + path);
+            if (route == routes.end() ||
+                (route->second.access == Access::kReplication && !replicated_)) {
+                return WriteError(res, request_id, "NOT_FOUND", "route not found",
+                                  Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
-
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/buckets/create") {
-                auto body = ParseBody(req);
-                auto result = store_->CreateBucket(body->getValue<std::string>("name"));
-                if (!result.ok()) {
-                    if (result.error().code == nebulafs::core::ErrorCode::kAlreadyExists) {
-                        return WriteError(res, request_id, "ALREADY_EXISTS", "bucket exists",
-                                          Poco::Net::HTTPResponse::HTTP_CONFLICT);
-                    }
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("name", result.value().name);
-                root->set("created_at", result.value().created_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+            if (replicated_ && route->second.access == Access::kFollowerRead) {
+                const auto min_index = std::stoull(req.get("X-Nebula-Min-Index", "0"));
+                auto readable = replicated_->group().AwaitReadable(min_index, read_wait_ms_);
+                if (!readable.ok()) {
+                    return WriteUnavailable(res, request_id, "STALE_REPLICA",
+                                            readable.error().message);
+                }
+            } else if (replicated_ && route->second.access == Access::kLeader &&
+                       !replicated_->group().IsLeader()) {
+                return WriteUnavailable(res, request_id, "NOT_LEADER",
+                                        "writes must go to the leader");
             }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/buckets/list") {
-                auto result = store_->ListBuckets();
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                for (const auto& bucket : result.value()) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("id", bucket.id);
-                    item->set("name", bucket.name);
-                    item->set("created_at", bucket.created_at);
-                    arr->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("buckets", arr);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+            RpcCall call(req, res, uri, request_id);
+            (this->*route->second.handler)(call);
+        } catch (const Poco::Exception& ex) {
+            return WriteError(res, request_id, "INVALID_ARGUMENT", ex.displayText(),
+                              Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+        } catch (const std::exception& ex) {
+            return WriteError(res, request_id, "INTERNAL_ERROR", ex.what(),
+                              Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        }
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/buckets/get") {
-                auto params = uri.getQueryParameters();
-                std::string name;
-                for (const auto& p : params) {
-                    if (p.first == "name") name = p.second;
-                }
-                auto result = store_->GetBucket(name);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "NOT_FOUND", "bucket not found",
-                                      Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("name", result.value().name);
-                root->set("created_at", result.value().created_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+private:
+    // Which replicas may serve a route: the leader only, any member within the staleness bound,
+    // or the replication protocol itself, which runs between members regardless of role.
+    enum class Access { kLeader, kFollowerRead, kReplication };
+
+    struct Route {
+        void (MetadataHandler::*handler)(RpcCall&);
+        Access access;
+    };
+
+    // Keyed by "<METHOD> <path>"; built once and shared by every handler instance.
+    static const std::unordered_map<std::string, Route>& Routes() {
+        static const std::unordered_map<std::string, Route> routes = {
+            {"POST /internal/v1/storage-nodes/configure",
+             {&MetadataHandler::ConfigureStorageNodes, Access::kLeader}},
+            {"POST /internal/v1/buckets/create",
+             {&MetadataHandler::CreateBucket, Access::kLeader}},
+            {"GET /internal/v1/buckets/list",
+             {&MetadataHandler::ListBuckets, Access::kFollowerRead}},
+            {"GET /internal/v1/buckets/get",
+             {&MetadataHandler::GetBucket, Access::kFollowerRead}},
+            {"POST /internal/v1/objects/upsert",
+             {&MetadataHandler::UpsertObject, Access::kLeader}},
+            {"GET /internal/v1/objects/get",
+             {&MetadataHandler::GetObject, Access::kFollowerRead}},
+            {"GET /internal/v1/objects/list",
+             {&MetadataHandler::ListObjects, Access::kFollowerRead}},
+            {"DELETE /internal/v1/objects/delete",
+             {&MetadataHandler::DeleteObject, Access::kLeader}},
+            {"POST /internal/v1/objects/allocate-write",
+             {&MetadataHandler::AllocateWrite, Access::kLeader}},
+            {"POST /internal/v1/objects/commit",
+             {&MetadataHandler::CommitWrite, Access::kLeader}},
+            {"GET /internal/v1/objects/resolve-read",
+             {&MetadataHandler::ResolveRead, Access::kFollowerRead}},
+            {"POST /internal/v1/multipart/uploads/create",
+             {&MetadataHandler::CreateMultipartUpload, Access::kLeader}},
+            {"GET /internal/v1/multipart/uploads/get",
+             {&MetadataHandler::GetMultipartUpload, Access::kLeader}},
+            {"GET /internal/v1/multipart/uploads/list-expired",
+             {&MetadataHandler::ListExpiredMultipartUploads, Access::kLeader}},
+            {"POST /internal/v1/multipart/uploads/state",
+             {&MetadataHandler::UpdateMultipartUploadState, Access::kLeader}},
+            {"DELETE /internal/v1/multipart/uploads/delete",
+             {&MetadataHandler::DeleteMultipartUpload, Access::kLeader}},
+            {"POST /internal/v1/multipart/parts/upsert",
+             {&MetadataHandler::UpsertMultipartPart, Access::kLeader}},
+            {"GET /internal/v1/multipart/parts/list",
+             {&MetadataHandler::ListMultipartParts, Access::kLeader}},
+            {"DELETE /internal/v1/multipart/parts/delete",
+             {&MetadataHandler::DeleteMultipartParts, Access::kLeader}},
+            {"POST /internal/v1/batch", {&MetadataHandler::ExecuteBatch, Access::kLeader}},
+            {"GET /internal/v1/changes", {&MetadataHandler::ReadChanges, Access::kLeader}},
+            {"POST /internal/v1/replication/vote",
+             {&MetadataHandler::ReplicationVote, Access::kReplication}},
+            {"POST /internal/v1/replication/heartbeat",
+             {&MetadataHandler::ReplicationHeartbeat, Access::kReplication}},
+            {"GET /internal/v1/replication/entries",
+             {&MetadataHandler::ReplicationEntries, Access::kReplication}},
+            {"GET /internal/v1/replication/status",
+             {&MetadataHandler::ReplicationStatus, Access::kReplication}},
+        };
+        return routes;
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/objects/upsert") {
-                auto body = ParseBody(req);
-                nebulafs::metadata::ObjectMetadata meta;
-                meta.name = body->getValue<std::string>("name");
-                meta.size_bytes = body->getValue<Poco::UInt64>("size_bytes");
-                meta.etag = body->getValue<std::string>("etag");
-                auto result = store_->UpsertObject(body->getValue<std::string>("bucket"), meta);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("bucket_id", result.value().bucket_id);
-                root->set("name", result.value().name);
-                root->set("size_bytes", static_cast<Poco::UInt64>(result.value().size_bytes));
-                root->set("etag", result.value().etag);
-                root->set("created_at", result.value().created_at);
-                root->set("updated_at", result.value().updated_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void ConfigureStorageNodes(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::ConfigureNodesRequest>();
+        auto result = store_->ConfigureStorageNodes(request.endpoints);
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/objects/get") {
-                std::string bucket;
-                std::string object_name;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "bucket") bucket = p.second;
-                    if (p.first == "object") object_name = p.second;
-                }
-                auto result = store_->GetObject(bucket, object_name);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "NOT_FOUND", "object not found",
-                                      Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("bucket_id", result.value().bucket_id);
-                root->set("name", result.value().name);
-                root->set("size_bytes", static_cast<Poco::UInt64>(result.value().size_bytes));
-                root->set("etag", result.value().etag);
-                root->set("created_at", result.value().created_at);
-                root->set("updated_at", result.value().updated_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void CreateBucket(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::CreateBucketRequest>();
+        auto result = store_->CreateBucket(std::string(request.name));
+        if (!result.ok()) {
+            if (result.error().code == nebulafs::core::ErrorCode::kAlreadyExists) {
+                return call.Fail("ALREADY_EXISTS", "bucket exists",
+                                 Poco::Net::HTTPResponse::HTTP_CONFLICT);
             }
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/objects/list") {
-                std::string bucket;
-                std::string prefix;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "bucket") bucket = p.second;
-                    if (p.first == "prefix") prefix = p.second;
-                }
-                auto result = store_->ListObjects(bucket, prefix);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Array::Ptr arr = new Poco::JSON::Array();
-                for (const auto& object : result.value()) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("id", object.id);
-                    item->set("bucket_id", object.bucket_id);
-                    item->set("name", object.name);
-                    item->set("size_bytes", static_cast<Poco::UInt64>(object.size_bytes));
-                    item->set("etag", object.etag);
-                    item->set("created_at", object.created_at);
-                    item->set("updated_at", object.updated_at);
-                    arr->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("objects", arr);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void ListBuckets(RpcCall& call) {
+        auto result = store_->ListBuckets();
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::BucketListResponse{std::move(result.value())});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_DELETE &&
-                path == "/internal/v1/objects/delete") {
-                std::string bucket;
-                std::string object_name;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "bucket") bucket = p.second;
-                    if (p.first == "object") object_name = p.second;
-                }
-                auto result = store_->DeleteObject(bucket, object_name);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void GetBucket(RpcCall& call) {
+        auto result = store_->GetBucket(GetParam(call.uri, "name"));
+        if (!result.ok()) {
+            return call.Fail("NOT_FOUND", "bucket not found",
+                             Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/multipart/uploads/create") {
-                auto body = ParseBody(req);
-                auto result = store_->CreateMultipartUpload(
-                    body->getValue<std::string>("bucket"), body->getValue<std::string>("upload_id"),
-                    body->getValue<std::string>("object"), body->getValue<std::string>("expires_at"));
-                if (!result.ok()) {
-                    if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
-                        return WriteError(res, request_id, "NOT_FOUND", "bucket not found",
-                                          Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                    }
-                    if (result.error().code == nebulafs::core::ErrorCode::kAlreadyExists) {
-                        return WriteError(res, request_id, "ALREADY_EXISTS",
-                                          "multipart upload already exists",
-                                          Poco::Net::HTTPResponse::HTTP_CONFLICT);
-                    }
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("upload_id", result.value().upload_id);
-                root->set("bucket_id", result.value().bucket_id);
-                root->set("object_name", result.value().object_name);
-                root->set("state", result.value().state);
-                root->set("expires_at", result.value().expires_at);
-                root->set("created_at", result.value().created_at);
-                root->set("updated_at", result.value().updated_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void UpsertObject(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::UpsertObjectRequest>();
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = request.name;
+        meta.size_bytes = request.size_bytes;
+        meta.etag = request.etag;
+        auto result = store_->UpsertObject(std::string(request.bucket), meta);
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/multipart/uploads/get") {
-                std::string upload_id;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "upload_id") upload_id = p.second;
-                }
-                auto result = store_->GetMultipartUpload(upload_id);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "NOT_FOUND", "multipart upload not found",
-                                      Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("upload_id", result.value().upload_id);
-                root->set("bucket_id", result.value().bucket_id);
-                root->set("object_name", result.value().object_name);
-                root->set("state", result.value().state);
-                root->set("expires_at", result.value().expires_at);
-                root->set("created_at", result.value().created_at);
-                root->set("updated_at", result.value().updated_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void GetObject(RpcCall& call) {
+        auto result =
+            store_->GetObject(GetParam(call.uri, "bucket"), GetParam(call.uri, "object"));
+        if (!result.ok()) {
+            return call.Fail("NOT_FOUND", "object not found",
+                             Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/multipart/uploads/list-expired") {
-                std::string expires_before;
-                int limit = 100;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "expires_before") expires_before = p.second;
-                    if (p.first == "limit") limit = std::stoi(p.second);
-                }
-                auto result = store_->ListExpiredMultipartUploads(expires_before, limit);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Array::Ptr uploads = new Poco::JSON::Array();
-                for (const auto& upload : result.value()) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("id", upload.id);
-                    item->set("upload_id", upload.upload_id);
-                    item->set("bucket_id", upload.bucket_id);
-                    item->set("object_name", upload.object_name);
-                    item->set("state", upload.state);
-                    item->set("expires_at", upload.expires_at);
-                    item->set("created_at", upload.created_at);
-                    item->set("updated_at", upload.updated_at);
-                    uploads->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("uploads", uploads);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void ListObjects(RpcCall& call) {
+        nebulafs::metadata::ListObjectsOptions options;
+        options.prefix = GetParam(call.uri, "prefix");
+        options.delimiter = GetParam(call.uri, "delimiter");
+        const auto max_keys = GetParam(call.uri, "max_keys");
+        if (!max_keys.empty()) {
+            options.max_keys = std::stoi(max_keys);
+        }
+        auto cursor = nebulafs::metadata::DecodeListCursor(GetParam(call.uri, "cursor"));
+        if (!cursor) {
+            return call.Fail("INVALID_ARGUMENT", "invalid cursor",
+                             Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+        }
+        options.cursor = std::move(*cursor);
+        auto result = store_->ListObjectsPage(GetParam(call.uri, "bucket"), options);
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        auto& listing = result.value();
+        // Cursors may hold bytes JSON cannot carry verbatim, so ship the opaque token.
+        call.Reply(nebulafs::metadata::ObjectPageResponse{
+            std::move(listing.objects), std::move(listing.common_prefixes),
+            listing.is_truncated, nebulafs::metadata::EncodeListCursor(listing.next_cursor)});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/multipart/uploads/state") {
-                auto body = ParseBody(req);
-                auto result = store_->UpdateMultipartUploadState(
-                    body->getValue<std::string>("upload_id"), body->getValue<std::string>("state"));
-                if (!result.ok()) {
-                    if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
-                        return WriteError(res, request_id, "NOT_FOUND", "multipart upload not found",
-                                          Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                    }
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void DeleteObject(RpcCall& call) {
+        auto result =
+            store_->DeleteObject(GetParam(call.uri, "bucket"), GetParam(call.uri, "object"));
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_DELETE &&
-                path == "/internal/v1/multipart/uploads/delete") {
-                std::string upload_id;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "upload_id") upload_id = p.second;
-                }
-                auto result = store_->DeleteMultipartUpload(upload_id);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void AllocateWrite(RpcCall& call) {
+        const auto started_at = std::chrono::steady_clock::now();
+        const auto request = call.ReadRequest<nebulafs::metadata::AllocateWriteRequest>();
+        auto result = store_->AllocateWrite(std::string(request.bucket),
+                                            std::string(request.object),
+                                            request.replication_factor,
+                                            std::string(request.service_token));
+        if (!result.ok()) {
+            nebulafs::observability::RecordMetadataAllocate(false, ElapsedMs(started_at));
+            if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
+                return call.Fail("NOT_FOUND", result.error().message,
+                                 Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
-
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/multipart/parts/upsert") {
-                auto body = ParseBody(req);
-                auto result = store_->UpsertMultipartPart(
-                    body->getValue<std::string>("upload_id"), body->getValue<int>("part_number"),
-                    body->getValue<Poco::UInt64>("size_bytes"), body->getValue<std::string>("etag"),
-                    body->getValue<std::string>("temp_path"));
-                if (!result.ok()) {
-                    if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
-                        return WriteError(res, request_id, "NOT_FOUND", "multipart upload not found",
-                                          Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                    }
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("id", result.value().id);
-                root->set("upload_id", result.value().upload_id);
-                root->set("part_number", result.value().part_number);
-                root->set("size_bytes", static_cast<Poco::UInt64>(result.value().size_bytes));
-                root->set("etag", result.value().etag);
-                root->set("temp_path", result.value().temp_path);
-                root->set("created_at", result.value().created_at);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+            if (result.error().code == nebulafs::core::ErrorCode::kInvalidArgument) {
+                return call.Fail("INVALID_ARGUMENT", result.error().message,
+                                 Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
             }
+            return call.FailInternal(result.error().message);
+        }
+        nebulafs::observability::RecordMetadataAllocate(true, ElapsedMs(started_at));
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/multipart/parts/list") {
-                std::string upload_id;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "upload_id") upload_id = p.second;
-                }
-                auto result = store_->ListMultipartParts(upload_id);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Array::Ptr parts = new Poco::JSON::Array();
-                for (const auto& part : result.value()) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("id", part.id);
-                    item->set("upload_id", part.upload_id);
-                    item->set("part_number", part.part_number);
-                    item->set("size_bytes", static_cast<Poco::UInt64>(part.size_bytes));
-                    item->set("etag", part.etag);
-                    item->set("temp_path", part.temp_path);
-                    item->set("created_at", part.created_at);
-                    parts->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("parts", parts);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-            }
+    void CommitWrite(RpcCall& call) {
+        const auto started_at = std::chrono::steady_clock::now();
+        const auto request = call.ReadRequest<nebulafs::metadata::CommitWriteRequest>();
+        auto result = store_->CommitWrite(std::string(request.bucket), std::string(request.object),
+                                          std::string(request.blob_id), request.size_bytes,
+                                          std::string(request.etag), request.replicas);
+        if (!result.ok()) {
+            nebulafs::observability::RecordMetadataCommit(false, ElapsedMs(started_at));
+            return call.FailInternal(result.error().message);
+        }
+        nebulafs::observability::RecordMetadataCommit(true, ElapsedMs(started_at));
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_DELETE &&
-                path == "/internal/v1/multipart/parts/delete") {
-                std::string upload_id;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "upload_id") upload_id = p.second;
-                }
-                auto result = store_->DeleteMultipartParts(upload_id);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void ResolveRead(RpcCall& call) {
+        auto result =
+            store_->ResolveRead(GetParam(call.uri, "bucket"), GetParam(call.uri, "object"));
+        if (!result.ok()) {
+            return call.Fail("NOT_FOUND", "object not found",
+                             Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+        }
+        call.Reply(result.value());
+    }
+
+    void CreateMultipartUpload(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::CreateUploadRequest>();
+        auto result = store_->CreateMultipartUpload(
+            std::string(request.bucket), std::string(request.upload_id),
+            std::string(request.object), std::string(request.expires_at));
+        if (!result.ok()) {
+            if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
+                return call.Fail("NOT_FOUND", "bucket not found",
+                                 Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
+            if (result.error().code == nebulafs::core::ErrorCode::kAlreadyExists) {
+                return call.Fail("ALREADY_EXISTS", "multipart upload already exists",
+                                 Poco::Net::HTTPResponse::HTTP_CONFLICT);
+            }
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/objects/allocate-write") {
-                const auto started_at = std::chrono::steady_clock::now();
-                auto body = ParseBody(req);
-                auto result = store_->AllocateWrite(body->getValue<std::string>("bucket"),
-                                                    body->getValue<std::string>("object"),
-                                                    body->getValue<int>("replication_factor"),
-                                                    body->getValue<std::string>("service_token"));
-                if (!result.ok()) {
-                    nebulafs::observability::RecordMetadataAllocate(false, ElapsedMs(started_at));
-                    if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
-                        return WriteError(res, request_id, "NOT_FOUND", result.error().message,
-                                          Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                    }
-                    if (result.error().code == nebulafs::core::ErrorCode::kInvalidArgument) {
-                        return WriteError(res, request_id, "INVALID_ARGUMENT",
-                                          result.error().message,
-                                          Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-                    }
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                nebulafs::observability::RecordMetadataAllocate(true, ElapsedMs(started_at));
-                Poco::JSON::Array::Ptr replicas = new Poco::JSON::Array();
-                for (const auto& replica : result.value().replicas) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("node_id", replica.node_id);
-                    item->set("replica_index", replica.replica_index);
-                    item->set("endpoint", replica.endpoint);
-                    replicas->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("blob_id", result.value().blob_id);
-                root->set("write_token", result.value().write_token);
-                root->set("replicas", replicas);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void GetMultipartUpload(RpcCall& call) {
+        auto result = store_->GetMultipartUpload(GetParam(call.uri, "upload_id"));
+        if (!result.ok()) {
+            return call.Fail("NOT_FOUND", "multipart upload not found",
+                             Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+        }
+        call.Reply(result.value());
+    }
+
+    void ListExpiredMultipartUploads(RpcCall& call) {
+        const auto limit = GetParam(call.uri, "limit");
+        auto result = store_->ListExpiredMultipartUploads(GetParam(call.uri, "expires_before"),
+                                                          limit.empty() ? 100 : std::stoi(limit));
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::UploadListResponse{std::move(result.value())});
+    }
+
+    void UpdateMultipartUploadState(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::UploadStateRequest>();
+        auto result = store_->UpdateMultipartUploadState(std::string(request.upload_id),
+                                                         std::string(request.state));
+        if (!result.ok()) {
+            if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
+                return call.Fail("NOT_FOUND", "multipart upload not found",
+                                 Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_POST &&
-                path == "/internal/v1/objects/commit") {
-                const auto started_at = std::chrono::steady_clock::now();
-                auto body = ParseBody(req);
-                std::vector<nebulafs::metadata::ReplicaTarget> replicas;
-                auto arr = body->getArray("replicas");
-                for (size_t i = 0; i < arr->size(); ++i) {
-                    auto item = arr->getObject(i);
-                    replicas.push_back(nebulafs::metadata::ReplicaTarget{
-                        item->getValue<int>("node_id"), item->getValue<int>("replica_index"),
-                        item->getValue<std::string>("endpoint")});
-                }
-                auto result = store_->CommitWrite(body->getValue<std::string>("bucket"),
-                                                  body->getValue<std::string>("object"),
-                                                  body->getValue<std::string>("blob_id"),
-                                                  body->getValue<Poco::UInt64>("size_bytes"),
-                                                  body->getValue<std::string>("etag"), replicas);
-                if (!result.ok()) {
-                    nebulafs::observability::RecordMetadataCommit(false, ElapsedMs(started_at));
-                    return WriteError(res, request_id, "INTERNAL_ERROR", result.error().message,
-                                      Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                }
-                nebulafs::observability::RecordMetadataCommit(true, ElapsedMs(started_at));
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("ok", true);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void DeleteMultipartUpload(RpcCall& call) {
+        auto result = store_->DeleteMultipartUpload(GetParam(call.uri, "upload_id"));
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
+
+    void UpsertMultipartPart(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::UpsertPartRequest>();
+        auto result = store_->UpsertMultipartPart(
+            std::string(request.upload_id), request.part_number, request.size_bytes,
+            std::string(request.etag), std::string(request.temp_path));
+        if (!result.ok()) {
+            if (result.error().code == nebulafs::core::ErrorCode::kNotFound) {
+                return call.Fail("NOT_FOUND", "multipart upload not found",
+                                 Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(result.value());
+    }
 
-            if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_GET &&
-                path == "/internal/v1/objects/resolve-read") {
-                std::string bucket;
-                std::string object_name;
-                for (const auto& p : uri.getQueryParameters()) {
-                    if (p.first == "bucket") bucket = p.second;
-                    if (p.first == "object") object_name = p.second;
-                }
-                auto result = store_->ResolveRead(bucket, object_name);
-                if (!result.ok()) {
-                    return WriteError(res, request_id, "NOT_FOUND", "object not found",
-                                      Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                }
-                Poco::JSON::Array::Ptr replicas = new Poco::JSON::Array();
-                for (const auto& replica : result.value().replicas) {
-                    Poco::JSON::Object::Ptr item = new Poco::JSON::Object();
-                    item->set("node_id", replica.node_id);
-                    item->set("replica_index", replica.replica_index);
-                    item->set("endpoint", replica.endpoint);
-                    replicas->add(item);
-                }
-                Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-                root->set("blob_id", result.value().blob_id);
-                root->set("etag", result.value().etag);
-                root->set("size_bytes", static_cast<Poco::UInt64>(result.value().size_bytes));
-                root->set("replicas", replicas);
-                return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
+    void ListMultipartParts(RpcCall& call) {
+        auto result = store_->ListMultipartParts(GetParam(call.uri, "upload_id"));
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::PartListResponse{std::move(result.value())});
+    }
+
+    void DeleteMultipartParts(RpcCall& call) {
+        auto result = store_->DeleteMultipartParts(GetParam(call.uri, "upload_id"));
+        if (!result.ok()) {
+            return call.FailInternal(result.error().message);
+        }
+        call.Reply(nebulafs::metadata::AckResponse{});
+    }
+
+    void ExecuteBatch(RpcCall& call) {
+        const auto request = call.ReadRequest<nebulafs::metadata::BatchRequest>();
+        if (request.ops.empty() || request.ops.size() > nebulafs::metadata::kMaxBatchOps) {
+            return call.Fail("INVALID_ARGUMENT",
+                             "batch must hold 1 to " +
+                                 std::to_string(nebulafs::metadata::kMaxBatchOps) + " ops",
+                             Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+        }
+        auto result = store_->ExecuteBatch(request.ops);
+        if (!result.ok()) {
+            switch (result.error().code) {
+                case nebulafs::core::ErrorCode::kInvalidArgument:
+                    return call.Fail("INVALID_ARGUMENT", result.error().message,
+                                     Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+                case nebulafs::core::ErrorCode::kNotFound:
+                    return call.Fail("NOT_FOUND", result.error().message,
+                                     Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+                case nebulafs::core::ErrorCode::kFailedPrecondition:
+                    return call.Fail("PRECONDITION_FAILED", result.error().message,
+                                     Poco::Net::HTTPResponse::HTTP_CONFLICT);
+                case nebulafs::core::ErrorCode::kUnavailable:
+                    return WriteUnavailable(call.res, call.request_id, "NOT_LEADER",
+                                            result.error().message);
+                default:
+                    return call.FailInternal(result.error().message);
             }
+        }
+        call.Reply(nebulafs::metadata::BatchResponse{std::move(result.value())});
+    }
 
-            return WriteError(res, request_id, "NOT_FOUND", "route not found",
-                              Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-        } catch (const Poco::Exception& ex) {
-            return WriteError(res, request_id, "INVALID_ARGUMENT", ex.displayText(),
-                              Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-        } catch (const std::exception& ex) {
-            return WriteError(res, request_id, "INTERNAL_ERROR", ex.what(),
-                              Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+    // Long-polls the change feed. Each replica numbers its own feed, so gateways follow the
+    // leader and start over (a reset) whenever leadership moves.
+    void ReadChanges(RpcCall& call) {
+        const auto limit = GetUInt64Param(call.uri, "limit");
+        const auto wait_ms = GetUInt64Param(call.uri, "wait_ms");
+        auto page = feed_->Read(
+            GetParam(call.uri, "cursor"),
+            limit == 0 ? kMaxChangesPerRead
+                       : std::min<std::size_t>(static_cast<std::size_t>(limit), kMaxChangesPerRead),
+            static_cast<int>(std::min<std::uint64_t>(wait_ms, kMaxChangesWaitMs)));
+        call.Reply(nebulafs::metadata::ChangesResponse{std::move(page.cursor), page.reset,
+                                                       std::move(page.events), page.head});
+    }
+
+    void WriteUnavailable(Poco::Net::HTTPServerResponse& res, const std::string& request_id,
+                          const std::string& code, const std::string& message) {
+        const auto leader = replicated_->group().leader();
+        if (!leader.empty()) {
+            res.set("X-Nebula-Leader", leader);
         }
+        WriteError(res, request_id, code, message,
+                   Poco::Net::HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
     }
 
-private:
-    std::shared_ptr<nebulafs::metadata::SqliteMetadataStore> store_;
+    void ReplicationVote(RpcCall& call) {
+        auto body = ParseBody(call.req);
+        const auto vote = replicated_->group().HandleVote(nebulafs::metadata::VoteRequest{
+            body->getValue<Poco::UInt64>("term"), body->getValue<std::string>("candidate"),
+            body->getValue<Poco::UInt64>("last_index"),
+            body->getValue<Poco::UInt64>("last_term")});
+        Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+        root->set("term", static_cast<Poco::UInt64>(vote.term));
+        root->set("granted", vote.granted);
+        WriteJson(call.res, root, Poco::Net::HTTPResponse::HTTP_OK, call.request_id);
+    }
+
+    void ReplicationHeartbeat(RpcCall& call) {
+        auto body = ParseBody(call.req);
+        const auto heartbeat =
+            replicated_->group().HandleHeartbeat(nebulafs::metadata::HeartbeatRequest{
+                body->getValue<Poco::UInt64>("term"), body->getValue<std::string>("leader"),
+                body->getValue<Poco::UInt64>("commit_index")});
+        Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+        root->set("term", static_cast<Poco::UInt64>(heartbeat.term));
+        root->set("accepted", heartbeat.accepted);
+        WriteJson(call.res, root, Poco::Net::HTTPResponse::HTTP_OK, call.request_id);
+    }
+
+    void ReplicationEntries(RpcCall& call) {
+        nebulafs::metadata::FetchRequest fetch;
+        fetch.term = GetUInt64Param(call.uri, "term");
+        fetch.after = GetUInt64Param(call.uri, "after");
+        fetch.after_term = GetUInt64Param(call.uri, "after_term");
+        fetch.wait_ms = static_cast<int>(GetUInt64Param(call.uri, "wait_ms"));
+        fetch.follower = GetParam(call.uri, "follower");
+        const auto body =
+            nebulafs::metadata::EncodeFetchResponse(replicated_->group().HandleFetch(fetch));
+        call.res.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+        call.res.setContentType("application/octet-stream");
+        call.res.set("X-Request-Id", call.request_id);
+        call.res.setContentLength(static_cast<std::streamsize>(body.size()));
+        call.res.send().write(body.data(), static_cast<std::streamsize>(body.size()));
+    }
+
+    void ReplicationStatus(RpcCall& call) {
+        const auto status = replicated_->group().Status();
+        Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
+        root->set("role", status.role);
+        root->set("term", static_cast<Poco::UInt64>(status.term));
+        root->set("leader", status.leader);
+        root->set("last_index", static_cast<Poco::UInt64>(status.last_index));
+        root->set("commit_index", static_cast<Poco::UInt64>(status.commit_index));
+        root->set("applied_index", static_cast<Poco::UInt64>(status.applied_index));
+        root->set("diverged", status.diverged);
+        WriteJson(call.res, root, Poco::Net::HTTPResponse::HTTP_OK, call.request_id);
+    }
+
+    std::shared_ptr<nebulafs::metadata::MetadataStore> store_;
+    std::shared_ptr<nebulafs::metadata::ReplicatedMetadataStore> replicated_;
+    std::shared_ptr<nebulafs::metadata::ChangeFeed> feed_;
     std::string token_;
+    int read_wait_ms_;
 };
 
 class MetadataHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
 public:
-    MetadataHandlerFactory(std::shared_ptr<nebulafs::metadata::SqliteMetadataStore> store,
-                           std::string token)
+    MetadataHandlerFactory(std::shared_ptr<nebulafs::metadata::MetadataStore> store,
+                           std::shared_ptr<nebulafs::metadata::ReplicatedMetadataStore> replicated,
+                           std::shared_ptr<nebulafs::metadata::ChangeFeed> feed,
+                           std::string token, int read_wait_ms)
         : store_(std::move(store)),
-          token_(std::move(token)) {
+          replicated_(std::move(replicated)),
+          feed_(std::move(feed)),
+          token_(std::move(token)),
+          read_wait_ms_(read_wait_ms) {
     }
 
     Poco::Net::HTTPRequestHandler* createRequestHandler(
         const Poco::Net::HTTPServerRequest&) override {
-        return new MetadataHandler(store_, token_);
+        return new MetadataHandler(store_, replicated_, feed_, token_, read_wait_ms_);
     }
 
 private:
-    std::shared_ptr<nebulafs::metadata::SqliteMetadataStore> store_;
+    std::shared_ptr<nebulafs::metadata::MetadataStore> store_;
+    std::shared_ptr<nebulafs::metadata::ReplicatedMetadataStore> replicated_;
+    std::shared_ptr<nebulafs::metadata::ChangeFeed> feed_;
     std::string token_;
+    int read_wait_ms_;
 };
 
 }  // namespace
@@ -610,11 +686,32 @@ int main(int argc, char** argv) {
 
     auto config = nebulafs::core::LoadConfig(config_path);
     nebulafs::core::InitLogging(config.observability.log_level);
-    auto sqlite_path = nebulafs::core::LoadDatabasePath(db_path);
-    std::filesystem::create_directories(std::filesystem::path(sqlite_path).parent_path());
-
-    auto store = std::make_shared<nebulafs::metadata::SqliteMetadataStore>(sqlite_path);
-    if (!config.distributed.storage_nodes.empty()) {
+    // The feed sits beneath replication so followers record the mutations they replay too.
+    auto feed = std::make_shared<nebulafs::metadata::ChangeFeed>(
+        static_cast<std::size_t>(config.distributed.change_feed_retain_events));
+    std::shared_ptr<nebulafs::metadata::MetadataStore> store =
+        std::make_shared<nebulafs::metadata::ChangeFeedMetadataStore>(
+            nebulafs::metadata::OpenMetadataStore(nebulafs::core::LoadDatabaseConfig(db_path)),
+            feed);
+    std::shared_ptr<nebulafs::metadata::ReplicatedMetadataStore> replicated;
+    if (config.replication.enabled) {
+        const auto& replication = config.replication;
+        nebulafs::metadata::ReplicaOptions options;
+        options.self_url = replication.self_url;
+        options.peers = replication.peers;
+        options.state_dir = replication.state_dir;
+        options.election_timeout_ms = replication.election_timeout_ms;
+        options.heartbeat_interval_ms = replication.heartbeat_interval_ms;
+        options.max_staleness_ms = replication.max_staleness_ms;
+        options.commit_timeout_ms = replication.commit_timeout_ms;
+        auto transport = std::make_shared<nebulafs::metadata::HttpReplicaTransport>(
+            config.distributed.service_auth_token, replication.election_timeout_ms / 2);
+        replicated = std::make_shared<nebulafs::metadata::ReplicatedMetadataStore>(
+            store, std::move(options), std::move(transport));
+        store = replicated;
+    }
+    // A replica group has no leader yet; gateways configure nodes through the leader instead.
+    if (!replicated && !config.distributed.storage_nodes.empty()) {
         auto configured = store->ConfigureStorageNodes(config.distributed.storage_nodes);
         if (!configured.ok()) {
             throw std::runtime_error(configured.error().message);
@@ -623,7 +720,9 @@ int main(int argc, char** argv) {
 
     Poco::Net::ServerSocket socket(config.server.port);
     Poco::Net::HTTPServer server(
-        new MetadataHandlerFactory(store, config.distributed.service_auth_token), socket,
+        new MetadataHandlerFactory(store, replicated, feed, config.distributed.service_auth_token,
+                                   config.replication.read_wait_ms),
+        socket,
         new Poco::Net::HTTPServerParams());
     server.start();
     nebulafs::core::LogInfo("Metadata service listening on port " + std::to_string(config.server.port));
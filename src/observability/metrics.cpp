@@ -1,5 +1,7 @@
 #include "nebulafs/observability/metrics.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstdint>
 
@@ -15,19 +17,56 @@ std::atomic<std::uint64_t> g_timed_out_total{0};
 std::atomic<std::uint64_t> g_gateway_storage_put_failures_total{0};
 std::atomic<std::uint64_t> g_gateway_metadata_rpc_failures_total{0};
 std::atomic<std::uint64_t> g_gateway_replica_fallback_total{0};
-std::atomic<std::uint64_t> g_gateway_multipart_compose_failures_total{0};
-std::atomic<std::uint64_t> g_gateway_multipart_rollback_attempts_total{0};
-std::atomic<std::uint64_t> g_gateway_multipart_rollback_failures_total{0};
+std::atomic<std::uint64_t> g_gateway_metadata_cache_hits_total{0};
+std::atomic<std::uint64_t> g_gateway_metadata_cache_misses_total{0};
+std::atomic<std::uint64_t> g_gateway_metadata_cache_coalesced_total{0};
+// Upper bounds in ms of the change-feed lag buckets; the last bucket is +Inf.
+constexpr std::array<long long, 8> kChangeFeedLagBuckets{5, 10, 25, 50, 100, 250, 1000, 5000};
+std::array<std::atomic<std::uint64_t>, kChangeFeedLagBuckets.size() + 1>
+    g_change_feed_lag_buckets{};
+std::atomic<std::uint64_t> g_change_feed_lag_ms_sum{0};
+std::atomic<std::uint64_t> g_change_feed_lag_count{0};
+std::atomic<std::uint64_t> g_gateway_change_feed_resets_total{0};
+std::atomic<std::uint64_t> g_gateway_change_feed_errors_total{0};
 std::atomic<std::uint64_t> g_gateway_distributed_cleanup_uploads_total{0};
 std::atomic<std::uint64_t> g_gateway_distributed_cleanup_upload_failures_total{0};
 std::atomic<std::uint64_t> g_gateway_distributed_cleanup_blob_deletes_total{0};
 std::atomic<std::uint64_t> g_gateway_distributed_cleanup_blob_delete_failures_total{0};
+std::atomic<std::uint64_t> g_gateway_cleanup_sweeps_skipped_total{0};
+std::atomic<std::uint64_t> g_gateway_content_dedup_hits_total{0};
+std::atomic<std::uint64_t> g_gateway_content_reclaimed_total{0};
+std::atomic<std::uint64_t> g_gateway_objects_migrated_total{0};
+std::atomic<std::uint64_t> g_gateway_object_copies_total{0};
+std::atomic<std::uint64_t> g_gateway_object_moves_total{0};
+std::atomic<std::uint64_t> g_gateway_bulk_delete_requests_total{0};
+std::atomic<std::uint64_t> g_gateway_bulk_delete_keys_total{0};
+std::atomic<std::uint64_t> g_gateway_bulk_deleted_objects_total{0};
+std::atomic<std::int64_t> g_gateway_reclaim_queue{0};
+std::atomic<std::uint64_t> g_gateway_reclaim_batches_total{0};
+std::atomic<std::uint64_t> g_gateway_reclaim_batch_failures_total{0};
+std::atomic<std::uint64_t> g_gateway_reclaimed_blobs_total{0};
+std::atomic<std::uint64_t> g_gateway_compression_raw_bytes_total{0};
+std::atomic<std::uint64_t> g_gateway_compression_stored_bytes_total{0};
+std::atomic<std::uint64_t> g_gateway_compression_us_total{0};
+std::atomic<std::uint64_t> g_gateway_decompressed_frames_total{0};
+std::atomic<std::uint64_t> g_gateway_decompression_us_total{0};
+std::atomic<std::int64_t> g_gateway_upload_write_queue{0};
+std::atomic<std::int64_t> g_gateway_upload_hash_queue{0};
+std::atomic<std::uint64_t> g_gateway_upload_pipeline_stalls_total{0};
 std::atomic<std::uint64_t> g_metadata_allocate_requests_total{0};
 std::atomic<std::uint64_t> g_metadata_allocate_failures_total{0};
 std::atomic<std::uint64_t> g_metadata_allocate_latency_ms_sum{0};
 std::atomic<std::uint64_t> g_metadata_commit_requests_total{0};
 std::atomic<std::uint64_t> g_metadata_commit_failures_total{0};
 std::atomic<std::uint64_t> g_metadata_commit_latency_ms_sum{0};
+std::atomic<std::uint64_t> g_metadata_change_feed_events_total{0};
+std::atomic<std::uint64_t> g_metadata_replication_rejected_total{0};
+std::atomic<std::uint64_t> g_metadata_replication_replay_failures_total{0};
+// Upper bounds of the group-commit size buckets; the last bucket is +Inf.
+constexpr std::array<std::size_t, 8> kGroupCommitBuckets{1, 2, 4, 8, 16, 32, 64, 128};
+std::array<std::atomic<std::uint64_t>, kGroupCommitBuckets.size() + 1> g_group_commit_buckets{};
+std::atomic<std::uint64_t> g_group_commit_transactions_sum{0};
+std::atomic<std::uint64_t> g_group_commits_total{0};
 std::atomic<std::uint64_t> g_storage_node_blob_writes_total{0};
 std::atomic<std::uint64_t> g_storage_node_blob_write_failures_total{0};
 std::atomic<std::uint64_t> g_storage_node_blob_write_latency_ms_sum{0};
@@ -37,9 +76,6 @@ std::atomic<std::uint64_t> g_storage_node_blob_read_latency_ms_sum{0};
 std::atomic<std::uint64_t> g_storage_node_blob_deletes_total{0};
 std::atomic<std::uint64_t> g_storage_node_blob_delete_failures_total{0};
 std::atomic<std::uint64_t> g_storage_node_blob_delete_latency_ms_sum{0};
-std::atomic<std::uint64_t> g_storage_node_blob_composes_total{0};
-std::atomic<std::uint64_t> g_storage_node_blob_compose_failures_total{0};
-std::atomic<std::uint64_t> g_storage_node_blob_compose_latency_ms_sum{0};
 }  // namespace
 
 void RecordRequest(int status_code, long long latency_ms) {
@@ -71,16 +107,100 @@ void RecordGatewayReplicaFallback() {
     g_gateway_replica_fallback_total.fetch_add(1, std::memory_order_relaxed);
 }
 
-void RecordGatewayMultipartComposeFailure() {
-    g_gateway_multipart_compose_failures_total.fetch_add(1, std::memory_order_relaxed);
+void RecordGatewayMetadataCacheLookup(bool hit) {
+    (hit ? g_gateway_metadata_cache_hits_total : g_gateway_metadata_cache_misses_total)
+        .fetch_add(1, std::memory_order_relaxed);
 }
 
-void RecordGatewayMultipartRollbackAttempt() {
-    g_gateway_multipart_rollback_attempts_total.fetch_add(1, std::memory_order_relaxed);
+void RecordGatewayMetadataCacheCoalesced() {
+    g_gateway_metadata_cache_coalesced_total.fetch_add(1, std::memory_order_relaxed);
 }
 
-void RecordGatewayMultipartRollbackFailure() {
-    g_gateway_multipart_rollback_failures_total.fetch_add(1, std::memory_order_relaxed);
+void RecordGatewayChangeFeedLag(long long lag_ms) {
+    // Clocks of different hosts disagree a little; an event never arrives before its commit.
+    lag_ms = std::max(0LL, lag_ms);
+    std::size_t bucket = 0;
+    while (bucket < kChangeFeedLagBuckets.size() && lag_ms > kChangeFeedLagBuckets[bucket]) {
+        ++bucket;
+    }
+    g_change_feed_lag_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    g_change_feed_lag_ms_sum.fetch_add(static_cast<std::uint64_t>(lag_ms),
+                                       std::memory_order_relaxed);
+    g_change_feed_lag_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayChangeFeedReset() {
+    g_gateway_change_feed_resets_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayChangeFeedError() {
+    g_gateway_change_feed_errors_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayCleanupSweepSkipped() {
+    g_gateway_cleanup_sweeps_skipped_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayContentDedupHit() {
+    g_gateway_content_dedup_hits_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayContentReclaimed(std::uint64_t bodies) {
+    g_gateway_content_reclaimed_total.fetch_add(bodies, std::memory_order_relaxed);
+}
+
+void RecordGatewayObjectsMigrated(std::uint64_t objects) {
+    g_gateway_objects_migrated_total.fetch_add(objects, std::memory_order_relaxed);
+}
+
+void RecordGatewayObjectCopy(bool move) {
+    (move ? g_gateway_object_moves_total : g_gateway_object_copies_total)
+        .fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordGatewayBulkDelete(std::uint64_t keys, std::uint64_t deleted) {
+    g_gateway_bulk_delete_requests_total.fetch_add(1, std::memory_order_relaxed);
+    g_gateway_bulk_delete_keys_total.fetch_add(keys, std::memory_order_relaxed);
+    g_gateway_bulk_deleted_objects_total.fetch_add(deleted, std::memory_order_relaxed);
+}
+
+void RecordGatewayReclaimQueue(std::int64_t delta) {
+    g_gateway_reclaim_queue.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void RecordGatewayBlobReclaim(std::uint64_t blobs, bool success) {
+    g_gateway_reclaim_batches_total.fetch_add(1, std::memory_order_relaxed);
+    if (success) {
+        g_gateway_reclaimed_blobs_total.fetch_add(blobs, std::memory_order_relaxed);
+    } else {
+        g_gateway_reclaim_batch_failures_total.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RecordGatewayCompression(std::uint64_t raw_bytes, std::uint64_t stored_bytes,
+                              long long elapsed_us) {
+    g_gateway_compression_raw_bytes_total.fetch_add(raw_bytes, std::memory_order_relaxed);
+    g_gateway_compression_stored_bytes_total.fetch_add(stored_bytes, std::memory_order_relaxed);
+    g_gateway_compression_us_total.fetch_add(static_cast<std::uint64_t>(std::max(0LL, elapsed_us)),
+                                             std::memory_order_relaxed);
+}
+
+void RecordGatewayDecompression(std::uint64_t frames, long long elapsed_us) {
+    g_gateway_decompressed_frames_total.fetch_add(frames, std::memory_order_relaxed);
+    g_gateway_decompression_us_total.fetch_add(
+        static_cast<std::uint64_t>(std::max(0LL, elapsed_us)), std::memory_order_relaxed);
+}
+
+void RecordGatewayUploadWriteQueue(std::int64_t delta) {
+    g_gateway_upload_write_queue.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void RecordGatewayUploadHashQueue(std::int64_t delta) {
+    g_gateway_upload_hash_queue.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void RecordGatewayUploadPipelineStall() {
+    g_gateway_upload_pipeline_stalls_total.fetch_add(1, std::memory_order_relaxed);
 }
 
 void RecordGatewayDistributedCleanupUpload(bool success) {
@@ -117,6 +237,25 @@ void RecordMetadataCommit(bool success, long long latency_ms) {
     }
 }
 
+void RecordMetadataChangeFeedEvent() {
+    g_metadata_change_feed_events_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordMetadataReplicationApplyFailure(bool replay) {
+    (replay ? g_metadata_replication_replay_failures_total : g_metadata_replication_rejected_total)
+        .fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordMetadataGroupCommit(std::size_t transactions) {
+    std::size_t bucket = 0;
+    while (bucket < kGroupCommitBuckets.size() && transactions > kGroupCommitBuckets[bucket]) {
+        ++bucket;
+    }
+    g_group_commit_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    g_group_commit_transactions_sum.fetch_add(transactions, std::memory_order_relaxed);
+    g_group_commits_total.fetch_add(1, std::memory_order_relaxed);
+}
+
 void RecordStorageNodeWrite(bool success, long long latency_ms) {
     g_storage_node_blob_writes_total.fetch_add(1, std::memory_order_relaxed);
     g_storage_node_blob_write_latency_ms_sum.fetch_add(static_cast<std::uint64_t>(latency_ms),
@@ -144,15 +283,49 @@ void RecordStorageNodeDelete(bool success, long long latency_ms) {
     }
 }
 
-void RecordStorageNodeCompose(bool success, long long latency_ms) {
-    g_storage_node_blob_composes_total.fetch_add(1, std::memory_order_relaxed);
-    g_storage_node_blob_compose_latency_ms_sum.fetch_add(static_cast<std::uint64_t>(latency_ms),
-                                                         std::memory_order_relaxed);
-    if (!success) {
-        g_storage_node_blob_compose_failures_total.fetch_add(1, std::memory_order_relaxed);
+namespace {
+
+// Prometheus histogram buckets are cumulative, so each line adds every smaller bucket.
+std::string RenderChangeFeedLagHistogram() {
+    std::string out =
+        "# HELP nebulafs_gateway_change_feed_lag_ms Time from metadata commit to gateway invalidation\n"
+        "# TYPE nebulafs_gateway_change_feed_lag_ms histogram\n";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < g_change_feed_lag_buckets.size(); ++i) {
+        cumulative += g_change_feed_lag_buckets[i].load(std::memory_order_relaxed);
+        const auto le =
+            i < kChangeFeedLagBuckets.size() ? std::to_string(kChangeFeedLagBuckets[i]) : "+Inf";
+        out += "nebulafs_gateway_change_feed_lag_ms_bucket{le=\"" + le + "\"} " +
+               std::to_string(cumulative) + "\n";
+    }
+    out += "nebulafs_gateway_change_feed_lag_ms_sum " +
+           std::to_string(g_change_feed_lag_ms_sum.load(std::memory_order_relaxed)) + "\n";
+    out += "nebulafs_gateway_change_feed_lag_ms_count " +
+           std::to_string(g_change_feed_lag_count.load(std::memory_order_relaxed)) + "\n";
+    return out;
+}
+
+std::string RenderGroupCommitHistogram() {
+    std::string out =
+        "# HELP nebulafs_metadata_group_commit_transactions Caller transactions per SQLite commit\n"
+        "# TYPE nebulafs_metadata_group_commit_transactions histogram\n";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < g_group_commit_buckets.size(); ++i) {
+        cumulative += g_group_commit_buckets[i].load(std::memory_order_relaxed);
+        const auto le =
+            i < kGroupCommitBuckets.size() ? std::to_string(kGroupCommitBuckets[i]) : "+Inf";
+        out += "nebulafs_metadata_group_commit_transactions_bucket{le=\"" + le + "\"} " +
+               std::to_string(cumulative) + "\n";
     }
+    out += "nebulafs_metadata_group_commit_transactions_sum " +
+           std::to_string(g_group_commit_transactions_sum.load(std::memory_order_relaxed)) + "\n";
+    out += "nebulafs_metadata_group_commit_transactions_count " +
+           std::to_string(g_group_commits_total.load(std::memory_order_relaxed)) + "\n";
+    return out;
 }
 
+}  // namespace
+
 std::string RenderMetrics() {
     const auto total = g_total_requests.load(std::memory_order_relaxed);
     const auto total_latency = g_latency_ms_total.load(std::memory_order_relaxed);
@@ -199,23 +372,139 @@ std::string RenderMetrics() {
            "# TYPE nebulafs_gateway_replica_fallback_total counter\n"
            "nebulafs_gateway_replica_fallback_total " +
            std::to_string(g_gateway_replica_fallback_total.load(std::memory_order_relaxed)) + "\n"
-           "# HELP nebulafs_gateway_multipart_compose_failures_total Total distributed multipart compose failures\n"
-           "# TYPE nebulafs_gateway_multipart_compose_failures_total counter\n"
-           "nebulafs_gateway_multipart_compose_failures_total " +
+           "# HELP nebulafs_gateway_metadata_cache_hits_total Metadata lookups answered by the gateway cache\n"
+           "# TYPE nebulafs_gateway_metadata_cache_hits_total counter\n"
+           "nebulafs_gateway_metadata_cache_hits_total " +
+           std::to_string(g_gateway_metadata_cache_hits_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_metadata_cache_misses_total Metadata lookups sent to the metadata store\n"
+           "# TYPE nebulafs_gateway_metadata_cache_misses_total counter\n"
+           "nebulafs_gateway_metadata_cache_misses_total " +
+           std::to_string(g_gateway_metadata_cache_misses_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_metadata_cache_coalesced_total Cache misses that waited on an identical lookup\n"
+           "# TYPE nebulafs_gateway_metadata_cache_coalesced_total counter\n"
+           "nebulafs_gateway_metadata_cache_coalesced_total " +
+           std::to_string(g_gateway_metadata_cache_coalesced_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_change_feed_resets_total Change-feed reads that restarted from the head\n"
+           "# TYPE nebulafs_gateway_change_feed_resets_total counter\n"
+           "nebulafs_gateway_change_feed_resets_total " +
+           std::to_string(g_gateway_change_feed_resets_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_change_feed_errors_total Failed change-feed reads\n"
+           "# TYPE nebulafs_gateway_change_feed_errors_total counter\n"
+           "nebulafs_gateway_change_feed_errors_total " +
+           std::to_string(g_gateway_change_feed_errors_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_cleanup_sweeps_skipped_total Cleanup sweeps left to the gateway holding the lease\n"
+           "# TYPE nebulafs_gateway_cleanup_sweeps_skipped_total counter\n"
+           "nebulafs_gateway_cleanup_sweeps_skipped_total " +
+           std::to_string(g_gateway_cleanup_sweeps_skipped_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_content_dedup_hits_total Object writes that reused a stored body\n"
+           "# TYPE nebulafs_gateway_content_dedup_hits_total counter\n"
+           "nebulafs_gateway_content_dedup_hits_total " +
+           std::to_string(g_gateway_content_dedup_hits_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_content_reclaimed_total Stored bodies removed once no object used them\n"
+           "# TYPE nebulafs_gateway_content_reclaimed_total counter\n"
+           "nebulafs_gateway_content_reclaimed_total " +
+           std::to_string(g_gateway_content_reclaimed_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_objects_migrated_total Objects moved into the fan-out bucket layout\n"
+           "# TYPE nebulafs_gateway_objects_migrated_total counter\n"
+           "nebulafs_gateway_objects_migrated_total " +
+           std::to_string(g_gateway_objects_migrated_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_object_copies_total Objects copied on the server side\n"
+           "# TYPE nebulafs_gateway_object_copies_total counter\n"
+           "nebulafs_gateway_object_copies_total " +
+           std::to_string(g_gateway_object_copies_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_object_moves_total Objects moved on the server side\n"
+           "# TYPE nebulafs_gateway_object_moves_total counter\n"
+           "nebulafs_gateway_object_moves_total " +
+           std::to_string(g_gateway_object_moves_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_bulk_delete_requests_total Bulk delete requests served\n"
+           "# TYPE nebulafs_gateway_bulk_delete_requests_total counter\n"
+           "nebulafs_gateway_bulk_delete_requests_total " +
+           std::to_string(g_gateway_bulk_delete_requests_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_bulk_delete_keys_total Object keys named by bulk delete requests\n"
+           "# TYPE nebulafs_gateway_bulk_delete_keys_total counter\n"
+           "nebulafs_gateway_bulk_delete_keys_total " +
+           std::to_string(g_gateway_bulk_delete_keys_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_bulk_deleted_objects_total Objects removed by bulk delete requests\n"
+           "# TYPE nebulafs_gateway_bulk_deleted_objects_total counter\n"
+           "nebulafs_gateway_bulk_deleted_objects_total " +
+           std::to_string(g_gateway_bulk_deleted_objects_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_reclaim_queue_depth Blob replicas waiting for the background reclaimer\n"
+           "# TYPE nebulafs_gateway_reclaim_queue_depth gauge\n"
+           "nebulafs_gateway_reclaim_queue_depth " +
+           std::to_string(g_gateway_reclaim_queue.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_reclaim_batches_total Batched blob deletes sent to storage nodes\n"
+           "# TYPE nebulafs_gateway_reclaim_batches_total counter\n"
+           "nebulafs_gateway_reclaim_batches_total " +
+           std::to_string(g_gateway_reclaim_batches_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_reclaim_batch_failures_total Batched blob deletes a storage node did not complete\n"
+           "# TYPE nebulafs_gateway_reclaim_batch_failures_total counter\n"
+           "nebulafs_gateway_reclaim_batch_failures_total " +
            std::to_string(
-               g_gateway_multipart_compose_failures_total.load(std::memory_order_relaxed)) +
+               g_gateway_reclaim_batch_failures_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_reclaimed_blobs_total Blob replicas removed by the background reclaimer\n"
+           "# TYPE nebulafs_gateway_reclaimed_blobs_total counter\n"
+           "nebulafs_gateway_reclaimed_blobs_total " +
+           std::to_string(g_gateway_reclaimed_blobs_total.load(std::memory_order_relaxed)) +
            "\n"
-           "# HELP nebulafs_gateway_multipart_rollback_attempts_total Total distributed multipart rollback attempts\n"
-           "# TYPE nebulafs_gateway_multipart_rollback_attempts_total counter\n"
-           "nebulafs_gateway_multipart_rollback_attempts_total " +
+           "# HELP nebulafs_gateway_compression_raw_bytes_total Bytes of objects stored compressed, before compression\n"
+           "# TYPE nebulafs_gateway_compression_raw_bytes_total counter\n"
+           "nebulafs_gateway_compression_raw_bytes_total " +
            std::to_string(
-               g_gateway_multipart_rollback_attempts_total.load(std::memory_order_relaxed)) +
+               g_gateway_compression_raw_bytes_total.load(std::memory_order_relaxed)) +
            "\n"
-           "# HELP nebulafs_gateway_multipart_rollback_failures_total Total distributed multipart rollback failures\n"
-           "# TYPE nebulafs_gateway_multipart_rollback_failures_total counter\n"
-           "nebulafs_gateway_multipart_rollback_failures_total " +
+           "# HELP nebulafs_gateway_compression_stored_bytes_total Bytes written for objects stored compressed, frame index included\n"
+           "# TYPE nebulafs_gateway_compression_stored_bytes_total counter\n"
+           "nebulafs_gateway_compression_stored_bytes_total " +
            std::to_string(
-               g_gateway_multipart_rollback_failures_total.load(std::memory_order_relaxed)) +
+               g_gateway_compression_stored_bytes_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_compression_us_total Microseconds spent compressing objects\n"
+           "# TYPE nebulafs_gateway_compression_us_total counter\n"
+           "nebulafs_gateway_compression_us_total " +
+           std::to_string(g_gateway_compression_us_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_decompressed_frames_total Compressed frames decoded to serve reads\n"
+           "# TYPE nebulafs_gateway_decompressed_frames_total counter\n"
+           "nebulafs_gateway_decompressed_frames_total " +
+           std::to_string(g_gateway_decompressed_frames_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_decompression_us_total Microseconds spent decoding compressed frames\n"
+           "# TYPE nebulafs_gateway_decompression_us_total counter\n"
+           "nebulafs_gateway_decompression_us_total " +
+           std::to_string(g_gateway_decompression_us_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_upload_write_queue_depth Upload chunks queued for or being written to disk\n"
+           "# TYPE nebulafs_gateway_upload_write_queue_depth gauge\n"
+           "nebulafs_gateway_upload_write_queue_depth " +
+           std::to_string(g_gateway_upload_write_queue.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_upload_hash_queue_depth Upload chunks queued for or being hashed\n"
+           "# TYPE nebulafs_gateway_upload_hash_queue_depth gauge\n"
+           "nebulafs_gateway_upload_hash_queue_depth " +
+           std::to_string(g_gateway_upload_hash_queue.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_gateway_upload_pipeline_stalls_total Upload reads that waited for a pipeline stage to free a chunk\n"
+           "# TYPE nebulafs_gateway_upload_pipeline_stalls_total counter\n"
+           "nebulafs_gateway_upload_pipeline_stalls_total " +
+           std::to_string(
+               g_gateway_upload_pipeline_stalls_total.load(std::memory_order_relaxed)) +
            "\n"
            "# HELP nebulafs_gateway_distributed_cleanup_uploads_total Total distributed cleanup uploads processed\n"
            "# TYPE nebulafs_gateway_distributed_cleanup_uploads_total counter\n"
@@ -268,6 +557,22 @@ std::string RenderMetrics() {
            "# TYPE nebulafs_metadata_commit_latency_ms_sum counter\n"
            "nebulafs_metadata_commit_latency_ms_sum " +
            std::to_string(g_metadata_commit_latency_ms_sum.load(std::memory_order_relaxed)) + "\n"
+           "# HELP nebulafs_metadata_change_feed_events_total Events appended to the metadata change feed\n"
+           "# TYPE nebulafs_metadata_change_feed_events_total counter\n"
+           "nebulafs_metadata_change_feed_events_total " +
+           std::to_string(g_metadata_change_feed_events_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_metadata_replication_rejected_total Replicated operations the leader's store rejected\n"
+           "# TYPE nebulafs_metadata_replication_rejected_total counter\n"
+           "nebulafs_metadata_replication_rejected_total " +
+           std::to_string(g_metadata_replication_rejected_total.load(std::memory_order_relaxed)) +
+           "\n"
+           "# HELP nebulafs_metadata_replication_replay_failures_total Replicated operations that failed when replayed from the log\n"
+           "# TYPE nebulafs_metadata_replication_replay_failures_total counter\n"
+           "nebulafs_metadata_replication_replay_failures_total " +
+           std::to_string(
+               g_metadata_replication_replay_failures_total.load(std::memory_order_relaxed)) +
+           "\n"
            "# HELP nebulafs_storage_node_blob_writes_total Total storage node blob writes\n"
            "# TYPE nebulafs_storage_node_blob_writes_total counter\n"
            "nebulafs_storage_node_blob_writes_total " +
@@ -310,22 +615,7 @@ std::string RenderMetrics() {
            "# TYPE nebulafs_storage_node_blob_delete_latency_ms_sum counter\n"
            "nebulafs_storage_node_blob_delete_latency_ms_sum " +
            std::to_string(g_storage_node_blob_delete_latency_ms_sum.load(std::memory_order_relaxed)) +
-           "\n"
-           "# HELP nebulafs_storage_node_blob_composes_total Total storage node blob compose requests\n"
-           "# TYPE nebulafs_storage_node_blob_composes_total counter\n"
-           "nebulafs_storage_node_blob_composes_total " +
-           std::to_string(g_storage_node_blob_composes_total.load(std::memory_order_relaxed)) +
-           "\n"
-           "# HELP nebulafs_storage_node_blob_compose_failures_total Total storage node blob compose failures\n"
-           "# TYPE nebulafs_storage_node_blob_compose_failures_total counter\n"
-           "nebulafs_storage_node_blob_compose_failures_total " +
-           std::to_string(g_storage_node_blob_compose_failures_total.load(std::memory_order_relaxed)) +
-           "\n"
-           "# HELP nebulafs_storage_node_blob_compose_latency_ms_sum Sum of storage node blob compose latency in ms\n"
-           "# TYPE nebulafs_storage_node_blob_compose_latency_ms_sum counter\n"
-           "nebulafs_storage_node_blob_compose_latency_ms_sum " +
-           std::to_string(g_storage_node_blob_compose_latency_ms_sum.load(std::memory_order_relaxed)) +
-           "\n";
+           "\n" + RenderGroupCommitHistogram() + RenderChangeFeedLagHistogram();
 }
 
 }  // namespace nebulafs::observability
@@ -0,0 +1,134 @@
+#include "nebulafs/storage/blob_reclaimer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "nebulafs/core/logger.h"
+#include "nebulafs/observability/metrics.h"
+
+namespace nebulafs::storage {
+
+BlobReclaimer::BlobReclaimer(Sender sender, std::size_t batch_size,
+                             std::chrono::milliseconds retry_delay)
+    : sender_(std::move(sender)),
+      batch_size_(batch_size == 0 ? 1 : batch_size),
+      retry_delay_(retry_delay),
+      worker_([this] { Run(); }) {}
+
+BlobReclaimer::~BlobReclaimer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+void BlobReclaimer::Enqueue(const metadata::ResolveReadPlan& plan) {
+    std::size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto add = [&](const std::string& blob_id,
+                       const std::vector<metadata::ReplicaTarget>& replicas) {
+            for (const auto& replica : replicas) {
+                queue_[replica.endpoint].push_back(Pending{blob_id, 0});
+                ++added;
+            }
+        };
+        add(plan.blob_id, plan.replicas);
+        // A composite object owns the blobs its parts were uploaded as.
+        for (const auto& segment : plan.segments) {
+            add(segment.blob_id, segment.replicas);
+        }
+        queued_ += added;
+    }
+    if (added > 0) {
+        observability::RecordGatewayReclaimQueue(static_cast<std::int64_t>(added));
+        wake_.notify_one();
+    }
+}
+
+void BlobReclaimer::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [&] { return queued_ == 0 && in_flight_ == 0; });
+}
+
+void BlobReclaimer::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || queued_ > 0; });
+        if (queued_ == 0) {
+            break;
+        }
+        // One batch per node per round, so a node with a deep queue does not hold up the
+        // others.
+        std::vector<std::pair<std::string, std::vector<Pending>>> batches;
+        std::size_t taken = 0;
+        for (auto it = queue_.begin(); it != queue_.end();) {
+            auto& pending = it->second;
+            const auto count = std::min(batch_size_, pending.size());
+            const auto first = pending.end() - static_cast<std::ptrdiff_t>(count);
+            std::vector<Pending> batch(std::make_move_iterator(first),
+                                       std::make_move_iterator(pending.end()));
+            batches.emplace_back(it->first, std::move(batch));
+            pending.erase(first, pending.end());
+            taken += count;
+            it = pending.empty() ? queue_.erase(it) : std::next(it);
+        }
+        queued_ -= taken;
+        in_flight_ += taken;
+        const bool last_round = stop_;
+        lock.unlock();
+
+        std::vector<std::pair<std::string, std::vector<Pending>>> retries;
+        std::size_t done = 0;
+        for (auto& [endpoint, pending] : batches) {
+            std::vector<std::string> blob_ids;
+            blob_ids.reserve(pending.size());
+            for (const auto& blob : pending) {
+                blob_ids.push_back(blob.blob_id);
+            }
+            auto sent = sender_(endpoint, blob_ids);
+            observability::RecordGatewayBlobReclaim(blob_ids.size(), sent.ok());
+            if (sent.ok()) {
+                done += pending.size();
+                continue;
+            }
+            std::vector<Pending> again;
+            for (auto& blob : pending) {
+                if (++blob.attempts < kMaxAttempts && !last_round) {
+                    again.push_back(std::move(blob));
+                }
+            }
+            if (again.size() < pending.size()) {
+                core::LogError("dropping " + std::to_string(pending.size() - again.size()) +
+                               " blob deletes for " + endpoint + ": " + sent.error().message);
+            }
+            done += pending.size() - again.size();
+            if (!again.empty()) {
+                retries.emplace_back(endpoint, std::move(again));
+            }
+        }
+        observability::RecordGatewayReclaimQueue(-static_cast<std::int64_t>(done));
+
+        lock.lock();
+        in_flight_ -= taken;
+        for (auto& [endpoint, pending] : retries) {
+            queued_ += pending.size();
+            auto& queued = queue_[endpoint];
+            queued.insert(queued.end(), std::make_move_iterator(pending.begin()),
+                          std::make_move_iterator(pending.end()));
+        }
+        if (queued_ == 0 && in_flight_ == 0) {
+            idle_.notify_all();
+        }
+        if (!retries.empty()) {
+            // An unreachable node is given time to come back before the next round.
+            wake_.wait_for(lock, retry_delay_, [&] { return stop_; });
+        }
+    }
+    idle_.notify_all();
+}
+
+}  // namespace nebulafs::storage
@@ -0,0 +1,238 @@
+#include "nebulafs/storage/compressed_object.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <zlib.h>
+
+#include "nebulafs/core/binary_codec.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace nebulafs::storage {
+
+namespace {
+
+// "NFZ1" read as a little-endian u32.
+constexpr std::uint32_t kFooterMagic = 0x315a464e;
+// Size, frame size, frame count, index CRC-32C and magic.
+constexpr std::size_t kFooterBytes = 8 + 4 + 4 + 4 + 4;
+// Stored size with the deflated flag, then the CRC-32C of the uncompressed bytes.
+constexpr std::size_t kIndexEntryBytes = 8;
+constexpr std::uint32_t kDeflatedFlag = 0x80000000u;
+// Logs and JSON already shrink several times at a low level; higher ones cost far more CPU for
+// a few more percent.
+constexpr int kCompressionLevel = 3;
+
+core::Error IoError(const std::string& message) {
+    return core::Error{core::ErrorCode::kIoError, message};
+}
+
+struct Footer {
+    std::uint64_t size{0};
+    std::uint32_t frame_bytes{0};
+    std::uint32_t frame_count{0};
+    std::uint32_t index_crc{0};
+};
+
+core::Result<Footer> ReadFooter(std::ifstream& in, std::uint64_t file_size) {
+    if (file_size < kFooterBytes) {
+        return IoError("compressed object is truncated");
+    }
+    std::string bytes(kFooterBytes, '\0');
+    in.seekg(static_cast<std::streamoff>(file_size - kFooterBytes));
+    if (!in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+        return IoError("failed to read compressed object footer");
+    }
+    core::ByteReader reader(bytes);
+    Footer footer;
+    std::uint32_t magic = 0;
+    if (!reader.GetU64(footer.size) || !reader.GetU32(footer.frame_bytes) ||
+        !reader.GetU32(footer.frame_count) || !reader.GetU32(footer.index_crc) ||
+        !reader.GetU32(magic) || magic != kFooterMagic || footer.frame_bytes == 0 ||
+        footer.frame_count != (footer.size + footer.frame_bytes - 1) / footer.frame_bytes) {
+        return IoError("invalid compressed object footer");
+    }
+    return footer;
+}
+
+std::uint64_t FileSize(std::ifstream& in) {
+    in.seekg(0, std::ios::end);
+    const auto end = in.tellg();
+    return end < 0 ? 0 : static_cast<std::uint64_t>(end);
+}
+
+}  // namespace
+
+core::Result<CompressionResult> CompressObjectFile(const std::string& source,
+                                                   const std::string& dest,
+                                                   std::size_t frame_bytes) {
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    if (!in.is_open() || !out.is_open()) {
+        return IoError("failed to open compressed object files");
+    }
+    z_stream stream{};
+    // Raw deflate: the index already records each frame's size and checksum.
+    if (deflateInit2(&stream, kCompressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) !=
+        Z_OK) {
+        return IoError("failed to start compression");
+    }
+    std::string raw(frame_bytes, '\0');
+    std::string packed(deflateBound(&stream, static_cast<uLong>(frame_bytes)), '\0');
+    core::ByteWriter index;
+    CompressionResult result;
+    std::uint32_t frame_count = 0;
+    bool ok = true;
+    while (ok) {
+        in.read(raw.data(), static_cast<std::streamsize>(raw.size()));
+        const auto size = static_cast<std::size_t>(in.gcount());
+        if (size == 0) {
+            break;
+        }
+        deflateReset(&stream);
+        stream.next_in = reinterpret_cast<Bytef*>(raw.data());
+        stream.avail_in = static_cast<uInt>(size);
+        stream.next_out = reinterpret_cast<Bytef*>(packed.data());
+        stream.avail_out = static_cast<uInt>(packed.size());
+        ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+        const auto deflated_size = packed.size() - stream.avail_out;
+        // Frames that do not shrink (already compressed media) are kept as they are.
+        const bool deflated = deflated_size < size;
+        const auto stored_size = deflated ? deflated_size : size;
+        out.write(deflated ? packed.data() : raw.data(), static_cast<std::streamsize>(stored_size));
+        index.PutU32(static_cast<std::uint32_t>(stored_size) | (deflated ? kDeflatedFlag : 0));
+        index.PutU32(core::Crc32c(std::string_view(raw.data(), size)));
+        result.raw_bytes += size;
+        result.stored_bytes += stored_size;
+        ++frame_count;
+        ok = ok && out.good();
+    }
+    deflateEnd(&stream);
+    if (!ok || in.bad()) {
+        return IoError("failed to compress object");
+    }
+    core::ByteWriter footer;
+    footer.PutU64(result.raw_bytes);
+    footer.PutU32(static_cast<std::uint32_t>(frame_bytes));
+    footer.PutU32(frame_count);
+    footer.PutU32(core::Crc32c(index.data()));
+    footer.PutU32(kFooterMagic);
+    out.write(index.data().data(), static_cast<std::streamsize>(index.size()));
+    out.write(footer.data().data(), static_cast<std::streamsize>(footer.size()));
+    out.close();
+    if (!out.good()) {
+        return IoError("failed to write compressed object");
+    }
+#ifndef _WIN32
+    // The raw temp file was synced; the file replacing it must be as durable.
+    const int fd = ::open(dest.c_str(), O_RDONLY);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return IoError("failed to sync compressed object");
+    }
+    ::close(fd);
+#endif
+    result.stored_bytes += index.size() + footer.size();
+    return result;
+}
+
+core::Result<CompressedObjectReader> CompressedObjectReader::Open(const std::string& path) {
+    CompressedObjectReader reader;
+    reader.file_.open(path, std::ios::binary);
+    if (!reader.file_.is_open()) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    const auto file_size = FileSize(reader.file_);
+    auto footer = ReadFooter(reader.file_, file_size);
+    if (!footer.ok()) {
+        return footer.error();
+    }
+    const auto& f = footer.value();
+    const auto index_bytes = static_cast<std::uint64_t>(f.frame_count) * kIndexEntryBytes;
+    if (file_size < kFooterBytes + index_bytes) {
+        return IoError("compressed object is truncated");
+    }
+    const auto frames_end = file_size - kFooterBytes - index_bytes;
+    std::string index(static_cast<std::size_t>(index_bytes), '\0');
+    reader.file_.seekg(static_cast<std::streamoff>(frames_end));
+    if (!reader.file_.read(index.data(), static_cast<std::streamsize>(index.size())) ||
+        core::Crc32c(index) != f.index_crc) {
+        return IoError("invalid compressed object index");
+    }
+    core::ByteReader entries(index);
+    std::uint64_t offset = 0;
+    reader.frames_.resize(f.frame_count);
+    for (auto& frame : reader.frames_) {
+        std::uint32_t stored = 0;
+        entries.GetU32(stored);
+        entries.GetU32(frame.crc32c);
+        frame.offset = offset;
+        frame.deflated = (stored & kDeflatedFlag) != 0;
+        frame.stored_size = stored & ~kDeflatedFlag;
+        offset += frame.stored_size;
+    }
+    if (offset != frames_end) {
+        return IoError("invalid compressed object index");
+    }
+    reader.size_ = f.size;
+    reader.frame_bytes_ = f.frame_bytes;
+    return reader;
+}
+
+core::Result<std::uint64_t> CompressedObjectReader::ReadObjectSize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return core::Error{core::ErrorCode::kNotFound, "object not found"};
+    }
+    auto footer = ReadFooter(in, FileSize(in));
+    if (!footer.ok()) {
+        return footer.error();
+    }
+    return footer.value().size;
+}
+
+core::Result<void> CompressedObjectReader::ReadFrame(std::size_t index, std::string& out) {
+    if (index >= frames_.size()) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "frame out of range"};
+    }
+    const auto& frame = frames_[index];
+    const auto first = static_cast<std::uint64_t>(index) * frame_bytes_;
+    const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(frame_bytes_, size_ - first));
+    stored_.resize(frame.stored_size);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(frame.offset));
+    if (!file_.read(stored_.data(), static_cast<std::streamsize>(stored_.size()))) {
+        return IoError("failed to read compressed frame");
+    }
+    if (!frame.deflated) {
+        out = stored_;
+    } else {
+        out.resize(size);
+        z_stream stream{};
+        if (inflateInit2(&stream, -15) != Z_OK) {
+            return IoError("failed to start decompression");
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(stored_.data());
+        stream.avail_in = static_cast<uInt>(stored_.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        const int rc = inflate(&stream, Z_FINISH);
+        const bool complete = rc == Z_STREAM_END && stream.avail_out == 0;
+        inflateEnd(&stream);
+        if (!complete) {
+            return IoError("corrupt compressed frame");
+        }
+    }
+    if (out.size() != size || core::Crc32c(out) != frame.crc32c) {
+        return IoError("corrupt compressed frame");
+    }
+    return core::Ok();
+}
+
+}  // namespace nebulafs::storage
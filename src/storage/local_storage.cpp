@@ -1,39 +1,201 @@
 #include "nebulafs/storage/local_storage.h"
 
+#include <algorithm>
 #include <array>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 
-#include <Poco/DigestEngine.h>
-#include <Poco/SHA2Engine.h>
 #include <Poco/UUIDGenerator.h>
 
+#include "nebulafs/core/config.h"
+#include "nebulafs/core/hashing.h"
+#include "nebulafs/observability/metrics.h"
+#include "nebulafs/storage/compressed_object.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <fcntl.h>
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#endif
 
 namespace nebulafs::storage {
 
-LocalStorage::LocalStorage(std::string base_path, std::string temp_path)
-    : base_path_(std::move(base_path)), temp_path_(std::move(temp_path)) {
+namespace {
+
+// Points `final_path` at the stored body through a fresh link renamed over it, so a reader of
+// `final_path` sees either the old object or the new one.
+bool LinkIntoPlace(const std::string& content_path, const std::string& final_path,
+                   const std::string& temp_dir) {
+    const auto link_path =
+        (std::filesystem::path(temp_dir) / Poco::UUIDGenerator().createOne().toString()).string();
+    std::error_code ec;
+    std::filesystem::create_hard_link(content_path, link_path, ec);
+    if (ec) {
+        return false;
+    }
+    std::filesystem::rename(link_path, final_path, ec);
+    if (ec) {
+        std::filesystem::remove(link_path, ec);
+        return false;
+    }
+    return true;
+}
+
+// Writes a copy of `source` to `dest` without reading the bytes through this process where the
+// filesystem allows: a reflink shares the source's extents until either file changes, and
+// copy_file_range stays in the kernel (and may be offloaded by NFS or a copy-on-write
+// filesystem). Anything else falls back to a plain copy.
+bool CloneFile(const std::string& source, const std::string& dest) {
+#ifdef __linux__
+    const int in = ::open(source.c_str(), O_RDONLY);
+    if (in < 0) {
+        return false;
+    }
+    const int out = ::open(dest.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+    bool copied = ::ioctl(out, FICLONE, in) == 0;
+    if (!copied) {
+        struct stat info {};
+        copied = ::fstat(in, &info) == 0;
+        auto remaining = copied ? static_cast<std::uint64_t>(info.st_size) : 0;
+        while (copied && remaining > 0) {
+            const auto moved = ::copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+            if (moved < 0 && errno == EINTR) {
+                continue;
+            }
+            copied = moved > 0;
+            remaining -= copied ? static_cast<std::uint64_t>(moved) : 0;
+        }
+    }
+    // Like a written object, the copy is durable before it is renamed into place.
+    copied = copied && ::fsync(out) == 0;
+    ::close(in);
+    ::close(out);
+    if (copied) {
+        return true;
+    }
+#endif
+    std::error_code ec;
+    std::filesystem::copy_file(source, dest, std::filesystem::copy_options::overwrite_existing,
+                               ec);
+    return !ec;
+}
+
+}  // namespace
+
+LocalStorage::LocalStorage(std::string base_path, std::string temp_path, bool content_addressed,
+                           std::vector<std::string> fanout_buckets,
+                           std::vector<std::string> compressed_buckets)
+    : base_path_(std::move(base_path)),
+      temp_path_(std::move(temp_path)),
+      content_addressed_(content_addressed),
+      fanout_buckets_(std::move(fanout_buckets)),
+      compressed_buckets_(std::move(compressed_buckets)) {
     std::filesystem::create_directories(base_path_);
     std::filesystem::create_directories(temp_path_);
+    if (fanout_buckets_.empty()) {
+        return;
+    }
+    // Existing buckets switch before any write, so none lands in a flat directory behind the
+    // migration.
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(std::filesystem::path(base_path_) / "buckets", ec),
+         end;
+         !ec && it != end; it.increment(ec)) {
+        const auto bucket = it->path().filename().string();
+        std::error_code entry_ec;
+        if (it->is_directory(entry_ec) && WantsFanout(bucket)) {
+            MarkFanoutBucket(bucket);
+        }
+    }
 }
 
 core::Result<void> LocalStorage::EnsureBucket(const std::string& bucket) {
     if (!IsSafeName(bucket)) {
         return core::Error{core::ErrorCode::kInvalidArgument, "invalid bucket name"};
     }
+    if (IsFanoutBucket(bucket)) {
+        return core::Ok();
+    }
+    if (WantsFanout(bucket)) {
+        MarkFanoutBucket(bucket);
+        return core::Ok();
+    }
     std::filesystem::path bucket_path = std::filesystem::path(base_path_) / "buckets" / bucket;
     // Ensure bucket and object directories exist before any writes.
     std::filesystem::create_directories(bucket_path / "objects");
     return core::Ok();
 }
 
+bool LocalStorage::WantsFanout(const std::string& bucket) const {
+    return core::IsBucketListed(fanout_buckets_, bucket);
+}
+
+void LocalStorage::MarkFanoutBucket(const std::string& bucket) {
+    std::filesystem::create_directories(std::filesystem::path(base_path_) / "buckets" / bucket /
+                                        "fanout");
+    std::unique_lock<std::shared_mutex> lock(fanout_mutex_);
+    fanout_state_[bucket] = true;
+}
+
+bool LocalStorage::IsFanoutBucket(const std::string& bucket) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(fanout_mutex_);
+        const auto it = fanout_state_.find(bucket);
+        if (it != fanout_state_.end()) {
+            return it->second;
+        }
+    }
+    const auto bucket_path = std::filesystem::path(base_path_) / "buckets" / bucket;
+    std::error_code ec;
+    const bool fanout = std::filesystem::is_directory(bucket_path / "fanout", ec);
+    // Only buckets that exist are remembered, so lookups of unknown names cannot grow the map.
+    if (fanout || std::filesystem::is_directory(bucket_path, ec)) {
+        std::unique_lock<std::shared_mutex> lock(fanout_mutex_);
+        auto& state = fanout_state_[bucket];
+        // A concurrent MarkFanoutBucket may have got here first, and its switch holds.
+        state = state || fanout;
+        return state;
+    }
+    return false;
+}
+
+std::string LocalStorage::ObjectPath(const std::string& bucket, const std::string& object) const {
+    return IsFanoutBucket(bucket) ? BuildFanoutObjectPath(base_path_, bucket, object)
+                                  : BuildObjectPath(base_path_, bucket, object);
+}
+
+std::string LocalStorage::FindObjectPath(const std::string& bucket, const std::string& object,
+                                         const std::string& suffix) const {
+    std::error_code ec;
+    const auto flat = BuildObjectPath(base_path_, bucket, object) + suffix;
+    if (!IsFanoutBucket(bucket)) {
+        return std::filesystem::exists(flat, ec) ? flat : std::string();
+    }
+    const auto fanned = BuildFanoutObjectPath(base_path_, bucket, object) + suffix;
+    if (std::filesystem::exists(fanned, ec)) {
+        return fanned;
+    }
+    // Either not migrated yet, or migrated between the two lookups, which the last one catches.
+    if (std::filesystem::exists(flat, ec)) {
+        return flat;
+    }
+    return std::filesystem::exists(fanned, ec) ? fanned : std::string();
+}
+
 core::Result<StoredObject> LocalStorage::WriteObject(const std::string& bucket,
                                                      const std::string& object,
                                                      std::istream& data) {
@@ -46,12 +208,11 @@ core::Result<StoredObject> LocalStorage::WriteObject(const std::string& bucket,
         return ensure.error();
     }
 
-    const auto final_path = BuildObjectPath(base_path_, bucket, object);
     // Write to a temp file first, then atomically rename into place.
     const auto temp_name = Poco::UUIDGenerator().createOne().toString();
     const auto temp_path = (std::filesystem::path(temp_path_) / temp_name).string();
 
-    Poco::SHA2Engine256 sha256;
+    core::Sha256Hasher sha256;
     std::uint64_t total = 0;
 
 #ifdef _WIN32
@@ -67,7 +228,7 @@ core::Result<StoredObject> LocalStorage::WriteObject(const std::string& bucket,
             break;
         }
         out.write(buffer.data(), bytes);
-        sha256.update(buffer.data(), static_cast<unsigned int>(bytes));
+        sha256.Update(buffer.data(), static_cast<std::size_t>(bytes));
         total += static_cast<std::uint64_t>(bytes);
     }
     out.flush();
@@ -95,42 +256,352 @@ core::Result<StoredObject> LocalStorage::WriteObject(const std::string& bucket,
             ::close(fd);
             return core::Error{core::ErrorCode::kIoError, "failed to write temp file"};
         }
-        sha256.update(buffer.data(), static_cast<unsigned int>(bytes));
+        sha256.Update(buffer.data(), static_cast<std::size_t>(bytes));
         total += static_cast<std::uint64_t>(bytes);
     }
     ::fsync(fd);
     ::close(fd);
 #endif
 
+    return InstallObject(bucket, object, temp_path, sha256.HexDigest(), total);
+}
+
+core::Result<StoredObject> LocalStorage::InstallObject(const std::string& bucket,
+                                                       const std::string& object,
+                                                       const std::string& temp_file,
+                                                       const std::string& etag,
+                                                       std::uint64_t size) {
+    StoredObject stored;
+    stored.path = ObjectPath(bucket, object);
+    stored.etag = etag;
+    stored.size_bytes = size;
     std::error_code ec;
-    std::filesystem::create_directories(std::filesystem::path(final_path).parent_path(), ec);
+    std::filesystem::create_directories(std::filesystem::path(stored.path).parent_path(), ec);
     if (ec) {
         return core::Error{core::ErrorCode::kIoError, "failed to create object directory"};
     }
+    if (core::IsBucketListed(compressed_buckets_, bucket)) {
+        // Compressed bodies are not shared through the content store: it keeps raw bytes.
+        const auto packed =
+            (std::filesystem::path(temp_path_) / Poco::UUIDGenerator().createOne().toString())
+                .string();
+        const auto started = std::chrono::steady_clock::now();
+        auto compressed = CompressObjectFile(temp_file, packed);
+        std::filesystem::remove(temp_file, ec);
+        if (!compressed.ok()) {
+            std::filesystem::remove(packed, ec);
+            return compressed.error();
+        }
+        observability::RecordGatewayCompression(
+            compressed.value().raw_bytes, compressed.value().stored_bytes,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started)
+                .count());
+        stored.path += kCompressedSuffix;
+        stored.compressed = true;
+        std::filesystem::rename(packed, stored.path, ec);
+        if (ec) {
+            std::filesystem::remove(packed, ec);
+            return core::Error{core::ErrorCode::kIoError, "failed to finalize object write"};
+        }
+        // Reads try the raw file first, so an older raw version would shadow this one.
+        RemoveObjectFiles(bucket, object, "");
+        return stored;
+    }
+    if (content_addressed_ && IsContentDigest(etag)) {
+        auto committed = CommitContent(temp_file, etag, stored.path);
+        if (!committed.ok()) {
+            return committed.error();
+        }
+    } else {
+        std::filesystem::rename(temp_file, stored.path, ec);
+        if (ec) {
+            return core::Error{core::ErrorCode::kIoError, "failed to finalize object write"};
+        }
+    }
+    // The raw file already shadows an older compressed version; this just frees its space.
+    RemoveObjectFiles(bucket, object, kCompressedSuffix);
+    return stored;
+}
+
+core::Result<void> LocalStorage::CommitContent(const std::string& temp_path,
+                                               const std::string& etag,
+                                               const std::string& final_path) {
+    const auto content_path = BuildContentPath(base_path_, etag);
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(content_path).parent_path(), ec);
+    if (!ec) {
+        std::filesystem::create_hard_link(temp_path, content_path, ec);
+        // The link only fails to appear when an identical body is already kept; the object
+        // then shares it and these bytes are dropped.
+        if (ec && LinkIntoPlace(content_path, final_path, temp_path_)) {
+            std::filesystem::remove(temp_path, ec);
+            observability::RecordGatewayContentDedupHit();
+            return core::Ok();
+        }
+    }
+    // When the store cannot take the body (or it was reclaimed while being linked), the object
+    // keeps its own bytes: still correct, only not shared.
     std::filesystem::rename(temp_path, final_path, ec);
     if (ec) {
         return core::Error{core::ErrorCode::kIoError, "failed to finalize object write"};
     }
+    return core::Ok();
+}
+
+core::Result<StoredObject> LocalStorage::LinkObject(const std::string& bucket,
+                                                    const std::string& object,
+                                                    const std::string& sha256) {
+    if (!IsSafeName(bucket) || !IsSafeName(object)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
+    }
+    const core::Error not_stored{core::ErrorCode::kNotFound, "content not stored"};
+    if (!content_addressed_ || !IsContentDigest(sha256)) {
+        return not_stored;
+    }
+    const auto content_path = BuildContentPath(base_path_, sha256);
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(content_path, ec);
+    if (ec) {
+        return not_stored;
+    }
+    auto ensure = EnsureBucket(bucket);
+    if (!ensure.ok()) {
+        return ensure.error();
+    }
+    const auto final_path = ObjectPath(bucket, object);
+    std::filesystem::create_directories(std::filesystem::path(final_path).parent_path(), ec);
+    if (!LinkIntoPlace(content_path, final_path, temp_path_)) {
+        // A reclaim may have removed the body since it was found; the client then sends it.
+        if (!std::filesystem::exists(content_path)) {
+            return not_stored;
+        }
+        return core::Error{core::ErrorCode::kIoError, "failed to link stored content"};
+    }
+    observability::RecordGatewayContentDedupHit();
+    RemoveObjectFiles(bucket, object, kCompressedSuffix);
 
     StoredObject stored;
     stored.path = final_path;
-    stored.size_bytes = total;
-    stored.etag = Poco::DigestEngine::digestToHex(sha256.digest());
+    stored.size_bytes = static_cast<std::uint64_t>(size);
+    stored.etag = sha256;
     return stored;
 }
 
+core::Result<StoredObject> LocalStorage::PlaceObject(const std::string& bucket,
+                                                     const std::string& object,
+                                                     const std::string& file_path,
+                                                     const std::string& etag) {
+    if (!IsSafeName(bucket) || !IsSafeName(object)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
+    }
+    auto ensure = EnsureBucket(bucket);
+    if (!ensure.ok()) {
+        return ensure.error();
+    }
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(file_path, ec);
+    if (ec) {
+        return core::Error{core::ErrorCode::kIoError, "failed to finalize object write"};
+    }
+    return InstallObject(bucket, object, file_path, etag, static_cast<std::uint64_t>(size));
+}
+
+core::Result<std::uint64_t> LocalStorage::MigrateObjectLayout(std::size_t max_objects) {
+    const std::filesystem::directory_iterator end;
+    std::uint64_t moved = 0;
+    bool failed = false;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator buckets(std::filesystem::path(base_path_) / "buckets",
+                                                     ec);
+         !ec && buckets != end && moved < max_objects; buckets.increment(ec)) {
+        const auto bucket = buckets->path().filename().string();
+        const auto flat_dir = buckets->path() / "objects";
+        std::error_code dir_ec;
+        if (!IsFanoutBucket(bucket) || !std::filesystem::is_directory(flat_dir, dir_ec)) {
+            continue;
+        }
+        for (std::filesystem::directory_iterator it(flat_dir, dir_ec);
+             !dir_ec && it != end && moved < max_objects; it.increment(dir_ec)) {
+            // A compressed object moves under the hash of its object name, like its raw form.
+            auto name = it->path().filename().string();
+            std::string suffix;
+            const std::string compressed_suffix = kCompressedSuffix;
+            if (name.size() > compressed_suffix.size() &&
+                name.compare(name.size() - compressed_suffix.size(), compressed_suffix.size(),
+                             compressed_suffix) == 0) {
+                name.resize(name.size() - compressed_suffix.size());
+                suffix = compressed_suffix;
+            }
+            const auto target = BuildFanoutObjectPath(base_path_, bucket, name) + suffix;
+            std::error_code move_ec;
+            std::filesystem::create_directories(std::filesystem::path(target).parent_path(),
+                                                move_ec);
+            // A link rather than a rename: it fails instead of replacing an object written to
+            // the new path since, whose flat copy is then stale and just goes. Deletes remove
+            // the flat copy first, so a link made here never outlives one.
+            std::filesystem::create_hard_link(it->path(), target, move_ec);
+            if (move_ec && move_ec != std::errc::file_exists) {
+                failed = true;
+                continue;
+            }
+            std::filesystem::remove(it->path(), move_ec);
+            ++moved;
+        }
+        failed = failed || static_cast<bool>(dir_ec);
+    }
+    observability::RecordGatewayObjectsMigrated(moved);
+    if (ec || failed) {
+        return core::Error{core::ErrorCode::kIoError, "failed to migrate object layout"};
+    }
+    return moved;
+}
+
+core::Result<std::uint64_t> LocalStorage::ReclaimContent() {
+    const auto root = std::filesystem::path(base_path_) / "content";
+    std::error_code ec;
+    if (!content_addressed_ || !std::filesystem::exists(root, ec)) {
+        return 0;
+    }
+    // A body whose only link is its own store entry backs no object. A writer linking it
+    // concurrently still holds its own link to the same file, so removing the entry never
+    // loses data; that write just stops being shared.
+    std::uint64_t reclaimed = 0;
+    for (std::filesystem::recursive_directory_iterator it(root, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        std::error_code entry_ec;
+        if (!it->is_regular_file(entry_ec) || entry_ec ||
+            std::filesystem::hard_link_count(it->path(), entry_ec) != 1 || entry_ec) {
+            continue;
+        }
+        if (std::filesystem::remove(it->path(), entry_ec)) {
+            ++reclaimed;
+        }
+    }
+    observability::RecordGatewayContentReclaimed(reclaimed);
+    if (ec) {
+        return core::Error{core::ErrorCode::kIoError, "failed to scan content store"};
+    }
+    return reclaimed;
+}
+
 core::Result<StoredObject> LocalStorage::ReadObject(const std::string& bucket,
                                                     const std::string& object) const {
     if (!IsSafeName(bucket) || !IsSafeName(object)) {
         return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
     }
-    const auto path = BuildObjectPath(base_path_, bucket, object);
-    if (!std::filesystem::exists(path)) {
+    StoredObject stored;
+    stored.path = FindObjectPath(bucket, object);
+    std::error_code ec;
+    if (!stored.path.empty()) {
+        stored.size_bytes = static_cast<std::uint64_t>(std::filesystem::file_size(stored.path, ec));
+        if (!ec) {
+            return stored;
+        }
+    }
+    stored.path = FindObjectPath(bucket, object, kCompressedSuffix);
+    if (stored.path.empty()) {
         return core::Error{core::ErrorCode::kNotFound, "object not found"};
     }
-    StoredObject stored;
-    stored.path = path;
-    stored.size_bytes = static_cast<std::uint64_t>(std::filesystem::file_size(path));
+    auto size = CompressedObjectReader::ReadObjectSize(stored.path);
+    if (!size.ok()) {
+        return size.error();
+    }
+    stored.size_bytes = size.value();
+    stored.compressed = true;
+    return stored;
+}
+
+core::Result<StoredRange> LocalStorage::ReadObjectRange(const std::string& bucket,
+                                                        const std::string& object,
+                                                        std::uint64_t first,
+                                                        std::uint64_t last) const {
+    auto stored = ReadObject(bucket, object);
+    if (!stored.ok()) {
+        return stored.error();
+    }
+    // The object file already holds every byte, so the range is served from it in place.
+    StoredRange range;
+    range.object_size = stored.value().size_bytes;
+    if (first >= range.object_size) {
+        return range;
+    }
+    range.path = std::move(stored.value().path);
+    range.compressed = stored.value().compressed;
+    range.path_offset = range.compressed ? 0 : first;
+    range.first = first;
+    range.last = std::min(last, range.object_size - 1);
+    return range;
+}
+
+core::Result<StoredObject> LocalStorage::CopyObject(const std::string& source_bucket,
+                                                    const std::string& source_object,
+                                                    const std::string& bucket,
+                                                    const std::string& object) {
+    return TransferObject(source_bucket, source_object, bucket, object, false);
+}
+
+core::Result<StoredObject> LocalStorage::MoveObject(const std::string& source_bucket,
+                                                    const std::string& source_object,
+                                                    const std::string& bucket,
+                                                    const std::string& object) {
+    return TransferObject(source_bucket, source_object, bucket, object, true);
+}
+
+core::Result<StoredObject> LocalStorage::TransferObject(const std::string& source_bucket,
+                                                        const std::string& source_object,
+                                                        const std::string& bucket,
+                                                        const std::string& object, bool move) {
+    if (!IsSafeName(source_bucket) || !IsSafeName(source_object) || !IsSafeName(bucket) ||
+        !IsSafeName(object)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
+    }
+    if (source_bucket == bucket && source_object == object) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "source and destination are the same"};
+    }
+    auto source = ReadObject(source_bucket, source_object);
+    if (!source.ok()) {
+        return source.error();
+    }
+    auto ensure = EnsureBucket(bucket);
+    if (!ensure.ok()) {
+        return ensure.error();
+    }
+    // The object keeps the form it is stored in, whatever the destination bucket would
+    // write; reads find either form.
+    StoredObject stored = std::move(source.value());
+    const auto source_path = stored.path;
+    const auto suffix = stored.compressed ? kCompressedSuffix : "";
+    stored.path = ObjectPath(bucket, object) + suffix;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(stored.path).parent_path(), ec);
+    if (move) {
+        // Both buckets live under `base_path`, so this is a rename(2) on one filesystem.
+        std::filesystem::rename(source_path, stored.path, ec);
+        if (ec) {
+            return core::Error{core::ErrorCode::kIoError, "failed to move object"};
+        }
+        // Drops a shadowed copy in the other form or the other layout.
+        RemoveObjectFiles(source_bucket, source_object, "");
+        RemoveObjectFiles(source_bucket, source_object, kCompressedSuffix);
+    } else if (!(content_addressed_ && !stored.compressed &&
+                 LinkIntoPlace(source_path, stored.path, temp_path_))) {
+        // Content-addressed bodies are shared by linking, as identical uploads are; other
+        // objects get their own file so their link counts keep meaning nothing.
+        const auto temp_file =
+            (std::filesystem::path(temp_path_) / Poco::UUIDGenerator().createOne().toString())
+                .string();
+        if (!CloneFile(source_path, temp_file)) {
+            std::filesystem::remove(temp_file, ec);
+            return core::Error{core::ErrorCode::kIoError, "failed to copy object"};
+        }
+        std::filesystem::rename(temp_file, stored.path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_file, ec);
+            return core::Error{core::ErrorCode::kIoError, "failed to copy object"};
+        }
+    }
+    RemoveObjectFiles(bucket, object, stored.compressed ? "" : kCompressedSuffix);
     return stored;
 }
 
@@ -139,14 +610,47 @@ core::Result<void> LocalStorage::DeleteObject(const std::string& bucket,
     if (!IsSafeName(bucket) || !IsSafeName(object)) {
         return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
     }
-    const auto path = BuildObjectPath(base_path_, bucket, object);
-    if (!std::filesystem::exists(path)) {
+    const bool removed_raw = RemoveObjectFiles(bucket, object, "");
+    const bool removed_compressed = RemoveObjectFiles(bucket, object, kCompressedSuffix);
+    if (!removed_raw && !removed_compressed) {
         return core::Error{core::ErrorCode::kNotFound, "object not found"};
     }
-    std::filesystem::remove(path);
     return core::Ok();
 }
 
+core::Result<std::vector<bool>> LocalStorage::DeleteObjects(
+    const std::string& bucket, const std::vector<std::string>& objects) {
+    if (!IsSafeName(bucket)) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "invalid object path"};
+    }
+    std::vector<bool> removed(objects.size(), false);
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (!IsSafeName(objects[i])) {
+            continue;
+        }
+        // Both forms go, as in `DeleteObject`; the metadata rows are the caller's to remove.
+        const bool removed_raw = RemoveObjectFiles(bucket, objects[i], "");
+        const bool removed_compressed = RemoveObjectFiles(bucket, objects[i], kCompressedSuffix);
+        removed[i] = removed_raw || removed_compressed;
+    }
+    return removed;
+}
+
+bool LocalStorage::RemoveObjectFiles(const std::string& bucket, const std::string& object,
+                                     const std::string& suffix) {
+    // The flat copy goes first, so the migration cannot link it across once the fan-out copy
+    // is gone.
+    std::error_code ec;
+    const bool removed_flat =
+        std::filesystem::remove(BuildObjectPath(base_path_, bucket, object) + suffix, ec);
+    if (!IsFanoutBucket(bucket)) {
+        return removed_flat;
+    }
+    const bool removed_fanned =
+        std::filesystem::remove(BuildFanoutObjectPath(base_path_, bucket, object) + suffix, ec);
+    return removed_flat || removed_fanned;
+}
+
 bool LocalStorage::IsSafeName(const std::string& name) {
     if (name.empty() || name.size() > 255) {
         return false;
@@ -167,4 +671,33 @@ std::string LocalStorage::BuildObjectPath(const std::string& base_path, const st
     return (std::filesystem::path(base_path) / "buckets" / bucket / "objects" / object).string();
 }
 
+std::string LocalStorage::BuildFanoutObjectPath(const std::string& base_path,
+                                               const std::string& bucket,
+                                               const std::string& object) {
+    // FNV-1a rather than std::hash: the path must not change between builds or platforms.
+    std::uint32_t hash = 2166136261u;
+    for (const unsigned char c : object) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    // 256 x 256 directories keep about 150 objects in each at ten million.
+    constexpr char kHex[] = "0123456789abcdef";
+    const std::string outer{kHex[(hash >> 28) & 0xf], kHex[(hash >> 24) & 0xf]};
+    const std::string inner{kHex[(hash >> 20) & 0xf], kHex[(hash >> 16) & 0xf]};
+    return (std::filesystem::path(base_path) / "buckets" / bucket / "fanout" / outer / inner /
+            object)
+        .string();
+}
+
+std::string LocalStorage::BuildContentPath(const std::string& base_path,
+                                           const std::string& sha256) {
+    // A two-digit fan-out keeps any one directory to a few thousand entries per million bodies.
+    return (std::filesystem::path(base_path) / "content" / sha256.substr(0, 2) / sha256).string();
+}
+
+bool LocalStorage::IsContentDigest(const std::string& sha256) {
+    return sha256.size() == 64 && std::all_of(sha256.begin(), sha256.end(), [](char c) {
+               return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+           });
+}
+
 }  // namespace nebulafs::storage
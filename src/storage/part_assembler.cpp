@@ -0,0 +1,186 @@
+#include "nebulafs/storage/part_assembler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nebulafs/core/hashing.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace nebulafs::storage {
+
+namespace {
+
+constexpr std::size_t kCopyBufferBytes = 1 << 20;
+
+core::Error IoError(const std::string& message) {
+    return core::Error{core::ErrorCode::kIoError, message};
+}
+
+// Copies `size` bytes from the start of `in` to the current position of `out`.
+bool CopyBytes(std::istream& in, std::ostream& out, std::uint64_t size, std::vector<char>& buf) {
+    while (size > 0) {
+        const auto chunk = static_cast<std::streamsize>(std::min<std::uint64_t>(size, buf.size()));
+        if (!in.read(buf.data(), chunk) || !out.write(buf.data(), chunk)) {
+            return false;
+        }
+        size -= static_cast<std::uint64_t>(chunk);
+    }
+    return true;
+}
+
+}  // namespace
+
+core::Result<AssembledObject> AssembleParts(const std::vector<PartSource>& parts,
+                                            const std::string& dest_path, int threads) {
+    std::vector<std::uint64_t> offsets(parts.size());
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        offsets[i] = total;
+        total += parts[i].size_bytes;
+    }
+    {
+        std::ofstream create(dest_path, std::ios::binary | std::ios::trunc);
+        if (!create.is_open()) {
+            return IoError("failed to open final temp file");
+        }
+    }
+    std::error_code ec;
+    std::filesystem::resize_file(dest_path, total, ec);
+    if (ec) {
+        std::filesystem::remove(dest_path, ec);
+        return IoError("failed to size final temp file");
+    }
+
+    // Parts have disjoint offsets, so workers write through their own handles without locking.
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stop{false};
+    std::mutex error_mutex;
+    std::optional<core::Error> error;
+    auto fail = [&](core::Error failure) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+            error = std::move(failure);
+        }
+        stop = true;
+    };
+    auto copy_parts = [&] {
+        std::fstream out(dest_path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!out.is_open()) {
+            return fail(IoError("failed to open final temp file"));
+        }
+        std::vector<char> buf(kCopyBufferBytes);
+        for (auto i = next++; i < parts.size() && !stop; i = next++) {
+            const auto& part = parts[i];
+            std::error_code size_ec;
+            const auto size = std::filesystem::file_size(part.path, size_ec);
+            if (size_ec || size != part.size_bytes) {
+                return fail(IoError("an uploaded part does not match its recorded size"));
+            }
+            std::ifstream in(part.path, std::ios::binary);
+            out.seekp(static_cast<std::streamoff>(offsets[i]));
+            if (!in.is_open() || !CopyBytes(in, out, part.size_bytes, buf)) {
+                return fail(IoError("failed to copy uploaded part"));
+            }
+        }
+        if (!out.flush()) {
+            fail(IoError("failed to write final temp file"));
+        }
+    };
+
+    const auto worker_count = std::min<std::size_t>(static_cast<std::size_t>(std::max(threads, 1)),
+                                                    std::max<std::size_t>(parts.size(), 1));
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(copy_parts);
+    }
+
+    // The etag covers the parts in order, so it is computed here from the part files while the
+    // workers copy; both read the same pages, which stay cached between the two passes.
+    core::Sha256Hasher sha256;
+    std::vector<char> buf(kCopyBufferBytes);
+    for (const auto& part : parts) {
+        if (stop) {
+            break;
+        }
+        std::ifstream in(part.path, std::ios::binary);
+        auto remaining = part.size_bytes;
+        while (in && remaining > 0) {
+            const auto chunk =
+                static_cast<std::streamsize>(std::min<std::uint64_t>(remaining, buf.size()));
+            in.read(buf.data(), chunk);
+            const auto bytes = in.gcount();
+            sha256.Update(buf.data(), static_cast<std::size_t>(bytes));
+            remaining -= static_cast<std::uint64_t>(bytes);
+        }
+        if (remaining > 0) {
+            fail(IoError("failed to read uploaded part"));
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::filesystem::remove(dest_path, ec);
+        return *error;
+    }
+    return AssembledObject{total, sha256.HexDigest()};
+}
+
+core::Result<void> WriteAt(const std::string& path, std::uint64_t offset, std::string_view data) {
+#ifdef _WIN32
+    // Each call has its own descriptor, so seeking then writing cannot race another writer's
+    // position.
+    const int fd = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd < 0) {
+        return IoError("failed to open upload file");
+    }
+    bool ok = ::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) >= 0;
+    while (ok && !data.empty()) {
+        const auto chunk = static_cast<unsigned int>(std::min<std::size_t>(data.size(), 1u << 30));
+        const int written = ::_write(fd, data.data(), chunk);
+        ok = written > 0;
+        if (ok) {
+            data.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }
+    ::_close(fd);
+#else
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        return IoError("failed to open upload file");
+    }
+    bool ok = true;
+    while (ok && !data.empty()) {
+        const auto written =
+            ::pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset));
+        ok = written > 0;
+        if (ok) {
+            data.remove_prefix(static_cast<std::size_t>(written));
+            offset += static_cast<std::uint64_t>(written);
+        }
+    }
+    ok = ::close(fd) == 0 && ok;
+#endif
+    if (!ok) {
+        return IoError("failed to write upload file");
+    }
+    return core::Ok();
+}
+
+}  // namespace nebulafs::storage
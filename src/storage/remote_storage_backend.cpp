@@ -1,16 +1,20 @@
 #include "nebulafs/storage/remote_storage_backend.h"
 
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <string_view>
 
-#include <Poco/DigestEngine.h>
-#include <Poco/SHA2Engine.h>
 #include <Poco/UUIDGenerator.h>
 
+#include "nebulafs/core/hashing.h"
 #include "nebulafs/core/logger.h"
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/distributed/blob_rpc.h"
 #include "nebulafs/distributed/http_client.h"
+#include "nebulafs/metadata/metadata_batch.h"
 #include "nebulafs/observability/metrics.h"
 
 namespace nebulafs::storage {
@@ -43,6 +47,94 @@ void BestEffortRollbackWrites(const core::DistributedConfig& distributed,
     }
 }
 
+// Removes `blob_ids` from one storage node in a single request.
+core::Result<void> SendBlobDeletes(const core::DistributedConfig& distributed,
+                                   const std::string& endpoint,
+                                   const std::vector<std::string>& blob_ids) {
+    const auto format = core::WireFormatFromName(distributed.rpc_format);
+    const std::string media_type(core::MediaTypeFor(format));
+    distributed::DeleteBlobsRequest request;
+    request.blob_ids.assign(blob_ids.begin(), blob_ids.end());
+    auto sent = distributed::SendHttpRequest("POST", BlobUrl(endpoint, "batch-delete"),
+                                             core::EncodeWire(format, request), media_type,
+                                             distributed.service_auth_token,
+                                             {{"Accept", media_type}});
+    if (!sent.ok()) {
+        return sent.error();
+    }
+    if (sent.value().status != 200) {
+        return core::Error{core::ErrorCode::kIoError, "storage node batch delete returned status " +
+                                                          std::to_string(sent.value().status)};
+    }
+    return core::Ok();
+}
+
+std::string CachePath(const std::string& temp_path) {
+    return (std::filesystem::path(temp_path) / "remote_cache" /
+            Poco::UUIDGenerator().createOne().toString())
+        .string();
+}
+
+// Appends bytes `first`..`last` of a blob to `out`, trying replicas in order. A node that
+// ignores the Range header answers 200 with the whole blob, which is sliced here instead.
+bool FetchBlobRange(const core::DistributedConfig& distributed,
+                    const std::vector<metadata::ReplicaTarget>& replicas,
+                    const std::string& blob_id, std::uint64_t first, std::uint64_t last,
+                    std::ostream& out) {
+    const auto length = last - first + 1;
+    bool first_attempt = true;
+    for (const auto& replica : replicas) {
+        auto get = distributed::SendHttpRequest(
+            "GET", BlobUrl(replica.endpoint, blob_id), "", "", distributed.service_auth_token,
+            {{"Range", "bytes=" + std::to_string(first) + "-" + std::to_string(last)}});
+        std::string_view body;
+        if (get.ok() && get.value().status == 206 && get.value().body.size() == length) {
+            body = get.value().body;
+        } else if (get.ok() && get.value().status == 200 && get.value().body.size() > last) {
+            body = std::string_view(get.value().body).substr(first, length);
+        } else {
+            if (first_attempt) {
+                nebulafs::observability::RecordGatewayReplicaFallback();
+                first_attempt = false;
+            }
+            continue;
+        }
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        return static_cast<bool>(out);
+    }
+    return false;
+}
+
+// Writes bytes `first`..`last` of a composite object to `out`, fetching from each segment
+// only the part of it inside the range.
+bool FetchSegments(const core::DistributedConfig& distributed,
+                   const std::vector<metadata::ManifestSegment>& segments, std::uint64_t first,
+                   std::uint64_t last, std::ostream& out) {
+    // Segments are in offset order; start at the last one beginning at or before `first`.
+    auto it = std::upper_bound(segments.begin(), segments.end(), first,
+                               [](std::uint64_t offset, const metadata::ManifestSegment& segment) {
+                                   return offset < segment.offset;
+                               });
+    if (it != segments.begin()) {
+        --it;
+    }
+    for (; it != segments.end() && it->offset <= last; ++it) {
+        if (it->size_bytes == 0) {
+            continue;
+        }
+        const auto segment_last = it->offset + it->size_bytes - 1;
+        if (segment_last < first) {
+            continue;
+        }
+        if (!FetchBlobRange(distributed, it->replicas, it->blob_id,
+                            std::max(first, it->offset) - it->offset,
+                            std::min(last, segment_last) - it->offset, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
 RemoteStorageBackend::RemoteStorageBackend(core::DistributedConfig distributed,
@@ -50,7 +142,12 @@ RemoteStorageBackend::RemoteStorageBackend(core::DistributedConfig distributed,
                                            std::string temp_path)
     : distributed_(std::move(distributed)),
       metadata_(std::move(metadata)),
-      temp_path_(std::move(temp_path)) {
+      temp_path_(std::move(temp_path)),
+      reclaimer_(std::make_unique<BlobReclaimer>(
+          [distributed = distributed_](const std::string& endpoint,
+                                       const std::vector<std::string>& blob_ids) {
+              return SendBlobDeletes(distributed, endpoint, blob_ids);
+          })) {
     std::filesystem::create_directories(std::filesystem::path(temp_path_) / "remote_cache");
     std::filesystem::create_directories(std::filesystem::path(temp_path_) / "remote_spool");
 }
@@ -68,7 +165,7 @@ core::Result<StoredObject> RemoteStorageBackend::WriteObject(const std::string&
     }
 
     std::array<char, 8192> buffer{};
-    Poco::SHA2Engine256 sha256;
+    core::Sha256Hasher sha256;
     std::uint64_t total = 0;
     while (data) {
         data.read(buffer.data(), buffer.size());
@@ -83,11 +180,11 @@ core::Result<StoredObject> RemoteStorageBackend::WriteObject(const std::string&
             std::filesystem::remove(spool_path, remove_ec);
             return core::Error{core::ErrorCode::kIoError, "failed to write spool file"};
         }
-        sha256.update(buffer.data(), static_cast<unsigned int>(bytes));
+        sha256.Update(buffer.data(), static_cast<std::size_t>(bytes));
         total += static_cast<std::uint64_t>(bytes);
     }
     spool.close();
-    const auto etag = Poco::DigestEngine::digestToHex(sha256.digest());
+    const auto etag = sha256.HexDigest();
 
     auto allocation = metadata_->AllocateWrite(bucket, object, distributed_.replication_factor,
                                                distributed_.service_auth_token);
@@ -147,6 +244,24 @@ core::Result<StoredObject> RemoteStorageBackend::ReadObject(const std::string& b
         nebulafs::observability::RecordGatewayMetadataRpcFailure();
         return plan.error();
     }
+    if (!plan.value().segments.empty()) {
+        // A composite object is stitched from its segments into one cache file.
+        const auto cache_path = CachePath(temp_path_);
+        std::ofstream out(cache_path, std::ios::binary | std::ios::trunc);
+        const auto size = plan.value().size_bytes;
+        if (!out.is_open() ||
+            (size > 0 && !FetchSegments(distributed_, plan.value().segments, 0, size - 1, out))) {
+            out.close();
+            std::error_code remove_ec;
+            std::filesystem::remove(cache_path, remove_ec);
+            return core::Error{core::ErrorCode::kNotFound, "object not found on storage nodes"};
+        }
+        StoredObject stored;
+        stored.path = cache_path;
+        stored.etag = plan.value().etag;
+        stored.size_bytes = size;
+        return stored;
+    }
 
     bool first_attempt = true;
     for (const auto& replica : plan.value().replicas) {
@@ -159,9 +274,7 @@ core::Result<StoredObject> RemoteStorageBackend::ReadObject(const std::string& b
             }
             continue;
         }
-        const auto cache_path = (std::filesystem::path(temp_path_) / "remote_cache" /
-                                 Poco::UUIDGenerator().createOne().toString())
-                                    .string();
+        const auto cache_path = CachePath(temp_path_);
         std::ofstream out(cache_path, std::ios::binary | std::ios::trunc);
         out.write(get.value().body.data(), static_cast<std::streamsize>(get.value().body.size()));
         out.close();
@@ -175,21 +288,178 @@ core::Result<StoredObject> RemoteStorageBackend::ReadObject(const std::string& b
     return core::Error{core::ErrorCode::kNotFound, "object not found on storage nodes"};
 }
 
-core::Result<void> RemoteStorageBackend::DeleteObject(const std::string& bucket,
-                                                      const std::string& object) {
+core::Result<StoredRange> RemoteStorageBackend::ReadObjectRange(const std::string& bucket,
+                                                                const std::string& object,
+                                                                std::uint64_t first,
+                                                                std::uint64_t last) const {
     auto plan = metadata_->ResolveRead(bucket, object);
     if (!plan.ok()) {
-        // Keep delete idempotent.
-        return core::Ok();
+        nebulafs::observability::RecordGatewayMetadataRpcFailure();
+        return plan.error();
     }
-    for (const auto& replica : plan.value().replicas) {
-        (void)distributed::SendHttpRequest("DELETE",
-                                           BlobUrl(replica.endpoint, plan.value().blob_id), "", "",
-                                           distributed_.service_auth_token, {});
+    StoredRange range;
+    range.object_size = plan.value().size_bytes;
+    range.etag = plan.value().etag;
+    if (first >= range.object_size) {
+        return range;
     }
+    range.first = first;
+    range.last = std::min(last, range.object_size - 1);
+
+    // Only the requested bytes cross the network, and the cache file holds just those.
+    const auto cache_path = CachePath(temp_path_);
+    std::ofstream out(cache_path, std::ios::binary | std::ios::trunc);
+    const bool fetched =
+        out.is_open() &&
+        (plan.value().segments.empty()
+             ? FetchBlobRange(distributed_, plan.value().replicas, plan.value().blob_id,
+                              range.first, range.last, out)
+             : FetchSegments(distributed_, plan.value().segments, range.first, range.last, out));
+    out.close();
+    if (!fetched) {
+        std::error_code remove_ec;
+        std::filesystem::remove(cache_path, remove_ec);
+        return core::Error{core::ErrorCode::kNotFound, "object not found on storage nodes"};
+    }
+    range.path = cache_path;
+    return range;
+}
+
+core::Result<void> RemoteStorageBackend::DeleteObject(const std::string& bucket,
+                                                      const std::string& object) {
+    // Keep delete idempotent.
+    (void)DeleteObjects(bucket, {object});
     return core::Ok();
 }
 
+core::Result<std::vector<bool>> RemoteStorageBackend::DeleteObjects(
+    const std::string& bucket, const std::vector<std::string>& objects) {
+    std::vector<bool> existed(objects.size(), false);
+    // Each batch drops its rows in one metadata transaction and counts the objects left on
+    // their blobs in the same step, so a copy committed concurrently either is counted or
+    // fails for want of a source. Blobs nothing names any more are left to the reclaimer.
+    for (std::size_t first = 0; first < objects.size(); first += metadata::kMaxBatchOps) {
+        const auto end = std::min(objects.size(), first + metadata::kMaxBatchOps);
+        std::vector<metadata::BatchOp> ops(end - first);
+        for (std::size_t i = first; i < end; ++i) {
+            auto& op = ops[i - first];
+            op.type = metadata::BatchOpType::kDeleteObject;
+            op.bucket = bucket;
+            op.object_name = objects[i];
+        }
+        auto removed = metadata_->ExecuteBatch(ops);
+        if (!removed.ok()) {
+            nebulafs::observability::RecordGatewayMetadataRpcFailure();
+            return removed.error();
+        }
+        for (std::size_t i = first; i < end; ++i) {
+            const auto& result = removed.value()[i - first];
+            existed[i] = result.removed;
+            if (result.removed && result.blob_references == 0) {
+                reclaimer_->Enqueue(result.read_plan);
+            }
+        }
+    }
+    return existed;
+}
+
+core::Result<StoredObject> RemoteStorageBackend::CopyObject(const std::string& source_bucket,
+                                                            const std::string& source_object,
+                                                            const std::string& bucket,
+                                                            const std::string& object) {
+    return TransferObject(source_bucket, source_object, bucket, object, false);
+}
+
+core::Result<StoredObject> RemoteStorageBackend::MoveObject(const std::string& source_bucket,
+                                                            const std::string& source_object,
+                                                            const std::string& bucket,
+                                                            const std::string& object) {
+    return TransferObject(source_bucket, source_object, bucket, object, true);
+}
+
+core::Result<StoredObject> RemoteStorageBackend::TransferObject(
+    const std::string& source_bucket, const std::string& source_object, const std::string& bucket,
+    const std::string& object, bool move) {
+    if (source_bucket == bucket && source_object == object) {
+        return core::Error{core::ErrorCode::kInvalidArgument, "source and destination are the same"};
+    }
+    // Blobs are immutable, so the copy is a new row naming the source's blobs; a move also
+    // drops the source row in the same batch, which leaves the blobs referenced.
+    std::vector<metadata::BatchOp> ops(1);
+    ops[0].type = metadata::BatchOpType::kCopyObject;
+    ops[0].bucket = bucket;
+    ops[0].object_name = object;
+    ops[0].source_bucket = source_bucket;
+    ops[0].source_object = source_object;
+    if (move) {
+        metadata::BatchOp remove;
+        remove.type = metadata::BatchOpType::kDeleteObject;
+        remove.bucket = source_bucket;
+        remove.object_name = source_object;
+        ops.push_back(std::move(remove));
+    }
+    auto copied = metadata_->ExecuteBatch(ops);
+    if (copied.ok()) {
+        const auto& plan = copied.value().front().read_plan;
+        StoredObject stored;
+        stored.etag = plan.etag;
+        stored.size_bytes = plan.size_bytes;
+        return stored;
+    }
+    // Buckets on different metadata shards cannot share one transaction; the bytes are then
+    // written again under the destination, as a client copy would have.
+    if (copied.error().code != core::ErrorCode::kCrossShard) {
+        nebulafs::observability::RecordGatewayMetadataRpcFailure();
+        return copied.error();
+    }
+    auto source = ReadObject(source_bucket, source_object);
+    if (!source.ok()) {
+        return source.error();
+    }
+    std::ifstream in(source.value().path, std::ios::binary);
+    auto stored = WriteObject(bucket, object, in);
+    in.close();
+    std::error_code remove_ec;
+    std::filesystem::remove(source.value().path, remove_ec);
+    if (stored.ok() && move) {
+        // The two rows live on different shards, so the copy is undone when the source cannot
+        // be removed: a failed move leaves the source alone rather than two objects.
+        auto removed = DeleteObject(source_bucket, source_object);
+        if (!removed.ok()) {
+            auto undone = DeleteObject(bucket, object);
+            if (!undone.ok()) {
+                return core::Error{removed.error().code,
+                                   removed.error().message +
+                                       "; removing the copy failed: " + undone.error().message};
+            }
+            return removed.error();
+        }
+    }
+    return stored;
+}
+
+// Storage nodes keep blobs by id rather than by content, so there is never a stored body to
+// link and nothing for the gateway to reclaim.
+core::Result<StoredObject> RemoteStorageBackend::LinkObject(const std::string&,
+                                                            const std::string&,
+                                                            const std::string&) {
+    return core::Error{core::ErrorCode::kNotFound, "content not stored"};
+}
+
+core::Result<std::uint64_t> RemoteStorageBackend::ReclaimContent() { return 0; }
+
+// Distributed objects are written to storage nodes as they stream in; there is no local file
+// to move into place and no gateway-side layout to migrate.
+core::Result<StoredObject> RemoteStorageBackend::PlaceObject(const std::string&,
+                                                             const std::string&,
+                                                             const std::string&,
+                                                             const std::string&) {
+    return core::Error{core::ErrorCode::kInvalidArgument,
+                       "remote storage does not place local files"};
+}
+
+core::Result<std::uint64_t> RemoteStorageBackend::MigrateObjectLayout(std::size_t) { return 0; }
+
 core::Result<void> RemoteStorageBackend::EnsureBucket(const std::string&) { return core::Ok(); }
 
 }  // namespace nebulafs::storage
@@ -0,0 +1,159 @@
+#include "nebulafs/storage/upload_pipeline.h"
+
+#include <cerrno>
+#include <string_view>
+#include <utility>
+
+#include <boost/asio/post.hpp>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/observability/metrics.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace nebulafs::storage {
+
+UploadPipeline::UploadPipeline(boost::asio::thread_pool& pool,
+                               boost::asio::any_io_executor owner, int fd,
+                               std::optional<core::ObjectHasher> hasher,
+                               std::optional<std::uint32_t> crc32c, std::size_t depth)
+    : owner_(std::move(owner)),
+      writer_strand_(boost::asio::make_strand(pool.get_executor())),
+      hasher_strand_(boost::asio::make_strand(pool.get_executor())),
+      fd_(fd),
+      depth_(depth == 0 ? 1 : depth),
+      hashing_(hasher.has_value() || crc32c.has_value()),
+      hasher_(std::move(hasher)),
+      crc32c_(crc32c) {}
+
+std::shared_ptr<UploadChunk> UploadPipeline::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_.empty()) {
+        auto chunk = std::move(free_.back());
+        free_.pop_back();
+        ++in_flight_;
+        return chunk;
+    }
+    if (allocated_ == depth_) {
+        return nullptr;
+    }
+    // Chunks are allocated on first use, so a small body never costs `depth` buffers.
+    ++allocated_;
+    ++in_flight_;
+    auto chunk = std::make_shared<UploadChunk>();
+    chunk->data.resize(kChunkBytes);
+    return chunk;
+}
+
+void UploadPipeline::Submit(std::shared_ptr<UploadChunk> chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk->stages_left = chunk->size == 0 ? 0 : (hashing_ ? 2 : 1);
+    }
+    if (chunk->size == 0) {
+        return Release(std::move(chunk));
+    }
+    observability::RecordGatewayUploadWriteQueue(1);
+    boost::asio::post(writer_strand_, [self = shared_from_this(), chunk] {
+        self->Write(chunk);
+        observability::RecordGatewayUploadWriteQueue(-1);
+        self->Release(chunk);
+    });
+    if (hashing_) {
+        observability::RecordGatewayUploadHashQueue(1);
+        boost::asio::post(hasher_strand_, [self = shared_from_this(), chunk] {
+            self->Hash(chunk);
+            observability::RecordGatewayUploadHashQueue(-1);
+            self->Release(chunk);
+        });
+    }
+}
+
+void UploadPipeline::WaitForChunk(std::function<void()> resume) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!free_.empty() || allocated_ < depth_) {
+        lock.unlock();
+        boost::asio::post(owner_, std::move(resume));
+        return;
+    }
+    waiter_ = std::move(resume);
+    waiting_for_drain_ = false;
+}
+
+void UploadPipeline::WaitForDrain(std::function<void()> done) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (in_flight_ == 0) {
+        lock.unlock();
+        boost::asio::post(owner_, std::move(done));
+        return;
+    }
+    waiter_ = std::move(done);
+    waiting_for_drain_ = true;
+}
+
+core::Result<void> UploadPipeline::status() const {
+    if (write_error_) {
+        return core::Error{core::ErrorCode::kIoError, *write_error_};
+    }
+    return core::Ok();
+}
+
+void UploadPipeline::Write(const std::shared_ptr<UploadChunk>& chunk) {
+    // After a failed write the rest of the body is only drained; the upload is failed as a
+    // whole once the connection sees the error.
+    if (write_error_) {
+        return;
+    }
+    std::string_view pending(chunk->data.data(), chunk->size);
+    while (!pending.empty()) {
+#ifdef _WIN32
+        const auto written =
+            ::_write(fd_, pending.data(), static_cast<unsigned int>(pending.size()));
+#else
+        const auto written = ::write(fd_, pending.data(), pending.size());
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            write_error_ = "failed to write temp file";
+            return;
+        }
+        pending.remove_prefix(static_cast<std::size_t>(written));
+    }
+}
+
+void UploadPipeline::Hash(const std::shared_ptr<UploadChunk>& chunk) {
+    if (hasher_) {
+        hasher_->Update(chunk->data.data(), chunk->size);
+    }
+    if (crc32c_) {
+        *crc32c_ = core::Crc32c(std::string_view(chunk->data.data(), chunk->size), *crc32c_);
+    }
+}
+
+void UploadPipeline::Release(std::shared_ptr<UploadChunk> chunk) {
+    std::function<void()> wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (chunk->stages_left > 0 && --chunk->stages_left > 0) {
+            return;
+        }
+        chunk->size = 0;
+        free_.push_back(std::move(chunk));
+        --in_flight_;
+        if (waiter_ && (!waiting_for_drain_ || in_flight_ == 0)) {
+            wake = std::move(waiter_);
+            waiter_ = nullptr;
+        }
+    }
+    if (wake) {
+        boost::asio::post(owner_, std::move(wake));
+    }
+}
+
+}  // namespace nebulafs::storage
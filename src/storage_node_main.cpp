@@ -1,17 +1,18 @@
+#include <algorithm>
 #include <array>
+#include <charconv>
 #include <chrono>
-#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
-#include <Poco/DigestEngine.h>
-#include <Poco/JSON/Array.h>
 #include <Poco/JSON/Object.h>
-#include <Poco/JSON/Parser.h>
 #include <Poco/Net/HTTPServer.h>
 #include <Poco/Net/HTTPServerParams.h>
 #include <Poco/Net/HTTPRequest.h>
@@ -21,14 +22,14 @@
 #include <Poco/Net/HTTPServerResponse.h>
 #include <Poco/Net/HTTPResponse.h>
 #include <Poco/Net/ServerSocket.h>
-#include <Poco/SHA2Engine.h>
 #include <Poco/Thread.h>
 #include <Poco/URI.h>
-#include <Poco/UUIDGenerator.h>
 
 #include "nebulafs/core/config.h"
 #include "nebulafs/core/ids.h"
 #include "nebulafs/core/logger.h"
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/distributed/blob_rpc.h"
 #include "nebulafs/distributed/placement_token.h"
 #include "nebulafs/observability/metrics.h"
 
@@ -60,27 +61,35 @@ bool HasValidPlacementToken(const Poco::Net::HTTPServerRequest& req,
                                                          "write", service_token);
 }
 
-std::optional<std::vector<std::string>> ParseComposeSources(std::istream& stream) {
-    try {
-        Poco::JSON::Parser parser;
-        auto root = parser.parse(stream).extract<Poco::JSON::Object::Ptr>();
-        auto source_blob_ids = root->getArray("source_blob_ids");
-        if (!source_blob_ids || source_blob_ids->empty()) {
-            return std::nullopt;
-        }
-        std::vector<std::string> blob_ids;
-        blob_ids.reserve(source_blob_ids->size());
-        for (size_t i = 0; i < source_blob_ids->size(); ++i) {
-            const auto blob_id = source_blob_ids->getElement<std::string>(i);
-            if (blob_id.empty()) {
-                return std::nullopt;
-            }
-            blob_ids.push_back(blob_id);
-        }
-        return blob_ids;
-    } catch (const std::exception&) {
+struct BlobRange {
+    std::uint64_t first{0};
+    std::uint64_t last{0};
+};
+
+// Gateways ask for one `bytes=first-last` window of a blob; anything else, or a window not
+// inside the blob, is served as the whole blob.
+std::optional<BlobRange> ParseBlobRange(const std::string& header, std::uint64_t size) {
+    constexpr std::string_view kPrefix = "bytes=";
+    if (header.compare(0, kPrefix.size(), kPrefix) != 0) {
+        return std::nullopt;
+    }
+    const auto dash = header.find('-', kPrefix.size());
+    if (dash == std::string::npos) {
+        return std::nullopt;
+    }
+    BlobRange range;
+    const auto* begin = header.data();
+    const auto* end = begin + header.size();
+    auto parsed = std::from_chars(begin + kPrefix.size(), begin + dash, range.first);
+    if (parsed.ec != std::errc() || parsed.ptr != begin + dash) {
+        return std::nullopt;
+    }
+    parsed = std::from_chars(begin + dash + 1, end, range.last);
+    if (parsed.ec != std::errc() || parsed.ptr != end || range.first > range.last ||
+        range.last >= size) {
         return std::nullopt;
     }
+    return range;
 }
 
 void WriteJson(Poco::Net::HTTPServerResponse& res, Poco::JSON::Object::Ptr obj,
@@ -108,6 +117,18 @@ void WriteError(Poco::Net::HTTPServerResponse& res, const std::string& request_i
     WriteJson(res, root, status, request_id);
 }
 
+// Replies to internal RPCs go back in the format the gateway accepts.
+template <typename Msg>
+void WriteWire(Poco::Net::HTTPServerRequest& req, Poco::Net::HTTPServerResponse& res,
+               const std::string& request_id, const Msg& msg) {
+    const auto reply_format = nebulafs::core::FormatFromMediaType(req.get("Accept", ""));
+    const auto body = nebulafs::core::EncodeWire(reply_format, msg);
+    res.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+    res.setContentType(std::string(nebulafs::core::MediaTypeFor(reply_format)));
+    res.set("X-Request-Id", request_id);
+    res.sendBuffer(body.data(), body.size());
+}
+
 long long ElapsedMs(const std::chrono::steady_clock::time_point& started_at) {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
                std::chrono::steady_clock::now() - started_at)
@@ -149,110 +170,12 @@ public:
             return WriteError(res, request_id, "NOT_FOUND", "route not found",
                               Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
         }
-        std::string blob_id = path.substr(prefix.size());
-        bool is_compose_route = false;
-        constexpr const char* kComposeSuffix = "/compose";
-        if (blob_id.size() > std::strlen(kComposeSuffix) &&
-            blob_id.compare(blob_id.size() - std::strlen(kComposeSuffix),
-                            std::strlen(kComposeSuffix), kComposeSuffix) == 0) {
-            is_compose_route = true;
-            blob_id = blob_id.substr(0, blob_id.size() - std::strlen(kComposeSuffix));
-        }
-        if (blob_id.empty()) {
-            return WriteError(res, request_id, "NOT_FOUND", "route not found",
-                              Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+        if (path.compare(prefix.size(), std::string::npos, "batch-delete") == 0) {
+            return HandleBatchDelete(req, res, request_id);
         }
+        const std::string blob_id = path.substr(prefix.size());
         const auto file_path = BlobPath(root_path_, blob_id);
 
-        if (is_compose_route) {
-            if (req.getMethod() != Poco::Net::HTTPRequest::HTTP_POST) {
-                return WriteError(res, request_id, "METHOD_NOT_ALLOWED", "method not allowed",
-                                  Poco::Net::HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
-            }
-
-            const auto started_at = std::chrono::steady_clock::now();
-            if (!HasValidPlacementToken(req, service_token_, blob_id)) {
-                nebulafs::observability::RecordStorageNodeCompose(false, ElapsedMs(started_at));
-                return WriteError(res, request_id, "UNAUTHORIZED", "invalid placement token",
-                                  Poco::Net::HTTPResponse::HTTP_UNAUTHORIZED);
-            }
-
-            auto source_blob_ids = ParseComposeSources(req.stream());
-            if (!source_blob_ids.has_value()) {
-                nebulafs::observability::RecordStorageNodeCompose(false, ElapsedMs(started_at));
-                return WriteError(res, request_id, "INVALID_REQUEST",
-                                  "source_blob_ids must be a non-empty array",
-                                  Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-            }
-
-            const auto temp_path =
-                BlobPath(root_path_, Poco::UUIDGenerator().createOne().toString() + ".compose.tmp");
-            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
-            if (!out.is_open()) {
-                nebulafs::observability::RecordStorageNodeCompose(false, ElapsedMs(started_at));
-                return WriteError(res, request_id, "INTERNAL_ERROR",
-                                  "failed to open compose temp file",
-                                  Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-            }
-
-            Poco::SHA2Engine256 sha256;
-            std::array<char, 8192> buffer{};
-            std::uint64_t total_bytes = 0;
-            for (const auto& source_blob_id : source_blob_ids.value()) {
-                const auto source_path = BlobPath(root_path_, source_blob_id);
-                std::ifstream in(source_path, std::ios::binary);
-                if (!in.is_open()) {
-                    out.close();
-                    std::error_code remove_ec;
-                    std::filesystem::remove(temp_path, remove_ec);
-                    nebulafs::observability::RecordStorageNodeCompose(false, ElapsedMs(started_at));
-                    return WriteError(res, request_id, "NOT_FOUND",
-                                      "source blob not found: " + source_blob_id,
-                                      Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
-                }
-                while (in) {
-                    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-                    const auto bytes = in.gcount();
-                    if (bytes <= 0) {
-                        break;
-                    }
-                    out.write(buffer.data(), bytes);
-                    if (!out) {
-                        out.close();
-                        std::error_code remove_ec;
-                        std::filesystem::remove(temp_path, remove_ec);
-                        nebulafs::observability::RecordStorageNodeCompose(false,
-                                                                          ElapsedMs(started_at));
-                        return WriteError(res, request_id, "INTERNAL_ERROR",
-                                          "failed to write compose output",
-                                          Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-                    }
-                    sha256.update(buffer.data(), static_cast<unsigned int>(bytes));
-                    total_bytes += static_cast<std::uint64_t>(bytes);
-                }
-            }
-
-            out.flush();
-            out.close();
-
-            std::error_code rename_ec;
-            std::filesystem::rename(temp_path, file_path, rename_ec);
-            if (rename_ec) {
-                std::error_code remove_ec;
-                std::filesystem::remove(temp_path, remove_ec);
-                nebulafs::observability::RecordStorageNodeCompose(false, ElapsedMs(started_at));
-                return WriteError(res, request_id, "INTERNAL_ERROR", rename_ec.message(),
-                                  Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
-            }
-
-            nebulafs::observability::RecordStorageNodeCompose(true, ElapsedMs(started_at));
-            Poco::JSON::Object::Ptr root = new Poco::JSON::Object();
-            root->set("blob_id", blob_id);
-            root->set("size_bytes", static_cast<Poco::UInt64>(total_bytes));
-            root->set("etag", Poco::DigestEngine::digestToHex(sha256.digest()));
-            return WriteJson(res, root, Poco::Net::HTTPResponse::HTTP_OK, request_id);
-        }
-
         if (req.getMethod() == Poco::Net::HTTPRequest::HTTP_PUT) {
             const auto started_at = std::chrono::steady_clock::now();
             if (!HasValidPlacementToken(req, service_token_, blob_id)) {
@@ -283,13 +206,44 @@ public:
                 return WriteError(res, request_id, "NOT_FOUND", "blob not found",
                                   Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
             }
-            res.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
             res.setContentType("application/octet-stream");
             res.set("X-Request-Id", request_id);
             std::ifstream in(file_path, std::ios::binary);
+            std::error_code size_ec;
+            const auto size = std::filesystem::file_size(file_path, size_ec);
+            const auto range = size_ec || !req.has("Range")
+                                   ? std::nullopt
+                                   : ParseBlobRange(req.get("Range"), size);
+            if (!range) {
+                res.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+                std::ostream& out = res.send();
+                out << in.rdbuf();
+                nebulafs::observability::RecordStorageNodeRead(true, ElapsedMs(started_at));
+                return;
+            }
+            // Range reads serve one segment of a composite object without sending the rest.
+            const auto length = range->last - range->first + 1;
+            res.setStatus(Poco::Net::HTTPResponse::HTTP_PARTIAL_CONTENT);
+            res.set("Content-Range", "bytes " + std::to_string(range->first) + "-" +
+                                         std::to_string(range->last) + "/" +
+                                         std::to_string(size));
+            res.setContentLength64(static_cast<Poco::Int64>(length));
+            in.seekg(static_cast<std::streamoff>(range->first));
             std::ostream& out = res.send();
-            out << in.rdbuf();
-            nebulafs::observability::RecordStorageNodeRead(true, ElapsedMs(started_at));
+            std::array<char, 8192> buffer{};
+            auto remaining = length;
+            while (remaining > 0 && in) {
+                in.read(buffer.data(), static_cast<std::streamsize>(
+                                           std::min<std::uint64_t>(remaining, buffer.size())));
+                const auto bytes = in.gcount();
+                if (bytes <= 0) {
+                    break;
+                }
+                out.write(buffer.data(), bytes);
+                remaining -= static_cast<std::uint64_t>(bytes);
+            }
+            nebulafs::observability::RecordStorageNodeRead(remaining == 0,
+                                                           ElapsedMs(started_at));
             return;
         }
 
@@ -314,6 +268,47 @@ public:
     }
 
 private:
+    // A gateway reclaiming deleted objects sends one request per node for many blobs rather
+    // than one per blob and replica. Removal is idempotent, so after a failure the gateway
+    // resends the whole batch.
+    void HandleBatchDelete(Poco::Net::HTTPServerRequest& req, Poco::Net::HTTPServerResponse& res,
+                           const std::string& request_id) {
+        if (req.getMethod() != Poco::Net::HTTPRequest::HTTP_POST) {
+            return WriteError(res, request_id, "METHOD_NOT_ALLOWED", "method not allowed",
+                              Poco::Net::HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+        }
+        const std::string body(std::istreambuf_iterator<char>(req.stream()),
+                               std::istreambuf_iterator<char>());
+        nebulafs::core::WireDecoder decoder(
+            nebulafs::core::FormatFromMediaType(req.getContentType()));
+        auto request = decoder.Decode<nebulafs::distributed::DeleteBlobsRequest>(body);
+        if (!request.ok()) {
+            return WriteError(res, request_id, "INVALID_REQUEST", "blob_ids must be an array",
+                              Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+        }
+        nebulafs::distributed::DeleteBlobsResponse reply;
+        bool failed = false;
+        for (const auto blob_id : request.value().blob_ids) {
+            const auto started_at = std::chrono::steady_clock::now();
+            // Ids name files directly under blobs/; nothing else may be reached through them.
+            if (blob_id.empty() || blob_id == ".." || blob_id.find('/') != std::string_view::npos) {
+                nebulafs::observability::RecordStorageNodeDelete(false, ElapsedMs(started_at));
+                continue;
+            }
+            std::error_code ec;
+            if (std::filesystem::remove(BlobPath(root_path_, std::string(blob_id)), ec)) {
+                ++reply.deleted;
+            }
+            failed = failed || static_cast<bool>(ec);
+            nebulafs::observability::RecordStorageNodeDelete(!ec, ElapsedMs(started_at));
+        }
+        if (failed) {
+            return WriteError(res, request_id, "INTERNAL_ERROR", "failed to delete blobs",
+                              Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+        }
+        return WriteWire(req, res, request_id, reply);
+    }
+
     std::string root_path_;
     std::string service_token_;
 };
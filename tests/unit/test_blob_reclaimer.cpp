@@ -0,0 +1,100 @@
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "nebulafs/storage/blob_reclaimer.h"
+
+namespace {
+
+using nebulafs::metadata::ResolveReadPlan;
+using nebulafs::storage::BlobReclaimer;
+
+// Records what each node was sent, failing the first `failures` requests to `failing`.
+struct FakeNodes {
+    std::mutex mutex;
+    std::map<std::string, std::vector<std::vector<std::string>>> batches;
+    std::string failing;
+    int failures{0};
+
+    BlobReclaimer::Sender Sender() {
+        return [this](const std::string& endpoint, const std::vector<std::string>& blob_ids)
+                   -> nebulafs::core::Result<void> {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (endpoint == failing && failures > 0) {
+                --failures;
+                return nebulafs::core::Error{nebulafs::core::ErrorCode::kIoError, "node down"};
+            }
+            batches[endpoint].push_back(blob_ids);
+            return nebulafs::core::Ok();
+        };
+    }
+
+    std::size_t BlobCount(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t count = 0;
+        for (const auto& batch : batches[endpoint]) {
+            count += batch.size();
+        }
+        return count;
+    }
+};
+
+ResolveReadPlan PlanOn(const std::string& blob_id, const std::vector<std::string>& endpoints) {
+    ResolveReadPlan plan;
+    plan.blob_id = blob_id;
+    for (std::size_t i = 0; i < endpoints.size(); ++i) {
+        plan.replicas.push_back({static_cast<int>(i + 1), static_cast<int>(i), endpoints[i]});
+    }
+    return plan;
+}
+
+}  // namespace
+
+TEST(BlobReclaimer, BatchesReplicasPerNode) {
+    FakeNodes nodes;
+    BlobReclaimer reclaimer(nodes.Sender(), 4);
+    for (int i = 0; i < 10; ++i) {
+        reclaimer.Enqueue(PlanOn("blob-" + std::to_string(i), {"http://a", "http://b"}));
+    }
+    // A composite object's segments are reclaimed with it.
+    ResolveReadPlan composite;
+    composite.segments = {{"part-1", 0, 5, "p1", {{1, 0, "http://a"}}},
+                          {"part-2", 5, 5, "p2", {{3, 0, "http://c"}}}};
+    reclaimer.Enqueue(composite);
+    reclaimer.Flush();
+
+    EXPECT_EQ(nodes.BlobCount("http://a"), 11u);
+    EXPECT_EQ(nodes.BlobCount("http://b"), 10u);
+    EXPECT_EQ(nodes.BlobCount("http://c"), 1u);
+    std::lock_guard<std::mutex> lock(nodes.mutex);
+    for (const auto& [endpoint, batches] : nodes.batches) {
+        for (const auto& batch : batches) {
+            EXPECT_LE(batch.size(), 4u) << endpoint;
+        }
+    }
+}
+
+TEST(BlobReclaimer, RetriesAFailingNodeAndThenGivesUp) {
+    FakeNodes nodes;
+    nodes.failing = "http://b";
+    nodes.failures = 2;
+    {
+        BlobReclaimer reclaimer(nodes.Sender(), 100, std::chrono::milliseconds(1));
+        reclaimer.Enqueue(PlanOn("blob-1", {"http://a", "http://b"}));
+        reclaimer.Flush();
+        EXPECT_EQ(nodes.BlobCount("http://a"), 1u);
+        EXPECT_EQ(nodes.BlobCount("http://b"), 1u);
+
+        // A node that never answers costs `kMaxAttempts` sends, then the blob is dropped.
+        nodes.failures = BlobReclaimer::kMaxAttempts + 1;
+        reclaimer.Enqueue(PlanOn("blob-2", {"http://b"}));
+        reclaimer.Flush();
+        EXPECT_EQ(nodes.BlobCount("http://b"), 1u);
+        std::lock_guard<std::mutex> lock(nodes.mutex);
+        EXPECT_EQ(nodes.failures, 1);
+    }
+}
@@ -0,0 +1,212 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/metadata/caching_metadata_store.h"
+#include "nebulafs/metadata/memory_metadata_store.h"
+
+namespace {
+
+using nebulafs::metadata::CachingMetadataStore;
+using nebulafs::metadata::MetadataCacheOptions;
+
+// Counts the lookups that reach the backing store; read-plan lookups can be held at a gate.
+class CountingStore : public nebulafs::metadata::MemoryMetadataStore {
+public:
+    using MemoryMetadataStore::MemoryMetadataStore;
+
+    nebulafs::core::Result<nebulafs::metadata::Bucket> GetBucket(
+        const std::string& name) override {
+        ++bucket_lookups;
+        return MemoryMetadataStore::GetBucket(name);
+    }
+
+    nebulafs::core::Result<nebulafs::metadata::ResolveReadPlan> ResolveRead(
+        const std::string& bucket, const std::string& object_name) override {
+        ++read_lookups;
+        if (gate.valid()) {
+            gate.wait();
+        }
+        auto plan = MemoryMetadataStore::ResolveRead(bucket, object_name);
+        for (int i = 0; plan.ok() && i < manifest_segments; ++i) {
+            plan.value().segments.push_back(
+                {"part-" + std::to_string(i), 0, 1, "etag", {{1, 0, "http://node-a"}}});
+        }
+        return plan;
+    }
+
+    std::atomic<int> bucket_lookups{0};
+    std::atomic<int> read_lookups{0};
+    // Segments appended to every read plan, standing in for a composite object's manifest.
+    int manifest_segments{0};
+    std::shared_future<void> gate;
+};
+
+class CachingMetadataStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("nebulafs_cache_" + Poco::UUIDGenerator().createOne().toString());
+        inner_ = std::make_shared<CountingStore>(dir_.string());
+        ASSERT_TRUE(inner_->ConfigureStorageNodes({"http://node-a"}).ok());
+    }
+
+    void TearDown() override {
+        inner_.reset();
+        std::filesystem::remove_all(dir_);
+    }
+
+    void Commit(CachingMetadataStore& cache, const std::string& object, const std::string& blob) {
+        ASSERT_TRUE(cache.CommitWrite("alpha", object, blob, 7, "etag-" + blob,
+                                      {{1, 0, "http://node-a"}})
+                        .ok());
+    }
+
+    std::filesystem::path dir_;
+    std::shared_ptr<CountingStore> inner_;
+};
+
+}  // namespace
+
+TEST_F(CachingMetadataStoreTest, CachesHitsAndMissesUntilLocalWrites) {
+    CachingMetadataStore cache(inner_, MetadataCacheOptions{});
+
+    EXPECT_EQ(cache.GetBucket("alpha").error().code, nebulafs::core::ErrorCode::kNotFound);
+    EXPECT_EQ(cache.GetBucket("alpha").error().code, nebulafs::core::ErrorCode::kNotFound);
+    EXPECT_EQ(inner_->bucket_lookups, 1);
+
+    // Creating the bucket drops the negative entry.
+    ASSERT_TRUE(cache.CreateBucket("alpha").ok());
+    ASSERT_TRUE(cache.GetBucket("alpha").ok());
+    ASSERT_TRUE(cache.GetBucket("alpha").ok());
+    EXPECT_EQ(inner_->bucket_lookups, 2);
+
+    EXPECT_FALSE(cache.ResolveRead("alpha", "a.bin").ok());
+    EXPECT_FALSE(cache.ResolveRead("alpha", "a.bin").ok());
+    EXPECT_EQ(inner_->read_lookups, 1);
+
+    Commit(cache, "a.bin", "blob-1");
+    auto plan = cache.ResolveRead("alpha", "a.bin");
+    ASSERT_TRUE(plan.ok());
+    EXPECT_EQ(plan.value().blob_id, "blob-1");
+
+    // An overwrite must not serve the previous blob.
+    Commit(cache, "a.bin", "blob-2");
+    plan = cache.ResolveRead("alpha", "a.bin");
+    ASSERT_TRUE(plan.ok());
+    EXPECT_EQ(plan.value().blob_id, "blob-2");
+    ASSERT_TRUE(cache.ResolveRead("alpha", "a.bin").ok());
+    EXPECT_EQ(inner_->read_lookups, 3);
+
+    ASSERT_TRUE(cache.DeleteObject("alpha", "a.bin").ok());
+    EXPECT_EQ(cache.ResolveRead("alpha", "a.bin").error().code,
+              nebulafs::core::ErrorCode::kNotFound);
+}
+
+TEST_F(CachingMetadataStoreTest, ExpiredEntriesAreLookedUpAgain) {
+    MetadataCacheOptions options;
+    options.bucket_ttl = std::chrono::milliseconds(20);
+    options.negative_ttl = std::chrono::milliseconds(0);
+    CachingMetadataStore cache(inner_, options);
+
+    EXPECT_FALSE(cache.GetBucket("alpha").ok());
+    EXPECT_FALSE(cache.GetBucket("alpha").ok());
+    EXPECT_EQ(inner_->bucket_lookups, 2);
+
+    ASSERT_TRUE(inner_->CreateBucket("alpha").ok());
+    ASSERT_TRUE(cache.GetBucket("alpha").ok());
+    ASSERT_TRUE(cache.GetBucket("alpha").ok());
+    EXPECT_EQ(inner_->bucket_lookups, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    ASSERT_TRUE(cache.GetBucket("alpha").ok());
+    EXPECT_EQ(inner_->bucket_lookups, 4);
+}
+
+TEST_F(CachingMetadataStoreTest, CoalescesConcurrentLookups) {
+    CachingMetadataStore cache(inner_, MetadataCacheOptions{});
+    ASSERT_TRUE(cache.CreateBucket("alpha").ok());
+    Commit(cache, "a.bin", "blob-1");
+
+    std::promise<void> release;
+    inner_->gate = release.get_future().share();
+    std::vector<std::future<bool>> readers;
+    for (int i = 0; i < 8; ++i) {
+        readers.push_back(std::async(std::launch::async, [&] {
+            auto plan = cache.ResolveRead("alpha", "a.bin");
+            return plan.ok() && plan.value().blob_id == "blob-1";
+        }));
+    }
+    while (inner_->read_lookups == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Give the other readers time to join the lookup in flight.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release.set_value();
+    for (auto& reader : readers) {
+        EXPECT_TRUE(reader.get());
+    }
+    EXPECT_EQ(inner_->read_lookups, 1);
+}
+
+TEST_F(CachingMetadataStoreTest, WriteDuringLookupIsNotCached) {
+    CachingMetadataStore cache(inner_, MetadataCacheOptions{});
+    ASSERT_TRUE(cache.CreateBucket("alpha").ok());
+    Commit(cache, "a.bin", "blob-1");
+
+    std::promise<void> release;
+    inner_->gate = release.get_future().share();
+    auto stale =
+        std::async(std::launch::async, [&] { return cache.ResolveRead("alpha", "a.bin"); });
+    while (inner_->read_lookups == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Commit(cache, "a.bin", "blob-2");
+    release.set_value();
+    ASSERT_TRUE(stale.get().ok());
+
+    auto plan = cache.ResolveRead("alpha", "a.bin");
+    ASSERT_TRUE(plan.ok());
+    EXPECT_EQ(plan.value().blob_id, "blob-2");
+    EXPECT_EQ(inner_->read_lookups, 2);
+}
+
+TEST_F(CachingMetadataStoreTest, EvictsLeastRecentlyUsedWithinBudget) {
+    MetadataCacheOptions options;
+    options.max_bytes = 4096;
+    CachingMetadataStore cache(inner_, options);
+
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_FALSE(cache.GetBucket("bucket-" + std::to_string(i)).ok());
+        EXPECT_LE(cache.cached_bytes(), options.max_bytes);
+    }
+    EXPECT_GT(cache.cached_bytes(), 0u);
+    const int lookups = inner_->bucket_lookups;
+    // The newest entry survived; the oldest was evicted.
+    EXPECT_FALSE(cache.GetBucket("bucket-199").ok());
+    EXPECT_EQ(inner_->bucket_lookups, lookups);
+    EXPECT_FALSE(cache.GetBucket("bucket-0").ok());
+    EXPECT_EQ(inner_->bucket_lookups, lookups + 1);
+}
+
+TEST_F(CachingMetadataStoreTest, ChargesManifestSegmentsAgainstTheBudget) {
+    MetadataCacheOptions options;
+    options.max_bytes = 64 * 1024;
+    CachingMetadataStore cache(inner_, options);
+    ASSERT_TRUE(cache.CreateBucket("alpha").ok());
+    Commit(cache, "big.bin", "blob-1");
+    inner_->manifest_segments = 10000;
+
+    ASSERT_TRUE(cache.ResolveRead("alpha", "big.bin").ok());
+    ASSERT_TRUE(cache.ResolveRead("alpha", "big.bin").ok());
+    // A plan larger than the whole budget is never cached.
+    EXPECT_EQ(inner_->read_lookups, 2);
+    EXPECT_LE(cache.cached_bytes(), options.max_bytes);
+}
@@ -0,0 +1,147 @@
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/metadata/caching_metadata_store.h"
+#include "nebulafs/metadata/change_feed.h"
+#include "nebulafs/metadata/change_feed_metadata_store.h"
+#include "nebulafs/metadata/change_feed_watcher.h"
+#include "nebulafs/metadata/memory_metadata_store.h"
+
+namespace {
+
+using nebulafs::metadata::ChangeFeed;
+using nebulafs::metadata::ChangeKind;
+
+class ChangeFeedStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("nebulafs_feed_" + Poco::UUIDGenerator().createOne().toString());
+        inner_ = std::make_shared<nebulafs::metadata::MemoryMetadataStore>(dir_.string());
+        ASSERT_TRUE(inner_->ConfigureStorageNodes({"http://node-a"}).ok());
+        feed_ = std::make_shared<ChangeFeed>();
+    }
+
+    void TearDown() override {
+        inner_.reset();
+        std::filesystem::remove_all(dir_);
+    }
+
+    std::filesystem::path dir_;
+    std::shared_ptr<nebulafs::metadata::MemoryMetadataStore> inner_;
+    std::shared_ptr<ChangeFeed> feed_;
+};
+
+}  // namespace
+
+TEST(ChangeFeed, ResumesFromCursorAndResetsUnknownOrEvictedOnes) {
+    ChangeFeed feed(3);
+    auto start = feed.Read("", 10, 0);
+    EXPECT_TRUE(start.reset);
+    EXPECT_TRUE(start.events.empty());
+
+    feed.Append(ChangeKind::kBucket, "alpha");
+    feed.Append(ChangeKind::kObject, "alpha", "a.txt");
+    auto first = feed.Read(start.cursor, 1, 0);
+    EXPECT_FALSE(first.reset);
+    ASSERT_EQ(first.events.size(), 1u);
+    EXPECT_EQ(first.events[0].kind, ChangeKind::kBucket);
+    EXPECT_EQ(first.head, 2u);
+
+    auto second = feed.Read(first.cursor, 10, 0);
+    ASSERT_EQ(second.events.size(), 1u);
+    EXPECT_EQ(second.events[0].object_name, "a.txt");
+    EXPECT_EQ(second.events[0].sequence, 2u);
+
+    // Only three events are kept, so a reader four behind has missed one.
+    for (int i = 0; i < 4; ++i) {
+        feed.Append(ChangeKind::kObject, "alpha", "b.txt");
+    }
+    auto evicted = feed.Read(second.cursor, 10, 0);
+    EXPECT_TRUE(evicted.reset);
+    EXPECT_EQ(evicted.head, 6u);
+    EXPECT_TRUE(feed.Read(evicted.cursor, 10, 0).events.empty());
+
+    // Another feed's cursor, such as one from before a restart, starts over too.
+    EXPECT_TRUE(feed.Read(ChangeFeed().Read("", 10, 0).cursor, 10, 0).reset);
+}
+
+TEST(ChangeFeed, ReadWaitsForTheNextEvent) {
+    ChangeFeed feed;
+    const auto cursor = feed.Read("", 10, 0).cursor;
+    auto reader = std::async(std::launch::async, [&] { return feed.Read(cursor, 10, 5000); });
+    EXPECT_EQ(reader.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    feed.Append(ChangeKind::kObject, "alpha", "a.txt");
+    auto page = reader.get();
+    ASSERT_EQ(page.events.size(), 1u);
+    EXPECT_EQ(page.events[0].bucket, "alpha");
+
+    const auto started = std::chrono::steady_clock::now();
+    EXPECT_TRUE(feed.Read(page.cursor, 10, 20).events.empty());
+    EXPECT_GE(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(20));
+}
+
+TEST_F(ChangeFeedStoreTest, RecordsSuccessfulMutationsOnly) {
+    nebulafs::metadata::ChangeFeedMetadataStore store(inner_, feed_);
+    const auto cursor = feed_->Read("", 10, 0).cursor;
+
+    ASSERT_TRUE(store.CreateBucket("alpha").ok());
+    ASSERT_FALSE(store.CreateBucket("alpha").ok());
+    ASSERT_TRUE(store.GetBucket("alpha").ok());
+    ASSERT_TRUE(store.CommitWrite("alpha", "a.txt", "blob-1", 7, "etag-1",
+                                  {{1, 0, "http://node-a"}})
+                    .ok());
+    ASSERT_TRUE(store.CreateMultipartUpload("alpha", "up-1", "b.txt", "2099-01-01T00:00:00Z").ok());
+    ASSERT_TRUE(store.DeleteObject("alpha", "a.txt").ok());
+
+    auto page = feed_->Read(cursor, 10, 0);
+    ASSERT_EQ(page.events.size(), 4u);
+    EXPECT_EQ(page.events[0].kind, ChangeKind::kBucket);
+    EXPECT_EQ(page.events[1].kind, ChangeKind::kObject);
+    EXPECT_EQ(page.events[1].object_name, "a.txt");
+    EXPECT_EQ(page.events[2].kind, ChangeKind::kUpload);
+    EXPECT_EQ(page.events[2].upload_id, "up-1");
+    EXPECT_EQ(page.events[3].kind, ChangeKind::kObject);
+}
+
+TEST_F(ChangeFeedStoreTest, WatcherDropsEntriesChangedThroughAnotherGateway) {
+    auto service = std::make_shared<nebulafs::metadata::ChangeFeedMetadataStore>(inner_, feed_);
+    ASSERT_TRUE(service->CreateBucket("alpha").ok());
+    ASSERT_TRUE(service->CommitWrite("alpha", "a.txt", "blob-1", 7, "etag-1",
+                                     {{1, 0, "http://node-a"}})
+                    .ok());
+
+    nebulafs::metadata::MetadataCacheOptions options;
+    options.read_plan_ttl = std::chrono::hours(1);
+    auto cache = std::make_shared<nebulafs::metadata::CachingMetadataStore>(service, options);
+    auto feed = feed_;
+    nebulafs::metadata::ChangeFeedWatcher watcher(
+        cache,
+        [feed](const std::string&) {
+            return [feed](const std::string& cursor, int wait_ms)
+                       -> nebulafs::core::Result<nebulafs::metadata::ChangePage> {
+                return feed->Read(cursor, 100, wait_ms);
+            };
+        },
+        50);
+    watcher.SetEndpoints({"http://metadata-a"});
+    ASSERT_EQ(cache->ResolveRead("alpha", "a.txt").value().blob_id, "blob-1");
+
+    // Another gateway overwrites the object behind this cache's back.
+    ASSERT_TRUE(service->CommitWrite("alpha", "a.txt", "blob-2", 7, "etag-2",
+                                     {{1, 0, "http://node-a"}})
+                    .ok());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cache->ResolveRead("alpha", "a.txt").value().blob_id != "blob-2" &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(cache->ResolveRead("alpha", "a.txt").value().blob_id, "blob-2");
+}
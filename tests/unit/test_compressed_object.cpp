@@ -0,0 +1,95 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/storage/compressed_object.h"
+
+namespace {
+
+using nebulafs::storage::CompressedObjectReader;
+
+std::filesystem::path MakeTempPath() {
+    return std::filesystem::temp_directory_path() /
+           ("nebulafs_compressed_" + Poco::UUIDGenerator().createOne().toString());
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+// Reads bytes `first`..`end` through the frames that cover them, as a range download does.
+std::string ReadRange(CompressedObjectReader& reader, std::uint64_t first, std::uint64_t end) {
+    std::string out;
+    std::string frame;
+    while (first < end) {
+        const auto index = reader.FrameOf(first);
+        EXPECT_TRUE(reader.ReadFrame(index, frame).ok());
+        const auto frame_start = index * reader.frame_bytes();
+        const auto to = std::min<std::uint64_t>(end - frame_start, frame.size());
+        out.append(frame, first - frame_start, to - (first - frame_start));
+        first = frame_start + to;
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(CompressedObject, RangesDecodeOnlyTheirFrames) {
+    const auto source = MakeTempPath();
+    const auto packed = MakeTempPath();
+    // Text that compresses well, then bytes that do not, so frames of both kinds are stored.
+    std::string body;
+    for (int i = 0; body.size() < 300000; ++i) {
+        body += "{\"line\":" + std::to_string(i) + ",\"level\":\"info\"}\n";
+    }
+    std::uint32_t state = 12345;
+    for (int i = 0; i < 70000; ++i) {
+        state = state * 1103515245u + 12345u;
+        body.push_back(static_cast<char>(state >> 24));
+    }
+    WriteFile(source, body);
+
+    auto result = nebulafs::storage::CompressObjectFile(source.string(), packed.string(), 65536);
+    ASSERT_TRUE(result.ok()) << result.error().message;
+    EXPECT_EQ(result.value().raw_bytes, body.size());
+    EXPECT_EQ(result.value().stored_bytes, std::filesystem::file_size(packed));
+    EXPECT_LT(result.value().stored_bytes, body.size() / 2);
+    EXPECT_EQ(CompressedObjectReader::ReadObjectSize(packed.string()).value(), body.size());
+
+    auto reader = CompressedObjectReader::Open(packed.string());
+    ASSERT_TRUE(reader.ok()) << reader.error().message;
+    auto& frames = reader.value();
+    EXPECT_EQ(frames.size(), body.size());
+    EXPECT_TRUE(ReadRange(frames, 0, body.size()) == body);
+    EXPECT_EQ(ReadRange(frames, 65530, 65542), body.substr(65530, 12));
+    EXPECT_TRUE(ReadRange(frames, 310000, body.size()) == body.substr(310000));
+
+    std::filesystem::remove(source);
+    std::filesystem::remove(packed);
+}
+
+TEST(CompressedObject, CorruptFramesAreRejected) {
+    const auto source = MakeTempPath();
+    const auto packed = MakeTempPath();
+    WriteFile(source, std::string(200000, 'a'));
+    ASSERT_TRUE(nebulafs::storage::CompressObjectFile(source.string(), packed.string()).ok());
+
+    {
+        std::fstream file(packed, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(2);
+        file.put('\x7f');
+    }
+    auto reader = CompressedObjectReader::Open(packed.string());
+    ASSERT_TRUE(reader.ok());
+    std::string frame;
+    EXPECT_FALSE(reader.value().ReadFrame(0, frame).ok());
+    EXPECT_FALSE(reader.value().ReadFrame(5, frame).ok());
+
+    // A raw file is not mistaken for a compressed one.
+    EXPECT_FALSE(CompressedObjectReader::Open(source.string()).ok());
+    std::filesystem::remove(source);
+    std::filesystem::remove(packed);
+}
@@ -114,3 +114,152 @@ TEST(Config, DistributedModeLoadsValidSettings) {
 
     std::filesystem::remove(path);
 }
+
+TEST(Config, DatabaseConfigLoadsReaderPoolSize) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"sqlite\": {\"path\": \"data/test.db\", \"reader_connections\": 8}}";
+    }
+
+    auto database = nebulafs::core::LoadDatabaseConfig(path.string());
+    EXPECT_EQ(database.path, "data/test.db");
+    EXPECT_EQ(database.reader_connections, 8);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, DatabaseConfigRejectsNegativeReaderPool) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"sqlite\": {\"path\": \"data/test.db\", \"reader_connections\": -1}}";
+    }
+
+    EXPECT_THROW({ (void)nebulafs::core::LoadDatabaseConfig(path.string()); },
+                 std::invalid_argument);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, DatabaseConfigSelectsMemoryEngine) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"engine\": \"memory\", "
+            << "\"memory\": {\"path\": \"data/mem\", \"snapshot_wal_bytes\": 4096}}";
+    }
+
+    auto database = nebulafs::core::LoadDatabaseConfig(path.string());
+    EXPECT_EQ(database.engine, "memory");
+    EXPECT_EQ(database.memory_path, "data/mem");
+    EXPECT_EQ(database.snapshot_wal_bytes, 4096u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, DatabaseConfigRejectsUnknownEngine) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"engine\": \"rocksdb\"}";
+    }
+
+    EXPECT_THROW({ (void)nebulafs::core::LoadDatabaseConfig(path.string()); },
+                 std::invalid_argument);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, DistributedModeAcceptsMetadataShards) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"server\": {\"mode\": \"distributed\"}, "
+            << "\"storage\": {\"multipart\": {\"max_upload_ttl_seconds\": 60}}, "
+            << "\"cleanup\": {\"sweep_interval_seconds\": 60, \"max_uploads_per_sweep\": 10}, "
+            << "\"distributed\": {\"metadata_shards\": [\"http://m1\", \"http://m2\"], "
+            << "\"service_auth_token\": \"token\", \"storage_nodes\": [\"http://s1\", "
+            << "\"http://s2\"], \"replication_factor\": 2, \"min_write_acks\": 1}}";
+    }
+
+    auto config = nebulafs::core::LoadConfig(path.string());
+    const auto shards = nebulafs::core::MetadataShardEndpoints(config.distributed);
+    ASSERT_EQ(shards.size(), 2u);
+    EXPECT_EQ(shards[1], "http://m2");
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, ShardMapFileOverridesShardList) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"shards\": [\"http://a\", \"http://b\", \"http://c\"]}";
+    }
+
+    nebulafs::core::DistributedConfig distributed;
+    distributed.metadata_shards = {"http://old"};
+    distributed.shard_map_path = path.string();
+    EXPECT_EQ(nebulafs::core::MetadataShardEndpoints(distributed).size(), 3u);
+
+    {
+        std::ofstream out(path);
+        out << "{\"shards\": []}";
+    }
+    EXPECT_THROW({ (void)nebulafs::core::LoadShardMap(path.string()); }, std::invalid_argument);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, ReplicationLoadsMembersAndTimeouts) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"replication\": {\"enabled\": true, \"self_url\": \"http://m1\", "
+            << "\"peers\": [\"http://m2\", \"http://m3\"], \"election_timeout_ms\": 600, "
+            << "\"heartbeat_interval_ms\": 100, \"max_staleness_ms\": 1500}}";
+    }
+
+    auto config = nebulafs::core::LoadConfig(path.string());
+    EXPECT_TRUE(config.replication.enabled);
+    EXPECT_EQ(config.replication.self_url, "http://m1");
+    ASSERT_EQ(config.replication.peers.size(), 2u);
+    EXPECT_EQ(config.replication.peers[1], "http://m3");
+    EXPECT_EQ(config.replication.election_timeout_ms, 600);
+    EXPECT_EQ(config.replication.max_staleness_ms, 1500);
+    EXPECT_EQ(config.replication.commit_timeout_ms, 5000);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, ReplicationRejectsHeartbeatSlowerThanElectionTimeout) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"replication\": {\"enabled\": true, \"self_url\": \"http://m1\", "
+            << "\"election_timeout_ms\": 200, \"heartbeat_interval_ms\": 500}}";
+    }
+
+    EXPECT_THROW({ (void)nebulafs::core::LoadConfig(path.string()); }, std::invalid_argument);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Config, MetadataCacheLoadsTtlsAndBudget) {
+    const auto path = MakeTempConfigPath();
+    {
+        std::ofstream out(path);
+        out << "{\"metadata_cache\": {\"read_plan_ttl_ms\": 250, \"negative_ttl_ms\": 0, "
+            << "\"max_bytes\": 1048576}}";
+    }
+
+    auto config = nebulafs::core::LoadConfig(path.string());
+    EXPECT_TRUE(config.metadata_cache.enabled);
+    EXPECT_EQ(config.metadata_cache.bucket_ttl_ms, 30000);
+    EXPECT_EQ(config.metadata_cache.read_plan_ttl_ms, 250);
+    EXPECT_EQ(config.metadata_cache.negative_ttl_ms, 0);
+    EXPECT_EQ(config.metadata_cache.max_bytes, 1048576u);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,231 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/storage/local_storage.h"
+
+namespace {
+
+std::filesystem::path MakeTempDir() {
+    const auto name = "nebulafs_storage_" + Poco::UUIDGenerator().createOne().toString();
+    return std::filesystem::temp_directory_path() / name;
+}
+
+nebulafs::storage::StoredObject Write(nebulafs::storage::LocalStorage& storage,
+                                      const std::string& object, const std::string& body) {
+    std::istringstream in(body);
+    auto stored = storage.WriteObject("ci", object, in);
+    EXPECT_TRUE(stored.ok());
+    return stored.ok() ? stored.value() : nebulafs::storage::StoredObject{};
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+}  // namespace
+
+TEST(LocalStorage, ContentAddressedWritesShareOneBody) {
+    const auto dir = MakeTempDir();
+    {
+        nebulafs::storage::LocalStorage storage((dir / "data").string(), (dir / "tmp").string(),
+                                                true);
+        const auto first = Write(storage, "a.bin", "artifact");
+        const auto second = Write(storage, "b.bin", "artifact");
+        Write(storage, "c.bin", "other");
+        EXPECT_EQ(first.etag, second.etag);
+        const auto content =
+            nebulafs::storage::LocalStorage::BuildContentPath((dir / "data").string(), first.etag);
+        // Both objects and the store entry are links to one file.
+        EXPECT_EQ(std::filesystem::hard_link_count(content), 3u);
+
+        auto linked = storage.LinkObject("ci", "c.bin", first.etag);
+        ASSERT_TRUE(linked.ok()) << linked.error().message;
+        EXPECT_EQ(linked.value().size_bytes, 8u);
+        EXPECT_EQ(ReadFile(linked.value().path), "artifact");
+        // A staged body placed under its digest joins the stored copy instead of adding one.
+        const auto staged = (dir / "tmp" / "staged").string();
+        std::ofstream(staged) << "artifact";
+        auto placed = storage.PlaceObject("ci", "p.bin", staged, first.etag);
+        ASSERT_TRUE(placed.ok()) << placed.error().message;
+        EXPECT_EQ(std::filesystem::hard_link_count(content), 5u);
+        EXPECT_FALSE(std::filesystem::exists(staged));
+        ASSERT_TRUE(storage.DeleteObject("ci", "p.bin").ok());
+        auto unknown = storage.LinkObject("ci", "d.bin", std::string(64, 'a'));
+        ASSERT_FALSE(unknown.ok());
+        EXPECT_EQ(unknown.error().code, nebulafs::core::ErrorCode::kNotFound);
+
+        // "other" lost its only object when c.bin was relinked, so it is the one body to go.
+        auto reclaimed = storage.ReclaimContent();
+        ASSERT_TRUE(reclaimed.ok());
+        EXPECT_EQ(reclaimed.value(), 1u);
+        ASSERT_TRUE(storage.DeleteObject("ci", "a.bin").ok());
+        ASSERT_TRUE(storage.DeleteObject("ci", "b.bin").ok());
+        EXPECT_EQ(storage.ReclaimContent().value(), 0u);
+        ASSERT_TRUE(storage.DeleteObject("ci", "c.bin").ok());
+        EXPECT_EQ(storage.ReclaimContent().value(), 1u);
+        EXPECT_FALSE(std::filesystem::exists(content));
+        EXPECT_FALSE(storage.LinkObject("ci", "e.bin", first.etag).ok());
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LocalStorage, PlainLayoutKeepsSeparateFiles) {
+    const auto dir = MakeTempDir();
+    {
+        nebulafs::storage::LocalStorage storage((dir / "data").string(), (dir / "tmp").string());
+        const auto first = Write(storage, "a.bin", "artifact");
+        Write(storage, "b.bin", "artifact");
+        EXPECT_EQ(std::filesystem::hard_link_count(first.path), 1u);
+        auto linked = storage.LinkObject("ci", "c.bin", first.etag);
+        ASSERT_FALSE(linked.ok());
+        EXPECT_EQ(linked.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_EQ(storage.ReclaimContent().value(), 0u);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LocalStorage, FanoutBucketsReadFlatObjectsUntilMigrated) {
+    const auto dir = MakeTempDir();
+    const auto data = (dir / "data").string();
+    // The hash is fixed: FNV-1a of "a" is 0xe40c292c.
+    EXPECT_EQ(nebulafs::storage::LocalStorage::BuildFanoutObjectPath(data, "ci", "a"),
+              (dir / "data" / "buckets" / "ci" / "fanout" / "e4" / "0c" / "a").string());
+    {
+        nebulafs::storage::LocalStorage flat(data, (dir / "tmp").string());
+        Write(flat, "a.bin", "first");
+        Write(flat, "b.bin", "old");
+        EXPECT_EQ(flat.MigrateObjectLayout(10).value(), 0u);
+    }
+    {
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string(), false, {"ci"});
+        auto before = storage.ReadObject("ci", "a.bin");
+        ASSERT_TRUE(before.ok());
+        EXPECT_EQ(before.value().path,
+                  nebulafs::storage::LocalStorage::BuildObjectPath(data, "ci", "a.bin"));
+        const auto written = Write(storage, "b.bin", "new");
+        EXPECT_EQ(written.path,
+                  nebulafs::storage::LocalStorage::BuildFanoutObjectPath(data, "ci", "b.bin"));
+
+        // One object per step: the stale flat b.bin only goes, it does not replace the new one.
+        EXPECT_EQ(storage.MigrateObjectLayout(1).value(), 1u);
+        EXPECT_EQ(storage.MigrateObjectLayout(10).value(), 1u);
+        EXPECT_EQ(storage.MigrateObjectLayout(10).value(), 0u);
+        EXPECT_TRUE(std::filesystem::is_empty(dir / "data" / "buckets" / "ci" / "objects"));
+        auto after = storage.ReadObject("ci", "a.bin");
+        ASSERT_TRUE(after.ok());
+        EXPECT_EQ(ReadFile(after.value().path), "first");
+        EXPECT_EQ(ReadFile(storage.ReadObject("ci", "b.bin").value().path), "new");
+
+        const auto staged = (dir / "tmp" / "staged").string();
+        std::ofstream(staged) << "placed";
+        auto placed = storage.PlaceObject("ci", "c.bin", staged, "etag-c");
+        ASSERT_TRUE(placed.ok()) << placed.error().message;
+        EXPECT_EQ(placed.value().size_bytes, 6u);
+        EXPECT_EQ(ReadFile(storage.ReadObject("ci", "c.bin").value().path), "placed");
+
+        ASSERT_TRUE(storage.DeleteObject("ci", "a.bin").ok());
+        EXPECT_FALSE(storage.ReadObject("ci", "a.bin").ok());
+        auto missing = storage.DeleteObject("ci", "a.bin");
+        ASSERT_FALSE(missing.ok());
+        EXPECT_EQ(missing.error().code, nebulafs::core::ErrorCode::kNotFound);
+    }
+    {
+        // The switch is recorded on disk, so the layout holds without the setting.
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string());
+        EXPECT_EQ(ReadFile(storage.ReadObject("ci", "b.bin").value().path), "new");
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LocalStorage, CompressedBucketsKeepUncompressedSizes) {
+    const auto dir = MakeTempDir();
+    const auto data = (dir / "data").string();
+    const std::string body(100000, 'z');
+    {
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string(), false, {}, {"ci"});
+        const auto written = Write(storage, "log.txt", body);
+        EXPECT_TRUE(written.compressed);
+        EXPECT_EQ(written.size_bytes, body.size());
+        EXPECT_LT(std::filesystem::file_size(written.path), body.size() / 10);
+
+        auto read = storage.ReadObject("ci", "log.txt");
+        ASSERT_TRUE(read.ok());
+        EXPECT_TRUE(read.value().compressed);
+        EXPECT_EQ(read.value().size_bytes, body.size());
+        auto range = storage.ReadObjectRange("ci", "log.txt", 99990, 200000);
+        ASSERT_TRUE(range.ok());
+        EXPECT_TRUE(range.value().compressed);
+        EXPECT_EQ(range.value().last, body.size() - 1);
+    }
+    {
+        // Without the setting the next write is raw again and the compressed copy goes.
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string());
+        EXPECT_TRUE(storage.ReadObject("ci", "log.txt").value().compressed);
+        const auto written = Write(storage, "log.txt", "plain");
+        EXPECT_FALSE(written.compressed);
+        EXPECT_EQ(ReadFile(storage.ReadObject("ci", "log.txt").value().path), "plain");
+        EXPECT_FALSE(std::filesystem::exists(
+            nebulafs::storage::LocalStorage::BuildObjectPath(data, "ci", "log.txt") +
+            nebulafs::storage::LocalStorage::kCompressedSuffix));
+        ASSERT_TRUE(storage.DeleteObject("ci", "log.txt").ok());
+        EXPECT_FALSE(storage.ReadObject("ci", "log.txt").ok());
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LocalStorage, CopiesAndMovesKeepTheStoredForm) {
+    const auto dir = MakeTempDir();
+    const auto data = (dir / "data").string();
+    const std::string body(100000, 'z');
+    {
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string(), false, {"fan"},
+                                                {"ci"});
+        Write(storage, "log.txt", body);
+        auto copied = storage.CopyObject("ci", "log.txt", "fan", "copy.txt");
+        ASSERT_TRUE(copied.ok()) << copied.error().message;
+        EXPECT_TRUE(copied.value().compressed);
+        EXPECT_EQ(copied.value().size_bytes, body.size());
+        auto read = storage.ReadObject("fan", "copy.txt");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().path, copied.value().path);
+        EXPECT_TRUE(ReadFile(read.value().path) ==
+                    ReadFile(storage.ReadObject("ci", "log.txt").value().path));
+
+        // The source keeps its own file.
+        ASSERT_TRUE(storage.DeleteObject("ci", "log.txt").ok());
+        EXPECT_TRUE(storage.ReadObject("fan", "copy.txt").ok());
+
+        auto moved = storage.MoveObject("fan", "copy.txt", "fan", "moved.txt");
+        ASSERT_TRUE(moved.ok()) << moved.error().message;
+        EXPECT_FALSE(storage.ReadObject("fan", "copy.txt").ok());
+        EXPECT_EQ(storage.ReadObject("fan", "moved.txt").value().size_bytes, body.size());
+
+        auto same = storage.CopyObject("fan", "moved.txt", "fan", "moved.txt");
+        ASSERT_FALSE(same.ok());
+        EXPECT_EQ(same.error().code, nebulafs::core::ErrorCode::kInvalidArgument);
+        auto missing = storage.MoveObject("fan", "copy.txt", "fan", "other.txt");
+        ASSERT_FALSE(missing.ok());
+        EXPECT_EQ(missing.error().code, nebulafs::core::ErrorCode::kNotFound);
+    }
+    {
+        // A raw copy replaces a compressed destination, and content-addressed copies share
+        // the stored body.
+        nebulafs::storage::LocalStorage storage(data, (dir / "tmp").string(), true);
+        const auto written = Write(storage, "raw.bin", "artifact");
+        auto copied = storage.CopyObject("ci", "raw.bin", "fan", "moved.txt");
+        ASSERT_TRUE(copied.ok()) << copied.error().message;
+        EXPECT_FALSE(copied.value().compressed);
+        EXPECT_EQ(ReadFile(storage.ReadObject("fan", "moved.txt").value().path), "artifact");
+        EXPECT_FALSE(std::filesystem::exists(
+            nebulafs::storage::LocalStorage::BuildFanoutObjectPath(data, "fan", "moved.txt") +
+            nebulafs::storage::LocalStorage::kCompressedSuffix));
+        EXPECT_EQ(std::filesystem::hard_link_count(written.path), 3u);
+    }
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,619 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/metadata/memory_metadata_store.h"
+
+namespace {
+
+std::filesystem::path MakeTempDir() {
+    const auto name = "nebulafs_mem_" + Poco::UUIDGenerator().createOne().toString();
+    return std::filesystem::temp_directory_path() / name;
+}
+
+void PutObjects(nebulafs::metadata::MetadataStore& store, const std::string& bucket,
+                const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = name;
+        meta.etag = "etag-" + name;
+        ASSERT_TRUE(store.UpsertObject(bucket, meta).ok());
+    }
+}
+
+}  // namespace
+
+TEST(MemoryMetadataStore, RecoversStateFromWal) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        PutObjects(store, "alpha", {"a.txt", "b.txt", "c.txt"});
+        ASSERT_TRUE(store.DeleteObject("alpha", "b.txt").ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("alpha", "up-1", "big.bin", "2099-01-01").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 5, "p1", "/tmp/p1").ok());
+        nebulafs::metadata::BatchOp set_size;
+        set_size.type = nebulafs::metadata::BatchOpType::kSetMultipartPartSize;
+        set_size.upload_id = "up-1";
+        set_size.part_size = 4096;
+        ASSERT_TRUE(store.ExecuteBatch({set_size}).ok());
+        nebulafs::metadata::BatchOp create;
+        create.type = nebulafs::metadata::BatchOpType::kCreateMultipartUpload;
+        create.bucket = "alpha";
+        create.object_name = "huge.bin";
+        create.upload_id = "up-2";
+        create.expires_at = "2099-01-01";
+        set_size.upload_id = "up-2";
+        set_size.part_size = 8192;
+        ASSERT_TRUE(store.ExecuteBatch({create, set_size}).ok());
+        set_size.upload_id = "missing";
+        create.upload_id = "up-3";
+        ASSERT_FALSE(store.ExecuteBatch({create, set_size}).ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a"}).ok());
+        ASSERT_TRUE(store.CommitWrite("alpha", "d.bin", "blob-1", 7, "etag-d",
+                                      {{1, 0, "http://node-a"}})
+                        .ok());
+    }
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        auto objects = store.ListObjects("alpha", "");
+        ASSERT_TRUE(objects.ok());
+        ASSERT_EQ(objects.value().size(), 3u);
+        EXPECT_EQ(objects.value()[0].name, "a.txt");
+        EXPECT_EQ(objects.value()[1].name, "c.txt");
+
+        auto parts = store.ListMultipartParts("up-1");
+        ASSERT_TRUE(parts.ok());
+        ASSERT_EQ(parts.value().size(), 1u);
+        EXPECT_EQ(parts.value()[0].etag, "p1");
+        EXPECT_EQ(store.GetMultipartUpload("up-1").value().part_size, 4096u);
+        EXPECT_EQ(store.GetMultipartUpload("up-2").value().object_name, "huge.bin");
+        EXPECT_EQ(store.GetMultipartUpload("up-2").value().part_size, 8192u);
+        EXPECT_FALSE(store.GetMultipartUpload("up-3").ok());
+
+        auto read = store.ResolveRead("alpha", "d.bin");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, "blob-1");
+        ASSERT_EQ(read.value().replicas.size(), 1u);
+        EXPECT_EQ(read.value().replicas[0].endpoint, "http://node-a");
+
+        // Ids continue past recovered rows instead of reusing them.
+        auto bucket = store.CreateBucket("beta");
+        ASSERT_TRUE(bucket.ok());
+        EXPECT_EQ(bucket.value().id, 2);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, BatchRollsBackOnFailureAndRecoversAsOneRecord) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto dir = MakeTempDir();
+
+    BatchOp commit;
+    commit.type = BatchOpType::kCommitWrite;
+    commit.bucket = "alpha";
+    commit.upload_id = "up-1";
+    commit.expect_upload_state = "initiated";
+    commit.blob_id = "blob-1";
+    commit.size_bytes = 5;
+    commit.etag = "etag-big";
+    commit.replicas = {{1, 0, ""}};
+    BatchOp delete_upload;
+    delete_upload.type = BatchOpType::kDeleteMultipartUpload;
+    delete_upload.upload_id = "up-1";
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a"}).ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("alpha", "up-1", "big.bin", "2099-01-01").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 5, "p1", "loc-1").ok());
+
+        BatchOp mismatch = delete_upload;
+        mismatch.expect_upload_state = "uploading";
+        auto failed = store.ExecuteBatch({commit, mismatch});
+        ASSERT_FALSE(failed.ok());
+        EXPECT_EQ(failed.error().code, nebulafs::core::ErrorCode::kFailedPrecondition);
+        EXPECT_FALSE(store.GetObject("alpha", "big.bin").ok());
+        EXPECT_TRUE(store.GetMultipartUpload("up-1").ok());
+
+        ASSERT_TRUE(store.ExecuteBatch({commit, delete_upload}).ok());
+    }
+
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    auto object = store.GetObject("alpha", "big.bin");
+    ASSERT_TRUE(object.ok());
+    EXPECT_EQ(object.value().etag, "etag-big");
+    EXPECT_EQ(store.ResolveRead("alpha", "big.bin").value().blob_id, "blob-1");
+    EXPECT_FALSE(store.GetMultipartUpload("up-1").ok());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, ManifestsSurviveWalReplay) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto dir = MakeTempDir();
+
+    BatchOp commit;
+    commit.type = BatchOpType::kCommitManifest;
+    commit.bucket = "alpha";
+    commit.object_name = "big.bin";
+    commit.size_bytes = 12;
+    commit.etag = "etag-composite-2";
+    commit.segments = {{"blob-1", 0, 5, "p1", {{0, 0, "http://node-b"}}},
+                       {"blob-2", 5, 7, "p2", {{0, 0, "http://node-a"}, {0, 1, "http://node-b"}}}};
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+        BatchOp short_manifest = commit;
+        short_manifest.size_bytes = 13;
+        auto rejected = store.ExecuteBatch({short_manifest});
+        ASSERT_FALSE(rejected.ok());
+        EXPECT_EQ(rejected.error().code, nebulafs::core::ErrorCode::kInvalidArgument);
+        ASSERT_TRUE(store.ExecuteBatch({commit}).ok());
+    }
+
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    auto read = store.ResolveRead("alpha", "big.bin");
+    ASSERT_TRUE(read.ok()) << read.error().message;
+    EXPECT_EQ(read.value().size_bytes, 12u);
+    EXPECT_TRUE(read.value().replicas.empty());
+    ASSERT_EQ(read.value().segments.size(), 2u);
+    EXPECT_EQ(read.value().segments[0].replicas[0].endpoint, "http://node-b");
+    EXPECT_EQ(read.value().segments[1].offset, 5u);
+    ASSERT_EQ(read.value().segments[1].replicas.size(), 2u);
+    EXPECT_EQ(read.value().segments[1].replicas[0].endpoint, "http://node-a");
+    EXPECT_EQ(read.value().segments[1].replicas[1].endpoint, "http://node-b");
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, BlobReferencesSurviveRecoveryAndRollback) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto dir = MakeTempDir();
+
+    BatchOp copy;
+    copy.type = BatchOpType::kCopyObject;
+    copy.bucket = "beta";
+    copy.object_name = "b.bin";
+    copy.source_bucket = "alpha";
+    copy.source_object = "a.bin";
+    BatchOp remove;
+    remove.type = BatchOpType::kDeleteObject;
+    remove.bucket = "alpha";
+    remove.object_name = "a.bin";
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        ASSERT_TRUE(store.CreateBucket("beta").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+        auto plan = store.AllocateWrite("alpha", "a.bin", 2, "token");
+        ASSERT_TRUE(plan.ok());
+        ASSERT_TRUE(store.CommitWrite("alpha", "a.bin", "blob-1", 9, "etag-1",
+                                      plan.value().replicas)
+                        .ok());
+        auto copied = store.ExecuteBatch({copy});
+        ASSERT_TRUE(copied.ok()) << copied.error().message;
+        EXPECT_EQ(copied.value()[0].read_plan.replicas[0].endpoint, "http://node-a");
+
+        // A failed batch gives back the references its ops took.
+        BatchOp bad = remove;
+        bad.bucket = "missing";
+        BatchOp second = copy;
+        second.object_name = "c.bin";
+        EXPECT_FALSE(store.ExecuteBatch({second, bad}).ok());
+        EXPECT_FALSE(store.GetObject("beta", "c.bin").ok());
+    }
+
+    // The counts are rebuilt from the replayed rows.
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    auto read = store.ResolveRead("beta", "b.bin");
+    ASSERT_TRUE(read.ok()) << read.error().message;
+    EXPECT_EQ(read.value().blob_id, "blob-1");
+    EXPECT_EQ(read.value().etag, "etag-1");
+    ASSERT_EQ(read.value().replicas.size(), 2u);
+    auto first = store.ExecuteBatch({remove});
+    ASSERT_TRUE(first.ok());
+    EXPECT_EQ(first.value()[0].blob_references, 1u);
+    remove.bucket = "beta";
+    remove.object_name = "b.bin";
+    auto last = store.ExecuteBatch({remove});
+    ASSERT_TRUE(last.ok());
+    EXPECT_EQ(last.value()[0].blob_references, 0u);
+    EXPECT_EQ(last.value()[0].read_plan.blob_id, "blob-1");
+    EXPECT_TRUE(last.value()[0].removed);
+    auto again = store.ExecuteBatch({remove});
+    ASSERT_TRUE(again.ok());
+    EXPECT_FALSE(again.value()[0].removed);
+    EXPECT_FALSE(store.ExecuteBatch({copy}).ok());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, InlineDataSurvivesWalReplayAndSnapshots) {
+    const auto dir = MakeTempDir();
+
+    nebulafs::metadata::ObjectMetadata meta;
+    meta.name = "tiny.txt";
+    meta.size_bytes = 5;
+    meta.etag = "etag";
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        meta.inline_data = "hello";
+        ASSERT_TRUE(store.UpsertObject("alpha", meta).ok());
+        ASSERT_TRUE(store.Checkpoint().ok());
+        meta.name = "later.txt";
+        meta.inline_data = "world";
+        ASSERT_TRUE(store.UpsertObject("alpha", meta).ok());
+        meta.name = "cleared.txt";
+        ASSERT_TRUE(store.UpsertObject("alpha", meta).ok());
+        meta.inline_data.reset();
+        ASSERT_TRUE(store.UpsertObject("alpha", meta).ok());
+
+        // A move takes the body along in the copied row.
+        nebulafs::metadata::BatchOp copy;
+        copy.type = nebulafs::metadata::BatchOpType::kCopyObject;
+        copy.bucket = "alpha";
+        copy.object_name = "moved.txt";
+        copy.source_bucket = "alpha";
+        copy.source_object = "later.txt";
+        nebulafs::metadata::BatchOp remove;
+        remove.type = nebulafs::metadata::BatchOpType::kDeleteObject;
+        remove.bucket = "alpha";
+        remove.object_name = "later.txt";
+        auto moved = store.ExecuteBatch({copy, remove});
+        ASSERT_TRUE(moved.ok()) << moved.error().message;
+        copy.source_object = "cleared.txt";
+        EXPECT_FALSE(store.ExecuteBatch({copy}).ok());
+    }
+
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    auto snapshotted = store.GetObject("alpha", "tiny.txt");
+    ASSERT_TRUE(snapshotted.ok());
+    EXPECT_EQ(snapshotted.value().inline_data.value_or(""), "hello");
+    auto replayed = store.GetObject("alpha", "moved.txt");
+    ASSERT_TRUE(replayed.ok());
+    EXPECT_EQ(replayed.value().inline_data.value_or(""), "world");
+    EXPECT_FALSE(store.GetObject("alpha", "later.txt").ok());
+    auto cleared = store.GetObject("alpha", "cleared.txt");
+    ASSERT_TRUE(cleared.ok());
+    EXPECT_FALSE(cleared.value().inline_data.has_value());
+    auto listed = store.ListObjects("alpha", "");
+    ASSERT_TRUE(listed.ok());
+    ASSERT_EQ(listed.value().size(), 3u);
+    EXPECT_FALSE(listed.value()[0].inline_data.has_value());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, LeasesSurviveWalReplayAndSnapshots) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto dir = MakeTempDir();
+
+    BatchOp acquire;
+    acquire.type = BatchOpType::kAcquireLease;
+    acquire.lease = "cleanup/multipart";
+    acquire.lease_holder = "gw-a";
+    acquire.lease_ttl_ms = 1000;
+    acquire.now_ms = 10000;
+    BatchOp rival = acquire;
+    rival.lease_holder = "gw-b";
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.ExecuteBatch({acquire}).ok());
+        ASSERT_TRUE(store.Checkpoint().ok());
+        rival.now_ms = 12000;
+        auto taken = store.ExecuteBatch({rival});
+        ASSERT_TRUE(taken.ok()) << taken.error().message;
+        EXPECT_EQ(taken.value()[0].lease.fencing_token, 2u);
+
+        // A failed check rolls back a lease taken earlier in the same batch.
+        BatchOp stale;
+        stale.type = BatchOpType::kCheckLease;
+        stale.lease = "cleanup/multipart";
+        stale.lease_holder = "gw-a";
+        stale.fencing_token = 1;
+        stale.now_ms = 12000;
+        BatchOp other = acquire;
+        other.lease = "cleanup/other";
+        ASSERT_FALSE(store.ExecuteBatch({other, stale}).ok());
+    }
+
+    // Snapshot then WAL: the second holder's term is what recovery restores.
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    acquire.now_ms = 12500;
+    auto refused = store.ExecuteBatch({acquire});
+    ASSERT_FALSE(refused.ok());
+    EXPECT_EQ(refused.error().code, nebulafs::core::ErrorCode::kFailedPrecondition);
+    BatchOp other = acquire;
+    other.lease = "cleanup/other";
+    auto fresh = store.ExecuteBatch({other});
+    ASSERT_TRUE(fresh.ok());
+    EXPECT_EQ(fresh.value()[0].lease.fencing_token, 1u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, BucketStatsSurviveRecoveryAndRollback) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto dir = MakeTempDir();
+
+    BatchOp get;
+    get.type = BatchOpType::kGetBucketStats;
+    get.bucket = "stats";
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a"}).ok());
+        ASSERT_TRUE(store.CreateBucket("stats").ok());
+        ASSERT_TRUE(store.CommitWrite("stats", "a.txt", "blob-a", 10, "etag-a",
+                                      {{1, 0, "http://node-a"}})
+                        .ok());
+        ASSERT_TRUE(store.CommitWrite("stats", "a.txt", "blob-b", 4, "etag-b",
+                                      {{1, 0, "http://node-a"}})
+                        .ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("stats", "up-1", "big.bin", "2099-01-01").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 5, "e1", "/tmp/p1").ok());
+        ASSERT_TRUE(store.Checkpoint().ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 6, "e1", "/tmp/p1").ok());
+
+        // A batch that fails after committing an object leaves the counters as they were.
+        BatchOp commit;
+        commit.type = BatchOpType::kCommitWrite;
+        commit.bucket = "stats";
+        commit.object_name = "b.txt";
+        commit.blob_id = "blob-c";
+        commit.size_bytes = 100;
+        commit.etag = "etag-c";
+        commit.replicas = {{1, 0, "http://node-a"}};
+        BatchOp parts;
+        parts.type = BatchOpType::kDeleteMultipartParts;
+        parts.upload_id = "up-1";
+        BatchOp stale;
+        stale.type = BatchOpType::kUpdateMultipartUploadState;
+        stale.upload_id = "up-1";
+        stale.state = "completed";
+        stale.expect_upload_state = "aborted";
+        ASSERT_FALSE(store.ExecuteBatch({commit, parts, stale}).ok());
+    }
+
+    nebulafs::metadata::MemoryMetadataStore store(dir.string());
+    BatchOp repair = get;
+    repair.type = BatchOpType::kRepairBucketStats;
+    auto stats = store.ExecuteBatch({get, repair});
+    ASSERT_TRUE(stats.ok());
+    for (const auto& result : stats.value()) {
+        EXPECT_EQ(result.stats.object_count, 1u);
+        EXPECT_EQ(result.stats.total_bytes, 4u);
+        EXPECT_EQ(result.stats.multipart_bytes, 6u);
+    }
+    ASSERT_TRUE(store.DeleteMultipartUpload("up-1").ok());
+    ASSERT_TRUE(store.DeleteObject("stats", "a.txt").ok());
+    auto emptied = store.ExecuteBatch({get});
+    ASSERT_TRUE(emptied.ok());
+    EXPECT_EQ(emptied.value()[0].stats.object_count, 0u);
+    EXPECT_EQ(emptied.value()[0].stats.total_bytes, 0u);
+    EXPECT_EQ(emptied.value()[0].stats.multipart_bytes, 0u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, CheckpointTruncatesWalAndRecovers) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        PutObjects(store, "alpha", {"one", "two"});
+        ASSERT_TRUE(store.Checkpoint().ok());
+        EXPECT_EQ(std::filesystem::file_size(dir / "wal"), 0u);
+        PutObjects(store, "alpha", {"three"});
+    }
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        auto objects = store.ListObjects("alpha", "");
+        ASSERT_TRUE(objects.ok());
+        ASSERT_EQ(objects.value().size(), 3u);
+        EXPECT_EQ(objects.value()[2].name, "two");
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, DropsTornWalTail) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+    }
+    {
+        std::ofstream out(dir / "wal", std::ios::binary | std::ios::app);
+        out << "partial";
+    }
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.GetBucket("alpha").ok());
+        ASSERT_TRUE(store.CreateBucket("beta").ok());
+    }
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        auto buckets = store.ListBuckets();
+        ASSERT_TRUE(buckets.ok());
+        EXPECT_EQ(buckets.value().size(), 2u);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, ConcurrentWritersShareGroupCommits) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string(), 4096);
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&store, t] {
+                for (int i = 0; i < 50; ++i) {
+                    nebulafs::metadata::ObjectMetadata meta;
+                    meta.name = "t" + std::to_string(t) + "-" + std::to_string(i);
+                    EXPECT_TRUE(store.UpsertObject("alpha", meta).ok());
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+    }
+
+    {
+        // The small WAL threshold forces background snapshots during the run.
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        auto objects = store.ListObjects("alpha", "");
+        ASSERT_TRUE(objects.ok());
+        EXPECT_EQ(objects.value().size(), 200u);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, SnapshotsTakenDuringWritesRecover) {
+    const auto dir = MakeTempDir();
+    std::vector<std::pair<std::string, std::string>> expected;
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        // Enough objects that a snapshot copies them in several chunks.
+        for (int first = 0; first < 10000; first += 1000) {
+            std::vector<nebulafs::metadata::BatchOp> ops(1000);
+            for (int i = 0; i < 1000; ++i) {
+                ops[i].type = nebulafs::metadata::BatchOpType::kCommitWrite;
+                ops[i].bucket = "alpha";
+                ops[i].object_name = "o-" + std::to_string(first + i);
+                ops[i].etag = "v1";
+            }
+            ASSERT_TRUE(store.ExecuteBatch(ops).ok());
+        }
+
+        std::thread writer([&store] {
+            for (int i = 0; i < 300; ++i) {
+                nebulafs::metadata::ObjectMetadata meta;
+                meta.name = "o-" + std::to_string(i * 31);
+                meta.etag = "v2";
+                EXPECT_TRUE(store.UpsertObject("alpha", meta).ok());
+                EXPECT_TRUE(store.DeleteObject("alpha", "o-" + std::to_string(i * 29 + 1)).ok());
+                meta.name = "new-" + std::to_string(i);
+                EXPECT_TRUE(store.UpsertObject("alpha", meta).ok());
+            }
+        });
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(store.Checkpoint().ok());
+        }
+        writer.join();
+
+        auto objects = store.ListObjects("alpha", "");
+        ASSERT_TRUE(objects.ok());
+        for (const auto& object : objects.value()) {
+            expected.emplace_back(object.name, object.etag);
+        }
+    }
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        auto objects = store.ListObjects("alpha", "");
+        ASSERT_TRUE(objects.ok());
+        ASSERT_EQ(objects.value().size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(objects.value()[i].name, expected[i].first);
+            EXPECT_EQ(objects.value()[i].etag, expected[i].second);
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, ListObjectsPageStaysWithinBucket) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        ASSERT_TRUE(store.CreateBucket("beta").ok());
+        PutObjects(store, "alpha", {"docs/a", "docs/b", "img/c", "root"});
+        PutObjects(store, "beta", {"docs/z"});
+
+        nebulafs::metadata::ListObjectsOptions options;
+        options.delimiter = "/";
+        options.max_keys = 2;
+        auto page = store.ListObjectsPage("alpha", options);
+        ASSERT_TRUE(page.ok());
+        ASSERT_EQ(page.value().common_prefixes.size(), 2u);
+        EXPECT_EQ(page.value().common_prefixes[0], "docs/");
+        EXPECT_TRUE(page.value().is_truncated);
+
+        options.cursor = page.value().next_cursor;
+        page = store.ListObjectsPage("alpha", options);
+        ASSERT_TRUE(page.ok());
+        ASSERT_EQ(page.value().objects.size(), 1u);
+        EXPECT_EQ(page.value().objects[0].name, "root");
+        EXPECT_FALSE(page.value().is_truncated);
+
+        auto missing = store.ListObjectsPage("gamma", {});
+        ASSERT_TRUE(missing.ok());
+        EXPECT_TRUE(missing.value().objects.empty());
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MemoryMetadataStore, ListMultipartPartsPagesFromMarker) {
+    const auto dir = MakeTempDir();
+
+    {
+        nebulafs::metadata::MemoryMetadataStore store(dir.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("alpha", "up-1", "big.bin", "2099-01-01").ok());
+        for (int part = 1; part <= 5; ++part) {
+            ASSERT_TRUE(store.UpsertMultipartPart("up-1", part * 2, 1, "e", "/tmp/p").ok());
+        }
+
+        nebulafs::metadata::BatchOp list;
+        list.type = nebulafs::metadata::BatchOpType::kListMultipartParts;
+        list.upload_id = "up-1";
+        list.part_number_marker = 4;
+        list.max_parts = 2;
+        auto page = store.ExecuteBatch({list});
+        ASSERT_TRUE(page.ok());
+        ASSERT_EQ(page.value()[0].parts.size(), 2u);
+        EXPECT_EQ(page.value()[0].parts[0].part_number, 6);
+        EXPECT_EQ(page.value()[0].parts[1].part_number, 8);
+
+        list.part_number_marker = 10;
+        page = store.ExecuteBatch({list});
+        ASSERT_TRUE(page.ok());
+        EXPECT_TRUE(page.value()[0].parts.empty());
+    }
+
+    std::filesystem::remove_all(dir);
+}
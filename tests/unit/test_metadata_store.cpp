@@ -1,9 +1,17 @@
+#include <atomic>
 #include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <Poco/UUIDGenerator.h>
 
+#include "nebulafs/core/time.h"
+#include "nebulafs/metadata/metadata_batch.h"
+#include "nebulafs/metadata/object_listing.h"
 #include "nebulafs/metadata/sqlite_metadata_store.h"
+#include "nebulafs/metadata/sqlite_schema.h"
 
 namespace {
 
@@ -12,6 +20,22 @@ std::filesystem::path MakeTempDbPath() {
     return std::filesystem::temp_directory_path() / name;
 }
 
+void PutObjects(nebulafs::metadata::MetadataStore& store, const std::string& bucket,
+                const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = name;
+        meta.etag = "etag-" + name;
+        ASSERT_TRUE(store.UpsertObject(bucket, meta).ok());
+    }
+}
+
+void RemoveDb(const std::filesystem::path& db_path) {
+    std::filesystem::remove(db_path);
+    std::filesystem::remove(db_path.string() + "-wal");
+    std::filesystem::remove(db_path.string() + "-shm");
+}
+
 }  // namespace
 
 TEST(MetadataStore, CreateAndFetchBucket) {
@@ -30,6 +54,30 @@ TEST(MetadataStore, CreateAndFetchBucket) {
     std::filesystem::remove(db_path);
 }
 
+TEST(MetadataStore, WritesUseTheCallersClockOverride) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        nebulafs::core::ScopedClockOverride outer("2021-03-04T05:06:07Z");
+        {
+            nebulafs::core::ScopedClockOverride inner("2022-01-01T00:00:00Z");
+            EXPECT_EQ(nebulafs::core::NowIso8601(), "2022-01-01T00:00:00Z");
+        }
+        // The write runs on the store's writer thread but keeps this thread's override.
+        auto created = store.CreateBucket("alpha");
+        ASSERT_TRUE(created.ok());
+        EXPECT_EQ(created.value().created_at, "2021-03-04T05:06:07Z");
+
+        std::string other_now;
+        std::thread([&] { other_now = nebulafs::core::NowIso8601(); }).join();
+        EXPECT_NE(other_now, "2021-03-04T05:06:07Z");
+    }
+    EXPECT_FALSE(nebulafs::core::ClockOverride().has_value());
+
+    RemoveDb(db_path);
+}
+
 TEST(MetadataStore, UpsertObject) {
     const auto db_path = MakeTempDbPath();
 
@@ -53,6 +101,89 @@ TEST(MetadataStore, UpsertObject) {
     std::filesystem::remove(db_path);
 }
 
+TEST(MetadataStore, InlineDataFollowsUpsertsAndStaysOutOfListings) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        store.CreateBucket("beta");
+
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = "tiny.txt";
+        meta.size_bytes = 5;
+        meta.etag = "etag";
+        meta.inline_data = std::string("he\0lo", 5);
+        ASSERT_TRUE(store.UpsertObject("beta", meta).ok());
+
+        auto fetched = store.GetObject("beta", "tiny.txt");
+        ASSERT_TRUE(fetched.ok());
+        ASSERT_TRUE(fetched.value().inline_data.has_value());
+        EXPECT_EQ(*fetched.value().inline_data, std::string("he\0lo", 5));
+        auto listed = store.ListObjects("beta", "");
+        ASSERT_TRUE(listed.ok());
+        ASSERT_EQ(listed.value().size(), 1u);
+        EXPECT_FALSE(listed.value()[0].inline_data.has_value());
+
+        // A rewrite that went to a file clears the bytes kept in the row.
+        meta.inline_data.reset();
+        ASSERT_TRUE(store.UpsertObject("beta", meta).ok());
+        fetched = store.GetObject("beta", "tiny.txt");
+        ASSERT_TRUE(fetched.ok());
+        EXPECT_FALSE(fetched.value().inline_data.has_value());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, CopiesCarryInlineBodiesWithTheRow) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("beta").ok());
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = "tiny.txt";
+        meta.size_bytes = 5;
+        meta.etag = "etag";
+        meta.inline_data = std::string("he\0lo", 5);
+        ASSERT_TRUE(store.UpsertObject("beta", meta).ok());
+        meta.name = "file.txt";
+        meta.inline_data.reset();
+        ASSERT_TRUE(store.UpsertObject("beta", meta).ok());
+
+        // A move copies the row with its body and drops the source in the same batch.
+        BatchOp copy;
+        copy.type = BatchOpType::kCopyObject;
+        copy.bucket = "beta";
+        copy.object_name = "moved.txt";
+        copy.source_bucket = "beta";
+        copy.source_object = "tiny.txt";
+        BatchOp remove;
+        remove.type = BatchOpType::kDeleteObject;
+        remove.bucket = "beta";
+        remove.object_name = "tiny.txt";
+        auto moved = store.ExecuteBatch({copy, remove});
+        ASSERT_TRUE(moved.ok()) << moved.error().message;
+        EXPECT_TRUE(moved.value()[1].removed);
+        auto fetched = store.GetObject("beta", "moved.txt");
+        ASSERT_TRUE(fetched.ok());
+        EXPECT_EQ(fetched.value().etag, "etag");
+        EXPECT_EQ(fetched.value().inline_data.value_or(""), std::string("he\0lo", 5));
+        EXPECT_FALSE(store.GetObject("beta", "tiny.txt").ok());
+
+        // A row whose body is in a file has nothing the batch could copy.
+        copy.source_object = "file.txt";
+        auto rejected = store.ExecuteBatch({copy});
+        ASSERT_FALSE(rejected.ok());
+        EXPECT_EQ(rejected.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_TRUE(store.GetObject("beta", "moved.txt").value().inline_data.has_value());
+    }
+
+    RemoveDb(db_path);
+}
+
 TEST(MetadataStore, MultipartUploadLifecycle) {
     const auto db_path = MakeTempDbPath();
 
@@ -84,6 +215,18 @@ TEST(MetadataStore, MultipartUploadLifecycle) {
         auto fetched = store.GetMultipartUpload(upload_id);
         ASSERT_TRUE(fetched.ok());
         EXPECT_EQ(fetched.value().state, "uploading");
+        EXPECT_EQ(fetched.value().part_size, 0u);
+
+        nebulafs::metadata::BatchOp set_size;
+        set_size.type = nebulafs::metadata::BatchOpType::kSetMultipartPartSize;
+        set_size.upload_id = upload_id;
+        set_size.part_size = 8u << 20;
+        ASSERT_TRUE(store.ExecuteBatch({set_size}).ok());
+        EXPECT_EQ(store.GetMultipartUpload(upload_id).value().part_size, 8u << 20);
+        set_size.upload_id = "missing";
+        auto set_missing = store.ExecuteBatch({set_size});
+        ASSERT_FALSE(set_missing.ok());
+        EXPECT_EQ(set_missing.error().code, nebulafs::core::ErrorCode::kNotFound);
 
         auto delete_parts = store.DeleteMultipartParts(upload_id);
         ASSERT_TRUE(delete_parts.ok());
@@ -100,6 +243,46 @@ TEST(MetadataStore, MultipartUploadLifecycle) {
     std::filesystem::remove(db_path);
 }
 
+TEST(MetadataStore, CreatesUploadWithPartSizeInOneBatch) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("alpha").ok());
+
+        nebulafs::metadata::BatchOp create;
+        create.type = nebulafs::metadata::BatchOpType::kCreateMultipartUpload;
+        create.bucket = "alpha";
+        create.object_name = "big.bin";
+        create.upload_id = "up-1";
+        create.expires_at = "2099-01-01T00:00:00Z";
+        nebulafs::metadata::BatchOp set_size;
+        set_size.type = nebulafs::metadata::BatchOpType::kSetMultipartPartSize;
+        set_size.upload_id = "up-1";
+        set_size.part_size = 8u << 20;
+        auto created = store.ExecuteBatch({create, set_size});
+        ASSERT_TRUE(created.ok());
+        EXPECT_EQ(created.value()[0].upload.state, "initiated");
+        EXPECT_EQ(created.value()[0].upload.object_name, "big.bin");
+        EXPECT_EQ(store.GetMultipartUpload("up-1").value().part_size, 8u << 20);
+
+        // A failing op later in the batch takes the new upload with it.
+        create.upload_id = "up-2";
+        set_size.upload_id = "missing";
+        auto failed = store.ExecuteBatch({create, set_size});
+        ASSERT_FALSE(failed.ok());
+        EXPECT_EQ(failed.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_FALSE(store.GetMultipartUpload("up-2").ok());
+
+        create.upload_id = "up-1";
+        auto duplicate = store.ExecuteBatch({create});
+        ASSERT_FALSE(duplicate.ok());
+        EXPECT_EQ(duplicate.error().code, nebulafs::core::ErrorCode::kAlreadyExists);
+    }
+
+    std::filesystem::remove(db_path);
+}
+
 TEST(MetadataStore, ListExpiredMultipartUploads) {
     const auto db_path = MakeTempDbPath();
 
@@ -125,7 +308,862 @@ TEST(MetadataStore, ListExpiredMultipartUploads) {
         ASSERT_TRUE(expired.ok());
         ASSERT_EQ(expired.value().size(), 1);
         EXPECT_EQ(expired.value()[0].upload_id, "expired-1");
+
+        // A sweep that retired an upload but failed to delete it finds it again.
+        ASSERT_TRUE(store.UpdateMultipartUploadState("expired-1", "expired").ok());
+        expired = store.ListExpiredMultipartUploads("2020-01-01T00:00:00Z", 10);
+        ASSERT_TRUE(expired.ok());
+        ASSERT_EQ(expired.value().size(), 1);
+        EXPECT_EQ(expired.value()[0].state, "expired");
+    }
+
+    {
+        // "expired" has a state code like every other state.
+        nebulafs::metadata::SqliteConnection db(db_path.string(), true);
+        auto state = db.Query(
+            "SELECT typeof(state), state FROM multipart_uploads WHERE upload_id = 'expired-1'");
+        ASSERT_TRUE(state.Next());
+        EXPECT_EQ(state.Text(0), "integer");
+        EXPECT_EQ(state.Int(1), 5);
     }
 
     std::filesystem::remove(db_path);
 }
+
+TEST(MetadataStore, ConcurrentReadersSeeCommittedWrites) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string(), 4);
+        ASSERT_TRUE(store.CreateBucket("concurrent").ok());
+
+        constexpr int kObjects = 200;
+        std::atomic<bool> writer_done{false};
+        std::atomic<int> failures{0};
+
+        std::thread writer([&] {
+            for (int i = 0; i < kObjects; ++i) {
+                nebulafs::metadata::ObjectMetadata meta;
+                meta.name = "obj-" + std::to_string(i);
+                meta.size_bytes = static_cast<std::uint64_t>(i);
+                meta.etag = "etag";
+                if (!store.UpsertObject("concurrent", meta).ok()) {
+                    ++failures;
+                }
+            }
+            writer_done = true;
+        });
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&] {
+                while (!writer_done) {
+                    if (!store.GetBucket("concurrent").ok() ||
+                        !store.ListObjects("concurrent", "obj-").ok()) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+
+        writer.join();
+        for (auto& reader : readers) {
+            reader.join();
+        }
+
+        EXPECT_EQ(failures.load(), 0);
+        auto listed = store.ListObjects("concurrent", "obj-");
+        ASSERT_TRUE(listed.ok());
+        EXPECT_EQ(listed.value().size(), static_cast<std::size_t>(kObjects));
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, WorksWithoutReaderPool) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string(), 0);
+        ASSERT_TRUE(store.CreateBucket("serial").ok());
+        auto fetched = store.GetBucket("serial");
+        ASSERT_TRUE(fetched.ok());
+        EXPECT_EQ(fetched.value().name, "serial");
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, GroupCommitIsolatesFailingWrites) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("group").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a"}).ok());
+
+        constexpr int kThreads = 8;
+        constexpr int kWritesPerThread = 50;
+        std::atomic<int> failures{0};
+        std::atomic<int> expected_failures{0};
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < kWritesPerThread; ++i) {
+                    const auto name = "obj-" + std::to_string(t) + "-" + std::to_string(i);
+                    // Every tenth write references a missing node; its foreign-key failure
+                    // must roll back only its own rows, not the writes sharing its commit.
+                    const int node_id = i % 10 == 0 ? 999 : 1;
+                    auto committed =
+                        store.CommitWrite("group", name, "blob-" + name, 1, "etag",
+                                          {nebulafs::metadata::ReplicaTarget{node_id, 0, "x"}});
+                    if (node_id == 999) {
+                        if (committed.ok()) {
+                            ++failures;
+                        }
+                        ++expected_failures;
+                    } else if (!committed.ok()) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        EXPECT_EQ(failures.load(), 0);
+        auto listed = store.ListObjects("group", "obj-");
+        ASSERT_TRUE(listed.ok());
+        EXPECT_EQ(listed.value().size(),
+                  static_cast<std::size_t>(kThreads * kWritesPerThread - expected_failures));
+        EXPECT_FALSE(store.GetObject("group", "obj-0-0").ok());
+        EXPECT_TRUE(store.ResolveRead("group", "obj-0-1").ok());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, CommitWriteAndResolveRead) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("dist").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+
+        auto plan = store.AllocateWrite("dist", "blob.bin", 2, "token");
+        ASSERT_TRUE(plan.ok());
+        ASSERT_EQ(plan.value().replicas.size(), 2u);
+        ASSERT_TRUE(store.CommitWrite("dist", "blob.bin", plan.value().blob_id, 9, "etag-x",
+                                      plan.value().replicas)
+                        .ok());
+
+        // Reconfiguring nodes on restart must keep existing replica rows readable.
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+
+        auto read = store.ResolveRead("dist", "blob.bin");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, plan.value().blob_id);
+        EXPECT_EQ(read.value().size_bytes, 9u);
+        EXPECT_EQ(read.value().etag, "etag-x");
+        ASSERT_EQ(read.value().replicas.size(), 2u);
+        EXPECT_EQ(read.value().replicas[0].endpoint, "http://node-a");
+
+        auto missing = store.ResolveRead("dist", "absent.bin");
+        ASSERT_FALSE(missing.ok());
+        EXPECT_EQ(missing.error().code, nebulafs::core::ErrorCode::kNotFound);
+
+        auto no_bucket = store.AllocateWrite("nope", "blob.bin", 2, "token");
+        ASSERT_FALSE(no_bucket.ok());
+        EXPECT_EQ(no_bucket.error().code, nebulafs::core::ErrorCode::kNotFound);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, ExecuteBatchIsAtomicAndConditional) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("dist").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("dist", "up-1", "big.bin", "2099-01-01").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 5, "p1", "loc-1").ok());
+
+        std::vector<BatchOp> lookup(4);
+        lookup[0].type = BatchOpType::kGetBucket;
+        lookup[0].bucket = "dist";
+        lookup[1].type = BatchOpType::kGetMultipartUpload;
+        lookup[1].upload_id = "up-1";
+        lookup[2].type = BatchOpType::kListMultipartParts;
+        lookup[2].upload_id = "up-1";
+        lookup[3].type = BatchOpType::kAllocateWrite;
+        lookup[3].bucket = "dist";
+        lookup[3].upload_id = "up-1";
+        lookup[3].replication_factor = 2;
+        lookup[3].service_token = "token";
+        auto looked_up = store.ExecuteBatch(lookup);
+        ASSERT_TRUE(looked_up.ok()) << looked_up.error().message;
+        EXPECT_EQ(looked_up.value()[1].upload.bucket_id, looked_up.value()[0].bucket.id);
+        ASSERT_EQ(looked_up.value()[2].parts.size(), 1u);
+        const auto plan = looked_up.value()[3].write_plan;
+        ASSERT_EQ(plan.replicas.size(), 2u);
+
+        BatchOp commit;
+        commit.type = BatchOpType::kCommitWrite;
+        commit.bucket = "dist";
+        commit.upload_id = "up-1";
+        commit.blob_id = plan.blob_id;
+        commit.size_bytes = 5;
+        commit.etag = "etag-big";
+        commit.replicas = plan.replicas;
+        BatchOp delete_parts;
+        delete_parts.type = BatchOpType::kDeleteMultipartParts;
+        delete_parts.upload_id = "up-1";
+        BatchOp delete_upload;
+        delete_upload.type = BatchOpType::kDeleteMultipartUpload;
+        delete_upload.upload_id = "up-1";
+
+        // An unmet condition rejects the whole batch before anything changes.
+        commit.expect_upload_state = "completed";
+        auto stale = store.ExecuteBatch({commit, delete_parts, delete_upload});
+        ASSERT_FALSE(stale.ok());
+        EXPECT_EQ(stale.error().code, nebulafs::core::ErrorCode::kFailedPrecondition);
+        EXPECT_NE(stale.error().message.find("batch op 0"), std::string::npos);
+
+        // A failure after earlier writes rolls those writes back.
+        BatchOp missing;
+        missing.type = BatchOpType::kUpdateMultipartUploadState;
+        missing.upload_id = "absent";
+        missing.state = "completed";
+        auto partial = store.ExecuteBatch({delete_parts, missing});
+        ASSERT_FALSE(partial.ok());
+        EXPECT_EQ(partial.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_EQ(store.ListMultipartParts("up-1").value().size(), 1u);
+
+        commit.expect_upload_state = "initiated";
+        auto committed = store.ExecuteBatch({commit, delete_parts, delete_upload});
+        ASSERT_TRUE(committed.ok()) << committed.error().message;
+        auto read = store.ResolveRead("dist", "big.bin");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, plan.blob_id);
+        EXPECT_FALSE(store.GetMultipartUpload("up-1").ok());
+        EXPECT_TRUE(store.ListMultipartParts("up-1").value().empty());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, CommitManifestStoresSegmentsInOrder) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("dist").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("dist", "up-1", "big.bin", "2099-01-01").ok());
+
+        BatchOp commit;
+        commit.type = BatchOpType::kCommitManifest;
+        commit.bucket = "dist";
+        commit.upload_id = "up-1";
+        commit.expect_upload_state = "initiated";
+        commit.size_bytes = 12;
+        commit.etag = "etag-composite-2";
+        commit.segments = {{"blob-1", 0, 5, "p1", {{0, 0, "http://node-b"}, {0, 1, "http://node-a"}}},
+                           {"blob-2", 5, 7, "p2", {{0, 0, "http://node-a"}}}};
+
+        // Segments must tile the object, and every node they name must be registered.
+        BatchOp gap = commit;
+        gap.segments[1].offset = 6;
+        auto rejected = store.ExecuteBatch({gap});
+        ASSERT_FALSE(rejected.ok());
+        EXPECT_EQ(rejected.error().code, nebulafs::core::ErrorCode::kInvalidArgument);
+        BatchOp stranger = commit;
+        stranger.segments[1].replicas[0].endpoint = "http://node-z";
+        auto unknown = store.ExecuteBatch({stranger});
+        ASSERT_FALSE(unknown.ok());
+        EXPECT_EQ(unknown.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_FALSE(store.GetObject("dist", "big.bin").ok());
+
+        ASSERT_TRUE(store.ExecuteBatch({commit}).ok());
+        auto read = store.ResolveRead("dist", "big.bin");
+        ASSERT_TRUE(read.ok()) << read.error().message;
+        EXPECT_TRUE(read.value().blob_id.empty());
+        EXPECT_TRUE(read.value().replicas.empty());
+        EXPECT_EQ(read.value().size_bytes, 12u);
+        EXPECT_EQ(read.value().etag, "etag-composite-2");
+        ASSERT_EQ(read.value().segments.size(), 2u);
+        EXPECT_EQ(read.value().segments[0].blob_id, "blob-1");
+        EXPECT_EQ(read.value().segments[0].etag, "p1");
+        ASSERT_EQ(read.value().segments[0].replicas.size(), 2u);
+        EXPECT_EQ(read.value().segments[0].replicas[0].endpoint, "http://node-b");
+        EXPECT_EQ(read.value().segments[0].replicas[1].endpoint, "http://node-a");
+        EXPECT_EQ(read.value().segments[1].offset, 5u);
+        EXPECT_EQ(read.value().segments[1].size_bytes, 7u);
+        EXPECT_EQ(store.GetObject("dist", "big.bin").value().size_bytes, 12u);
+
+        // A plain write over the object replaces its manifest.
+        ASSERT_TRUE(
+            store.CommitWrite("dist", "big.bin", "blob-3", 4, "etag-3", {{1, 0, ""}}).ok());
+        read = store.ResolveRead("dist", "big.bin");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, "blob-3");
+        EXPECT_TRUE(read.value().segments.empty());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, CopiesShareBlobsUntilTheLastDelete) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("dist").ok());
+        ASSERT_TRUE(store.CreateBucket("other").ok());
+        ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a", "http://node-b"}).ok());
+        ASSERT_TRUE(store.CommitWrite("dist", "a.bin", "blob-1", 9, "etag-1",
+                                      {{1, 0, ""}, {2, 1, ""}})
+                        .ok());
+
+        BatchOp copy;
+        copy.type = BatchOpType::kCopyObject;
+        copy.bucket = "other";
+        copy.object_name = "b.bin";
+        copy.source_bucket = "dist";
+        copy.source_object = "a.bin";
+        auto copied = store.ExecuteBatch({copy});
+        ASSERT_TRUE(copied.ok()) << copied.error().message;
+        EXPECT_EQ(copied.value()[0].read_plan.blob_id, "blob-1");
+        auto read = store.ResolveRead("other", "b.bin");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, "blob-1");
+        EXPECT_EQ(read.value().etag, "etag-1");
+        EXPECT_EQ(read.value().size_bytes, 9u);
+        ASSERT_EQ(read.value().replicas.size(), 2u);
+        EXPECT_EQ(read.value().replicas[1].endpoint, "http://node-b");
+
+        BatchOp missing = copy;
+        missing.source_object = "absent.bin";
+        auto rejected = store.ExecuteBatch({missing});
+        ASSERT_FALSE(rejected.ok());
+        EXPECT_EQ(rejected.error().code, nebulafs::core::ErrorCode::kNotFound);
+
+        // A move is a copy and a delete in one batch; the delete still sees the copy.
+        BatchOp remove;
+        remove.type = BatchOpType::kDeleteObject;
+        remove.bucket = "dist";
+        remove.object_name = "a.bin";
+        BatchOp moved = copy;
+        moved.bucket = "dist";
+        moved.object_name = "c.bin";
+        auto renamed = store.ExecuteBatch({moved, remove});
+        ASSERT_TRUE(renamed.ok()) << renamed.error().message;
+        EXPECT_EQ(renamed.value()[1].blob_references, 2u);
+        EXPECT_FALSE(store.GetObject("dist", "a.bin").ok());
+
+        remove.object_name = "c.bin";
+        auto first = store.ExecuteBatch({remove});
+        ASSERT_TRUE(first.ok());
+        EXPECT_EQ(first.value()[0].blob_references, 1u);
+        remove.bucket = "other";
+        remove.object_name = "b.bin";
+        auto last = store.ExecuteBatch({remove});
+        ASSERT_TRUE(last.ok());
+        EXPECT_EQ(last.value()[0].blob_references, 0u);
+        EXPECT_EQ(last.value()[0].read_plan.blob_id, "blob-1");
+        ASSERT_EQ(last.value()[0].read_plan.replicas.size(), 2u);
+
+        EXPECT_TRUE(last.value()[0].removed);
+
+        // Deleting what is already gone succeeds and names no blobs.
+        auto again = store.ExecuteBatch({remove});
+        ASSERT_TRUE(again.ok());
+        EXPECT_TRUE(again.value()[0].read_plan.replicas.empty());
+        EXPECT_FALSE(again.value()[0].removed);
+
+        // Composite objects copy their manifests.
+        ASSERT_TRUE(store.CreateMultipartUpload("dist", "up-1", "big.bin", "2099-01-01").ok());
+        BatchOp manifest;
+        manifest.type = BatchOpType::kCommitManifest;
+        manifest.bucket = "dist";
+        manifest.upload_id = "up-1";
+        manifest.size_bytes = 12;
+        manifest.etag = "etag-composite-2";
+        manifest.segments = {{"blob-2", 0, 5, "p1", {{0, 0, "http://node-a"}}},
+                             {"blob-3", 5, 7, "p2", {{0, 0, "http://node-b"}}}};
+        ASSERT_TRUE(store.ExecuteBatch({manifest}).ok());
+        copy.source_object = "big.bin";
+        ASSERT_TRUE(store.ExecuteBatch({copy}).ok());
+        read = store.ResolveRead("other", "b.bin");
+        ASSERT_TRUE(read.ok());
+        ASSERT_EQ(read.value().segments.size(), 2u);
+        EXPECT_EQ(read.value().segments[1].blob_id, "blob-3");
+        EXPECT_EQ(read.value().segments[1].replicas[0].endpoint, "http://node-b");
+        auto shared = store.ExecuteBatch({remove});
+        ASSERT_TRUE(shared.ok());
+        EXPECT_EQ(shared.value()[0].blob_references, 1u);
+        ASSERT_EQ(shared.value()[0].read_plan.segments.size(), 2u);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, BatchDeletesReportWhichObjectsExisted) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("logs").ok());
+        // Single-node rows name no blobs, so only the row count tells what was there.
+        PutObjects(store, "logs", {"a.log", "b.log", "c.log"});
+
+        std::vector<BatchOp> ops;
+        for (const auto* name : {"a.log", "missing.log", "c.log", "a.log"}) {
+            BatchOp remove;
+            remove.type = BatchOpType::kDeleteObject;
+            remove.bucket = "logs";
+            remove.object_name = name;
+            ops.push_back(remove);
+        }
+        auto removed = store.ExecuteBatch(ops);
+        ASSERT_TRUE(removed.ok()) << removed.error().message;
+        ASSERT_EQ(removed.value().size(), 4u);
+        EXPECT_TRUE(removed.value()[0].removed);
+        EXPECT_FALSE(removed.value()[1].removed);
+        EXPECT_TRUE(removed.value()[2].removed);
+        EXPECT_FALSE(removed.value()[3].removed);
+        EXPECT_EQ(store.ListObjects("logs", "").value().size(), 1u);
+
+        ops.resize(1);
+        ops[0].bucket = "absent";
+        auto rejected = store.ExecuteBatch(ops);
+        ASSERT_FALSE(rejected.ok());
+        EXPECT_EQ(rejected.error().code, nebulafs::core::ErrorCode::kNotFound);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, LeasesFenceFormerHolders) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    BatchOp acquire;
+    acquire.type = BatchOpType::kAcquireLease;
+    acquire.lease = "cleanup/multipart";
+    acquire.lease_holder = "gw-a";
+    acquire.lease_ttl_ms = 1000;
+    acquire.now_ms = 10000;
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        auto first = store.ExecuteBatch({acquire});
+        ASSERT_TRUE(first.ok()) << first.error().message;
+        const auto held = first.value()[0].lease;
+        EXPECT_EQ(held.fencing_token, 1u);
+        EXPECT_EQ(held.expires_at_ms, 11000u);
+
+        // Another holder waits out the term; the holder itself renews under the same token.
+        BatchOp rival = acquire;
+        rival.lease_holder = "gw-b";
+        rival.now_ms = 10500;
+        auto refused = store.ExecuteBatch({rival});
+        ASSERT_FALSE(refused.ok());
+        EXPECT_EQ(refused.error().code, nebulafs::core::ErrorCode::kFailedPrecondition);
+        acquire.now_ms = 10600;
+        EXPECT_EQ(store.ExecuteBatch({acquire}).value()[0].lease.fencing_token, 1u);
+
+        rival.now_ms = 12000;
+        auto taken = store.ExecuteBatch({rival});
+        ASSERT_TRUE(taken.ok()) << taken.error().message;
+        EXPECT_EQ(taken.value()[0].lease.fencing_token, 2u);
+
+        // The former holder's writes are refused as a whole.
+        ASSERT_TRUE(store.CreateBucket("dist").ok());
+        ASSERT_TRUE(store.CreateMultipartUpload("dist", "up-1", "big.bin", "2099-01-01").ok());
+        auto check = nebulafs::metadata::LeaseCheckOp(held);
+        check.now_ms = 12000;
+        BatchOp delete_upload;
+        delete_upload.type = BatchOpType::kDeleteMultipartUpload;
+        delete_upload.upload_id = "up-1";
+        auto fenced = store.ExecuteBatch({check, delete_upload});
+        ASSERT_FALSE(fenced.ok());
+        EXPECT_EQ(fenced.error().code, nebulafs::core::ErrorCode::kFailedPrecondition);
+        EXPECT_TRUE(store.GetMultipartUpload("up-1").ok());
+
+        check = nebulafs::metadata::LeaseCheckOp(taken.value()[0].lease);
+        check.now_ms = 12000;
+        ASSERT_TRUE(store.ExecuteBatch({check, delete_upload}).ok());
+        EXPECT_FALSE(store.GetMultipartUpload("up-1").ok());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, BucketStatsFollowWritesAndRepair) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+
+    BatchOp get;
+    get.type = BatchOpType::kGetBucketStats;
+    get.bucket = "stats";
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("stats").ok());
+        ASSERT_TRUE(store.CreateBucket("other").ok());
+        nebulafs::metadata::ObjectMetadata object;
+        object.name = "a.txt";
+        object.size_bytes = 10;
+        object.etag = "etag-a";
+        ASSERT_TRUE(store.UpsertObject("stats", object).ok());
+        object.size_bytes = 4;
+        ASSERT_TRUE(store.UpsertObject("stats", object).ok());
+        object.name = "b.txt";
+        object.size_bytes = 7;
+        ASSERT_TRUE(store.UpsertObject("stats", object).ok());
+        ASSERT_TRUE(store.UpsertObject("other", object).ok());
+        ASSERT_TRUE(store.DeleteObject("stats", "b.txt").ok());
+
+        ASSERT_TRUE(store.CreateMultipartUpload("stats", "up-1", "big.bin", "2099-01-01").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 1, 5, "e1", "/tmp/p1").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 2, 6, "e2", "/tmp/p2").ok());
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", 2, 8, "e2", "/tmp/p2").ok());
+
+        auto stats = store.ExecuteBatch({get});
+        ASSERT_TRUE(stats.ok());
+        EXPECT_EQ(stats.value()[0].stats.object_count, 1u);
+        EXPECT_EQ(stats.value()[0].stats.total_bytes, 4u);
+        EXPECT_EQ(stats.value()[0].stats.multipart_bytes, 13u);
+
+        // An upload's parts leave the counters with it, through the cascade.
+        ASSERT_TRUE(store.DeleteMultipartUpload("up-1").ok());
+        EXPECT_EQ(store.ExecuteBatch({get}).value()[0].stats.multipart_bytes, 0u);
+
+        get.bucket = "missing";
+        auto missing = store.ExecuteBatch({get});
+        ASSERT_FALSE(missing.ok());
+        EXPECT_EQ(missing.error().code, nebulafs::core::ErrorCode::kNotFound);
+        get.bucket = "stats";
+    }
+
+    {
+        nebulafs::metadata::SqliteConnection db(db_path.string(), false);
+        db.Execute("UPDATE bucket_stats SET object_count = 99, total_bytes = 0");
+    }
+
+    nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+    BatchOp repair = get;
+    repair.type = BatchOpType::kRepairBucketStats;
+    auto repaired = store.ExecuteBatch({get, repair});
+    ASSERT_TRUE(repaired.ok());
+    EXPECT_EQ(repaired.value()[0].stats.object_count, 99u);
+    EXPECT_EQ(repaired.value()[1].stats.object_count, 1u);
+    EXPECT_EQ(repaired.value()[1].stats.total_bytes, 4u);
+    // Only the named bucket is recounted.
+    get.bucket = "other";
+    EXPECT_EQ(store.ExecuteBatch({get}).value()[0].stats.object_count, 99u);
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, ListMultipartPartsPagesFromMarker) {
+    using nebulafs::metadata::BatchOp;
+    using nebulafs::metadata::BatchOpType;
+    const auto db_path = MakeTempDbPath();
+    nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+    ASSERT_TRUE(store.CreateBucket("parts").ok());
+    ASSERT_TRUE(store.CreateMultipartUpload("parts", "up-1", "big.bin", "2099-01-01").ok());
+    for (int part = 1; part <= 5; ++part) {
+        ASSERT_TRUE(store.UpsertMultipartPart("up-1", part * 2, 1, "e", "/tmp/p").ok());
+    }
+
+    BatchOp list;
+    list.type = BatchOpType::kListMultipartParts;
+    list.upload_id = "up-1";
+    list.part_number_marker = 4;
+    list.max_parts = 2;
+    auto page = store.ExecuteBatch({list});
+    ASSERT_TRUE(page.ok());
+    ASSERT_EQ(page.value()[0].parts.size(), 2u);
+    EXPECT_EQ(page.value()[0].parts[0].part_number, 6);
+    EXPECT_EQ(page.value()[0].parts[1].part_number, 8);
+
+    // The marker need not name an uploaded part, and no limit means the rest of the list.
+    list.part_number_marker = 7;
+    list.max_parts = 0;
+    page = store.ExecuteBatch({list});
+    ASSERT_TRUE(page.ok());
+    ASSERT_EQ(page.value()[0].parts.size(), 2u);
+    EXPECT_EQ(page.value()[0].parts[0].part_number, 8);
+    EXPECT_EQ(store.ListMultipartParts("up-1").value().size(), 5u);
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, DeleteObjectReportsMissingBucket) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("gamma").ok());
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = "gone.txt";
+        meta.etag = "etag";
+        ASSERT_TRUE(store.UpsertObject("gamma", meta).ok());
+
+        ASSERT_TRUE(store.DeleteObject("gamma", "gone.txt").ok());
+        EXPECT_FALSE(store.GetObject("gamma", "gone.txt").ok());
+        EXPECT_TRUE(store.DeleteObject("gamma", "gone.txt").ok());
+
+        auto missing_bucket = store.DeleteObject("nope", "gone.txt");
+        ASSERT_FALSE(missing_bucket.ok());
+        EXPECT_EQ(missing_bucket.error().code, nebulafs::core::ErrorCode::kNotFound);
+        EXPECT_FALSE(store.UpsertObject("nope", meta).ok());
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, ListObjectsPagesWithCursor) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("pages").ok());
+        ASSERT_TRUE(store.CreateBucket("pages-other").ok());
+        PutObjects(store, "pages", {"a1", "a2", "a3", "b1", "A0"});
+        PutObjects(store, "pages-other", {"a0"});
+
+        nebulafs::metadata::ListObjectsOptions options;
+        options.prefix = "a";
+        options.max_keys = 2;
+        std::vector<std::string> names;
+        int pages = 0;
+        while (true) {
+            auto page = store.ListObjectsPage("pages", options);
+            ASSERT_TRUE(page.ok());
+            ++pages;
+            for (const auto& object : page.value().objects) {
+                names.push_back(object.name);
+            }
+            if (!page.value().is_truncated) {
+                EXPECT_TRUE(page.value().next_cursor.empty());
+                break;
+            }
+            auto token = nebulafs::metadata::EncodeListCursor(page.value().next_cursor);
+            auto cursor = nebulafs::metadata::DecodeListCursor(token);
+            ASSERT_TRUE(cursor.has_value());
+            options.cursor = *cursor;
+        }
+        // Range scans are case-sensitive and bucket-scoped, unlike the old LIKE match.
+        EXPECT_EQ(names, (std::vector<std::string>{"a1", "a2", "a3"}));
+        EXPECT_EQ(pages, 2);
+
+        auto all = store.ListObjects("pages", "a");
+        ASSERT_TRUE(all.ok());
+        EXPECT_EQ(all.value().size(), 3u);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, ListObjectsRollsUpCommonPrefixes) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("tree").ok());
+        PutObjects(store, "tree",
+                   {"logs.2024.01", "logs.2024.02", "logs.2025.01", "logs.readme", "notes",
+                    "photos.1", "photos.2"});
+
+        nebulafs::metadata::ListObjectsOptions options;
+        options.delimiter = ".";
+        auto top = store.ListObjectsPage("tree", options);
+        ASSERT_TRUE(top.ok());
+        ASSERT_EQ(top.value().objects.size(), 1u);
+        EXPECT_EQ(top.value().objects[0].name, "notes");
+        EXPECT_EQ(top.value().common_prefixes, (std::vector<std::string>{"logs.", "photos."}));
+        EXPECT_FALSE(top.value().is_truncated);
+
+        options.prefix = "logs.";
+        options.max_keys = 2;
+        auto first = store.ListObjectsPage("tree", options);
+        ASSERT_TRUE(first.ok());
+        EXPECT_EQ(first.value().common_prefixes,
+                  (std::vector<std::string>{"logs.2024.", "logs.2025."}));
+        EXPECT_TRUE(first.value().is_truncated);
+
+        options.cursor = first.value().next_cursor;
+        auto second = store.ListObjectsPage("tree", options);
+        ASSERT_TRUE(second.ok());
+        EXPECT_TRUE(second.value().common_prefixes.empty());
+        ASSERT_EQ(second.value().objects.size(), 1u);
+        EXPECT_EQ(second.value().objects[0].name, "logs.readme");
+        EXPECT_FALSE(second.value().is_truncated);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, MigratesV1DatabasesInPlace) {
+    const auto db_path = MakeTempDbPath();
+    const std::string upload_id = "0f8e2c4a-5b7d-4e1f-9a3c-6d2b8e0f1a7c";
+    const std::string etag(64, 'a');
+
+    {
+        nebulafs::metadata::SqliteConnection v1(db_path.string(), false);
+        nebulafs::metadata::CreateSchemaV1(v1);
+        v1.Execute("INSERT INTO buckets(id, name, created_at) "
+                   "VALUES(1, 'legacy', '2024-01-02T03:04:05Z')");
+        v1.Execute("INSERT INTO objects(id, bucket_id, name, size_bytes, etag, created_at, "
+                   "updated_at) VALUES(1, 1, 'a.txt', 5, '" + etag +
+                   "', '2024-01-02T03:04:05Z', '2024-01-02T03:04:06Z')");
+        v1.Execute("INSERT INTO objects(id, bucket_id, name, size_bytes, etag, created_at, "
+                   "updated_at) VALUES(2, 1, 'b.txt', 1, 'not-hex', "
+                   "'2024-01-02T03:04:05Z', '2024-01-02T03:04:05Z')");
+        v1.Execute("INSERT INTO multipart_uploads(upload_id, bucket_id, object_name, state, "
+                   "expires_at, created_at, updated_at) VALUES('" + upload_id +
+                   "', 1, 'big.bin', 'uploading', '2000-01-01T00:00:00Z', "
+                   "'2000-01-01T00:00:00Z', '2000-01-01T00:00:00Z')");
+        v1.Execute("INSERT INTO multipart_parts(upload_id, part_number, size_bytes, etag, "
+                   "temp_path, created_at) VALUES('" + upload_id +
+                   "', 1, 3, 'abcd', '/tmp/p1', '2000-01-01T00:00:00Z')");
+        v1.Execute("INSERT INTO storage_nodes(id, endpoint, status, updated_at) "
+                   "VALUES(1, 'http://node-a', 'active', '2024-01-01T00:00:00Z')");
+        v1.Execute("INSERT INTO object_replicas(object_id, node_id, blob_id, replica_index, "
+                   "state, checksum, updated_at) VALUES(1, 1, '" + upload_id +
+                   "', 0, 'committed', '" + etag + "', '2024-01-01T00:00:00Z')");
+    }
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        auto bucket = store.GetBucket("legacy");
+        ASSERT_TRUE(bucket.ok());
+        EXPECT_EQ(bucket.value().created_at, "2024-01-02T03:04:05Z");
+
+        auto object = store.GetObject("legacy", "a.txt");
+        ASSERT_TRUE(object.ok());
+        EXPECT_EQ(object.value().etag, etag);
+        EXPECT_EQ(object.value().updated_at, "2024-01-02T03:04:06Z");
+        EXPECT_EQ(store.GetObject("legacy", "b.txt").value().etag, "not-hex");
+
+        auto upload = store.GetMultipartUpload(upload_id);
+        ASSERT_TRUE(upload.ok());
+        EXPECT_EQ(upload.value().state, "uploading");
+        EXPECT_EQ(upload.value().part_size, 0u);
+        auto expired = store.ListExpiredMultipartUploads("2020-01-01T00:00:00Z", 10);
+        ASSERT_TRUE(expired.ok());
+        ASSERT_EQ(expired.value().size(), 1u);
+        EXPECT_EQ(expired.value()[0].upload_id, upload_id);
+        auto parts = store.ListMultipartParts(upload_id);
+        ASSERT_TRUE(parts.ok());
+        ASSERT_EQ(parts.value().size(), 1u);
+        EXPECT_EQ(parts.value()[0].etag, "abcd");
+
+        auto read = store.ResolveRead("legacy", "a.txt");
+        ASSERT_TRUE(read.ok());
+        EXPECT_EQ(read.value().blob_id, upload_id);
+        EXPECT_EQ(read.value().replicas[0].endpoint, "http://node-a");
+
+        nebulafs::metadata::BatchOp stats_op;
+        stats_op.type = nebulafs::metadata::BatchOpType::kGetBucketStats;
+        stats_op.bucket = "legacy";
+        auto stats = store.ExecuteBatch({stats_op});
+        ASSERT_TRUE(stats.ok());
+        EXPECT_EQ(stats.value()[0].stats.object_count, 2u);
+        EXPECT_EQ(stats.value()[0].stats.total_bytes, 6u);
+        EXPECT_EQ(stats.value()[0].stats.multipart_bytes, 3u);
+
+        // Foreign keys survive the table rebuild: deleting the upload cascades to its parts.
+        ASSERT_TRUE(store.DeleteMultipartUpload(upload_id).ok());
+        EXPECT_TRUE(store.ListMultipartParts(upload_id).value().empty());
+        EXPECT_EQ(store.ExecuteBatch({stats_op}).value()[0].stats.multipart_bytes, 0u);
+    }
+
+    {
+        nebulafs::metadata::SqliteConnection db(db_path.string(), true);
+        auto version = db.Query("PRAGMA user_version");
+        ASSERT_TRUE(version.Next());
+        EXPECT_EQ(version.Int(0), nebulafs::metadata::kSqliteSchemaVersion);
+        auto types = db.Query("SELECT typeof(etag), typeof(created_at) FROM objects WHERE id = 1");
+        ASSERT_TRUE(types.Next());
+        EXPECT_EQ(types.Text(0), "blob");
+        EXPECT_EQ(types.Text(1), "integer");
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, MigrationRefusesDanglingReferences) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteConnection v1(db_path.string(), false);
+        nebulafs::metadata::CreateSchemaV1(v1);
+        v1.Execute("INSERT INTO buckets(id, name, created_at) "
+                   "VALUES(1, 'legacy', '2024-01-02T03:04:05Z')");
+        v1.Execute("INSERT INTO objects(id, bucket_id, name, size_bytes, etag, created_at, "
+                   "updated_at) VALUES(1, 1, 'a.txt', 5, 'abcd', '2024-01-02T03:04:05Z', "
+                   "'2024-01-02T03:04:05Z')");
+        // Node 9 was never registered.
+        v1.Execute("INSERT INTO object_replicas(object_id, node_id, blob_id, replica_index, "
+                   "state, checksum, updated_at) VALUES(1, 9, 'blob', 0, 'committed', 'abcd', "
+                   "'2024-01-01T00:00:00Z')");
+    }
+
+    EXPECT_ANY_THROW(nebulafs::metadata::SqliteMetadataStore store(db_path.string()));
+    {
+        nebulafs::metadata::SqliteConnection db(db_path.string(), true);
+        auto version = db.Query("PRAGMA user_version");
+        ASSERT_TRUE(version.Next());
+        EXPECT_LT(version.Int(0), nebulafs::metadata::kSqliteSchemaVersion);
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(MetadataStore, RejectsUnparseableExpiry) {
+    const auto db_path = MakeTempDbPath();
+
+    {
+        nebulafs::metadata::SqliteMetadataStore store(db_path.string());
+        ASSERT_TRUE(store.CreateBucket("b").ok());
+        auto created = store.CreateMultipartUpload("b", "up-1", "o", "next tuesday");
+        ASSERT_FALSE(created.ok());
+        EXPECT_EQ(created.error().code, nebulafs::core::ErrorCode::kInvalidArgument);
+        // Short ids that are not UUIDs stay text and still round-trip.
+        ASSERT_TRUE(store.CreateMultipartUpload("b", "up-1", "o", "2099-01-01").ok());
+        auto upload = store.GetMultipartUpload("up-1");
+        ASSERT_TRUE(upload.ok());
+        EXPECT_EQ(upload.value().expires_at, "2099-01-01T00:00:00Z");
+    }
+
+    RemoveDb(db_path);
+}
+
+TEST(ObjectListing, CursorTokensRoundTripAndRejectGarbage) {
+    const std::string cursor = std::string("key") + '\0';
+    auto decoded = nebulafs::metadata::DecodeListCursor(
+        nebulafs::metadata::EncodeListCursor(cursor));
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, cursor);
+    EXPECT_FALSE(nebulafs::metadata::DecodeListCursor("v1abc").has_value());
+    EXPECT_FALSE(nebulafs::metadata::DecodeListCursor("zz").has_value());
+    EXPECT_EQ(nebulafs::metadata::PrefixUpperBound("ab"), "ac");
+    EXPECT_EQ(nebulafs::metadata::PrefixUpperBound(std::string("a\xff")), "b");
+}
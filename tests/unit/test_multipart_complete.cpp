@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Poco/DigestEngine.h>
+#include <Poco/SHA2Engine.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/core/result.h"
+#include "nebulafs/http/multipart_complete.h"
+#include "nebulafs/storage/part_assembler.h"
+
+namespace {
+
+using nebulafs::core::ErrorCode;
+using nebulafs::http::CheckInPlaceLayout;
+using nebulafs::http::MatchCompleteParts;
+using nebulafs::http::ParseCompleteParts;
+
+std::filesystem::path MakeTempDir() {
+    const auto dir = std::filesystem::temp_directory_path() /
+                     ("nebulafs_assemble_" + Poco::UUIDGenerator().createOne().toString());
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+nebulafs::metadata::MultipartPart Uploaded(int part_number, const std::string& etag,
+                                           std::uint64_t size_bytes = 0) {
+    nebulafs::metadata::MultipartPart part;
+    part.part_number = part_number;
+    part.etag = etag;
+    part.size_bytes = size_bytes;
+    return part;
+}
+
+}  // namespace
+
+TEST(MultipartComplete, ParsesPartsAndSkipsOtherKeys) {
+    auto parsed = ParseCompleteParts(
+        R"( {"note":{"a":[1,true,null,-2.5e3]},"parts":[{"etag":"a\"bé","part_number":1},)"
+        R"({"part_number":7,"extra":"x","etag":"c"}]} )");
+    ASSERT_TRUE(parsed.ok()) << parsed.error().message;
+    ASSERT_EQ(parsed.value().size(), 2u);
+    EXPECT_EQ(parsed.value()[0].part_number, 1);
+    EXPECT_EQ(parsed.value()[0].etag, "a\"b\xc3\xa9");
+    EXPECT_EQ(parsed.value()[1].part_number, 7);
+    EXPECT_EQ(parsed.value()[1].etag, "c");
+}
+
+TEST(MultipartComplete, RejectsMalformedBodies) {
+    const std::vector<std::string> bodies = {
+        "",
+        "[]",
+        "{}",
+        R"({"parts":[]})",
+        R"({"parts":{}})",
+        R"({"parts":[{"part_number":1}]})",
+        R"({"parts":[{"part_number":0,"etag":"a"}]})",
+        R"({"parts":[{"part_number":1.5,"etag":"a"}]})",
+        R"({"parts":[{"part_number":99999999999,"etag":"a"}]})",
+        R"({"parts":[{"part_number":2,"etag":"a"},{"part_number":2,"etag":"b"}]})",
+        R"({"parts":[{"part_number":1,"etag":"a"}]} trailing)",
+        R"({"parts":[{"part_number":1,"etag":"\ud800"}]})",
+        R"({"parts":[{"part_number":1,"etag":"a"})",
+        "{\"x\":" + std::string(64, '[') + std::string(64, ']') +
+            R"(,"parts":[{"part_number":1,"etag":"a"}]})",
+    };
+    for (const auto& body : bodies) {
+        auto parsed = ParseCompleteParts(body);
+        ASSERT_FALSE(parsed.ok()) << body;
+        EXPECT_EQ(parsed.error().code, ErrorCode::kInvalidArgument) << body;
+    }
+}
+
+TEST(MultipartComplete, MatchesRequestedPartsAgainstUploaded) {
+    const std::vector<nebulafs::metadata::MultipartPart> uploaded = {
+        Uploaded(1, "a"), Uploaded(2, "b"), Uploaded(3, "c"), Uploaded(5, "e")};
+
+    auto matched = MatchCompleteParts({{1, "a"}, {3, "c"}, {5, "e"}}, uploaded);
+    ASSERT_TRUE(matched.ok());
+    ASSERT_EQ(matched.value().size(), 3u);
+    EXPECT_EQ(matched.value()[1], &uploaded[2]);
+
+    auto missing = MatchCompleteParts({{1, "a"}, {4, "d"}}, uploaded);
+    ASSERT_FALSE(missing.ok());
+    EXPECT_EQ(missing.error().code, ErrorCode::kNotFound);
+    EXPECT_EQ(missing.error().message, "missing uploaded part 4");
+
+    auto mismatch = MatchCompleteParts({{2, "x"}}, uploaded);
+    ASSERT_FALSE(mismatch.ok());
+    EXPECT_EQ(mismatch.error().code, ErrorCode::kFailedPrecondition);
+}
+
+TEST(MultipartComplete, ChecksInPlaceLayoutAndBuildsCompositeEtag) {
+    const auto a = Uploaded(1, "a", 8);
+    const auto b = Uploaded(2, "b", 8);
+    const auto short_last = Uploaded(3, "c", 3);
+    const auto gap = Uploaded(4, "d", 8);
+
+    auto size = CheckInPlaceLayout({&a, &b, &short_last}, 8);
+    ASSERT_TRUE(size.ok());
+    EXPECT_EQ(size.value(), 19u);
+    // A short part may only come last, and numbering must start at 1 without gaps.
+    EXPECT_EQ(CheckInPlaceLayout({&a, &short_last, &gap}, 8).error().code,
+              ErrorCode::kFailedPrecondition);
+    EXPECT_FALSE(CheckInPlaceLayout({&b}, 8).ok());
+    EXPECT_FALSE(CheckInPlaceLayout({&a, &gap}, 8).ok());
+    EXPECT_FALSE(CheckInPlaceLayout({&a, &b}, 4).ok());
+
+    const auto etag = nebulafs::http::CompositeEtag({&a, &b, &short_last});
+    EXPECT_EQ(etag.substr(etag.size() - 2), "-3");
+    EXPECT_EQ(etag, nebulafs::http::CompositeEtag({&a, &b, &short_last}));
+}
+
+TEST(PartAssembler, WriteAtFillsOffsetsInAnyOrder) {
+    const auto dir = MakeTempDir();
+    const auto path = (dir / "object").string();
+    ASSERT_TRUE(nebulafs::storage::WriteAt(path, 8, "world").ok());
+    ASSERT_TRUE(nebulafs::storage::WriteAt(path, 0, "hello, ").ok());
+    ASSERT_TRUE(nebulafs::storage::WriteAt(path, 7, "!").ok());
+    EXPECT_EQ(ReadFile(path), "hello, !world");
+    EXPECT_FALSE(nebulafs::storage::WriteAt((dir / "missing" / "x").string(), 0, "a").ok());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PartAssembler, ConcatenatesPartsInOrderAcrossThreads) {
+    const auto dir = MakeTempDir();
+    std::vector<nebulafs::storage::PartSource> parts;
+    std::string expected;
+    for (int i = 0; i < 37; ++i) {
+        // Uneven sizes, including an empty part, so offsets are not a multiple of anything.
+        const std::string data(static_cast<std::size_t>(i * 131), static_cast<char>('a' + i % 26));
+        const auto path = dir / ("part-" + std::to_string(i));
+        std::ofstream(path, std::ios::binary) << data;
+        parts.push_back({path.string(), data.size()});
+        expected += data;
+    }
+    Poco::SHA2Engine256 sha256;
+    sha256.update(expected.data(), static_cast<unsigned int>(expected.size()));
+    const auto expected_etag = Poco::DigestEngine::digestToHex(sha256.digest());
+
+    for (const int threads : {1, 4, 64}) {
+        const auto dest = dir / ("object-" + std::to_string(threads));
+        auto assembled = nebulafs::storage::AssembleParts(parts, dest.string(), threads);
+        ASSERT_TRUE(assembled.ok()) << assembled.error().message;
+        EXPECT_EQ(assembled.value().size_bytes, expected.size());
+        EXPECT_EQ(assembled.value().etag, expected_etag);
+        EXPECT_EQ(ReadFile(dest), expected);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PartAssembler, RejectsPartsThatChangedSize) {
+    const auto dir = MakeTempDir();
+    const auto path = dir / "part-1";
+    std::ofstream(path, std::ios::binary) << "hello";
+    const auto dest = dir / "object";
+
+    auto assembled = nebulafs::storage::AssembleParts({{path.string(), 4}}, dest.string(), 2);
+    ASSERT_FALSE(assembled.ok());
+    EXPECT_EQ(assembled.error().code, ErrorCode::kIoError);
+    EXPECT_FALSE(std::filesystem::exists(dest));
+
+    assembled = nebulafs::storage::AssembleParts({{(dir / "gone").string(), 1}}, dest.string(), 1);
+    ASSERT_FALSE(assembled.ok());
+    EXPECT_FALSE(std::filesystem::exists(dest));
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,317 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/metadata/memory_metadata_store.h"
+#include "nebulafs/metadata/replicated_metadata_store.h"
+#include "nebulafs/metadata/replication_log.h"
+
+namespace {
+
+using nebulafs::metadata::ReplicatedMetadataStore;
+
+// Delivers RPCs by direct call; a "down" member neither sends nor receives.
+class LocalTransport : public nebulafs::metadata::ReplicaTransport {
+public:
+    void Add(const std::string& url, std::shared_ptr<ReplicatedMetadataStore> node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_[url] = std::move(node);
+    }
+    void Remove(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes_.erase(url);
+    }
+    void SetDown(const std::string& url, bool down) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (down) {
+            down_.insert(url);
+        } else {
+            down_.erase(url);
+        }
+    }
+
+    nebulafs::core::Result<nebulafs::metadata::VoteResponse> RequestVote(
+        const std::string& peer, const nebulafs::metadata::VoteRequest& request) override {
+        auto node = Route(request.candidate, peer);
+        if (!node) {
+            return Unreachable();
+        }
+        return node->group().HandleVote(request);
+    }
+    nebulafs::core::Result<nebulafs::metadata::HeartbeatResponse> Heartbeat(
+        const std::string& peer, const nebulafs::metadata::HeartbeatRequest& request) override {
+        auto node = Route(request.leader, peer);
+        if (!node) {
+            return Unreachable();
+        }
+        return node->group().HandleHeartbeat(request);
+    }
+    nebulafs::core::Result<nebulafs::metadata::FetchResponse> Fetch(
+        const std::string& leader, const nebulafs::metadata::FetchRequest& request) override {
+        auto node = Route(request.follower, leader);
+        if (!node) {
+            return Unreachable();
+        }
+        return node->group().HandleFetch(request);
+    }
+
+private:
+    static nebulafs::core::Error Unreachable() {
+        return nebulafs::core::Error{nebulafs::core::ErrorCode::kIoError, "unreachable"};
+    }
+
+    std::shared_ptr<ReplicatedMetadataStore> Route(const std::string& from,
+                                                   const std::string& to) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (down_.count(from) != 0 || down_.count(to) != 0) {
+            return nullptr;
+        }
+        const auto it = nodes_.find(to);
+        return it == nodes_.end() ? nullptr : it->second;
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<ReplicatedMetadataStore>> nodes_;
+    std::set<std::string> down_;
+};
+
+class ReplicaCluster {
+public:
+    explicit ReplicaCluster(int size)
+        : root_(std::filesystem::temp_directory_path() /
+                ("nebulafs_replicas_" + Poco::UUIDGenerator().createOne().toString())),
+          transport_(std::make_shared<LocalTransport>()) {
+        for (int i = 0; i < size; ++i) {
+            urls_.push_back("node-" + std::to_string(i));
+        }
+        for (const auto& url : urls_) {
+            nebulafs::metadata::ReplicaOptions options;
+            options.self_url = url;
+            for (const auto& other : urls_) {
+                if (other != url) {
+                    options.peers.push_back(other);
+                }
+            }
+            options.state_dir = (root_ / url / "replication").string();
+            options.election_timeout_ms = 150;
+            options.heartbeat_interval_ms = 30;
+            options.max_staleness_ms = 400;
+            options.commit_timeout_ms = 2000;
+            auto node = std::make_shared<ReplicatedMetadataStore>(
+                std::make_shared<nebulafs::metadata::MemoryMetadataStore>(
+                    (root_ / url / "store").string()),
+                std::move(options), transport_);
+            transport_->Add(url, node);
+            nodes_[url] = std::move(node);
+        }
+    }
+
+    ~ReplicaCluster() {
+        for (const auto& url : urls_) {
+            transport_->Remove(url);
+        }
+        nodes_.clear();
+        std::filesystem::remove_all(root_);
+    }
+
+    /// Waits for exactly one reachable leader and returns its URL.
+    std::string WaitForLeader() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::vector<std::string> leaders;
+            for (const auto& [url, node] : nodes_) {
+                if (node && !down_.count(url) && node->group().IsLeader()) {
+                    leaders.push_back(url);
+                }
+            }
+            if (leaders.size() == 1) {
+                return leaders.front();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return "";
+    }
+
+    std::vector<std::string> Followers(const std::string& leader) const {
+        std::vector<std::string> followers;
+        for (const auto& url : urls_) {
+            if (url != leader && !down_.count(url)) {
+                followers.push_back(url);
+            }
+        }
+        return followers;
+    }
+
+    ReplicatedMetadataStore& operator[](const std::string& url) { return *nodes_.at(url); }
+
+    void Isolate(const std::string& url) {
+        down_.insert(url);
+        transport_->SetDown(url, true);
+    }
+
+    void Heal(const std::string& url) {
+        down_.erase(url);
+        transport_->SetDown(url, false);
+    }
+
+private:
+    std::filesystem::path root_;
+    std::shared_ptr<LocalTransport> transport_;
+    std::vector<std::string> urls_;
+    std::map<std::string, std::shared_ptr<ReplicatedMetadataStore>> nodes_;
+    std::set<std::string> down_;
+};
+
+nebulafs::metadata::ObjectMetadata MakeObject(const std::string& name, const std::string& etag) {
+    nebulafs::metadata::ObjectMetadata object;
+    object.name = name;
+    object.size_bytes = 7;
+    object.etag = etag;
+    return object;
+}
+
+}  // namespace
+
+TEST(ReplicationLog, ReopensAfterTornTailAndForgetsCompactedEntries) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("nebulafs_rlog_" + Poco::UUIDGenerator().createOne().toString());
+    {
+        nebulafs::metadata::ReplicationLog log(path.string(), 2);
+        for (std::uint64_t i = 1; i <= 6; ++i) {
+            ASSERT_TRUE(log.Append({{i, i < 4 ? 1u : 2u, "op-" + std::to_string(i)}}).ok());
+        }
+        EXPECT_EQ(log.TermAt(5), 2u);
+        // Only the newest two entries stay readable.
+        EXPECT_FALSE(log.ReadAfter(2, 10).has_value());
+        auto tail = log.ReadAfter(4, 10);
+        ASSERT_TRUE(tail.has_value());
+        ASSERT_EQ(tail->size(), 2u);
+        EXPECT_EQ(tail->back().payload, "op-6");
+        EXPECT_FALSE(log.Append({{9, 2, "gap"}}).ok());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "torn";
+    }
+    nebulafs::metadata::ReplicationLog reopened(path.string(), 2);
+    EXPECT_EQ(reopened.last_index(), 6u);
+    EXPECT_EQ(reopened.last_term(), 2u);
+    EXPECT_TRUE(reopened.Append({{7, 3, "op-7"}}).ok());
+    std::filesystem::remove(path);
+}
+
+TEST(ReplicationLog, TruncatesAConflictingSuffix) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("nebulafs_rlog_" + Poco::UUIDGenerator().createOne().toString());
+    {
+        nebulafs::metadata::ReplicationLog log(path.string(), 4);
+        for (std::uint64_t i = 1; i <= 4; ++i) {
+            ASSERT_TRUE(log.Append({{i, 1, "op-" + std::to_string(i)}}).ok());
+        }
+        ASSERT_TRUE(log.TruncateAfter(2).ok());
+        EXPECT_EQ(log.last_index(), 2u);
+        EXPECT_EQ(log.last_term(), 1u);
+        EXPECT_FALSE(log.TermAt(3).has_value());
+        ASSERT_TRUE(log.Append({{3, 2, "op-3b"}}).ok());
+    }
+    nebulafs::metadata::ReplicationLog reopened(path.string(), 4);
+    EXPECT_EQ(reopened.last_index(), 3u);
+    auto tail = reopened.ReadAfter(2, 10);
+    ASSERT_TRUE(tail.has_value());
+    ASSERT_EQ(tail->size(), 1u);
+    EXPECT_EQ(tail->front().payload, "op-3b");
+    std::filesystem::remove(path);
+}
+
+TEST(ReplicatedMetadataStore, FollowersServeLeaderWritesWithLeaderTimestamps) {
+    ReplicaCluster cluster(3);
+    const auto leader = cluster.WaitForLeader();
+    ASSERT_FALSE(leader.empty());
+
+    ReplicatedMetadataStore::ResetLastWriteIndex();
+    ASSERT_TRUE(cluster[leader].CreateBucket("photos").ok());
+    auto written = cluster[leader].UpsertObject("photos", MakeObject("cat.jpg", "etag-1"));
+    ASSERT_TRUE(written.ok());
+    const auto index = ReplicatedMetadataStore::LastWriteIndex();
+    EXPECT_GT(index, 0u);
+
+    for (const auto& follower : cluster.Followers(leader)) {
+        ASSERT_TRUE(cluster[follower].group().AwaitReadable(index, 2000).ok()) << follower;
+        auto object = cluster[follower].GetObject("photos", "cat.jpg");
+        ASSERT_TRUE(object.ok()) << follower;
+        EXPECT_EQ(object.value().etag, "etag-1");
+        EXPECT_EQ(object.value().updated_at, written.value().updated_at);
+        EXPECT_FALSE(cluster[follower].group().IsLeader());
+    }
+}
+
+TEST(ReplicatedMetadataStore, FollowersRejectWrites) {
+    ReplicaCluster cluster(3);
+    const auto leader = cluster.WaitForLeader();
+    ASSERT_FALSE(leader.empty());
+    const auto follower = cluster.Followers(leader).front();
+    ASSERT_TRUE(cluster[follower].group().AwaitReadable(0, 2000).ok());
+
+    auto created = cluster[follower].CreateBucket("photos");
+    ASSERT_FALSE(created.ok());
+    EXPECT_EQ(created.error().code, nebulafs::core::ErrorCode::kUnavailable);
+    EXPECT_EQ(cluster[follower].group().leader(), leader);
+}
+
+TEST(ReplicatedMetadataStore, NewLeaderKeepsCommittedWritesAfterFailover) {
+    ReplicaCluster cluster(3);
+    const auto leader = cluster.WaitForLeader();
+    ASSERT_FALSE(leader.empty());
+    ASSERT_TRUE(cluster[leader].CreateBucket("photos").ok());
+    ASSERT_TRUE(cluster[leader].UpsertObject("photos", MakeObject("a", "etag-a")).ok());
+
+    cluster.Isolate(leader);
+    const auto successor = cluster.WaitForLeader();
+    ASSERT_FALSE(successor.empty());
+    ASSERT_NE(successor, leader);
+
+    ASSERT_TRUE(cluster[successor].group().AwaitReadable(0, 2000).ok());
+    auto object = cluster[successor].GetObject("photos", "a");
+    ASSERT_TRUE(object.ok());
+    EXPECT_EQ(object.value().etag, "etag-a");
+    EXPECT_TRUE(cluster[successor].UpsertObject("photos", MakeObject("b", "etag-b")).ok());
+    const auto index = ReplicatedMetadataStore::LastWriteIndex();
+
+    // The isolated leader can no longer reach a quorum, so it neither commits nor serves reads,
+    // and the write it logged never reaches its store.
+    auto stranded = cluster[leader].UpsertObject("photos", MakeObject("c", "etag-c"));
+    EXPECT_FALSE(stranded.ok());
+    EXPECT_FALSE(cluster[leader].group().AwaitReadable(0, 0).ok());
+    EXPECT_FALSE(cluster[leader].GetObject("photos", "c").ok());
+
+    // Back in the group, it drops the uncommitted entry and catches up instead of diverging.
+    cluster.Heal(leader);
+    ASSERT_TRUE(cluster[leader].group().AwaitReadable(index, 5000).ok());
+    EXPECT_FALSE(cluster[leader].group().Status().diverged);
+    EXPECT_TRUE(cluster[leader].GetObject("photos", "b").ok());
+    EXPECT_FALSE(cluster[leader].GetObject("photos", "c").ok());
+}
+
+TEST(ReplicatedMetadataStore, IsolatedFollowerStopsServingReads) {
+    ReplicaCluster cluster(3);
+    const auto leader = cluster.WaitForLeader();
+    ASSERT_FALSE(leader.empty());
+    const auto follower = cluster.Followers(leader).front();
+    ASSERT_TRUE(cluster[follower].group().AwaitReadable(0, 2000).ok());
+
+    cluster.Isolate(follower);
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    auto readable = cluster[follower].group().AwaitReadable(0, 0);
+    ASSERT_FALSE(readable.ok());
+    EXPECT_EQ(readable.error().code, nebulafs::core::ErrorCode::kUnavailable);
+}
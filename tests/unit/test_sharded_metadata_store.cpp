@@ -0,0 +1,174 @@
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/metadata/memory_metadata_store.h"
+#include "nebulafs/metadata/sharded_metadata_store.h"
+
+namespace {
+
+// Local stores stand in for the per-shard metadata services.
+class LocalShards {
+public:
+    LocalShards()
+        : root_(std::filesystem::temp_directory_path() /
+                ("nebulafs_shards_" + Poco::UUIDGenerator().createOne().toString())) {}
+    ~LocalShards() {
+        stores_.clear();
+        std::filesystem::remove_all(root_);
+    }
+
+    nebulafs::metadata::ShardedMetadataStore::ShardFactory Factory() {
+        return [this](const std::string& endpoint) { return Get(endpoint); };
+    }
+
+    std::shared_ptr<nebulafs::metadata::MetadataStore> Get(const std::string& endpoint) {
+        auto& store = stores_[endpoint];
+        if (!store) {
+            ++created_;
+            store = std::make_shared<nebulafs::metadata::MemoryMetadataStore>(
+                (root_ / endpoint).string());
+        }
+        return store;
+    }
+
+    int created() const { return created_; }
+
+private:
+    std::filesystem::path root_;
+    std::map<std::string, std::shared_ptr<nebulafs::metadata::MetadataStore>> stores_;
+    int created_{0};
+};
+
+}  // namespace
+
+TEST(ShardMap, AssignmentIgnoresOrderAndMovesFewBuckets) {
+    nebulafs::metadata::ShardMap three({"shard-a", "shard-b", "shard-c"});
+    nebulafs::metadata::ShardMap shuffled({"shard-c", "shard-a", "shard-b"});
+    nebulafs::metadata::ShardMap four({"shard-a", "shard-b", "shard-c", "shard-d"});
+
+    int moved = 0;
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < 3000; ++i) {
+        const auto bucket = "bucket-" + std::to_string(i);
+        const auto& owner = three.endpoints()[three.ShardFor(bucket)];
+        EXPECT_EQ(owner, shuffled.endpoints()[shuffled.ShardFor(bucket)]);
+        ++counts[three.ShardFor(bucket)];
+        const auto& next_owner = four.endpoints()[four.ShardFor(bucket)];
+        if (next_owner != owner) {
+            // Adding a shard only ever moves buckets onto the new shard.
+            EXPECT_EQ(next_owner, "shard-d");
+            ++moved;
+        }
+    }
+    for (int count : counts) {
+        EXPECT_GT(count, 800);
+    }
+    EXPECT_GT(moved, 500);
+    EXPECT_LT(moved, 1000);
+}
+
+TEST(ShardedMetadataStore, RoutesBucketsAndFansOutListings) {
+    LocalShards shards;
+    nebulafs::metadata::ShardedMetadataStore store({"shard-a", "shard-b", "shard-c"},
+                                                   shards.Factory());
+    for (int i = 0; i < 12; ++i) {
+        const auto bucket = "bucket-" + std::to_string(i);
+        ASSERT_TRUE(store.CreateBucket(bucket).ok());
+        nebulafs::metadata::ObjectMetadata meta;
+        meta.name = "obj";
+        ASSERT_TRUE(store.UpsertObject(bucket, meta).ok());
+    }
+
+    std::size_t total = 0;
+    for (const auto& endpoint : store.endpoints()) {
+        auto local = shards.Get(endpoint)->ListBuckets();
+        ASSERT_TRUE(local.ok());
+        EXPECT_LT(local.value().size(), 12u);
+        total += local.value().size();
+    }
+    EXPECT_EQ(total, 12u);
+
+    auto buckets = store.ListBuckets();
+    ASSERT_TRUE(buckets.ok());
+    ASSERT_EQ(buckets.value().size(), 12u);
+    EXPECT_EQ(buckets.value().front().name, "bucket-0");
+    ASSERT_TRUE(store.GetObject("bucket-7", "obj").ok());
+}
+
+TEST(ShardedMetadataStore, FindsUploadsWithoutCachedShard) {
+    LocalShards shards;
+    const std::vector<std::string> endpoints{"shard-a", "shard-b"};
+    nebulafs::metadata::ShardedMetadataStore first(endpoints, shards.Factory());
+    ASSERT_TRUE(first.CreateBucket("media").ok());
+    ASSERT_TRUE(first.CreateMultipartUpload("media", "up-1", "video.mp4", "2000-01-01").ok());
+
+    // A second gateway has no cache entry and must locate the upload by asking every shard.
+    nebulafs::metadata::ShardedMetadataStore second(endpoints, shards.Factory());
+    ASSERT_TRUE(second.UpsertMultipartPart("up-1", 1, 10, "etag", "/tmp/p").ok());
+    auto parts = first.ListMultipartParts("up-1");
+    ASSERT_TRUE(parts.ok());
+    EXPECT_EQ(parts.value().size(), 1u);
+
+    auto expired = second.ListExpiredMultipartUploads("2001-01-01", 10);
+    ASSERT_TRUE(expired.ok());
+    ASSERT_EQ(expired.value().size(), 1u);
+
+    ASSERT_TRUE(second.DeleteMultipartUpload("up-1").ok());
+    auto missing = first.GetMultipartUpload("up-1");
+    ASSERT_FALSE(missing.ok());
+    EXPECT_EQ(missing.error().code, nebulafs::core::ErrorCode::kNotFound);
+}
+
+TEST(ShardedMetadataStore, RejectsBatchesAcrossShards) {
+    LocalShards shards;
+    nebulafs::metadata::ShardedMetadataStore store({"shard-a", "shard-b"}, shards.Factory());
+    nebulafs::metadata::ShardMap map(store.endpoints());
+    std::string other;
+    for (int i = 0; other.empty(); ++i) {
+        const auto bucket = "bucket-" + std::to_string(i);
+        if (map.ShardFor(bucket) != map.ShardFor("photos")) {
+            other = bucket;
+        }
+    }
+    ASSERT_TRUE(store.CreateBucket("photos").ok());
+    ASSERT_TRUE(store.CreateBucket(other).ok());
+
+    nebulafs::metadata::BatchOp copy;
+    copy.type = nebulafs::metadata::BatchOpType::kCopyObject;
+    copy.bucket = other;
+    copy.object_name = "cat.jpg";
+    copy.source_bucket = "photos";
+    copy.source_object = "cat.jpg";
+    auto executed = store.ExecuteBatch({copy});
+    ASSERT_FALSE(executed.ok());
+    EXPECT_EQ(executed.error().code, nebulafs::core::ErrorCode::kCrossShard);
+
+    // Within one shard the op runs and fails on its own terms.
+    copy.bucket = "photos";
+    copy.object_name = "dog.jpg";
+    executed = store.ExecuteBatch({copy});
+    ASSERT_FALSE(executed.ok());
+    EXPECT_NE(executed.error().code, nebulafs::core::ErrorCode::kCrossShard);
+}
+
+TEST(ShardedMetadataStore, ReloadReusesExistingShards) {
+    LocalShards shards;
+    nebulafs::metadata::ShardedMetadataStore store({"shard-a", "shard-b"}, shards.Factory());
+    EXPECT_EQ(shards.created(), 2);
+
+    store.Reload({"shard-b", "shard-a", "shard-c"});
+    EXPECT_EQ(shards.created(), 3);
+    EXPECT_EQ(store.endpoints().size(), 3u);
+
+    ASSERT_TRUE(store.ConfigureStorageNodes({"http://node-a"}).ok());
+    ASSERT_TRUE(store.CreateBucket("photos").ok());
+    auto plan = store.AllocateWrite("photos", "cat.jpg", 1, "token");
+    ASSERT_TRUE(plan.ok());
+    EXPECT_EQ(plan.value().replicas.front().endpoint, "http://node-a");
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "nebulafs/core/binary_codec.h"
+#include "nebulafs/storage/upload_pipeline.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using nebulafs::storage::UploadPipeline;
+
+// Feeds `body` through `pipeline` in pieces of varying size, the way a connection would, and
+// runs `owner` until the pipeline drains.
+void Pump(boost::asio::io_context& owner, UploadPipeline& pipeline, const std::string& body) {
+    std::size_t offset = 0;
+    std::size_t piece = 1;
+    bool drained = false;
+    // Nothing is queued on `owner` while the connection waits for a chunk to come back.
+    auto work = boost::asio::make_work_guard(owner);
+    std::function<void()> feed = [&] {
+        while (offset < body.size()) {
+            auto chunk = pipeline.Acquire();
+            if (!chunk) {
+                return pipeline.WaitForChunk(feed);
+            }
+            piece = piece * 7 % UploadPipeline::kChunkBytes + 1;
+            chunk->size = std::min(piece, body.size() - offset);
+            std::memcpy(chunk->data.data(), body.data() + offset, chunk->size);
+            offset += chunk->size;
+            pipeline.Submit(std::move(chunk));
+        }
+        pipeline.WaitForDrain([&] {
+            drained = true;
+            work.reset();
+        });
+    };
+    feed();
+    owner.run();
+    EXPECT_TRUE(drained);
+}
+
+std::string MakeBody(std::size_t size) {
+    std::string body(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        body[i] = static_cast<char>((i * 131) ^ (i >> 9));
+    }
+    return body;
+}
+
+}  // namespace
+
+TEST(UploadPipeline, WritesAndHashesChunksInOrder) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("nebulafs_pipeline_" + Poco::UUIDGenerator().createOne().toString());
+    const auto body = MakeBody(3 * 1024 * 1024 + 17);
+    const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+
+    boost::asio::io_context owner;
+    boost::asio::thread_pool pool(3);
+    auto pipeline = std::make_shared<UploadPipeline>(
+        pool, owner.get_executor(), fd, nebulafs::core::ObjectHasher(), std::uint32_t{0}, 2);
+    Pump(owner, *pipeline, body);
+    ::close(fd);
+
+    ASSERT_TRUE(pipeline->status().ok());
+    nebulafs::core::ObjectHasher expected;
+    expected.Update(body);
+    EXPECT_EQ(pipeline->TakeHasher()->HexDigest(), expected.HexDigest());
+    EXPECT_EQ(pipeline->TakeCrc32c(), nebulafs::core::Crc32c(body));
+    std::ifstream in(path, std::ios::binary);
+    EXPECT_TRUE(std::string(std::istreambuf_iterator<char>(in), {}) == body);
+    std::filesystem::remove(path);
+}
+
+TEST(UploadPipeline, WriteFailureDrainsAndReportsError) {
+    boost::asio::io_context owner;
+    boost::asio::thread_pool pool(1);
+    auto pipeline = std::make_shared<UploadPipeline>(pool, owner.get_executor(), -1,
+                                                     std::nullopt, std::nullopt, 1);
+    Pump(owner, *pipeline, MakeBody(200000));
+    auto status = pipeline->status();
+    ASSERT_FALSE(status.ok());
+    EXPECT_EQ(status.error().code, nebulafs::core::ErrorCode::kIoError);
+}
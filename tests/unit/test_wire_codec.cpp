@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+
+#include "nebulafs/core/wire_codec.h"
+#include "nebulafs/metadata/metadata_rpc.h"
+
+namespace {
+
+using nebulafs::core::WireFormat;
+
+nebulafs::metadata::CommitWriteRequest MakeCommit() {
+    nebulafs::metadata::CommitWriteRequest request;
+    request.bucket = "photos";
+    request.object = "2024/\"quoted\"\n.jpg";
+    request.blob_id = "blob-1";
+    request.size_bytes = 5'000'000'000ULL;
+    request.etag = "etag";
+    request.replicas = {{1, 0, "http://node-a"}, {2, 1, "http://node-b"}};
+    return request;
+}
+
+// A later revision of `Versioned` that appended `note`.
+struct Versioned {
+    int id{0};
+    std::string name;
+};
+
+struct VersionedV2 {
+    int id{0};
+    std::string name;
+    std::string note{"default"};
+};
+
+}  // namespace
+
+template <>
+struct nebulafs::core::WireSchema<Versioned> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("id", &Versioned::id), Field("name", &Versioned::name));
+};
+
+template <>
+struct nebulafs::core::WireSchema<VersionedV2> {
+    static constexpr auto kFields =
+        std::make_tuple(Field("id", &VersionedV2::id), Field("name", &VersionedV2::name),
+                        Field("note", &VersionedV2::note));
+};
+
+TEST(WireCodec, RoundTripsInBothFormats) {
+    const auto request = MakeCommit();
+    for (const auto format : {WireFormat::kBinary, WireFormat::kJson}) {
+        const auto body = nebulafs::core::EncodeWire(format, request);
+        nebulafs::core::WireDecoder decoder(format);
+        auto decoded = decoder.Decode<nebulafs::metadata::CommitWriteRequest>(body);
+        ASSERT_TRUE(decoded.ok()) << decoded.error().message;
+        EXPECT_EQ(decoded.value().object, request.object);
+        EXPECT_EQ(decoded.value().size_bytes, request.size_bytes);
+        ASSERT_EQ(decoded.value().replicas.size(), 2u);
+        EXPECT_EQ(decoded.value().replicas[1].node_id, 2);
+        EXPECT_EQ(decoded.value().replicas[1].endpoint, "http://node-b");
+    }
+}
+
+TEST(WireCodec, BinaryIsSmallerAndDecodesWithoutCopies) {
+    const auto request = MakeCommit();
+    const auto binary = nebulafs::core::EncodeWire(WireFormat::kBinary, request);
+    const auto json = nebulafs::core::EncodeWire(WireFormat::kJson, request);
+    EXPECT_LT(binary.size(), json.size());
+
+    nebulafs::core::WireDecoder decoder(WireFormat::kBinary);
+    auto decoded = decoder.Decode<nebulafs::metadata::CommitWriteRequest>(binary);
+    ASSERT_TRUE(decoded.ok());
+    const auto* begin = binary.data();
+    const auto* end = binary.data() + binary.size();
+    EXPECT_GE(decoded.value().bucket.data(), begin);
+    EXPECT_LT(decoded.value().bucket.data(), end);
+}
+
+TEST(WireCodec, BatchOpsKeepTheirTypes) {
+    nebulafs::metadata::BatchRequest request;
+    request.ops.resize(2);
+    request.ops[0].type = nebulafs::metadata::BatchOpType::kCommitWrite;
+    request.ops[0].expect_upload_state = "initiated";
+    request.ops[1].type = nebulafs::metadata::BatchOpType::kDeleteMultipartUpload;
+    request.ops[1].upload_id = "up-1";
+    for (const auto format : {WireFormat::kBinary, WireFormat::kJson}) {
+        auto decoded = nebulafs::core::DecodeWire<nebulafs::metadata::BatchRequest>(
+            format, nebulafs::core::EncodeWire(format, request));
+        ASSERT_TRUE(decoded.ok()) << decoded.error().message;
+        ASSERT_EQ(decoded.value().ops.size(), 2u);
+        EXPECT_EQ(decoded.value().ops[0].type, nebulafs::metadata::BatchOpType::kCommitWrite);
+        EXPECT_EQ(decoded.value().ops[0].expect_upload_state, "initiated");
+        EXPECT_EQ(decoded.value().ops[1].type,
+                  nebulafs::metadata::BatchOpType::kDeleteMultipartUpload);
+    }
+}
+
+TEST(WireCodec, OlderAndNewerSchemasInteroperate) {
+    const auto old_body = nebulafs::core::EncodeWire(WireFormat::kBinary, Versioned{7, "a"});
+    auto upgraded = nebulafs::core::DecodeWire<VersionedV2>(WireFormat::kBinary, old_body);
+    ASSERT_TRUE(upgraded.ok());
+    EXPECT_EQ(upgraded.value().id, 7);
+    EXPECT_EQ(upgraded.value().note, "default");
+
+    const auto new_body =
+        nebulafs::core::EncodeWire(WireFormat::kBinary, VersionedV2{8, "b", "extra"});
+    auto downgraded = nebulafs::core::DecodeWire<Versioned>(WireFormat::kBinary, new_body);
+    ASSERT_TRUE(downgraded.ok());
+    EXPECT_EQ(downgraded.value().name, "b");
+}
+
+TEST(WireCodec, RejectsUnknownVersionsAndTruncatedBodies) {
+    auto body = nebulafs::core::EncodeWire(WireFormat::kBinary, MakeCommit());
+    auto future = body;
+    future[0] = static_cast<char>(nebulafs::core::kWireVersion + 1);
+    EXPECT_FALSE(nebulafs::core::WireDecoder(WireFormat::kBinary)
+                     .Decode<nebulafs::metadata::CommitWriteRequest>(future)
+                     .ok());
+    body.resize(body.size() - 3);
+    EXPECT_FALSE(nebulafs::core::WireDecoder(WireFormat::kBinary)
+                     .Decode<nebulafs::metadata::CommitWriteRequest>(body)
+                     .ok());
+}
+
+TEST(WireCodec, NegotiatesFromMediaTypes) {
+    EXPECT_EQ(nebulafs::core::FormatFromMediaType("application/x-nebulafs-rpc"),
+              WireFormat::kBinary);
+    EXPECT_EQ(nebulafs::core::FormatFromMediaType("application/x-nebulafs-rpc, application/json"),
+              WireFormat::kBinary);
+    EXPECT_EQ(nebulafs::core::FormatFromMediaType("application/json"), WireFormat::kJson);
+    EXPECT_EQ(nebulafs::core::FormatFromMediaType(""), WireFormat::kJson);
+    EXPECT_EQ(nebulafs::core::WireFormatFromName("json"), WireFormat::kJson);
+}